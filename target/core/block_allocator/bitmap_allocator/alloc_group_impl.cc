@@ -0,0 +1,718 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "alloc_group_impl.h"
+#include <stdint.h>
+#include <fstream>
+#include <algorithm>
+
+namespace AllocatorType {
+
+// Token identifying the calling thread as a group owner, never 0
+static uint64_t current_thread_token() {
+    static std::atomic<uint64_t> next_token(1);
+    static thread_local uint64_t token = 0;
+
+    if (token == 0) {
+        token = next_token.fetch_add(1, std::memory_order_relaxed);
+    }
+    return token;
+}
+
+AllocGroups::AllocGroups(
+        BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer,
+        uint64_t total_blocks,
+        uint8_t bits_per_cell,
+        uint64_t num_block_states,
+        uint64_t block_alloc_meta_start_offset,
+        uint64_t logical_start_block_offset,
+        uint64_t logical_block_size,
+        uint64_t optimum_write_size,
+        uint64_t num_groups)
+    : logical_start_block_offset_(logical_start_block_offset),
+      block_alloc_meta_start_offset_(block_alloc_meta_start_offset),
+      total_blocks_(total_blocks),
+      group_blocks_(0),
+      shared_owner_(io_task_orderer != nullptr),
+      deferred_frees_(0) {
+
+    // Cells held by one meta block, groups are aligned to this
+    // so that each group bitmap starts on its own meta block
+    uint64_t cells_per_meta_blk =
+        (logical_block_size * BITS_PER_BYTE) / bits_per_cell;
+    uint64_t start = 0;
+    uint64_t num_blocks = 0;
+    uint64_t i = 0;
+
+    if (num_groups == 0) {
+        num_groups = 1;
+    }
+
+    group_blocks_ = (total_blocks + num_groups - 1) / num_groups;
+    group_blocks_ = ((group_blocks_ + cells_per_meta_blk - 1) /
+            cells_per_meta_blk) * cells_per_meta_blk;
+    if (group_blocks_ == 0) {
+        group_blocks_ = cells_per_meta_blk;
+    }
+
+    do {
+        start = i * group_blocks_;
+        num_blocks = std::min(group_blocks_, total_blocks - start);
+
+        std::unique_ptr<AllocGroup> g(new AllocGroup());
+        g->start_block = logical_start_block_offset + start;
+        g->num_blocks = num_blocks;
+        g->meta_byte_offset = (start * bits_per_cell) / BITS_PER_BYTE;
+        g->jso = std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                num_blocks, g->start_block, optimum_write_size);
+        g->bitmap = std::make_shared<QwordVector64Cell>(
+                g->jso,
+                io_task_orderer,
+                num_blocks,
+                bits_per_cell,
+                num_block_states,
+                block_alloc_meta_start_offset + start / cells_per_meta_blk,
+                g->start_block);
+        g->owner.store(0);
+        g->pending_frees.store(nullptr);
+        groups_.push_back(std::move(g));
+        i++;
+    } while (i * group_blocks_ < total_blocks);
+}
+
+AllocGroups::~AllocGroups() {
+    DeferredFree *f = nullptr;
+    DeferredFree *next = nullptr;
+
+    // Frees still queued are dropped with the bitmaps
+    for (auto& g : groups_) {
+        f = g->pending_frees.exchange(nullptr);
+        while (f != nullptr) {
+            next = f->next;
+            delete f;
+            f = next;
+        }
+    }
+}
+
+uint64_t AllocGroups::group_of(uint64_t block_index) const {
+    uint64_t gi = 0;
+
+    if (block_index < logical_start_block_offset_) {
+        return 0;
+    }
+
+    gi = (block_index - logical_start_block_offset_) / group_blocks_;
+    if (gi >= groups_.size()) {
+        gi = groups_.size() - 1;
+    }
+    return gi;
+}
+
+bool AllocGroups::acquire(AllocGroup& g) {
+    std::atomic<uint64_t>& slot = owner_slot(g);
+    uint64_t token = current_thread_token();
+    uint64_t owner = slot.load(std::memory_order_acquire);
+
+    if (owner == token) {
+        return true;
+    }
+    if (owner != 0) {
+        return false;
+    }
+    if (slot.compare_exchange_strong(owner, token,
+                std::memory_order_acq_rel)) {
+        return true;
+    }
+    return owner == token;
+}
+
+bool AllocGroups::acquire_range(uint64_t block_index, uint64_t num_blocks) {
+    uint64_t first = group_of(block_index);
+    uint64_t last = group_of(block_index + num_blocks - 1);
+
+    for (uint64_t i = first; i <= last; i++) {
+        if (!acquire(*groups_[i])) {
+            return false;
+        }
+        drain_frees(*groups_[i]);
+    }
+    return true;
+}
+
+dss_blk_allocator_status_t AllocGroups::alloc_blocks_at_span(
+        uint64_t state,
+        uint64_t block_index,
+        uint64_t num_blocks) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t index = block_index;
+    uint64_t remaining = num_blocks;
+    uint64_t chunk = 0;
+
+    if ((block_index < logical_start_block_offset_) ||
+            (block_index + num_blocks >
+             logical_start_block_offset_ + total_blocks_)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if (!acquire_range(block_index, num_blocks)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    while (remaining > 0) {
+        AllocGroup& g = *groups_[group_of(index)];
+        chunk = std::min(remaining, g.start_block + g.num_blocks - index);
+
+        status = g.bitmap->alloc_blocks_contig(state, index, chunk, NULL);
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            // Release the part already placed in earlier groups
+            if ((index > block_index) &&
+                    (clear_blocks(block_index, index - block_index) !=
+                     BLK_ALLOCATOR_STATUS_SUCCESS)) {
+                assert(("ERROR", false));
+            }
+            return status;
+        }
+        index += chunk;
+        remaining -= chunk;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+bool AllocGroups::is_owner(AllocGroup& g) {
+    return owner_slot(g).load(std::memory_order_acquire) ==
+        current_thread_token();
+}
+
+void AllocGroups::push_free(
+        AllocGroup& g, uint64_t block_index, uint64_t num_blocks) {
+
+    DeferredFree *f = new DeferredFree();
+    f->block_index = block_index;
+    f->num_blocks = num_blocks;
+    f->next = g.pending_frees.load(std::memory_order_relaxed);
+    while (!g.pending_frees.compare_exchange_weak(f->next, f,
+                std::memory_order_release, std::memory_order_relaxed)) {
+        // f->next is reloaded with the current head on failure
+    }
+    deferred_frees_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocGroups::drain_frees(AllocGroup& g) {
+    DeferredFree *f = nullptr;
+    DeferredFree *next = nullptr;
+    dss_blk_allocator_status_t status;
+
+    // Avoid the exchange when nothing is queued
+    if (g.pending_frees.load(std::memory_order_acquire) == nullptr) {
+        return;
+    }
+
+    f = g.pending_frees.exchange(nullptr, std::memory_order_acquire);
+    while (f != nullptr) {
+        next = f->next;
+        status = g.bitmap->clear_blocks(f->block_index, f->num_blocks);
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            assert(("ERROR", false));
+        }
+        delete f;
+        f = next;
+    }
+}
+
+void AllocGroups::destroy() {
+    // Allocator is quiesced, apply whatever is still queued
+    for (auto& g : groups_) {
+        drain_frees(*g);
+    }
+}
+
+uint64_t AllocGroups::get_physical_size() {
+    uint64_t size = 0;
+
+    // Groups are meta block aligned so the sum matches the size
+    // of a single bitmap over all blocks
+    for (auto& g : groups_) {
+        size += g->bitmap->get_physical_size();
+    }
+    return size;
+}
+
+dss_blk_allocator_status_t AllocGroups::is_block_free(
+        uint64_t block_index,
+        bool *is_free) {
+
+    AllocGroup& g = *groups_[group_of(block_index)];
+
+    if (is_owner(g)) {
+        drain_frees(g);
+    }
+    return g.bitmap->is_block_free(block_index, is_free);
+}
+
+dss_blk_allocator_status_t AllocGroups::get_block_state(
+        uint64_t block_index,
+        uint64_t *block_state) {
+
+    AllocGroup& g = *groups_[group_of(block_index)];
+
+    if (is_owner(g)) {
+        drain_frees(g);
+    }
+    return g.bitmap->get_block_state(block_index, block_state);
+}
+
+dss_blk_allocator_status_t AllocGroups::check_blocks_state(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t block_state,
+        uint64_t *scanned_index) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t index = block_index;
+    uint64_t remaining = num_blocks;
+    uint64_t mismatch_index = block_index + num_blocks;
+    uint64_t group_scanned = 0;
+    uint64_t group_mismatch = 0;
+    uint64_t chunk = 0;
+
+    if ((block_index < logical_start_block_offset_) ||
+            (block_index + num_blocks >
+             logical_start_block_offset_ + total_blocks_)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Check group by group till a block not in state is found
+    while (remaining > 0) {
+        AllocGroup& g = *groups_[group_of(index)];
+        chunk = std::min(remaining, g.start_block + g.num_blocks - index);
+
+        if (is_owner(g)) {
+            drain_frees(g);
+        }
+        status = g.bitmap->check_blocks_state(
+                index, chunk, block_state, &group_scanned);
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return status;
+        }
+
+        group_mismatch = (index == 0) ? group_scanned : group_scanned + 1;
+        if (group_mismatch < index + chunk) {
+            mismatch_index = group_mismatch;
+            break;
+        }
+        index += chunk;
+        remaining -= chunk;
+    }
+
+    // Last block in state, or block_index - 1 if none
+    if (block_index == 0) {
+        *scanned_index = mismatch_index;
+    } else {
+        *scanned_index = mismatch_index - 1;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::set_blocks_state(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t state) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t index = block_index;
+    uint64_t remaining = num_blocks;
+    uint64_t chunk = 0;
+
+    if ((block_index < logical_start_block_offset_) ||
+            (block_index + num_blocks >
+             logical_start_block_offset_ + total_blocks_)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Only the owner may change block states of a group, claim all
+    // groups first so a range is not left half changed
+    if (!acquire_range(block_index, num_blocks)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    while (remaining > 0) {
+        AllocGroup& g = *groups_[group_of(index)];
+        chunk = std::min(remaining, g.start_block + g.num_blocks - index);
+
+        status = g.bitmap->set_blocks_state(index, chunk, state);
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return status;
+        }
+        index += chunk;
+        remaining -= chunk;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::clear_blocks(
+        uint64_t block_index,
+        uint64_t num_blocks) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t index = block_index;
+    uint64_t remaining = num_blocks;
+    uint64_t chunk = 0;
+
+    if ((block_index < logical_start_block_offset_) ||
+            (block_index + num_blocks >
+             logical_start_block_offset_ + total_blocks_)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    while (remaining > 0) {
+        AllocGroup& g = *groups_[group_of(index)];
+        chunk = std::min(remaining, g.start_block + g.num_blocks - index);
+
+        if (acquire(g)) {
+            drain_frees(g);
+            status = g.bitmap->clear_blocks(index, chunk);
+            if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+                return status;
+            }
+        } else {
+            // Owner applies the free on its next operation
+            push_free(g, index, chunk);
+        }
+        index += chunk;
+        remaining -= chunk;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::alloc_blocks_contig(
+        uint64_t state,
+        uint64_t hint_block_index,
+        uint64_t num_blocks,
+        uint64_t *allocated_start_block) {
+
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_ERROR;
+    uint64_t hint_group = group_of(hint_block_index);
+    uint64_t token = current_thread_token();
+    std::vector<bool> tried(groups_.size(), false);
+    uint64_t owner = 0;
+    uint64_t free_blocks = 0;
+    uint64_t best_free = 0;
+    uint64_t best = 0;
+    bool found = false;
+
+    if (hint_block_index >= logical_start_block_offset_ + total_blocks_) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Exact placement across groups is split per group
+    if ((allocated_start_block == NULL) &&
+            (hint_block_index + num_blocks >
+             groups_[hint_group]->start_block +
+             groups_[hint_group]->num_blocks)) {
+        return alloc_blocks_at_span(state, hint_block_index, num_blocks);
+    }
+
+    // 1. Try the group holding the hint
+    AllocGroup& hg = *groups_[hint_group];
+    if (acquire(hg)) {
+        drain_frees(hg);
+        status = hg.bitmap->alloc_blocks_contig(
+                state, hint_block_index, num_blocks, allocated_start_block);
+        if (status == BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    // Allocation at hint only, nothing to spill
+    if (allocated_start_block == NULL) {
+        return status;
+    }
+    tried[hint_group] = true;
+
+    // 2. Spill to the group with most free blocks this thread may use
+    while (true) {
+        found = false;
+        best_free = 0;
+        for (uint64_t i = 0; i < groups_.size(); i++) {
+            AllocGroup& g = *groups_[i];
+            if (tried[i]) {
+                continue;
+            }
+            owner = owner_slot(g).load(std::memory_order_acquire);
+            if (owner == token) {
+                drain_frees(g);
+                free_blocks = g.jso->get_free_blocks();
+            } else if (owner == 0) {
+                // Nothing has touched an unclaimed group yet
+                free_blocks = g.num_blocks;
+            } else {
+                continue;
+            }
+            if (free_blocks >= num_blocks && free_blocks > best_free) {
+                best = i;
+                best_free = free_blocks;
+                found = true;
+            }
+        }
+
+        if (!found) {
+            return BLK_ALLOCATOR_STATUS_ERROR;
+        }
+
+        tried[best] = true;
+        AllocGroup& g = *groups_[best];
+        if (!acquire(g)) {
+            // Claimed by another thread meanwhile
+            continue;
+        }
+        drain_frees(g);
+        status = g.bitmap->alloc_blocks_contig(
+                state, g.start_block, num_blocks, allocated_start_block);
+        if (status == BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+}
+
+dss_blk_allocator_status_t AllocGroups::translate_meta_to_drive_addr(
+        uint64_t meta_lba,
+        uint64_t meta_num_blocks,
+        uint64_t drive_smallest_block_size,
+        uint64_t logical_block_size,
+        uint64_t& drive_blk_lba,
+        uint64_t& drive_num_blocks) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t meta_lba_end = (meta_lba + meta_num_blocks) - 1;
+    uint64_t dlba_start = 0;
+    uint64_t dlba_end = 0;
+    uint64_t num_blocks = 0;
+
+    drive_blk_lba = 0;
+    drive_num_blocks = 0;
+
+    // Range may span groups, translate both ends in their own group
+    status = groups_[group_of(meta_lba)]->bitmap->
+        translate_meta_to_drive_addr(meta_lba, 1,
+                drive_smallest_block_size, logical_block_size,
+                dlba_start, num_blocks);
+    if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+        return status;
+    }
+    status = groups_[group_of(meta_lba_end)]->bitmap->
+        translate_meta_to_drive_addr(meta_lba_end, 1,
+                drive_smallest_block_size, logical_block_size,
+                dlba_end, num_blocks);
+    if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+        return status;
+    }
+
+    drive_blk_lba = dlba_start;
+    drive_num_blocks = (dlba_end - dlba_start) + 1;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::serialize_drive_data(
+        uint64_t drive_blk_addr,
+        uint64_t drive_num_blocks,
+        uint64_t drive_smallest_block_size,
+        void** serialized_drive_data,
+        uint64_t& serialized_len) {
+
+    char *serial_buf = nullptr;
+    uint64_t range_start = 0;
+    uint64_t range_end = 0;
+    uint64_t group_start = 0;
+    uint64_t group_end = 0;
+    uint64_t copy_start = 0;
+    uint64_t copy_end = 0;
+
+    if (drive_blk_addr < block_alloc_meta_start_offset_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Byte range of the meta region to serialize
+    range_start = (drive_blk_addr - block_alloc_meta_start_offset_) *
+        drive_smallest_block_size;
+    serialized_len = drive_num_blocks * drive_smallest_block_size;
+    range_end = range_start + serialized_len;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    serial_buf = (char *)dss_dma_zmalloc(
+            serialized_len, drive_smallest_block_size);
+#else
+    serial_buf = (char *)calloc(1, serialized_len);
+#endif
+    DSS_ASSERT(serial_buf != NULL);
+    if (serial_buf == nullptr) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Copy the part of every group bitmap within the range,
+    // bytes past the last group stay zero
+    for (auto& g : groups_) {
+        group_start = g->meta_byte_offset;
+        group_end = group_start + g->bitmap->get_physical_size();
+        copy_start = std::max(range_start, group_start);
+        copy_end = std::min(range_end, group_end);
+        if (copy_start >= copy_end) {
+            continue;
+        }
+        g->bitmap->serialize_range(
+                (copy_start - group_start) / sizeof(uint64_t),
+                (copy_end - copy_start) / sizeof(uint64_t),
+                serial_buf + (copy_start - range_start),
+                copy_end - copy_start);
+    }
+
+    *serialized_drive_data = serial_buf;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::load_meta_from_disk_data(
+        uint8_t *serialized_data,
+        uint64_t serialized_data_len,
+        uint64_t disk_read_offset) {
+
+    dss_blk_allocator_status_t status;
+    uint64_t range_end = disk_read_offset + serialized_data_len;
+    uint64_t group_start = 0;
+    uint64_t group_end = 0;
+    uint64_t load_start = 0;
+    uint64_t load_end = 0;
+
+    for (auto& g : groups_) {
+        group_start = g->meta_byte_offset;
+        group_end = group_start + g->bitmap->get_physical_size();
+        load_start = std::max(disk_read_offset, group_start);
+        load_end = std::min(range_end, group_end);
+        if (load_start >= load_end) {
+            continue;
+        }
+
+        // Loading thread owns the groups it loads
+        if (!acquire(*g)) {
+            assert(("ERROR", false));
+            return BLK_ALLOCATOR_STATUS_ERROR;
+        }
+        status = g->bitmap->load_meta_from_disk_data(
+                serialized_data + (load_start - disk_read_offset),
+                load_end - load_start,
+                load_start - group_start);
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return status;
+        }
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::write_meta_to_file() {
+    // Currently written to /var/log/dss_bmap.data
+    std::ofstream dump_file;
+    uint64_t block_state = 0;
+    const uint64_t lb_per_line = 16;
+
+    dump_file.open("/var/log/dss_bmap.data");
+    for (uint64_t i = 0; i < groups_.size(); i++) {
+        AllocGroup& g = *groups_[i];
+        dump_file<<"group "<<i<<" "<<g.start_block<<" "
+            <<g.num_blocks<<"\n";
+        for (uint64_t lb = 0; lb < g.num_blocks; lb++) {
+            g.bitmap->get_block_state(g.start_block + lb, &block_state);
+            dump_file<<(g.start_block + lb)<<":"<<block_state<<", ";
+            if ((lb + 1) % lb_per_line == 0) {
+                dump_file<<"\n";
+            }
+        }
+        dump_file<<"\n";
+    }
+    dump_file.close();
+    std::cout<<"Completed writing bmap data to file"<<std::endl;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t AllocGroups::print_stats() {
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_SUCCESS;
+
+    std::cout<<std::endl;
+    std::cout<<"Allocation groups = "<<groups_.size()<<std::endl;
+    std::cout<<"Blocks per group = "<<group_blocks_<<std::endl;
+    std::cout<<"Deferred frees = "<<deferred_frees()<<std::endl;
+    for (uint64_t i = 0; i < groups_.size(); i++) {
+        std::cout<<"Group "<<i<<" owner = "
+            <<owner_slot(*groups_[i]).load()<<std::endl;
+        if (groups_[i]->bitmap->print_stats() !=
+                BLK_ALLOCATOR_STATUS_SUCCESS) {
+            status = BLK_ALLOCATOR_STATUS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+dss_blk_allocator_status_t AllocGroups::get_frag_stats(
+        dss_blk_allocator_frag_stats_t& stats) {
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_SUCCESS;
+
+    // Only counters are read, safe from any thread
+    for (auto& g : groups_) {
+        if (g->bitmap->get_frag_stats(stats) !=
+                BLK_ALLOCATOR_STATUS_SUCCESS) {
+            status = BLK_ALLOCATOR_STATUS_ERROR;
+        }
+    }
+
+    return status;
+}
+
+void AllocGroups::set_size_class_regions(uint64_t region_blocks) {
+
+    for (auto& g : groups_) {
+        g->jso->set_size_class_regions(region_blocks);
+    }
+
+    return;
+}
+
+} // End AllocatorType namespace
@@ -0,0 +1,222 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "block_allocator.h"
+#include "bitmap_impl.h"
+#include <atomic>
+
+namespace AllocatorType {
+
+/*
+ * - This class splits the blocks managed by an allocator into
+ *   allocation groups, each a QwordVector64Cell with its own
+ *   judy seek optimizer over a contiguous slice of the blocks
+ * - Group boundaries are aligned to the cells held by one meta
+ *   block, so the on-disk bitmap is laid out exactly as with a
+ *   single QwordVector64Cell over all the blocks
+ * - A group is owned by the first thread modifying it. Only the
+ *   owner allocates from a group; frees from any other thread are
+ *   pushed on a lock-free queue and applied by the owner on its next
+ *   operation on the group
+ * - Allocations go to the group of the hint and spill to the group
+ *   with the most free blocks that the calling thread may use
+ * - With meta sync enabled all groups share a single owner, since
+ *   the io task orderer marks dirty meta without locking
+ */
+class AllocGroups : public BlockAlloc::Allocator {
+public:
+    // Constructor of the class
+    explicit AllocGroups(
+            BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer,
+            uint64_t total_blocks,
+            uint8_t bits_per_cell,
+            uint64_t num_block_states,
+            uint64_t block_alloc_meta_start_offset,
+            uint64_t logical_start_block_offset,
+            uint64_t logical_block_size,
+            uint64_t optimum_write_size,
+            uint64_t num_groups);
+
+    ~AllocGroups();
+
+    /**
+     * @return number of allocation groups actually created
+     */
+    uint64_t num_groups() const { return groups_.size(); }
+    /**
+     * @return number of blocks in every group but the last one
+     */
+    uint64_t group_blocks() const { return group_blocks_; }
+    /**
+     * @return total frees queued by non-owner threads so far
+     */
+    uint64_t deferred_frees() const { return deferred_frees_.load(); }
+    /**
+     * @brief Enables size class regions on the seek optimizer of
+     *        every group, see JudySeekOptimizer::set_size_class_regions
+     */
+    void set_size_class_regions(uint64_t region_blocks);
+
+    //BlockAlloc::Allocator API (concrete definitions)
+    void destroy() override;
+    uint64_t get_physical_size() override;
+    dss_blk_allocator_status_t is_block_free(
+            uint64_t block_index,
+            bool *is_free) override;
+    dss_blk_allocator_status_t get_block_state(
+            uint64_t block_index,
+            uint64_t *block_state) override;
+    dss_blk_allocator_status_t check_blocks_state(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t block_state,
+            uint64_t *scanned_index) override;
+    dss_blk_allocator_status_t set_blocks_state(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t state) override;
+    dss_blk_allocator_status_t clear_blocks(
+            uint64_t block_index,
+            uint64_t num_blocks) override;
+    dss_blk_allocator_status_t alloc_blocks_contig(
+            uint64_t state,
+            uint64_t hint_block_index,
+            uint64_t num_blocks,
+            uint64_t *allocated_start_block) override;
+    dss_blk_allocator_status_t translate_meta_to_drive_addr(
+            uint64_t meta_lba,
+            uint64_t meta_num_blocks,
+            uint64_t drive_smallest_block_size,
+            uint64_t logical_block_size,
+            uint64_t& drive_blk_addr,
+            uint64_t& drive_num_blocks) override;
+    dss_blk_allocator_status_t serialize_drive_data(
+            uint64_t drive_blk_addr,
+            uint64_t drive_num_blocks,
+            uint64_t drive_smallest_block_size,
+            void** serialized_drive_data,
+            uint64_t& serialized_len) override;
+    dss_blk_allocator_status_t load_meta_from_disk_data(
+            uint8_t *serialized_data,
+            uint64_t serialized_data_len,
+            uint64_t disk_read_offset) override;
+    dss_blk_allocator_status_t write_meta_to_file() override;
+    dss_blk_allocator_status_t print_stats() override;
+    dss_blk_allocator_status_t get_frag_stats(
+            dss_blk_allocator_frag_stats_t& stats) override;
+
+private:
+    // Range freed by a thread not owning the group
+    struct DeferredFree {
+        DeferredFree *next;
+        uint64_t block_index;
+        uint64_t num_blocks;
+    };
+
+    struct AllocGroup {
+        uint64_t start_block;
+        uint64_t num_blocks;
+        // Offset of the group bitmap from the start of the meta region
+        uint64_t meta_byte_offset;
+        BlockAlloc::JudySeekOptimizerSharedPtr jso;
+        std::shared_ptr<QwordVector64Cell> bitmap;
+        // Thread token of the owner, 0 till claimed
+        std::atomic<uint64_t> owner;
+        // Multi producer single consumer stack of deferred frees
+        std::atomic<DeferredFree *> pending_frees;
+    };
+
+    uint64_t logical_start_block_offset_;
+    uint64_t block_alloc_meta_start_offset_;
+    uint64_t total_blocks_;
+    uint64_t group_blocks_;
+    bool shared_owner_;
+    std::vector<std::unique_ptr<AllocGroup>> groups_;
+    std::atomic<uint64_t> deferred_frees_;
+
+    /**
+     * @brief Index of the group holding block_index, the last group
+     *        for blocks past the end so it reports the error
+     */
+    uint64_t group_of(uint64_t block_index) const;
+
+    /**
+     * @brief Owner slot consulted for a group
+     */
+    std::atomic<uint64_t>& owner_slot(AllocGroup& g) {
+        return shared_owner_ ? groups_[0]->owner : g.owner;
+    }
+
+    /**
+     * @brief Claim the group for the calling thread if unclaimed
+     *
+     * @return true if the calling thread owns the group
+     */
+    bool acquire(AllocGroup& g);
+
+    /**
+     * @brief Claim every group covering the range for the calling
+     *        thread and apply their queued frees
+     *
+     * @return true if the calling thread owns all of them
+     */
+    bool acquire_range(uint64_t block_index, uint64_t num_blocks);
+
+    /**
+     * @brief Allocate exactly at block_index a range crossing groups,
+     *        undoing the groups done so far if one of them fails
+     */
+    dss_blk_allocator_status_t alloc_blocks_at_span(
+            uint64_t state,
+            uint64_t block_index,
+            uint64_t num_blocks);
+
+    /**
+     * @return true if the calling thread owns the group
+     */
+    bool is_owner(AllocGroup& g);
+
+    /**
+     * @brief Queue a free on a group owned by another thread
+     */
+    void push_free(AllocGroup& g, uint64_t block_index, uint64_t num_blocks);
+
+    /**
+     * @brief Apply frees queued on the group, called by the owner
+     */
+    void drain_frees(AllocGroup& g);
+};
+
+} // End AllocatorType namespace
@@ -34,6 +34,11 @@
 #include "bitmap_impl.h"
 #include <stdint.h>
 #include <fstream>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace AllocatorType {
 
@@ -71,6 +76,97 @@ void QwordVector64Cell::set_cell(uint64_t index, uint8_t value) {
     return;
 }
 
+uint64_t QwordVector64Cell::find_first_mismatch(
+        uint64_t begin_cell,
+        uint64_t num_cells,
+        uint8_t value) const {
+
+    uint64_t end_cell = begin_cell + num_cells;
+    uint64_t cell = begin_cell;
+    uint64_t pattern = cell_ones_ * (value & read_cell_flag_);
+    uint64_t qword_index = 0;
+    uint64_t diff = 0;
+    int first_cell = 0;
+    int cells_in_qword = 0;
+
+    while (cell < end_cell) {
+        qword_index = cell / cells_per_qword_;
+        first_cell = cell % cells_per_qword_;
+
+#if defined(__AVX2__)
+        // Skip four matching qwords per compare on aligned runs
+        if (first_cell == 0) {
+            const __m256i pattern_v = _mm256_set1_epi64x(pattern);
+            uint64_t cells_per_vec = 4 * (uint64_t)cells_per_qword_;
+            while (cell + cells_per_vec <= end_cell) {
+                __m256i v = _mm256_loadu_si256(
+                        (const __m256i *)&data_[qword_index]);
+                __m256i eq = _mm256_cmpeq_epi64(v, pattern_v);
+                if (_mm256_movemask_epi8(eq) != -1) {
+                    // Locate the cell in the qword loop below
+                    break;
+                }
+                cell += cells_per_vec;
+                qword_index += 4;
+            }
+            if (cell >= end_cell) {
+                break;
+            }
+        }
+#endif
+
+        cells_in_qword = cells_per_qword_ - first_cell;
+        if (end_cell - cell < (uint64_t)cells_in_qword) {
+            cells_in_qword = end_cell - cell;
+        }
+        diff = (data_[qword_index] ^ pattern) &
+            qword_cell_mask(first_cell, cells_in_qword);
+        if (diff != 0) {
+            return (qword_index * cells_per_qword_) +
+                (__builtin_ctzll(diff) / bits_per_cell_);
+        }
+        cell += cells_in_qword;
+    }
+
+    return end_cell;
+}
+
+void QwordVector64Cell::fill_cells(
+        uint64_t begin_cell,
+        uint64_t num_cells,
+        uint8_t value) {
+
+    uint64_t end_cell = begin_cell + num_cells;
+    uint64_t cell = begin_cell;
+    uint64_t pattern = cell_ones_ * (value & read_cell_flag_);
+    uint64_t qword_index = 0;
+    uint64_t mask = 0;
+    int first_cell = 0;
+    int cells_in_qword = 0;
+
+    while (cell < end_cell) {
+        qword_index = cell / cells_per_qword_;
+        first_cell = cell % cells_per_qword_;
+        cells_in_qword = cells_per_qword_ - first_cell;
+        if (end_cell - cell < (uint64_t)cells_in_qword) {
+            cells_in_qword = end_cell - cell;
+        }
+        if (cells_in_qword == cells_per_qword_) {
+            // Whole qwords are written without reading them back
+            uint64_t num_qwords = (end_cell - cell) / cells_per_qword_;
+            std::fill(data_.begin() + qword_index,
+                    data_.begin() + qword_index + num_qwords, pattern);
+            cell += num_qwords * cells_per_qword_;
+            continue;
+        }
+        mask = qword_cell_mask(first_cell, cells_in_qword);
+        data_[qword_index] = (data_[qword_index] & ~mask) | (pattern & mask);
+        cell += cells_in_qword;
+    }
+
+    return;
+}
+
 void QwordVector64Cell::serialize_all(char* serialized) const {
     std::memcpy(serialized, data_.data(), data_.size() * sizeof(uint64_t));
     return;
@@ -122,32 +218,10 @@ bool QwordVector64Cell::seek_empty_cell_range(
         return false;  // Out of bounds
     }
 
-    int i = begin_cell / cells_per_qword_;  // Integer index containing the start bit
-    int j = (begin_cell % cells_per_qword_) * bits_per_cell_; // Position of n-bit val
-    uint64_t mask = 0;
-    mask |= read_cell_flag_;
-    uint64_t mask_shift = 0;
-    
-    // Check each n-bit value in the range
-    for (uint64_t k = 0; k < len; k += bits_per_cell_) { 
-        mask_shift = j * bits_per_cell_;
-        // Get the n-bits (cell-value) at the current position
-        uint64_t bits = data_[i] & (mask << mask_shift);
-        if (bits != 0) {
-            // Found non-zero n-bit value, return false
-            return false;
-        }
-        
-        // Move to the next cell
-        j = j + bits_per_cell_;
-        if (j == cells_per_qword_) {
-            i++;
-            j = 0;
-        }
-    }
-
-    // All cells in range are zero, retun true
-    return true;
+    // All cells in range are zero if no cell differs from free state
+    return find_first_mismatch(
+            begin_cell, len, DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) ==
+        begin_cell + len;
 }
 
 uint64_t QwordVector64Cell::get_physical_size() {
@@ -203,24 +277,35 @@ dss_blk_allocator_status_t QwordVector64Cell::check_blocks_state(
 
     uint64_t bmap_last_cell_id = cells_ + logical_start_block_offset_;
     uint64_t req_last_block_lb = block_index + num_blocks - 1;
+    uint64_t scan_end = block_index + num_blocks;
+    uint64_t mismatch_index = 0;
 
     if ((block_index > bmap_last_cell_id)
             || (req_last_block_lb > bmap_last_cell_id)) {
         return BLK_ALLOCATOR_STATUS_ERROR;
     }
 
-    if (block_index == 0) {
-        *scanned_index = 0;
-    } else {
-        *scanned_index = block_index - 1;
+    if (block_index < logical_start_block_offset_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
     }
 
-    for (uint64_t i=block_index; i<num_blocks; i++) {
-        if (get_cell_value(i) == block_state) {
-            *scanned_index = *scanned_index + 1;
-        } else {
-            break;
-        }
+    // Scan only cells present in the bitmap
+    if (scan_end > bmap_last_cell_id) {
+        scan_end = bmap_last_cell_id;
+    }
+
+    mismatch_index = logical_start_block_offset_ +
+        find_first_mismatch(
+            block_index - logical_start_block_offset_,
+            scan_end - block_index,
+            block_state);
+
+    // Last block in state, or block_index - 1 if none
+    if (block_index == 0) {
+        *scanned_index = mismatch_index;
+    } else {
+        *scanned_index = mismatch_index - 1;
     }
 
     return BLK_ALLOCATOR_STATUS_SUCCESS;
@@ -273,7 +358,7 @@ dss_blk_allocator_status_t QwordVector64Cell::set_blocks_state(
         #ifndef DSS_BUILD_CUNIT_DISABLE_MARK_DIRTY
         if(this->io_task_orderer_ != nullptr) {
             // mark dirty bitmap
-            this->io_task_orderer_->mark_dirty_meta(block_index, 1);
+            this->io_task_orderer_->mark_dirty_meta(block_index, 1, state);
         }
         #endif
         return BLK_ALLOCATOR_STATUS_SUCCESS;
@@ -301,7 +386,7 @@ dss_blk_allocator_status_t QwordVector64Cell::set_blocks_state(
     #ifndef DSS_BUILD_CUNIT_DISABLE_MARK_DIRTY
     if(this->io_task_orderer_ != nullptr) {
         // mark dirty bitmap
-        this->io_task_orderer_->mark_dirty_meta(block_index, 1);
+        this->io_task_orderer_->mark_dirty_meta(block_index, 1, state);
     }
     #endif
 
@@ -312,7 +397,6 @@ dss_blk_allocator_status_t QwordVector64Cell::clear_blocks(
         uint64_t block_index,
         uint64_t num_blocks) {
 
-    uint64_t iter_blk_id = 0;
     uint64_t bmap_last_cell_id = cells_ + logical_start_block_offset_;
     uint64_t req_last_block_lb = block_index + num_blocks - 1;
 
@@ -337,19 +421,18 @@ dss_blk_allocator_status_t QwordVector64Cell::clear_blocks(
         }
     }
 
-    // Store block index
-    iter_blk_id = block_index;
+    if (block_index < logical_start_block_offset_) {
+        assert(("ERROR", false));
+    }
 
     // Now proceed to represent state on bitmap
-    for (uint64_t i=0; i<num_blocks; i++ ) {
-        QwordVector64Cell::set_cell(
-                iter_blk_id, DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
-        iter_blk_id = iter_blk_id + 1;
-    }
+    fill_cells(block_index - logical_start_block_offset_,
+            num_blocks, DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
     #ifndef DSS_BUILD_CUNIT_DISABLE_MARK_DIRTY
     if(this->io_task_orderer_ != nullptr) {
         // mark dirty bitmap
-        this->io_task_orderer_->mark_dirty_meta(block_index, num_blocks);
+        this->io_task_orderer_->mark_dirty_meta(block_index, num_blocks,
+                DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
     }
     #endif
 
@@ -364,7 +447,6 @@ dss_blk_allocator_status_t QwordVector64Cell::alloc_blocks_contig(
         uint64_t *allocated_start_block) {
 
     uint64_t actual_allocated_lb = 0;
-    uint64_t iter_blk_id = 0;
     bool is_jso_allocable = false;
 
     uint64_t bmap_last_cell_id = cells_ + logical_start_block_offset_;
@@ -401,17 +483,18 @@ dss_blk_allocator_status_t QwordVector64Cell::alloc_blocks_contig(
         *allocated_start_block = actual_allocated_lb;
     }
 
-    iter_blk_id = actual_allocated_lb;
+    if (actual_allocated_lb < logical_start_block_offset_) {
+        assert(("ERROR", false));
+    }
 
     // Now proceed to represent state on bitmap
-    for (uint64_t i=0; i<num_blocks; i++ ) {
-        QwordVector64Cell::set_cell(iter_blk_id, state);
-        iter_blk_id = iter_blk_id + 1;
-    }
+    fill_cells(actual_allocated_lb - logical_start_block_offset_,
+            num_blocks, state);
     #ifndef DSS_BUILD_CUNIT_DISABLE_MARK_DIRTY
     if(this->io_task_orderer_ != nullptr) {
         // mark dirty bitmap
-        this->io_task_orderer_->mark_dirty_meta(actual_allocated_lb, num_blocks);
+        this->io_task_orderer_->mark_dirty_meta(actual_allocated_lb, num_blocks,
+                state);
     }
     #endif
 
@@ -658,8 +741,8 @@ dss_blk_allocator_status_t QwordVector64Cell::load_meta_from_disk_data(
     
     // Acquire the allocator type and deserialize range
     // Make sure range is within the bitmap
-    if (begin_word + num_words >= data_.size()) {
-        num_words = data_.size() - begin_word + 1;
+    if (begin_word + num_words > data_.size()) {
+        num_words = data_.size() - begin_word;
     }
     this->deserialize_range(
             begin_word,
@@ -759,6 +842,18 @@ dss_blk_allocator_status_t QwordVector64Cell::print_stats() {
     }
 }
 
+dss_blk_allocator_status_t QwordVector64Cell::get_frag_stats(
+        dss_blk_allocator_frag_stats_t& stats) {
+
+    if (jso_ == NULL) {
+        // Free extents are only tracked by the jso
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+    jso_->get_frag_stats(stats);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
 void QwordVector64Cell::print_range(uint64_t begin, uint64_t end) const {
     // Begin and end must account for logical_start_block_offset if present
     // As they are accounted again inside `get_cell_value` API
@@ -78,7 +78,9 @@ public:
             ((total_cells / cells_per_qword_) +
             ((total_cells % cells_per_qword_) ? 1 : 0)), 0),
           read_cell_flag_(
-                  0xff >> (BITS_PER_BYTE - bits_per_cell_))
+                  0xff >> (BITS_PER_BYTE - bits_per_cell_)),
+          cell_ones_(
+                  qword_cell_ones(bits_per_cell_, cells_per_qword_))
           {}
 
     ~QwordVector64Cell() {
@@ -174,6 +176,8 @@ public:
             uint64_t disk_read_offset) override;
     dss_blk_allocator_status_t write_meta_to_file() override;
     dss_blk_allocator_status_t print_stats() override;
+    dss_blk_allocator_status_t get_frag_stats(
+            dss_blk_allocator_frag_stats_t& stats) override;
 
 private:
     BlockAlloc::JudySeekOptimizerSharedPtr jso_;
@@ -186,6 +190,57 @@ private:
     int cells_per_qword_;
     std::vector<uint64_t> data_;
     uint64_t read_cell_flag_;
+    // qword with every cell set to 1, multiplied by a cell value
+    // to get a qword with every cell set to that value
+    uint64_t cell_ones_;
+
+    static uint64_t qword_cell_ones(
+            uint8_t bits_per_cell, int cells_per_qword) {
+        uint64_t ones = 0;
+        for (int i = 0; i < cells_per_qword; i++) {
+            ones |= 1ULL << (i * bits_per_cell);
+        }
+        return ones;
+    }
+
+    /**
+     * @brief Mask of `num_cells` cells from `first_cell` within a qword
+     */
+    uint64_t qword_cell_mask(int first_cell, int num_cells) const {
+        uint64_t width = (uint64_t)num_cells * bits_per_cell_;
+        uint64_t mask = (width >= BITS_PER_WORD) ?
+            UINT64_MAX : ((1ULL << width) - 1);
+        return mask << (first_cell * bits_per_cell_);
+    }
+
+    /**
+     * @brief Find the first cell in a range whose value differs
+     *        from `value`, comparing a whole qword of cells at a
+     *        time (four qwords with AVX2)
+     *
+     * @param begin_cell, cell index without logical start block offset
+     * @param num_cells, number of cells in range
+     * @param value, cell value to match
+     * @return index of the first differing cell, begin_cell + num_cells
+     *         if all cells in range hold `value`
+     */
+    uint64_t find_first_mismatch(
+            uint64_t begin_cell,
+            uint64_t num_cells,
+            uint8_t value) const;
+
+    /**
+     * @brief Set all cells in a range to `value` a qword at a time
+     *
+     * @param begin_cell, cell index without logical start block offset
+     * @param num_cells, number of cells in range
+     * @param value, cell value to set
+     */
+    void fill_cells(
+            uint64_t begin_cell,
+            uint64_t num_cells,
+            uint8_t value);
+
     /**
      * @brief Helper function for translate_meta_to_drive_addr
      * 
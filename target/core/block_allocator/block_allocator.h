@@ -42,6 +42,8 @@
 #include <memory>
 #include <functional>
 #include <vector>
+#include <chrono>
+#include <unordered_map>
 
 /**
  * This namespace includes all block allocator operations
@@ -107,7 +109,15 @@ public:
           logical_start_block_offset_(logical_start_block_offset),
           optimal_ssd_write_kb_(optimal_ssd_write_kb),
           jarr_free_lb_(NULL),
-          jarr_free_contig_len_(std::make_shared<Utilities::JudyHashMap>())
+          jarr_free_contig_len_(std::make_shared<Utilities::JudyHashMap>()),
+          size_class_region_blocks_(0),
+          num_regions_(0),
+          jarr_region_class_(NULL),
+          jarr_region_used_(NULL),
+          jarr_class_regions_(),
+          num_class_regions_(),
+          num_free_extents_(0),
+          free_extent_hist_()
     {
         // Perform setup operation based on the input to constructor
         if (!init()) {
@@ -126,6 +136,18 @@ public:
             std::cout<<"Seek optimizer free bytes = "
                 <<free_bytes<<std::endl;
         }
+        // Free size class region arrays
+        if (jarr_region_class_ != NULL) {
+            JudyLFreeArray(&jarr_region_class_, PJE0);
+        }
+        if (jarr_region_used_ != NULL) {
+            JudyLFreeArray(&jarr_region_used_, PJE0);
+        }
+        for (uint32_t i = 0; i < BLK_ALLOCATOR_NUM_SIZE_CLASSES; i++) {
+            if (jarr_class_regions_[i] != NULL) {
+                JudyLFreeArray(&jarr_class_regions_[i], PJE0);
+            }
+        }
         // Free judy hash map, `jarr_free_contig_len_`
         //jarr_free_contig_len_->delete_hashmap();
     }
@@ -163,8 +185,87 @@ public:
      */
     void print_map() const;
 
+    /**
+     * @brief Splits the blocks into regions of region_blocks. An
+     *        allocation that can not be placed at its hint is placed
+     *        in a region of its size class, a region is claimed by a
+     *        size class on first use and released once fully free.
+     *        Must be set before any allocation.
+     * @param region_blocks, blocks per region, 0 disables size classes
+     */
+    void set_size_class_regions(uint64_t region_blocks);
+
+    /**
+     * @brief Size class of an allocation of num_blocks
+     */
+    static uint32_t get_size_class(uint64_t num_blocks);
+
+    /**
+     * @brief Adds free extent histogram and size class region counts
+     *        to stats
+     */
+    void get_frag_stats(dss_blk_allocator_frag_stats_t& stats) const;
+
 private:
 
+    /**
+     * @brief Allocates num_blocks in a region of its size class,
+     *        claiming a region not used by any class if needed
+     * @param hint_lb, regions closest after hint_lb are tried first
+     * @param num_blocks, total blocks requested to be allocated
+     * @param[OUT] allocated_lb, start lb of the allocation
+     * @return boolean, `allocated_lb` only has meaning when true
+     */
+    bool allocate_size_class(const uint64_t& hint_lb,
+            const uint64_t& num_blocks, uint64_t& allocated_lb);
+
+    /**
+     * @brief First fit allocation of num_blocks inside region. Only
+     *        the largest size class may cross into following regions
+     *        that are free of other classes.
+     * @return boolean, `allocated_lb` only has meaning when true
+     */
+    bool allocate_in_region(const uint64_t& region,
+            const uint32_t& size_class,
+            const uint64_t& num_blocks, uint64_t& allocated_lb);
+
+    /**
+     * @brief Checks that an allocation of num_blocks may be placed at
+     *        hint_lb, multi block allocations are only placed at their
+     *        hint inside a region claimed by their own size class
+     */
+    bool is_hint_allowed(const uint64_t& hint_lb,
+            const uint64_t& num_blocks) const;
+
+    /**
+     * @brief Checks that no region in the lb range is claimed by
+     *        a class other than size_class
+     */
+    bool is_range_claimable(const uint64_t& lb,
+            const uint64_t& num_blocks,
+            const uint32_t& size_class) const;
+
+    /**
+     * @brief Claims the unclaimed regions of an lb range for size_class
+     */
+    void claim_regions(const uint64_t& lb,
+            const uint64_t& num_blocks, const uint32_t& size_class);
+
+    /**
+     * @brief Accounts allocated or freed blocks on their regions,
+     *        regions that become fully free are released
+     */
+    void account_regions(const uint64_t& lb,
+            const uint64_t& num_blocks, bool is_alloc);
+
+    // Blocks in region, the last region may be short
+    uint64_t get_region_len(const uint64_t& region) const;
+    // Blocks allocated in region
+    uint64_t get_region_used(const uint64_t& region) const;
+
+    // Histogram bucket of a free extent of len blocks
+    static uint32_t get_hist_bucket(uint64_t len);
+
     /**
      * @brief Checks if a current free chunk is mergable with its
      *        neighbors
@@ -319,6 +420,21 @@ private:
     uint64_t optimal_ssd_write_kb_;
     void *jarr_free_lb_;
     Utilities::JudyHashMapSharedPtr jarr_free_contig_len_;
+
+    // Size class regions
+    uint64_t size_class_region_blocks_;
+    uint64_t num_regions_;
+    // region -> size class + 1, for claimed regions
+    void *jarr_region_class_;
+    // region -> allocated blocks, for regions with allocations
+    void *jarr_region_used_;
+    // Claimed regions of each size class
+    void *jarr_class_regions_[BLK_ALLOCATOR_NUM_SIZE_CLASSES];
+    uint64_t num_class_regions_[BLK_ALLOCATOR_NUM_SIZE_CLASSES];
+
+    // Free extents by length, kept up to date on add/remove element
+    uint64_t num_free_extents_;
+    uint64_t free_extent_hist_[BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS];
 };
 
 using JudySeekOptimizerSharedPtr = std::shared_ptr<JudySeekOptimizer>;
@@ -519,10 +635,43 @@ public:
      * @brief print block allocator stats to standard out
      */
     virtual dss_blk_allocator_status_t print_stats()=0;
+    /**
+     * @brief Report free extent histogram and size class regions
+     *
+     * @param[out] stats zeroed by the caller, accumulated into
+     */
+    virtual dss_blk_allocator_status_t get_frag_stats(
+            dss_blk_allocator_frag_stats_t& stats)=0;
 };
 
 using AllocatorSharedPtr = std::shared_ptr<Allocator>;
 
+// Identifies a block of the allocation journal
+#define BA_JOURNAL_MAGIC (0x4c4e524a41425344ULL)
+
+/**
+ * On disk allocation journal record, `num_blocks` blocks starting
+ * at `lba` are in `state`
+ */
+typedef struct __attribute__((__packed__)) ba_journal_rec_s {
+    uint64_t lba;
+    uint32_t num_blocks;
+    uint32_t state;
+} ba_journal_rec_t;
+
+/**
+ * Header of an allocation journal block, records follow the header
+ */
+typedef struct __attribute__((__packed__)) ba_journal_hdr_s {
+    uint64_t magic;
+    // Sequence of the block, the journal slot is seq % journal size
+    uint64_t seq;
+    // Changes of all journal blocks up to ckpt_seq are in the bitmap
+    uint64_t ckpt_seq;
+    uint32_t num_recs;
+    uint32_t checksum;
+} ba_journal_hdr_t;
+
 /**
  * Concrete class for ordering Bitmap meta-data ordering
  */
@@ -543,16 +692,20 @@ public:
           jarr_dirty_meta_(nullptr),
           io_ranges_(max_dirty_segments, std::make_pair(0,0)),
           jarr_io_dev_guard_(nullptr)
-    {}
+    {
+        is_io_task_failed = IoTaskOrderer::get_io_task_failed;
+    }
 
     // Default destructor
     ~IoTaskOrderer() = default;
 
     /**
      * @brief API to indicate dirty meta from block allocator
+     * @param state, state the blocks were set to, recorded in the
+     *        journal
      */
     dss_blk_allocator_status_t mark_dirty_meta(
-            uint64_t lba, uint64_t num_blocks);
+            uint64_t lba, uint64_t num_blocks, uint64_t state);
 
     /**
      * @brief API to interface with KV-Translator layer to queue
@@ -570,6 +723,14 @@ public:
     dss_blk_allocator_status_t get_next_submit_meta_io_tasks(
             dss_io_task_t** io_task);
 
+    /**
+     * @brief - Number of IO tasks queued for meta sync that are not yet
+     *          handed out, held in an open group or waiting on overlap
+     */
+    uint64_t get_num_pending_meta_io_tasks() const {
+        return group_q_.size() + io_dev_guard_q_.size();
+    }
+
     /**
      * @brief - API to interface with KV-Translator layer to mark
      *          completed IO.
@@ -579,11 +740,85 @@ public:
     dss_blk_allocator_status_t complete_meta_sync(
             dss_io_task_t* io_task);
 
+    /**
+     * @brief Default io task status lookup on meta sync completion
+     * @return true if any op of the io task failed
+     */
+    static bool get_io_task_failed(dss_io_task_t* io_task);
+
     // Getter for io device reference
     dss_device_t** get_io_device() {
         return &io_device_;
     }
 
+    /**
+     * @brief Enable group commit of dirty meta. IO tasks queued for
+     *        meta sync are held till `max_reqs` tasks are queued or the
+     *        oldest one waited `window_us`, then the dirty meta of the
+     *        whole group is written by the first task and all tasks of
+     *        the group complete together
+     * @param max_reqs, tasks per group, 0 or 1 disables group commit
+     * @param window_us, max time the first task of a group is held
+     */
+    void set_group_commit(uint64_t max_reqs, uint64_t window_us) {
+        group_max_reqs_ = max_reqs;
+        group_window_us_ = window_us;
+    }
+
+    /**
+     * @brief Persist allocations as records appended to a journal
+     *        instead of rewriting the bitmap on every meta sync. The
+     *        dirty bitmap is written in place as a checkpoint once a
+     *        quarter of the journal is used
+     * @param start_block, first drive block of the journal region
+     * @param num_blocks, journal size in blocks
+     * @param max_ranges, max disjoint ranges a checkpoint can write
+     * @return dss_blk_allocator_status_t BLK_ALLOCATOR_STATUS_SUCCESS
+     *         on success, BLK_ALLOCATOR_STATUS_INVALID_BLOCK_RANGE if
+     *         the region is too small for a checkpoint every quarter
+     */
+    dss_blk_allocator_status_t set_journal(
+            uint64_t start_block,
+            uint64_t num_blocks,
+            uint64_t max_ranges);
+
+    /**
+     * @brief Parse the journal region read from disk
+     *
+     * @param data, whole journal region
+     * @param data_len, length of data in bytes
+     * @param[out] recs, records not covered by the last checkpoint,
+     *             in the order they were written
+     * @return dss_blk_allocator_status_t BLK_ALLOCATOR_STATUS_SUCCESS
+     *         on success or error code otherwise
+     */
+    dss_blk_allocator_status_t load_journal(
+            const uint8_t *data,
+            uint64_t data_len,
+            std::vector<ba_journal_rec_t>& recs);
+
+    /**
+     * @brief Changes applied while replaying are only marked dirty
+     *        for the next checkpoint, they are already in the journal
+     */
+    void set_replaying(bool replaying) {
+        replaying_ = replaying;
+    }
+
+    /**
+     * @brief Fill a journal block with header and records
+     *
+     * @param buf, journal block of `block_size` bytes
+     * @return number of records from `recs` that fit in the block
+     */
+    static uint32_t format_journal_block(
+            void *buf,
+            uint64_t block_size,
+            uint64_t seq,
+            uint64_t ckpt_seq,
+            const ba_journal_rec_t *recs,
+            uint64_t num_recs);
+
     /**
      * Allocator specific translator implementation
      */
@@ -607,8 +842,39 @@ public:
             uint64_t& serialized_len)>
         serialize_drive_data;
 
+    /**
+     * Allocator specific block state lookup, used to rebuild journal
+     * records of failed journal writes
+     */
+    std::function<dss_blk_allocator_status_t(
+            uint64_t block_index,
+            uint64_t *block_state)>
+        get_block_state;
+
+    /**
+     * Io task status lookup on meta sync completion, meta written by a
+     * failed task is marked dirty again
+     */
+    std::function<bool(dss_io_task_t* io_task)> is_io_task_failed;
+
 private:
 
+    /**
+     * @brief Journal state of an io task queued for meta sync
+     */
+    struct JournalTask {
+        std::vector<ba_journal_rec_t> recs;
+        // Journal blocks added to the io task
+        bool is_written = false;
+        // Checkpoint value in the journal block headers of the task
+        uint64_t hdr_ckpt_seq = 0;
+        // First task recording a new checkpoint
+        bool is_publisher = false;
+        // Task also writes the dirty bitmap up to ckpt_seq
+        bool is_ckpt = false;
+        uint64_t ckpt_seq = 0;
+    };
+
     /**
      * @brief API to remove dirty meta range from
      *        jarr_dirty_meta_ (judy array)
@@ -679,10 +945,28 @@ private:
      * @param[out] io_ranges, lb-len tuple or dirty meta-data to be added
      *             to io_task
      * @param[out] num_ranges, total dirty tuples 
+     * @param is_failed, completed task failed, records of its journal
+     *        blocks are queued again before the buffers are freed
      */
     void populate_io_ranges(dss_io_task_t* io_task,
             std::vector<std::pair<uint64_t,uint64_t>>& io_ranges,
-            uint64_t& num_ranges, bool is_completion);
+            uint64_t& num_ranges, bool is_completion,
+            bool is_failed = false);
+
+    /**
+     * @brief Check if a drive block is in the journal region
+     */
+    bool is_journal_block(uint64_t drive_lba) const {
+        return journal_num_blocks_ > 0 &&
+            drive_lba >= journal_start_block_ &&
+            drive_lba < journal_start_block_ + journal_num_blocks_;
+    }
+
+    /**
+     * @brief Queue the records of a journal block that was not written
+     *        for the journal blocks of the next io-task
+     */
+    void requeue_journal_block(const void *buf);
 
     /**
      * @brief API to check IO range overlap with current in-flight IO range
@@ -758,6 +1042,54 @@ private:
             const std::vector<std::pair<uint64_t, uint64_t>>& io_ranges,
             const uint64_t& num_ranges);
 
+    /**
+     * @brief Add all dirty meta ranges as write ops to the io-task and
+     *        reset the dirty meta ranges
+     *
+     * @param io_task, task that persists the dirty meta
+     */
+    void add_dirty_meta_to_task(dss_io_task_t* io_task);
+
+    /**
+     * @brief Add all dirty bitmap ranges as write ops to the io-task
+     *        and reset the dirty bitmap ranges
+     */
+    void add_dirty_bitmap_to_task(dss_io_task_t* io_task);
+
+    /**
+     * @brief Record a block state change for the journal records of
+     *        the next queued io-task, merged with the previous change
+     *        when contiguous and in the same state
+     */
+    void add_journal_pending(
+            uint64_t lba, uint64_t num_blocks, uint64_t state);
+
+    /**
+     * @brief Move the block state changes since the last queued
+     *        io-task to journal records of the io-task
+     */
+    void add_journal_recs_to_task(dss_io_task_t* io_task);
+
+    /**
+     * @brief Add journal block writes of the io-task on submission, and
+     *        the bitmap checkpoint if due
+     * @return false if the journal slots are not free till the
+     *         checkpoint in flight completes
+     */
+    bool add_journal_blocks_to_task(dss_io_task_t* io_task);
+
+    /**
+     * @brief Advance the journal checkpoint on io-task completion. A
+     *        failed io-task releases its checkpoint without advancing
+     */
+    void complete_journal_task(dss_io_task_t* io_task, bool is_failed);
+
+    /**
+     * @brief Write dirty meta with the first task of the pending group
+     *        and move the group to `io_dev_guard_q_`
+     */
+    void seal_group();
+
     // Class specific variables
     uint64_t drive_smallest_block_size_;
     uint64_t logical_block_size_;
@@ -767,6 +1099,28 @@ private:
     std::vector<std::pair<uint64_t, uint64_t>> io_ranges_;
     void *jarr_io_dev_guard_;
     std::vector<dss_io_task_t *> io_dev_guard_q_;
+    // Group commit
+    uint64_t group_max_reqs_ = 1;
+    uint64_t group_window_us_ = 0;
+    std::vector<dss_io_task_t *> group_q_;
+    std::chrono::steady_clock::time_point group_start_;
+    // Allocation journal, disabled with 0 blocks
+    uint64_t journal_start_block_ = 0;
+    uint64_t journal_num_blocks_ = 0;
+    // Sequence of the next journal block, starts at 1
+    uint64_t journal_next_seq_ = 1;
+    // Last journal block whose changes are written to the bitmap
+    uint64_t journal_ckpt_seq_ = 0;
+    // Last checkpoint recorded in a completed journal block, slots
+    // up to this one can be reused
+    uint64_t journal_published_ckpt_seq_ = 0;
+    bool journal_ckpt_in_flight_ = false;
+    // A task recording a new checkpoint is in flight
+    bool journal_publishing_ = false;
+    bool replaying_ = false;
+    // Block state changes since the last queued io task, in order
+    std::vector<ba_journal_rec_t> journal_pending_;
+    std::unordered_map<dss_io_task_t *, JournalTask> journal_tasks_;
 };
 
 using IoTaskOrdererSharedPtr = std::shared_ptr<IoTaskOrderer>;
@@ -855,6 +1209,15 @@ public:
             dss_blk_allocator_context_t *ctx,
             dss_io_task_t **io_task);
 
+    /**
+     * @brief Number of meta sync IO tasks queued but not yet handed out
+     *
+     * @param ctx block allocator context
+     * @return uint64_t number of pending tasks, 0 without io ordering
+     */
+    uint64_t get_num_pending_meta_io_tasks(
+            dss_blk_allocator_context_t *ctx);
+
     /**
      * @brief Update block allocator of meta IO completion
      *
@@ -895,6 +1258,21 @@ public:
             dss_blk_allocator_context_t *ctx,
             dss_io_task_t *io_task);
 
+    /**
+     * @brief Replay the allocation journal over the bitmap loaded from
+     *        disk
+     *
+     * @param serialized_data, whole journal region read from disk
+     * @param serialized_data_len, length of serialized_data in bytes
+     * @param[out] num_records, number of records replayed
+     * @return dss_blk_allocator_status_t BLK_ALLOCATOR_STATUS_SUCCESS on
+     *         success or error code otherwise
+     */
+    dss_blk_allocator_status_t load_journal_from_disk_data(
+            uint8_t *serialized_data,
+            uint64_t serialized_data_len,
+            uint64_t *num_records);
+
     AllocatorSharedPtr allocator;
     IoTaskOrdererSharedPtr io_task_orderer;
 };
@@ -33,6 +33,8 @@
 
 #include "block_allocator.h"
 #include "bitmap_impl.h"
+#include "alloc_group_impl.h"
+#include "extent_tree_impl.h"
 
 namespace BlockAlloc {
 
@@ -81,15 +83,6 @@ bool BlockAllocator::init(
         return false;
     }
 
-    // CXX: Check if judy seek optimizer is optional
-    // Check if the config indicates any other type of allocator
-    BlockAlloc::JudySeekOptimizerSharedPtr jso =
-        std::make_shared<BlockAlloc::JudySeekOptimizer>
-        (total_blocks, logical_start_block_offset, optimum_write_size);
-    if (jso == NULL) {
-        return false;
-    }
-
     // Currently only bitmap allocator is supported
     if (num_block_states <= 16) {
         // Currently only 4 bits per cell/block are represented in the bitmap
@@ -110,20 +103,71 @@ bool BlockAllocator::init(
         {
             return false;
         }
+        io_task_orderer->set_group_commit(
+                config->meta_sync_group_max_reqs,
+                config->meta_sync_group_window_us);
     }
 
     // Concrete definition of the allocator
-    // CXX TODO: Config should be parsed to arrive at a specific
-    //           allocator type. However, only 1 type of allocator
-    //           is supported for now.
-    this->allocator = std::make_shared<AllocatorType::QwordVector64Cell>(
-            jso,
-            this->io_task_orderer,
-            total_blocks,
-            num_bits_per_block,
-            num_block_states + 1,
-            block_alloc_meta_start_offset,
-            logical_start_block_offset);
+    if (config->backend == BLK_ALLOCATOR_BACKEND_EXTENT_TREE) {
+        // Block states kept as extents, free extents on the judy
+        // seek optimizer
+        if (config->num_alloc_groups > 1) {
+            DSS_NOTICELOG("Extent tree allocator ignores %lu alloc groups\n",
+                    config->num_alloc_groups);
+        }
+        BlockAlloc::JudySeekOptimizerSharedPtr jso =
+            std::make_shared<BlockAlloc::JudySeekOptimizer>
+            (total_blocks, logical_start_block_offset, optimum_write_size);
+        if (jso == NULL) {
+            return false;
+        }
+        jso->set_size_class_regions(config->size_class_region_blocks);
+
+        this->allocator = std::make_shared<AllocatorType::ExtentTree>(
+                jso,
+                this->io_task_orderer,
+                total_blocks,
+                num_bits_per_block,
+                num_block_states + 1,
+                block_alloc_meta_start_offset,
+                logical_start_block_offset);
+    } else if (config->num_alloc_groups > 1) {
+        // Bitmap split in allocation groups, each with its own
+        // judy seek optimizer
+        std::shared_ptr<AllocatorType::AllocGroups> groups =
+            std::make_shared<AllocatorType::AllocGroups>(
+                this->io_task_orderer,
+                total_blocks,
+                num_bits_per_block,
+                num_block_states + 1,
+                block_alloc_meta_start_offset,
+                logical_start_block_offset,
+                logical_block_size,
+                optimum_write_size,
+                config->num_alloc_groups);
+        groups->set_size_class_regions(config->size_class_region_blocks);
+        this->allocator = groups;
+    } else {
+        // CXX: Check if judy seek optimizer is optional
+        // Check if the config indicates any other type of allocator
+        BlockAlloc::JudySeekOptimizerSharedPtr jso =
+            std::make_shared<BlockAlloc::JudySeekOptimizer>
+            (total_blocks, logical_start_block_offset, optimum_write_size);
+        if (jso == NULL) {
+            return false;
+        }
+        jso->set_size_class_regions(config->size_class_region_blocks);
+
+        this->allocator = std::make_shared<AllocatorType::QwordVector64Cell>(
+                jso,
+                this->io_task_orderer,
+                total_blocks,
+                num_bits_per_block,
+                num_block_states + 1,
+                block_alloc_meta_start_offset,
+                logical_start_block_offset);
+    }
     if (allocator == NULL) {
         return false;
     }
@@ -166,10 +210,87 @@ bool BlockAllocator::init(
                 serialized_len);
         };
         DSS_ASSERT(this->io_task_orderer->serialize_drive_data);
+
+        if (config->journal_num_blocks > 0) {
+            // Bind the block state lookup for journal records
+            this->io_task_orderer->get_block_state =
+                [&](uint64_t block_index, uint64_t *block_state)
+            {
+                return this->allocator->get_block_state(
+                    block_index, block_state);
+            };
+
+            // A checkpoint can write every block of the bitmap region
+            if (this->io_task_orderer->set_journal(
+                    config->journal_start_block,
+                    config->journal_num_blocks,
+                    this->allocator->get_physical_size() /
+                        logical_block_size + 1 +
+                        config->journal_num_blocks) !=
+                    BLK_ALLOCATOR_STATUS_SUCCESS) {
+                // Journal region too small, fail rather than silently
+                // fall back to writing the bitmap on every meta sync
+                return false;
+            }
+        }
     }
     return true;
 }
 
+dss_blk_allocator_status_t BlockAllocator::load_journal_from_disk_data(
+        uint8_t *serialized_data,
+        uint64_t serialized_data_len,
+        uint64_t *num_records) {
+
+    std::vector<ba_journal_rec_t> recs;
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_SUCCESS;
+    uint64_t state = 0;
+
+    *num_records = 0;
+    if (!this->io_task_orderer) {
+        // Journal is only written with ba meta sync
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+
+    status = this->io_task_orderer->load_journal(
+            serialized_data, serialized_data_len, recs);
+    if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+        return status;
+    }
+
+    // Records are applied in the order written over the loaded bitmap
+    this->io_task_orderer->set_replaying(true);
+    for (size_t i=0; i<recs.size(); i++) {
+        uint64_t end_lba = recs[i].lba + recs[i].num_blocks;
+
+        for (uint64_t lba=recs[i].lba; lba<end_lba; lba++) {
+            status = this->allocator->get_block_state(lba, &state);
+            if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+                break;
+            }
+            if (state == recs[i].state) {
+                continue;
+            }
+            if (recs[i].state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) {
+                status = this->allocator->clear_blocks(lba, 1);
+            } else {
+                status = this->allocator->set_blocks_state(
+                        lba, 1, recs[i].state);
+            }
+            if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+                break;
+            }
+        }
+        if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            break;
+        }
+    }
+    this->io_task_orderer->set_replaying(false);
+
+    *num_records = recs.size();
+    return status;
+}
+
 dss_blk_allocator_status_t BlockAllocator::queue_sync_meta_io_tasks(
                      dss_blk_allocator_context_t *ctx,
                      dss_io_task_t *io_task) {
@@ -194,6 +315,16 @@ dss_blk_allocator_status_t BlockAllocator::get_next_submit_meta_io_tasks(
     }
 }
 
+uint64_t BlockAllocator::get_num_pending_meta_io_tasks(
+                     dss_blk_allocator_context_t *ctx) {
+
+    if(this->io_task_orderer) {
+        return this->io_task_orderer->get_num_pending_meta_io_tasks();
+    } else {
+        return 0;
+    }
+}
+
 dss_blk_allocator_status_t BlockAllocator::complete_meta_sync(
                      dss_blk_allocator_context_t *ctx,
                      dss_io_task_t *io_task) {
@@ -269,6 +269,23 @@ dss_blk_allocator_status_t print_stats(
     return ba_i->allocator->print_stats();
 }
 
+dss_blk_allocator_status_t get_frag_stats(
+        dss_blk_allocator_context_t *ctx,
+        dss_blk_allocator_frag_stats_t *stats) {
+
+    DSS_ASSERT(!strcmp(ctx->m->name, block_allocator_name));
+    dss_blk_alloc_impresario_ctx_t *c =
+        (dss_blk_alloc_impresario_ctx_t *)ctx;
+
+    BlockAlloc::BlockAllocator *ba_i = c->impresario_instance;
+    if (ba_i == NULL || stats == NULL) {
+        DSS_ERRLOG("Incorrect usage before block allocator init");
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+    memset(stats, 0, sizeof(*stats));
+    return ba_i->allocator->get_frag_stats(*stats);
+}
+
 dss_blk_allocator_status_t queue_sync_meta_io_tasks(
                      dss_blk_allocator_context_t *ctx,
                      dss_io_task_t *io_task) {
@@ -305,6 +322,23 @@ dss_blk_allocator_status_t get_next_submit_meta_io_tasks(
     return ba_i->get_next_submit_meta_io_tasks(ctx, io_task);
 }
 
+uint64_t get_num_pending_meta_io_tasks(
+        dss_blk_allocator_context_t *ctx) {
+
+    DSS_ASSERT(!strcmp(ctx->m->name, block_allocator_name));
+
+    dss_blk_alloc_impresario_ctx_t *c =
+        (dss_blk_alloc_impresario_ctx_t *)ctx;
+
+    BlockAlloc::BlockAllocator *ba_i = c->impresario_instance;
+    if (ba_i == NULL) {
+        DSS_ERRLOG("Incorrect usage before block allocator init");
+        return 0;
+    }
+
+    return ba_i->get_num_pending_meta_io_tasks(ctx);
+}
+
 dss_blk_allocator_status_t complete_meta_sync(
         dss_blk_allocator_context_t *ctx,
         dss_io_task_t *io_task) {
@@ -345,6 +379,28 @@ dss_blk_allocator_status_t load_meta_from_disk_data(
             serialized_data, serialized_data_len, disk_read_offset);
 }
 
+dss_blk_allocator_status_t load_journal_from_disk_data(
+        dss_blk_allocator_context_t *ctx,
+        uint8_t *serialized_data,
+        uint64_t serialized_data_len,
+        uint64_t *num_records
+        ) {
+
+    DSS_ASSERT(!strcmp(ctx->m->name, block_allocator_name));
+
+    dss_blk_alloc_impresario_ctx_t *c =
+        (dss_blk_alloc_impresario_ctx_t *)ctx;
+
+    BlockAlloc::BlockAllocator *ba_i = c->impresario_instance;
+    if (ba_i == NULL) {
+        DSS_ERRLOG("Incorrect usage before block allocator init");
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    return ba_i->load_journal_from_disk_data(
+            serialized_data, serialized_data_len, num_records);
+}
+
 } // End namespace BlockInterface
 
 /**
@@ -362,7 +418,8 @@ struct dss_blk_alloc_module_s dss_block_impresario = {
         .clear_blocks = BlockInterface::clear_blocks,
         .alloc_blocks_contig = BlockInterface::alloc_blocks_contig,
         .write_meta_to_file = BlockInterface::write_meta_to_file,
-        .print_stats = BlockInterface::print_stats
+        .print_stats = BlockInterface::print_stats,
+        .get_frag_stats = BlockInterface::get_frag_stats
     },
     .disk = {
         .blk_alloc_get_physical_size =
@@ -371,9 +428,13 @@ struct dss_blk_alloc_module_s dss_block_impresario = {
             BlockInterface::queue_sync_meta_io_tasks,
         .blk_alloc_get_next_submit_meta_io_tasks =
             BlockInterface::get_next_submit_meta_io_tasks,
+        .blk_alloc_get_num_pending_meta_io_tasks =
+            BlockInterface::get_num_pending_meta_io_tasks,
         .blk_alloc_complete_meta_sync =
             BlockInterface::complete_meta_sync,
         .blk_alloc_load_meta_from_disk_data =
-            BlockInterface::load_meta_from_disk_data
+            BlockInterface::load_meta_from_disk_data,
+        .blk_alloc_load_journal_from_disk_data =
+            BlockInterface::load_journal_from_disk_data
     }
 };
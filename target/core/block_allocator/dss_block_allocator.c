@@ -47,6 +47,9 @@ DSS_BLOCK_ALLOCATOR_REGISTER(block_impresario, &dss_block_impresario);
 #define BLK_ALLOCATOR_DEFAULT_DISK_BLOCK_SIZE (4096)
 #define BLK_ALLOCATOR_DEFAULT_RESVD_BLOCKS (0)
 #define BLK_ALLOCATOR_DEFAULT_RSVD_START_BLOCK_INDEX (-1)
+#define BLK_ALLOCATOR_DEFAULT_NUM_ALLOC_GROUPS (1)
+#define BLK_ALLOCATOR_DEFAULT_META_SYNC_GROUP_MAX_REQS (1)
+#define BLK_ALLOCATOR_DEFAULT_META_SYNC_GROUP_WINDOW_US (50)
 
 
 struct dss_blk_alloc_mgr_s {
@@ -86,13 +89,16 @@ void dss_block_allocator_add_module(dss_blk_alloc_module_t *m)
     DSS_ASSERT(m->core.alloc_blocks_contig);
     //Optional to implement: m->core.write_meta_to_file
     //Optional to implement: m->core.print_stats
+    //Optional to implement: m->core.get_frag_stats
     DSS_ASSERT(m->core.clear_blocks);
 
     //On-Disk functions
     DSS_ASSERT(m->disk.blk_alloc_get_physical_size);
     DSS_ASSERT(m->disk.blk_alloc_queue_sync_meta_io_tasks);
     //Optional to implement: DSS_ASSERT(m->disk.blk_alloc_get_next_submit_meta_io_tasks);
+    //Optional to implement: DSS_ASSERT(m->disk.blk_alloc_get_num_pending_meta_io_tasks);
     //Optional to implement: DSS_ASSERT(m->disk.blk_alloc_load_meta_from_disk_data);
+    //Optional to implement: DSS_ASSERT(m->disk.blk_alloc_load_journal_from_disk_data);
     DSS_ASSERT(m->disk.blk_alloc_complete_meta_sync);
 
     TAILQ_INSERT_TAIL(&g_blk_alloc_mgr.blk_alloc_modules, m, module_list_link);
@@ -175,6 +181,13 @@ void dss_blk_allocator_set_default_config(dss_device_t *device, dss_blk_allocato
     opts->d.reserved_data_blocks_start_index = BLK_ALLOCATOR_DEFAULT_RSVD_START_BLOCK_INDEX;
     opts->d.reserved_data_blocks = BLK_ALLOCATOR_DEFAULT_RESVD_BLOCKS;
     opts->enable_ba_meta_sync = false;
+    opts->num_alloc_groups = BLK_ALLOCATOR_DEFAULT_NUM_ALLOC_GROUPS;
+    opts->meta_sync_group_max_reqs = BLK_ALLOCATOR_DEFAULT_META_SYNC_GROUP_MAX_REQS;
+    opts->meta_sync_group_window_us = BLK_ALLOCATOR_DEFAULT_META_SYNC_GROUP_WINDOW_US;
+    opts->journal_start_block = 0;
+    opts->journal_num_blocks = 0;
+    opts->backend = BLK_ALLOCATOR_BACKEND_BITMAP;
+    opts->size_class_region_blocks = 0;
 
     return;
 }
@@ -205,6 +218,21 @@ dss_blk_allocator_status_t dss_blk_allocator_load_meta_from_disk_data(
             ctx, serialized_data, serialized_data_len, disk_read_offset);
 }
 
+dss_blk_allocator_status_t dss_blk_allocator_load_journal_from_disk_data(
+        dss_blk_allocator_context_t *ctx,
+        uint8_t *serialized_data,
+        uint64_t serialized_data_len,
+        uint64_t *num_records) {
+
+    *num_records = 0;
+    if (!ctx->m->disk.blk_alloc_load_journal_from_disk_data) {
+        // Allocator does not journal, nothing to replay
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+    return ctx->m->disk.blk_alloc_load_journal_from_disk_data(
+            ctx, serialized_data, serialized_data_len, num_records);
+}
+
 dss_blk_allocator_status_t dss_blk_allocator_is_block_free(dss_blk_allocator_context_t* ctx, uint64_t block_index, bool *is_free)
 {
     DSS_ASSERT(ctx->m->core.is_block_free);
@@ -325,6 +353,16 @@ dss_blk_allocator_status_t dss_blk_allocator_print_stats(dss_blk_allocator_conte
     }
 }
 
+dss_blk_allocator_status_t dss_blk_allocator_get_frag_stats(dss_blk_allocator_context_t *ctx, dss_blk_allocator_frag_stats_t *stats)
+{
+    // This could be optional
+    if (ctx->m->core.get_frag_stats != NULL) {
+        return ctx->m->core.get_frag_stats(ctx, stats);
+    } else {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+}
+
 uint64_t dss_blk_allocator_get_physical_size(dss_blk_allocator_opts_t *config) {
     dss_blk_allocator_context_t *c = NULL;
     dss_blk_alloc_module_t *m;
@@ -372,6 +410,16 @@ dss_blk_allocator_status_t dss_blk_allocator_get_next_submit_meta_io_tasks(dss_b
     return ctx->m->disk.blk_alloc_get_next_submit_meta_io_tasks(ctx, io_task);
 }
 
+uint64_t dss_blk_allocator_get_num_pending_meta_io_tasks(dss_blk_allocator_context_t *ctx)
+{
+    // This could be optional
+    if (ctx->m->disk.blk_alloc_get_num_pending_meta_io_tasks != NULL) {
+        return ctx->m->disk.blk_alloc_get_num_pending_meta_io_tasks(ctx);
+    } else {
+        return 0;
+    }
+}
+
 dss_blk_allocator_status_t dss_blk_allocator_complete_meta_sync(dss_blk_allocator_context_t *ctx, dss_io_task_t *io_task)
 {
     DSS_ASSERT(ctx->m->disk.blk_alloc_complete_meta_sync);
@@ -53,6 +53,7 @@ typedef dss_blk_allocator_status_t (*clear_blocks_fn)(dss_blk_allocator_context_
 typedef dss_blk_allocator_status_t (*alloc_blocks_contig_fn)(dss_blk_allocator_context_t *ctx, uint64_t state, uint64_t hint_block_index, uint64_t num_blocks, uint64_t *allocated_start_block);
 typedef dss_blk_allocator_status_t (*write_meta_to_file_fn)(dss_blk_allocator_context_t *ctx);
 typedef dss_blk_allocator_status_t (*print_stats_fn)(dss_blk_allocator_context_t *ctx);
+typedef dss_blk_allocator_status_t (*get_frag_stats_fn)(dss_blk_allocator_context_t *ctx, dss_blk_allocator_frag_stats_t *stats);
 typedef void (*blk_alloc_destroy_fn)(dss_blk_allocator_context_t *ctx);
 
 /**
@@ -70,14 +71,18 @@ typedef struct dss_blk_alloc_core_ops_s {
         alloc_blocks_contig_fn alloc_blocks_contig;
         write_meta_to_file_fn write_meta_to_file; //Debug API
         print_stats_fn print_stats;
+        get_frag_stats_fn get_frag_stats; //Optional to implement in allocator
 } dss_blk_alloc_core_ops_t;
 
 typedef dss_blk_allocator_status_t (*blk_alloc_queue_sync_meta_io_tasks_fn)(dss_blk_allocator_context_t *ctx, dss_io_task_t *io_task);
 typedef dss_blk_allocator_status_t (*blk_alloc_get_next_submit_meta_io_tasks_fn)(dss_blk_allocator_context_t *ctx, dss_io_task_t **io_task);
+typedef uint64_t (*blk_alloc_get_num_pending_meta_io_tasks_fn)(dss_blk_allocator_context_t *ctx);
 typedef dss_blk_allocator_status_t (*blk_alloc_complete_meta_sync_fn)(dss_blk_allocator_context_t *ctx, dss_io_task_t *io_task);
 typedef uint64_t (*blk_alloc_get_physical_size_fn)(dss_blk_allocator_opts_t *config);
 typedef dss_blk_allocator_status_t (*blk_alloc_load_meta_from_disk_data_fn)(
         dss_blk_allocator_context_t *ctx, uint8_t *serial_data, uint64_t serial_len, uint64_t disk_read_offset);
+typedef dss_blk_allocator_status_t (*blk_alloc_load_journal_from_disk_data_fn)(
+        dss_blk_allocator_context_t *ctx, uint8_t *serial_data, uint64_t serial_len, uint64_t *num_records);
 
 /**
  * @brief disk operation implementaions needed to support persisting block allocator state
@@ -87,8 +92,10 @@ typedef struct dss_blk_alloc_disk_ops_s {
     blk_alloc_get_physical_size_fn blk_alloc_get_physical_size;
     blk_alloc_queue_sync_meta_io_tasks_fn blk_alloc_queue_sync_meta_io_tasks;
     blk_alloc_get_next_submit_meta_io_tasks_fn blk_alloc_get_next_submit_meta_io_tasks;
+    blk_alloc_get_num_pending_meta_io_tasks_fn blk_alloc_get_num_pending_meta_io_tasks;
     blk_alloc_complete_meta_sync_fn blk_alloc_complete_meta_sync;
     blk_alloc_load_meta_from_disk_data_fn blk_alloc_load_meta_from_disk_data;
+    blk_alloc_load_journal_from_disk_data_fn blk_alloc_load_journal_from_disk_data;
 } dss_blk_alloc_disk_ops_t;
 
 /**
@@ -342,7 +342,8 @@ static struct dss_blk_alloc_module_s dss_simbmap_allocator = {
         .set_blocks_state = dss_blk_allocator_simbmap_set_blocks_state,
         .clear_blocks = dss_blk_allocator_simbmap_clear_blocks,
         .alloc_blocks_contig = dss_blk_allocator_simbmap_alloc_blocks_contig,
-        .print_stats = NULL
+        .print_stats = NULL,
+        .get_frag_stats = NULL
     },
     .disk = {
         .blk_alloc_get_physical_size = dss_blk_allocator_simbmap_get_physical_size,
@@ -0,0 +1,789 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "extent_tree_impl.h"
+#include "bitmap_impl.h"
+#include <stdint.h>
+#include <fstream>
+#include <algorithm>
+
+namespace AllocatorType {
+
+/**
+ * @brief Set `num_cells` cells from `begin_cell` to `value` in a
+ *        serialized bitmap, a qword at a time where possible
+ */
+static void fill_serialized_cells(
+        uint64_t *qwords,
+        uint64_t begin_cell,
+        uint64_t num_cells,
+        uint64_t value,
+        uint8_t bits_per_cell,
+        uint64_t cells_per_qword) {
+
+    uint64_t cell_flag = (1ULL << bits_per_cell) - 1;
+    uint64_t all_cells = 0;
+    uint64_t cell = begin_cell;
+    uint64_t end_cell = begin_cell + num_cells;
+
+    for (uint64_t i = 0; i < cells_per_qword; i++) {
+        all_cells |= (value & cell_flag) << (i * bits_per_cell);
+    }
+
+    while (cell < end_cell) {
+        if ((cell % cells_per_qword == 0) &&
+                (end_cell - cell >= cells_per_qword)) {
+            qwords[cell / cells_per_qword] = all_cells;
+            cell += cells_per_qword;
+            continue;
+        }
+        qwords[cell / cells_per_qword] |= (value & cell_flag) <<
+            ((cell % cells_per_qword) * bits_per_cell);
+        cell++;
+    }
+}
+
+ExtentTree::ExtentTree(
+        BlockAlloc::JudySeekOptimizerSharedPtr jso,
+        BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer,
+        uint64_t total_blocks,
+        uint8_t bits_per_cell,
+        uint64_t num_block_states,
+        uint64_t block_alloc_meta_start_offset,
+        uint64_t logical_start_block_offset)
+    : jso_(std::move(jso)),
+      io_task_orderer_(io_task_orderer),
+      total_blocks_(total_blocks),
+      bits_per_cell_(
+        ((bits_per_cell > BITS_PER_WORD) || (bits_per_cell == 0))?
+        BITS_PER_WORD : bits_per_cell),
+      num_block_states_(num_block_states),
+      block_alloc_meta_start_offset_(block_alloc_meta_start_offset),
+      logical_start_block_offset_(logical_start_block_offset),
+      cells_per_qword_(BITS_PER_WORD / bits_per_cell_),
+      jarr_state_extents_(NULL),
+      num_extents_(0)
+{
+    // States must fit the low bits of an extent value
+    DSS_ASSERT(num_block_states_ <= EXTENT_STATE_MASK + 1);
+}
+
+ExtentTree::~ExtentTree() {
+    destroy();
+}
+
+void ExtentTree::destroy() {
+    if (jarr_state_extents_ != NULL) {
+        JudyLFreeArray(&jarr_state_extents_, PJE0);
+        jarr_state_extents_ = NULL;
+    }
+    num_extents_ = 0;
+}
+
+bool ExtentTree::find_extent(
+        uint64_t block_index,
+        uint64_t& start,
+        uint64_t& len,
+        uint64_t& state) const {
+
+    Word_t index = (Word_t)block_index;
+    Word_t *ptr_j_entry = NULL;
+
+    // Last extent starting at or before block_index
+    ptr_j_entry = (Word_t *)JudyLLast(jarr_state_extents_, &index, PJE0);
+    if (ptr_j_entry == NULL) {
+        return false;
+    }
+
+    start = index;
+    len = *ptr_j_entry >> EXTENT_STATE_BITS;
+    state = *ptr_j_entry & EXTENT_STATE_MASK;
+
+    return block_index < start + len;
+}
+
+void ExtentTree::put_extent(uint64_t start, uint64_t len, uint64_t state) {
+
+    Word_t *ptr_j_entry = NULL;
+
+    DSS_ASSERT(len != 0);
+    DSS_ASSERT(state != DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+
+    ptr_j_entry = (Word_t *)JudyLIns(
+            &jarr_state_extents_, (Word_t)start, PJE0);
+    if (ptr_j_entry == PJERR) {
+        assert(("ERROR", false));
+        return;
+    }
+    // Extent values are never 0, a 0 value is a new entry
+    if (*ptr_j_entry == 0) {
+        num_extents_++;
+    }
+    *ptr_j_entry = (len << EXTENT_STATE_BITS) | state;
+}
+
+void ExtentTree::remove_extent(uint64_t start) {
+    if (JudyLDel(&jarr_state_extents_, (Word_t)start, PJE0) == 1) {
+        num_extents_--;
+    }
+}
+
+void ExtentTree::split_at(uint64_t block_index) {
+
+    uint64_t start = 0;
+    uint64_t len = 0;
+    uint64_t state = 0;
+
+    if (!find_extent(block_index, start, len, state)) {
+        return;
+    }
+    if (start == block_index) {
+        return;
+    }
+
+    put_extent(start, block_index - start, state);
+    put_extent(block_index, start + len - block_index, state);
+}
+
+void ExtentTree::set_range_state(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t state) {
+
+    uint64_t end_index = block_index + num_blocks;
+    uint64_t start = block_index;
+    uint64_t len = num_blocks;
+    uint64_t neighbor_len = 0;
+    uint64_t neighbor_state = 0;
+    Word_t index = 0;
+    Word_t *ptr_j_entry = NULL;
+
+    // Extents now start and end at the range boundaries
+    split_at(block_index);
+    split_at(end_index);
+
+    // Drop every extent inside the range
+    index = (Word_t)block_index;
+    ptr_j_entry = (Word_t *)JudyLFirst(jarr_state_extents_, &index, PJE0);
+    while (ptr_j_entry != NULL && index < end_index) {
+        remove_extent(index);
+        ptr_j_entry = (Word_t *)JudyLFirst(
+                jarr_state_extents_, &index, PJE0);
+    }
+
+    if (state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) {
+        return;
+    }
+
+    // Merge with the previous extent if adjacent in the same state
+    index = (Word_t)block_index;
+    ptr_j_entry = (Word_t *)JudyLPrev(jarr_state_extents_, &index, PJE0);
+    if (ptr_j_entry != NULL) {
+        neighbor_len = *ptr_j_entry >> EXTENT_STATE_BITS;
+        neighbor_state = *ptr_j_entry & EXTENT_STATE_MASK;
+        if (index + neighbor_len == block_index &&
+                neighbor_state == state) {
+            start = index;
+            len += neighbor_len;
+        }
+    }
+
+    // Merge with the next extent if adjacent in the same state
+    ptr_j_entry = (Word_t *)JudyLGet(
+            jarr_state_extents_, (Word_t)end_index, PJE0);
+    if (ptr_j_entry != NULL) {
+        neighbor_len = *ptr_j_entry >> EXTENT_STATE_BITS;
+        neighbor_state = *ptr_j_entry & EXTENT_STATE_MASK;
+        if (neighbor_state == state) {
+            len += neighbor_len;
+            remove_extent(end_index);
+        }
+    }
+
+    put_extent(start, len, state);
+}
+
+uint64_t ExtentTree::find_first_mismatch(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t state) const {
+
+    uint64_t end_index = block_index + num_blocks;
+    uint64_t curr_index = block_index;
+    uint64_t start = 0;
+    uint64_t len = 0;
+    uint64_t extent_state = 0;
+    Word_t index = 0;
+
+    if (state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) {
+        // First allocated block in range
+        if (find_extent(block_index, start, len, extent_state)) {
+            return block_index;
+        }
+        index = (Word_t)block_index;
+        if (JudyLNext(jarr_state_extents_, &index, PJE0) != NULL &&
+                index < end_index) {
+            return index;
+        }
+        return end_index;
+    }
+
+    // Adjacent extents in the same state are merged, so this only
+    // loops on extents with a different state
+    while (curr_index < end_index) {
+        if (!find_extent(curr_index, start, len, extent_state) ||
+                extent_state != state) {
+            return curr_index;
+        }
+        curr_index = start + len;
+    }
+
+    return end_index;
+}
+
+void ExtentTree::mark_dirty(
+        uint64_t block_index, uint64_t num_blocks, uint64_t state) {
+    #ifndef DSS_BUILD_CUNIT_DISABLE_MARK_DIRTY
+    if(this->io_task_orderer_ != nullptr) {
+        // mark dirty bitmap
+        this->io_task_orderer_->mark_dirty_meta(block_index, num_blocks, state);
+    }
+    #endif
+}
+
+uint64_t ExtentTree::get_physical_size() {
+
+    // Same size as the n-bit cell bitmap written to disk
+    uint64_t num_qwords = (total_blocks_ / cells_per_qword_) +
+        ((total_blocks_ % cells_per_qword_) ? 1 : 0);
+
+    return (BITS_PER_BYTE * num_qwords);
+}
+
+dss_blk_allocator_status_t ExtentTree::is_block_free(
+        uint64_t block_index,
+        bool *is_free) {
+
+    uint64_t block_state = 0;
+    dss_blk_allocator_status_t status;
+
+    status = get_block_state(block_index, &block_state);
+    if (status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+        return status;
+    }
+
+    *is_free = (block_state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::get_block_state(
+        uint64_t block_index,
+        uint64_t *block_state) {
+
+    uint64_t last_block_id = total_blocks_ + logical_start_block_offset_;
+    uint64_t start = 0;
+    uint64_t len = 0;
+    uint64_t state = 0;
+
+    if (block_index > last_block_id) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if (block_index < logical_start_block_offset_) {
+        assert(("ERROR", false));
+    }
+
+    if (find_extent(block_index, start, len, state)) {
+        *block_state = state;
+    } else {
+        *block_state = DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::check_blocks_state(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t block_state,
+        uint64_t *scanned_index) {
+
+    uint64_t last_block_id = total_blocks_ + logical_start_block_offset_;
+    uint64_t req_last_block_lb = block_index + num_blocks - 1;
+    uint64_t scan_end = block_index + num_blocks;
+    uint64_t mismatch_index = 0;
+
+    if ((block_index > last_block_id)
+            || (req_last_block_lb > last_block_id)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if (block_index < logical_start_block_offset_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Scan only blocks managed by the allocator
+    if (scan_end > last_block_id) {
+        scan_end = last_block_id;
+    }
+
+    mismatch_index = find_first_mismatch(
+            block_index, scan_end - block_index, block_state);
+
+    // Last block in state, or block_index - 1 if none
+    if (block_index == 0) {
+        *scanned_index = mismatch_index;
+    } else {
+        *scanned_index = mismatch_index - 1;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::set_blocks_state(
+        uint64_t block_index,
+        uint64_t num_blocks,
+        uint64_t state) {
+
+    bool is_jso_allocable = false;
+    uint64_t actual_allocated_lb = 0;
+    uint64_t start = 0;
+    uint64_t len = 0;
+    uint64_t curr_state = 0;
+
+    uint64_t last_block_id = total_blocks_ + logical_start_block_offset_;
+    uint64_t req_last_block_lb = block_index + num_blocks - 1;
+
+    if (num_blocks != 1) {
+        // Incorrect use of API
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if (state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) {
+        assert(("ERROR", false));
+    }
+
+    // Make sure to set only valid states
+    if (state >= num_block_states_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_INVALID_BLOCK_STATE;
+    }
+
+    if ((block_index > last_block_id)
+            || (req_last_block_lb > last_block_id)) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // If the block to change state is free, alloc and then change-state
+    if (!find_extent(block_index, start, len, curr_state) &&
+            jso_ != NULL) {
+        // try allocating on jso
+        is_jso_allocable = jso_->allocate_lb(
+                block_index, num_blocks, actual_allocated_lb);
+        if (!is_jso_allocable) {
+            return BLK_ALLOCATOR_STATUS_ERROR;
+        }
+
+        // Make sure block_index is the same as actual_allocated_lb
+        if (actual_allocated_lb != block_index) {
+            assert(("ERROR", false));
+        }
+    }
+
+    set_range_state(block_index, num_blocks, state);
+    mark_dirty(block_index, num_blocks, state);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::clear_blocks(
+        uint64_t block_index,
+        uint64_t num_blocks) {
+
+    uint64_t last_block_id = total_blocks_ + logical_start_block_offset_;
+    uint64_t req_last_block_lb = block_index + num_blocks - 1;
+
+    if ((block_index > last_block_id)
+            || (req_last_block_lb > last_block_id)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Check if seek optimization is enabled
+    if (jso_ != NULL) {
+        // try clearing/freeing on jso
+        if (!jso_->free_lb(block_index, num_blocks)) {
+            // JSO returns false on clearing blocks when nothing is
+            // allocated.
+            // Check if nothing is allocated to support clear blocks
+            if (jso_->get_allocated_blocks() == 0) {
+                return BLK_ALLOCATOR_STATUS_SUCCESS;
+            } else {
+                assert(("ERROR", false));
+                return BLK_ALLOCATOR_STATUS_ERROR;
+            }
+        }
+    }
+
+    if (block_index < logical_start_block_offset_) {
+        assert(("ERROR", false));
+    }
+
+    set_range_state(block_index, num_blocks,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+    mark_dirty(block_index, num_blocks,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::alloc_blocks_contig(
+        uint64_t state,
+        uint64_t hint_block_index,
+        uint64_t num_blocks,
+        uint64_t *allocated_start_block) {
+
+    uint64_t actual_allocated_lb = 0;
+    bool is_jso_allocable = false;
+
+    uint64_t last_block_id = total_blocks_ + logical_start_block_offset_;
+
+    if ((hint_block_index > last_block_id)
+            || (num_blocks > total_blocks_)) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    // Free extents are only tracked by the seek optimizer
+    if (jso_ == NULL) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    is_jso_allocable = jso_->allocate_lb(
+            hint_block_index, num_blocks, actual_allocated_lb);
+    if (!is_jso_allocable) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if (allocated_start_block == NULL) {
+        // This means that actual_allocated_lb
+        // should be equal to hint_block_index
+        if (hint_block_index != actual_allocated_lb) {
+            // Free the allocated block at a different index
+            if (!jso_->free_lb(actual_allocated_lb, num_blocks)) {
+                // This can not fail
+                assert(("ERROR", false));
+            }
+
+            return BLK_ALLOCATOR_STATUS_ERROR;
+        }
+    } else {
+        // Assign the allocated lb to the request lb
+        *allocated_start_block = actual_allocated_lb;
+    }
+
+    if (actual_allocated_lb < logical_start_block_offset_) {
+        assert(("ERROR", false));
+    }
+
+    set_range_state(actual_allocated_lb, num_blocks, state);
+    mark_dirty(actual_allocated_lb, num_blocks, state);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::translate_meta_to_drive_addr(
+        uint64_t meta_lba,
+        uint64_t meta_num_blocks,
+        uint64_t drive_smallest_block_size,
+        uint64_t logical_block_size,
+        uint64_t& drive_blk_lba,
+        uint64_t& drive_num_blocks) {
+
+    // Blocks whose cells fit in one meta block
+    uint64_t lba_per_block =
+        (logical_block_size * BITS_PER_BYTE) / bits_per_cell_;
+    uint64_t meta_lba_end = (meta_lba + meta_num_blocks) - 1;
+    uint64_t dlba_end = 0;
+
+    drive_blk_lba = 0;
+    drive_num_blocks = 0;
+
+    if (logical_block_size != drive_smallest_block_size) {
+        // Same assumption as the bitmap allocator
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    if ((logical_start_block_offset_ != 0) &&
+            (meta_lba < logical_start_block_offset_)) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    drive_blk_lba = block_alloc_meta_start_offset_ +
+        (meta_lba - logical_start_block_offset_) / lba_per_block;
+    dlba_end = block_alloc_meta_start_offset_ +
+        (meta_lba_end - logical_start_block_offset_) / lba_per_block;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    // To catch any lba outside the block allocator meta-region
+    if (dlba_end >= logical_start_block_offset_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+#endif
+
+    drive_num_blocks = (dlba_end - drive_blk_lba) + 1;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::serialize_drive_data(
+        uint64_t drive_blk_addr,
+        uint64_t drive_num_blocks,
+        uint64_t drive_smallest_block_size,
+        void** serialized_drive_data,
+        uint64_t& serialized_len) {
+
+    uint64_t *serial_buf = nullptr;
+    uint64_t first_cell = 0;
+    uint64_t end_cell = 0;
+    uint64_t range_start = 0;
+    uint64_t range_end = 0;
+    uint64_t start = 0;
+    uint64_t len = 0;
+    uint64_t state = 0;
+    uint64_t fill_start = 0;
+    uint64_t fill_end = 0;
+    Word_t index = 0;
+    Word_t *ptr_j_entry = NULL;
+
+    if (drive_blk_addr < block_alloc_meta_start_offset_) {
+        assert(("ERROR", false));
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    serialized_len = drive_num_blocks * drive_smallest_block_size;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    serial_buf = (uint64_t *)dss_dma_zmalloc(
+            serialized_len, drive_smallest_block_size);
+#else
+    serial_buf = (uint64_t *)calloc(1, serialized_len);
+#endif
+    DSS_ASSERT(serial_buf != NULL);
+    *serialized_drive_data = serial_buf;
+
+    // Cells held by the requested meta blocks
+    first_cell = ((drive_blk_addr - block_alloc_meta_start_offset_) *
+            drive_smallest_block_size * BITS_PER_BYTE) / bits_per_cell_;
+    end_cell = first_cell +
+        (serialized_len * BITS_PER_BYTE) / bits_per_cell_;
+    if (end_cell > total_blocks_) {
+        end_cell = total_blocks_;
+    }
+    if (first_cell >= end_cell) {
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+
+    range_start = first_cell + logical_start_block_offset_;
+    range_end = end_cell + logical_start_block_offset_;
+
+    // Start with the extent holding the first block if any
+    if (find_extent(range_start, start, len, state)) {
+        index = (Word_t)start;
+    } else {
+        index = (Word_t)range_start;
+    }
+
+    ptr_j_entry = (Word_t *)JudyLFirst(jarr_state_extents_, &index, PJE0);
+    while (ptr_j_entry != NULL && index < range_end) {
+        start = index;
+        len = *ptr_j_entry >> EXTENT_STATE_BITS;
+        state = *ptr_j_entry & EXTENT_STATE_MASK;
+
+        fill_start = std::max(start, range_start);
+        fill_end = std::min(start + len, range_end);
+        fill_serialized_cells(
+                serial_buf,
+                fill_start - range_start,
+                fill_end - fill_start,
+                state,
+                bits_per_cell_,
+                cells_per_qword_);
+
+        ptr_j_entry = (Word_t *)JudyLNext(
+                jarr_state_extents_, &index, PJE0);
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::load_meta_from_disk_data(
+        uint8_t *serialized_data,
+        uint64_t serialized_data_len,
+        uint64_t disk_read_offset) {
+
+    uint64_t cell_flag = (1ULL << bits_per_cell_) - 1;
+    uint64_t qword = 0;
+    uint64_t cell = 0;
+    uint64_t cell_value = 0;
+    uint64_t run_start = 0;
+    uint64_t run_state = DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE;
+    uint64_t actual_allocated_lb = 0;
+
+    // disk_read_offset indicates the word alignment
+    uint64_t begin_word =
+        (disk_read_offset * BITS_PER_BYTE) / BITS_PER_WORD;
+    uint64_t num_words =
+        (serialized_data_len * BITS_PER_BYTE) / BITS_PER_WORD;
+    uint64_t begin_cell = begin_word * cells_per_qword_;
+    uint64_t end_cell = begin_cell + num_words * cells_per_qword_;
+
+    if (begin_cell > total_blocks_ - 1) {
+        // Which means the region is out of bounds, do nothing
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+    if (end_cell > total_blocks_) {
+        end_cell = total_blocks_;
+    }
+
+    // Runs of blocks in the same state become one extent
+    for (cell = begin_cell; cell <= end_cell; cell++) {
+        if (cell == end_cell) {
+            cell_value = DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE;
+        } else {
+            if ((cell - begin_cell) % cells_per_qword_ == 0) {
+                std::memcpy(&qword,
+                        serialized_data +
+                        ((cell - begin_cell) / cells_per_qword_) *
+                        sizeof(uint64_t),
+                        sizeof(uint64_t));
+                if (qword == 0 &&
+                        run_state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE &&
+                        end_cell - cell > cells_per_qword_) {
+                    // Skip a qword of free cells
+                    cell += cells_per_qword_ - 1;
+                    continue;
+                }
+            }
+            cell_value = (qword >> (((cell - begin_cell) %
+                            cells_per_qword_) * bits_per_cell_)) &
+                cell_flag;
+        }
+
+        if (cell_value == run_state) {
+            continue;
+        }
+
+        if (run_state != DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE) {
+            // Convey the allocated run to JSO
+            if (jso_ != NULL) {
+                if (!jso_->allocate_lb(
+                            run_start + logical_start_block_offset_,
+                            cell - run_start, actual_allocated_lb)) {
+                    // This API is called on reboot and failing to do so
+                    // can not occur
+                    assert(("ERROR", false));
+                    return BLK_ALLOCATOR_STATUS_ERROR;
+                }
+                if (actual_allocated_lb !=
+                        run_start + logical_start_block_offset_) {
+                    assert(("ERROR", false));
+                    return BLK_ALLOCATOR_STATUS_ERROR;
+                }
+            }
+            set_range_state(run_start + logical_start_block_offset_,
+                    cell - run_start, run_state);
+        }
+
+        run_start = cell;
+        run_state = cell_value;
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::write_meta_to_file() {
+    // Currently written to /var/log/dss_extent.data
+    std::ofstream dump_file;
+    Word_t index = 0;
+    Word_t *ptr_j_entry = NULL;
+
+    dump_file.open("/var/log/dss_extent.data");
+    ptr_j_entry = (Word_t *)JudyLFirst(jarr_state_extents_, &index, PJE0);
+    while (ptr_j_entry != NULL) {
+        dump_file<<index<<" "<<(*ptr_j_entry >> EXTENT_STATE_BITS)
+            <<" "<<(*ptr_j_entry & EXTENT_STATE_MASK)<<"\n";
+        ptr_j_entry = (Word_t *)JudyLNext(
+                jarr_state_extents_, &index, PJE0);
+    }
+    dump_file.close();
+    std::cout<<"Completed writing extent data to file"<<std::endl;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::print_stats() {
+
+    if (jso_ == NULL) {
+        std::cout<<"Judy seek optimizer turned off!"
+            <<" No stats to report"<<std::endl;
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+
+    std::cout<<std::endl;
+    std::cout<<"Total blocks = "<<jso_->get_total_blocks()<<std::endl;
+    std::cout<<"Free blocks = "<<jso_->get_free_blocks()<<std::endl;
+    std::cout<<"Allocated blocks = "<<jso_->get_allocated_blocks()
+        <<std::endl;
+    std::cout<<"State extents = "<<num_extents_<<std::endl;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+dss_blk_allocator_status_t ExtentTree::get_frag_stats(
+        dss_blk_allocator_frag_stats_t& stats) {
+
+    if (jso_ == NULL) {
+        return BLK_ALLOCATOR_STATUS_ERROR;
+    }
+    jso_->get_frag_stats(stats);
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+} // End AllocatorType namespace
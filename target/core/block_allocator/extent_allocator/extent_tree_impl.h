@@ -0,0 +1,195 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "block_allocator.h"
+
+namespace AllocatorType {
+
+// Low bits of a state extent value hold the state, the rest the length
+#define EXTENT_STATE_BITS 8
+#define EXTENT_STATE_MASK ((1ULL << EXTENT_STATE_BITS) - 1)
+
+/*
+ * - This class keeps block states as extents instead of a cell per
+ *   block, so memory grows with fragmentation rather than capacity
+ * - Free extents are indexed by the judy seek optimizer, the same
+ *   ordered judy arrays the bitmap allocator seeks with
+ * - Allocated blocks are kept in a judy array of state extents keyed
+ *   by start block, each value packing the extent length and state.
+ *   Adjacent extents in the same state are merged
+ * - The on-disk meta is the same n-bit cell bitmap written by
+ *   QwordVector64Cell, built from the extents on serialization, so
+ *   either allocator loads the meta written by the other
+ */
+class ExtentTree : public BlockAlloc::Allocator {
+public:
+    // Constructor of the class
+    explicit ExtentTree(
+            BlockAlloc::JudySeekOptimizerSharedPtr jso,
+            BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer,
+            uint64_t total_blocks,
+            uint8_t bits_per_cell,
+            uint64_t num_block_states,
+            uint64_t block_alloc_meta_start_offset,
+            uint64_t logical_start_block_offset);
+
+    ~ExtentTree();
+
+    /**
+     * @return number of state extents held in memory
+     */
+    uint64_t num_extents() const { return num_extents_; }
+
+    //BlockAlloc::Allocator API (concrete definitions)
+    void destroy() override;
+    uint64_t get_physical_size() override;
+    dss_blk_allocator_status_t is_block_free(
+            uint64_t block_index,
+            bool *is_free) override;
+    dss_blk_allocator_status_t get_block_state(
+            uint64_t block_index,
+            uint64_t *block_state) override;
+    dss_blk_allocator_status_t check_blocks_state(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t block_state,
+            uint64_t *scanned_index) override;
+    dss_blk_allocator_status_t set_blocks_state(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t state) override;
+    dss_blk_allocator_status_t clear_blocks(
+            uint64_t block_index,
+            uint64_t num_blocks) override;
+    dss_blk_allocator_status_t alloc_blocks_contig(
+            uint64_t state,
+            uint64_t hint_block_index,
+            uint64_t num_blocks,
+            uint64_t *allocated_start_block) override;
+    dss_blk_allocator_status_t translate_meta_to_drive_addr(
+            uint64_t meta_lba,
+            uint64_t meta_num_blocks,
+            uint64_t drive_smallest_block_size,
+            uint64_t logical_block_size,
+            uint64_t& drive_blk_addr,
+            uint64_t& drive_num_blocks) override;
+    dss_blk_allocator_status_t serialize_drive_data(
+            uint64_t drive_blk_addr,
+            uint64_t drive_num_blocks,
+            uint64_t drive_smallest_block_size,
+            void** serialized_drive_data,
+            uint64_t& serialized_len) override;
+    dss_blk_allocator_status_t load_meta_from_disk_data(
+            uint8_t *serialized_data,
+            uint64_t serialized_data_len,
+            uint64_t disk_read_offset) override;
+    dss_blk_allocator_status_t write_meta_to_file() override;
+    dss_blk_allocator_status_t print_stats() override;
+    dss_blk_allocator_status_t get_frag_stats(
+            dss_blk_allocator_frag_stats_t& stats) override;
+
+private:
+    BlockAlloc::JudySeekOptimizerSharedPtr jso_;
+    BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer_;
+    uint64_t total_blocks_;
+    uint8_t bits_per_cell_;
+    uint64_t num_block_states_;
+    uint64_t block_alloc_meta_start_offset_;
+    uint64_t logical_start_block_offset_;
+    uint64_t cells_per_qword_;
+    // Start block to (length << EXTENT_STATE_BITS | state)
+    void *jarr_state_extents_;
+    uint64_t num_extents_;
+
+    /**
+     * @brief Find the extent holding block_index
+     *
+     * @param[OUT] start, first block of the extent
+     * @param[OUT] len, number of blocks in the extent
+     * @param[OUT] state, state of the extent
+     * @return boolean, false if block_index is free
+     */
+    bool find_extent(
+            uint64_t block_index,
+            uint64_t& start,
+            uint64_t& len,
+            uint64_t& state) const;
+
+    /**
+     * @brief Split the extent holding block_index so that an extent
+     *        starts at block_index
+     */
+    void split_at(uint64_t block_index);
+
+    /**
+     * @brief Insert or overwrite the extent at start
+     */
+    void put_extent(uint64_t start, uint64_t len, uint64_t state);
+
+    /**
+     * @brief Remove the extent at start
+     */
+    void remove_extent(uint64_t start);
+
+    /**
+     * @brief Set the state of a range of blocks in the extent map,
+     *        a free state removes the range from the map
+     */
+    void set_range_state(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t state);
+
+    /**
+     * @brief Find the first block in a range whose state differs
+     *        from `state`
+     *
+     * @return index of the first differing block,
+     *         block_index + num_blocks if all blocks are in `state`
+     */
+    uint64_t find_first_mismatch(
+            uint64_t block_index,
+            uint64_t num_blocks,
+            uint64_t state) const;
+
+    /**
+     * @brief Mark the range dirty on the io task orderer
+     * @param state, state the range was set to
+     */
+    void mark_dirty(
+            uint64_t block_index, uint64_t num_blocks, uint64_t state);
+};
+
+} // End AllocatorType namespace
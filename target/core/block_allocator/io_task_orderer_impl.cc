@@ -32,48 +32,91 @@
  */
 
 #include "block_allocator.h"
+#include <algorithm>
 
 namespace BlockAlloc {
 
+// FNV-1a over journal block header and records
+static uint32_t journal_checksum(
+        uint32_t hash, const void *buf, uint64_t len) {
+
+    const uint8_t *p = (const uint8_t *)buf;
+
+    for (uint64_t i=0; i<len; i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t journal_block_checksum(
+        const ba_journal_hdr_t *hdr, const ba_journal_rec_t *recs) {
+
+    ba_journal_hdr_t hdr_copy = *hdr;
+
+    hdr_copy.checksum = 0;
+    return journal_checksum(
+            journal_checksum(2166136261u, &hdr_copy, sizeof(hdr_copy)),
+            recs, hdr->num_recs * sizeof(ba_journal_rec_t));
+}
+
+bool IoTaskOrderer::get_io_task_failed(dss_io_task_t* io_task) {
+#ifndef DSS_BUILD_CUNIT_WO_IO_TASK
+    return dss_io_task_get_status(io_task) != DSS_IO_TASK_STATUS_SUCCESS;
+#else
+    return false;
+#endif
+}
+
 void IoTaskOrderer::populate_io_ranges(dss_io_task_t* io_task,
         std::vector<std::pair<uint64_t, uint64_t>>& io_ranges,
-        uint64_t& num_ranges, bool is_completion) {
-    dss_io_op_exec_state_t op_state_filter;
-
-    is_completion?
-        (op_state_filter = DSS_IO_OP_COMPLETED):
-            (op_state_filter = DSS_IO_OP_FOR_SUBMISSION);
+        uint64_t& num_ranges, bool is_completion, bool is_failed) {
     num_ranges = 0;
 
 #ifndef DSS_BUILD_CUNIT_WO_IO_TASK
+    // Ops of a completed task are either done or failed
+    dss_io_op_exec_state_t op_state_filters[2] =
+        {DSS_IO_OP_COMPLETED, DSS_IO_OP_FAILED};
+    int num_filters = 2;
     dss_io_task_status_t rc;
-    void *tmp_it_ctx = NULL;
     dss_io_op_user_param_t op_params;
-    do {
-        rc = dss_io_task_get_op_ranges(
-                io_task, DSS_IO_OP_OWNER_BA,
-                op_state_filter,
-                &tmp_it_ctx,
-                &op_params);
-        DSS_ASSERT((rc == DSS_IO_TASK_STATUS_SUCCESS) 
-                || (rc == DSS_IO_TASK_STATUS_IT_END));
-        if(op_params.is_params_valid) {
-            io_ranges[num_ranges].first = op_params.lba;
-            io_ranges[num_ranges].second = op_params.num_blocks;
-            if(is_completion) {
+
+    if (!is_completion) {
+        op_state_filters[0] = DSS_IO_OP_FOR_SUBMISSION;
+        num_filters = 1;
+    }
+    for (int i=0; i<num_filters; i++) {
+        void *tmp_it_ctx = NULL;
+        do {
+            rc = dss_io_task_get_op_ranges(
+                    io_task, DSS_IO_OP_OWNER_BA,
+                    op_state_filters[i],
+                    &tmp_it_ctx,
+                    &op_params);
+            DSS_ASSERT((rc == DSS_IO_TASK_STATUS_SUCCESS) 
+                    || (rc == DSS_IO_TASK_STATUS_IT_END));
+            if(op_params.is_params_valid) {
+                io_ranges[num_ranges].first = op_params.lba;
+                io_ranges[num_ranges].second = op_params.num_blocks;
+                if(is_completion) {
+                    if (is_failed && op_params.data &&
+                            is_journal_block(op_params.lba)) {
+                        this->requeue_journal_block(op_params.data);
+                    }
 #ifndef DSS_BUILD_CUNIT_TEST
-                if(op_params.data) dss_free(op_params.data);
+                    if(op_params.data) dss_free(op_params.data);
 #else
-                if(op_params.data) free(op_params.data);
+                    if(op_params.data) free(op_params.data);
 #endif
+                }
+                num_ranges++;
+                DSS_ASSERT(
+                        num_ranges <= this->max_dirty_segments_);
+                //Vector capacity is now equal to max dirty segments
             }
-            num_ranges++;
-            DSS_ASSERT(
-                    num_ranges <= this->max_dirty_segments_);
-            //Vector capacity is now equal to max dirty segments
-        }
-    } while(rc == DSS_IO_TASK_STATUS_SUCCESS);
-    //TODO: Handle if any ops failed
+        } while(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
 #else
     //Dummy stub for unit test
     num_ranges = 1;
@@ -288,7 +331,7 @@ void IoTaskOrderer::merge_dirty_meta(
 }
 
 dss_blk_allocator_status_t IoTaskOrderer::mark_dirty_meta(
-        uint64_t lba, uint64_t num_blocks) {
+        uint64_t lba, uint64_t num_blocks, uint64_t state) {
 
     dss_blk_allocator_status_t blk_status = BLK_ALLOCATOR_STATUS_ERROR;
     uint64_t drive_blk_addr = 0;
@@ -314,6 +357,11 @@ dss_blk_allocator_status_t IoTaskOrderer::mark_dirty_meta(
     // But this needs to be accounted on jarr_dirty_meta_
     this->merge_dirty_meta(drive_blk_addr, drive_num_blocks);
 
+    if (journal_num_blocks_ > 0 && !replaying_) {
+        // Remember the change for the journal records of the next task
+        this->add_journal_pending(lba, num_blocks, state);
+    }
+
     return BLK_ALLOCATOR_STATUS_SUCCESS;
 }
 
@@ -472,8 +520,19 @@ bool IoTaskOrderer::mark_completed(
     return true;
 }
 
-dss_blk_allocator_status_t IoTaskOrderer::queue_sync_meta_io_tasks(
-        dss_io_task_t* io_task) {
+void IoTaskOrderer::add_dirty_meta_to_task(dss_io_task_t* io_task) {
+
+    if (journal_num_blocks_ > 0) {
+        // Bitmap is written on checkpoint only
+        this->add_journal_recs_to_task(io_task);
+    } else {
+        this->add_dirty_bitmap_to_task(io_task);
+    }
+
+    return;
+}
+
+void IoTaskOrderer::add_dirty_bitmap_to_task(dss_io_task_t* io_task) {
 
     uint64_t drive_blk_addr = 0;
     uint64_t drive_num_blocks = 0;
@@ -551,8 +610,58 @@ dss_blk_allocator_status_t IoTaskOrderer::queue_sync_meta_io_tasks(
     }
     // CXX: Log free bytes for examination
 
-    // Insert into IO device guard queue
-    io_dev_guard_q_.push_back(io_task);
+    return;
+}
+
+void IoTaskOrderer::seal_group() {
+
+    DSS_ASSERT(group_q_.size() > 0);
+
+    // One pass over the dirty meta covers every task in the group,
+    // adjacent dirty ranges are already merged in jarr_dirty_meta_
+    this->add_dirty_meta_to_task(group_q_.front());
+
+#ifndef DSS_BUILD_CUNIT_WO_IO_TASK
+    if (group_q_.size() > 1 && group_q_.front() != nullptr) {
+        dss_io_task_status_t io_status;
+        // None of the tasks can complete before the meta write does
+        io_status = dss_io_task_group_create(
+                group_q_.data(), group_q_.size());
+        if (io_status != DSS_IO_TASK_STATUS_SUCCESS) {
+            assert(("ERROR", false));
+        }
+    }
+#endif
+
+    // Queue the meta write first so followers are not submitted ahead
+    // of a group that is still waiting on an overlapping meta write
+    io_dev_guard_q_.insert(
+            io_dev_guard_q_.end(), group_q_.begin(), group_q_.end());
+    group_q_.clear();
+
+    return;
+}
+
+dss_blk_allocator_status_t IoTaskOrderer::queue_sync_meta_io_tasks(
+        dss_io_task_t* io_task) {
+
+    if (group_max_reqs_ <= 1) {
+        this->add_dirty_meta_to_task(io_task);
+
+        // Insert into IO device guard queue
+        io_dev_guard_q_.push_back(io_task);
+
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+
+    if (group_q_.empty()) {
+        group_start_ = std::chrono::steady_clock::now();
+    }
+    group_q_.push_back(io_task);
+
+    if (group_q_.size() >= group_max_reqs_) {
+        this->seal_group();
+    }
 
     return BLK_ALLOCATOR_STATUS_SUCCESS;
 }
@@ -563,6 +672,13 @@ dss_blk_allocator_status_t IoTaskOrderer::get_next_submit_meta_io_tasks(
     // Iterate from the front of queue to examine all possible
     // io tasks that do not have overlap and can be executed in
     // parallel
+
+    if (!group_q_.empty() &&
+            std::chrono::steady_clock::now() - group_start_ >=
+            std::chrono::microseconds(group_window_us_)) {
+        // Oldest task in the group has waited long enough
+        this->seal_group();
+    }
     
     if (io_dev_guard_q_.size() == 0) {
         return BLK_ALLOCATOR_STATUS_ITERATION_END;
@@ -590,8 +706,19 @@ dss_blk_allocator_status_t IoTaskOrderer::get_next_submit_meta_io_tasks(
 #ifndef DSS_IO_ORDER_CPPUNIT_TEST
     uint64_t num_ranges = 0;
 
+    if (journal_num_blocks_ > 0 && !this->add_journal_blocks_to_task(*it)) {
+        // Journal is full till the checkpoint in flight completes
+        return BLK_ALLOCATOR_STATUS_ITERATION_END;
+    }
+
     populate_io_ranges(*it, io_ranges_, num_ranges, false);
-    if (is_dev_guard_overlap(io_ranges_, num_ranges)) {
+    if (num_ranges == 0) {
+        // Group followers carry no meta, nothing to guard
+        *io_task = *it;
+        io_dev_guard_q_.erase(it);
+
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    } else if (is_dev_guard_overlap(io_ranges_, num_ranges)) {
         return BLK_ALLOCATOR_STATUS_ITERATION_END;
     } else {
         this->mark_in_flight(io_ranges_, num_ranges);
@@ -609,9 +736,27 @@ dss_blk_allocator_status_t IoTaskOrderer::complete_meta_sync(
         dss_io_task_t* io_task) {
 
     uint64_t num_ranges = 0;
+    // A failed group fails every member, none of it is persisted
+    bool is_failed = this->is_io_task_failed(io_task);
 
     // Populate io-ranges associated with io-task
-    this->populate_io_ranges(io_task, io_ranges_, num_ranges, true);
+    this->populate_io_ranges(
+            io_task, io_ranges_, num_ranges, true, is_failed);
+
+    if (journal_num_blocks_ > 0) {
+        this->complete_journal_task(io_task, is_failed);
+    }
+
+    if (is_failed) {
+        // Bitmap ranges are written again with the next meta sync,
+        // journal records were queued again while populating
+        for (size_t i=0; i<num_ranges; i++) {
+            if (!is_journal_block(io_ranges_[i].first)) {
+                this->merge_dirty_meta(
+                        io_ranges_[i].first, io_ranges_[i].second);
+            }
+        }
+    }
 
     // Mark ranges completed (remove from jarr_io_dev_guard_)
     if (this->mark_completed(io_ranges_, num_ranges)) {
@@ -622,4 +767,325 @@ dss_blk_allocator_status_t IoTaskOrderer::complete_meta_sync(
 
 }
 
+dss_blk_allocator_status_t IoTaskOrderer::set_journal(
+        uint64_t start_block,
+        uint64_t num_blocks,
+        uint64_t max_ranges) {
+
+    // A checkpoint is due every quarter of the journal
+    if (num_blocks < 8) {
+        journal_num_blocks_ = 0;
+        return BLK_ALLOCATOR_STATUS_INVALID_BLOCK_RANGE;
+    }
+
+    journal_start_block_ = start_block;
+    journal_num_blocks_ = num_blocks;
+
+    // Checkpoint writes all bitmap ranges dirtied since the last one
+    if (max_ranges > max_dirty_segments_) {
+        max_dirty_segments_ = max_ranges;
+        io_ranges_.resize(max_ranges, std::make_pair(0, 0));
+    }
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
+uint32_t IoTaskOrderer::format_journal_block(
+        void *buf,
+        uint64_t block_size,
+        uint64_t seq,
+        uint64_t ckpt_seq,
+        const ba_journal_rec_t *recs,
+        uint64_t num_recs) {
+
+    ba_journal_hdr_t *hdr = (ba_journal_hdr_t *)buf;
+    ba_journal_rec_t *block_recs = (ba_journal_rec_t *)(hdr + 1);
+    uint64_t max_recs =
+        (block_size - sizeof(ba_journal_hdr_t)) / sizeof(ba_journal_rec_t);
+
+    if (num_recs > max_recs) {
+        num_recs = max_recs;
+    }
+
+    std::memset(buf, 0, block_size);
+    hdr->magic = BA_JOURNAL_MAGIC;
+    hdr->seq = seq;
+    hdr->ckpt_seq = ckpt_seq;
+    hdr->num_recs = num_recs;
+    std::memcpy(block_recs, recs, num_recs * sizeof(ba_journal_rec_t));
+    hdr->checksum = journal_block_checksum(hdr, block_recs);
+
+    return num_recs;
+}
+
+void IoTaskOrderer::add_journal_pending(
+        uint64_t lba, uint64_t num_blocks, uint64_t state) {
+
+    ba_journal_rec_t rec;
+    uint64_t rec_blocks = 0;
+
+    while (num_blocks > 0) {
+        if (!journal_pending_.empty()) {
+            ba_journal_rec_t& last = journal_pending_.back();
+
+            // Same blocks changed again, only the latest state counts
+            if (last.lba == lba && last.num_blocks == num_blocks) {
+                last.state = state;
+                return;
+            }
+            if (last.state == state &&
+                    last.lba + last.num_blocks == lba &&
+                    last.num_blocks + num_blocks <= UINT32_MAX) {
+                last.num_blocks += num_blocks;
+                return;
+            }
+        }
+
+        rec_blocks = std::min(num_blocks, (uint64_t)UINT32_MAX);
+        rec.lba = lba;
+        rec.num_blocks = rec_blocks;
+        rec.state = state;
+        journal_pending_.push_back(rec);
+        lba += rec_blocks;
+        num_blocks -= rec_blocks;
+    }
+
+    return;
+}
+
+void IoTaskOrderer::add_journal_recs_to_task(dss_io_task_t* io_task) {
+
+    JournalTask jt;
+
+    if (journal_pending_.empty()) {
+        // Changes were recorded with an earlier io task
+        return;
+    }
+
+    jt.recs = std::move(journal_pending_);
+    journal_pending_.clear();
+    journal_tasks_[io_task] = std::move(jt);
+
+    return;
+}
+
+bool IoTaskOrderer::add_journal_blocks_to_task(dss_io_task_t* io_task) {
+
+    std::unordered_map<dss_io_task_t *, JournalTask>::iterator jt_it =
+        journal_tasks_.find(io_task);
+    uint64_t block_size = this->drive_smallest_block_size_;
+    uint64_t recs_per_block =
+        (block_size - sizeof(ba_journal_hdr_t)) / sizeof(ba_journal_rec_t);
+    uint64_t num_blocks = 0;
+    uint64_t used_blocks = 0;
+    uint64_t max_used_blocks = journal_num_blocks_;
+    uint64_t rec_index = 0;
+    bool is_publisher = false;
+    void *buf = nullptr;
+
+    if (jt_it == journal_tasks_.end() || jt_it->second.is_written) {
+        return true;
+    }
+    JournalTask& jt = jt_it->second;
+
+    num_blocks = (jt.recs.size() + recs_per_block - 1) / recs_per_block;
+    // Keeps the gating below free of deadlock, a larger task would wait
+    // for free journal slots forever in release builds too
+    DSS_RELEASE_ASSERT(num_blocks <= journal_num_blocks_ / 8);
+
+    // A slot is reused only after a completed journal block recorded a
+    // checkpoint covering the block in it. The first task recording a
+    // new checkpoint may use the whole journal, others only half of it
+    // while a checkpoint is pending so that replay after a crash always
+    // leaves room for the next checkpoint
+    is_publisher = (journal_ckpt_seq_ > journal_published_ckpt_seq_) &&
+        !journal_publishing_;
+    if (journal_ckpt_in_flight_ ||
+            (journal_ckpt_seq_ > journal_published_ckpt_seq_ &&
+             !is_publisher)) {
+        max_used_blocks = journal_num_blocks_ / 2;
+    }
+    used_blocks =
+        journal_next_seq_ + num_blocks - 1 - journal_published_ckpt_seq_;
+    if (used_blocks > max_used_blocks) {
+        return false;
+    }
+
+    while (rec_index < jt.recs.size()) {
+#ifndef DSS_BUILD_CUNIT_TEST
+        buf = dss_dma_zmalloc(block_size, block_size);
+#else
+        buf = malloc(block_size);
+#endif
+        DSS_ASSERT(buf != NULL);
+
+        rec_index += format_journal_block(
+                buf,
+                block_size,
+                journal_next_seq_,
+                journal_ckpt_seq_,
+                &jt.recs[rec_index],
+                jt.recs.size() - rec_index);
+
+#ifndef DSS_BUILD_CUNIT_WO_IO_TASK
+        dss_io_task_status_t io_status = DSS_IO_TASK_STATUS_ERROR;
+        dss_io_opts_t io_opts =
+        {.mod_id = DSS_IO_OP_OWNER_BA, .is_blocking = false};
+        io_status = dss_io_task_add_blk_write(
+                io_task,
+                *this->get_io_device(),
+                journal_start_block_ + journal_next_seq_ % journal_num_blocks_,
+                1,
+                buf,
+                &io_opts);
+        if (io_status != DSS_IO_TASK_STATUS_SUCCESS) {
+            assert(("ERROR", false));
+        }
+#else
+        free(buf);
+#endif
+        journal_next_seq_++;
+    }
+
+    jt.is_written = true;
+    jt.hdr_ckpt_seq = journal_ckpt_seq_;
+    if (is_publisher) {
+        jt.is_publisher = true;
+        journal_publishing_ = true;
+    }
+    jt.recs.clear();
+    jt.recs.shrink_to_fit();
+
+    // Write the bitmap once a quarter of the journal is used since the
+    // last checkpoint
+    if (!journal_ckpt_in_flight_ &&
+            journal_ckpt_seq_ == journal_published_ckpt_seq_ &&
+            (journal_next_seq_ - 1) - journal_ckpt_seq_ >=
+                journal_num_blocks_ / 4 &&
+            jarr_dirty_meta_ != nullptr) {
+        this->add_dirty_bitmap_to_task(io_task);
+        jt.is_ckpt = true;
+        jt.ckpt_seq = journal_next_seq_ - 1;
+        journal_ckpt_in_flight_ = true;
+    }
+
+    return true;
+}
+
+void IoTaskOrderer::requeue_journal_block(const void *buf) {
+
+    const ba_journal_hdr_t *hdr = (const ba_journal_hdr_t *)buf;
+    const ba_journal_rec_t *recs = (const ba_journal_rec_t *)(hdr + 1);
+
+    uint64_t state = 0;
+    dss_blk_allocator_status_t blk_status = BLK_ALLOCATOR_STATUS_ERROR;
+
+    // Tasks queued after the failed one may have journaled newer
+    // changes, so record the current block state again
+    for (uint32_t i=0; i<hdr->num_recs; i++) {
+        uint64_t end_lba = recs[i].lba + recs[i].num_blocks;
+
+        for (uint64_t lba = recs[i].lba; lba < end_lba; lba++) {
+            blk_status = this->get_block_state(lba, &state);
+            if (blk_status != BLK_ALLOCATOR_STATUS_SUCCESS) {
+                assert(("ERROR", false));
+            }
+            this->add_journal_pending(lba, 1, state);
+        }
+    }
+
+    return;
+}
+
+void IoTaskOrderer::complete_journal_task(
+        dss_io_task_t* io_task, bool is_failed) {
+
+    std::unordered_map<dss_io_task_t *, JournalTask>::iterator jt_it =
+        journal_tasks_.find(io_task);
+
+    if (jt_it == journal_tasks_.end()) {
+        return;
+    }
+    JournalTask& jt = jt_it->second;
+
+    if (jt.is_ckpt) {
+        // Bitmap now holds every change up to ckpt_seq, a failed
+        // checkpoint is due again with the next journal task
+        if (!is_failed) {
+            journal_ckpt_seq_ = jt.ckpt_seq;
+        }
+        journal_ckpt_in_flight_ = false;
+    }
+    if (!is_failed && jt.hdr_ckpt_seq > journal_published_ckpt_seq_) {
+        journal_published_ckpt_seq_ = jt.hdr_ckpt_seq;
+    }
+    if (jt.is_publisher) {
+        journal_publishing_ = false;
+    }
+    journal_tasks_.erase(jt_it);
+
+    return;
+}
+
+dss_blk_allocator_status_t IoTaskOrderer::load_journal(
+        const uint8_t *data,
+        uint64_t data_len,
+        std::vector<ba_journal_rec_t>& recs) {
+
+    uint64_t block_size = this->drive_smallest_block_size_;
+    uint64_t recs_per_block =
+        (block_size - sizeof(ba_journal_hdr_t)) / sizeof(ba_journal_rec_t);
+    uint64_t num_blocks = data_len / block_size;
+    uint64_t max_seq = 0;
+    uint64_t ckpt_seq = 0;
+    std::vector<std::pair<uint64_t, const ba_journal_hdr_t *>> blocks;
+
+    recs.clear();
+    if (journal_num_blocks_ == 0) {
+        return BLK_ALLOCATOR_STATUS_SUCCESS;
+    }
+    if (num_blocks > journal_num_blocks_) {
+        num_blocks = journal_num_blocks_;
+    }
+
+    // Collect valid blocks, torn or stale writes fail the checksum
+    for (uint64_t i=0; i<num_blocks; i++) {
+        const ba_journal_hdr_t *hdr =
+            (const ba_journal_hdr_t *)(data + i * block_size);
+
+        if (hdr->magic != BA_JOURNAL_MAGIC ||
+                hdr->num_recs > recs_per_block ||
+                hdr->seq % journal_num_blocks_ != i ||
+                hdr->checksum != journal_block_checksum(
+                    hdr, (const ba_journal_rec_t *)(hdr + 1))) {
+            continue;
+        }
+        blocks.push_back(std::make_pair(hdr->seq, hdr));
+        max_seq = std::max(max_seq, (uint64_t)hdr->seq);
+        ckpt_seq = std::max(ckpt_seq, (uint64_t)hdr->ckpt_seq);
+    }
+    std::sort(blocks.begin(), blocks.end());
+
+    // Only blocks newer than the last checkpoint and within one lap of
+    // the latest block are replayed
+    for (size_t i=0; i<blocks.size(); i++) {
+        const ba_journal_hdr_t *hdr = blocks[i].second;
+        const ba_journal_rec_t *block_recs =
+            (const ba_journal_rec_t *)(hdr + 1);
+
+        if (blocks[i].first <= ckpt_seq ||
+                blocks[i].first + journal_num_blocks_ <= max_seq) {
+            continue;
+        }
+        recs.insert(recs.end(), block_recs, block_recs + hdr->num_recs);
+    }
+
+    // Replayed changes stay in the journal till the next checkpoint
+    journal_next_seq_ = max_seq + 1;
+    journal_ckpt_seq_ = ckpt_seq;
+    journal_published_ckpt_seq_ = ckpt_seq;
+
+    return BLK_ALLOCATOR_STATUS_SUCCESS;
+}
+
 }// End namespace BlockAlloc
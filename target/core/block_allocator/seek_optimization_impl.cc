@@ -32,6 +32,14 @@
  */
 
 #include "block_allocator.h"
+#include <algorithm>
+
+// Largest allocation of each size class in blocks
+static const uint64_t size_class_max_blocks[BLK_ALLOCATOR_NUM_SIZE_CLASSES] =
+    {1, 4, 16, 64, UINT64_MAX};
+
+// Unclaimed regions tried before falling back to the closest free chunk
+#define SIZE_CLASS_MAX_CLAIM_SCAN (64)
 
 namespace BlockAlloc {
 
@@ -72,6 +80,10 @@ bool JudySeekOptimizer::init() {
         return false;
     }
 
+    // The whole range is a single free extent
+    num_free_extents_ = 1;
+    free_extent_hist_[get_hist_bucket(total_blocks_)]++;
+
     // Relevant structures are initialized, return true
     return true;
 }
@@ -100,6 +112,9 @@ void JudySeekOptimizer::remove_element(
         std::cout<<"Remove from jarr_free_contig_len_ failed"<<std::endl;
         assert(("ERROR", false));
     }
+
+    num_free_extents_--;
+    free_extent_hist_[get_hist_bucket(request_len)]--;
     return;
 }
 
@@ -134,6 +149,9 @@ bool JudySeekOptimizer::add_element(
         return false;
     }
 
+    num_free_extents_++;
+    free_extent_hist_[get_hist_bucket(request_len)]++;
+
     // Added to relevant structures, return true
     return true;
 }
@@ -487,7 +505,9 @@ bool JudySeekOptimizer::allocate_lb(const uint64_t& hint_lb,
     // Look up hint_lb on jarr_free_lb_
     ptr_j_entry = (Word_t *)JudyLGet(
         jarr_free_lb_, (Word_t)hint_lb, PJE0);
-    if (ptr_j_entry != NULL) {
+    if (!is_hint_allowed(hint_lb, num_blocks)) {
+        // Hint lies in a region of another size class
+    } else if (ptr_j_entry != NULL) {
         // Entry found, check if len is available
         free_len = *(uint64_t *)ptr_j_entry;
         if (num_blocks <= free_len) {
@@ -518,13 +538,22 @@ bool JudySeekOptimizer::allocate_lb(const uint64_t& hint_lb,
                             hint_lb, num_blocks, allocated_lb)) {
                     is_allocable = true;
                 }
+            } else if (size_class_region_blocks_ != 0) {
+                // Only the hint itself is taken from the previous
+                // chunk, anything else goes to the size class regions
+                if (neighbor_last_lb == hint_lb && num_blocks == 1) {
+                    if (split_curr_chunk(neighbor_lb, neighbor_len,
+                                hint_lb, num_blocks, allocated_lb)) {
+                        is_allocable = true;
+                    }
+                }
             } else if (split_prev_chunk(neighbor_lb,
                         neighbor_len, num_blocks, allocated_lb)) {
                     is_allocable = true;
             }
         }
 
-        if (!is_allocable) {
+        if (!is_allocable && size_class_region_blocks_ == 0) {
             // Check next neighbor
             if (is_next_neighbor_allocable(
                         hint_lb, free_len,
@@ -539,6 +568,12 @@ bool JudySeekOptimizer::allocate_lb(const uint64_t& hint_lb,
         }
     }
 
+    // Could not place at hint, use a region of the request size class
+    if (!is_allocable && size_class_region_blocks_ != 0) {
+        is_allocable = allocate_size_class(
+                hint_lb, num_blocks, allocated_lb);
+    }
+
     // Still not found ?
     // Search jarr_free_contig_len_ for allocation
 
@@ -603,6 +638,7 @@ bool JudySeekOptimizer::allocate_lb(const uint64_t& hint_lb,
     if(is_allocable) {
         // Record allocated on counter manager and return
         this->record_allocated_blocks(num_blocks);
+        account_regions(allocated_lb, num_blocks, true);
         return true;
     } else {
         return false;
@@ -837,6 +873,7 @@ bool JudySeekOptimizer::free_lb(
 
     // Record freed blocks
     this->record_freed_blocks(num_blocks);
+    account_regions(lb, num_blocks, false);
 
     return true;
 }
@@ -917,4 +954,340 @@ void JudySeekOptimizer::print_map() const {
     jarr_free_contig_len_->print_map();
 }
 
+void JudySeekOptimizer::set_size_class_regions(uint64_t region_blocks) {
+
+    if (CounterManager::get_allocated_blocks() != 0) {
+        // Regions do not account blocks allocated before
+        assert(("ERROR", false));
+        return;
+    }
+
+    size_class_region_blocks_ = region_blocks;
+    if (region_blocks == 0) {
+        num_regions_ = 0;
+        return;
+    }
+    num_regions_ = (total_blocks_ + region_blocks - 1) / region_blocks;
+
+    return;
+}
+
+uint32_t JudySeekOptimizer::get_size_class(uint64_t num_blocks) {
+
+    uint32_t size_class = 0;
+
+    while (num_blocks > size_class_max_blocks[size_class]) {
+        size_class++;
+    }
+
+    return size_class;
+}
+
+uint32_t JudySeekOptimizer::get_hist_bucket(uint64_t len) {
+
+    uint32_t bucket = 63 - __builtin_clzll(len);
+
+    if (bucket >= BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS) {
+        bucket = BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS - 1;
+    }
+
+    return bucket;
+}
+
+uint64_t JudySeekOptimizer::get_region_len(const uint64_t& region) const {
+
+    uint64_t region_start = region * size_class_region_blocks_;
+
+    return std::min(size_class_region_blocks_, total_blocks_ - region_start);
+}
+
+uint64_t JudySeekOptimizer::get_region_used(const uint64_t& region) const {
+
+    Word_t *ptr_j_entry = NULL;
+
+    ptr_j_entry = (Word_t *)JudyLGet(
+            jarr_region_used_, (Word_t)region, PJE0);
+    if (ptr_j_entry == NULL) {
+        return 0;
+    }
+
+    return (uint64_t)*ptr_j_entry;
+}
+
+bool JudySeekOptimizer::is_hint_allowed(
+        const uint64_t& hint_lb,
+        const uint64_t& num_blocks) const {
+
+    Word_t *ptr_j_entry = NULL;
+    uint64_t region = 0;
+
+    // Single blocks are meta blocks placed by hash, always honored
+    if (size_class_region_blocks_ == 0 || num_blocks == 1 ||
+            hint_lb < logical_start_block_offset_) {
+        return true;
+    }
+
+    region = (hint_lb - logical_start_block_offset_) /
+        size_class_region_blocks_;
+    ptr_j_entry = (Word_t *)JudyLGet(
+            jarr_region_class_, (Word_t)region, PJE0);
+    if (ptr_j_entry == NULL) {
+        // Let the class claim a region through allocate_size_class
+        return false;
+    }
+
+    return *ptr_j_entry == get_size_class(num_blocks) + 1;
+}
+
+bool JudySeekOptimizer::is_range_claimable(
+        const uint64_t& lb,
+        const uint64_t& num_blocks,
+        const uint32_t& size_class) const {
+
+    Word_t *ptr_j_entry = NULL;
+    uint64_t first_region =
+        (lb - logical_start_block_offset_) / size_class_region_blocks_;
+    uint64_t last_region = ((lb + num_blocks - 1) -
+            logical_start_block_offset_) / size_class_region_blocks_;
+
+    for (uint64_t region = first_region; region <= last_region; region++) {
+        ptr_j_entry = (Word_t *)JudyLGet(
+                jarr_region_class_, (Word_t)region, PJE0);
+        if (ptr_j_entry != NULL && *ptr_j_entry != size_class + 1) {
+            // Region serves another size class
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void JudySeekOptimizer::claim_regions(
+        const uint64_t& lb,
+        const uint64_t& num_blocks,
+        const uint32_t& size_class) {
+
+    Word_t *ptr_j_entry = NULL;
+    uint64_t first_region =
+        (lb - logical_start_block_offset_) / size_class_region_blocks_;
+    uint64_t last_region = ((lb + num_blocks - 1) -
+            logical_start_block_offset_) / size_class_region_blocks_;
+
+    for (uint64_t region = first_region; region <= last_region; region++) {
+        ptr_j_entry = (Word_t *)JudyLIns(
+                &jarr_region_class_, (Word_t)region, PJE0);
+        if (*ptr_j_entry != 0) {
+            // Already claimed
+            continue;
+        }
+        *ptr_j_entry = (Word_t)(size_class + 1);
+
+        ptr_j_entry = (Word_t *)JudyLIns(
+                &jarr_class_regions_[size_class], (Word_t)region, PJE0);
+        *ptr_j_entry = 1;
+        num_class_regions_[size_class]++;
+    }
+
+    return;
+}
+
+void JudySeekOptimizer::account_regions(
+        const uint64_t& lb,
+        const uint64_t& num_blocks,
+        bool is_alloc) {
+
+    Word_t *ptr_j_entry = NULL;
+    uint64_t offset = 0;
+    uint64_t end_offset = 0;
+    uint64_t region = 0;
+    uint64_t region_end_offset = 0;
+    uint64_t len = 0;
+    uint32_t size_class = 0;
+
+    if (size_class_region_blocks_ == 0) {
+        return;
+    }
+
+    offset = lb - logical_start_block_offset_;
+    end_offset = offset + num_blocks;
+    region = offset / size_class_region_blocks_;
+
+    while (offset < end_offset) {
+        region_end_offset = (region + 1) * size_class_region_blocks_;
+        len = std::min(end_offset, region_end_offset) - offset;
+
+        if (is_alloc) {
+            ptr_j_entry = (Word_t *)JudyLIns(
+                    &jarr_region_used_, (Word_t)region, PJE0);
+            *ptr_j_entry = *ptr_j_entry + len;
+        } else {
+            ptr_j_entry = (Word_t *)JudyLGet(
+                    jarr_region_used_, (Word_t)region, PJE0);
+            if (ptr_j_entry == NULL || *ptr_j_entry < len) {
+                // Freeing more than was allocated in the region
+                assert(("ERROR", false));
+                return;
+            }
+            *ptr_j_entry = *ptr_j_entry - len;
+
+            if (*ptr_j_entry == 0) {
+                JudyLDel(&jarr_region_used_, (Word_t)region, PJE0);
+
+                // Release the fully free region from its size class
+                ptr_j_entry = (Word_t *)JudyLGet(
+                        jarr_region_class_, (Word_t)region, PJE0);
+                if (ptr_j_entry != NULL) {
+                    size_class = (uint32_t)(*ptr_j_entry - 1);
+                    JudyLDel(&jarr_class_regions_[size_class],
+                            (Word_t)region, PJE0);
+                    JudyLDel(&jarr_region_class_, (Word_t)region, PJE0);
+                    num_class_regions_[size_class]--;
+                }
+            }
+        }
+
+        offset = offset + len;
+        region++;
+    }
+
+    return;
+}
+
+bool JudySeekOptimizer::allocate_in_region(
+        const uint64_t& region,
+        const uint32_t& size_class,
+        const uint64_t& num_blocks,
+        uint64_t& allocated_lb) {
+
+    Word_t *ptr_j_entry = NULL;
+    Word_t chunk_lb = 0;
+    uint64_t chunk_len = 0;
+    uint64_t start_lb = 0;
+    uint64_t end_lb = 0;
+    uint64_t region_lb = logical_start_block_offset_ +
+        region * size_class_region_blocks_;
+    uint64_t region_len = get_region_len(region);
+    uint64_t region_end_lb = region_lb + region_len;
+    bool is_largest = (size_class == BLK_ALLOCATOR_NUM_SIZE_CLASSES - 1);
+    uint64_t needed_blocks = num_blocks;
+
+    // Only the largest class may continue into the next regions
+    if (is_largest && needed_blocks > region_len) {
+        needed_blocks = region_len;
+    }
+    if (region_len - get_region_used(region) < needed_blocks) {
+        return false;
+    }
+
+    // Free chunk overlapping the start of the region, if any
+    chunk_lb = region_lb;
+    ptr_j_entry = (Word_t *)JudyLLast(jarr_free_lb_, &chunk_lb, PJE0);
+    if (ptr_j_entry == NULL || chunk_lb + *ptr_j_entry <= region_lb) {
+        chunk_lb = region_lb;
+        ptr_j_entry = (Word_t *)JudyLNext(jarr_free_lb_, &chunk_lb, PJE0);
+    }
+
+    // First fit within the region
+    while (ptr_j_entry != NULL && chunk_lb < region_end_lb) {
+        chunk_len = *(uint64_t *)ptr_j_entry;
+        start_lb = std::max((uint64_t)chunk_lb, region_lb);
+        end_lb = chunk_lb + chunk_len;
+        if (!is_largest && end_lb > region_end_lb) {
+            end_lb = region_end_lb;
+        }
+
+        if (end_lb - start_lb >= num_blocks &&
+                (!is_largest ||
+                 is_range_claimable(start_lb, num_blocks, size_class))) {
+            return split_curr_chunk(chunk_lb, chunk_len,
+                    start_lb, num_blocks, allocated_lb);
+        }
+
+        ptr_j_entry = (Word_t *)JudyLNext(jarr_free_lb_, &chunk_lb, PJE0);
+    }
+
+    return false;
+}
+
+bool JudySeekOptimizer::allocate_size_class(
+        const uint64_t& hint_lb,
+        const uint64_t& num_blocks,
+        uint64_t& allocated_lb) {
+
+    Word_t *ptr_j_entry = NULL;
+    Word_t region = 0;
+    uint64_t hint_region = 0;
+    uint32_t size_class = get_size_class(num_blocks);
+    uint32_t scanned = 0;
+    bool is_allocated = false;
+
+    if (hint_lb > logical_start_block_offset_) {
+        hint_region = (hint_lb - logical_start_block_offset_) /
+            size_class_region_blocks_;
+    }
+
+    // 1. Regions claimed by the size class, closest after hint first
+    region = hint_region;
+    ptr_j_entry = (Word_t *)JudyLFirst(
+            jarr_class_regions_[size_class], &region, PJE0);
+    while (ptr_j_entry != NULL && !is_allocated) {
+        is_allocated = allocate_in_region(
+                region, size_class, num_blocks, allocated_lb);
+        ptr_j_entry = (Word_t *)JudyLNext(
+                jarr_class_regions_[size_class], &region, PJE0);
+    }
+
+    region = 0;
+    ptr_j_entry = (Word_t *)JudyLFirst(
+            jarr_class_regions_[size_class], &region, PJE0);
+    while (ptr_j_entry != NULL && region < hint_region && !is_allocated) {
+        is_allocated = allocate_in_region(
+                region, size_class, num_blocks, allocated_lb);
+        ptr_j_entry = (Word_t *)JudyLNext(
+                jarr_class_regions_[size_class], &region, PJE0);
+    }
+
+    // 2. Claim a region not used by any size class
+    region = hint_region;
+    while (!is_allocated && scanned < SIZE_CLASS_MAX_CLAIM_SCAN &&
+            JudyLFirstEmpty(jarr_region_class_, &region, PJE0) == 1 &&
+            region < num_regions_) {
+        is_allocated = allocate_in_region(
+                region, size_class, num_blocks, allocated_lb);
+        region++;
+        scanned++;
+    }
+
+    region = 0;
+    while (!is_allocated && scanned < SIZE_CLASS_MAX_CLAIM_SCAN &&
+            JudyLFirstEmpty(jarr_region_class_, &region, PJE0) == 1 &&
+            region < hint_region) {
+        is_allocated = allocate_in_region(
+                region, size_class, num_blocks, allocated_lb);
+        region++;
+        scanned++;
+    }
+
+    if (is_allocated) {
+        claim_regions(allocated_lb, num_blocks, size_class);
+    }
+
+    return is_allocated;
+}
+
+void JudySeekOptimizer::get_frag_stats(
+        dss_blk_allocator_frag_stats_t& stats) const {
+
+    stats.free_blocks += CounterManager::get_free_blocks();
+    stats.free_extents += num_free_extents_;
+    for (uint32_t i = 0; i < BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS; i++) {
+        stats.free_extent_hist[i] += free_extent_hist_[i];
+    }
+    for (uint32_t i = 0; i < BLK_ALLOCATOR_NUM_SIZE_CLASSES; i++) {
+        stats.size_class_regions[i] += num_class_regions_[i];
+    }
+
+    return;
+}
+
 }// End namespace BlockAlloc
@@ -263,6 +263,9 @@ dfly_config_read(struct spdk_conf_section *sp)
         
 	g_dragonfly->num_nw_threads = dfly_spdk_conf_section_get_intval_default(sp, "poll_threads_per_nic", 4);
    	g_dragonfly->mm_buff_count = dfly_spdk_conf_section_get_intval_default(sp, "mm_buff_count", 1024 * 32);
+	g_dragonfly->module_poll_adaptive = spdk_conf_section_get_boolval(sp, "module_poll_adaptive", false);
+	g_dragonfly->module_poll_idle_threshold = dfly_spdk_conf_section_get_intval_default(sp, "module_poll_idle_threshold", DFLY_MODULE_POLL_IDLE_THRESHOLD);
+	g_dragonfly->module_poll_idle_period_us = dfly_spdk_conf_section_get_intval_default(sp, "module_poll_idle_period_us", DFLY_MODULE_POLL_IDLE_PERIOD_US);
 	g_dragonfly->test_nic_bw  = spdk_conf_section_get_boolval(sp, "test_nic_bw", false);
    	g_dragonfly->test_sim_io_timeout = dfly_spdk_conf_section_get_intval_default(sp, "test_sim_io_timeout", 0);
 	g_dragonfly->test_sim_io_stall = spdk_conf_section_get_boolval(sp, "test_sim_io_stall", false);
@@ -297,6 +300,10 @@ dfly_config_read(struct spdk_conf_section *sp)
 			"wal_log_batch_nr_obj_adjust", WAL_LOG_BATCH_NR_OBJ_ADJUST);
 	g_wal_conf.wal_log_batch_timeout_us_adjust = dfly_spdk_conf_section_get_intval_default(sp,
 			"wal_log_batch_timeout_us_adjust", WAL_LOG_BATCH_TIMEOUT_US_ADJUST);
+	g_wal_conf.wal_log_commit_target_us = dfly_spdk_conf_section_get_intval_default(sp,
+					      "wal_log_commit_target_us", WAL_LOG_COMMIT_TARGET_US);
+	if (g_wal_conf.wal_log_commit_target_us < 0)
+		g_wal_conf.wal_log_commit_target_us = 0;
 
 	g_wal_conf.wal_cache_flush_period_ms = dfly_spdk_conf_section_get_intval_default(sp,
 					       "wal_cache_flush_period_ms", WAL_CACHE_FLUSH_PERIOD_MS);
@@ -307,6 +314,19 @@ dfly_config_read(struct spdk_conf_section *sp)
 	g_wal_conf.wal_log_crash_test = dfly_spdk_conf_section_get_intval_default(sp,
 					"wal_log_crash_test", WAL_LOG_CRASH_TEST);
 
+	g_wal_conf.wal_log_recover_nr_zones = dfly_spdk_conf_section_get_intval_default(sp,
+					      "wal_log_recover_nr_zones", WAL_LOG_RECOVER_NR_ZONES);
+	if (g_wal_conf.wal_log_recover_nr_zones < 1)
+		g_wal_conf.wal_log_recover_nr_zones = 1;
+
+	g_wal_conf.wal_log_recover_qd = dfly_spdk_conf_section_get_intval_default(sp,
+					"wal_log_recover_qd", WAL_LOG_RECOVER_QD);
+	if (g_wal_conf.wal_log_recover_qd < 1)
+		g_wal_conf.wal_log_recover_qd = 1;
+
+	g_wal_conf.wal_log_dev_pmem = dfly_spdk_conf_section_get_intval_default(sp,
+				      "wal_log_dev_pmem", WAL_LOG_DEV_PMEM);
+
 	g_wal_conf.wal_nr_log_dev = 0;
 	for (int i = 0; i < WAL_MAX_LOG_DEV; i++) {
 		char *log_name = spdk_conf_section_get_nmval(sp, "wal_log_dev_name", i, 0);
@@ -381,6 +401,47 @@ dfly_config_read(struct spdk_conf_section *sp)
 	val = spdk_conf_section_get_boolval(sp, "kvtrans_dump_mem_meta", false);
 	set_kvtrans_dump_mem_meta_enabled(val);
 
+	set_kvtrans_batch_size(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_batch_size",
+			       1));
+
+	set_kvtrans_meta_cache_blks(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_meta_cache_blks",
+			       0));
+
+	set_kvtrans_key_filter_keys(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_key_filter_keys",
+			       0));
+
+	set_kvtrans_placement(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_placement",
+			       0));
+
+	set_kvtrans_cuckoo_bucket_blks(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_cuckoo_bucket_blks",
+			       4));
+
+	val = spdk_conf_section_get_boolval(sp, "kvtrans_packed_meta", false);
+	set_kvtrans_packed_meta(val);
+
+	set_kvtrans_boot_ranges(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_boot_ranges",
+			       4));
+
+	val = spdk_conf_section_get_boolval(sp, "kvtrans_index_snapshot", true);
+	set_kvtrans_index_snapshot(val);
+
+	set_kvtrans_ba_alloc_groups(dfly_spdk_conf_section_get_intval_default(sp, "kvtrans_ba_alloc_groups",
+			       1));
+
+	set_kvtrans_ba_meta_sync_group_reqs(dfly_spdk_conf_section_get_intval_default(sp,
+			"kvtrans_ba_meta_sync_group_reqs", 1));
+	set_kvtrans_ba_meta_sync_group_window_us(dfly_spdk_conf_section_get_intval_default(sp,
+			"kvtrans_ba_meta_sync_group_window_us", 50));
+
+	val = spdk_conf_section_get_boolval(sp, "kvtrans_ba_journal", true);
+	set_kvtrans_ba_journal(val);
+
+	val = spdk_conf_section_get_boolval(sp, "kvtrans_ba_extent_tree", false);
+	set_kvtrans_ba_extent_tree(val);
+
+	set_kvtrans_ba_size_class_region_blocks(dfly_spdk_conf_section_get_intval_default(sp,
+			"kvtrans_ba_size_class_region_blocks", 0));
+
     return;
 }
 
@@ -319,6 +319,25 @@ void *dfly_io_thread_instance_destroy(void *mctx, void *inst_ctx)
 	return NULL;
 }
 
+//Stage io task ops for the whole batch so adjacent LBAs merge across requests
+void dfly_io_req_batch_start(void *ctx)
+{
+	struct io_thread_inst_ctx_s *thrd_inst = (struct io_thread_inst_ctx_s *)ctx;
+
+	if(thrd_inst->module_ctx->dfly_subsys->use_io_task) {
+		dss_io_task_plug();
+	}
+}
+
+void dfly_io_req_batch_end(void *ctx)
+{
+	struct io_thread_inst_ctx_s *thrd_inst = (struct io_thread_inst_ctx_s *)ctx;
+
+	if(thrd_inst->module_ctx->dfly_subsys->use_io_task) {
+		dss_io_task_unplug();
+	}
+}
+
 struct dfly_module_ops io_module_ops {
 	.module_init_instance_context = dfly_io_thread_instance_init,
 	.module_rpoll = dfly_io_req_process,
@@ -327,6 +346,8 @@ struct dfly_module_ops io_module_ops {
 	.module_gpoll = NULL,
 	.find_instance_context = NULL,
 	.module_instance_destroy = dfly_io_thread_instance_destroy,
+	.module_rpoll_batch_start = dfly_io_req_batch_start,
+	.module_rpoll_batch_end = dfly_io_req_batch_end,
 };
 
 int
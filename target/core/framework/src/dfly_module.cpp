@@ -34,6 +34,9 @@
 
 #include <string.h>
 
+#include <deque>
+#include <list>
+
 #include <dragonfly.h>
 
 
@@ -45,10 +48,199 @@
 
 bool dss_module_loaded(dss_module_t *m);
 
+//Requests posted from this thread inside a batch scope, grouped by ring
+struct dfly_module_post_batch_s {
+	struct spdk_ring *ring;
+	struct dfly_module_poller_instance_s *stat_inst;//NULL if not accounted
+	int nreqs;
+	void *reqs[DFLY_MODULE_POST_BATCH_SZ];
+};
+
+static __thread struct {
+	int depth;
+	int nbatches;
+	struct dfly_module_post_batch_s batch[DFLY_MODULE_POST_BATCH_MAX_RINGS];
+} g_dfly_post_batch;
+
+//Returns the number of requests that went into the ring
+static int _dfly_module_ring_enqueue_bulk(struct spdk_ring *ring,
+		struct dfly_module_poller_instance_s *stat_inst,
+		void **reqs, int nreqs, bool batched)
+{
+	int nposted;
+
+	nposted = (int)spdk_ring_enqueue(ring, reqs, nreqs, NULL);
+
+	if (stat_inst && nposted) {
+		dfly_ustat_update_module_inst_stat(stat_inst, 0, nposted);
+		if (batched) {
+			dfly_ustat_update_module_inst_batch_stat(stat_inst, 0, nposted);
+		}
+	}
+
+	return nposted;
+}
+
+//Requests that did not fit in the ring stay at the head of the batch for
+//the next flush. Returns the number of requests still held
+static int _dfly_module_flush_post_batch(struct dfly_module_post_batch_s *b)
+{
+	int nposted;
+
+	if (b->nreqs) {
+		nposted = _dfly_module_ring_enqueue_bulk(b->ring, b->stat_inst, b->reqs, b->nreqs, true);
+		if (nposted < b->nreqs) {
+			memmove(b->reqs, &b->reqs[nposted], (b->nreqs - nposted) * sizeof(void *));
+		}
+		b->nreqs -= nposted;
+	}
+
+	return b->nreqs;
+}
+
+//Returns the number of requests still held for full rings
+static int _dfly_module_flush_all_post_batches(void)
+{
+	int i, nheld = 0, nbatches = 0;
+
+	for (i = 0; i < g_dfly_post_batch.nbatches; i++) {
+		if (_dfly_module_flush_post_batch(&g_dfly_post_batch.batch[i])) {
+			nheld += g_dfly_post_batch.batch[i].nreqs;
+			if (nbatches != i) {
+				g_dfly_post_batch.batch[nbatches] = g_dfly_post_batch.batch[i];
+			}
+			nbatches++;
+		}
+	}
+	g_dfly_post_batch.nbatches = nbatches;
+
+	return nheld;
+}
+
+int dfly_module_ring_enqueue(struct spdk_ring *ring, struct dfly_module_poller_instance_s *stat_inst,
+			     void *req)
+{
+	struct dfly_module_post_batch_s *b = NULL;
+	int i;
+
+	//Requests held for a full ring are looked up outside a batch scope too
+	//so that later posts do not overtake them
+	for (i = 0; i < g_dfly_post_batch.nbatches; i++) {
+		if (g_dfly_post_batch.batch[i].ring == ring &&
+		    g_dfly_post_batch.batch[i].stat_inst == stat_inst) {
+			b = &g_dfly_post_batch.batch[i];
+			break;
+		}
+	}
+
+	if (!b) {
+		if (g_dfly_post_batch.nbatches == DFLY_MODULE_POST_BATCH_MAX_RINGS) {
+			_dfly_module_flush_all_post_batches();
+		}
+		if (!g_dfly_post_batch.depth ||
+		    g_dfly_post_batch.nbatches == DFLY_MODULE_POST_BATCH_MAX_RINGS) {
+			if (_dfly_module_ring_enqueue_bulk(ring, stat_inst, &req, 1, false) != 1) {
+				return -1;
+			}
+			return 0;
+		}
+		b = &g_dfly_post_batch.batch[g_dfly_post_batch.nbatches++];
+		b->ring = ring;
+		b->stat_inst = stat_inst;
+		b->nreqs = 0;
+	}
+
+	if (b->nreqs == DFLY_MODULE_POST_BATCH_SZ &&
+	    _dfly_module_flush_post_batch(b) == DFLY_MODULE_POST_BATCH_SZ) {
+		//Ring is full and the batch can not hold more
+		return -1;
+	}
+
+	b->reqs[b->nreqs++] = req;
+	if (!g_dfly_post_batch.depth) {
+		_dfly_module_flush_all_post_batches();
+	} else if (b->nreqs == DFLY_MODULE_POST_BATCH_SZ) {
+		_dfly_module_flush_post_batch(b);
+	}
+
+	return 0;
+}
+
+#if defined DFLY_MODULE_MSG_MP_SC
+static int _dfly_module_drain_all_deferred_posts(void);
+#endif
+
+int dfly_module_post_batch_flush(void)
+{
+	int nheld;
+
+	if (g_dfly_post_batch.depth) {
+		//Flushed when the outermost scope ends
+		return 0;
+	}
+
+	nheld = _dfly_module_flush_all_post_batches();
+#if defined DFLY_MODULE_MSG_MP_SC
+	nheld += _dfly_module_drain_all_deferred_posts();
+#endif
+
+	return nheld;
+}
+
+void dfly_module_post_batch_begin(void)
+{
+	g_dfly_post_batch.depth++;
+}
+
+void dfly_module_post_batch_end(void)
+{
+	assert(g_dfly_post_batch.depth > 0);
+	g_dfly_post_batch.depth--;
+	if (!g_dfly_post_batch.depth) {
+		_dfly_module_flush_all_post_batches();
+	}
+}
+
+static int _module_poller(struct dfly_module_poller_instance_s *m_inst);
+static void _dfly_module_set_poll_idle(struct dfly_module_poller_instance_s *m_inst, bool idle);
+static inline void _dfly_module_poll_kick(struct dfly_module_poller_instance_s *m_inst);
+
 int module_poller(void *ctx)
 {
 	struct dfly_module_poller_instance_s *m_inst = (struct dfly_module_poller_instance_s *)ctx;
+	int nprocessed;
+	int nheld;
+
+	//Requests posted while polling go out with one ring enqueue per destination
+	dfly_module_post_batch_begin();
+	nprocessed = _module_poller(m_inst);
+	dfly_module_post_batch_end();
+	//Posts held for a full ring keep the poller busy till they go out
+	nheld = dfly_module_post_batch_flush();
+
+	if (m_inst->status != 1) {
+		return nprocessed;
+	}
+
+	dfly_ustat_update_module_inst_stat(m_inst, 2, nprocessed);
+
+	if (g_dragonfly->module_poll_adaptive) {
+		if (nprocessed || nheld) {
+			m_inst->num_empty_polls = 0;
+			if (m_inst->poll_idle) {
+				_dfly_module_set_poll_idle(m_inst, false);
+			}
+		} else if (!m_inst->poll_idle &&
+			   ++m_inst->num_empty_polls >= g_dragonfly->module_poll_idle_threshold) {
+			_dfly_module_set_poll_idle(m_inst, true);
+		}
+	}
+
+	return nprocessed;
+}
 
+static int _module_poller(struct dfly_module_poller_instance_s *m_inst)
+{
 	int nprocessed = 0;
 	int num_msgs, i;
 	int ret;
@@ -83,8 +275,15 @@ int module_poller(void *ctx)
 	//deque from ring
 #if defined DFLY_MODULE_MSG_MP_SC
 	num_msgs = spdk_ring_dequeue(m_inst->pipe.msg_ring, reqs, REQ_PER_POLL);
+	if (num_msgs) {
+		__sync_fetch_and_add(&m_inst->msg_ring_credits, num_msgs);
+		dfly_ustat_update_module_inst_batch_stat(m_inst, 1, num_msgs);
+	}
 #endif
 	dfly_ustat_update_module_inst_stat(m_inst, 1, num_msgs);
+	if (num_msgs && m_inst->module->ops->module_rpoll_batch_start) {
+		m_inst->module->ops->module_rpoll_batch_start(m_inst->ctx);
+	}
 	//call registered function for each request
 	for (i = 0; i < num_msgs; i++) {
 		struct dfly_request *req = (struct dfly_request *)reqs[i];
@@ -96,15 +295,75 @@ int module_poller(void *ctx)
 			dfly_handle_request(req);
 		}
 	}
+	if (num_msgs && m_inst->module->ops->module_rpoll_batch_end) {
+		m_inst->module->ops->module_rpoll_batch_end(m_inst->ctx);
+	}
 	nprocessed += num_msgs;
 
 	if (m_inst->module->ops->module_gpoll && dss_module_loaded(m_inst->module)) {
-		m_inst->module->ops->module_gpoll(m_inst->ctx);
+		//Positive return means the generic poller still has work pending
+		ret = m_inst->module->ops->module_gpoll(m_inst->ctx);
+		if (ret > 0) {
+			nprocessed += ret;
+		}
 	}
 
 	return nprocessed;
 }
 
+static void _dfly_module_set_poll_idle(struct dfly_module_poller_instance_s *m_inst, bool idle)
+{
+	uint64_t period_us = idle ? g_dragonfly->module_poll_idle_period_us : 0;
+
+	//Safe from within module_poller, the current poller is released after it returns
+	spdk_poller_unregister(&m_inst->mpoller);
+	m_inst->mpoller = spdk_poller_register(module_poller, m_inst, period_us);
+	assert(m_inst->mpoller);
+
+	//Pairs with the acquire load in _dfly_module_poll_kick
+	__atomic_store_n(&m_inst->poll_idle, idle, __ATOMIC_RELEASE);
+	m_inst->num_empty_polls = 0;
+	if (idle) {
+		dfly_ustat_update_module_inst_stat(m_inst, 3, 0);
+	}
+	DFLY_DEBUGLOG(DFLY_LOG_MODULE, "Module %s instance on core %d poll period %lu us\n",
+		      m_inst->module->name, m_inst->icore, period_us);
+
+#if defined DFLY_MODULE_MSG_MP_SC
+	//A poster that enqueued before seeing poll_idle set did not kick
+	if (idle) {
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (spdk_ring_count(m_inst->pipe.msg_ring) || spdk_ring_count(m_inst->pipe.cmpl_ring)) {
+			_dfly_module_set_poll_idle(m_inst, false);
+		}
+	}
+#endif
+}
+
+static void _dfly_module_poll_kick_cb(void *ctx)
+{
+	struct dfly_module_poller_instance_s *m_inst = (struct dfly_module_poller_instance_s *)ctx;
+
+	__sync_lock_release(&m_inst->poll_kick_pending);
+	if (m_inst->status == 1 && __atomic_load_n(&m_inst->poll_idle, __ATOMIC_ACQUIRE)) {
+		_dfly_module_set_poll_idle(m_inst, false);
+	}
+}
+
+//Bring an idle instance back to busy polling as soon as work is posted to it
+static inline void _dfly_module_poll_kick(struct dfly_module_poller_instance_s *m_inst)
+{
+	//Orders the load after the ring enqueue, pairs with the fence in _dfly_module_set_poll_idle
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (spdk_likely(!__atomic_load_n(&m_inst->poll_idle, __ATOMIC_ACQUIRE))) {
+		return;
+	}
+
+	if (__sync_lock_test_and_set(&m_inst->poll_kick_pending, 1) == 0) {
+		spdk_thread_send_msg(m_inst->thread, _dfly_module_poll_kick_cb, m_inst);
+	}
+}
+
 #if defined DFLY_MODULE_MSG_MP_SC
 static inline struct dfly_module_poller_instance_s *dfly_get_module_instance(dfly_module_t *module)
 {
@@ -123,35 +382,184 @@ static inline struct dfly_module_poller_instance_s *dfly_get_module_instance(dfl
 
 	return (m_inst);
 }
+static inline struct dfly_module_poller_instance_s *dfly_find_module_instance(dfly_module_t *module, struct dfly_request *req)
+{
+	if (module->ops->find_instance_context) {
+		return (struct dfly_module_poller_instance_s *)module->ops->find_instance_context(req);
+	}
+	//Default to round robin across module instance
+	return dfly_get_module_instance(module);
+}
+
+//Posts that found no ring credit or no room in the ring, kept per
+//destination ring in post order by the posting thread
+struct dfly_module_deferred_post_s {
+	struct spdk_ring *ring;
+	struct dfly_module_poller_instance_s *m_inst;
+	struct dfly_module_poller_instance_s *stat_inst;
+	bool msg;//Posted on the message ring and accounted in msg_ring_credits
+	std::deque<void *> reqs;
+};
+
+static thread_local std::list<struct dfly_module_deferred_post_s> g_dfly_deferred_posts;
+
+static inline bool _dfly_module_take_credit(struct dfly_module_poller_instance_s *m_inst)
+{
+	if (__sync_sub_and_fetch(&m_inst->msg_ring_credits, 1) < 0) {
+		__sync_fetch_and_add(&m_inst->msg_ring_credits, 1);
+		return false;
+	}
+
+	return true;
+}
+
+//Returns the number of requests still deferred
+static int _dfly_module_drain_deferred_posts(struct dfly_module_deferred_post_s *d)
+{
+	int nposted = 0;
+
+	while (!d->reqs.empty()) {
+		if (d->msg && !_dfly_module_take_credit(d->m_inst)) {
+			break;
+		}
+		if (dfly_module_ring_enqueue(d->ring, d->stat_inst, d->reqs.front())) {
+			if (d->msg) {
+				__sync_fetch_and_add(&d->m_inst->msg_ring_credits, 1);
+			}
+			break;
+		}
+		d->reqs.pop_front();
+		nposted++;
+	}
+
+	if (nposted) {
+		_dfly_module_poll_kick(d->m_inst);
+	}
+
+	return d->reqs.size();
+}
+
+static int _dfly_module_drain_all_deferred_posts(void)
+{
+	std::list<struct dfly_module_deferred_post_s>::iterator it;
+	int ndeferred = 0;
+
+	it = g_dfly_deferred_posts.begin();
+	while (it != g_dfly_deferred_posts.end()) {
+		if (_dfly_module_drain_deferred_posts(&*it)) {
+			ndeferred += it->reqs.size();
+			it++;
+		} else {
+			it = g_dfly_deferred_posts.erase(it);
+		}
+	}
+
+	return ndeferred;
+}
+
+/**
+ * @brief Post req on a module instance ring. Without a ring credit or room
+ *        in the ring req is deferred on this thread and retried by
+ *        dfly_module_post_batch_flush, behind earlier deferred posts to the
+ *        same ring
+ *
+ * @param msg post on the message ring, the completion ring otherwise
+ * @param have_credit message ring credit was already taken by the caller
+ * @return int 0 if req was posted or deferred, -1 if too many posts are deferred
+ */
+static int _dfly_module_post(struct dfly_module_poller_instance_s *m_inst,
+			     struct dfly_module_poller_instance_s *stat_inst,
+			     void *req, bool msg, bool have_credit)
+{
+	struct spdk_ring *ring = msg ? m_inst->pipe.msg_ring : m_inst->pipe.cmpl_ring;
+	struct dfly_module_deferred_post_s *d = NULL;
+	std::list<struct dfly_module_deferred_post_s>::iterator it;
+
+	for (it = g_dfly_deferred_posts.begin(); it != g_dfly_deferred_posts.end(); it++) {
+		if (it->ring == ring && it->stat_inst == stat_inst) {
+			d = &*it;
+			break;
+		}
+	}
+
+	if (!d || !_dfly_module_drain_deferred_posts(d)) {
+		if (!msg || have_credit || _dfly_module_take_credit(m_inst)) {
+			if (!dfly_module_ring_enqueue(ring, stat_inst, req)) {
+				_dfly_module_poll_kick(m_inst);
+				return 0;
+			}
+			if (msg) {
+				__sync_fetch_and_add(&m_inst->msg_ring_credits, 1);
+			}
+		}
+	} else if (have_credit) {
+		//Keep the order of deferred posts
+		__sync_fetch_and_add(&m_inst->msg_ring_credits, 1);
+	}
+
+	if (!d) {
+		g_dfly_deferred_posts.emplace_back();
+		d = &g_dfly_deferred_posts.back();
+		d->ring = ring;
+		d->m_inst = m_inst;
+		d->stat_inst = stat_inst;
+		d->msg = msg;
+	} else if (d->reqs.size() >= DFLY_MODULE_RING_SZ) {
+		return -1;
+	}
+
+	d->reqs.push_back(req);
+
+	return 0;
+}
 #endif
 
 
 void dfly_module_post_request(struct dfly_module_s *module, struct dfly_request *req)
 {
-	int rc;
+#if defined DFLY_MODULE_MSG_MP_SC
+	struct dfly_module_poller_instance_s *m_inst;
+
+	m_inst = dfly_find_module_instance(module, req);
+
+	if (_dfly_module_post(m_inst, m_inst, req, true, false)) {
+		DSS_ERRLOG("Module %s ring full on core %d\n", module->name, m_inst->icore);
+		assert(false);
+	}
+#endif
+}
 
+struct dfly_module_poller_instance_s *dfly_module_reserve_request(struct dfly_module_s *module, struct dfly_request *req)
+{
 #if defined DFLY_MODULE_MSG_MP_SC
 	struct dfly_module_poller_instance_s *m_inst;
 
-	if (module->ops->find_instance_context) {
-		m_inst = (struct dfly_module_poller_instance_s *)module->ops->find_instance_context(req);
-	} else {
-		//Default to round robin across module instance
-		m_inst = dfly_get_module_instance(module);
+	m_inst = dfly_find_module_instance(module, req);
+
+	if (__sync_sub_and_fetch(&m_inst->msg_ring_credits, 1) < DFLY_MODULE_RING_RESERVED_SLOTS) {
+		__sync_fetch_and_add(&m_inst->msg_ring_credits, 1);
+		return NULL;
 	}
 
-	rc = spdk_ring_enqueue(m_inst->pipe.msg_ring, (void **)&req, 1, NULL);
-	if (rc != 1) {
+	return m_inst;
+#else
+	return NULL;
+#endif
+}
+
+void dfly_module_post_reserved_request(struct dfly_module_poller_instance_s *m_inst, struct dfly_request *req)
+{
+#if defined DFLY_MODULE_MSG_MP_SC
+	//Credit was taken in dfly_module_reserve_request
+	if (_dfly_module_post(m_inst, m_inst, req, true, true)) {
+		DSS_ERRLOG("Module %s ring full on core %d\n", m_inst->module->name, m_inst->icore);
 		assert(false);
 	}
-	dfly_ustat_update_module_inst_stat(m_inst, 0, 1);
 #endif
 }
 
 void dfly_module_complete_request(struct dfly_module_s *module, struct dfly_request *req)
 {
-	int rc;
-
 #if defined DFLY_MODULE_MSG_MP_SC
 	struct dfly_module_poller_instance_s *m_inst;
 
@@ -162,8 +570,8 @@ void dfly_module_complete_request(struct dfly_module_s *module, struct dfly_requ
 		m_inst = dfly_get_module_instance(module);
 	}
 
-	rc = spdk_ring_enqueue(m_inst->pipe.cmpl_ring, (void **)&req, 1, NULL);
-	if (rc != 1) {
+	if (_dfly_module_post(m_inst, NULL, req, false, false)) {
+		DSS_ERRLOG("Module %s completion ring full on core %d\n", module->name, m_inst->icore);
 		assert(false);
 	}
 #endif
@@ -211,10 +619,12 @@ void dfly_module_thread_start(void *inst, void *cb_event)
 	DFLY_INFOLOG(DFLY_LOG_MODULE, "Launching module thread on core %u\n", m_inst->icore);
 #if defined DFLY_MODULE_MSG_MP_SC
 	//Initialize spdk ring
-	m_inst->pipe.msg_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, 65536, SPDK_ENV_SOCKET_ID_ANY);
+	m_inst->pipe.msg_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, DFLY_MODULE_RING_SZ, SPDK_ENV_SOCKET_ID_ANY);
 	assert(m_inst->pipe.msg_ring);
+	//Ring can hold one less than its size
+	m_inst->msg_ring_credits = DFLY_MODULE_RING_SZ - 1;
 
-	m_inst->pipe.cmpl_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, 65536, SPDK_ENV_SOCKET_ID_ANY);
+	m_inst->pipe.cmpl_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, DFLY_MODULE_RING_SZ, SPDK_ENV_SOCKET_ID_ANY);
 	assert(m_inst->pipe.cmpl_ring);
 #endif
 
@@ -227,6 +637,11 @@ void dfly_module_thread_start(void *inst, void *cb_event)
 	module->num_threads++;
 #endif
 
+	m_inst->thread = spdk_get_thread();
+	m_inst->poll_idle = false;
+	m_inst->poll_kick_pending = 0;
+	m_inst->num_empty_polls = 0;
+
 	m_inst->status = 1;
 	m_inst->mpoller = spdk_poller_register(module_poller, m_inst, 0);
 	assert(m_inst->mpoller);
@@ -537,30 +952,22 @@ dss_module_status_t dss_module_dec_async_pending_task(dss_module_t *m)
 
 dss_module_status_t dss_module_post_to_instance(dss_module_type_t mtype, dss_module_instance_t *module_thread_instance, void *req)
 {
-	int rc;
 	//TODO: Verify module thread instance pointer
 #if defined DFLY_MODULE_MSG_MP_SC
-	rc = spdk_ring_enqueue(module_thread_instance->pipe.msg_ring, (void **)&req, 1, NULL);
-	if (rc != 1) {
-		DSS_ASSERT(rc == 1);
+	if (_dfly_module_post(module_thread_instance, module_thread_instance, req, true, false)) {
 		return DSS_MODULE_STATUS_ERROR;
 	}
-	dfly_ustat_update_module_inst_stat(module_thread_instance, 0, 1);
 	return DSS_MODULE_STATUS_SUCCESS;
 #endif
 }
 
 dss_module_status_t dss_module_post_to_instance_cq(dss_module_type_t mtype, dss_module_instance_t *module_thread_instance, void *req)
 {
-	int rc;
 	//TODO: Verify module thread instance pointer
 #if defined DFLY_MODULE_MSG_MP_SC
-	rc = spdk_ring_enqueue(module_thread_instance->pipe.cmpl_ring, (void **)&req, 1, NULL);
-	if (rc != 1) {
-		DSS_ASSERT(rc == 1);
+	if (_dfly_module_post(module_thread_instance, module_thread_instance, req, false, false)) {
 		return DSS_MODULE_STATUS_ERROR;
 	}
-	dfly_ustat_update_module_inst_stat(module_thread_instance, 0, 1);
 	return DSS_MODULE_STATUS_SUCCESS;
 #endif
 }
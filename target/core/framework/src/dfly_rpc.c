@@ -980,3 +980,106 @@ invalid:
 	return;
 }
 SPDK_RPC_REGISTER("dss_rdb_compact", dss_rpc_rdb_compact, SPDK_RPC_RUNTIME)
+
+struct dss_rpc_ba_frag_stats_ctx_s {
+	struct spdk_jsonrpc_request *request;
+	struct spdk_json_write_ctx *w;
+	struct dfly_subsystem *df_subsys;
+	uint32_t dev_index;
+};
+
+static void dss_rpc_ba_frag_stats_next(struct dss_rpc_ba_frag_stats_ctx_s *ctx);
+
+// Called on the kvtrans thread owning the device
+static void dss_rpc_ba_frag_stats_dev_done(void *cb_arg, const char *dev_name,
+		dss_blk_allocator_frag_stats_t *stats)
+{
+	struct dss_rpc_ba_frag_stats_ctx_s *ctx = (struct dss_rpc_ba_frag_stats_ctx_s *)cb_arg;
+	struct spdk_json_write_ctx *w = ctx->w;
+	int j;
+
+	if (stats) {
+		spdk_json_write_object_begin(w);
+
+		spdk_json_write_name(w, "device");
+		spdk_json_write_string(w, dev_name ? dev_name : "");
+		spdk_json_write_name(w, "free_blocks");
+		spdk_json_write_uint64(w, stats->free_blocks);
+		spdk_json_write_name(w, "free_extents");
+		spdk_json_write_uint64(w, stats->free_extents);
+
+		// Bucket i holds extents of [2^i, 2^(i+1)) blocks
+		spdk_json_write_name(w, "free_extent_hist");
+		spdk_json_write_array_begin(w);
+		for(j=0; j < BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS; j++) {
+			spdk_json_write_uint64(w, stats->free_extent_hist[j]);
+		}
+		spdk_json_write_array_end(w);
+
+		spdk_json_write_name(w, "size_class_regions");
+		spdk_json_write_array_begin(w);
+		for(j=0; j < BLK_ALLOCATOR_NUM_SIZE_CLASSES; j++) {
+			spdk_json_write_uint64(w, stats->size_class_regions[j]);
+		}
+		spdk_json_write_array_end(w);
+
+		spdk_json_write_object_end(w);
+	}
+
+	ctx->dev_index++;
+	dss_rpc_ba_frag_stats_next(ctx);
+}
+
+// Devices are read one at a time, the reply is sent from the thread of the last one
+static void dss_rpc_ba_frag_stats_next(struct dss_rpc_ba_frag_stats_ctx_s *ctx)
+{
+	while(ctx->dev_index < ctx->df_subsys->num_io_devices) {
+		if(!dss_kvtrans_module_get_ba_frag_stats(ctx->df_subsys, ctx->dev_index,
+					dss_rpc_ba_frag_stats_dev_done, ctx)) {
+			return;
+		}
+		ctx->dev_index++;
+	}
+
+	spdk_json_write_array_end(ctx->w);
+	spdk_jsonrpc_end_result(ctx->request, ctx->w);
+	free(ctx);
+}
+
+static void dss_rpc_get_ba_frag_stats(struct spdk_jsonrpc_request *request,
+		const struct spdk_json_val *params)
+{
+	struct dss_rpc_nqn_req_s req = {};
+	struct dss_rpc_ba_frag_stats_ctx_s *ctx;
+	struct dfly_subsystem *df_subsys;
+
+	if((df_subsys = dss_rpc_decode_nqn_param(params, &req)) == NULL) {
+		goto invalid;
+	}
+	free_rpc_nqn_req(&req);
+
+	ctx = calloc(1, sizeof(struct dss_rpc_ba_frag_stats_ctx_s));
+	if (ctx == NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Out of memory");
+		return;
+	}
+
+	ctx->w = spdk_jsonrpc_begin_result(request);
+	if (ctx->w == NULL) {
+		free(ctx);
+		return;
+	}
+	ctx->request = request;
+	ctx->df_subsys = df_subsys;
+
+	// Allocators are only read on the kvtrans threads that update them
+	spdk_json_write_array_begin(ctx->w);
+	dss_rpc_ba_frag_stats_next(ctx);
+	return;
+
+invalid:
+	spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid Parameters");
+	free_rpc_nqn_req(&req);
+	return;
+}
+SPDK_RPC_REGISTER("dss_get_ba_frag_stats", dss_rpc_get_ba_frag_stats, SPDK_RPC_RUNTIME)
@@ -136,6 +136,31 @@ const stat_rqpair_t stat_rqpair_io_table = {
 const stat_module_t stat_module_req_table = {
 	{"i_reqs", USTAT_TYPE_UINT64, 0, NULL},
 	{"i_reqs_max", USTAT_TYPE_UINT64, 0, NULL},
+	{"enq_batches", USTAT_TYPE_UINT64, 0, NULL},
+	{"enq_reqs", USTAT_TYPE_UINT64, 0, NULL},
+	{"enq_batch_max", USTAT_TYPE_UINT64, 0, NULL},
+	{"deq_batches", USTAT_TYPE_UINT64, 0, NULL},
+	{"deq_reqs", USTAT_TYPE_UINT64, 0, NULL},
+	{"busy_polls", USTAT_TYPE_UINT64, 0, NULL},
+	{"idle_polls", USTAT_TYPE_UINT64, 0, NULL},
+	{"idle_switches", USTAT_TYPE_UINT64, 0, NULL},
+};
+
+const stat_meta_cache_t stat_meta_cache_table = {
+	{"hits", USTAT_TYPE_UINT64, 0, NULL},
+	{"misses", USTAT_TYPE_UINT64, 0, NULL},
+	{"fills", USTAT_TYPE_UINT64, 0, NULL},
+	{"evictions", USTAT_TYPE_UINT64, 0, NULL},
+	{"invalidations", USTAT_TYPE_UINT64, 0, NULL},
+};
+
+const stat_wal_commit_t stat_wal_commit_table = {
+	{"batch_nr_obj", USTAT_TYPE_UINT64, 0, NULL},
+	{"batch_timeout_us", USTAT_TYPE_UINT64, 0, NULL},
+	{"p99_us", USTAT_TYPE_UINT64, 0, NULL},
+	{"device_us", USTAT_TYPE_UINT64, 0, NULL},
+	{"arrival_ns", USTAT_TYPE_UINT64, 0, NULL},
+	{"batches", USTAT_TYPE_UINT64, 0, NULL},
 };
 
 void dfly_ustat_insert_stat_thread_table(ustat_struct_t **s, int id, const stat_module_t *table,
@@ -481,6 +506,54 @@ dfly_ustat_remove_module_inst_stat(void *poller_inst)
 	dfly_ustat_delete(module_inst->stat_module);
 }
 
+int
+dfly_ustat_init_meta_cache_stat(stat_meta_cache_t **stat, int id)
+{
+	char *ename = alloca(STAT_ENAME_LEN);
+	(void) dfly_ustats_get_ename(STAT_ENAME_KVTRANS, id, ename, STAT_ENAME_LEN);
+	ustat_handle *h = dfly_ustats_get_handle();
+	assert(h);
+	(*stat) = (stat_meta_cache_t *)ustat_insert(h, ename, STAT_GNAME_META_CACHE,
+						&ustat_class_test,
+						sizeof(stat_meta_cache_table) / sizeof(ustat_named_t),
+						&stat_meta_cache_table, NULL);
+	if (!(*stat)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+dfly_ustat_remove_meta_cache_stat(stat_meta_cache_t *stat)
+{
+	dfly_ustat_delete(stat);
+}
+
+int
+dfly_ustat_init_wal_commit_stat(stat_wal_commit_t **stat, int id)
+{
+	char *ename = alloca(STAT_ENAME_LEN);
+	(void) dfly_ustats_get_ename(STAT_ENAME_WAL, id, ename, STAT_ENAME_LEN);
+	ustat_handle *h = dfly_ustats_get_handle();
+	assert(h);
+	(*stat) = (stat_wal_commit_t *)ustat_insert(h, ename, STAT_GNAME_WAL_COMMIT,
+						&ustat_class_test,
+						sizeof(stat_wal_commit_table) / sizeof(ustat_named_t),
+						&stat_wal_commit_table, NULL);
+	if (!(*stat)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+dfly_ustat_remove_wal_commit_stat(stat_wal_commit_t *stat)
+{
+	dfly_ustat_delete(stat);
+}
+
 void
 dfly_ustat_update_module_inst_stat(void *poller_inst, int ops, uint64_t num_reqs)
 {
@@ -495,8 +568,42 @@ dfly_ustat_update_module_inst_stat(void *poller_inst, int ops, uint64_t num_reqs
 		if (curr_req > max_req) {
 			dfly_ustat_set_u64(module_inst->stat_module, &module_inst->stat_module->i_reqs_max, curr_req);
 		}
-	} else {
+	} else if (ops == 1) {
 		dfly_ustat_atomic_sub_u64(module_inst->stat_module, &module_inst->stat_module->i_reqs, num_reqs);
+	} else {
+		stat_module_t *st = module_inst->stat_module;
+		ustat_named_t *n;
+
+		//Polls are only accounted from the instance thread
+		if (ops == 3) {
+			n = &st->idle_switches;
+		} else if (num_reqs) {
+			n = &st->busy_polls;
+		} else {
+			n = &st->idle_polls;
+		}
+		dfly_ustat_set_u64(st, n, dfly_ustat_get_u64(st, n) + 1);
+	}
+}
+
+void
+dfly_ustat_update_module_inst_batch_stat(void *poller_inst, int ops, uint64_t num_reqs)
+{
+	struct dfly_module_poller_instance_s *module_inst = (struct dfly_module_poller_instance_s *)
+			poller_inst;
+	stat_module_t *st = module_inst->stat_module;
+
+	if (ops == 0) {
+		dfly_ustat_atomic_inc_u64(st, &st->enq_batches);
+		dfly_ustat_atomic_add_u64(st, &st->enq_reqs, num_reqs);
+		//Racy max across posting cores is good enough for a stat
+		if (num_reqs > dfly_ustat_get_u64(st, &st->enq_batch_max)) {
+			dfly_ustat_set_u64(st, &st->enq_batch_max, num_reqs);
+		}
+	} else {
+		//Dequeue runs only on the instance thread
+		dfly_ustat_set_u64(st, &st->deq_batches, dfly_ustat_get_u64(st, &st->deq_batches) + 1);
+		dfly_ustat_set_u64(st, &st->deq_reqs, dfly_ustat_get_u64(st, &st->deq_reqs) + num_reqs);
 	}
 }
 
@@ -36,6 +36,16 @@
 
 #include <dragonfly.h>
 
+//Idle polls before a worker parks, adapted between min and max
+#define DSS_TPOOL_MIN_SPIN_POLLS (1024)
+#define DSS_TPOOL_MAX_SPIN_POLLS (1024 * 1024)
+//Upper bound on a park, also covers wakeups missed for batched posts
+#define DSS_TPOOL_PARK_TIMEOUT_US (1000)
+//A park shorter than this means work arrives soon after idling, spin longer
+#define DSS_TPOOL_SHORT_PARK_US (100)
+//Only steal from a worker with more queued requests than this
+#define DSS_TPOOL_STEAL_MIN_QD (1)
+
 typedef struct dfly_tpool_s {
 	char name[MAX_MODULE_NAME_LEN];
 	tpool_req_process_fn tpool_req_process;//Request Polling
@@ -52,24 +62,29 @@ typedef struct dfly_tpool_s {
 
 struct dfly_tpool_instance_s {
 	int icore;
+	int index;//Index in module active_thread_arr
 	void *ctx;//instance context info
 	dss_tpool_t *module;
-	struct dfly_module_pipe_s pipe;
+	struct dfly_module_pipe_s pipe;//msg_ring is MP_MC so idle workers can steal
+	int64_t qdepth;//Requests posted and not yet dequeued
 	int status;
 	pthread_t th_h;
+	//Spin then park
+	pthread_mutex_t park_lock;
+	pthread_cond_t park_cond;
+	int parked;
+	uint64_t spin_polls;
+	//Stats
+	uint64_t num_stolen;
+	uint64_t num_parks;
 	TAILQ_ENTRY(dfly_tpool_instance_s) link;// Link of the list of pollers
 };
 
-int _tpool_poller(struct dfly_tpool_instance_s *m_inst)
+static inline void _tpool_process_reqs(struct dfly_tpool_instance_s *m_inst, void **reqs, int num_msgs)
 {
-	int nprocessed = 0;
-	int num_msgs, i;
-	int ret;
-
-	void *reqs[REQ_PER_POLL] = {NULL};
+	int i;
 
-	//deque from ring
-	num_msgs = spdk_ring_dequeue(m_inst->pipe.msg_ring, reqs, REQ_PER_POLL);
+	dfly_module_post_batch_begin();
 	//call registered function for each request
 	for (i = 0; i < num_msgs; i++) {
 		struct dfly_request *req = (struct dfly_request *)reqs[i];
@@ -80,9 +95,119 @@ int _tpool_poller(struct dfly_tpool_instance_s *m_inst)
 		//Process request inline
 		dfly_handle_request(req);
 	}
-	nprocessed += num_msgs;
+	dfly_module_post_batch_end();
+}
+
+static inline int _tpool_dequeue(struct dfly_tpool_instance_s *m_inst, void **reqs, int max_reqs)
+{
+	int num_msgs;
+
+	num_msgs = spdk_ring_dequeue(m_inst->pipe.msg_ring, reqs, max_reqs);
+	if (num_msgs) {
+		__sync_fetch_and_sub(&m_inst->qdepth, num_msgs);
+	}
+
+	return num_msgs;
+}
+
+int _tpool_poller(struct dfly_tpool_instance_s *m_inst)
+{
+	int num_msgs;
+
+	void *reqs[REQ_PER_POLL] = {NULL};
+
+	//deque from ring
+	num_msgs = _tpool_dequeue(m_inst, reqs, REQ_PER_POLL);
+	if (num_msgs) {
+		_tpool_process_reqs(m_inst, reqs, num_msgs);
+	}
+
+	return num_msgs;
+}
+
+/**
+ * @brief Take up to half a poll worth of requests from the most backed up
+ *        sibling worker and process them on this thread
+ */
+static int _tpool_steal(struct dfly_tpool_instance_s *m_inst)
+{
+	dss_tpool_t *module = m_inst->module;
+	struct dfly_tpool_instance_s *victim = NULL, *t_inst;
+	int64_t max_qd = DSS_TPOOL_STEAL_MIN_QD;
+	int num_threads = module->num_threads;
+	int num_msgs, i;
+
+	void *reqs[REQ_PER_POLL / 2] = {NULL};
+
+	for (i = 1; i < num_threads; i++) {
+		t_inst = module->active_thread_arr[(m_inst->index + i) % num_threads];
+		if (t_inst->qdepth > max_qd) {
+			max_qd = t_inst->qdepth;
+			victim = t_inst;
+		}
+	}
+
+	if (!victim) {
+		return 0;
+	}
+
+	num_msgs = _tpool_dequeue(victim, reqs, REQ_PER_POLL / 2);
+	if (num_msgs) {
+		m_inst->num_stolen += num_msgs;
+		_tpool_process_reqs(m_inst, reqs, num_msgs);
+	}
+
+	return num_msgs;
+}
+
+static void _tpool_park(struct dfly_tpool_instance_s *m_inst)
+{
+	struct timespec ts;
+	uint64_t start_tick, park_us;
+	bool woken_early;
+
+	//park_cond waits on CLOCK_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ts.tv_nsec += DSS_TPOOL_PARK_TIMEOUT_US * 1000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
 
-	return nprocessed;
+	start_tick = spdk_get_ticks();
+
+	pthread_mutex_lock(&m_inst->park_lock);
+	__sync_lock_test_and_set(&m_inst->parked, 1);
+	//Pairs with the barrier in dss_tpool_post_request so a post is either
+	//seen here or the poster sees parked and signals
+	__sync_synchronize();
+	if (m_inst->status == 1 && m_inst->qdepth == 0) {
+		m_inst->num_parks++;
+		pthread_cond_timedwait(&m_inst->park_cond, &m_inst->park_lock, &ts);
+	}
+	__sync_lock_release(&m_inst->parked);
+	pthread_mutex_unlock(&m_inst->park_lock);
+
+	park_us = (spdk_get_ticks() - start_tick) * 1000000 / spdk_get_ticks_hz();
+	woken_early = (m_inst->qdepth != 0);
+
+	//Work showing up right after parking means the spin window is too short
+	if (woken_early && park_us < DSS_TPOOL_SHORT_PARK_US) {
+		if (m_inst->spin_polls < DSS_TPOOL_MAX_SPIN_POLLS) {
+			m_inst->spin_polls *= 2;
+		}
+	} else if (!woken_early) {
+		if (m_inst->spin_polls > DSS_TPOOL_MIN_SPIN_POLLS) {
+			m_inst->spin_polls /= 2;
+		}
+	}
+}
+
+static void _tpool_wake(struct dfly_tpool_instance_s *m_inst)
+{
+	pthread_mutex_lock(&m_inst->park_lock);
+	pthread_cond_signal(&m_inst->park_cond);
+	pthread_mutex_unlock(&m_inst->park_lock);
 }
 
 void *tpool_poller(void *ctx)
@@ -91,6 +216,7 @@ void *tpool_poller(void *ctx)
 
 	cpu_set_t cpuset;
 	int rc;
+	uint64_t idle_polls = 0;
 
 	CPU_ZERO(&cpuset);
 	CPU_SET(m_inst->icore, &cpuset);
@@ -104,7 +230,21 @@ void *tpool_poller(void *ctx)
     //pthread_setname_np(m_inst->th_h, name);
 
 	while(m_inst->status == 1) {
-		_tpool_poller(m_inst);
+		if (_tpool_poller(m_inst) || _tpool_steal(m_inst)) {
+			idle_polls = 0;
+			continue;
+		}
+
+		//Don't park with posts still held for a full ring
+		if (dfly_module_post_batch_flush()) {
+			idle_polls = 0;
+			continue;
+		}
+
+		if (++idle_polls >= m_inst->spin_polls) {
+			_tpool_park(m_inst);
+			idle_polls = 0;
+		}
 	}
 
 	//TODO: Flush pending requests
@@ -112,9 +252,14 @@ void *tpool_poller(void *ctx)
 	return ctx;
 }
 
+/**
+ * @brief Pick the less loaded of the next round robin worker and its
+ *        neighbour so a backed up worker does not keep getting new requests
+ */
 static inline struct dfly_tpool_instance_s *dss_tpool_get_th_inst(dss_tpool_t *module)
 {
 	struct dfly_tpool_instance_s *m_inst = NULL;
+	struct dfly_tpool_instance_s *alt_inst = NULL;
 
 	int thread_index = 0;
 
@@ -124,6 +269,12 @@ static inline struct dfly_tpool_instance_s *dss_tpool_get_th_inst(dss_tpool_t *m
 	thread_index = module->thread_index_arr;
 
 	m_inst = module->active_thread_arr[thread_index];
+	if (module->num_threads > 1) {
+		alt_inst = module->active_thread_arr[(thread_index + 1) % module->num_threads];
+		if (alt_inst->qdepth < m_inst->qdepth) {
+			m_inst = alt_inst;
+		}
+	}
 
 	return (m_inst);
 }
@@ -131,22 +282,42 @@ static inline struct dfly_tpool_instance_s *dss_tpool_get_th_inst(dss_tpool_t *m
 
 void dss_tpool_post_request(struct dfly_tpool_s *module, struct dfly_request *req)
 {
-	int rc;
+	size_t rc;
 
 	struct dfly_tpool_instance_s *m_inst;
 
 	//TODO:
 	//	Post to queue only if initialized
 
-	//Default to round robin across module instance
 	m_inst = dss_tpool_get_th_inst(module);
 
 	DFLY_ASSERT(req);
 
-	rc = spdk_ring_enqueue(m_inst->pipe.msg_ring, (void **)&req, 1, NULL);
-	if (rc != 1) {
-		assert(false);
+	__sync_fetch_and_add(&m_inst->qdepth, 1);
+	if (!m_inst->parked) {
+		if (dfly_module_ring_enqueue(m_inst->pipe.msg_ring, NULL, req)) {
+			__sync_fetch_and_sub(&m_inst->qdepth, 1);
+			DFLY_ERRLOG("Thread pool ring full on core %d\n", m_inst->icore);
+			assert(false);
+			return;
+		}
+		//Pairs with the barrier in _tpool_park
+		__sync_synchronize();
+		if (!m_inst->parked) {
+			return;
+		}
+	} else {
+		//Don't hold requests for a parked worker in the post batch
+		rc = spdk_ring_enqueue(m_inst->pipe.msg_ring, (void **)&req, 1, NULL);
+		if (rc != 1) {
+			__sync_fetch_and_sub(&m_inst->qdepth, 1);
+			DFLY_ERRLOG("Thread pool ring full on core %d\n", m_inst->icore);
+			assert(false);
+			return;
+		}
 	}
+
+	_tpool_wake(m_inst);
 }
 
 //
@@ -165,22 +336,34 @@ void dss_tpool_thread_start(void *inst)
 {
 	struct dfly_tpool_instance_s *m_inst = (struct dfly_tpool_instance_s *)inst;
 	dss_tpool_t *module = m_inst->module;
+	pthread_condattr_t cond_attr;
 
 	pthread_mutex_lock(&module->module_lock);
 
 	DFLY_INFOLOG(DFLY_LOG_MODULE, "Launching tpool thread %p\n", m_inst);
 #if defined DFLY_MODULE_MSG_MP_SC
-	//Initialize spdk ring
-	m_inst->pipe.msg_ring = spdk_ring_create(SPDK_RING_TYPE_MP_SC, 65536, SPDK_ENV_SOCKET_ID_ANY);
+	//Initialize spdk ring, multi consumer for work stealing
+	m_inst->pipe.msg_ring = spdk_ring_create(SPDK_RING_TYPE_MP_MC, 65536, SPDK_ENV_SOCKET_ID_ANY);
 	assert(m_inst->pipe.msg_ring);
 
 #endif
 
 #if defined DFLY_MODULE_MSG_MP_SC
+	m_inst->index = module->num_threads;
 	module->active_thread_arr[module->num_threads] = m_inst;
 	module->num_threads++;
 #endif
 
+	pthread_mutex_init(&m_inst->park_lock, NULL);
+	//Park timeout is not affected by wall clock changes
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&m_inst->park_cond, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
+	m_inst->parked = 0;
+	m_inst->qdepth = 0;
+	m_inst->spin_polls = DSS_TPOOL_MIN_SPIN_POLLS;
+
 	m_inst->status = 1;
 
 	pthread_create(&m_inst->th_h, NULL, tpool_poller, (void *)m_inst);
@@ -251,9 +434,15 @@ void dfly_tpool_thread_stop(void *ctx)
 	struct dfly_tpool_instance_s *m_inst_next = NULL;
 
 	m_inst->status = 0;
+	_tpool_wake(m_inst);
 
 	pthread_join(m_inst->th_h, NULL);
 
+	DFLY_INFOLOG(DFLY_LOG_MODULE, "tpool thread %p stolen reqs %lu parks %lu\n", m_inst,
+		     m_inst->num_stolen, m_inst->num_parks);
+	pthread_cond_destroy(&m_inst->park_cond);
+	pthread_mutex_destroy(&m_inst->park_lock);
+
 	if (m_inst->pipe.msg_ring != NULL) {
 		spdk_ring_free(m_inst->pipe.msg_ring);
 		m_inst->pipe.msg_ring = NULL;
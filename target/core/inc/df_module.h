@@ -45,6 +45,21 @@ extern "C" {
 
 #define DFLY_MODULE_MSG_MP_SC
 
+#define DFLY_MODULE_RING_SZ (65536)
+//Module ring slots only usable by posts that are not throttled,
+//completions and internal requests, so they never find the ring full
+#define DFLY_MODULE_RING_RESERVED_SLOTS (DFLY_MODULE_RING_SZ / 4)
+
+//Max requests held per destination ring before a batched post is flushed
+#define DFLY_MODULE_POST_BATCH_SZ (REQ_PER_POLL * 4)
+//Max destination rings tracked per thread in a batch scope
+#define DFLY_MODULE_POST_BATCH_MAX_RINGS (16)
+
+//Consecutive empty polls before an adaptive module poller slows down
+#define DFLY_MODULE_POLL_IDLE_THRESHOLD (100000)
+//Poll period of an idle module poller
+#define DFLY_MODULE_POLL_IDLE_PERIOD_US (100)
+
 typedef enum dfly_module_request_status_s {
 	/// @brief Note: Do not use DFLY_MODULE_REQUEST_PROCESSED in new code. This will be deprecated
 	DFLY_MODULE_REQUEST_PROCESSED = 0,
@@ -95,7 +110,12 @@ struct dfly_module_poller_instance_s {
 	dfly_module_t *module;
 #if defined DFLY_MODULE_MSG_MP_SC
 	struct dfly_module_pipe_s pipe;
+	int64_t msg_ring_credits;//Free slots in pipe.msg_ring
 #endif
+	struct spdk_thread *thread;//Thread mpoller runs on
+	bool poll_idle;//mpoller registered with the idle poll period
+	int poll_kick_pending;//Switch back to busy polling requested by a poster
+	uint64_t num_empty_polls;
 	int status;
 	stat_module_t *stat_module;
 	TAILQ_ENTRY(dfly_module_poller_instance_s) link;// Link of the list of pollers
@@ -117,7 +137,59 @@ struct dfly_module_s *dfly_module_start(const char *name, dss_module_type_t mtyp
 					df_module_event_complete_cb cb, void *cb_arg);
 void dfly_module_stop(struct dfly_module_s *module, df_module_event_complete_cb cb, void *cb_arg);
 void dfly_module_post_request(struct dfly_module_s *module, struct dfly_request *req);
+
+/**
+ * @brief Reserve a message ring slot on the module instance that would process req
+ *
+ * @param module module the request is posted to
+ * @param req request to be posted with dfly_module_post_reserved_request
+ * @return struct dfly_module_poller_instance_s* module instance holding the reserved slot,
+ *         NULL if the instance ring is down to reserved slots and the caller should retry later
+ */
+struct dfly_module_poller_instance_s *dfly_module_reserve_request(struct dfly_module_s *module, struct dfly_request *req);
+
+/**
+ * @brief Post request to a module instance slot reserved by dfly_module_reserve_request
+ *
+ * @param m_inst module instance returned by dfly_module_reserve_request
+ * @param req request to post
+ */
+void dfly_module_post_reserved_request(struct dfly_module_poller_instance_s *m_inst, struct dfly_request *req);
 void dfly_module_complete_request(struct dfly_module_s *module, struct dfly_request *req);
+
+/**
+ * @brief Enqueue req on a module or thread pool ring. Inside a batch scope
+ *        requests are held per ring and enqueued together when the scope
+ *        ends or the batch fills up. Requests that find the ring full stay in
+ *        the batch and are retried on the next flush
+ *
+ * @param ring destination message or completion ring
+ * @param stat_inst module instance to account the request to, NULL to skip stats
+ * @param req request to enqueue
+ * @return int 0 if req was enqueued or held, -1 if the ring is full and req
+ *         could not be held
+ */
+int dfly_module_ring_enqueue(struct spdk_ring *ring, struct dfly_module_poller_instance_s *stat_inst,
+			     void *req);
+
+/**
+ * @brief Retry requests held for full rings or deferred for want of ring
+ *        credits by the current thread. No-op inside a batch scope
+ *
+ * @return int number of requests still held or deferred
+ */
+int dfly_module_post_batch_flush(void);
+
+/**
+ * @brief Start holding ring posts from the current thread. Scopes nest,
+ *        posts are flushed when the outermost scope ends
+ */
+void dfly_module_post_batch_begin(void);
+
+/**
+ * @brief End a batch scope started with dfly_module_post_batch_begin
+ */
+void dfly_module_post_batch_end(void);
 void *dfly_module_get_ctx(struct dfly_module_s *module);
 
 struct dfly_module_ops {
@@ -131,6 +203,9 @@ struct dfly_module_ops {
 	void *(*find_instance_context)(struct dfly_request
 				       *req);//	Find the module instance context based on the request
 	void *(*module_instance_destroy)(void *mctx, void *inst_ctx);
+	//Optional hooks around a batch of requests dequeued for module_rpoll
+	void (*module_rpoll_batch_start)(void *ctx);
+	void (*module_rpoll_batch_end)(void *ctx);
 };
 
 #ifdef __cplusplus
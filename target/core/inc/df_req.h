@@ -282,6 +282,7 @@ typedef struct dfly_request {
 	TAILQ_ENTRY(dfly_request)	fuse_pending_list;
 
 	TAILQ_ENTRY(dfly_request)	outstanding;
+	TAILQ_ENTRY(dfly_request)	credit_wait; /**< net module linkage while target module is out of credits */
 	uint32_t waiting_for_buffer:1;
 	struct df_io_lat_ticks lat;
     uint64_t submit_tick;
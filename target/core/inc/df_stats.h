@@ -51,6 +51,8 @@ extern "C" {
 #define STAT_NAME_SES		"session"
 #define STAT_NAME_DRIVE		"drive"
 #define STAT_NAME_THREAD	"thread"
+#define STAT_NAME_KVTRANS	"kvtrans"
+#define STAT_NAME_WAL		"wal"
 
 #define STAT_ENAME_LEN		64
 #define STAT_ENAME_TARGET	"target."
@@ -58,12 +60,16 @@ extern "C" {
 #define STAT_ENAME_SES		STAT_ENAME_TARGET STAT_NAME_SES
 #define STAT_ENAME_DRIVE	STAT_ENAME_TARGET STAT_NAME_DRIVE
 #define STAT_ENAME_THREAD	STAT_ENAME_TARGET STAT_NAME_THREAD
+#define STAT_ENAME_KVTRANS	STAT_ENAME_TARGET STAT_NAME_KVTRANS
+#define STAT_ENAME_WAL		STAT_ENAME_TARGET STAT_NAME_WAL
 
 
 #define STAT_GNAME_KVIO	"kvio"
 #define STAT_GNAME_KVLIST   "kvlist"
 #define STAT_GNAME_NAME	"id"
 #define STAT_GNAME_RDMA "rdma"
+#define STAT_GNAME_META_CACHE "meta_cache"
+#define STAT_GNAME_WAL_COMMIT "commit"
 
 #define STAT_GNAME_COUNTERS "counters"
 #define STAT_GNAME_DEBUG "debug"
@@ -131,6 +137,14 @@ typedef struct stat_rqpair {
 typedef struct stat_module {
 	ustat_named_t i_reqs;
 	ustat_named_t i_reqs_max;
+	ustat_named_t enq_batches;
+	ustat_named_t enq_reqs;
+	ustat_named_t enq_batch_max;
+	ustat_named_t deq_batches;
+	ustat_named_t deq_reqs;
+	ustat_named_t busy_polls;
+	ustat_named_t idle_polls;
+	ustat_named_t idle_switches;
 } stat_module_t;
 
 typedef struct stat_rdma {
@@ -147,6 +161,23 @@ typedef struct stat_thread {
 	ustat_named_t i_reqs_max;
 } stat_thread_t;
 
+typedef struct stat_meta_cache {
+	ustat_named_t hits;
+	ustat_named_t misses;
+	ustat_named_t fills;
+	ustat_named_t evictions;
+	ustat_named_t invalidations;
+} stat_meta_cache_t;
+
+typedef struct stat_wal_commit {
+	ustat_named_t batch_nr_obj;
+	ustat_named_t batch_timeout_us;
+	ustat_named_t p99_us;
+	ustat_named_t device_us;
+	ustat_named_t arrival_ns;
+	ustat_named_t batches;
+} stat_wal_commit_t;
+
 typedef struct stat_blk_io stat_block_io_t;
 
 extern const ustat_class_t ustat_class_test;
@@ -169,10 +200,18 @@ int dfly_ustat_init_qpair_stat(void *);
 void dfly_ustat_remove_qpair_stat(void *);
 int dfly_ustat_init_module_inst_stat(void *, char *, int);
 void dfly_ustat_remove_module_inst_stat(void *);
+int dfly_ustat_init_meta_cache_stat(stat_meta_cache_t **stat, int id);
+void dfly_ustat_remove_meta_cache_stat(stat_meta_cache_t *stat);
+int dfly_ustat_init_wal_commit_stat(stat_wal_commit_t **stat, int id);
+void dfly_ustat_remove_wal_commit_stat(stat_wal_commit_t *stat);
 
 // ops 0 is add & ops 1 is sub
+// For module instances ops 2 records a poll that processed num_reqs requests,
+// ops 3 records a switch of the poller to the idle poll period
 void dfly_ustat_update_rqpair_stat(void *qpair, int ops);
 void dfly_ustat_update_module_inst_stat(void *module_inst, int ops, uint64_t num_reqs);
+// ops 0 is a batched ring enqueue & ops 1 is a ring dequeue of num_reqs requests
+void dfly_ustat_update_module_inst_batch_stat(void *module_inst, int ops, uint64_t num_reqs);
 
 void dfly_ustat_atomic_inc_u64(ustat_struct_t *s, ustat_named_t *n);
 void dfly_ustat_atomic_dec_u64(ustat_struct_t *s, ustat_named_t *n);
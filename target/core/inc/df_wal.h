@@ -100,11 +100,15 @@ extern "C" {
 #define WAL_LOG_BATCH_NR_OBJ 256
 #define WAL_LOG_BATCH_TIMEOUT_US_ADJUST 100
 #define WAL_LOG_BATCH_NR_OBJ_ADJUST 2
+#define WAL_LOG_COMMIT_TARGET_US 0	// p99 commit latency target of the batch controller, 0 for fixed adjust steps
 #define WAL_CACHE_ZONE_GROUP_IO_CNT 10000
 
 #define WAL_CACHE_FLUSH_PERIOD_MS 120000	// two mins timeout for cache flush.
 #define WAL_LOG_CRASH_TEST	0
+#define WAL_LOG_RECOVER_NR_ZONES	8	// zones replayed concurrently per log device
+#define WAL_LOG_RECOVER_QD	4	// data reads in flight per recovering zone
 #define WAL_NR_LOG_DEV_DEFAULT	0
+#define WAL_LOG_DEV_PMEM	0	// log devices are bdevs, 1 for DAX devices or files mapped in memory
 #define WAL_MAX_LOG_DEV	256
 
 #define WAL_CACHE_OBJECT_SIZE_LIMIT_KB_DEFAULT	64
@@ -141,8 +145,12 @@ typedef struct wal_conf_s {
 	int wal_log_batch_nr_obj_adjust;
 	int wal_log_batch_timeout_us;
 	int wal_log_batch_timeout_us_adjust;
+	int wal_log_commit_target_us;
 	int wal_nr_log_dev;
 	int wal_log_crash_test;
+	int wal_log_recover_nr_zones;
+	int wal_log_recover_qd;
+	int wal_log_dev_pmem;
 	char wal_cache_dev_nqn_name[256];
 	char wal_log_dev_name[WAL_MAX_LOG_DEV][256];
 } wal_conf_t;
@@ -65,6 +65,7 @@ extern "C" {
 #include "dss.h"
 #include "apis/dss_module_apis.h"
 #include "apis/dss_io_task_apis.h"
+#include "apis/dss_block_allocator_apis.h"
 
 #include "df_dev.h"
 #include "df_req.h"
@@ -326,6 +327,10 @@ struct dragonfly {
 
 	uint32_t mm_buff_count;
 
+	bool module_poll_adaptive;/** Slow down module pollers that stay idle */
+	uint32_t module_poll_idle_threshold;/** Consecutive empty polls before slowing down */
+	uint32_t module_poll_idle_period_us;/** Poll period of an idle module poller */
+
     bool test_nic_bw; /** Enable simulation for short circuit without drive IO (PUT/GET) */
 	uint32_t test_sim_io_timeout;/** Simulate IO Timeout in Seconds */
 
@@ -417,6 +422,19 @@ int dss_kvtrans_module_subsystem_start(struct dfly_subsystem *subsystem, void *a
 
 void dss_kvtrans_module_subsystem_stop(struct dfly_subsystem *subsystem, void *arg /*Not used*/, df_module_event_complete_cb cb, void *cb_arg);
 
+typedef void (*dss_kvtrans_frag_stats_cb)(void *cb_arg, const char *dev_name,
+					  dss_blk_allocator_frag_stats_t *stats);
+
+/**
+ * @brief Free space fragmentation of the block allocator of device dev_index,
+ *        read on the kvtrans thread owning the device. cb runs on that
+ *        thread, with stats NULL if the device is still loading
+ *
+ * @return 0 if cb will be called, -1 if the device has no kvtrans thread
+ */
+int dss_kvtrans_module_get_ba_frag_stats(struct dfly_subsystem *subsystem, uint32_t dev_index,
+					 dss_kvtrans_frag_stats_cb cb, void *cb_arg);
+
 int dfly_lock_service_subsys_start(struct dfly_subsystem *subsys, void *arg/*Not used*/,
 				   df_module_event_complete_cb cb, void *cb_arg);
 void dfly_lock_service_subsystem_stop(struct dfly_subsystem *subsys, void *arg/*Not used*/,
@@ -32,6 +32,7 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <pthread.h>
 #include <sys/queue.h>
 
@@ -54,6 +55,20 @@ void set_kvtrans_disk_data_store(bool val);
 void set_kvtrans_disk_meta_store(bool val);
 void set_kvtrans_ba_meta_sync_enabled(bool val);
 void set_kvtrans_dump_mem_meta_enabled(bool val);
+void set_kvtrans_batch_size(uint32_t val);
+void set_kvtrans_meta_cache_blks(uint32_t val);
+void set_kvtrans_key_filter_keys(uint64_t val);
+void set_kvtrans_placement(uint32_t val);
+void set_kvtrans_cuckoo_bucket_blks(uint32_t val);
+void set_kvtrans_packed_meta(bool val);
+void set_kvtrans_boot_ranges(uint32_t val);
+void set_kvtrans_index_snapshot(bool val);
+void set_kvtrans_ba_alloc_groups(uint32_t val);
+void set_kvtrans_ba_meta_sync_group_reqs(uint32_t val);
+void set_kvtrans_ba_journal(bool val);
+void set_kvtrans_ba_extent_tree(bool val);
+void set_kvtrans_ba_size_class_region_blocks(uint32_t val);
+void set_kvtrans_ba_meta_sync_group_window_us(uint32_t val);
 
 #ifndef DSS_BUILD_CUNIT_TEST
 
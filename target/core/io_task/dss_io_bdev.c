@@ -265,52 +265,122 @@ uint32_t dss_io_dev_get_disk_num_blks(dss_device_t *device)
     return device->disk_num_blks;
 }
 
-struct spdk_io_channel *dss_io_dev_get_channel(dss_device_t *io_device)
+//Ops staged for submission by tasks on this core while the io module
+//processes a batch of requests. See dss_io_task_plug
+static __thread struct {
+    bool initialized;
+    bool plugged;
+    TAILQ_HEAD(, dss_device_channel_s) staged_chs;
+} g_dss_io_plug;
+
+static dss_device_channel_t *_dss_io_dev_get_dev_channel(dss_device_t *io_device)
 {
     uint32_t ch_arr_index = dss_env_get_current_core();
-    struct spdk_io_channel *ch;
+    dss_device_channel_t *dch;
 
     DSS_ASSERT(ch_arr_index <= io_device->n_ch);
 
-    if(spdk_unlikely(!io_device->ch_arr[ch_arr_index].ch)) {
-        io_device->ch_arr[ch_arr_index].ch = spdk_bdev_get_io_channel(io_device->desc);
-        DSS_ASSERT(io_device->ch_arr[ch_arr_index].ch);
-        io_device->ch_arr[ch_arr_index].thread = dss_env_get_spdk_thread();
-        DSS_ASSERT(io_device->ch_arr[ch_arr_index].thread != NULL);
+    dch = &io_device->ch_arr[ch_arr_index];
+    if(spdk_unlikely(!dch->ch)) {
+        dch->ch = spdk_bdev_get_io_channel(io_device->desc);
+        DSS_ASSERT(dch->ch);
+        dch->thread = dss_env_get_spdk_thread();
+        DSS_ASSERT(dch->thread != NULL);
+        dch->device = io_device;
+        dch->io_wait_armed = false;
+        dch->on_staged_list = false;
+        dch->num_nomem = 0;
+        dch->num_merged_ops = 0;
+        TAILQ_INIT(&dch->staged_ops);
     }
 
-    ch = io_device->ch_arr[ch_arr_index].ch;
-    DSS_ASSERT(ch != NULL);
+    DSS_ASSERT(dch->ch != NULL);
 
-    return ch;
+    return dch;
 }
 
+struct spdk_io_channel *dss_io_dev_get_channel(dss_device_t *io_device)
+{
+    return _dss_io_dev_get_dev_channel(io_device)->ch;
+}
 
+static void _dss_io_task_post_completion(dss_io_task_t *task)
+{
+    //Note: Assumption net module is always present
+    //TODO: If there are no module threads then this callback needs to happen and trigger 
+    //      further processing of the request
+    DSS_ASSERT(task->cb_minst);
+    DSS_ASSERT(task->cb_ctx);
+    //TODO: store module context and get mtype
+    task->in_progress = false;
+    dss_trace_record(TRACE_IO_DEQUEUE_KREQ, 0, 0, 0, (uintptr_t)task->dreq);
+    if(task->cb_to_cq) {
+        dss_module_post_to_instance_cq(DSS_MODULE_END, task->cb_minst, task->cb_ctx);
+    } else {
+        dss_module_post_to_instance(DSS_MODULE_END, task->cb_minst, task->cb_ctx);
+    }
+}
 
+//Tasks in a group can complete on different io threads, the last one posts all
+static void _dss_io_task_group_complete(dss_io_task_t *task)
+{
+    dss_io_task_group_t *g = task->group;
+    uint32_t i;
 
-void _dss_io_task_op_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+    if(task->task_status != DSS_IO_TASK_STATUS_SUCCESS) {
+        __sync_fetch_and_or(&g->failed, 1);
+    }
+
+    if(__sync_sub_and_fetch(&g->pending, 1) != 0) {
+        return;
+    }
+
+    for(i = 0; i < g->ntasks; i++) {
+        g->tasks[i]->group = NULL;
+        //Group shares one meta write, a failure fails every member
+        if(g->failed) {
+            g->tasks[i]->task_status = DSS_IO_TASK_STATUS_ERROR;
+        }
+        _dss_io_task_post_completion(g->tasks[i]);
+    }
+    free(g);
+}
+
+/**
+ * @brief Record why an op failed, bdev_io is NULL if the op never reached the device
+ */
+static void _dss_io_op_set_failure(dss_io_op_t *op, struct spdk_bdev_io *bdev_io)
+{
+    uint32_t cdw0 = 0;
+    int sct = SPDK_NVME_SCT_GENERIC;
+    int sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+
+    if(bdev_io) {
+        spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+    }
+
+    op->status.nvme_rsp.cdw0 = cdw0;
+    op->status.nvme_rsp.sct = (uint16_t)sct;
+    op->status.nvme_rsp.sc = (uint16_t)sc;
+}
+
+static void _dss_io_task_complete_op(dss_io_op_t *op, bool success)
 {
-    dss_io_op_t *op = (dss_io_op_t *)cb_arg;
     dss_io_task_t *task = op->parent;
     dss_io_op_t *next_op;
 
-
-    DSS_ASSERT(task->num_outstanding_ops >= 0);
+    DSS_ASSERT(task->num_outstanding_ops > 0);
     DSS_DEBUGLOG(DSS_IO_TASK, "IO Completed task[%p] op[%d] lba[%x] nblocks[%x]\n", task, op->opc, op->blk_rw.lba, op->blk_rw.nblocks);
 
     task->num_ops_done++;
     task->num_outstanding_ops--;
 
-    // TODO: Get nvme status
-    // spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
-    spdk_bdev_free_io(bdev_io);
-
     TAILQ_REMOVE(&task->ops_in_progress, op, op_next);
     if(success) {
         TAILQ_INSERT_TAIL(&task->op_done, op, op_next);
     } else {
+        //Failure code is recorded on the op by the caller
         TAILQ_INSERT_TAIL(&task->failed_ops, op, op_next);
-        //TODO: Update failure code to OP
         task->task_status = DSS_IO_TASK_STATUS_ERROR;
     }
 
@@ -322,85 +392,368 @@ void _dss_io_task_op_complete(struct spdk_bdev_io *bdev_io, bool success, void *
     next_op = TAILQ_FIRST(&task->op_todo_list);
     if(next_op) {
         _dss_io_task_submit_to_device(task);
+    } else if(task->group) {
+        _dss_io_task_group_complete(task);
     } else {//All operations completed
-        //Note: Assumption net module is always present
-        //TODO: If there are no module threads then this callback needs to happen and trigger 
-        //      further processing of the request
-        DSS_ASSERT(task->cb_minst);
-        DSS_ASSERT(task->cb_ctx);
-        //TODO: store module context and get mtype
-        task->in_progress = false;
-        dss_trace_record(TRACE_IO_DEQUEUE_KREQ, 0, 0, 0, (uintptr_t)task->dreq);
-        if(task->cb_to_cq) {
-            dss_module_post_to_instance_cq(DSS_MODULE_END, task->cb_minst, task->cb_ctx);
-        } else {
-            dss_module_post_to_instance(DSS_MODULE_END, task->cb_minst, task->cb_ctx);
+        _dss_io_task_post_completion(task);
+    }
+
+    return;
+}
+
+void _dss_io_task_op_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+    dss_io_op_t *op = (dss_io_op_t *)cb_arg;
+
+    if(!success) {
+        _dss_io_op_set_failure(op, bdev_io);
+    }
+    spdk_bdev_free_io(bdev_io);
+
+    _dss_io_task_complete_op(op, success);
+
+    return;
+}
+
+static void _dss_io_task_merged_op_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+    dss_io_op_t *op = (dss_io_op_t *)cb_arg;
+    dss_io_op_t *next_op;
+    dss_io_task_status_t iot_rc;
+
+    if(!success) {
+        for(next_op = op; next_op; next_op = next_op->merge_next) {
+            _dss_io_op_set_failure(next_op, bdev_io);
         }
     }
+    spdk_bdev_free_io(bdev_io);
 
+    DSS_ASSERT(op->merge_iov);
+    iot_rc = dss_io_iov_free(op->parent->io_task_module, op->merge_iov);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    op->merge_iov = NULL;
+
+    //Completing an op can hand its task back to the owner, read the link first
+    while(op) {
+        next_op = op->merge_next;
+        op->merge_next = NULL;
+        _dss_io_task_complete_op(op, success);
+        op = next_op;
+    }
 
     return;
 }
 
-void _dss_io_task_submit_to_device(dss_io_task_t *task)
+static inline void _dss_io_op_get_disk_range(dss_device_t *io_device, dss_io_op_t *op, uint64_t nblocks, uint64_t *disk_lba, uint64_t *num_disk_blocks)
 {
-    dss_io_op_t *curr_op, *tmp_op;
-    dss_device_t *io_device;
+    uint64_t disk_tr_factor;
+
+    *disk_lba = op->blk_rw.lba;
+    *num_disk_blocks = nblocks;
+    if (io_device->user_blk_sz != io_device->disk_blk_sz)
+    {
+        DSS_ASSERT(io_device->disk_blk_sz <= io_device->user_blk_sz);
+        DSS_ASSERT(io_device->user_blk_sz % io_device->disk_blk_sz == 0);
+
+        disk_tr_factor = io_device->user_blk_sz / io_device->disk_blk_sz;
+        *disk_lba *= disk_tr_factor;
+        *num_disk_blocks *= disk_tr_factor;
+    }
+}
+
+static int _dss_io_dev_submit_op(dss_device_channel_t *dch, dss_io_op_t *curr_op)
+{
+    dss_device_t *io_device = dch->device;
+    struct spdk_io_channel *ch = dch->ch;
+    dss_io_task_t *task = curr_op->parent;
+    uint64_t disk_lba;
+    uint64_t num_disk_blocks;
+    int rc = -EINVAL;
+
+    _dss_io_op_get_disk_range(io_device, curr_op, curr_op->blk_rw.nblocks, &disk_lba, &num_disk_blocks);
+
+    switch(curr_op->opc) {
+        case DSS_IO_BLK_READ:
+            rc = spdk_bdev_read_blocks(io_device->desc, ch, curr_op->blk_rw.data, \
+                                                       disk_lba, \
+                                                       num_disk_blocks,
+                                                       _dss_io_task_op_complete,
+                                                       curr_op);
+        DSS_DEBUGLOG(DSS_IO_TASK, "BLK_READ submit task[%p] op[%d] lba[%x] nblocks[%x]\n", task, curr_op->opc, curr_op->blk_rw.lba, curr_op->blk_rw.nblocks);
+            break;
+        case DSS_IO_BLK_WRITE:
+            rc = spdk_bdev_write_blocks(io_device->desc, ch, curr_op->blk_rw.data, \
+                                                        disk_lba, \
+                                                        num_disk_blocks,
+                                                        _dss_io_task_op_complete,
+                                                        curr_op);
+        DSS_DEBUGLOG(DSS_IO_TASK, "BLK_WRITE submit task[%p] op[%d] lba[%x] nblocks[%x]\n", task, curr_op->opc, curr_op->blk_rw.lba, curr_op->blk_rw.nblocks);
+            break;
+        case DSS_IO_BLK_READV:
+            rc = spdk_bdev_readv_blocks(io_device->desc, ch, curr_op->rw_v.iov->iovs, \
+                                                       curr_op->rw_v.iov->iovcnt, \
+                                                       disk_lba, \
+                                                       num_disk_blocks,
+                                                       _dss_io_task_op_complete,
+                                                       curr_op);
+        DSS_DEBUGLOG(DSS_IO_TASK, "BLK_READV submit task[%p] op[%d] lba[%x] nblocks[%x] iovcnt[%d]\n", task, curr_op->opc, curr_op->rw_v.lba, curr_op->rw_v.nblocks, curr_op->rw_v.iov->iovcnt);
+            break;
+        case DSS_IO_BLK_WRITEV:
+            rc = spdk_bdev_writev_blocks(io_device->desc, ch, curr_op->rw_v.iov->iovs, \
+                                                        curr_op->rw_v.iov->iovcnt, \
+                                                        disk_lba, \
+                                                        num_disk_blocks,
+                                                        _dss_io_task_op_complete,
+                                                        curr_op);
+        DSS_DEBUGLOG(DSS_IO_TASK, "BLK_WRITEV submit task[%p] op[%d] lba[%x] nblocks[%x] iovcnt[%d]\n", task, curr_op->opc, curr_op->rw_v.lba, curr_op->rw_v.nblocks, curr_op->rw_v.iov->iovcnt);
+            break;
+        default:
+            DSS_ASSERT(0);
+    }
+
+    return rc;
+}
+
+static inline int _dss_io_op_num_regions(dss_io_op_t *op)
+{
+    if(op->opc == DSS_IO_BLK_READV || op->opc == DSS_IO_BLK_WRITEV) {
+        return op->rw_v.iov->iovcnt;
+    }
+    return 1;
+}
+
+static inline void _dss_io_op_add_regions(dss_device_t *io_device, dss_io_op_t *op, dss_iov_t *iov)
+{
+    dss_io_task_status_t iot_rc;
+    int i;
+
+    if(op->opc == DSS_IO_BLK_READV || op->opc == DSS_IO_BLK_WRITEV) {
+        for(i = 0; i < op->rw_v.iov->iovcnt; i++) {
+            iot_rc = dss_io_iov_add(iov, op->rw_v.iov->iovs[i].iov_base, op->rw_v.iov->iovs[i].iov_len, 0);
+            DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        }
+    } else {
+        iot_rc = dss_io_iov_add(iov, op->blk_rw.data, op->blk_rw.nblocks * io_device->user_blk_sz, 0);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+}
 
-    struct spdk_io_channel *ch;
+/**
+ * @brief Submit nops staged ops starting at first as one bdev io
+ *        Ops are linked through merge_next and completed together
+ */
+static int _dss_io_dev_submit_merged_ops(dss_device_channel_t *dch, dss_io_op_t *first, int nops)
+{
+    dss_device_t *io_device = dch->device;
+    dss_io_op_t *op, *prev = NULL;
+    dss_iov_t *iov;
+    uint64_t nblocks = 0;
+    uint64_t disk_lba;
+    uint64_t num_disk_blocks;
+    int i;
     int rc;
 
-    uint64_t disk_lba = -1;
-    uint64_t num_disk_blocks = -1;
-    uint64_t disk_tr_factor;
+    iov = dss_io_iov_get(first->parent->io_task_module);
+    if(!iov) {
+        return -ENOMEM;
+    }
 
-    DSS_ASSERT(task->in_progress == true);
+    op = first;
+    for(i = 0; i < nops; i++) {
+        _dss_io_op_add_regions(io_device, op, iov);
+        nblocks += op->blk_rw.nblocks;
+        if(prev) {
+            prev->merge_next = op;
+        }
+        prev = op;
+        op = TAILQ_NEXT(op, stage_link);
+    }
+    prev->merge_next = NULL;
+    first->merge_iov = iov;
 
-    TAILQ_FOREACH_SAFE(curr_op, &task->op_todo_list, op_next, tmp_op) {
-        //TODO: io task management
-        io_device = curr_op->device;
-        ch = dss_io_dev_get_channel(io_device);
-
-        if (curr_op->opc == DSS_IO_BLK_READ || curr_op->opc == DSS_IO_BLK_WRITE) {
-            disk_lba = curr_op->blk_rw.lba;
-            num_disk_blocks = curr_op->blk_rw.nblocks;
-            if (io_device->user_blk_sz != io_device->disk_blk_sz)
-            {
-                DSS_ASSERT(io_device->disk_blk_sz <= io_device->user_blk_sz);
-                DSS_ASSERT(io_device->user_blk_sz % io_device->disk_blk_sz == 0);
-
-                disk_tr_factor = io_device->user_blk_sz / io_device->disk_blk_sz;
-                disk_lba *= disk_tr_factor;
-                num_disk_blocks *= disk_tr_factor;
+    _dss_io_op_get_disk_range(io_device, first, nblocks, &disk_lba, &num_disk_blocks);
+
+    if(first->opc == DSS_IO_BLK_WRITE || first->opc == DSS_IO_BLK_WRITEV) {
+        rc = spdk_bdev_writev_blocks(io_device->desc, dch->ch, iov->iovs, iov->iovcnt,
+                                     disk_lba, num_disk_blocks,
+                                     _dss_io_task_merged_op_complete, first);
+    } else {
+        rc = spdk_bdev_readv_blocks(io_device->desc, dch->ch, iov->iovs, iov->iovcnt,
+                                    disk_lba, num_disk_blocks,
+                                    _dss_io_task_merged_op_complete, first);
+    }
+    DSS_DEBUGLOG(DSS_IO_TASK, "Merged submit op[%d] lba[%x] nblocks[%x] nops[%d] iovcnt[%d] rc[%d]\n",
+                    first->opc, first->blk_rw.lba, nblocks, nops, iov->iovcnt, rc);
+
+    if(rc != 0) {
+        op = first;
+        while(op) {
+            prev = op->merge_next;
+            op->merge_next = NULL;
+            op = prev;
+        }
+        first->merge_iov = NULL;
+        dss_io_iov_free(first->parent->io_task_module, iov);
+    } else {
+        dch->num_merged_ops += nops;
+    }
+
+    return rc;
+}
+
+static void _dss_io_dev_flush_channel(dss_device_channel_t *dch);
+
+static void _dss_io_dev_io_wait_cb(void *ctx)
+{
+    dss_device_channel_t *dch = (dss_device_channel_t *)ctx;
+
+    dch->io_wait_armed = false;
+    _dss_io_dev_flush_channel(dch);
+}
+
+/**
+ * @brief Submit ops staged on the device channel, merging runs of ops with
+ *        adjacent LBAs into one bdev io. When the bdev runs out of
+ *        spdk_bdev_io the remaining ops stay staged till io_wait fires
+ */
+static void _dss_io_dev_flush_channel(dss_device_channel_t *dch)
+{
+    dss_io_op_t *first, *last, *next, *op;
+    dss_io_op_t *run[DSS_IO_MAX_IOV_ENTRIES];//Every op adds at least one iov region
+    int nops, nregions, i;
+    uint64_t nbytes;
+    int rc;
+
+    while((first = TAILQ_FIRST(&dch->staged_ops)) != NULL) {
+        last = first;
+        nops = 1;
+        nregions = _dss_io_op_num_regions(first);
+        nbytes = first->blk_rw.nblocks * dch->device->user_blk_sz;
+        next = TAILQ_NEXT(first, stage_link);
+        while(next && dss_io_op_can_merge(last, next)) {
+            if(nregions + _dss_io_op_num_regions(next) > DSS_IO_MAX_IOV_ENTRIES) break;
+            if(nbytes + next->blk_rw.nblocks * dch->device->user_blk_sz > DSS_IO_MAX_MERGE_BYTES) break;
+            nregions += _dss_io_op_num_regions(next);
+            nbytes += next->blk_rw.nblocks * dch->device->user_blk_sz;
+            nops++;
+            last = next;
+            next = TAILQ_NEXT(next, stage_link);
+        }
+
+        if(nops > 1) {
+            rc = _dss_io_dev_submit_merged_ops(dch, first, nops);
+            if(rc == -ENOMEM) {
+                //Out of iovs or bdev io, fall back to the first op alone
+                nops = 1;
+                rc = _dss_io_dev_submit_op(dch, first);
+            }
+        } else {
+            rc = _dss_io_dev_submit_op(dch, first);
+        }
+
+        if(spdk_unlikely(rc == -ENOMEM)) {
+            dch->num_nomem++;
+            if(!dch->io_wait_armed) {
+                dch->io_wait.bdev = dch->device->bdev;
+                dch->io_wait.cb_fn = _dss_io_dev_io_wait_cb;
+                dch->io_wait.cb_arg = dch;
+                rc = spdk_bdev_queue_io_wait(dch->device->bdev, dch->ch, &dch->io_wait);
+                DSS_RELEASE_ASSERT(rc == 0);
+                dch->io_wait_armed = true;
+                DSS_DEBUGLOG(DSS_IO_TASK, "Device [%s] out of bdev io, ops staged\n", dch->device->dev_name);
+            }
+            return;
+        }
+
+        //Unlink the run before completing anything, failure completion can stage more ops
+        DSS_ASSERT(nops <= DSS_IO_MAX_IOV_ENTRIES);
+        op = first;
+        for(i = 0; i < nops; i++) {
+            next = TAILQ_NEXT(op, stage_link);
+            TAILQ_REMOVE(&dch->staged_ops, op, stage_link);
+            run[i] = op;
+            op = next;
+        }
+
+        if(spdk_unlikely(rc != 0)) {
+            DSS_ERRLOG("Device [%s] submit failed rc [%d] op[%d] lba[%x] nblocks[%x] nops[%d]\n",
+                        dch->device->dev_name, rc, first->opc, first->blk_rw.lba, first->blk_rw.nblocks, nops);
+            //None of the ops in the run reached the device, fail each on its task
+            for(i = 0; i < nops; i++) {
+                _dss_io_op_set_failure(run[i], NULL);
+                _dss_io_task_complete_op(run[i], false);
             }
         }
+    }
+
+    return;
+}
 
-        switch(curr_op->opc) {
-            case DSS_IO_BLK_READ:
-                rc = spdk_bdev_read_blocks(io_device->desc, ch, curr_op->blk_rw.data, \
-                                                           disk_lba, \
-                                                           num_disk_blocks,
-                                                           _dss_io_task_op_complete,
-                                                           curr_op);
-            DSS_DEBUGLOG(DSS_IO_TASK, "BLK_READ submit task[%p] op[%d] lba[%x] nblocks[%x]\n", task, curr_op->opc, curr_op->blk_rw.lba, curr_op->blk_rw.nblocks);
-                break;
-            case DSS_IO_BLK_WRITE:
-                rc = spdk_bdev_write_blocks(io_device->desc, ch, curr_op->blk_rw.data, \
-                                                            disk_lba, \
-                                                            num_disk_blocks,
-                                                            _dss_io_task_op_complete,
-                                                            curr_op);
-            DSS_DEBUGLOG(DSS_IO_TASK, "BLK_WRITE submit task[%p] op[%d] lba[%x] nblocks[%x]\n", task, curr_op->opc, curr_op->blk_rw.lba, curr_op->blk_rw.nblocks);
-                break;
-            default:
-                DSS_ASSERT(0);
+static void _dss_io_dev_flush_staged(void)
+{
+    dss_device_channel_t *dch;
+
+    while((dch = TAILQ_FIRST(&g_dss_io_plug.staged_chs)) != NULL) {
+        TAILQ_REMOVE(&g_dss_io_plug.staged_chs, dch, staged_link);
+        dch->on_staged_list = false;
+        if(dch->io_wait_armed) {
+            //Flushed from io_wait callback
+            continue;
         }
-        DSS_ASSERT(rc == 0);
-        //TODO: Handle IO submission failure case
+        _dss_io_dev_flush_channel(dch);
+    }
+}
+
+/**
+ * @brief Stage op on its device channel, kept sorted by direction and LBA
+ */
+static void _dss_io_dev_stage_op(dss_device_channel_t *dch, dss_io_op_t *op)
+{
+    dss_io_op_t *pos;
+    bool is_write = (op->opc == DSS_IO_BLK_WRITE || op->opc == DSS_IO_BLK_WRITEV);
+    bool pos_write;
+
+    if(spdk_unlikely(!g_dss_io_plug.initialized)) {
+        TAILQ_INIT(&g_dss_io_plug.staged_chs);
+        g_dss_io_plug.initialized = true;
+    }
+
+    //New ops mostly land at the tail
+    TAILQ_FOREACH_REVERSE(pos, &dch->staged_ops, dss_io_op_list_s, stage_link) {
+        pos_write = (pos->opc == DSS_IO_BLK_WRITE || pos->opc == DSS_IO_BLK_WRITEV);
+        if(pos_write < is_write ||
+                (pos_write == is_write && pos->blk_rw.lba <= op->blk_rw.lba)) {
+            break;
+        }
+    }
+    if(pos) {
+        TAILQ_INSERT_AFTER(&dch->staged_ops, pos, op, stage_link);
+    } else {
+        TAILQ_INSERT_HEAD(&dch->staged_ops, op, stage_link);
+    }
+
+    if(!dch->on_staged_list) {
+        TAILQ_INSERT_TAIL(&g_dss_io_plug.staged_chs, dch, staged_link);
+        dch->on_staged_list = true;
+    }
+}
+
+void _dss_io_task_submit_to_device(dss_io_task_t *task)
+{
+    dss_io_op_t *curr_op, *tmp_op;
+    dss_device_channel_t *dch;
+
+    DSS_ASSERT(task->in_progress == true);
+
+    TAILQ_FOREACH_SAFE(curr_op, &task->op_todo_list, op_next, tmp_op) {
+        //TODO: io task management
+        dch = _dss_io_dev_get_dev_channel(curr_op->device);
 
         TAILQ_REMOVE(&task->op_todo_list, curr_op, op_next);
         TAILQ_INSERT_TAIL(&task->ops_in_progress, curr_op, op_next);
         task->num_outstanding_ops++;
+
+        _dss_io_dev_stage_op(dch, curr_op);
         if (curr_op->is_blocking) {
             break;
         }
@@ -409,9 +762,30 @@ void _dss_io_task_submit_to_device(dss_io_task_t *task)
     //Must have atleast one operation
     DSS_ASSERT(task->num_outstanding_ops != 0);
 
+    if(!g_dss_io_plug.plugged) {
+        _dss_io_dev_flush_staged();
+    }
+
     return;
 }
 
+void dss_io_task_plug(void)
+{
+    if(spdk_unlikely(!g_dss_io_plug.initialized)) {
+        TAILQ_INIT(&g_dss_io_plug.staged_chs);
+        g_dss_io_plug.initialized = true;
+    }
+    g_dss_io_plug.plugged = true;
+}
+
+void dss_io_task_unplug(void)
+{
+    g_dss_io_plug.plugged = false;
+    if(g_dss_io_plug.initialized) {
+        _dss_io_dev_flush_staged();
+    }
+}
+
 void dss_io_task_submit_to_device(dss_io_task_t *task)
 {
     if(task->in_progress == false) {
@@ -45,6 +45,14 @@ extern "C" {
 typedef struct dss_device_channel_s {
     void *ch;//SPDK channel
     void *thread;//SPDK thread
+    dss_device_t *device;
+    struct spdk_bdev_io_wait_entry io_wait;//Armed when bdev runs out of spdk_bdev_io
+    bool io_wait_armed;
+    bool on_staged_list;
+    TAILQ_HEAD(dss_io_op_list_s, dss_io_op_s) staged_ops;//Sorted by direction and LBA
+    TAILQ_ENTRY(dss_device_channel_s) staged_link;
+    uint64_t num_nomem;//Submissions that returned ENOMEM
+    uint64_t num_merged_ops;//Ops submitted as part of a merged bdev io
 } dss_device_channel_t;
 
 struct dss_device_s {
@@ -88,6 +88,14 @@ dss_io_task_module_status_t dss_io_task_module_init(dss_io_task_module_opts_t io
         goto err_out;
     }
 
+    malloc_opts.item_sz = sizeof(dss_iov_t);
+    malloc_opts.max_per_cache_items = io_task_opts.max_io_ops;
+    malloc_opts.num_caches = __dss_env_max_cores();
+    m->iov_allocator = dss_mallocator_init(DSS_MEM_ALLOC_MALLOC, malloc_opts);
+    if(!m->iov_allocator) {
+        goto err_out;
+    }
+
     *module = m;
     return DSS_IO_TASK_MODULE_STATUS_SUCCESS;
 
@@ -95,6 +103,7 @@ err_out:
     if(m) {
         if(m->io_task_allocator) dss_mallocator_destroy(m->io_task_allocator);
         if(m->ops_allocator) dss_mallocator_destroy(m->ops_allocator);
+        if(m->iov_allocator) dss_mallocator_destroy(m->iov_allocator);
         free(m);
     }
     *module = NULL;
@@ -106,6 +115,11 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m)
     dss_mallocator_status_t rc;
     DSS_RELEASE_ASSERT(m);
 
+    rc = dss_mallocator_destroy(m->iov_allocator);
+    if(rc != DSS_MALLOC_SUCCESS) {
+        return DSS_IO_TASK_MODULE_STATUS_ERROR;
+    }
+
     rc = dss_mallocator_destroy(m->ops_allocator);
     if(rc != DSS_MALLOC_SUCCESS) {
         return DSS_IO_TASK_MODULE_STATUS_ERROR;
@@ -119,6 +133,79 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m)
     return DSS_IO_TASK_MODULE_STATUS_SUCCESS;
 }
 
+dss_iov_t *dss_io_iov_get(dss_io_task_module_t *m)
+{
+    dss_iov_t *iov = NULL;
+    dss_mallocator_status_t status;
+
+    DSS_ASSERT(m);
+
+    status = dss_mallocator_get(m->iov_allocator, __dss_env_get_curr_core(), (dss_mallocator_item_t **)&iov);
+    if(status == DSS_MALLOC_ERROR || !iov) {
+        return NULL;
+    }
+
+    dss_io_iov_clear(iov);
+
+    return iov;
+}
+
+dss_io_task_status_t dss_io_iov_free(dss_io_task_module_t *m, dss_iov_t *iov)
+{
+    dss_mallocator_status_t status;
+
+    DSS_ASSERT(m);
+    DSS_ASSERT(iov);
+
+    status = dss_mallocator_put(m->iov_allocator, __dss_env_get_curr_core(), iov);
+    if(status != DSS_MALLOC_SUCCESS) {
+        return DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    return DSS_IO_TASK_STATUS_SUCCESS;
+}
+
+dss_io_task_status_t dss_io_iov_add(dss_iov_t *iov, void *data, uint64_t len, uint64_t offset)
+{
+    struct iovec *last;
+    void *base;
+
+    DSS_ASSERT(iov);
+    DSS_ASSERT(data);
+    DSS_ASSERT(len);
+
+    base = (void *)((uint8_t *)data + offset);
+
+    if(iov->iovcnt) {
+        last = &iov->iovs[iov->iovcnt - 1];
+        if((uint8_t *)last->iov_base + last->iov_len == (uint8_t *)base) {
+            //Extend the previous region if the new one follows it in memory
+            last->iov_len += len;
+            iov->len += len;
+            return DSS_IO_TASK_STATUS_SUCCESS;
+        }
+    }
+
+    if(iov->iovcnt == DSS_IO_MAX_IOV_ENTRIES) {
+        return DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    iov->iovs[iov->iovcnt].iov_base = base;
+    iov->iovs[iov->iovcnt].iov_len = len;
+    iov->iovcnt++;
+    iov->len += len;
+
+    return DSS_IO_TASK_STATUS_SUCCESS;
+}
+
+void dss_io_iov_clear(dss_iov_t *iov)
+{
+    DSS_ASSERT(iov);
+
+    iov->iovcnt = 0;
+    iov->len = 0;
+}
+
 dss_io_task_status_t dss_io_task_get_new(dss_io_task_module_t *m, dss_io_task_t **task)
 {
     dss_io_task_t *t;
@@ -148,6 +235,7 @@ dss_io_task_status_t dss_io_task_get_new(dss_io_task_module_t *m, dss_io_task_t
         t->task_status = DSS_IO_TASK_STATUS_SUCCESS;
         t->in_progress = false;
         t->cb_to_cq = false;
+        t->group = NULL;
     } else {
         DSS_ASSERT(status == DSS_MALLOC_SUCCESS);
     }
@@ -160,10 +248,29 @@ dss_io_task_status_t dss_io_task_get_new(dss_io_task_module_t *m, dss_io_task_t
 }
 
 
-dss_io_task_status_t dss_io_task_reset_ops(dss_io_task_t *io_task)
+static inline dss_io_task_status_t _dss_io_task_free_op(dss_io_task_t *io_task, dss_io_op_t *io_op)
 {
     dss_io_task_status_t rc = DSS_IO_TASK_STATUS_SUCCESS;
     dss_mallocator_status_t status;
+
+    if(io_op->opc == DSS_IO_BLK_READV || io_op->opc == DSS_IO_BLK_WRITEV) {
+        status = dss_mallocator_put(io_task->io_task_module->iov_allocator, io_task->tci, io_op->rw_v.iov);
+        if(status != DSS_MALLOC_SUCCESS) {
+            rc = DSS_IO_TASK_STATUS_ERROR;
+        }
+    }
+    memset(io_op, 0, sizeof(dss_io_op_t));
+    status = dss_mallocator_put(io_task->io_task_module->ops_allocator, io_task->tci, io_op);
+    if(status != DSS_MALLOC_SUCCESS) {
+        rc = DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    return rc;
+}
+
+dss_io_task_status_t dss_io_task_reset_ops(dss_io_task_t *io_task)
+{
+    dss_io_task_status_t rc = DSS_IO_TASK_STATUS_SUCCESS;
     dss_io_op_t *io_op;
 
     uint32_t freed_ops = 0;
@@ -174,36 +281,53 @@ dss_io_task_status_t dss_io_task_reset_ops(dss_io_task_t *io_task)
     tci = __dss_env_get_curr_core();
     DSS_ASSERT(tci == io_task->tci);
     DSS_ASSERT(io_task->in_progress == false);
+    DSS_ASSERT(io_task->group == NULL);
 
     DSS_ASSERT(TAILQ_EMPTY(&io_task->op_todo_list));
     DSS_ASSERT(TAILQ_EMPTY(&io_task->ops_in_progress));
-    //TODO: Handle failed ops
-    DSS_ASSERT(TAILQ_EMPTY(&io_task->failed_ops));
     DSS_ASSERT(io_task->num_outstanding_ops == 0);
     DSS_ASSERT(io_task->num_ops_done == io_task->num_total_ops);
 
     io_op = TAILQ_FIRST(&io_task->op_done);
     while(io_op) {
         TAILQ_REMOVE(&io_task->op_done, io_op, op_next);
-        memset(io_op, 0, sizeof(dss_io_op_t));
-        status = dss_mallocator_put(io_task->io_task_module->ops_allocator, io_task->tci, io_op);
-        if(status != DSS_MALLOC_SUCCESS) {
+        if(_dss_io_task_free_op(io_task, io_op) != DSS_IO_TASK_STATUS_SUCCESS) {
             rc = DSS_IO_TASK_STATUS_ERROR;
         }
         freed_ops++;
         io_op = TAILQ_FIRST(&io_task->op_done);
     }
 
+    //Failed ops are released the same way, the owner has seen task status by now
+    io_op = TAILQ_FIRST(&io_task->failed_ops);
+    while(io_op) {
+        TAILQ_REMOVE(&io_task->failed_ops, io_op, op_next);
+        if(_dss_io_task_free_op(io_task, io_op) != DSS_IO_TASK_STATUS_SUCCESS) {
+            rc = DSS_IO_TASK_STATUS_ERROR;
+        }
+        freed_ops++;
+        io_op = TAILQ_FIRST(&io_task->failed_ops);
+    }
+
     DSS_ASSERT(freed_ops == io_task->num_total_ops);
 
     io_task->num_ops_done = 0;
     io_task->num_total_ops = 0;
     io_task->task_status = DSS_IO_TASK_STATUS_SUCCESS;
     DSS_ASSERT(TAILQ_EMPTY(&io_task->op_done));
+    DSS_ASSERT(TAILQ_EMPTY(&io_task->failed_ops));
 
     return rc;
 }
 
+dss_io_task_status_t dss_io_task_get_status(dss_io_task_t *io_task)
+{
+    DSS_ASSERT(io_task);
+    DSS_ASSERT(io_task->in_progress == false);
+
+    return io_task->task_status;
+}
+
 dss_io_task_status_t dss_io_task_put(dss_io_task_t *io_task)
 {
     dss_io_task_status_t rc = DSS_IO_TASK_STATUS_SUCCESS;
@@ -238,11 +362,35 @@ dss_io_task_status_t dss_io_task_setup(dss_io_task_t *io_task, dss_request_t *re
     return DSS_IO_TASK_STATUS_SUCCESS;
 }
 
-static inline dss_io_task_status_t _dss_io_task_add_blk_op(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, void *data, bool is_write, dss_io_opts_t *opts)
+dss_io_task_status_t dss_io_task_group_create(dss_io_task_t **tasks, uint32_t ntasks)
+{
+    dss_io_task_group_t *g;
+    uint32_t i;
+
+    DSS_ASSERT(tasks);
+    DSS_ASSERT(ntasks > 0);
+
+    g = (dss_io_task_group_t *)calloc(1, sizeof(dss_io_task_group_t) + ntasks * sizeof(dss_io_task_t *));
+    if(!g) {
+        return DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    g->pending = ntasks;
+    g->ntasks = ntasks;
+    for(i = 0; i < ntasks; i++) {
+        DSS_ASSERT(tasks[i]->group == NULL);
+        DSS_ASSERT(TAILQ_EMPTY(&tasks[i]->ops_in_progress));
+        g->tasks[i] = tasks[i];
+        tasks[i]->group = g;
+    }
+
+    return DSS_IO_TASK_STATUS_SUCCESS;
+}
+
+static inline dss_io_op_t *_dss_io_task_alloc_blk_op(dss_io_task_t *task, dss_device_t *target_dev, dss_io_op_type_t opc, dss_io_opts_t *opts)
 {
     dss_io_op_t *io_op;
     dss_mallocator_status_t status;
-    dss_io_task_status_t rc;
 
     bool is_blocking = false;
     dss_io_op_owner_t mod_id = DSS_IO_OP_OWNER_NONE;
@@ -258,36 +406,98 @@ static inline dss_io_task_status_t _dss_io_task_add_blk_op(dss_io_task_t *task,
 
     status = dss_mallocator_get(task->io_task_module->ops_allocator, task->tci, (dss_mallocator_item_t **)&io_op);
     if(status == DSS_MALLOC_ERROR) {
-        return DSS_IO_TASK_STATUS_ERROR;
-    }
-
-    if(is_write == true) {
-        io_op->opc = DSS_IO_BLK_WRITE;
-    } else {
-        io_op->opc = DSS_IO_BLK_READ;
+        return NULL;
     }
 
+    io_op->opc = opc;
     io_op->is_blocking = is_blocking;
     io_op->mod_id = mod_id;
     io_op->op_id = task->num_total_ops;
     io_op->device = target_dev;
-
-    io_op->blk_rw.is_write = is_write;
-    io_op->blk_rw.lba = lba;
-    io_op->blk_rw.nblocks = num_blocks;
-    io_op->blk_rw.data = data;
+    io_op->merge_next = NULL;
+    io_op->merge_iov = NULL;
+    memset(&io_op->status, 0, sizeof(io_op->status));
 
     io_op->parent = task;
 
+    return io_op;
+}
+
+static inline bool _dss_io_op_is_write(dss_io_op_t *op)
+{
+    return (op->opc == DSS_IO_BLK_WRITE || op->opc == DSS_IO_BLK_WRITEV);
+}
+
+bool dss_io_op_can_merge(dss_io_op_t *prev, dss_io_op_t *next)
+{
+    DSS_ASSERT(prev && next);
+
+    if(prev->device != next->device) return false;
+    if(prev->is_blocking || next->is_blocking) return false;
+    if(_dss_io_op_is_write(prev) != _dss_io_op_is_write(next)) return false;
+    //lba and nblocks are at the same offset for blk_rw and rw_v
+    if(prev->blk_rw.lba + prev->blk_rw.nblocks != next->blk_rw.lba) return false;
+
+    if(prev->opc == DSS_IO_BLK_READ || prev->opc == DSS_IO_BLK_WRITE) {
+        if(!prev->blk_rw.data) return false;
+    }
+    if(next->opc == DSS_IO_BLK_READ || next->opc == DSS_IO_BLK_WRITE) {
+        if(!next->blk_rw.data) return false;
+    }
+
+    return true;
+}
+
+static inline void _dss_io_task_queue_blk_op(dss_io_task_t *task, dss_io_op_t *io_op)
+{
     task->num_total_ops++;
     TAILQ_INSERT_TAIL(&task->op_todo_list, io_op, op_next);
 
     DSS_DEBUGLOG(DSS_IO_TASK, "task[%p] op[%d] lba[%x] nblocks[%x]\n", task, io_op->opc, io_op->blk_rw.lba, io_op->blk_rw.nblocks);
+}
+
+static inline dss_io_task_status_t _dss_io_task_add_blk_op(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, void *data, bool is_write, dss_io_opts_t *opts)
+{
+    dss_io_op_t *io_op;
+
+    io_op = _dss_io_task_alloc_blk_op(task, target_dev, is_write ? DSS_IO_BLK_WRITE : DSS_IO_BLK_READ, opts);
+    if(!io_op) {
+        return DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    io_op->blk_rw.is_write = is_write;
+    io_op->blk_rw.lba = lba;
+    io_op->blk_rw.nblocks = num_blocks;
+    io_op->blk_rw.data = data;
+
+    _dss_io_task_queue_blk_op(task, io_op);
 
     return DSS_IO_TASK_STATUS_SUCCESS;
 
 }
 
+static inline dss_io_task_status_t _dss_io_task_add_blk_vop(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, bool is_write, dss_io_opts_t *opts)
+{
+    dss_io_op_t *io_op;
+
+    DSS_ASSERT(iov);
+    DSS_ASSERT(iov->iovcnt > 0);
+
+    io_op = _dss_io_task_alloc_blk_op(task, target_dev, is_write ? DSS_IO_BLK_WRITEV : DSS_IO_BLK_READV, opts);
+    if(!io_op) {
+        return DSS_IO_TASK_STATUS_ERROR;
+    }
+
+    io_op->rw_v.is_write = is_write;
+    io_op->rw_v.lba = lba;
+    io_op->rw_v.nblocks = num_blocks;
+    io_op->rw_v.iov = iov;
+
+    _dss_io_task_queue_blk_op(task, io_op);
+
+    return DSS_IO_TASK_STATUS_SUCCESS;
+}
+
 dss_io_task_status_t dss_io_task_add_blk_read(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, void *data, dss_io_opts_t *opts)
 {
     return _dss_io_task_add_blk_op(task, target_dev, lba, num_blocks, data,false, opts);
@@ -298,6 +508,16 @@ dss_io_task_status_t dss_io_task_add_blk_write(dss_io_task_t *task, dss_device_t
     return _dss_io_task_add_blk_op(task, target_dev, lba, num_blocks, data, true, opts);
 }
 
+dss_io_task_status_t dss_io_task_add_blk_readv(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, dss_io_opts_t *opts)
+{
+    return _dss_io_task_add_blk_vop(task, target_dev, lba, num_blocks, iov, false, opts);
+}
+
+dss_io_task_status_t dss_io_task_add_blk_writev(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, dss_io_opts_t *opts)
+{
+    return _dss_io_task_add_blk_vop(task, target_dev, lba, num_blocks, iov, true, opts);
+}
+
 dss_io_task_status_t dss_io_task_get_op_ranges(dss_io_task_t *task, dss_io_op_owner_t mod_id, dss_io_op_exec_state_t op_state, void **it_ctx, dss_io_op_user_param_t *op_params)
 {
     dss_io_op_t *op;
@@ -310,8 +530,9 @@ dss_io_task_status_t dss_io_task_get_op_ranges(dss_io_task_t *task, dss_io_op_ow
     DSS_ASSERT((task->num_outstanding_ops == 0) ||
                 (task->num_ops_done == task->num_total_ops));
 
-    //TODO: Handle failure path
-    DSS_ASSERT(task->task_status == DSS_IO_TASK_STATUS_SUCCESS);
+    //Ops of a failed task are iterated on completion only
+    DSS_ASSERT((task->task_status == DSS_IO_TASK_STATUS_SUCCESS) ||
+                (op_state != DSS_IO_OP_FOR_SUBMISSION));
 
     op_params->is_params_valid = false;
 
@@ -324,11 +545,11 @@ dss_io_task_status_t dss_io_task_get_op_ranges(dss_io_task_t *task, dss_io_op_ow
                 op = TAILQ_FIRST(&task->op_todo_list);
                 break;
             case DSS_IO_OP_COMPLETED:
-                DSS_DEBUGLOG(DSS_IO_TASK, "task[%p] op[%d] lba[%x] nblocks[%x], completed!\n", task, op, op->blk_rw.lba, op->blk_rw.nblocks);
+                DSS_DEBUGLOG(DSS_IO_TASK, "task[%p] iterate completed ops\n", task);
                 op = TAILQ_FIRST(&task->op_done);
                 break;
             case DSS_IO_OP_FAILED:
-                DSS_DEBUGLOG(DSS_IO_TASK, "task[%p] op[%d] lba[%x] nblocks[%x], failed!\n", task, op, op->blk_rw.lba, op->blk_rw.nblocks);
+                DSS_DEBUGLOG(DSS_IO_TASK, "task[%p] iterate failed ops\n", task);
                 op = TAILQ_FIRST(&task->failed_ops);
                 break;
             default:
@@ -364,8 +585,7 @@ dss_io_task_status_t dss_io_task_get_op_ranges(dss_io_task_t *task, dss_io_op_ow
         op = TAILQ_NEXT(op, op_next);
     } while(op);
 
-    DSS_ASSERT(found == true);
-
+    //A list may hold no op of mod_id, e.g. failed ops of another module
     if(!*it_ctx) {
         //Last item
         return DSS_IO_TASK_STATUS_IT_END;
@@ -34,6 +34,8 @@
 #ifndef DSS_IO_TASK_H
 #define DSS_IO_TASK_H
 
+#include <sys/uio.h>
+
 #include "dss.h"
 
 #include "apis/dss_io_task_apis.h"
@@ -47,31 +49,36 @@ extern "C" {
 struct dss_io_task_module_s {
     dss_mallocator_ctx_t *io_task_allocator;
     dss_mallocator_ctx_t *ops_allocator;
+    dss_mallocator_ctx_t *iov_allocator;
     dss_module_t *io_module;
 };
 
-// struct dss_iov_s {
-//     void *data;
-//     uint64_t len;
-//     uint64_t offset;
-// };
+#define DSS_IO_MAX_IOV_ENTRIES (16)
+#define DSS_IO_MAX_MERGE_BYTES (128 * 1024)//Upper bound on a merged block io
+
+struct dss_iov_s {
+    struct iovec iovs[DSS_IO_MAX_IOV_ENTRIES];
+    int iovcnt;
+    uint64_t len;//Total length of all data regions
+};
 
 typedef enum dss_io_op_type_e {
     DSS_IO_BLK_READ = 0,
-    DSS_IO_BLK_WRITE
+    DSS_IO_BLK_WRITE,
+    DSS_IO_BLK_READV,
+    DSS_IO_BLK_WRITEV
 } dss_io_op_type_t;
 
 typedef struct dss_io_op_s {
     dss_io_op_type_t opc;
+    //lba and nblocks are laid out the same in blk_rw and rw_v
     union {
-        // struct {
-        //     uint64_t lba;
-        //     uint64_t nblocks;
-        //     dss_iov_t *data_iov;
-        //     uint64_t length;
-        //     uint64_t offset;
-        //     bool is_write;
-        // } rw_v;
+        struct {
+            uint64_t lba;
+            uint64_t nblocks;
+            dss_iov_t *iov;//Owned by the op till ops are reset
+            bool is_write;
+        } rw_v;
         struct {
             uint64_t lba;
             uint64_t nblocks;
@@ -93,8 +100,18 @@ typedef struct dss_io_op_s {
         } nvme_rsp;
     } status;
     TAILQ_ENTRY(dss_io_op_s) op_next;
+    TAILQ_ENTRY(dss_io_op_s) stage_link;//Staged on device channel
+    struct dss_io_op_s *merge_next;//Next op in the same merged bdev io
+    dss_iov_t *merge_iov;//Set on the first op of a merged bdev io
 } dss_io_op_t;
 
+typedef struct dss_io_task_group_s {
+    uint32_t pending;//Tasks in the group that have not completed yet
+    uint32_t ntasks;
+    uint32_t failed;//Set when any task in the group failed
+    dss_io_task_t *tasks[];
+} dss_io_task_group_t;
+
 struct dss_io_task_s {
     dss_io_task_module_t *io_task_module;
     dss_request_t *dreq;
@@ -111,8 +128,19 @@ struct dss_io_task_s {
     uint32_t tci;//Task cache index
     bool in_progress;
     bool cb_to_cq;
+    dss_io_task_group_t *group;//Completion is posted with the rest of the group
 };
 
+/**
+ * @brief Check if next can be submitted in the same block io right after prev
+ *
+ * @param prev op that ends the current run
+ * @param next op that is a candidate to extend the run
+ * @return true if both ops are non blocking, target the same device in the
+ *         same direction and next starts at the LBA where prev ends
+ */
+bool dss_io_op_can_merge(dss_io_op_t *prev, dss_io_op_t *next);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,18 @@
 #include "dss_spdk_wrapper.h"
 #include "apis/dss_superblock_apis.h"
 #include "dss_block_allocator.h"
+#include "kvtrans_boot.h"
+#include "kvtrans_snapshot.h"
+
+extern uint32_t g_kvtrans_batch_size;
+extern uint32_t g_kvtrans_meta_cache_blks;
+extern uint64_t g_kvtrans_key_filter_keys;
+extern uint32_t g_kvtrans_placement;
+extern uint32_t g_kvtrans_cuckoo_bucket_blks;
+extern bool g_kvtrans_packed_meta;
+extern uint32_t g_kvtrans_boot_ranges;
+extern bool g_kvtrans_index_snapshot;
+extern bool g_kvtrans_ba_journal;
 
 #define TRACE_KVS_GET_NEW            SPDK_TPOINT_ID(TRACE_GROUP_DSS_KVTRANS, 0x1)
 #define TRACE_KVS_PUSH_CPL           SPDK_TPOINT_ID(TRACE_GROUP_DSS_KVTRANS, 0x2)
@@ -60,6 +72,17 @@ void set_default_kvtrans_params(kvtrans_params_t *params) {
     params->blk_offset = 1;
     params->state_num = DEFAULT_BLOCK_STATE_NUM;
     params->logi_blk_size = BLOCK_SIZE;
+    params->batch_size = g_kvtrans_batch_size;
+    params->meta_cache_blks = g_kvtrans_meta_cache_blks;
+    params->key_filter_keys = g_kvtrans_key_filter_keys;
+    params->placement = (enum kvtrans_placement_e) g_kvtrans_placement;
+    params->cuckoo_bucket_blks = g_kvtrans_cuckoo_bucket_blks;
+    params->cuckoo_table_blks = 0;
+    params->packed_meta = g_kvtrans_packed_meta;
+    params->snapshot_start_blk = 0;
+    params->snapshot_num_blks = 0;
+    params->ba_journal_start_blk = 0;
+    params->ba_journal_num_blks = 0;
 
     return;
 }
@@ -94,7 +117,6 @@ void dss_kvtrans_setup_request(dss_request_t *req, kvtrans_ctx_t *kvt_ctx)
 
 #define DSS_KVT_SUPERBLOCK_LBA (0)
 #define DSS_KVT_SUPERBLOCK_NUM_BLOCKS (1)
-#define DEFAULT_MDC_IO_DEPTH (128)
 
 dss_module_status_t dss_kvtrans_initiate_loading(kvtrans_ctx_t **new_kvt_ctx, dss_module_t *m, dss_module_instance_t *kvt_m_thrd_inst, kvtrans_params_t *p)
 {
@@ -120,6 +142,7 @@ dss_module_status_t dss_kvtrans_initiate_loading(kvtrans_ctx_t **new_kvt_ctx, ds
     init_req_ctx->kvt_ctx = new_kvt_ctx;
 
     init_req_ctx->state = DSS_KVT_LOADING_SUPERBLOCK;
+    init_req_ctx->boot_stat.start_tick = spdk_get_ticks();
 
     //TODO: Block allocator meta init might work better with bigger buffer
     init_req_ctx->data = spdk_dma_zmalloc(BLOCK_SIZE, 4096, NULL);
@@ -159,7 +182,7 @@ void dss_kvtrans_free_init_request(dss_request_t *req)
     kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
 
     spdk_free(kv_init_ctx->data);
-    if (kv_init_ctx->dc_entries) free(kv_init_ctx->dc_entries);
+    DSS_ASSERT(kv_init_ctx->range_reqs == NULL);
     memset(req, 0, sizeof(dss_request_t));
     free(req);
 
@@ -182,6 +205,13 @@ void *dss_kvtrans_thread_instance_init(void *mctx, void *inst_ctx, int inst_inde
     thread_ctx->inst_index = inst_index;
     thread_ctx->module_inst_ctx = inst_ctx;
 
+    thread_ctx->batch_size = g_kvtrans_batch_size;
+    thread_ctx->num_pending = 0;
+    if (thread_ctx->batch_size > 1) {
+        thread_ctx->pending_reqs = (dss_request_t **) calloc(thread_ctx->batch_size, sizeof(dss_request_t *));
+        DSS_RELEASE_ASSERT(thread_ctx->pending_reqs);
+    }
+
     dss_kvtrans_mctx->kvt_thrd_ctx_arr[inst_index] = thread_ctx;
     //Initialize devices corresponding to thread
     for(i=inst_index; i < num_devices; i= i+num_threads) {
@@ -226,28 +256,42 @@ void *dss_kvtrans_thread_instance_destroy(void *mctx, void *inst_ctx)
         free_kvtrans_ctx(kvt_ctx);
     }
 
+    DSS_ASSERT(thread_ctx->num_pending == 0);
+    if (thread_ctx->pending_reqs) {
+        free(thread_ctx->pending_reqs);
+        thread_ctx->pending_reqs = NULL;
+    }
+
     return NULL;
 }
 
-void dss_kvtrans_submit_runnable_tasks(kvtrans_ctx_t *kv_ctx)
+// Returns the number of tasks submitted
+int dss_kvtrans_submit_runnable_tasks(kvtrans_ctx_t *kv_ctx)
 {
     dss_io_task_t *io_task = NULL;
     dss_blk_allocator_status_t rc;
+    int nsubmitted = 0;
+
+    // Drain every runnable task, a sealed meta sync group releases
+    // its leader and all followers at once
+    while (1) {
+        rc = dss_blk_allocator_get_next_submit_meta_io_tasks(kv_ctx->blk_alloc_ctx, &io_task);
+        if(rc != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            DSS_ASSERT(rc == BLK_ALLOCATOR_STATUS_ITERATION_END);
+            return nsubmitted;//No IO task available to submit
+        }
 
-    //TODO: Can we try to sudmit multiple availabe tasks upto a defined threshold
-    rc = dss_blk_allocator_get_next_submit_meta_io_tasks(kv_ctx->blk_alloc_ctx, &io_task);
-    if(rc != BLK_ALLOCATOR_STATUS_SUCCESS) {
-        DSS_ASSERT(rc == BLK_ALLOCATOR_STATUS_ITERATION_END);
-        return;//No IO task available to submit
+        DSS_ASSERT(io_task != NULL);
+        DSS_DEBUGLOG(DSS_KVTRANS, "submit task [%p]\n", io_task);
+        dss_io_task_submit(io_task);
+        nsubmitted++;
     }
 
-    DSS_ASSERT(io_task != NULL);
-    DSS_DEBUGLOG(DSS_KVTRANS, "submit task [%p]\n", io_task);
-    dss_io_task_submit(io_task);
-
-    return;
+    return nsubmitted;
 }
 
+static void dss_kvtrans_process_batch(dss_kvtrans_thread_ctx_t *thread_ctx);
+
 int dss_kvtrans_process_generic(void *ctx)
 {
     dss_kvtrans_thread_ctx_t *thread_ctx = (dss_kvtrans_thread_ctx_t *) ctx;
@@ -255,15 +299,28 @@ int dss_kvtrans_process_generic(void *ctx)
     int num_devices = dss_kvtrans_mctx->dfly_subsys->num_io_devices;
     int num_threads = dss_kvtrans_mctx->num_threads;
     int i, inst_index;
+    int nprocessed = thread_ctx->num_pending;
+
+    // Drain requests collected since the last poll
+    dss_kvtrans_process_batch(thread_ctx);
 
     inst_index = thread_ctx->inst_index;
     for(i=inst_index; i < num_devices; i= i+num_threads) {
+        // Counts from io completions since the last poll
+        dss_kvtrans_publish_meta_cache_stat(dss_kvtrans_mctx->kvt_ctx_arr[i]);
         if(dss_kvtrans_mctx->kvt_ctx_arr[i]->is_ba_meta_sync_enabled) {
             //TODO: Optimize to disable genric poller if no kv trans instance has ba meta sync enabled
-            dss_kvtrans_submit_runnable_tasks(dss_kvtrans_mctx->kvt_ctx_arr[i]);
+            nprocessed += dss_kvtrans_submit_runnable_tasks(dss_kvtrans_mctx->kvt_ctx_arr[i]);
+            // Tasks held for an open group window or an overlapping meta write
+            // are only released by this poller, keep it at full rate
+            nprocessed += dss_blk_allocator_get_num_pending_meta_io_tasks(dss_kvtrans_mctx->kvt_ctx_arr[i]->blk_alloc_ctx);
         }
     }
-    return 0;
+
+    // Requests staged while the batch ran are drained on the next poll
+    nprocessed += thread_ctx->num_pending;
+
+    return nprocessed;
 }
 
 int dss_kvtrans_process(void *ctx, dss_request_t *req) {
@@ -325,6 +382,9 @@ void dss_kvtrans_net_request_complete(dss_request_t *req, dss_kvtrans_status_t r
         case KVTRANS_STATUS_NOT_FOUND:
             req->status = DSS_REQ_STATUS_KEY_NOT_FOUND;
             break;
+        case KVTRANS_STATUS_IO_ERROR:
+            req->status = DSS_REQ_STATUS_ERROR;
+            break;
         default:
             DSS_ASSERT(0);
         }
@@ -342,48 +402,99 @@ void dss_kvtrans_net_request_complete(dss_request_t *req, dss_kvtrans_status_t r
         }
 }
 
-int boot_dc_get_next_dmc_blk(dss_kvt_init_ctx_t *kv_init_ctx) {
+// Blocks that carry a key in their ondisk meta
+static bool boot_blk_has_key(blk_state_t state) {
+    switch (state) {
+    case EMPTY:
+    case DATA:
+    case DATA_COLLISION:
+    case CUCKOO_FREE:
+        return false;
+    default:
+        return true;
+    }
+}
+
+// Count a blk in the boot stats of a range
+static void boot_dc_count_blk(dss_kvt_boot_stat_t *stat, blk_state_t state) {
+    stat->blks_scanned++;
+    switch (state)
+    {
+    case META:
+        stat->meta++;
+    case COLLISION:
+        stat->mc++;
+    case META_DATA_COLLISION_ENTRY:
+    case META_DATA_COLLISION:
+        stat->mdc++;
+        break;
+    case PACKED_META:
+        stat->packed_blks++;
+        break;
+    default:
+        break;
+    }
+}
+
+static bool boot_dc_blk_needs_read(kvtrans_ctx_t *kvt_ctx, blk_state_t state) {
+    if (state == META_DATA_COLLISION_ENTRY) {
+        return true;
+    }
+    // key filter needs keys of all meta blks
+    return kvt_ctx->key_filter && boot_blk_has_key(state);
+}
+
+// Scan blk states from the range cursor and coalesce needed blks into the batch
+static int boot_dc_fill_batch(dss_kvt_init_ctx_t *kv_init_ctx) {
 
     dss_blk_allocator_status_t rc;
     kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
     blk_state_t state;
-    
-    while (kv_init_ctx->dss_mdc_lba < kvt_ctx->blk_offset + kvt_ctx->blk_num - 1)
+
+    while (kv_init_ctx->dss_mdc_lba < kv_init_ctx->dss_mdc_end_lba)
     {
-        // starts from kvt_ctx->blk_offset - 1;
-        kv_init_ctx->dss_mdc_lba ++;
         rc = dss_blk_allocator_get_block_state(kvt_ctx->blk_alloc_ctx, kv_init_ctx->dss_mdc_lba, &state);
         if (rc) {
             // TODO: error handling
-            DSS_ERRLOG("Fail to get blk [%d] state\n", kv_init_ctx->dss_mdc_lba);
+            DSS_ERRLOG("Fail to get blk [%lu] state\n", kv_init_ctx->dss_mdc_lba);
             return 1;
         }
 
-        switch (state)
-        {
-        case EMPTY:
-            break;
-        case META:
-            kvt_ctx->stat.meta ++;
-        case COLLISION:
-            kvt_ctx->stat.mc ++;
-        case META_DATA_COLLISION_ENTRY:
-        case META_DATA_COLLISION:
-            kvt_ctx->stat.mdc ++;
-            break; 
-        default:
+        if (boot_dc_blk_needs_read(kvt_ctx, state) &&
+                !kvtrans_boot_batch_add(kv_init_ctx->boot_batch, kv_init_ctx->dss_mdc_lba, state)) {
+            // batch is full, the blk goes to the next one
             break;
         }
+        boot_dc_count_blk(&kv_init_ctx->boot_stat, state);
+        kv_init_ctx->dss_mdc_lba++;
+    }
 
-        if (state==META_DATA_COLLISION_ENTRY) {
-            break;
+    return 0;
+}
+
+// Add key of a meta blk read at boot to the key filter
+static void boot_key_filter_insert_elm(kvtrans_ctx_t *kvt_ctx, void *data) {
+    ondisk_meta_t *blk = (ondisk_meta_t *)data;
+    kvtrans_packed_rec_t *rec;
+    int i;
+
+    if (kvtrans_packed_is_valid(data, sizeof(ondisk_meta_t))) {
+        for (i = 0; i < kvtrans_packed_num_slots(data); i++) {
+            rec = kvtrans_packed_get(data, i);
+            if (!rec) continue;
+            kvtrans_key_filter_insert(kvt_ctx->key_filter, kvtrans_packed_rec_key(rec), rec->key_len);
+            kvt_ctx->stat.packed_keys++;
         }
+        return;
     }
 
-    return 0;
+    if (!blk->isvalid || blk->key_len == 0) {
+        return;
+    }
+    kvtrans_key_filter_insert(kvt_ctx->key_filter, blk->key, blk->key_len);
 }
 
-int boot_dc_insert_elm(kvtrans_ctx_t *kvt_ctx, dc_item_t *it, void *data) {
+int boot_dc_insert_elm(kvtrans_ctx_t *kvt_ctx, cache_tbl_t *dc_tbl, dc_item_t *it, void *data) {
 
     dss_blk_allocator_status_t rc;
     uint64_t dc_idx;
@@ -395,7 +506,7 @@ int boot_dc_insert_elm(kvtrans_ctx_t *kvt_ctx, dc_item_t *it, void *data) {
 
     dc_idx = blk->data_collision_index;
 
-    if (find_elm(kvt_ctx->dc_cache_tbl, dc_idx)) {
+    if (find_elm(dc_tbl, dc_idx)) {
         // handle duplicated elm
     }
 
@@ -420,13 +531,548 @@ int boot_dc_insert_elm(kvtrans_ctx_t *kvt_ctx, dc_item_t *it, void *data) {
             assert(0);
     }
 
-    if(store_elm(kvt_ctx->dc_cache_tbl, dc_idx, (void *)it)) {
+    if(store_elm(dc_tbl, dc_idx, (void *)it)) {
         DSS_ERRLOG("Insert element failed in dc boot\n");
         return 1;
     }
     return 0;
 }
 
+// Add keys and dc entries of the blks read by the completed batch
+static void boot_dc_process_batch(kvtrans_ctx_t *kvt_ctx, dss_kvt_init_ctx_t *kv_init_ctx) {
+    kvtrans_boot_batch_t *batch = kv_init_ctx->boot_batch;
+    kvtrans_boot_blk_t *blk;
+    dc_item_t dc_entry;
+    void *buf;
+    uint32_t i;
+
+    for (i = 0; i < batch->num_blks; i++) {
+        blk = &batch->blks[i];
+        buf = (void *) ((uint64_t) blk->buf_idx * kvt_ctx->blk_size + (char *) kv_init_ctx->data);
+        if (kvt_ctx->key_filter && boot_blk_has_key((blk_state_t) blk->state)) {
+            boot_key_filter_insert_elm(kvt_ctx, buf);
+            kv_init_ctx->boot_stat.keys++;
+        }
+        if (blk->state != META_DATA_COLLISION_ENTRY) {
+            continue;
+        }
+        memset(&dc_entry, 0, sizeof(dc_item_t));
+        dc_entry.mdc_index = blk->lba;
+        if (boot_dc_insert_elm(kvt_ctx, (cache_tbl_t *) kv_init_ctx->range_dc_tbl, &dc_entry, buf)) {
+            DSS_ERRLOG("Insert element to dc table in boot failed for index [%lu]\n", blk->lba);
+            assert(0);
+        }
+        kv_init_ctx->boot_stat.dc_entries++;
+    }
+}
+
+static void boot_dc_submit_batch(dss_request_t *req, dss_kvt_init_ctx_t *kv_init_ctx) {
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    kvtrans_boot_batch_t *batch = kv_init_ctx->boot_batch;
+    kvtrans_boot_extent_t *ext;
+    dss_io_task_status_t iot_rc;
+    uint32_t i;
+
+    for (i = 0; i < batch->num_extents; i++) {
+        ext = &batch->extents[i];
+        iot_rc = dss_io_task_add_blk_read(
+                            req->io_task,
+                            kv_init_ctx->dev,
+                            ext->lba,
+                            ext->num_blks,
+                            (void *) ((uint64_t) ext->buf_idx * kvt_ctx->blk_size + (char *) kv_init_ctx->data),
+                            NULL);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+    kv_init_ctx->boot_stat.ios += batch->num_extents;
+    kv_init_ctx->boot_stat.blks_read += batch->num_buf_blks;
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "Submit %u mdc reads of %u blks.\n", batch->num_extents, batch->num_buf_blks);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+}
+
+// Run on the module instance a range request is posted to, on start and on each batch completion
+static void boot_dc_scan_range(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    dss_module_instance_t *minst = req->module_ctx[DSS_MODULE_KVTRANS].module_instance;
+    dss_request_t *parent_req = kv_init_ctx->parent_req;
+    dss_kvt_init_ctx_t *parent_ctx = &parent_req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    dss_io_task_t *iot = NULL;
+    dss_io_task_status_t iot_rc;
+
+    if (req->io_task == NULL) {
+        // io task is taken on the thread that runs the range
+        kv_init_ctx->boot_stat.start_tick = spdk_get_ticks();
+        iot_rc = dss_io_task_get_new(kv_init_ctx->iotm, &iot);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        iot_rc = dss_io_task_setup(iot, req, minst, req, false);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    } else if (kv_init_ctx->boot_batch->num_extents > 0) {
+        boot_dc_process_batch(kvt_ctx, kv_init_ctx);
+        kvtrans_boot_batch_reset(kv_init_ctx->boot_batch);
+        iot_rc = dss_io_task_reset_ops(req->io_task);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+
+    if (boot_dc_fill_batch(kv_init_ctx)) {
+        DSS_ERRLOG("DC Construction failed\n");
+        assert(0);
+    }
+    if (kv_init_ctx->boot_batch->num_extents > 0) {
+        boot_dc_submit_batch(req, kv_init_ctx);
+        return;
+    }
+
+    DSS_ASSERT(kv_init_ctx->dss_mdc_lba == kv_init_ctx->dss_mdc_end_lba);
+    iot_rc = dss_io_task_put(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    req->io_task = NULL;
+    kv_init_ctx->boot_stat.end_tick = spdk_get_ticks();
+
+    // the last range hands the loading request back for merging
+    if (__atomic_sub_fetch(&parent_ctx->pending_ranges, 1, __ATOMIC_ACQ_REL) == 0) {
+        dss_module_post_to_instance(DSS_MODULE_KVTRANS,
+                parent_req->module_ctx[DSS_MODULE_KVTRANS].module_instance, parent_req);
+    }
+}
+
+// Ranges are spread over kvtrans threads unless the key filter, which is not thread safe, is loaded
+static dss_module_instance_t *boot_dc_range_instance(dss_request_t *req, kvtrans_ctx_t *kvt_ctx, uint32_t range_idx) {
+    dss_module_instance_t *owner = req->module_ctx[DSS_MODULE_KVTRANS].module_instance;
+    dss_kvtrans_module_ctx_t *mctx = (dss_kvtrans_module_ctx_t *) req->module_ctx[DSS_MODULE_KVTRANS].module->ctx;
+    dss_kvtrans_thread_ctx_t *thread_ctx;
+    uint32_t i, owner_idx = 0;
+
+    if (kvt_ctx->key_filter) {
+        return owner;
+    }
+
+    for (i = 0; i < mctx->num_threads; i++) {
+        thread_ctx = mctx->kvt_thrd_ctx_arr[i];
+        if (thread_ctx && thread_ctx->module_inst_ctx == owner) {
+            owner_idx = i;
+            break;
+        }
+    }
+
+    // thread instances still being set up keep their ranges on the owner
+    thread_ctx = mctx->kvt_thrd_ctx_arr[(owner_idx + range_idx) % mctx->num_threads];
+    if (!thread_ctx) {
+        return owner;
+    }
+    return (dss_module_instance_t *) thread_ctx->module_inst_ctx;
+}
+
+// Split the device into LBA ranges each scanned by its own request
+static void boot_dc_start_ranges(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    dss_request_t *range_req;
+    dss_kvt_init_ctx_t *range_ctx;
+    uint32_t num_ranges = g_kvtrans_boot_ranges;
+    uint32_t i;
+    int rc;
+
+    if (num_ranges > kvt_ctx->blk_num) {
+        num_ranges = kvt_ctx->blk_num;
+    }
+    DSS_ASSERT(num_ranges > 0);
+
+    kv_init_ctx->num_ranges = num_ranges;
+    kv_init_ctx->pending_ranges = num_ranges;
+    kv_init_ctx->range_reqs = (dss_request_t **) calloc(num_ranges, sizeof(dss_request_t *));
+    DSS_ASSERT(kv_init_ctx->range_reqs);
+
+    for (i = 0; i < num_ranges; i++) {
+        range_req = (dss_request_t *) calloc(1, sizeof(dss_request_t));
+        DSS_ASSERT(range_req);
+
+        range_req->opc = DSS_INTERNAL_IO;
+        range_req->module_ctx[DSS_MODULE_KVTRANS].module = req->module_ctx[DSS_MODULE_KVTRANS].module;
+        range_req->module_ctx[DSS_MODULE_KVTRANS].module_instance = boot_dc_range_instance(req, kvt_ctx, i);
+        range_req->ss = req->ss;
+
+        range_ctx = &range_req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+        range_ctx->dev = kv_init_ctx->dev;
+        range_ctx->iotm = kv_init_ctx->iotm;
+        range_ctx->kvt_ctx = kv_init_ctx->kvt_ctx;
+        range_ctx->state = DSS_KVT_SCANNING_DC_RANGE;
+        range_ctx->parent_req = req;
+        kvtrans_boot_split_range(kvt_ctx->blk_offset, kvt_ctx->blk_num, num_ranges, i,
+                                 &range_ctx->dss_mdc_lba, &range_ctx->dss_mdc_end_lba);
+
+        range_ctx->data_len = (uint64_t) kvt_ctx->blk_size * KVTRANS_BOOT_BUF_BLKS;
+        range_ctx->data = spdk_dma_zmalloc(range_ctx->data_len, 4096, NULL);
+        DSS_ASSERT(range_ctx->data != NULL);
+        range_ctx->boot_batch = (kvtrans_boot_batch_t *) calloc(1, sizeof(kvtrans_boot_batch_t));
+        DSS_ASSERT(range_ctx->boot_batch);
+        rc = kvtrans_boot_batch_init(range_ctx->boot_batch, KVTRANS_BOOT_BUF_BLKS,
+                                     KVTRANS_BOOT_MAX_IO_BLKS, KVTRANS_BOOT_MAX_GAP_BLKS);
+        DSS_ASSERT(rc == 0);
+        range_ctx->range_dc_tbl = init_cache_tbl("boot_dc_range", 0, sizeof(dc_item_t), 1);
+        DSS_ASSERT(range_ctx->range_dc_tbl);
+
+        kv_init_ctx->range_reqs[i] = range_req;
+    }
+
+    // ranges may complete as soon as they are posted
+    kv_init_ctx->state = DSS_KVT_MERGING_DC_HT;
+    for (i = 0; i < num_ranges; i++) {
+        range_req = kv_init_ctx->range_reqs[i];
+        dss_module_post_to_instance(DSS_MODULE_KVTRANS,
+                range_req->module_ctx[DSS_MODULE_KVTRANS].module_instance, range_req);
+    }
+}
+
+static void boot_dc_merge_elm(uint64_t dc_idx, void *elm, void *dc_tbl) {
+    if (store_elm((cache_tbl_t *) dc_tbl, dc_idx, elm)) {
+        DSS_ERRLOG("Merge element failed in dc boot for index [%lu]\n", dc_idx);
+        assert(0);
+    }
+}
+
+static inline double boot_ticks_to_sec(uint64_t ticks) {
+    return (double) ticks / spdk_get_ticks_hz();
+}
+
+// Merge range dc tables into the dc table of the device and report boot time
+static void boot_dc_merge_ranges(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    dss_kvt_boot_stat_t *total = &kv_init_ctx->boot_stat;
+    dss_kvt_boot_stat_t *stat;
+    dss_kvt_init_ctx_t *range_ctx;
+    uint64_t merge_tick = spdk_get_ticks();
+    uint32_t i;
+
+    DSS_ASSERT(kv_init_ctx->pending_ranges == 0);
+    for (i = 0; i < kv_init_ctx->num_ranges; i++) {
+        range_ctx = &kv_init_ctx->range_reqs[i]->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+        stat = &range_ctx->boot_stat;
+
+        for_each_elm_fn((cache_tbl_t *) range_ctx->range_dc_tbl, boot_dc_merge_elm, kvt_ctx->dc_cache_tbl);
+
+        kvt_ctx->stat.meta += stat->meta;
+        kvt_ctx->stat.mc += stat->mc;
+        kvt_ctx->stat.mdc += stat->mdc;
+        kvt_ctx->stat.packed_blks += stat->packed_blks;
+
+        total->blks_scanned += stat->blks_scanned;
+        total->ios += stat->ios;
+        total->blks_read += stat->blks_read;
+        total->dc_entries += stat->dc_entries;
+        total->keys += stat->keys;
+
+        DSS_NOTICELOG("DC range [%u] lba [%lu, %lu): scanned [%lu] blks, read [%lu] blks in [%lu] IOs, "
+                      "[%lu] dc entries, [%lu] keys in [%.3f] s\n",
+                      i, range_ctx->dss_mdc_end_lba - stat->blks_scanned, range_ctx->dss_mdc_end_lba,
+                      stat->blks_scanned, stat->blks_read, stat->ios,
+                      stat->dc_entries, stat->keys,
+                      boot_ticks_to_sec(stat->end_tick - stat->start_tick));
+
+        free_cache_tbl((cache_tbl_t *) range_ctx->range_dc_tbl);
+        kvtrans_boot_batch_free(range_ctx->boot_batch);
+        free(range_ctx->boot_batch);
+        spdk_dma_free(range_ctx->data);
+        free(kv_init_ctx->range_reqs[i]);
+    }
+    free(kv_init_ctx->range_reqs);
+    kv_init_ctx->range_reqs = NULL;
+
+    DSS_NOTICELOG("KV trans [%p] boot: superblock [%.3f] s, BA meta [%.3f] s, "
+                  "DC table [%.3f] s in [%u] ranges (merge [%.3f] s)\n",
+                  kvt_ctx,
+                  boot_ticks_to_sec(kv_init_ctx->ba_start_tick - total->start_tick),
+                  boot_ticks_to_sec(kv_init_ctx->dc_start_tick - kv_init_ctx->ba_start_tick),
+                  boot_ticks_to_sec(spdk_get_ticks() - kv_init_ctx->dc_start_tick),
+                  kv_init_ctx->num_ranges,
+                  boot_ticks_to_sec(spdk_get_ticks() - merge_tick));
+    DSS_NOTICELOG("KV trans [%p] boot: scanned [%lu] blks, read [%lu] blks in [%lu] IOs, "
+                  "[%lu] dc entries, [%lu] keys\n",
+                  kvt_ctx, total->blks_scanned, total->blks_read, total->ios,
+                  total->dc_entries, total->keys);
+}
+
+// Meta blocks are placed as the device was formatted, a different config would misread them
+static bool boot_meta_layout_matches(dss_super_block_t *super_block, kvtrans_params_t *params) {
+    uint8_t placement = params->placement == KVTRANS_PLACEMENT_CUCKOO ?
+                            DSS_KVT_META_PLACEMENT_CUCKOO : DSS_KVT_META_PLACEMENT_CHAIN;
+    uint8_t packed_meta;
+
+    if (super_block->kvt_meta_placement != placement) {
+        DSS_ERRLOG("kvtrans placement [%u] does not match placement [%u] of formatted device\n",
+                    placement, super_block->kvt_meta_placement);
+        return false;
+    }
+    if (placement == DSS_KVT_META_PLACEMENT_CUCKOO &&
+            super_block->kvt_cuckoo_bucket_blks != params->cuckoo_bucket_blks) {
+        DSS_ERRLOG("kvtrans cuckoo bucket blks [%u] does not match [%u] of formatted device\n",
+                    params->cuckoo_bucket_blks, super_block->kvt_cuckoo_bucket_blks);
+        return false;
+    }
+    // packing is turned off without cuckoo placement
+    packed_meta = placement == DSS_KVT_META_PLACEMENT_CUCKOO && params->packed_meta;
+    if (super_block->kvt_packed_meta != packed_meta) {
+        DSS_ERRLOG("kvtrans packed meta [%u] does not match [%u] of formatted device\n",
+                    packed_meta, super_block->kvt_packed_meta);
+        return false;
+    }
+    return true;
+}
+
+// Add blk reads or writes of a snapshot buffer split into IOs of at most BA_META_DISK_READ_SZ_MB
+static void snapshot_add_blk_io(dss_request_t *req, dss_kvt_init_ctx_t *kv_init_ctx, uint64_t lba,
+                                uint64_t num_blks, void *buf, bool is_write) {
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    uint64_t max_io_blks = BA_META_DISK_READ_SZ_MB / kvt_ctx->blk_size;
+    uint64_t io_blks;
+    dss_io_task_status_t iot_rc;
+
+    while (num_blks > 0) {
+        io_blks = num_blks < max_io_blks ? num_blks : max_io_blks;
+        if (is_write) {
+            iot_rc = dss_io_task_add_blk_write(req->io_task, kv_init_ctx->dev, lba, io_blks, buf, NULL);
+        } else {
+            iot_rc = dss_io_task_add_blk_read(req->io_task, kv_init_ctx->dev, lba, io_blks, buf, NULL);
+        }
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        lba += io_blks;
+        num_blks -= io_blks;
+        buf = (void *) ((char *) buf + io_blks * kvt_ctx->blk_size);
+    }
+}
+
+// Read the whole BA journal region, false if there is no journal to replay
+static bool boot_ba_journal_read(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    uint64_t num_blks = kvt_ctx->kvtrans_params.ba_journal_num_blks;
+    dss_io_task_status_t iot_rc;
+
+    if (!g_kvtrans_ba_journal || num_blks == 0) {
+        return false;
+    }
+
+    iot_rc = dss_io_task_reset_ops(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    kv_init_ctx->ba_journal_data = spdk_dma_zmalloc(num_blks * kvt_ctx->blk_size, 4096, NULL);
+    DSS_ASSERT(kv_init_ctx->ba_journal_data != NULL);
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.ba_journal_start_blk, num_blks,
+                        kv_init_ctx->ba_journal_data, false);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    return true;
+}
+
+// Apply BA journal records newer than the last bitmap checkpoint
+static void boot_ba_journal_replay(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    uint64_t num_recs = 0;
+    dss_blk_allocator_status_t rc;
+
+    rc = dss_blk_allocator_load_journal_from_disk_data(kvt_ctx->blk_alloc_ctx,
+            kv_init_ctx->ba_journal_data,
+            kvt_ctx->kvtrans_params.ba_journal_num_blks * kvt_ctx->blk_size,
+            &num_recs);
+    DSS_ASSERT(rc == BLK_ALLOCATOR_STATUS_SUCCESS);
+    DSS_NOTICELOG("BA journal replayed [%lu] records\n", num_recs);
+
+    spdk_dma_free(kv_init_ctx->ba_journal_data);
+    kv_init_ctx->ba_journal_data = NULL;
+}
+
+// Read the snapshot header blk into the loading buffer
+static bool boot_snapshot_read_hdr(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    dss_io_task_status_t iot_rc;
+
+    if (kvt_ctx->kvtrans_params.snapshot_num_blks < 2) {
+        return false;
+    }
+    DSS_ASSERT(kv_init_ctx->data_len >= kvt_ctx->blk_size);
+
+    iot_rc = dss_io_task_reset_ops(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk, 1,
+                        kv_init_ctx->data, false);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    return true;
+}
+
+// Read the entries of a loadable snapshot, or reset a clean one that cannot be used.
+// Returns true if IO is submitted for the next state
+static bool boot_snapshot_check_hdr(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    kvtrans_snapshot_hdr_t *hdr = (kvtrans_snapshot_hdr_t *) kv_init_ctx->data;
+    uint64_t data_len = (kvt_ctx->kvtrans_params.snapshot_num_blks - 1) * kvt_ctx->blk_size;
+    uint64_t data_blks;
+    dss_io_task_status_t iot_rc;
+
+    if (!kvtrans_snapshot_hdr_is_valid(hdr)) {
+        DSS_NOTICELOG("No index snapshot found\n");
+        kv_init_ctx->state = DSS_KVT_LOADING_DC_HT;
+        return false;
+    }
+    kvt_ctx->snapshot_gen = hdr->generation;
+
+    iot_rc = dss_io_task_reset_ops(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    // key filter is filled by the scan of all meta blks
+    if (g_kvtrans_index_snapshot && !kvt_ctx->key_filter &&
+            kvtrans_snapshot_is_loadable(kvt_ctx, hdr, data_len)) {
+        kv_init_ctx->state = DSS_KVT_RESTORING_SNAPSHOT;
+        data_blks = kvtrans_snapshot_data_blks(hdr->num_dc_entries, kvt_ctx->blk_size);
+        if (data_blks == 0) {
+            return false;
+        }
+        kv_init_ctx->snapshot_data = spdk_dma_zmalloc(data_blks * kvt_ctx->blk_size, 4096, NULL);
+        DSS_ASSERT(kv_init_ctx->snapshot_data != NULL);
+        snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk + 1,
+                            data_blks, kv_init_ctx->snapshot_data, false);
+        iot_rc = dss_io_task_submit(req->io_task);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        return true;
+    }
+
+    if (!hdr->clean) {
+        DSS_NOTICELOG("Index snapshot [%lu] is stale\n", hdr->generation);
+        kv_init_ctx->state = DSS_KVT_LOADING_DC_HT;
+        return false;
+    }
+
+    DSS_NOTICELOG("Index snapshot [%lu] is not used\n", hdr->generation);
+    kvtrans_snapshot_invalidate(hdr);
+    kv_init_ctx->snapshot_loaded = false;
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk, 1,
+                        kv_init_ctx->data, true);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    kv_init_ctx->state = DSS_KVT_INVALIDATING_SNAPSHOT;
+    return true;
+}
+
+// Restore the dc table and mark the snapshot consumed so a later unclean stop is not mistaken for a clean one
+static void boot_snapshot_restore(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    kvtrans_snapshot_hdr_t *hdr = (kvtrans_snapshot_hdr_t *) kv_init_ctx->data;
+    dss_io_task_status_t iot_rc;
+
+    kv_init_ctx->snapshot_loaded = !kvtrans_snapshot_load(kvt_ctx, hdr, kv_init_ctx->snapshot_data);
+    if (!kv_init_ctx->snapshot_loaded) {
+        DSS_ERRLOG("Index snapshot [%lu] checksum mismatch\n", hdr->generation);
+    }
+    if (kv_init_ctx->snapshot_data) {
+        spdk_dma_free(kv_init_ctx->snapshot_data);
+        kv_init_ctx->snapshot_data = NULL;
+    }
+
+    kvtrans_snapshot_invalidate(hdr);
+    iot_rc = dss_io_task_reset_ops(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk, 1,
+                        kv_init_ctx->data, true);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+}
+
+// Module stop deferred until the index snapshots of all kvtrans instances are written
+typedef struct dss_kvt_snapshot_stop_ctx_s {
+    dss_module_t *module;
+    df_module_event_complete_cb cb;
+    void *cb_arg;
+    void *src_thread;
+    uint32_t pending;
+} dss_kvt_snapshot_stop_ctx_t;
+
+static void snapshot_stop_module(void *ctx) {
+    dss_kvt_snapshot_stop_ctx_t *stop_ctx = (dss_kvt_snapshot_stop_ctx_t *) ctx;
+
+    dfly_module_stop(stop_ctx->module, stop_ctx->cb, stop_ctx->cb_arg);
+    free(stop_ctx);
+}
+
+// Serialize the dc table and write the entries, the header blk is written once they are on disk
+static bool snapshot_save_data(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    kvtrans_snapshot_hdr_t *hdr;
+    dss_io_task_t *iot = NULL;
+    dss_io_task_status_t iot_rc;
+    uint64_t data_blks;
+    uint64_t tick = spdk_get_ticks();
+
+    kv_init_ctx->data_len = kvt_ctx->kvtrans_params.snapshot_num_blks * kvt_ctx->blk_size;
+    kv_init_ctx->data = spdk_dma_zmalloc(kv_init_ctx->data_len, 4096, NULL);
+    DSS_ASSERT(kv_init_ctx->data != NULL);
+    hdr = (kvtrans_snapshot_hdr_t *) kv_init_ctx->data;
+
+    if (kvtrans_snapshot_save(kvt_ctx, hdr, (char *) kv_init_ctx->data + kvt_ctx->blk_size,
+                              kv_init_ctx->data_len - kvt_ctx->blk_size)) {
+        DSS_ERRLOG("Index snapshot of kv trans [%p] skipped\n", kvt_ctx);
+        kv_init_ctx->state = DSS_KVT_SNAPSHOT_SAVED;
+        return false;
+    }
+    DSS_NOTICELOG("Index snapshot [%lu] of kv trans [%p] with [%lu] entries serialized in [%.3f] s\n",
+                  hdr->generation, kvt_ctx, hdr->num_dc_entries,
+                  boot_ticks_to_sec(spdk_get_ticks() - tick));
+
+    iot_rc = dss_io_task_get_new(kv_init_ctx->iotm, &iot);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    iot_rc = dss_io_task_setup(iot, req, req->module_ctx[DSS_MODULE_KVTRANS].module_instance, req, false);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    kv_init_ctx->state = DSS_KVT_SAVED_SNAPSHOT_DATA;
+    data_blks = kvtrans_snapshot_data_blks(hdr->num_dc_entries, kvt_ctx->blk_size);
+    if (data_blks == 0) {
+        return false;
+    }
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk + 1, data_blks,
+                        (char *) kv_init_ctx->data + kvt_ctx->blk_size, true);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    return true;
+}
+
+static void snapshot_save_hdr(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    kvtrans_ctx_t *kvt_ctx = *kv_init_ctx->kvt_ctx;
+    dss_io_task_status_t iot_rc;
+
+    iot_rc = dss_io_task_reset_ops(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    snapshot_add_blk_io(req, kv_init_ctx, kvt_ctx->kvtrans_params.snapshot_start_blk, 1,
+                        kv_init_ctx->data, true);
+    iot_rc = dss_io_task_submit(req->io_task);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+}
+
+// Free the save request, the last one stops the module on the thread that requested the stop
+static void snapshot_save_done(dss_request_t *req) {
+    dss_kvt_init_ctx_t *kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+    dss_kvt_snapshot_stop_ctx_t *stop_ctx = (dss_kvt_snapshot_stop_ctx_t *) kv_init_ctx->stop_ctx;
+    dss_io_task_status_t iot_rc;
+
+    if (req->io_task) {
+        iot_rc = dss_io_task_put(req->io_task);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        req->io_task = NULL;
+    }
+    spdk_dma_free(kv_init_ctx->data);
+    free(req);
+
+    if (__atomic_sub_fetch(&stop_ctx->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        dss_spdk_thread_send_msg(stop_ctx->src_thread, (void *) snapshot_stop_module, stop_ctx);
+    }
+}
+
 uint64_t _dss_calculate_default_ba_meta_sz_blocks(uint64_t total_blocks)
 {
     dss_blk_allocator_opts_t ba_config;
@@ -461,11 +1107,9 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
     dss_super_block_t *super_block = NULL;
     dss_io_task_status_t iot_rc = DSS_IO_TASK_STATUS_ERROR;
     dss_blk_allocator_context_t *blk_alloc_ctx = NULL;
+    dss_kvtrans_status_t kvt_rc;
     uint64_t usable_start_block = 0;
     uint64_t usable_end_block = 0;
-    int mdc_io_idx = 0;
-    void *mdc_buffer;
-    dc_item_t *dc_entry;
 
     DSS_ASSERT(req->opc == DSS_INTERNAL_IO);
     do {
@@ -511,6 +1155,29 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
                         super_block->logi_blk_alloc_meta_start_blk;
                     // Procure logical start addr or the offset
                     params.blk_offset = usable_start_block;
+                    // Procure index snapshot region if reserved by formatter
+                    params.snapshot_start_blk =
+                        super_block->logi_kvt_snapshot_start_blk;
+                    if (super_block->logi_kvt_snapshot_end_blk >
+                            super_block->logi_kvt_snapshot_start_blk) {
+                        params.snapshot_num_blks =
+                            super_block->logi_kvt_snapshot_end_blk -
+                            super_block->logi_kvt_snapshot_start_blk + 1;
+                    }
+                    // Procure block allocator journal if reserved by formatter
+                    params.ba_journal_start_blk =
+                        super_block->logi_blk_alloc_journal_start_blk;
+                    if (super_block->logi_blk_alloc_journal_end_blk >
+                            super_block->logi_blk_alloc_journal_start_blk) {
+                        params.ba_journal_num_blks =
+                            super_block->logi_blk_alloc_journal_end_blk -
+                            super_block->logi_blk_alloc_journal_start_blk + 1;
+                    }
+
+                    // Refuse to start on a device formatted with another meta layout
+                    if (!boot_meta_layout_matches(super_block, &params)) {
+                        DSS_RELEASE_ASSERT(0);
+                    }
 
                     //TODO: init path if not loading from superblock
                     //TODO: Setup device specific kvtrans params
@@ -523,6 +1190,7 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
                         break;
                     }
                     DSS_NOTICELOG("BA loading bitmap starts\n");
+                    kv_init_ctx->ba_start_tick = spdk_get_ticks();
                     // Figure out the first and last logical block to read from
                     kv_init_ctx->ba_meta_start_block =
                         super_block->logi_blk_alloc_meta_start_blk;
@@ -614,9 +1282,9 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
                 kv_init_ctx->ba_disk_read_it++;
                 if (kv_init_ctx->ba_disk_read_it == 
                         kv_init_ctx->ba_disk_read_total_it + 1) {
-                    // Initialize reading DC hash table, proceed to next
-                    // phase
-                    kv_init_ctx->state = DSS_KVT_LOADING_DC_HT;
+                    // Replay the BA journal over the bitmap, proceed to
+                    // next phase
+                    kv_init_ctx->state = DSS_KVT_LOADING_BA_JOURNAL;
                     DSS_ASSERT(kv_init_ctx->dss_mdc_lba == 0);
                     DSS_NOTICELOG("BA loading bitmap completed\n");
                     break;
@@ -644,80 +1312,92 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
                     kv_init_ctx->ba_meta_start_block_per_iter +
                     kv_init_ctx->ba_meta_num_blks_per_iter;
                 break;
-             case DSS_KVT_LOADING_DC_HT:
-                if (kv_init_ctx->dss_mdc_lba == 0) {
-                    // init varible for dc table construction
-                    DSS_NOTICELOG("DC table construction starts\n");
-                    kv_init_ctx->mdc_io_depth = DEFAULT_MDC_IO_DEPTH;
-                    kv_init_ctx->last_batch = false;
-                    kv_init_ctx->mdc_io_count = 0;
-                    kv_init_ctx->dc_ent_sz = sizeof(dc_item_t);
-                    kv_init_ctx->data = spdk_dma_zmalloc(kvt_ctx->blk_size * kv_init_ctx->mdc_io_depth, 4096, NULL);
-                    kv_init_ctx->dc_entries = calloc(kv_init_ctx->mdc_io_depth, kv_init_ctx->dc_ent_sz);
-                    kv_init_ctx->dss_mdc_lba = kvt_ctx->blk_offset - 1;
-                    iot_rc = dss_io_task_reset_ops(req->io_task);
-                    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
-                } else {
-                    // iterate over all buffers of outstanding mdc IOs.
-                    for (mdc_io_idx = 0; mdc_io_idx<kv_init_ctx->mdc_io_count; mdc_io_idx++) {
-                        mdc_buffer = (void *) (mdc_io_idx * kvt_ctx->blk_size + (char *) kv_init_ctx->data);
-                        dc_entry = (dc_item_t *) (mdc_io_idx * kv_init_ctx->dc_ent_sz + (char *) kv_init_ctx->dc_entries);
-                        if (boot_dc_insert_elm(kvt_ctx, dc_entry, mdc_buffer)) {
-                            DSS_ERRLOG("Insert element to dc table in boot failed for index [%u]\n", kv_init_ctx->dss_mdc_lba);
-                            assert(0);
-                        }
-                    }
-
-                    DSS_DEBUGLOG(DSS_KVTRANS, "Insert %d dc entries to dc_tbl.\n", mdc_io_idx);
-
-                    memset(kv_init_ctx->data, 0, kvt_ctx->blk_size * kv_init_ctx->mdc_io_depth);
-                    memset(kv_init_ctx->dc_entries, 0, kv_init_ctx->dc_ent_sz * kv_init_ctx->mdc_io_depth);
-                    iot_rc = dss_io_task_reset_ops(req->io_task);
-                    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+            case DSS_KVT_LOADING_BA_JOURNAL:
+                if (boot_ba_journal_read(req)) {
+                    kv_init_ctx->state = DSS_KVT_REPLAYING_BA_JOURNAL;
+                    return;
                 }
-
-                for (mdc_io_idx = 0 ; mdc_io_idx<kv_init_ctx->mdc_io_depth; mdc_io_idx++) {
-                    mdc_buffer = (void *) (mdc_io_idx * kvt_ctx->blk_size + (char *) kv_init_ctx->data);
-                    dc_entry = (dc_item_t *) (mdc_io_idx * kv_init_ctx->dc_ent_sz + (char *) kv_init_ctx->dc_entries);
-                    DSS_ASSERT(mdc_buffer);
-                    if (boot_dc_get_next_dmc_blk(kv_init_ctx)) {
-                        DSS_ERRLOG("DC Construction failed\n");
-                        assert(0);
-                    }
-                    if (kv_init_ctx->dss_mdc_lba == kvt_ctx->blk_offset + kvt_ctx->blk_num - 1) {
-                        kv_init_ctx->last_batch = true;
-                        kv_init_ctx->mdc_io_count = mdc_io_idx;
-                        break;
-                    }
-                    iot_rc = dss_io_task_add_blk_read(
-                                        req->io_task,
-                                        kv_init_ctx->dev,
-                                        kv_init_ctx->dss_mdc_lba,
-                                        1, 
-                                        mdc_buffer,
-                                        NULL);
-                    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
-                    dc_entry->mdc_index = kv_init_ctx->dss_mdc_lba;
+                // Initialize reading DC hash table from the index
+                // snapshot or by scan
+                kv_init_ctx->state = DSS_KVT_LOADING_SNAPSHOT;
+                break;
+            case DSS_KVT_REPLAYING_BA_JOURNAL:
+                boot_ba_journal_replay(req);
+                kv_init_ctx->state = DSS_KVT_LOADING_SNAPSHOT;
+                break;
+            case DSS_KVT_LOADING_SNAPSHOT:
+                kv_init_ctx->dc_start_tick = spdk_get_ticks();
+                if (boot_snapshot_read_hdr(req)) {
+                    kv_init_ctx->state = DSS_KVT_CHECKING_SNAPSHOT;
+                    return;
                 }
-
-                if (mdc_io_idx>0) {
-                    kv_init_ctx->mdc_io_count = mdc_io_idx;
-                    iot_rc = dss_io_task_submit(req->io_task);
-                    DSS_DEBUGLOG(DSS_KVTRANS, "Submit %d mdc I/Os.\n", mdc_io_idx);
+                kv_init_ctx->state = DSS_KVT_LOADING_DC_HT;
+                break;
+            case DSS_KVT_CHECKING_SNAPSHOT:
+                if (boot_snapshot_check_hdr(req)) {
+                    return;
                 }
-
-                if (mdc_io_idx<kv_init_ctx->last_batch && kv_init_ctx->mdc_io_count==0) {
-                    // reach to the last blk && no outstanding IOs
-                    DSS_NOTICELOG("DC table construction finished\n");
-                    if ((*kv_init_ctx->kvt_ctx)->dump_mem_meta) {
-                        dss_kvtrans_dump_in_memory_meta(*kv_init_ctx->kvt_ctx);
-                        DSS_NOTICELOG("In-memory data dumping finished\n");
-                    }
-                    kv_init_ctx->state = DSS_KVT_INITIALIZED;
+                break;
+            case DSS_KVT_RESTORING_SNAPSHOT:
+                boot_snapshot_restore(req);
+                kv_init_ctx->state = DSS_KVT_INVALIDATING_SNAPSHOT;
+                return;
+            case DSS_KVT_INVALIDATING_SNAPSHOT:
+                if (!kv_init_ctx->snapshot_loaded) {
+                    kv_init_ctx->state = DSS_KVT_LOADING_DC_HT;
+                    break;
                 }
+                DSS_NOTICELOG("KV trans [%p] boot: superblock [%.3f] s, BA meta [%.3f] s, "
+                              "DC table [%.3f] s from index snapshot [%lu] of [%lu] entries\n",
+                              kvt_ctx,
+                              boot_ticks_to_sec(kv_init_ctx->ba_start_tick - kv_init_ctx->boot_stat.start_tick),
+                              boot_ticks_to_sec(kv_init_ctx->dc_start_tick - kv_init_ctx->ba_start_tick),
+                              boot_ticks_to_sec(spdk_get_ticks() - kv_init_ctx->dc_start_tick),
+                              kvt_ctx->snapshot_gen,
+                              ((kvtrans_snapshot_hdr_t *) kv_init_ctx->data)->num_dc_entries);
+                if (kvt_ctx->dump_mem_meta) {
+                    dss_kvtrans_dump_in_memory_meta(kvt_ctx);
+                    DSS_NOTICELOG("In-memory data dumping finished\n");
+                }
+                kv_init_ctx->state = DSS_KVT_INITIALIZED;
                 break;
-                
+            case DSS_KVT_LOADING_DC_HT:
+                DSS_NOTICELOG("DC table construction starts\n");
+                // the last range request posts this one back in DSS_KVT_MERGING_DC_HT
+                boot_dc_start_ranges(req);
+                return;
+            case DSS_KVT_MERGING_DC_HT:
+                boot_dc_merge_ranges(req);
+                DSS_NOTICELOG("DC table construction finished\n");
+                if (kvt_ctx->key_filter) {
+                    DSS_NOTICELOG("Key filter loaded with [%zu] keys\n", kvt_ctx->key_filter->num_items);
+                }
+                if ((*kv_init_ctx->kvt_ctx)->dump_mem_meta) {
+                    dss_kvtrans_dump_in_memory_meta(*kv_init_ctx->kvt_ctx);
+                    DSS_NOTICELOG("In-memory data dumping finished\n");
+                }
+                kv_init_ctx->state = DSS_KVT_INITIALIZED;
+                break;
+            case DSS_KVT_SCANNING_DC_RANGE:
+                boot_dc_scan_range(req);
+                return;
+            case DSS_KVT_SAVING_SNAPSHOT:
+                if (snapshot_save_data(req)) {
+                    return;
+                }
+                break;
+            case DSS_KVT_SAVED_SNAPSHOT_DATA:
+                snapshot_save_hdr(req);
+                kv_init_ctx->state = DSS_KVT_SNAPSHOT_SAVED;
+                return;
+            case DSS_KVT_SNAPSHOT_SAVED:
+                snapshot_save_done(req);
+                return;
+
             case DSS_KVT_INITIALIZED:
+                // Keep values out of the cuckoo meta table, the allocator state is final now
+                kvt_rc = dss_kvtrans_cuckoo_reserve_table(*kv_init_ctx->kvt_ctx);
+                DSS_RELEASE_ASSERT(kvt_rc == KVTRANS_STATUS_SUCCESS);
                 dss_module_dec_async_pending_task(req->module_ctx[DSS_MODULE_KVTRANS].module);
                 
                 if (has_no_elm((*kv_init_ctx->kvt_ctx)->dc_cache_tbl)) {
@@ -733,13 +1413,99 @@ void dss_kvtrans_process_internal_io(dss_request_t *req)
     return;
 }
 
+static void dss_kvtrans_run_request(kvtrans_ctx_t *kvt_ctx, dss_request_t *req)
+{
+    kvtrans_req_t *kreq = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt;
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_ERROR;
+
+    DSS_ASSERT(kreq->initialized == true);
+
+    switch(kreq->req.opc) {
+    case KVTRANS_OPC_STORE:
+        rc = kvtrans_store(kvt_ctx, kreq);
+        break;
+    case KVTRANS_OPC_RETRIEVE:
+        rc = kvtrans_retrieve(kvt_ctx, kreq);
+        break;
+    case KVTRANS_OPC_DELETE:
+        rc = kvtrans_delete(kvt_ctx, kreq);
+        break;
+    case KVTRANS_OPC_EXIST:
+        rc = kvtrans_exist(kvt_ctx, kreq);
+        break;
+    default:
+        break;
+    }
+
+    if (rc) {
+        // key not found is handled in dss_kvtrans_net_request_complete function
+        if (!(rc == KVTRANS_STATUS_NOT_FOUND && kreq->state == REQ_CMPL)) {
+            DSS_ERRLOG("kvt_ctx [%p] returns code [%d] for key [%s]\n", kvt_ctx, rc, kreq->req.req_key.key);
+            kreq->state = REQ_CMPL;
+        }
+    }
+
+    if (kreq->state == REQ_CMPL) {
+        DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: meta blks [%zu], collision blks[%zu], meta data collision blks [%zu]\n",
+            kvt_ctx,
+            kvt_ctx->stat.meta, kvt_ctx->stat.mc,
+            kvt_ctx->stat.dc, kvt_ctx->stat.mdc);
+        free_kvtrans_req(kreq);
+        dss_kvtrans_net_request_complete(req, rc);
+    }
+
+    return;
+}
+
+// Hash all pending requests, then run them in entry block order so that
+// entry reads for adjacent blocks of a kvtrans instance are merged
+static void dss_kvtrans_process_batch(dss_kvtrans_thread_ctx_t *thread_ctx)
+{
+    kvtrans_req_t *kreqs[MAX_KVTRANS_BATCH_SIZE];
+    kvtrans_ctx_t *kvt_ctx = NULL;
+    kvtrans_ctx_t *next_ctx;
+    kvtrans_req_t *kreq;
+    uint32_t num_kreqs = thread_ctx->num_pending;
+    uint32_t i;
+
+    if (num_kreqs == 0) {
+        return;
+    }
+
+    DSS_ASSERT(num_kreqs <= MAX_KVTRANS_BATCH_SIZE);
+    for (i = 0; i < num_kreqs; i++) {
+        kreq = &thread_ctx->pending_reqs[i]->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt;
+        kreqs[i] = kreq;
+    }
+    thread_ctx->num_pending = 0;
+
+    dss_kvtrans_hash_entry_blks(kreqs, num_kreqs);
+
+    dss_kvtrans_sort_kreqs(kreqs, num_kreqs);
+
+    for (i = 0; i < num_kreqs; i++) {
+        // kreq can be freed once it completes, so read the context first
+        next_ctx = kreqs[i]->kvtrans_ctx;
+        if (next_ctx != kvt_ctx) {
+            if (kvt_ctx) dss_kvtrans_batch_end(kvt_ctx);
+            kvt_ctx = next_ctx;
+            dss_kvtrans_batch_begin(kvt_ctx);
+        }
+        dss_kvtrans_run_request(kvt_ctx, kreqs[i]->dreq);
+    }
+    if (kvt_ctx) dss_kvtrans_batch_end(kvt_ctx);
+
+    return;
+}
+
 static int dss_kvtrans_request_handler(void *ctx, dss_request_t *req)
 {
     dss_kvtrans_thread_ctx_t *kvt_thread_ctx = (dss_kvtrans_thread_ctx_t *)ctx;
     kvtrans_req_t *kreq = NULL;
+    kvtrans_batch_read_t *batch = NULL;
+    uint32_t i;
 
     kvtrans_ctx_t *kvt_ctx = NULL;
-    dss_kvtrans_status_t rc;
 
     if(dss_unlikely(req->opc == DSS_INTERNAL_IO)) {
 
@@ -768,43 +1534,36 @@ static int dss_kvtrans_request_handler(void *ctx, dss_request_t *req)
     if(kreq->initialized == false) {
         dss_kvtrans_setup_request(req, kvt_ctx);
         init_kvtrans_req(kvt_ctx, &kreq->req, kreq);
+        if (kvt_thread_ctx->batch_size > 1) {
+            // Defer new request to the next batch
+            kvt_thread_ctx->pending_reqs[kvt_thread_ctx->num_pending++] = req;
+            if (kvt_thread_ctx->num_pending == kvt_thread_ctx->batch_size) {
+                dss_kvtrans_process_batch(kvt_thread_ctx);
+            }
+            return DFLY_MODULE_REQUEST_QUEUED;
+        }
     }
 
-    DSS_ASSERT(kreq->initialized == true);
-
-    switch(kreq->req.opc) {
-    case KVTRANS_OPC_STORE:
-        rc = kvtrans_store(kvt_ctx, kreq);
-        break;
-    case KVTRANS_OPC_RETRIEVE:
-        rc = kvtrans_retrieve(kvt_ctx, kreq);
-        break;
-    case KVTRANS_OPC_DELETE:
-        rc = kvtrans_delete(kvt_ctx, kreq);
-        break;
-    case KVTRANS_OPC_EXIST:
-        rc = kvtrans_exist(kvt_ctx, kreq);
-        break;
-    default:
-        break;
-    }
-
-    if (rc) {
-        // key not found is handled in dss_kvtrans_net_request_complete function
-        if (!(rc == KVTRANS_STATUS_NOT_FOUND && kreq->state == REQ_CMPL)) {
-            DSS_ERRLOG("kvt_ctx [%p] returns code [%d] for key [%s]\n", kvt_ctx, rc, kreq->req.req_key.key);
-            kreq->state = REQ_CMPL;
+    if (dss_unlikely(kreq->batch_read != NULL)) {
+        // Merged entry read completed on leader io task
+        batch = kreq->batch_read;
+        kreq->batch_read = NULL;
+        DSS_ASSERT(batch->blk_ctx[0]->kreq == kreq);
+        if (dss_io_task_get_status(kreq->io_tasks) == DSS_IO_TASK_STATUS_SUCCESS) {
+            dss_kvtrans_batch_read_complete(batch);
+        } else {
+            // followers have no io task of their own to report the failure
+            for (i = 1; i < batch->num_blk_ctx; i++) {
+                batch->blk_ctx[i]->kreq->io_failed = true;
+            }
+        }
+        for (i = 1; i < batch->num_blk_ctx; i++) {
+            dss_kvtrans_run_request(kvt_ctx, batch->blk_ctx[i]->kreq->dreq);
         }
+        dss_kvtrans_free_batch_read(batch);
     }
 
-    if (kreq->state == REQ_CMPL) {
-        DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: meta blks [%zu], collision blks[%zu], meta data collision blks [%zu]\n",
-            kvt_ctx,
-            kvt_ctx->stat.meta, kvt_ctx->stat.mc,
-            kvt_ctx->stat.dc, kvt_ctx->stat.mdc);
-        free_kvtrans_req(kreq);
-        dss_kvtrans_net_request_complete(req, rc);
-    }
+    dss_kvtrans_run_request(kvt_ctx, req);
 
     return DFLY_MODULE_REQUEST_QUEUED;
 }
@@ -894,8 +1653,141 @@ int dss_kvtrans_module_subsystem_start(struct dfly_subsystem *subsystem,
     return 0;
 }
 
+static bool dss_kvtrans_snapshot_enabled(kvtrans_ctx_t *kvt_ctx)
+{
+    return kvt_ctx && kvt_ctx->is_ba_meta_sync_enabled &&
+            kvt_ctx->kvtrans_params.snapshot_num_blks > 1;
+}
+
+// Save index snapshots on the kvtrans threads before they are stopped
+static bool dss_kvtrans_save_snapshots(dss_module_t *m, df_module_event_complete_cb cb, void *cb_arg)
+{
+    dss_kvtrans_module_ctx_t *mctx = (dss_kvtrans_module_ctx_t *) m->ctx;
+    dss_kvt_snapshot_stop_ctx_t *stop_ctx;
+    dss_kvtrans_thread_ctx_t *thread_ctx;
+    dss_request_t *req;
+    dss_kvt_init_ctx_t *kv_init_ctx;
+    uint32_t num_saves = 0;
+    uint32_t i;
+
+    if (!g_kvtrans_index_snapshot) {
+        return false;
+    }
+    for (i = 0; i < mctx->num_kvts; i++) {
+        if (dss_kvtrans_snapshot_enabled(mctx->kvt_ctx_arr[i])) {
+            num_saves++;
+        }
+    }
+    if (num_saves == 0) {
+        return false;
+    }
+
+    stop_ctx = (dss_kvt_snapshot_stop_ctx_t *) calloc(1, sizeof(dss_kvt_snapshot_stop_ctx_t));
+    DSS_ASSERT(stop_ctx);
+    stop_ctx->module = m;
+    stop_ctx->cb = cb;
+    stop_ctx->cb_arg = cb_arg;
+    stop_ctx->src_thread = dss_env_get_spdk_thread();
+    stop_ctx->pending = num_saves;
+
+    for (i = 0; i < mctx->num_kvts; i++) {
+        if (!dss_kvtrans_snapshot_enabled(mctx->kvt_ctx_arr[i])) {
+            continue;
+        }
+        thread_ctx = mctx->kvt_thrd_ctx_arr[i % mctx->num_threads];
+        DSS_ASSERT(thread_ctx);
+
+        req = (dss_request_t *) calloc(1, sizeof(dss_request_t));
+        DSS_ASSERT(req);
+        req->opc = DSS_INTERNAL_IO;
+        req->module_ctx[DSS_MODULE_KVTRANS].module = m;
+        req->module_ctx[DSS_MODULE_KVTRANS].module_instance = thread_ctx->module_inst_ctx;
+        req->ss = mctx->dfly_subsys;
+
+        kv_init_ctx = &req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt_init;
+        kv_init_ctx->dev = mctx->kvt_ctx_arr[i]->kvtrans_params.dev;
+        kv_init_ctx->iotm = mctx->kvt_ctx_arr[i]->kvtrans_params.iotm;
+        kv_init_ctx->kvt_ctx = &mctx->kvt_ctx_arr[i];
+        kv_init_ctx->stop_ctx = stop_ctx;
+        kv_init_ctx->state = DSS_KVT_SAVING_SNAPSHOT;
+
+        dss_module_post_to_instance(DSS_MODULE_KVTRANS, thread_ctx->module_inst_ctx, req);
+    }
+
+    return true;
+}
+
 void dss_kvtrans_module_subsystem_stop(struct dfly_subsystem *subsystem, void *arg /*Not used*/, df_module_event_complete_cb cb, void *cb_arg)
 {
+    if (dss_kvtrans_save_snapshots(subsystem->mlist.dss_kv_trans_module, cb, cb_arg)) {
+        // module is stopped once all snapshots are written
+        return;
+    }
     dfly_module_stop(subsystem->mlist.dss_kv_trans_module, cb, cb_arg);
     return;
 }
+
+// Fragmentation stats read handed to the kvtrans thread owning the device
+typedef struct dss_kvt_frag_stats_ctx_s {
+    dss_kvtrans_module_ctx_t *mctx;
+    uint32_t dev_index;
+    dss_kvtrans_frag_stats_cb cb;
+    void *cb_arg;
+} dss_kvt_frag_stats_ctx_t;
+
+// Runs on the kvtrans thread owning the device, the only one updating its allocator
+static void kvtrans_read_ba_frag_stats(void *arg)
+{
+    dss_kvt_frag_stats_ctx_t *fctx = (dss_kvt_frag_stats_ctx_t *) arg;
+    kvtrans_ctx_t *kvt_ctx = fctx->mctx->kvt_ctx_arr[fctx->dev_index];
+    dss_blk_allocator_frag_stats_t stats;
+
+    memset(&stats, 0, sizeof(stats));
+    // Device still loading
+    if (!kvt_ctx || !kvt_ctx->blk_alloc_ctx ||
+            dss_blk_allocator_get_frag_stats(kvt_ctx->blk_alloc_ctx, &stats) != BLK_ALLOCATOR_STATUS_SUCCESS) {
+        fctx->cb(fctx->cb_arg, NULL, NULL);
+    } else {
+        fctx->cb(fctx->cb_arg, kvt_ctx->kvtrans_params.name, &stats);
+    }
+    free(fctx);
+}
+
+int dss_kvtrans_module_get_ba_frag_stats(struct dfly_subsystem *subsystem, uint32_t dev_index,
+                                         dss_kvtrans_frag_stats_cb cb, void *cb_arg)
+{
+    dss_kvtrans_module_ctx_t *mctx;
+    dss_kvtrans_thread_ctx_t *thread_ctx;
+    dss_kvt_frag_stats_ctx_t *fctx;
+
+    if (!subsystem->mlist.dss_kv_trans_module) {
+        return -1;
+    }
+    mctx = (dss_kvtrans_module_ctx_t *)dfly_module_get_ctx(subsystem->mlist.dss_kv_trans_module);
+    if (!mctx || dev_index >= mctx->num_kvts || !mctx->num_threads) {
+        return -1;
+    }
+
+    // Devices are spread over threads as in dss_kvtrans_thread_instance_init
+    thread_ctx = mctx->kvt_thrd_ctx_arr[dev_index % mctx->num_threads];
+    if (!thread_ctx) {
+        return -1;
+    }
+
+    fctx = (dss_kvt_frag_stats_ctx_t *) calloc(1, sizeof(dss_kvt_frag_stats_ctx_t));
+    if (!fctx) {
+        return -1;
+    }
+    fctx->mctx = mctx;
+    fctx->dev_index = dev_index;
+    fctx->cb = cb;
+    fctx->cb_arg = cb_arg;
+
+    if (dss_spdk_thread_send_msg(((dss_module_instance_t *) thread_ctx->module_inst_ctx)->thread,
+                                 (void *) kvtrans_read_ba_frag_stats, fctx)) {
+        free(fctx);
+        return -1;
+    }
+
+    return 0;
+}
@@ -66,6 +66,10 @@ struct dss_kvtrans_thread_ctx_s {
     // kvtrans_params_t *params;
     // now one shard is one device;
     uint32_t shard_index;
+    // new requests waiting to be processed as one batch
+    uint32_t batch_size;
+    uint32_t num_pending;
+    dss_request_t **pending_reqs;
 };
 
 #ifdef __cplusplus
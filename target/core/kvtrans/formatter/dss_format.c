@@ -11,9 +11,15 @@
 
 
 #define DSS_FORMATTER_DEFAULT_BLK_SIZE (0x1000)
-#define DSS_FORMATTER_DEFAULT_NUM_BLK_STATES (6)
+// kvtrans block states excluding EMPTY, up to CUCKOO_FREE. Blocks take 4 bits
+// for up to 16 states, so this does not change the on-disk layout
+#define DSS_FORMATTER_DEFAULT_NUM_BLK_STATES (11)
 #define DSS_FORMATTER_DEFAULT_BLK_ALLOCATOR_TYPE "block_impresario"
 #define DSS_FORMATTER_DEFAULT_DEBUG_OPTION (true)
+// kvtrans meta placement, must match the target's kvtrans_placement config
+#define DSS_FORMATTER_DEFAULT_KVT_PLACEMENT "chain"
+#define DSS_FORMATTER_DEFAULT_KVT_CUCKOO_BUCKET_BLKS (4)
+#define DSS_FORMATTER_MAX_KVT_CUCKOO_BUCKET_BLKS (8)
 
 enum dss_formatter_opts {
     DSS_FORMATTER_OPTION_BLK_SIZE = 0x1000, //Start with a high value so it does not overlap with spdk opts
@@ -21,6 +27,9 @@ enum dss_formatter_opts {
     DSS_FORMATTER_OPTION_BLK_ALLOCATOR_TYPE,
     DSS_FORMATTER_OPTION_NO_VERIFY,
     DSS_FORMATTER_OPTION_DEV_NAME,
+    DSS_FORMATTER_OPTION_KVT_PLACEMENT,
+    DSS_FORMATTER_OPTION_KVT_CUCKOO_BUCKET_BLKS,
+    DSS_FORMATTER_OPTION_KVT_PACKED_META,
 };
 
 static struct option g_cmdline_opts[] = {
@@ -54,6 +63,24 @@ static struct option g_cmdline_opts[] = {
         .flag = NULL,
         .val = DSS_FORMATTER_OPTION_DEV_NAME,
     },
+    {
+        .name = "kvtrans_placement",
+        .has_arg = 1,
+        .flag = NULL,
+        .val = DSS_FORMATTER_OPTION_KVT_PLACEMENT,
+    },
+    {
+        .name = "kvtrans_cuckoo_bucket_blks",
+        .has_arg = 1,
+        .flag = NULL,
+        .val = DSS_FORMATTER_OPTION_KVT_CUCKOO_BUCKET_BLKS,
+    },
+    {
+        .name = "kvtrans_packed_meta",
+        .has_arg = 0,
+        .flag = NULL,
+        .val = DSS_FORMATTER_OPTION_KVT_PACKED_META,
+    },
     {
         .name =""
     }
@@ -68,6 +95,9 @@ static void dss_formatter_set_default_opts(dss_formatter_config_opts_t *opts)
     opts->ba_type = DSS_FORMATTER_DEFAULT_BLK_ALLOCATOR_TYPE;
     opts->debug = DSS_FORMATTER_DEFAULT_DEBUG_OPTION;
     opts->dev_name = NULL;//Device name should be provided by user
+    opts->kvt_placement = DSS_FORMATTER_DEFAULT_KVT_PLACEMENT;
+    opts->kvt_cuckoo_bucket_blks = DSS_FORMATTER_DEFAULT_KVT_CUCKOO_BUCKET_BLKS;
+    opts->kvt_packed_meta = false;
 
     return;
 }
@@ -89,6 +119,22 @@ static bool dss_formatter_validate_config(dss_formatter_config_opts_t *opts)
         rc = false;
     }
 
+    if(strcmp(opts->kvt_placement, "chain") && strcmp(opts->kvt_placement, "cuckoo")) {
+        printf("kvtrans placement must be 'chain' or 'cuckoo'\n");
+        rc = false;
+    }
+
+    if(opts->kvt_cuckoo_bucket_blks == 0 ||
+            opts->kvt_cuckoo_bucket_blks > DSS_FORMATTER_MAX_KVT_CUCKOO_BUCKET_BLKS) {
+        printf("kvtrans cuckoo bucket blocks must be 1 to %d\n", DSS_FORMATTER_MAX_KVT_CUCKOO_BUCKET_BLKS);
+        rc = false;
+    }
+
+    if(opts->kvt_packed_meta && strcmp(opts->kvt_placement, "cuckoo")) {
+        printf("kvtrans packed meta needs cuckoo placement\n");
+        rc = false;
+    }
+
     return rc;
 }
 
@@ -99,6 +145,9 @@ static void usage (void) {
     printf(" --num_block_states <total block states>. Optional, Defaults to %d\n",DSS_FORMATTER_DEFAULT_NUM_BLK_STATES); 
     printf(" --block_allocator_type <type string>. Optional, defaults to '%s'\n", DSS_FORMATTER_DEFAULT_BLK_ALLOCATOR_TYPE);
     printf(" --no_verify. Optional, verifies formatted info on disk by default\n");
+    printf(" --kvtrans_placement <chain|cuckoo>. Optional, defaults to '%s'. Must match the target config\n", DSS_FORMATTER_DEFAULT_KVT_PLACEMENT);
+    printf(" --kvtrans_cuckoo_bucket_blks <blocks>. Optional, defaults to %d. Used with cuckoo placement\n", DSS_FORMATTER_DEFAULT_KVT_CUCKOO_BUCKET_BLKS);
+    printf(" --kvtrans_packed_meta. Optional, packs small keys in shared meta blocks. Needs cuckoo placement\n");
 
     return;
 }
@@ -135,6 +184,21 @@ static int dss_formatter_parse_args(int ch, char *optarg)
         case DSS_FORMATTER_OPTION_DEV_NAME:
             g_dss_formatter_opts.dev_name = strdup(optarg);
             break;
+        case DSS_FORMATTER_OPTION_KVT_PLACEMENT:
+            g_dss_formatter_opts.kvt_placement = strdup(optarg);
+            break;
+        case DSS_FORMATTER_OPTION_KVT_CUCKOO_BUCKET_BLKS:
+            tmp_option = spdk_strtol(optarg, 10);
+            if(tmp_option < 0) {
+                printf("Invalid kvtrans cuckoo bucket blocks provided\n");
+                usage();
+                return 1;
+            }
+            g_dss_formatter_opts.kvt_cuckoo_bucket_blks = tmp_option;
+            break;
+        case DSS_FORMATTER_OPTION_KVT_PACKED_META:
+            g_dss_formatter_opts.kvt_packed_meta = true;
+            break;
         default:
             usage();
             return 1;
@@ -192,6 +256,11 @@ main(int argc, char **argv)
     printf("\tBlock size         : %d\n", g_dss_formatter_opts.blk_size);
     printf("\tTotal block states : %d\n", g_dss_formatter_opts.nblk_states);
     printf("\tAllocator type     : %s\n", g_dss_formatter_opts.ba_type);
+    printf("\tKV meta placement  : %s\n", g_dss_formatter_opts.kvt_placement);
+    if(!strcmp(g_dss_formatter_opts.kvt_placement, "cuckoo")) {
+        printf("\tCuckoo bucket blks : %d\n", g_dss_formatter_opts.kvt_cuckoo_bucket_blks);
+        printf("\tPacked meta        : %s\n", g_dss_formatter_opts.kvt_packed_meta ? "yes" : "no");
+    }
     printf("==============================================================\n");
 
     snprintf(rpc_sock_fname, 255, "/var/tmp/dss_formatter.%s.sock", g_dss_formatter_opts.dev_name);
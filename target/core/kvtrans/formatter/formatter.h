@@ -92,7 +92,10 @@ public:
         bdev_total_num_logical_blocks_(0),
         bdev_total_num_physical_blocks_(0),
         block_allocator_meta_physical_num_blocks_(0),
-        block_allocator_meta_logical_num_blocks_(0)
+        block_allocator_meta_logical_num_blocks_(0),
+        kvt_meta_placement_(DSS_KVT_META_PLACEMENT_CHAIN),
+        kvt_cuckoo_bucket_blks_(0),
+        kvt_packed_meta_(0)
     {}
     virtual ~Formatter() = default;
     static void format_bdev_open_cb(
@@ -155,6 +158,17 @@ private:
     uint64_t bdev_total_num_physical_blocks_;
     uint64_t block_allocator_meta_physical_num_blocks_;
     uint64_t block_allocator_meta_logical_num_blocks_;
+    uint64_t bdev_kvt_snapshot_physical_start_block_; // kvtrans index
+    uint64_t bdev_kvt_snapshot_logical_start_block_;  // snapshot region
+    uint64_t bdev_kvt_snapshot_physical_end_block_;
+    uint64_t bdev_kvt_snapshot_logical_end_block_;
+    uint64_t bdev_ba_journal_physical_start_block_; // block allocator
+    uint64_t bdev_ba_journal_logical_start_block_;  // journal region
+    uint64_t bdev_ba_journal_physical_end_block_;
+    uint64_t bdev_ba_journal_logical_end_block_;
+    uint8_t kvt_meta_placement_; // kvtrans meta layout
+    uint8_t kvt_cuckoo_bucket_blks_;
+    uint8_t kvt_packed_meta_;
 };
 
 using FormatterSharedPtr = std::shared_ptr<Formatter>;
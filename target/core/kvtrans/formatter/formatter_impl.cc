@@ -76,6 +76,18 @@ bool Formatter::open_device(Parser::ParsedPayloadSharedPtr& payload) {
     uint64_t sblock_size_in_bytes = 0;
     dss_blk_allocator_opts_t *ba_config = nullptr;
 
+    // kvtrans meta layout is fixed at format time, bucket size and
+    // packed meta only apply to cuckoo placement
+    if (payload->kvt_placement.compare("cuckoo") == 0) {
+        this->kvt_meta_placement_ = DSS_KVT_META_PLACEMENT_CUCKOO;
+        this->kvt_cuckoo_bucket_blks_ = payload->kvt_cuckoo_bucket_blks;
+        this->kvt_packed_meta_ = payload->kvt_packed_meta;
+    } else if (payload->kvt_placement.compare("chain") != 0) {
+        std::cout<<"Unknown kvtrans placement "
+            <<payload->kvt_placement<<std::endl;
+        return false;
+    }
+
     // Procure device from name
     Formatter::bdev = spdk_bdev_get_by_name(payload->device_name.c_str());
     if (Formatter::bdev == nullptr) {
@@ -201,13 +213,37 @@ bool Formatter::open_device(Parser::ParsedPayloadSharedPtr& payload) {
         (this->bdev_block_alloc_meta_logical_start_block_ +
             this->block_allocator_meta_logical_num_blocks_) - 1;
     
+    // kvtrans index snapshot region follows block allocator meta-data
+    this->bdev_kvt_snapshot_physical_start_block_ =
+        this->bdev_block_alloc_meta_physical_end_block_ + 1;
+    this->bdev_kvt_snapshot_logical_start_block_ =
+        this->bdev_block_alloc_meta_logical_end_block_ + 1;
+    this->bdev_kvt_snapshot_physical_end_block_ =
+        (this->bdev_kvt_snapshot_physical_start_block_ +
+            DSS_KVT_SNAPSHOT_SIZE_BYTES / this->bdev_physical_block_size_) - 1;
+    this->bdev_kvt_snapshot_logical_end_block_ =
+        (this->bdev_kvt_snapshot_logical_start_block_ +
+            DSS_KVT_SNAPSHOT_SIZE_BYTES / this->bdev_logical_block_size_) - 1;
+
+    // block allocator journal region follows the index snapshot
+    this->bdev_ba_journal_physical_start_block_ =
+        this->bdev_kvt_snapshot_physical_end_block_ + 1;
+    this->bdev_ba_journal_logical_start_block_ =
+        this->bdev_kvt_snapshot_logical_end_block_ + 1;
+    this->bdev_ba_journal_physical_end_block_ =
+        (this->bdev_ba_journal_physical_start_block_ +
+            DSS_BA_JOURNAL_SIZE_BYTES / this->bdev_physical_block_size_) - 1;
+    this->bdev_ba_journal_logical_end_block_ =
+        (this->bdev_ba_journal_logical_start_block_ +
+            DSS_BA_JOURNAL_SIZE_BYTES / this->bdev_logical_block_size_) - 1;
+
     // bdev_user_physical_start_block_ is deduced from the following formula
     this->bdev_user_physical_start_block_ =
-        this->bdev_block_alloc_meta_physical_end_block_ + 1;
+        this->bdev_ba_journal_physical_end_block_ + 1;
 
     // bdev_user_logical_start_block_ is deduced from the following formula
     this->bdev_user_logical_start_block_ =
-        this->bdev_block_alloc_meta_logical_end_block_ + 1;
+        this->bdev_ba_journal_logical_end_block_ + 1;
 
     // bdev_user_physical_end_block_ is deduced from the following formula
     this->bdev_user_physical_end_block_ =
@@ -273,6 +309,36 @@ void Formatter::format_bdev_read_super_complete_cb(
         assert(read_sb->is_blk_alloc_meta_load_needed ==
                 Formatter::written_super_block->
                     is_blk_alloc_meta_load_needed);
+        std::cout<<"super_block->logi_kvt_snapshot_start_blk = "
+            <<read_sb->logi_kvt_snapshot_start_blk<<std::endl;
+        assert(read_sb->logi_kvt_snapshot_start_blk ==
+                Formatter::written_super_block->logi_kvt_snapshot_start_blk);
+        std::cout<<"super_block->logi_kvt_snapshot_end_blk = "
+            <<read_sb->logi_kvt_snapshot_end_blk<<std::endl;
+        assert(read_sb->logi_kvt_snapshot_end_blk ==
+                Formatter::written_super_block->logi_kvt_snapshot_end_blk);
+        std::cout<<"super_block->logi_blk_alloc_journal_start_blk = "
+            <<read_sb->logi_blk_alloc_journal_start_blk<<std::endl;
+        assert(read_sb->logi_blk_alloc_journal_start_blk ==
+                Formatter::written_super_block->
+                    logi_blk_alloc_journal_start_blk);
+        std::cout<<"super_block->logi_blk_alloc_journal_end_blk = "
+            <<read_sb->logi_blk_alloc_journal_end_blk<<std::endl;
+        assert(read_sb->logi_blk_alloc_journal_end_blk ==
+                Formatter::written_super_block->
+                    logi_blk_alloc_journal_end_blk);
+        std::cout<<"super_block->kvt_meta_placement = "
+            <<(uint32_t)read_sb->kvt_meta_placement<<std::endl;
+        assert(read_sb->kvt_meta_placement ==
+                Formatter::written_super_block->kvt_meta_placement);
+        std::cout<<"super_block->kvt_cuckoo_bucket_blks = "
+            <<(uint32_t)read_sb->kvt_cuckoo_bucket_blks<<std::endl;
+        assert(read_sb->kvt_cuckoo_bucket_blks ==
+                Formatter::written_super_block->kvt_cuckoo_bucket_blks);
+        std::cout<<"super_block->kvt_packed_meta = "
+            <<(uint32_t)read_sb->kvt_packed_meta<<std::endl;
+        assert(read_sb->kvt_packed_meta ==
+                Formatter::written_super_block->kvt_packed_meta);
     }
 
     // Free all the super block memory allocated
@@ -432,6 +498,17 @@ bool Formatter::format_device(bool is_debug) {
     super_block->is_blk_alloc_meta_load_needed = 0;
     super_block->logi_super_blk_start_addr =
         this->bdev_super_block_logical_start_block_;
+    super_block->logi_kvt_snapshot_start_blk =
+        this->bdev_kvt_snapshot_logical_start_block_;
+    super_block->logi_kvt_snapshot_end_blk =
+        this->bdev_kvt_snapshot_logical_end_block_;
+    super_block->logi_blk_alloc_journal_start_blk =
+        this->bdev_ba_journal_logical_start_block_;
+    super_block->logi_blk_alloc_journal_end_blk =
+        this->bdev_ba_journal_logical_end_block_;
+    super_block->kvt_meta_placement = this->kvt_meta_placement_;
+    super_block->kvt_cuckoo_bucket_blks = this->kvt_cuckoo_bucket_blks_;
+    super_block->kvt_packed_meta = this->kvt_packed_meta_;
 
     num_blocks = sizeof(dss_super_block_t)/this->bdev_physical_block_size_;
     Formatter::total_super_write_blocks = num_blocks;
@@ -477,6 +554,40 @@ bool Formatter::format_device(bool is_debug) {
         // return false;
     }
 
+    // Mark an in-flight request and trigger operation to bdev
+    // Clear kvtrans index snapshot so that a stale one is never loaded
+    Formatter::format_bdev_write_rq_count++;
+    rc = spdk_bdev_write_zeroes_blocks(
+            Formatter::desc,
+            Formatter::channel,
+            this->bdev_kvt_snapshot_physical_start_block_,
+            this->bdev_kvt_snapshot_physical_end_block_ -
+                this->bdev_kvt_snapshot_physical_start_block_ + 1,
+            Formatter::format_bdev_write_complete_cb,
+            nullptr);
+
+    if (rc !=0) {
+        assert(("ERROR", false));
+        // return false;
+    }
+
+    // Mark an in-flight request and trigger operation to bdev
+    // Clear block allocator journal so that no stale record is replayed
+    Formatter::format_bdev_write_rq_count++;
+    rc = spdk_bdev_write_zeroes_blocks(
+            Formatter::desc,
+            Formatter::channel,
+            this->bdev_ba_journal_physical_start_block_,
+            this->bdev_ba_journal_physical_end_block_ -
+                this->bdev_ba_journal_physical_start_block_ + 1,
+            Formatter::format_bdev_write_complete_cb,
+            nullptr);
+
+    if (rc !=0) {
+        assert(("ERROR", false));
+        // return false;
+    }
+
     // Format complete
     return true;
 }
@@ -44,6 +44,9 @@ typedef struct dss_formatter_config_opts_s {
     char *ba_type;
     bool debug;
     char *dev_name;
+    char *kvt_placement;
+    uint32_t kvt_cuckoo_bucket_blks;
+    bool kvt_packed_meta;
 } dss_formatter_config_opts_t;
 
 typedef struct formatter_conf_s {
@@ -29,6 +29,9 @@ void formatter_run_cmdline(dss_formatter_config_opts_t *opts)
     payload->is_debug = opts->debug;
     payload->logical_block_size = opts->blk_size;
     payload->num_block_states = opts->nblk_states;
+    payload->kvt_placement = opts->kvt_placement;
+    payload->kvt_cuckoo_bucket_blks = opts->kvt_cuckoo_bucket_blks;
+    payload->kvt_packed_meta = opts->kvt_packed_meta;
     payload->status = true;
 
     dss_do_format(payload);
@@ -55,6 +55,9 @@ public:
           num_block_states(0),
           block_allocator_type(),
           is_debug(true),
+          kvt_placement("chain"),
+          kvt_cuckoo_bucket_blks(0),
+          kvt_packed_meta(false),
           status(false)
     {}
     std::string device_name;
@@ -62,6 +65,9 @@ public:
     uint64_t num_block_states;
     std::string block_allocator_type;
     bool is_debug;
+    std::string kvt_placement;
+    uint32_t kvt_cuckoo_bucket_blks;
+    bool kvt_packed_meta;
     bool status;
 };
 
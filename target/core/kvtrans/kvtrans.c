@@ -131,8 +131,139 @@ void set_kvtrans_disk_meta_store(bool val) {
 }
 #endif
 
+uint32_t g_kvtrans_batch_size = DEFAULT_KVTRANS_BATCH_SIZE;
+
+void set_kvtrans_batch_size(uint32_t val) {
+    if (val == 0) {
+        val = 1;
+    } else if (val > MAX_KVTRANS_BATCH_SIZE) {
+        DSS_NOTICELOG("kvtrans batch size %u capped to %u\n", val, MAX_KVTRANS_BATCH_SIZE);
+        val = MAX_KVTRANS_BATCH_SIZE;
+    }
+    g_kvtrans_batch_size = val;
+}
+
+uint32_t g_kvtrans_meta_cache_blks = DEFAULT_KVTRANS_META_CACHE_BLKS;
+
+void set_kvtrans_meta_cache_blks(uint32_t val) {
+    g_kvtrans_meta_cache_blks = val;
+}
+
+uint64_t g_kvtrans_key_filter_keys = DEFAULT_KVTRANS_KEY_FILTER_KEYS;
+
+void set_kvtrans_key_filter_keys(uint64_t val) {
+    g_kvtrans_key_filter_keys = val;
+}
+
+uint32_t g_kvtrans_placement = DEFAULT_KVTRANS_PLACEMENT;
+
+void set_kvtrans_placement(uint32_t val) {
+    if (val > KVTRANS_PLACEMENT_CUCKOO) {
+        DSS_NOTICELOG("Unknown kvtrans placement %u, using chained placement\n", val);
+        val = KVTRANS_PLACEMENT_CHAIN;
+    }
+    g_kvtrans_placement = val;
+}
+
+uint32_t g_kvtrans_cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+
+void set_kvtrans_cuckoo_bucket_blks(uint32_t val) {
+    if (val == 0) {
+        val = 1;
+    } else if (val > KVTRANS_CUCKOO_MAX_BUCKET_BLKS) {
+        DSS_NOTICELOG("kvtrans cuckoo bucket blks %u capped to %u\n", val, KVTRANS_CUCKOO_MAX_BUCKET_BLKS);
+        val = KVTRANS_CUCKOO_MAX_BUCKET_BLKS;
+    }
+    g_kvtrans_cuckoo_bucket_blks = val;
+}
+
+bool g_kvtrans_packed_meta = DEFAULT_KVTRANS_PACKED_META;
+
+void set_kvtrans_packed_meta(bool val) {
+    g_kvtrans_packed_meta = val;
+}
+
+uint32_t g_kvtrans_boot_ranges = DEFAULT_KVTRANS_BOOT_RANGES;
+
+void set_kvtrans_boot_ranges(uint32_t val) {
+    if (val == 0) {
+        val = 1;
+    } else if (val > MAX_KVTRANS_BOOT_RANGES) {
+        DSS_NOTICELOG("kvtrans boot ranges %u capped to %u\n", val, MAX_KVTRANS_BOOT_RANGES);
+        val = MAX_KVTRANS_BOOT_RANGES;
+    }
+    g_kvtrans_boot_ranges = val;
+}
+
+bool g_kvtrans_index_snapshot = DEFAULT_KVTRANS_INDEX_SNAPSHOT;
+
+void set_kvtrans_index_snapshot(bool val) {
+    g_kvtrans_index_snapshot = val;
+}
+
+uint32_t g_kvtrans_ba_alloc_groups = DEFAULT_KVTRANS_BA_ALLOC_GROUPS;
+
+void set_kvtrans_ba_alloc_groups(uint32_t val) {
+    if (val == 0) {
+        val = 1;
+    } else if (val > MAX_KVTRANS_BA_ALLOC_GROUPS) {
+        DSS_NOTICELOG("kvtrans ba alloc groups %u capped to %u\n", val, MAX_KVTRANS_BA_ALLOC_GROUPS);
+        val = MAX_KVTRANS_BA_ALLOC_GROUPS;
+    }
+    g_kvtrans_ba_alloc_groups = val;
+}
+
+bool g_kvtrans_ba_journal = DEFAULT_KVTRANS_BA_JOURNAL;
+
+void set_kvtrans_ba_journal(bool val) {
+    g_kvtrans_ba_journal = val;
+}
+
+bool g_kvtrans_ba_extent_tree = DEFAULT_KVTRANS_BA_EXTENT_TREE;
+
+void set_kvtrans_ba_extent_tree(bool val) {
+    g_kvtrans_ba_extent_tree = val;
+}
+
+uint32_t g_kvtrans_ba_size_class_region_blocks = DEFAULT_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS;
+
+void set_kvtrans_ba_size_class_region_blocks(uint32_t val) {
+    if (val != 0 && val < MIN_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS) {
+        DSS_NOTICELOG("kvtrans ba size class region blocks %u raised to %u\n", val, MIN_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS);
+        val = MIN_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS;
+    }
+    g_kvtrans_ba_size_class_region_blocks = val;
+}
+
+uint32_t g_kvtrans_ba_meta_sync_group_reqs = DEFAULT_KVTRANS_BA_META_SYNC_GROUP_REQS;
+
+void set_kvtrans_ba_meta_sync_group_reqs(uint32_t val) {
+    if (val == 0) {
+        val = 1;
+    } else if (val > MAX_KVTRANS_BA_META_SYNC_GROUP_REQS) {
+        DSS_NOTICELOG("kvtrans ba meta sync group reqs %u capped to %u\n", val, MAX_KVTRANS_BA_META_SYNC_GROUP_REQS);
+        val = MAX_KVTRANS_BA_META_SYNC_GROUP_REQS;
+    }
+    g_kvtrans_ba_meta_sync_group_reqs = val;
+}
+
+uint32_t g_kvtrans_ba_meta_sync_group_window_us = DEFAULT_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US;
+
+void set_kvtrans_ba_meta_sync_group_window_us(uint32_t val) {
+    if (val > MAX_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US) {
+        DSS_NOTICELOG("kvtrans ba meta sync group window %u us capped to %u\n", val, MAX_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US);
+        val = MAX_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US;
+    }
+    g_kvtrans_ba_meta_sync_group_window_us = val;
+}
+
+#ifndef DSS_BUILD_CUNIT_TEST
+// id to tell meta cache stats of kvtrans instances apart
+static int g_kvtrans_meta_cache_stat_id = 0;
+#endif
+
 // TODO: use macro to convert states to strings
-const char *stateNames[] = { "Empty", "Meta", "Data", "Collision", "DC", "MDC", "MDC_Entry", "CE", "DC_Empty", "DC_CE"};
+const char *stateNames[] = { "Empty", "Meta", "Data", "Collision", "DC", "MDC", "MDC_Entry", "CE", "DC_Empty", "DC_CE", "Packed", "Cuckoo_Free"};
 
 // util functions to get time ticks.
 // tmp use for benchmarking kvtrans 
@@ -157,8 +288,21 @@ dss_kvtrans_alloc_contig(kvtrans_ctx_t *ctx,
                         uint64_t *allocated_start_block)
 {
     dss_blk_allocator_status_t rc;
-    rc = dss_blk_allocator_alloc_blocks_contig(ctx->blk_alloc_ctx, state, 
-                hint_block_index, num_blocks, allocated_start_block);
+    uint64_t blk_state = EMPTY;
+
+    if (ctx->cuckoo && num_blocks == 1 && kvtrans_cuckoo_has_blk(ctx->cuckoo, hint_block_index)) {
+        rc = dss_blk_allocator_get_block_state(ctx->blk_alloc_ctx, hint_block_index, &blk_state);
+        if (rc) return KVTRANS_STATUS_ERROR;
+    }
+
+    if (blk_state == CUCKOO_FREE) {
+        // reserved blk of the cuckoo meta table
+        rc = dss_blk_allocator_set_blocks_state(ctx->blk_alloc_ctx, hint_block_index, 1, state);
+        *allocated_start_block = hint_block_index;
+    } else {
+        rc = dss_blk_allocator_alloc_blocks_contig(ctx->blk_alloc_ctx, state, 
+                    hint_block_index, num_blocks, allocated_start_block);
+    }
     if (rc) {
         if (num_blocks == 1) {
             DSS_ERRLOG("Alloc contig [%d] blks for blk_ctx [%zu] failed\n",
@@ -184,6 +328,7 @@ dss_kvtrans_set_blk_state(kvtrans_ctx_t *ctx, blk_ctx_t *blk_ctx, uint64_t index
 {
     dss_blk_allocator_status_t rc;
     uint64_t idx_state, blk_state;
+    uint64_t offset = 0;
     
     blk_state = DEFAULT_BLOCK_STATE_NUM;
 
@@ -198,7 +343,17 @@ dss_kvtrans_set_blk_state(kvtrans_ctx_t *ctx, blk_ctx_t *blk_ctx, uint64_t index
 
     DSS_NOTICELOG("Set state for [ %zu ] block at [ %zu ] from [ %s ] to [ %s ]\n", blk_num, index, stateNames[blk_state], stateNames[state] );
 
-    if (state==EMPTY) {   
+    if (state==EMPTY && ctx->cuckoo) {
+        // blks of the cuckoo meta table go back to the table
+        rc = BLK_ALLOCATOR_STATUS_SUCCESS;
+        while (offset < blk_num && kvtrans_cuckoo_has_blk(ctx->cuckoo, index + offset) && !rc) {
+            rc = dss_blk_allocator_set_blocks_state(ctx->blk_alloc_ctx, index + offset, 1, CUCKOO_FREE);
+            offset++;
+        }
+        if (!rc && offset < blk_num) {
+            rc = dss_blk_allocator_clear_blocks(ctx->blk_alloc_ctx, index + offset, blk_num - offset);
+        }
+    } else if (state==EMPTY) {   
         rc = dss_blk_allocator_clear_blocks(ctx->blk_alloc_ctx, index, blk_num);
     } else {
         DSS_ASSERT(blk_num==1);
@@ -255,6 +410,8 @@ dss_kvtrans_get_blk_state(kvtrans_ctx_t *ctx, blk_ctx_t *blk_ctx)
         DSS_ERRLOG("Fail to get blk [%d] state\n", blk_ctx->index);
         return KVTRANS_STATUS_ERROR;
     }
+    // a reserved blk of the cuckoo meta table is free for meta
+    if (blk_state == CUCKOO_FREE) blk_state = EMPTY;
     blk_ctx->state = (blk_state_t) blk_state;
     return KVTRANS_STATUS_SUCCESS;
 }
@@ -277,7 +434,7 @@ dss_kvtrans_check_all_empty(kvtrans_ctx_t *ctx)
             DSS_ERRLOG("Fail to get blk [%zu] state\n", i);
             DSS_ASSERT(0);
         }
-        if (blk_state != EMPTY && !printed) {
+        if (blk_state != EMPTY && blk_state != CUCKOO_FREE && !printed) {
             DSS_ERRLOG("index [%zu] is [%s]\n", i, stateNames[blk_state]);
             printed = 1;
         }
@@ -660,6 +817,90 @@ _pop_meta_blk_from_queue(kvtrans_meta_sync_ctx_t *meta_sync_ctx, blk_ctx_t *in_f
 #endif
 
 
+#ifndef DSS_BUILD_CUNIT_TEST
+// Defer the entry blk read of a new request while a batch is in progress.
+// Blocks locked by an in-flight request take the meta sync queue path instead.
+static bool
+_stage_entry_blk_read(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq)
+{
+    kvtrans_ctx_t *ctx = kreq->kvtrans_ctx;
+    kvtrans_meta_sync_ctx_t *meta_sync_ctx = ctx->meta_sync_ctx;
+
+    if (!ctx->batch_in_progress || kreq->state != REQ_INITIALIZED) {
+        return false;
+    }
+
+    if (ctx->num_staged_blks == ctx->batch_size) {
+        return false;
+    }
+
+    if (_is_lba_dirty(meta_sync_ctx, blk_ctx->index)) {
+        return false;
+    }
+
+    if (_modify_meta(kreq)) {
+        if (_set_lba_dirty(meta_sync_ctx, blk_ctx->index)) {
+            return false;
+        }
+    }
+
+    ctx->staged_blks[ctx->num_staged_blks++] = blk_ctx;
+    return true;
+}
+
+// Serve a meta blk read from the meta cache. The request still completes
+// through its io task so callers see the same flow as for a disk read.
+// On a miss, remember the blk to cache it once the disk read completes.
+static bool
+_load_cached_meta_blk(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq)
+{
+    kvtrans_ctx_t *ctx = kreq->kvtrans_ctx;
+    kvtrans_meta_cache_t *cache = ctx->meta_cache;
+    dss_kvtrans_status_t rc;
+    dss_io_task_status_t iot_rc;
+    bool hit;
+
+    // queued ops need a real submit, and a dirty blk is owned by an in-flight request
+    if (kreq->io_to_queue || _is_lba_dirty(ctx->meta_sync_ctx, blk_ctx->index)) {
+        return false;
+    }
+
+    hit = kvtrans_meta_cache_lookup(cache, blk_ctx->index, blk_ctx->blk);
+    ctx->meta_cache_stat_dirty = true;
+    if (!hit) {
+        DSS_ASSERT(kreq->meta_fill_blk == NULL);
+        kreq->meta_fill_blk = blk_ctx;
+        kreq->meta_fill_seq = kvtrans_meta_cache_get_seq(cache, blk_ctx->index);
+        return false;
+    }
+
+    if (_modify_meta(kreq)) {
+        rc = _set_lba_dirty(ctx->meta_sync_ctx, blk_ctx->index);
+        DSS_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: meta cache hit for lba[%u] key [%s]\n", ctx, blk_ctx->index, kreq->req.req_key.key);
+    iot_rc = dss_io_task_post_completion(kreq->io_tasks);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    return true;
+}
+
+// Add the blk loaded from disk to the meta cache unless it was
+// overwritten while the read was in flight
+static void
+_fill_meta_cache(kvtrans_req_t *kreq)
+{
+    kvtrans_ctx_t *ctx = kreq->kvtrans_ctx;
+    blk_ctx_t *blk_ctx = kreq->meta_fill_blk;
+
+    if (!blk_ctx) return;
+    kreq->meta_fill_blk = NULL;
+
+    kvtrans_meta_cache_fill(ctx->meta_cache, blk_ctx->index, blk_ctx->blk, kreq->meta_fill_seq);
+    ctx->meta_cache_stat_dirty = true;
+}
+#endif
+
 // Loads meta block from drive to memory
 dss_kvtrans_status_t
 dss_kvtrans_queue_load_ondisk_blk(blk_ctx_t *blk_ctx,
@@ -686,11 +927,22 @@ dss_kvtrans_load_ondisk_blk(blk_ctx_t *blk_ctx,
                             bool submit_for_disk_io) {
     DSS_ASSERT(blk_ctx->index!=0);
     dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+    kreq->kvtrans_ctx->stat.meta_read++;
+    kreq->kvtrans_ctx->stat.meta_read_blks++;
 #ifdef MEM_BACKEND
 
 #ifndef DSS_BUILD_CUNIT_TEST
     if (g_disk_as_meta_store == true) {
         dss_io_task_status_t iot_rc;
+        if (submit_for_disk_io && kreq->kvtrans_ctx->meta_cache &&
+                _load_cached_meta_blk(blk_ctx, kreq)) {
+            // completion is posted to the io task without disk io
+            return KVTRANS_IO_SUBMITTED;
+        }
+        if (submit_for_disk_io && _stage_entry_blk_read(blk_ctx, kreq)) {
+            // read is merged and submitted at dss_kvtrans_batch_end
+            return KVTRANS_IO_SUBMITTED;
+        }
         rc = dss_kvtrans_queue_load_ondisk_blk(blk_ctx, kreq);
         if (submit_for_disk_io) {
             kreq->io_to_queue = false;
@@ -835,6 +1087,11 @@ dss_kvtrans_queue_write_ondisk_blk(blk_ctx_t *blk_ctx,
     if(!_is_lba_dirty(kreq->kvtrans_ctx->meta_sync_ctx, blk_ctx->index)) {
         _set_lba_dirty(kreq->kvtrans_ctx->meta_sync_ctx, blk_ctx->index);
     }
+    if (kvtrans_ctx->meta_cache) {
+        // cached again with the new content when the request completes
+        kvtrans_meta_cache_invalidate(kvtrans_ctx->meta_cache, blk_ctx->index);
+        blk_ctx->meta_written = true;
+    }
 #endif
     return KVTRANS_IO_QUEUED;
 }
@@ -888,6 +1145,9 @@ dss_kvtrans_delete_ondisk_blk(blk_ctx_t *blk_ctx,
 #ifdef MEM_BACKEND
 #ifndef  DSS_BUILD_CUNIT_TEST
     if (g_disk_as_meta_store) {
+        if (kreq->kvtrans_ctx->meta_cache) {
+            kvtrans_meta_cache_invalidate(kreq->kvtrans_ctx->meta_cache, blk_ctx->index);
+        }
         return KVTRANS_STATUS_SUCCESS;
     } else {
         delete_meta(kreq->kvtrans_ctx->meta_ctx, 
@@ -904,19 +1164,11 @@ dss_kvtrans_delete_ondisk_blk(blk_ctx_t *blk_ctx,
 #endif
 }
 
-// put meta and data in one buffer
-void *_serialize_data(void *buf1, int len1, void *buf2, int len2) {
-    // TODO: use scatter gather list
-    void * buff;
-    buff = malloc(len1+len2);
-    memcpy(buff, buf1, len1);
-    memcpy(buff+len1, buf2, len2);
-    return buff;
-}
-
-dss_kvtrans_status_t
-dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
+// Write value extents starting from place_value[first_entry]
+static dss_kvtrans_status_t
+_dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
                             kvtrans_req_t *kreq,
+                            int first_entry,
                             bool submit_for_disk_io) 
 {
     dss_kvtrans_status_t rc;
@@ -931,7 +1183,10 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
 
 #ifdef MEM_BACKEND
     if (blk->value_location!=INLINE) {
-        for (i=0; i<blk->num_valid_place_value_entry; i++) {
+        for (i=0; i<first_entry; i++) {
+            offset += blk->place_value[i].num_chunks * kreq->kvtrans_ctx->blk_size;
+        }
+        for (i=first_entry; i<blk->num_valid_place_value_entry; i++) {
 #ifndef DSS_BUILD_CUNIT_TEST
             if (g_disk_as_data_store == true) {
                 DSS_DEBUGLOG(DSS_KVTRANS, "Key [%s] LBA [%x] nBlks [%x] value [%p] offset [%x] blk_sz [%d] io_index [%d]\n", \
@@ -945,6 +1200,12 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
                                         &io_opts);
                 DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
                 kreq->io_to_queue = true;
+                if (kreq->kvtrans_ctx->meta_cache) {
+                    // value blks may reuse freed meta blks
+                    kvtrans_meta_cache_invalidate_range(kreq->kvtrans_ctx->meta_cache,
+                                                        blk->place_value[i].value_index,
+                                                        blk->place_value[i].num_chunks);
+                }
             } else
 #endif
                 if (!insert_data(kreq->kvtrans_ctx->data_ctx, 
@@ -980,7 +1241,7 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
 #else
     kvtrans_ctx_t *kvtrans_ctx = kreq->kvtrans_ctx;
 
-    void *buff;
+    dss_iov_t *iov;
     dss_device_t *target_dev = kvtrans_ctx->target_dev;
 
 
@@ -991,9 +1252,12 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
         dss_kvtrans_write_ondisk_blk(blk_ctx, kreq);
         break;
     case CONTIG:
-        buff = _serialize_data((void *)blk_ctx->blk, BLOCK_SIZE, req->req_value.value, (int)req->req_value.length);
-        dss_io_task_add_blk_write(kreq->io_tasks, target_dev, blk_ctx->index,
-            1+blk_ctx->vctx.value_blocks, buff, BLOCK_SIZE+kreq->req->req_value.length, 0, false);
+        iov = dss_io_iov_get(kvtrans_ctx->kvt_iotm);
+        DSS_ASSERT(iov);
+        dss_io_iov_add(iov, (void *)blk_ctx->blk, BLOCK_SIZE, 0);
+        dss_io_iov_add(iov, req->req_value.value, blk_ctx->vctx.value_blocks * BLOCK_SIZE, 0);
+        dss_io_task_add_blk_writev(kreq->io_tasks, target_dev, blk_ctx->index,
+            1+blk_ctx->vctx.value_blocks, iov, &io_opts);
         break;
     case REMOTE:
         dss_io_task_add_blk_write(kreq->io_tasks, target_dev, blk_ctx->index, 1, (void *)blk, BLOCK_SIZE, 0, false);
@@ -1001,8 +1265,11 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
             blk_ctx->vctx.value_blocks, req->req_value.value, kreq->req->req_value.length, 0, false);
         break;
     case HYBIRD:
-        buff = _serialize_data((void *)blk_ctx->blk, BLOCK_SIZE, req->req_value.value, blk_ctx->blk->place_value[0].num_chunks * BLOCK_SIZE);
-        dss_io_task_add_blk_write(kreq->io_tasks, target_dev, blk_ctx->index, 1+blk_ctx->blk->place_value[0].num_chunks, buff, (blk_ctx->blk->place_value[0].num_chunks+1)*BLOCK_SIZE, 0, false);
+        iov = dss_io_iov_get(kvtrans_ctx->kvt_iotm);
+        DSS_ASSERT(iov);
+        dss_io_iov_add(iov, (void *)blk_ctx->blk, BLOCK_SIZE, 0);
+        dss_io_iov_add(iov, req->req_value.value, blk_ctx->blk->place_value[0].num_chunks * BLOCK_SIZE, 0);
+        dss_io_task_add_blk_writev(kreq->io_tasks, target_dev, blk_ctx->index, 1+blk_ctx->blk->place_value[0].num_chunks, iov, &io_opts);
         offset = blk_ctx->blk->place_value[0].num_chunks * BLOCK_SIZE;
         for (int i=1; i<blk->num_valid_place_value_entry; i++) {
             dss_io_task_add_blk_write(kreq->io_tasks, target_dev, blk_ctx->blk->place_value[i].value_index, blk_ctx->blk->place_value[i].num_chunks, req->req_value.value, (blk_ctx->blk->place_value[i].num_chunks)*BLOCK_SIZE, offset, false);
@@ -1015,6 +1282,99 @@ dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
 #endif
 }
 
+dss_kvtrans_status_t
+dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx,
+                            kvtrans_req_t *kreq,
+                            bool submit_for_disk_io)
+{
+    return _dss_kvtrans_write_ondisk_data(blk_ctx, kreq, 0, submit_for_disk_io);
+}
+
+#ifndef DSS_BUILD_CUNIT_TEST
+// Meta blk and the first value extent can go out as one writev
+// when the extent was allocated right after the meta blk
+static inline bool
+_dss_kvtrans_can_merge_meta_value(blk_ctx_t *blk_ctx)
+{
+    ondisk_meta_t *blk = blk_ctx->blk;
+
+    if (!g_disk_as_meta_store || !g_disk_as_data_store) return false;
+    if (blk->value_location == INLINE) return false;
+    if (blk->num_valid_place_value_entry == 0) return false;
+
+    return blk->place_value[0].value_index == blk_ctx->index + 1;
+}
+
+static dss_kvtrans_status_t
+dss_kvtrans_queue_writev_meta_value(blk_ctx_t *blk_ctx,
+                                    kvtrans_req_t *kreq)
+{
+    dss_io_task_status_t iot_rc;
+    kvtrans_ctx_t *kvtrans_ctx = kreq->kvtrans_ctx;
+    ondisk_meta_t *blk = blk_ctx->blk;
+    dss_io_opts_t io_opts = {.mod_id = DSS_IO_OP_OWNER_KVTRANS,
+                             .is_blocking = false};
+    dss_iov_t *iov;
+
+    iov = dss_io_iov_get(kvtrans_ctx->kvt_iotm);
+    if (!iov) {
+        return KVTRANS_STATUS_IO_ERROR;
+    }
+
+    iot_rc = dss_io_iov_add(iov, (void *)blk, kvtrans_ctx->blk_size, 0);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    iot_rc = dss_io_iov_add(iov, kreq->req.req_value.value,
+                            blk->place_value[0].num_chunks * kvtrans_ctx->blk_size, 0);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "Key [%s] meta LBA [%x] value nBlks [%x]\n",
+                    kreq->req.req_key.key, blk_ctx->index, blk->place_value[0].num_chunks);
+
+    iot_rc = dss_io_task_add_blk_writev(kreq->io_tasks,
+                                    kvtrans_ctx->target_dev,
+                                    blk_ctx->index,
+                                    1 + blk->place_value[0].num_chunks,
+                                    iov,
+                                    &io_opts);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    kreq->io_to_queue = true;
+
+    if(!_is_lba_dirty(kvtrans_ctx->meta_sync_ctx, blk_ctx->index)) {
+        _set_lba_dirty(kvtrans_ctx->meta_sync_ctx, blk_ctx->index);
+    }
+    if (kvtrans_ctx->meta_cache) {
+        kvtrans_meta_cache_invalidate(kvtrans_ctx->meta_cache, blk_ctx->index);
+        blk_ctx->meta_written = true;
+        kvtrans_meta_cache_invalidate_range(kvtrans_ctx->meta_cache,
+                                            blk->place_value[0].value_index,
+                                            blk->place_value[0].num_chunks);
+    }
+    return KVTRANS_IO_QUEUED;
+}
+#endif
+
+dss_kvtrans_status_t
+dss_kvtrans_write_ondisk_blk_data(blk_ctx_t *blk_ctx,
+                                kvtrans_req_t *kreq,
+                                bool submit_for_disk_io)
+{
+    dss_kvtrans_status_t rc;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    if (_dss_kvtrans_can_merge_meta_value(blk_ctx)) {
+        rc = dss_kvtrans_queue_writev_meta_value(blk_ctx, kreq);
+        if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+        return _dss_kvtrans_write_ondisk_data(blk_ctx, kreq, 1, submit_for_disk_io);
+    }
+#endif
+
+    rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
+    if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+    DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
+
+    return _dss_kvtrans_write_ondisk_data(blk_ctx, kreq, 0, submit_for_disk_io);
+}
+
 
 static uint16_t _find_min_hash_size_for_device(int blk_num) {
     uint16_t hash_size = MIN_HASH_SIZE;
@@ -1076,24 +1436,28 @@ hash_fn_ctx_t *init_hash_fn_ctx(kvtrans_params_t *params)
             hash_fn_ctx->hash_type = sha256_take_bit;
             hash_fn_ctx->init = SHA256_init;
             hash_fn_ctx->update = SHA256_update_take_bit;
+            hash_fn_ctx->update_batch = HASH_update_batch;
             hash_fn_ctx->clean = SHA256_clean;
             break;
         case sha256_take_byte:
             hash_fn_ctx->hash_type = sha256_take_byte;
             hash_fn_ctx->init = SHA256_init;
             hash_fn_ctx->update = SHA256_update_take_byte;
+            hash_fn_ctx->update_batch = HASH_update_batch;
             hash_fn_ctx->clean = SHA256_clean;
             break;
         case xxhash:
             hash_fn_ctx->hash_type = xxhash;
             hash_fn_ctx->init = XXHASH_init;
             hash_fn_ctx->update = XXHASH_update;
+            hash_fn_ctx->update_batch = XXHASH_update_batch;
             hash_fn_ctx->clean = XXHASH_clean;
             break;
         case spooky:
             hash_fn_ctx->hash_type = spooky;
             hash_fn_ctx->init = SPOOKY_init;
             hash_fn_ctx->update = SPOOKY_update;
+            hash_fn_ctx->update_batch = HASH_update_batch;
             hash_fn_ctx->clean = SPOOKY_clean;
             break;
         default:
@@ -1141,6 +1505,13 @@ kvtrans_params_t set_default_params() {
     params.blk_offset = 1;
     params.logi_blk_size = BLOCK_SIZE;
     params.state_num = DEFAULT_BLOCK_STATE_NUM;
+    params.batch_size = g_kvtrans_batch_size;
+    params.meta_cache_blks = g_kvtrans_meta_cache_blks;
+    params.key_filter_keys = g_kvtrans_key_filter_keys;
+    params.placement = (enum kvtrans_placement_e) g_kvtrans_placement;
+    params.cuckoo_bucket_blks = g_kvtrans_cuckoo_bucket_blks;
+    params.cuckoo_table_blks = 0;
+    params.packed_meta = g_kvtrans_packed_meta;
     return params;    
 }
 
@@ -1157,6 +1528,7 @@ void dss_kvtrans_blk_ctx_ctor(void *ctx, void *item)
 #else
     blk_ctx->blk = (ondisk_meta_t *) calloc(1, kvt_ctx->blk_size);
 #endif
+    blk_ctx->meta_written = false;
 
     return;
 }
@@ -1229,6 +1601,18 @@ kvtrans_ctx_t *init_kvtrans_ctx(kvtrans_params_t *params)
     ctx->is_ba_meta_sync_enabled = g_ba_enable_meta_sync;
     ctx->dump_mem_meta = g_dump_mem_meta;
 
+    ctx->batch_size = ctx->kvtrans_params.batch_size;
+    if (ctx->batch_size == 0) {
+        ctx->batch_size = 1;
+    } else if (ctx->batch_size > MAX_KVTRANS_BATCH_SIZE) {
+        ctx->batch_size = MAX_KVTRANS_BATCH_SIZE;
+    }
+    ctx->staged_blks = (blk_ctx_t **) calloc(ctx->batch_size, sizeof(blk_ctx_t *));
+    if (!ctx->staged_blks) {
+        DSS_ERRLOG("calloc for staged blks failed\n");
+        goto failure_handle;
+    }
+
 
     dss_blk_allocator_set_default_config(ctx->kvtrans_params.dev, &config);
     //dss_blk_allocator_set_default_config(NULL, &config);
@@ -1247,6 +1631,20 @@ kvtrans_ctx_t *init_kvtrans_ctx(kvtrans_params_t *params)
     config.num_block_states = ctx->state_num - 1;
 
     config.enable_ba_meta_sync = ctx->is_ba_meta_sync_enabled;
+    config.num_alloc_groups = g_kvtrans_ba_alloc_groups;
+    config.meta_sync_group_max_reqs = g_kvtrans_ba_meta_sync_group_reqs;
+    config.meta_sync_group_window_us = g_kvtrans_ba_meta_sync_group_window_us;
+    if (g_kvtrans_ba_journal) {
+        config.journal_start_block = ctx->kvtrans_params.ba_journal_start_blk;
+        config.journal_num_blocks = ctx->kvtrans_params.ba_journal_num_blks;
+        if (ctx->is_ba_meta_sync_enabled && config.journal_num_blocks == 0) {
+            DSS_NOTICELOG("No block allocator journal region, meta sync writes the bitmap\n");
+        }
+    }
+    if (g_kvtrans_ba_extent_tree) {
+        config.backend = BLK_ALLOCATOR_BACKEND_EXTENT_TREE;
+    }
+    config.size_class_region_blocks = g_kvtrans_ba_size_class_region_blocks;
 
     ctx->blk_alloc_ctx = dss_blk_allocator_init(ctx->kvtrans_params.dev, &config);
     //ctx->blk_alloc_ctx = dss_blk_allocator_init(NULL, &config);
@@ -1296,6 +1694,56 @@ kvtrans_ctx_t *init_kvtrans_ctx(kvtrans_params_t *params)
         goto failure_handle;
     }
 
+#ifndef DSS_BUILD_CUNIT_TEST
+    if (g_disk_as_meta_store && ctx->kvtrans_params.meta_cache_blks > 0) {
+        ctx->meta_cache = kvtrans_meta_cache_init(ctx->kvtrans_params.meta_cache_blks, ctx->blk_size);
+        if (!ctx->meta_cache) {
+            DSS_ERRLOG("Create meta cache of [%u] blks failed\n", ctx->kvtrans_params.meta_cache_blks);
+            goto failure_handle;
+        }
+        if (dfly_ustat_init_meta_cache_stat(&ctx->meta_cache_stat,
+                    __atomic_fetch_add(&g_kvtrans_meta_cache_stat_id, 1, __ATOMIC_SEQ_CST))) {
+            DSS_NOTICELOG("Meta cache stats not available for kvtrans [%p]\n", ctx);
+            ctx->meta_cache_stat = NULL;
+        }
+        DSS_NOTICELOG("Meta cache of [%u] blks created for kvtrans [%p]\n", ctx->kvtrans_params.meta_cache_blks, ctx);
+    }
+#endif
+
+    if (ctx->kvtrans_params.key_filter_keys > 0) {
+        ctx->key_filter = kvtrans_key_filter_init(ctx->kvtrans_params.key_filter_keys);
+        if (!ctx->key_filter) {
+            DSS_ERRLOG("Create key filter for [%zu] keys failed\n", ctx->kvtrans_params.key_filter_keys);
+            goto failure_handle;
+        }
+    }
+
+    STAILQ_INIT(&ctx->cuckoo_wait_queue);
+    if (ctx->kvtrans_params.placement == KVTRANS_PLACEMENT_CUCKOO) {
+        uint64_t avail_blks = ctx->kvtrans_params.logi_blk_num - ctx->blk_offset;
+        uint64_t table_blks = ctx->kvtrans_params.cuckoo_table_blks;
+
+        if (table_blks == 0) {
+            table_blks = avail_blks / KVTRANS_CUCKOO_TABLE_SHARE;
+        } else if (table_blks >= avail_blks) {
+            // leave space for values
+            table_blks = avail_blks / 2;
+            DSS_NOTICELOG("Cuckoo meta table capped to [%zu] blks\n", table_blks);
+        }
+        ctx->cuckoo = kvtrans_cuckoo_init(ctx->blk_offset, table_blks, ctx->kvtrans_params.cuckoo_bucket_blks);
+        if (!ctx->cuckoo) {
+            DSS_ERRLOG("Create cuckoo meta table of [%zu] blks with [%u] blks per bucket failed\n",
+                        table_blks, ctx->kvtrans_params.cuckoo_bucket_blks);
+            goto failure_handle;
+        }
+        DSS_NOTICELOG("Cuckoo meta table of [%zu] buckets at blk [%zu] created for kvtrans [%p]\n",
+                        ctx->cuckoo->num_buckets, ctx->cuckoo->start_blk, ctx);
+    } else if (ctx->kvtrans_params.packed_meta) {
+        // a hashed meta blk of chained placement belongs to one key
+        DSS_NOTICELOG("Packed meta blks need cuckoo placement, disabled for kvtrans [%p]\n", ctx);
+        ctx->kvtrans_params.packed_meta = false;
+    }
+
 #ifdef MEM_BACKEND
     init_mem_backend(ctx, ctx->kvtrans_params.meta_blk_num, ctx->kvtrans_params.logi_blk_num);
     if ((!g_disk_as_meta_store && !ctx->meta_ctx) || (!g_disk_as_data_store && !ctx->data_ctx)) {
@@ -1344,12 +1792,94 @@ void free_kvtrans_ctx(kvtrans_ctx_t *ctx)
 
     if (ctx->meta_sync_ctx) dss_kvtrans_free_meta_sync_ctx(ctx->meta_sync_ctx);
 
+    if (ctx->staged_blks) free(ctx->staged_blks);
+
+    if (ctx->meta_cache) kvtrans_meta_cache_free(ctx->meta_cache);
+    if (ctx->key_filter) kvtrans_key_filter_free(ctx->key_filter);
+    if (ctx->cuckoo) kvtrans_cuckoo_free(ctx->cuckoo);
+#ifndef DSS_BUILD_CUNIT_TEST
+    if (ctx->meta_cache_stat) dfly_ustat_remove_meta_cache_stat(ctx->meta_cache_stat);
+#endif
+
 #ifdef MEM_BACKEND
     free_mem_backend(ctx);
 #endif
     free(ctx);
 }
 
+// Length of the run of blks in blk_state starting at lba, up to end_lba
+static dss_kvtrans_status_t kvtrans_blk_run_len(kvtrans_ctx_t *ctx, uint64_t lba, uint64_t end_lba,
+                                                uint64_t blk_state, uint64_t *run_len)
+{
+    dss_blk_allocator_status_t rc;
+    uint64_t scanned_index = 0;
+
+    rc = dss_blk_allocator_check_blocks_state(ctx->blk_alloc_ctx, lba, end_lba - lba,
+                                              blk_state, &scanned_index);
+    // the generic check reports a mismatch as an error, trust scanned_index instead
+    if (rc == BLK_ALLOCATOR_STATUS_INVALID_BLOCK_RANGE ||
+            rc == BLK_ALLOCATOR_STATUS_INVALID_BLOCK_STATE ||
+            scanned_index + 1 < lba || scanned_index >= end_lba) {
+        DSS_ERRLOG("Fail to check blk [%zu, %zu) state\n", lba, end_lba);
+        return KVTRANS_STATUS_ERROR;
+    }
+
+    // scanned_index is the last blk in blk_state, lba - 1 if none
+    *run_len = scanned_index + 1 - lba;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+dss_kvtrans_status_t dss_kvtrans_cuckoo_reserve_table(kvtrans_ctx_t *ctx)
+{
+    dss_blk_allocator_status_t rc;
+    kvtrans_cuckoo_t *cuckoo = ctx->cuckoo;
+    uint64_t blk_state;
+    uint64_t lba, end_lba, run_len, len;
+    uint64_t reserved = 0;
+
+    if (!cuckoo) return KVTRANS_STATUS_SUCCESS;
+
+    lba = cuckoo->start_blk;
+    end_lba = kvtrans_cuckoo_end_lba(cuckoo);
+    while (lba < end_lba) {
+        // find the next run of free blks, reserved ones were loaded with the allocator
+        if (kvtrans_blk_run_len(ctx, lba, end_lba, EMPTY, &run_len)) {
+            return KVTRANS_STATUS_ERROR;
+        }
+        if (run_len == 0) {
+            // skip the whole run of blks in the state of lba
+            rc = dss_blk_allocator_get_block_state(ctx->blk_alloc_ctx, lba, &blk_state);
+            if (rc) {
+                DSS_ERRLOG("Fail to get blk [%zu] state\n", lba);
+                return KVTRANS_STATUS_ERROR;
+            }
+            if (kvtrans_blk_run_len(ctx, lba, end_lba, blk_state, &run_len)) {
+                return KVTRANS_STATUS_ERROR;
+            }
+            lba += run_len ? run_len : 1;
+            continue;
+        }
+
+        while (run_len > 0) {
+            // take the run in smaller pieces if the allocator can not do it at once
+            len = run_len;
+            while (dss_blk_allocator_alloc_blocks_contig(ctx->blk_alloc_ctx, CUCKOO_FREE, lba, len, NULL)) {
+                if (len == 1) {
+                    DSS_ERRLOG("Reserve cuckoo meta table blk [%zu] failed\n", lba);
+                    return KVTRANS_STATUS_ALLOC_CONTIG_ERROR;
+                }
+                len /= 2;
+            }
+            lba += len;
+            run_len -= len;
+            reserved += len;
+        }
+    }
+
+    DSS_NOTICELOG("Reserved [%zu] free blks of cuckoo meta table [%zu, %zu) for kvtrans [%p]\n",
+                    reserved, cuckoo->start_blk, end_lba, ctx);
+    return KVTRANS_STATUS_SUCCESS;
+}
 
 kvtrans_req_t *init_kvtrans_req(kvtrans_ctx_t *kvtrans_ctx, req_t *req, kvtrans_req_t *preallocated_req)
 {
@@ -1410,6 +1940,17 @@ kvtrans_req_t *init_kvtrans_req(kvtrans_ctx_t *kvtrans_ctx, req_t *req, kvtrans_
 #endif
     kreq->ba_meta_updated = false;
     kreq->io_to_queue = false;
+    kreq->entry_hashed = false;
+    kreq->batch_read = NULL;
+    kreq->meta_fill_blk = NULL;
+    kreq->key_created = false;
+    kreq->io_failed = false;
+    kreq->cuckoo_num_locked = 0;
+    kreq->cuckoo_retries = 0;
+    kreq->cuckoo_num_kicks = 0;
+    kreq->cuckoo_num_moved = 0;
+    kreq->cuckoo_packed_rec = -1;
+    kreq->cuckoo_buf = NULL;
     kreq->state = REQ_INITIALIZED;
     kreq->initialized = true;
 
@@ -1470,7 +2011,12 @@ void free_kvtrans_req(kvtrans_req_t *kreq)
         DSS_ASSERT(TAILQ_NEXT(b1, blk_link) == NULL);
         // keep b1's link to kreq
         
+        DSS_ASSERT(kreq->batch_read == NULL);
+        DSS_ASSERT(kreq->cuckoo_num_locked == 0 && kreq->cuckoo_buf == NULL);
         kreq->ba_meta_updated = false;
+        kreq->entry_hashed = false;
+        kreq->meta_fill_blk = NULL;
+        kreq->key_created = false;
         kreq->dreq = NULL;
         kreq->id = -1;
         kreq->io_to_queue = false;
@@ -1558,13 +2104,17 @@ _alloc_entry_block(kvtrans_ctx_t *ctx,
     dss_blk_allocator_context_t *blk_alloc_ctx = ctx->blk_alloc_ctx;
     req_t *req = &kreq->req;
 
-    // TODO: it's possbile key is all zero.
-    DSS_ASSERT(!iskeynull(req->req_key.key));
-    hash_fn_ctx->clean(hash_fn_ctx);
-    hash_fn_ctx->update(req->req_key.key, req->req_key.length, hash_fn_ctx);
-    blk_ctx->index = hash_fn_ctx->hashcode;
-    // ensure index is within [1, blk_alloc_opts.num_total_blocks - 1]
-    ctx->kv_assign_block(&blk_ctx->index, ctx);
+    if (!kreq->entry_hashed) {
+        // TODO: it's possbile key is all zero.
+        DSS_ASSERT(!iskeynull(req->req_key.key));
+        hash_fn_ctx->clean(hash_fn_ctx);
+        hash_fn_ctx->update(req->req_key.key, req->req_key.length, hash_fn_ctx);
+        blk_ctx->index = hash_fn_ctx->hashcode;
+        // ensure index is within [1, blk_alloc_opts.num_total_blocks - 1]
+        ctx->kv_assign_block(&blk_ctx->index, ctx);
+    }
+    // the hashed index is only valid for the first pass
+    kreq->entry_hashed = false;
 
     DSS_ASSERT(_lba_in_range(ctx, blk_ctx->index));
     rc = dss_kvtrans_get_blk_state(ctx, blk_ctx);
@@ -1669,6 +2219,8 @@ find_data_blocks(blk_ctx_t *blk_ctx, kvtrans_ctx_t *ctx, uint64_t num_blocks) {
         return rc;
     } 
     uint64_t allocated_start_block = 0;
+    // keep values out of the cuckoo meta table
+    uint64_t hint = ctx->cuckoo ? kvtrans_cuckoo_end_lba(ctx->cuckoo) : blk_ctx->index + 1;
 
     if (blk_ctx->blk->num_valid_place_value_entry == MAX_VALUE_SCATTER) {
         DSS_ERRLOG("The max scattered data entries [%d] has been reached\n", MAX_VALUE_SCATTER);
@@ -1677,7 +2229,7 @@ find_data_blocks(blk_ctx_t *blk_ctx, kvtrans_ctx_t *ctx, uint64_t num_blocks) {
 
 
     rc = dss_kvtrans_alloc_contig(ctx, blk_ctx->kreq, DATA, 
-        blk_ctx->index+1, num_blocks, &allocated_start_block);
+        hint, num_blocks, &allocated_start_block);
     if(rc == KVTRANS_STATUS_SUCCESS) {
         DSS_ASSERT(_lba_in_range(ctx, allocated_start_block));
         blk_ctx->blk->place_value[blk_ctx->blk->num_valid_place_value_entry].num_chunks = num_blocks;
@@ -1905,11 +2457,7 @@ static dss_kvtrans_status_t init_meta_blk(void *ctx)
         goto roll_back;
     }
 
-    rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
-    if (rc == KVTRANS_STATUS_IO_ERROR) goto roll_back;
-    DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
-
-    rc = dss_kvtrans_write_ondisk_data(blk_ctx, kreq, false);
+    rc = dss_kvtrans_write_ondisk_blk_data(blk_ctx, kreq, false);
     if (rc == KVTRANS_STATUS_IO_ERROR) {
         goto roll_back;
     }
@@ -1922,6 +2470,7 @@ static dss_kvtrans_status_t init_meta_blk(void *ctx)
     if (state==META) kvtrans_ctx->stat.meta++; 
     else kvtrans_ctx->stat.mdc++;
 
+    kreq->key_created = true;
     return KVTRANS_STATUS_SUCCESS;
 
 roll_back:
@@ -2088,11 +2637,7 @@ static dss_kvtrans_status_t update_meta_blk(void *ctx) {
         case update:
             rc = _blk_update_value(ctx);
             if (rc) return rc;
-            rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
-            if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
-            DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
-
-            rc = dss_kvtrans_write_ondisk_data(blk_ctx, kreq, false);
+            rc = dss_kvtrans_write_ondisk_blk_data(blk_ctx, kreq, false);
             if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
             DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
             rc = KVTRANS_STATUS_SUCCESS;
@@ -2152,15 +2697,11 @@ _new_write_ops(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq) {
 
         rc = _blk_init_value((void *)blk_ctx);
         if (rc) return rc;
-        rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
-        if (rc != KVTRANS_STATUS_IO_ERROR) {
-            DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
-            rc = KVTRANS_STATUS_SUCCESS;
-        }
-        rc = dss_kvtrans_write_ondisk_data(blk_ctx, kreq, false);
+        rc = dss_kvtrans_write_ondisk_blk_data(blk_ctx, kreq, false);
         if (rc != KVTRANS_STATUS_IO_ERROR) {
             DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
             rc = KVTRANS_STATUS_SUCCESS;
+            kreq->key_created = true;
         }
         return rc;
     } else {
@@ -2365,11 +2906,7 @@ static dss_kvtrans_status_t update_collision_blk(void *ctx) {
         case new_write:
         case update:
             rc = _blk_update_value(ctx);
-            rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
-            if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
-            DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
-
-            rc = dss_kvtrans_write_ondisk_data(blk_ctx, kreq, false);
+            rc = dss_kvtrans_write_ondisk_blk_data(blk_ctx, kreq, false);
             if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
             DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
             rc = KVTRANS_STATUS_SUCCESS;
@@ -2530,6 +3067,8 @@ static blk_key_ops_t g_blk_register[DEFAULT_BLOCK_STATE_NUM] = {
     { NULL, &update_meta_data_collision_blk, NULL},
     // DATA_COLLISION_CE
     { NULL, &update_meta_data_collision_blk, NULL},
+    // PACKED_META is handled by cuckoo placement
+    { NULL, NULL, NULL},
 };
 
 static dss_kvtrans_status_t update_collision_extension_blk(void *ctx) {
@@ -2560,16 +3099,1048 @@ static dss_kvtrans_status_t update_collision_extension_blk(void *ctx) {
     return rc;
 }
 
-// key_ops is the call-back from io_task on write completion
-dss_kvtrans_status_t _kvtrans_key_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+// Track keys added and removed by a completed store or delete
+static void _update_key_filter(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
 {
-    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+    req_t *req = &kreq->req;
+
+    if (req->opc == KVTRANS_OPC_STORE && kreq->key_created) {
+        if (!kvtrans_key_filter_insert(ctx->key_filter, req->req_key.key, req->req_key.length)) {
+            if (ctx->key_filter->overflow && !ctx->stat.key_filter_overflow) {
+                DSS_NOTICELOG("KVTRANS [%p]: key filter is full with [%zu] keys, disabled\n",
+                                ctx, ctx->key_filter->num_items);
+                ctx->stat.key_filter_overflow = 1;
+            }
+        }
+    } else if (req->opc == KVTRANS_OPC_DELETE) {
+        kvtrans_key_filter_delete(ctx->key_filter, req->req_key.key, req->req_key.length);
+    }
+}
+
+// slots of the candidate buckets, the buckets of a kick chain and the relocation target
+#define CUCKOO_MAX_SLOTS ((2 + DSS_KVTRANS_CUCKOO_MAX_KICKS) * KVTRANS_CUCKOO_MAX_BUCKET_BLKS + 1)
+
+// Gather the first num_slots blk_ctx of the meta chain, growing the chain as needed.
+// Slots of bucket kreq->cuckoo_bucket[b] start at b * bucket_blks: the
+// candidate buckets come first, then the buckets read for a kick chain.
+// The relocation target takes the first slot after the last bucket read.
+static dss_kvtrans_status_t
+_cuckoo_get_slots(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t **slots, uint32_t num_slots)
+{
+    blk_ctx_t *blk_ctx = TAILQ_FIRST(&kreq->meta_chain);
+    uint32_t i;
+
+    DSS_ASSERT(blk_ctx);
+    for (i = 0; i < num_slots; i++) {
+        if (i > 0) {
+            blk_ctx = _get_next_blk_ctx(ctx, blk_ctx);
+            if (!blk_ctx) return KVTRANS_MALLOC_ERROR;
+        }
+        slots[i] = blk_ctx;
+    }
+    return KVTRANS_STATUS_SUCCESS;
+}
 
+// Find the candidate buckets of the request key. Stores and deletes lock
+// both of them. Returns false if the request has to wait for a locked bucket.
+static bool
+_cuckoo_begin(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    kvtrans_cuckoo_t *cuckoo = ctx->cuckoo;
     req_t *req = &kreq->req;
-    blk_ctx_t *blk_ctx, *col_ctx, *meta_blk_ctx, *pre_ctx;
-    enum kvtrans_req_e prev_state = -1;
-    dss_io_task_status_t iot_rc;
-    dss_blk_allocator_status_t ba_rc;
+
+    // entry blk hashed by a batch is not used by cuckoo placement
+    kreq->entry_hashed = false;
+    kvtrans_cuckoo_get_buckets(cuckoo, req->req_key.key, req->req_key.length,
+                                &kreq->cuckoo_bucket[0], &kreq->cuckoo_bucket[1]);
+    kreq->cuckoo_gen = cuckoo->generation;
+
+    if (req->opc == KVTRANS_OPC_STORE || req->opc == KVTRANS_OPC_DELETE) {
+        if (kvtrans_cuckoo_lock(cuckoo, kreq->cuckoo_bucket, 2)) {
+            kreq->cuckoo_num_locked = 2;
+            return true;
+        }
+    } else if (!kvtrans_cuckoo_is_locked(cuckoo, kreq->cuckoo_bucket[0]) &&
+                !kvtrans_cuckoo_is_locked(cuckoo, kreq->cuckoo_bucket[1])) {
+        return true;
+    }
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: kreq [%p] waits for bucket [%zu] or [%zu] for key [%s]\n",
+                    ctx, kreq, kreq->cuckoo_bucket[0], kreq->cuckoo_bucket[1], req->req_key.key);
+#ifndef DSS_BUILD_CUNIT_TEST
+    STAILQ_INSERT_TAIL(&ctx->cuckoo_wait_queue, kreq, meta_sync_link);
+#endif
+    return false;
+}
+
+// Unlock the buckets of a finished store or delete and resume the requests
+// waiting for them. A resumed request starts over and may wait again.
+static void
+_cuckoo_unlock(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    if (kreq->cuckoo_num_locked == 0) return;
+
+    kvtrans_cuckoo_unlock(ctx->cuckoo, kreq->cuckoo_bucket, kreq->cuckoo_num_locked);
+    kreq->cuckoo_num_locked = 0;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    STAILQ_HEAD(, kvtrans_req) waiting = STAILQ_HEAD_INITIALIZER(waiting);
+    kvtrans_req_t *waiter;
+    dss_io_task_status_t iot_rc;
+
+    STAILQ_CONCAT(&waiting, &ctx->cuckoo_wait_queue);
+    while ((waiter = STAILQ_FIRST(&waiting)) != NULL) {
+        STAILQ_REMOVE_HEAD(&waiting, meta_sync_link);
+        if (kvtrans_cuckoo_is_locked(ctx->cuckoo, waiter->cuckoo_bucket[0]) ||
+                kvtrans_cuckoo_is_locked(ctx->cuckoo, waiter->cuckoo_bucket[1])) {
+            STAILQ_INSERT_TAIL(&ctx->cuckoo_wait_queue, waiter, meta_sync_link);
+            continue;
+        }
+        iot_rc = dss_io_task_post_completion(waiter->io_tasks);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+#endif
+}
+
+static inline bool _cuckoo_blk_has_key(blk_ctx_t *blk_ctx)
+{
+    return blk_ctx->state == META || blk_ctx->state == PACKED_META;
+}
+
+// Whether the value of a store is small enough for a packed meta blk
+static inline bool _cuckoo_packable(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    return ctx->kvtrans_params.packed_meta &&
+            kvtrans_packed_is_packable(kreq->req.req_key.length, kreq->req.req_value.length);
+}
+
+// Point the slots of candidate bucket b at its blks and get their states
+static dss_kvtrans_status_t
+_cuckoo_setup_bucket(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t **slots, uint32_t b)
+{
+    dss_kvtrans_status_t rc;
+    uint32_t bucket_blks = ctx->cuckoo->bucket_blks;
+    uint64_t lba = kvtrans_cuckoo_bucket_lba(ctx->cuckoo, kreq->cuckoo_bucket[b]);
+    blk_ctx_t *blk_ctx;
+    uint32_t i;
+
+    for (i = 0; i < bucket_blks; i++) {
+        blk_ctx = slots[b * bucket_blks + i];
+        blk_ctx->index = lba + i;
+        blk_ctx->kreq = kreq;
+        blk_ctx->nothash = false;
+        blk_ctx->kctx.dc_index = 0;
+        blk_ctx->kctx.pindex = 0;
+        memset(&blk_ctx->vctx, 0, sizeof(blk_val_ctx_t));
+        rc = dss_kvtrans_get_blk_state(ctx, blk_ctx);
+        if (rc) return rc;
+    }
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+// Read candidate bucket b of the request. A bucket without keys is not read.
+// kreq->state is set to done_state if the bucket is in memory when this
+// returns, or to queue_state if a read was submitted.
+static dss_kvtrans_status_t
+_cuckoo_load_bucket(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint32_t b,
+                    enum kvtrans_req_e done_state, enum kvtrans_req_e queue_state)
+{
+    dss_kvtrans_status_t rc;
+    uint32_t bucket_blks = ctx->cuckoo->bucket_blks;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *blk_ctx;
+    uint64_t lba = kvtrans_cuckoo_bucket_lba(ctx->cuckoo, kreq->cuckoo_bucket[b]);
+    bool has_key = false;
+    uint32_t i;
+
+    rc = _cuckoo_get_slots(ctx, kreq, slots, (b + 1) * bucket_blks);
+    if (rc) return rc;
+
+    rc = _cuckoo_setup_bucket(ctx, kreq, slots, b);
+    if (rc) return rc;
+    for (i = 0; i < bucket_blks; i++) {
+        if (_cuckoo_blk_has_key(slots[b * bucket_blks + i])) has_key = true;
+    }
+
+    if (!has_key) {
+        kreq->state = done_state;
+        return KVTRANS_STATUS_SUCCESS;
+    }
+
+    ctx->stat.meta_read++;
+    ctx->stat.meta_read_blks += bucket_blks;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    if (g_disk_as_meta_store) {
+        dss_io_opts_t io_opts = {.mod_id = DSS_IO_OP_OWNER_KVTRANS, .is_blocking = true};
+        dss_io_task_status_t iot_rc;
+
+        DSS_ASSERT(kreq->cuckoo_buf == NULL);
+        kreq->cuckoo_buf = spdk_dma_zmalloc(bucket_blks * ctx->blk_size, BLK_ALIGN, NULL);
+        if (kreq->cuckoo_buf) {
+            iot_rc = dss_io_task_add_blk_read(kreq->io_tasks,
+                                            ctx->target_dev,
+                                            lba,
+                                            bucket_blks,
+                                            kreq->cuckoo_buf,
+                                            &io_opts);
+            DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        } else {
+            // No memory for a bucket read, read the key blks one by one
+            for (i = 0; i < bucket_blks; i++) {
+                blk_ctx = slots[b * bucket_blks + i];
+                if (_cuckoo_blk_has_key(blk_ctx)) {
+                    dss_kvtrans_queue_load_ondisk_blk(blk_ctx, kreq);
+                }
+            }
+        }
+        kreq->io_to_queue = false;
+        iot_rc = dss_io_task_submit(kreq->io_tasks);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        kreq->state = queue_state;
+        return KVTRANS_IO_SUBMITTED;
+    }
+#endif
+
+    for (i = 0; i < bucket_blks; i++) {
+        val_t val;
+
+        blk_ctx = slots[b * bucket_blks + i];
+        if (!_cuckoo_blk_has_key(blk_ctx)) continue;
+        val = load_meta(ctx->meta_ctx, blk_ctx->index);
+        if (!val) return KVTRANS_STATUS_ERROR;
+        memcpy(blk_ctx->blk, val, sizeof(ondisk_meta_t));
+    }
+    kreq->state = done_state;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+// Copy the blks of a completed read of bucket b to its slots
+static void
+_cuckoo_bucket_loaded(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t **slots, uint32_t b)
+{
+#ifndef DSS_BUILD_CUNIT_TEST
+    uint32_t bucket_blks = ctx->cuckoo->bucket_blks;
+    uint32_t i;
+
+    if (kreq->cuckoo_buf) {
+        for (i = 0; i < bucket_blks; i++) {
+            memcpy(slots[b * bucket_blks + i]->blk,
+                    (uint8_t *)kreq->cuckoo_buf + i * ctx->blk_size, sizeof(ondisk_meta_t));
+        }
+        spdk_free(kreq->cuckoo_buf);
+        kreq->cuckoo_buf = NULL;
+    }
+#endif
+}
+
+// Look up the request key in loaded bucket b. Blks of a completed bucket
+// read are copied out first. slot is set to the record of a packed blk.
+static blk_ctx_t *
+_cuckoo_find_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint32_t b, int *slot)
+{
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    uint32_t bucket_blks = ctx->cuckoo->bucket_blks;
+    req_t *req = &kreq->req;
+    blk_ctx_t *blk_ctx;
+    uint32_t i;
+
+    if (_cuckoo_get_slots(ctx, kreq, slots, (b + 1) * bucket_blks)) {
+        return NULL;
+    }
+    _cuckoo_bucket_loaded(ctx, kreq, slots, b);
+
+    for (i = 0; i < bucket_blks; i++) {
+        blk_ctx = slots[b * bucket_blks + i];
+        if (blk_ctx->state == META && blk_ctx->blk->isvalid &&
+                iskeysame(blk_ctx->blk->key, blk_ctx->blk->key_len, req->req_key.key, req->req_key.length)) {
+            return blk_ctx;
+        }
+        if (blk_ctx->state == PACKED_META &&
+                kvtrans_packed_is_valid(blk_ctx->blk, sizeof(ondisk_meta_t))) {
+            *slot = kvtrans_packed_find(blk_ctx->blk, req->req_key.key, req->req_key.length);
+            if (*slot >= 0) return blk_ctx;
+        }
+    }
+    return NULL;
+}
+
+// Add the request key to packed blk_ctx, the caller checks it fits
+static dss_kvtrans_status_t
+_cuckoo_packed_insert(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t *blk_ctx)
+{
+    dss_kvtrans_status_t rc;
+    req_t *req = &kreq->req;
+
+    if (kvtrans_packed_insert(blk_ctx->blk, sizeof(ondisk_meta_t),
+                                req->req_key.key, req->req_key.length,
+                                req->req_value.value, req->req_value.length, &req->req_ts) < 0) {
+        return KVTRANS_STATUS_ERROR;
+    }
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: key [%s] packed in blk [%zu] with [%u] keys\n",
+                    ctx, req->req_key.key, blk_ctx->index, kvtrans_packed_num_keys(blk_ctx->blk));
+
+    rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
+    if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+    DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
+
+    ctx->stat.packed_keys++;
+    kreq->key_created = true;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+// Store the request key in EMPTY blk_ctx, as a new packed blk if the key is small
+static dss_kvtrans_status_t
+_cuckoo_init_key_blk(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t *blk_ctx)
+{
+    dss_kvtrans_status_t rc;
+    uint64_t allocated_start_lba;
+
+    if (!_cuckoo_packable(ctx, kreq)) {
+        blk_ctx->kctx.flag = new_write;
+        blk_ctx->kctx.ops = g_blk_register[EMPTY];
+        return init_meta_blk((void *)blk_ctx);
+    }
+
+    rc = dss_kvtrans_alloc_contig(ctx, kreq, PACKED_META, blk_ctx->index, 1, &allocated_start_lba);
+    if (rc) return rc;
+    DSS_ASSERT(allocated_start_lba == blk_ctx->index);
+    blk_ctx->state = PACKED_META;
+    kvtrans_packed_init(blk_ctx->blk, sizeof(ondisk_meta_t));
+
+    rc = _cuckoo_packed_insert(ctx, kreq, blk_ctx);
+    if (rc) {
+        blk_ctx->state = EMPTY;
+        if (dss_kvtrans_set_blk_state(ctx, NULL, blk_ctx->index, 1, EMPTY)) {
+            return KVTRANS_ROLL_BACK_ERROR;
+        }
+        return rc;
+    }
+    ctx->stat.packed_blks++;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+static dss_kvtrans_status_t
+_cuckoo_insert_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint32_t num_loaded);
+
+// Copy the value of record slot of packed blk_ctx to the request
+static void
+_cuckoo_load_packed_value(kvtrans_req_t *kreq, blk_ctx_t *blk_ctx, int slot)
+{
+    kvtrans_packed_rec_t *rec = kvtrans_packed_get(blk_ctx->blk, slot);
+    req_t *req = &kreq->req;
+
+    DSS_ASSERT(rec);
+    memcpy(req->req_value.value, kvtrans_packed_rec_value(rec), rec->value_size);
+    req->req_value.length = rec->value_size;
+}
+
+// Drop record slot of packed blk_ctx, the blk is freed with its last record
+static dss_kvtrans_status_t
+_cuckoo_drop_packed_rec(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t *blk_ctx, int slot)
+{
+    dss_kvtrans_status_t rc;
+    req_t *req = &kreq->req;
+
+    kvtrans_packed_delete(blk_ctx->blk, slot);
+    ctx->stat.packed_keys--;
+    if (kvtrans_packed_num_keys(blk_ctx->blk) > 0) {
+        rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
+        if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+        DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
+        return KVTRANS_STATUS_SUCCESS;
+    }
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: packed blk [%zu] is empty after key [%s]\n",
+                    ctx, blk_ctx->index, req->req_key.key);
+    rc = dss_kvtrans_set_blk_state(ctx, blk_ctx, blk_ctx->index, 1, EMPTY);
+    if (rc) return rc;
+    ctx->stat.packed_blks--;
+    rc = dss_kvtrans_delete_ondisk_blk(blk_ctx, kreq);
+    memset(blk_ctx->blk, 0, sizeof(ondisk_meta_t));
+    return rc;
+}
+
+// Update or delete the request key found in record slot of packed blk_ctx.
+// A store that no longer fits in the blk moves the key to another blk.
+// Returns KVTRANS_IO_SUBMITTED if keys are moved to make room for it first.
+static dss_kvtrans_status_t
+_cuckoo_modify_packed_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t *blk_ctx,
+                          int slot, uint32_t num_loaded)
+{
+    dss_kvtrans_status_t rc;
+    req_t *req = &kreq->req;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    uint32_t i;
+
+    if (req->opc == KVTRANS_OPC_STORE) {
+        if (_cuckoo_packable(ctx, kreq) &&
+                kvtrans_packed_update(blk_ctx->blk, sizeof(ondisk_meta_t), slot,
+                                        req->req_key.key, req->req_key.length,
+                                        req->req_value.value, req->req_value.length, &req->req_ts)) {
+            rc = dss_kvtrans_write_ondisk_blk(blk_ctx, kreq, false);
+            if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+            DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
+            return KVTRANS_STATUS_SUCCESS;
+        }
+        // the old record stays until the key is stored elsewhere
+        rc = _cuckoo_insert_key(ctx, kreq, num_loaded);
+        if (rc == KVTRANS_IO_SUBMITTED) {
+            // dropped by _cuckoo_place_key once the key is stored
+            rc = _cuckoo_get_slots(ctx, kreq, slots, num_loaded * ctx->cuckoo->bucket_blks);
+            if (rc) return rc;
+            for (i = 0; slots[i] != blk_ctx; i++);
+            kreq->cuckoo_packed_pos = i;
+            kreq->cuckoo_packed_rec = slot;
+            return KVTRANS_IO_SUBMITTED;
+        }
+        if (rc) return rc;
+        kreq->key_created = false;
+        // lookups that missed the key in flight retry
+        ctx->cuckoo->generation++;
+    }
+
+    return _cuckoo_drop_packed_rec(ctx, kreq, blk_ctx, slot);
+}
+
+// Update or delete the request key found in blk_ctx
+static dss_kvtrans_status_t
+_cuckoo_modify_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t *blk_ctx,
+                   int slot, uint32_t num_loaded)
+{
+    if (blk_ctx->state == PACKED_META) {
+        return _cuckoo_modify_packed_key(ctx, kreq, blk_ctx, slot, num_loaded);
+    }
+    blk_ctx->kctx.flag = kreq->req.opc == KVTRANS_OPC_DELETE ? to_delete : new_write;
+    blk_ctx->kctx.ops = g_blk_register[META];
+    return update_meta_blk((void *)blk_ctx);
+}
+
+static bool
+_cuckoo_find_empty_blk(kvtrans_ctx_t *ctx, uint64_t bucket, uint64_t *index)
+{
+    uint64_t lba = kvtrans_cuckoo_bucket_lba(ctx->cuckoo, bucket);
+    uint64_t blk_state;
+    uint32_t i;
+
+    for (i = 0; i < ctx->cuckoo->bucket_blks; i++) {
+        if (dss_blk_allocator_get_block_state(ctx->blk_alloc_ctx, lba + i, &blk_state)) {
+            return false;
+        }
+        if (blk_state == EMPTY || blk_state == CUCKOO_FREE) {
+            *index = lba + i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Blk the key moved by kick m is copied to: the blk of the key moved by the
+// next kick, or for the last kick the free blk found in its alternate bucket.
+static blk_ctx_t *
+_cuckoo_move_dest(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_ctx_t **slots, uint8_t m)
+{
+    if (m + 1 < kreq->cuckoo_num_kicks) {
+        return slots[kreq->cuckoo_kick_slot[m + 1]];
+    }
+    return slots[(2 + m) * ctx->cuckoo->bucket_blks];
+}
+
+// Copy the key moved by kick m to its destination blk. The blk it leaves is
+// not changed until the copy is written, a crash in between leaves the key
+// in both of its buckets.
+static dss_kvtrans_status_t
+_cuckoo_move_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint8_t m)
+{
+    dss_kvtrans_status_t rc;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *victim, *dest;
+    uint64_t allocated_start_lba;
+
+    rc = _cuckoo_get_slots(ctx, kreq, slots, (1 + kreq->cuckoo_num_kicks) * ctx->cuckoo->bucket_blks + 1);
+    if (rc) return rc;
+    victim = slots[kreq->cuckoo_kick_slot[m]];
+    dest = _cuckoo_move_dest(ctx, kreq, slots, m);
+
+    if (m + 1 == kreq->cuckoo_num_kicks) {
+        rc = dss_kvtrans_alloc_contig(ctx, kreq, META, dest->index, 1, &allocated_start_lba);
+        if (rc) return rc;
+        DSS_ASSERT(allocated_start_lba == dest->index);
+        dest->state = META;
+    }
+    memcpy(dest->blk, victim->blk, sizeof(ondisk_meta_t));
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: relocate key [%s] from blk [%zu] to [%zu] for key [%s]\n",
+                    ctx, victim->blk->key, victim->index, dest->index, kreq->req.req_key.key);
+
+    rc = dss_kvtrans_write_ondisk_blk(dest, kreq, false);
+    if (rc == KVTRANS_STATUS_IO_ERROR) return rc;
+    DSS_ASSERT(rc == KVTRANS_IO_QUEUED || rc == KVTRANS_IO_SUBMITTED || rc == KVTRANS_STATUS_SUCCESS);
+
+    // lookups that missed the key in flight retry
+    ctx->cuckoo->generation++;
+    ctx->cuckoo->relocations++;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+// Write the copy of a moved key before the next move may overwrite its old blk
+static void
+_cuckoo_submit_move(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    kreq->state = QUEUE_TO_RELOCATE;
+#ifndef DSS_BUILD_CUNIT_TEST
+    dss_io_task_status_t iot_rc;
+    dss_blk_allocator_status_t ba_rc;
+
+    if (ctx->is_ba_meta_sync_enabled && kreq->ba_meta_updated) {
+        ba_rc = dss_blk_allocator_queue_sync_meta_io_tasks(ctx->blk_alloc_ctx, kreq->io_tasks);
+        DSS_ASSERT(ba_rc == BLK_ALLOCATOR_STATUS_SUCCESS);
+        return;
+    } else if (kreq->io_to_queue) {
+        iot_rc = dss_io_task_submit(kreq->io_tasks);
+        DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+        return;
+    }
+#endif
+    kreq->state = RELOCATE_DONE;
+}
+
+// The copy of the key moved by kick m is on disk
+static dss_kvtrans_status_t
+_cuckoo_move_done(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint8_t m)
+{
+#ifndef DSS_BUILD_CUNIT_TEST
+    dss_kvtrans_status_t rc;
+    dss_blk_allocator_status_t ba_rc;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *dest;
+
+    if (ctx->is_ba_meta_sync_enabled && kreq->ba_meta_updated) {
+        ba_rc = dss_blk_allocator_complete_meta_sync(ctx->blk_alloc_ctx, kreq->io_tasks);
+        DSS_ASSERT(ba_rc == BLK_ALLOCATOR_STATUS_SUCCESS);
+    }
+    dss_io_task_reset_ops(kreq->io_tasks);
+
+    // a copy that did not reach the disk stays out of the cache
+    if (ctx->meta_cache && !kreq->io_failed) {
+        rc = _cuckoo_get_slots(ctx, kreq, slots, (1 + kreq->cuckoo_num_kicks) * ctx->cuckoo->bucket_blks + 1);
+        if (rc) return rc;
+        dest = _cuckoo_move_dest(ctx, kreq, slots, m);
+        kvtrans_meta_cache_update(ctx->meta_cache, dest->index, dest->blk);
+    }
+#endif
+    kreq->ba_meta_updated = false;
+    kreq->io_to_queue = false;
+    kreq->cuckoo_num_moved++;
+    return KVTRANS_STATUS_SUCCESS;
+}
+
+// Store the request key in the blk left by the first key moved. Its old
+// content already lives in the alternate bucket of that key. A packed
+// record the key outgrew is dropped with the same io.
+static dss_kvtrans_status_t
+_cuckoo_place_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    dss_kvtrans_status_t rc;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *blk_ctx;
+
+    rc = _cuckoo_get_slots(ctx, kreq, slots, (1 + kreq->cuckoo_num_kicks) * ctx->cuckoo->bucket_blks + 1);
+    if (rc) return rc;
+    blk_ctx = slots[kreq->cuckoo_kick_slot[0]];
+
+    rc = dss_kvtrans_set_blk_state(ctx, blk_ctx, blk_ctx->index, 1, EMPTY);
+    if (rc) return rc;
+    blk_ctx->state = EMPTY;
+    rc = _cuckoo_init_key_blk(ctx, kreq, blk_ctx);
+    if (rc) return rc;
+
+    if (kreq->cuckoo_packed_rec < 0) {
+        return KVTRANS_STATUS_SUCCESS;
+    }
+    kreq->key_created = false;
+    // lookups that missed the key in flight retry
+    ctx->cuckoo->generation++;
+    return _cuckoo_drop_packed_rec(ctx, kreq, slots[kreq->cuckoo_packed_pos], kreq->cuckoo_packed_rec);
+}
+
+// Find a key among num slots from first that can move to its alternate
+// bucket. A key whose alternate bucket has a free blk ends the kick chain and
+// the moves start from the last kick. Otherwise the alternate bucket of the
+// first key that can move is read to kick one of its keys, at most
+// DSS_KVTRANS_CUCKOO_MAX_KICKS times. Buckets on the chain stay locked until
+// the request completes, so the chain never comes back to one of them.
+// Returns KVTRANS_IO_SUBMITTED when the request goes on in another state.
+static dss_kvtrans_status_t
+_cuckoo_kick(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint32_t first, uint32_t num)
+{
+    dss_kvtrans_status_t rc;
+    kvtrans_cuckoo_t *cuckoo = ctx->cuckoo;
+    uint32_t bucket_blks = cuckoo->bucket_blks;
+    uint8_t m = kreq->cuckoo_num_kicks;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *blk_ctx;
+    int32_t victim = -1, walk = -1;
+    uint64_t alt, walk_alt = 0, index = 0;
+    bool walk_on;
+    uint32_t i, j;
+
+    rc = _cuckoo_get_slots(ctx, kreq, slots, (2 + m) * bucket_blks + 1);
+    if (rc) return rc;
+
+    for (i = 0; i < num; i++) {
+        // start at another key each time so the same keys are not moved over and over
+        j = first + (i + cuckoo->relocations) % num;
+        blk_ctx = slots[j];
+        if (blk_ctx->state != META || !blk_ctx->blk->isvalid) continue;
+        alt = kvtrans_cuckoo_alt_bucket(cuckoo, blk_ctx->blk->key, blk_ctx->blk->key_len,
+                                        kreq->cuckoo_bucket[j / bucket_blks]);
+        if (kvtrans_cuckoo_is_locked(cuckoo, alt)) continue;
+        if (_cuckoo_find_empty_blk(ctx, alt, &index)) {
+            victim = j;
+            break;
+        }
+        if (walk < 0) {
+            walk = j;
+            walk_alt = alt;
+        }
+    }
+
+    if (victim < 0 && (walk < 0 || m + 1 >= DSS_KVTRANS_CUCKOO_MAX_KICKS)) {
+        cuckoo->insert_failures++;
+        DSS_ERRLOG("KVTRANS [%p]: buckets [%zu] and [%zu] are full after [%u] kicks for key [%s]\n",
+                    ctx, kreq->cuckoo_bucket[0], kreq->cuckoo_bucket[1], m, kreq->req.req_key.key);
+        return KVTRANS_STATUS_ALLOC_CONTIG_ERROR;
+    }
+    walk_on = victim < 0;
+    if (walk_on) {
+        victim = walk;
+        alt = walk_alt;
+    }
+
+    kreq->cuckoo_bucket[2 + m] = alt;
+    if (!kvtrans_cuckoo_lock(cuckoo, &kreq->cuckoo_bucket[2 + m], 1)) {
+        return KVTRANS_STATUS_ERROR;
+    }
+    kreq->cuckoo_num_locked = 3 + m;
+    kreq->cuckoo_kick_slot[m] = victim;
+    kreq->cuckoo_num_kicks = m + 1;
+
+    if (walk_on) {
+        rc = _cuckoo_load_bucket(ctx, kreq, 2 + m, KICK_LOADING_DONE, QUEUE_TO_LOAD_KICK);
+        if (rc && rc != KVTRANS_IO_SUBMITTED) return rc;
+        return KVTRANS_IO_SUBMITTED;
+    }
+
+    blk_ctx = slots[(2 + m) * bucket_blks];
+    blk_ctx->index = index;
+    blk_ctx->kreq = kreq;
+    rc = _cuckoo_move_key(ctx, kreq, m);
+    if (rc) return rc;
+    _cuckoo_submit_move(ctx, kreq);
+    return KVTRANS_IO_SUBMITTED;
+}
+
+// Store the request key in a packed blk with room for it, or in a free blk of
+// the candidate bucket with more free blks. If both buckets are full, keys are
+// kicked to their alternate buckets to make room and KVTRANS_IO_SUBMITTED is
+// returned. Only the first num_loaded candidate buckets were read, blks of
+// the other one are used only if they are free.
+static dss_kvtrans_status_t
+_cuckoo_insert_key(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, uint32_t num_loaded)
+{
+    dss_kvtrans_status_t rc;
+    kvtrans_cuckoo_t *cuckoo = ctx->cuckoo;
+    req_t *req = &kreq->req;
+    uint32_t bucket_blks = cuckoo->bucket_blks;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *free_slot[2] = {NULL, NULL};
+    blk_ctx_t *packed_slot = NULL;
+    uint32_t num_free[2] = {0, 0};
+    bool packable = _cuckoo_packable(ctx, kreq);
+    blk_ctx_t *blk_ctx;
+    uint32_t i, b;
+
+    rc = _cuckoo_get_slots(ctx, kreq, slots, 2 * bucket_blks);
+    if (rc) return rc;
+    if (num_loaded < 2) {
+        rc = _cuckoo_setup_bucket(ctx, kreq, slots, 1);
+        if (rc) return rc;
+    }
+
+    for (i = 0; i < 2 * bucket_blks; i++) {
+        blk_ctx = slots[i];
+        b = i / bucket_blks;
+        // values of other requests may have taken blks since the bucket was read
+        rc = dss_kvtrans_get_blk_state(ctx, blk_ctx);
+        if (rc) return rc;
+        if (blk_ctx->state == EMPTY) {
+            if (!free_slot[b]) free_slot[b] = blk_ctx;
+            num_free[b]++;
+        } else if (packable && !packed_slot && b < num_loaded &&
+                    blk_ctx->state == PACKED_META &&
+                    kvtrans_packed_fits(blk_ctx->blk, req->req_key.length, req->req_value.length)) {
+            packed_slot = blk_ctx;
+        }
+    }
+
+    if (packed_slot) {
+        return _cuckoo_packed_insert(ctx, kreq, packed_slot);
+    }
+
+    blk_ctx = num_free[1] > num_free[0] ? free_slot[1] : free_slot[0];
+    if (blk_ctx) {
+        return _cuckoo_init_key_blk(ctx, kreq, blk_ctx);
+    }
+
+    return _cuckoo_kick(ctx, kreq, 0, num_loaded * bucket_blks);
+}
+
+// Finish a store or delete in cuckoo placement
+static dss_kvtrans_status_t
+_cuckoo_complete(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, bool completed)
+{
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+#ifndef DSS_BUILD_CUNIT_TEST
+    blk_ctx_t *blk_ctx;
+
+    dss_trace_record(TRACE_KVTRANS_WRITE_REQ_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
+    TAILQ_FOREACH(blk_ctx, &kreq->meta_chain, blk_link) {
+        if (blk_ctx->meta_written && completed) {
+            kvtrans_meta_cache_update(ctx->meta_cache, blk_ctx->index, blk_ctx->blk);
+        }
+        blk_ctx->meta_written = false;
+        rc = _pop_meta_blk_from_queue(ctx->meta_sync_ctx, blk_ctx);
+        if (rc == KVTRANS_STATUS_ERROR) break;
+        rc = KVTRANS_STATUS_SUCCESS;
+    }
+    if (ctx->meta_cache) ctx->meta_cache_stat_dirty = true;
+    if (kreq->cuckoo_buf) {
+        spdk_free(kreq->cuckoo_buf);
+        kreq->cuckoo_buf = NULL;
+    }
+#endif
+    _cuckoo_unlock(ctx, kreq);
+    return rc;
+}
+
+// Store and delete with cuckoo placement. The key is looked up in its first
+// candidate bucket, then in the second one; a new key is inserted once both
+// were read, after kicking keys out of the way if both are full.
+static dss_kvtrans_status_t
+_kvtrans_cuckoo_key_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+    req_t *req = &kreq->req;
+    blk_ctx_t *slots[CUCKOO_MAX_SLOTS];
+    blk_ctx_t *blk_ctx;
+    int slot = -1;
+    uint32_t b;
+    enum kvtrans_req_e prev_state = -1;
+    dss_io_task_status_t iot_rc;
+    dss_blk_allocator_status_t ba_rc;
+
+    // completed writes still finish their block allocator meta sync first
+    if (kreq->io_failed && kreq->state != IO_CMPL && kreq->state != RELOCATE_DONE) {
+        rc = KVTRANS_STATUS_IO_ERROR;
+        goto req_terminate;
+    }
+
+    do {
+        DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: Req[%p] with opc [%d] prev state [%d] current_state [%d] for key [%s]\n",
+                        kreq->kvtrans_ctx, kreq, kreq->req.opc, prev_state, kreq->state, req->req_key.key);
+        prev_state = kreq->state;
+        switch (kreq->state) {
+        case REQ_INITIALIZED:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_WRITE_REQ_INITIALIZED, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            if (!_cuckoo_begin(ctx, kreq)) {
+                // resumed once the buckets are unlocked
+                break;
+            }
+            rc = _cuckoo_load_bucket(ctx, kreq, 0, ENTRY_LOADING_DONE, QUEUE_TO_LOAD_ENTRY);
+            if (rc == KVTRANS_IO_SUBMITTED) {
+                rc = KVTRANS_STATUS_SUCCESS;
+            } else if (rc) {
+                goto req_terminate;
+            }
+            break;
+        case QUEUE_TO_LOAD_ENTRY:
+        case QUEUE_TO_LOAD_COL:
+            //External code should continue progres
+            break;
+        case ENTRY_LOADING_DONE:
+            blk_ctx = _cuckoo_find_key(ctx, kreq, 0, &slot);
+            if (blk_ctx) {
+                rc = _cuckoo_modify_key(ctx, kreq, blk_ctx, slot, 1);
+                if (rc == KVTRANS_IO_SUBMITTED) {
+                    rc = KVTRANS_STATUS_SUCCESS;
+                    break;
+                } else if (rc) {
+                    goto req_terminate;
+                }
+                kreq->state = QUEUE_TO_START_IO;
+                break;
+            }
+            rc = _cuckoo_load_bucket(ctx, kreq, 1, COL_LOADING_DONE, QUEUE_TO_LOAD_COL);
+            if (rc == KVTRANS_IO_SUBMITTED) {
+                rc = KVTRANS_STATUS_SUCCESS;
+            } else if (rc) {
+                goto req_terminate;
+            }
+            break;
+        case COL_LOADING_DONE:
+            blk_ctx = _cuckoo_find_key(ctx, kreq, 1, &slot);
+            if (blk_ctx) {
+                rc = _cuckoo_modify_key(ctx, kreq, blk_ctx, slot, 2);
+            } else if (req->opc == KVTRANS_OPC_DELETE) {
+                rc = KVTRANS_STATUS_NOT_FOUND;
+            } else {
+                rc = _cuckoo_insert_key(ctx, kreq, 2);
+            }
+            if (rc == KVTRANS_IO_SUBMITTED) {
+                rc = KVTRANS_STATUS_SUCCESS;
+                break;
+            } else if (rc) {
+                goto req_terminate;
+            }
+            kreq->state = QUEUE_TO_START_IO;
+            break;
+        case QUEUE_TO_LOAD_KICK:
+        case QUEUE_TO_RELOCATE:
+            //External code should continue progres
+            break;
+        case KICK_LOADING_DONE:
+            // a bucket read without io comes back to this state
+            do {
+                b = 1 + kreq->cuckoo_num_kicks;
+                rc = _cuckoo_get_slots(ctx, kreq, slots, (b + 1) * ctx->cuckoo->bucket_blks);
+                if (rc) goto req_terminate;
+                _cuckoo_bucket_loaded(ctx, kreq, slots, b);
+                rc = _cuckoo_kick(ctx, kreq, b * ctx->cuckoo->bucket_blks, ctx->cuckoo->bucket_blks);
+                if (rc != KVTRANS_IO_SUBMITTED) goto req_terminate;
+            } while (kreq->state == KICK_LOADING_DONE);
+            rc = KVTRANS_STATUS_SUCCESS;
+            break;
+        case RELOCATE_DONE:
+            // keys move from the last kick back to the first, a move
+            // written without io comes back to this state
+            do {
+                rc = _cuckoo_move_done(ctx, kreq, kreq->cuckoo_num_kicks - 1 - kreq->cuckoo_num_moved);
+                if (rc) goto req_terminate;
+                if (kreq->io_failed) {
+                    rc = KVTRANS_STATUS_IO_ERROR;
+                    goto req_terminate;
+                }
+                if (kreq->cuckoo_num_moved == kreq->cuckoo_num_kicks) break;
+                rc = _cuckoo_move_key(ctx, kreq, kreq->cuckoo_num_kicks - 1 - kreq->cuckoo_num_moved);
+                if (rc) goto req_terminate;
+                _cuckoo_submit_move(ctx, kreq);
+            } while (kreq->state == RELOCATE_DONE);
+            if (kreq->state != RELOCATE_DONE) break;
+            rc = _cuckoo_place_key(ctx, kreq);
+            if (rc) goto req_terminate;
+            kreq->state = QUEUE_TO_START_IO;
+            break;
+        case QUEUE_TO_START_IO:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_WRITE_QUEUE_TO_START_IO, 0, 0, (uintptr_t)kreq->id, (uintptr_t)kreq);
+            if(ctx->is_ba_meta_sync_enabled == true && kreq->ba_meta_updated == true) {
+                ba_rc = dss_blk_allocator_queue_sync_meta_io_tasks(ctx->blk_alloc_ctx, kreq->io_tasks);
+                DSS_ASSERT(ba_rc == BLK_ALLOCATOR_STATUS_SUCCESS);
+                break;
+            } else if (kreq->io_to_queue) {
+                iot_rc = dss_io_task_submit(kreq->io_tasks);
+                DSS_ASSERT(iot_rc==DSS_IO_TASK_STATUS_SUCCESS);
+                break;
+            }
+#endif
+            kreq->state = IO_CMPL;
+            break;
+        case IO_CMPL:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_WRITE_IO_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            kreq->state = REQ_CMPL;
+            if(ctx->is_ba_meta_sync_enabled && kreq->ba_meta_updated) {
+                ba_rc = dss_blk_allocator_complete_meta_sync(ctx->blk_alloc_ctx, kreq->io_tasks);
+                DSS_ASSERT(ba_rc == BLK_ALLOCATOR_STATUS_SUCCESS);
+            }
+            if (kreq->io_failed) {
+                rc = KVTRANS_STATUS_IO_ERROR;
+                goto req_terminate;
+            }
+            break;
+        case REQ_CMPL:
+            rc = _cuckoo_complete(ctx, kreq, true);
+            if (rc) return rc;
+            if (ctx->key_filter) {
+                _update_key_filter(ctx, kreq);
+            }
+            ctx->task_done++;
+            return rc;
+        default:
+            DSS_ASSERT(0);
+            break;
+        }
+    } while (kreq->state != prev_state);
+#ifdef DSS_BUILD_CUNIT_TEST
+    STAILQ_INSERT_TAIL(&kreq->kvtrans_ctx->req_head, kreq, req_link);
+#endif
+
+    return rc;
+
+req_terminate:
+    if (rc == KVTRANS_STATUS_NOT_FOUND) {
+        DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: key [%s] not found in buckets [%zu] and [%zu]\n",
+                        ctx, req->req_key.key, kreq->cuckoo_bucket[0], kreq->cuckoo_bucket[1]);
+    } else {
+        DSS_ERRLOG("rc [%d]: Failed to process kreq [%p] in buckets [%zu] and [%zu] for key [%s]\n",
+                    rc, kreq, kreq->cuckoo_bucket[0], kreq->cuckoo_bucket[1], req->req_key.key);
+    }
+    kreq->state = REQ_CMPL;
+    if (_cuckoo_complete(ctx, kreq, false) == KVTRANS_STATUS_ERROR) {
+        return KVTRANS_STATUS_ERROR;
+    }
+    ctx->task_failed++;
+    return rc;
+}
+
+// Retrieve and exist with cuckoo placement. At most two bucket reads unless
+// keys were relocated while the lookup was in flight.
+static dss_kvtrans_status_t
+_kvtrans_cuckoo_val_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, blk_cb_t cb)
+{
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+    dss_io_task_status_t iot_rc;
+    blk_ctx_t *blk_ctx = NULL;
+    int slot = -1;
+    req_t *req = &kreq->req;
+    enum kvtrans_req_e prev_state = -1;
+
+    do {
+        prev_state = kreq->state;
+        DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: Req[%p] with opc [%d] prev state [%s] current_state [%s] for key [%s]\n",
+                            kreq->kvtrans_ctx, kreq, kreq->req.opc, stateNames[prev_state], stateNames[kreq->state], req->req_key.key);
+        switch (kreq->state) {
+        case REQ_INITIALIZED:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_READ_REQ_INITIALIZED, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            if (ctx->key_filter &&
+                    !kvtrans_key_filter_may_contain(ctx->key_filter, req->req_key.key, req->req_key.length)) {
+                rc = KVTRANS_STATUS_NOT_FOUND;
+                kreq->state = REQ_CMPL;
+                ctx->stat.key_filter_neg++;
+                break;
+            }
+            if (!_cuckoo_begin(ctx, kreq)) {
+                // resumed once the buckets are unlocked
+                break;
+            }
+            rc = _cuckoo_load_bucket(ctx, kreq, 0, ENTRY_LOADING_DONE, QUEUE_TO_LOAD_ENTRY);
+            if (rc == KVTRANS_IO_SUBMITTED) rc = KVTRANS_STATUS_SUCCESS;
+            else if (rc) return rc;
+            break;
+        case QUEUE_TO_LOAD_ENTRY:
+        case QUEUE_TO_LOAD_COL:
+            break;
+        case ENTRY_LOADING_DONE:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_READ_ENTRY_LOADING_DONE, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            blk_ctx = _cuckoo_find_key(ctx, kreq, 0, &slot);
+            if (blk_ctx) goto key_found;
+            rc = _cuckoo_load_bucket(ctx, kreq, 1, COL_LOADING_DONE, QUEUE_TO_LOAD_COL);
+            if (rc == KVTRANS_IO_SUBMITTED) rc = KVTRANS_STATUS_SUCCESS;
+            else if (rc) return rc;
+            break;
+        case COL_LOADING_DONE:
+            blk_ctx = _cuckoo_find_key(ctx, kreq, 1, &slot);
+            if (blk_ctx) goto key_found;
+            if (kreq->cuckoo_gen != ctx->cuckoo->generation &&
+                    kreq->cuckoo_retries < KVTRANS_CUCKOO_MAX_RETRIES) {
+                // the key may have moved to the bucket read first
+                kreq->cuckoo_retries++;
+                ctx->cuckoo->lookup_retries++;
+                kreq->state = REQ_INITIALIZED;
+                break;
+            }
+            rc = KVTRANS_STATUS_NOT_FOUND;
+            kreq->state = REQ_CMPL;
+            break;
+        case QUEUE_TO_START_IO:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_READ_QUEUE_TO_START_IO, 0, 0, 0, (uintptr_t)kreq->dreq);
+            DSS_ASSERT(cb!=NULL);
+            iot_rc = dss_io_task_submit(kreq->io_tasks);
+            DSS_ASSERT(iot_rc==DSS_IO_TASK_STATUS_SUCCESS);
+            break;
+#else
+            kreq->state = IO_CMPL;
+            break;
+#endif
+        case QUEUED_FOR_DATA_IO:
+            //External code should continue progres
+            break;
+        case IO_CMPL:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_READ_IO_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            kreq->state = REQ_CMPL;
+            break;
+        case REQ_CMPL:
+#ifndef DSS_BUILD_CUNIT_TEST
+            dss_trace_record(TRACE_KVTRANS_READ_REQ_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
+#endif
+            ctx->task_done++;
+            return rc;
+        default:
+            DSS_ASSERT(0);
+        }
+        continue;
+
+key_found:
+        rc = KVTRANS_STATUS_SUCCESS;
+        if (blk_ctx->state == PACKED_META) {
+            // value is inline with the packed record
+            if (cb) _cuckoo_load_packed_value(kreq, blk_ctx, slot);
+            kreq->state = REQ_CMPL;
+        } else if (cb) {
+            rc = cb((void *)blk_ctx);
+            DSS_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+            //State should be updated by cb
+        } else {
+            kreq->state = REQ_CMPL;
+        }
+    } while (kreq->state != prev_state);
+#ifdef DSS_BUILD_CUNIT_TEST
+    STAILQ_INSERT_TAIL(&kreq->kvtrans_ctx->req_head, kreq, req_link);
+#endif
+    return rc;
+}
+
+// key_ops is the call-back from io_task on write completion
+dss_kvtrans_status_t _kvtrans_key_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
+{
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+
+    req_t *req = &kreq->req;
+    blk_ctx_t *blk_ctx, *col_ctx, *meta_blk_ctx, *pre_ctx;
+    enum kvtrans_req_e prev_state = -1;
+    dss_io_task_status_t iot_rc;
+    dss_blk_allocator_status_t ba_rc;
+
+    if (ctx->cuckoo) {
+        return _kvtrans_cuckoo_key_ops(ctx, kreq);
+    }
+
+    if (kreq->io_failed && kreq->state != IO_CMPL) {
+        // a meta blk read failed, nothing loaded can be used
+        rc = KVTRANS_STATUS_IO_ERROR;
+        goto req_terminate;
+    }
 
     do {
         DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: Req[%p] with opc [%d] prev state [%d] current_state [%d] for key [%s]\n",
@@ -2778,12 +4349,21 @@ dss_kvtrans_status_t _kvtrans_key_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
                 DSS_ASSERT(ba_rc == BLK_ALLOCATOR_STATUS_SUCCESS);
                 DSS_DEBUGLOG(DSS_KVTRANS, "kreq [%p] completes BA meta sync with iotask [%p]\n", kreq, kreq->io_tasks);
             }
+            if (kreq->io_failed) {
+                rc = KVTRANS_STATUS_IO_ERROR;
+                goto req_terminate;
+            }
             break;
         case REQ_CMPL:
 #ifndef DSS_BUILD_CUNIT_TEST
             dss_trace_record(TRACE_KVTRANS_WRITE_REQ_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
             TAILQ_FOREACH(blk_ctx, &kreq->meta_chain, blk_link) {
                 DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS[%p]: kreq write [%p] for lba[%u] completed [%p] by io_task\n", ctx, kreq, blk_ctx->index, kreq->io_tasks);
+                if (blk_ctx->meta_written) {
+                    // written blk is durable, cache it before waking up waiters
+                    kvtrans_meta_cache_update(ctx->meta_cache, blk_ctx->index, blk_ctx->blk);
+                    blk_ctx->meta_written = false;
+                }
                 rc = _pop_meta_blk_from_queue(ctx->meta_sync_ctx, blk_ctx);
                 if (rc == KVTRANS_STATUS_ERROR) {
                     return rc;
@@ -2791,7 +4371,11 @@ dss_kvtrans_status_t _kvtrans_key_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq)
                     rc = KVTRANS_STATUS_SUCCESS;
                 }
             }
+            if (ctx->meta_cache) ctx->meta_cache_stat_dirty = true;
 #endif
+            if (ctx->key_filter) {
+                _update_key_filter(ctx, kreq);
+            }
             ctx->task_done++;
             return rc;
         default:
@@ -2812,6 +4396,8 @@ req_terminate:
     // new requests would be queued by zombie dirty LBAs
     dss_trace_record(TRACE_KVTRANS_WRITE_REQ_CMPL, 0, 0, 0, (uintptr_t)kreq->dreq);
     TAILQ_FOREACH(blk_ctx, &kreq->meta_chain, blk_link) {
+        // blk was invalidated when its write was queued
+        blk_ctx->meta_written = false;
         rc = _pop_meta_blk_from_queue(ctx->meta_sync_ctx, blk_ctx);
         if (rc == KVTRANS_STATUS_ERROR) {
             return rc;
@@ -2819,6 +4405,7 @@ req_terminate:
             rc = KVTRANS_STATUS_SUCCESS;
         }
     }
+    if (ctx->meta_cache) ctx->meta_cache_stat_dirty = true;
 #endif
 
     ctx->task_failed++;
@@ -2828,7 +4415,26 @@ req_terminate:
 dss_kvtrans_status_t
 kvtrans_handle_kreq_state(kvtrans_req_t *kreq) {
     DSS_ASSERT(kreq);
-    // TODO: check return status from io_task
+#ifndef DSS_BUILD_CUNIT_TEST
+    // status is lost once ops are reset, keep it for the rest of the request
+    if (dss_io_task_get_status(kreq->io_tasks) != DSS_IO_TASK_STATUS_SUCCESS) {
+        DSS_ERRLOG("kreq [%p] io task [%p] failed in state [%s] for key [%s]\n",
+                    kreq, kreq->io_tasks, stateNames[kreq->state], kreq->req.req_key.key);
+        kreq->io_failed = true;
+    }
+    if (kreq->meta_fill_blk) {
+        DSS_ASSERT(kreq->state == QUEUE_TO_LOAD_ENTRY ||
+                    kreq->state == QUEUE_TO_LOAD_COL ||
+                    kreq->state == QUEUE_TO_LOAD_COL_EXT ||
+                    kreq->state == QUEUE_TO_LOAD_KICK);
+        if (kreq->io_failed) {
+            // blk was not read, keep it out of the cache
+            kreq->meta_fill_blk = NULL;
+        } else {
+            _fill_meta_cache(kreq);
+        }
+    }
+#endif
     switch (kreq->state)
     {
     case QUEUE_TO_LOAD_ENTRY:
@@ -2845,6 +4451,14 @@ kvtrans_handle_kreq_state(kvtrans_req_t *kreq) {
         kreq->state = COL_EXT_LOADING_DONE;
         dss_io_task_reset_ops( kreq->io_tasks);
         break;
+    case QUEUE_TO_LOAD_KICK:
+        kreq->state = KICK_LOADING_DONE;
+        dss_io_task_reset_ops( kreq->io_tasks);
+        break;
+    case QUEUE_TO_RELOCATE:
+        // ops are reset after the block allocator meta sync completes
+        kreq->state = RELOCATE_DONE;
+        break;
     case QUEUED_FOR_DATA_IO:
         kreq->state = IO_CMPL;
         break;
@@ -2881,6 +4495,24 @@ dss_kvtrans_status_t _kvtrans_val_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, b
 
     enum kvtrans_req_e prev_state = -1;
 
+    if (kreq->io_failed && kreq->state != REQ_CMPL) {
+        // a meta blk or value read failed, complete with the error
+        DSS_ERRLOG("Failed to retrieve key [%s] for kreq [%p]\n", req->req_key.key, kreq);
+#ifndef DSS_BUILD_CUNIT_TEST
+        if (kreq->cuckoo_buf) {
+            spdk_free(kreq->cuckoo_buf);
+            kreq->cuckoo_buf = NULL;
+        }
+#endif
+        kreq->state = REQ_CMPL;
+        ctx->task_failed++;
+        return KVTRANS_STATUS_IO_ERROR;
+    }
+
+    if (ctx->cuckoo) {
+        return _kvtrans_cuckoo_val_ops(ctx, kreq, cb);
+    }
+
     do {
         prev_state = kreq->state;
         DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: Req[%p] with opc [%d] prev state [%s] current_state [%s] for key [%s]\n", 
@@ -2890,6 +4522,14 @@ dss_kvtrans_status_t _kvtrans_val_ops(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq, b
 #ifndef DSS_BUILD_CUNIT_TEST
             dss_trace_record(TRACE_KVTRANS_READ_REQ_INITIALIZED, 0, 0, 0, (uintptr_t)kreq->dreq);
 #endif
+            if (ctx->key_filter &&
+                    !kvtrans_key_filter_may_contain(ctx->key_filter, req->req_key.key, req->req_key.length)) {
+                // key was never stored, skip meta io
+                rc = KVTRANS_STATUS_NOT_FOUND;
+                kreq->state = REQ_CMPL;
+                ctx->stat.key_filter_neg++;
+                break;
+            }
             // only one blk_ctx in the meta_chain
             blk_ctx = TAILQ_FIRST(&kreq->meta_chain);
             // TODO: init blk_ctx with 0
@@ -3037,6 +4677,233 @@ dss_kvtrans_status_t kvtrans_exist(kvtrans_ctx_t *ctx, kvtrans_req_t *kreq) {
     return rc;
 }
 
+void dss_kvtrans_hash_entry_blks(kvtrans_req_t **kreqs, uint32_t num_kreqs)
+{
+    const char *keys[MAX_KVTRANS_BATCH_SIZE];
+    uint32_t klens[MAX_KVTRANS_BATCH_SIZE];
+    uint64_t hashcodes[MAX_KVTRANS_BATCH_SIZE];
+    kvtrans_ctx_t *ctx;
+    kvtrans_req_t *kreq;
+    blk_ctx_t *blk_ctx;
+    uint32_t start, end, i;
+
+    DSS_ASSERT(num_kreqs <= MAX_KVTRANS_BATCH_SIZE);
+
+    for (start = 0; start < num_kreqs; start = end) {
+        ctx = kreqs[start]->kvtrans_ctx;
+        for (end = start; end < num_kreqs && kreqs[end]->kvtrans_ctx == ctx; end++) {
+            kreq = kreqs[end];
+            DSS_ASSERT(kreq->state == REQ_INITIALIZED);
+            DSS_ASSERT(!iskeynull(kreq->req.req_key.key));
+            keys[end - start] = kreq->req.req_key.key;
+            klens[end - start] = kreq->req.req_key.length;
+        }
+
+        ctx->hash_fn_ctx->update_batch(keys, klens, hashcodes, end - start, ctx->hash_fn_ctx);
+
+        for (i = start; i < end; i++) {
+            blk_ctx = TAILQ_FIRST(&kreqs[i]->meta_chain);
+            DSS_ASSERT(blk_ctx);
+            blk_ctx->index = hashcodes[i - start];
+            ctx->kv_assign_block(&blk_ctx->index, ctx);
+            kreqs[i]->entry_hashed = true;
+        }
+    }
+}
+
+static int _kreq_entry_cmp(const void *a, const void *b)
+{
+    const kvtrans_req_t *k1 = *(kvtrans_req_t * const *)a;
+    const kvtrans_req_t *k2 = *(kvtrans_req_t * const *)b;
+    uint64_t i1, i2;
+
+    if (k1->kvtrans_ctx != k2->kvtrans_ctx) {
+        return (uintptr_t)k1->kvtrans_ctx < (uintptr_t)k2->kvtrans_ctx ? -1 : 1;
+    }
+
+    i1 = TAILQ_FIRST(&k1->meta_chain)->index;
+    i2 = TAILQ_FIRST(&k2->meta_chain)->index;
+    if (i1 != i2) {
+        return i1 < i2 ? -1 : 1;
+    }
+
+    // keep arrival order of requests on the same entry blk
+    if (k1->id != k2->id) {
+        return k1->id < k2->id ? -1 : 1;
+    }
+    return 0;
+}
+
+void dss_kvtrans_sort_kreqs(kvtrans_req_t **kreqs, uint32_t num_kreqs)
+{
+    if (num_kreqs < 2) return;
+    qsort(kreqs, num_kreqs, sizeof(kvtrans_req_t *), _kreq_entry_cmp);
+}
+
+void dss_kvtrans_batch_begin(kvtrans_ctx_t *ctx)
+{
+    DSS_ASSERT(!ctx->batch_in_progress);
+    ctx->num_staged_blks = 0;
+    ctx->batch_in_progress = true;
+}
+
+#ifndef DSS_BUILD_CUNIT_TEST
+static int _blk_ctx_index_cmp(const void *a, const void *b)
+{
+    const blk_ctx_t *b1 = *(blk_ctx_t * const *)a;
+    const blk_ctx_t *b2 = *(blk_ctx_t * const *)b;
+
+    if (b1->index == b2->index) return 0;
+    return b1->index < b2->index ? -1 : 1;
+}
+
+static void
+_submit_single_entry_read(blk_ctx_t *blk_ctx)
+{
+    dss_io_task_status_t iot_rc;
+    kvtrans_req_t *kreq = blk_ctx->kreq;
+
+    dss_kvtrans_queue_load_ondisk_blk(blk_ctx, kreq);
+    kreq->io_to_queue = false;
+    iot_rc = dss_io_task_submit(kreq->io_tasks);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+}
+
+static void
+_submit_batch_read(kvtrans_ctx_t *ctx, blk_ctx_t **blks, uint32_t num_blks)
+{
+    dss_io_task_status_t iot_rc;
+    dss_io_opts_t io_opts = {.mod_id = DSS_IO_OP_OWNER_KVTRANS, .is_blocking = true};
+    kvtrans_req_t *leader = blks[0]->kreq;
+    kvtrans_batch_read_t *batch;
+    uint32_t i;
+
+    if (num_blks == 1) {
+        _submit_single_entry_read(blks[0]);
+        return;
+    }
+
+    batch = (kvtrans_batch_read_t *) calloc(1, sizeof(kvtrans_batch_read_t));
+    if (batch) {
+        batch->lba = blks[0]->index;
+        batch->nblks = blks[num_blks - 1]->index - batch->lba + 1;
+        batch->buf = spdk_dma_zmalloc(batch->nblks * ctx->blk_size, BLK_ALIGN, NULL);
+    }
+
+    if (!batch || !batch->buf) {
+        // No memory for a merged read, fall back to one read per blk
+        free(batch);
+        for (i = 0; i < num_blks; i++) {
+            _submit_single_entry_read(blks[i]);
+        }
+        return;
+    }
+
+    for (i = 0; i < num_blks; i++) {
+        batch->blk_ctx[i] = blks[i];
+    }
+    batch->num_blk_ctx = num_blks;
+
+    DSS_ASSERT(leader->batch_read == NULL);
+    leader->batch_read = batch;
+
+    iot_rc = dss_io_task_add_blk_read(leader->io_tasks,
+                                    ctx->target_dev,
+                                    batch->lba,
+                                    batch->nblks,
+                                    batch->buf,
+                                    &io_opts);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+    leader->io_to_queue = false;
+
+    DSS_DEBUGLOG(DSS_KVTRANS, "KVTRANS [%p]: merged read of [%u] blks at lba [%zu] for [%u] kreqs\n",
+                    ctx, batch->nblks, batch->lba, num_blks);
+    ctx->stat.batch_read++;
+    ctx->stat.batch_read_kreq += num_blks;
+
+    iot_rc = dss_io_task_submit(leader->io_tasks);
+    DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
+}
+#endif
+
+void dss_kvtrans_publish_meta_cache_stat(kvtrans_ctx_t *ctx)
+{
+#ifndef DSS_BUILD_CUNIT_TEST
+    kvtrans_meta_cache_t *cache = ctx->meta_cache;
+    stat_meta_cache_t *stat = ctx->meta_cache_stat;
+
+    if (!ctx->meta_cache_stat_dirty) return;
+    ctx->meta_cache_stat_dirty = false;
+
+    if (!cache || !stat) return;
+
+    dfly_ustat_set_u64(stat, &stat->hits, cache->hits);
+    dfly_ustat_set_u64(stat, &stat->misses, cache->misses);
+    dfly_ustat_set_u64(stat, &stat->fills, cache->fills);
+    dfly_ustat_set_u64(stat, &stat->evictions, cache->evictions);
+    dfly_ustat_set_u64(stat, &stat->invalidations, cache->invalidations);
+#endif
+}
+
+void dss_kvtrans_batch_end(kvtrans_ctx_t *ctx)
+{
+    DSS_ASSERT(ctx->batch_in_progress);
+    ctx->batch_in_progress = false;
+
+    // Lookups of this batch are counted in the cache, publish them once
+    dss_kvtrans_publish_meta_cache_stat(ctx);
+
+#ifndef DSS_BUILD_CUNIT_TEST
+    blk_ctx_t **staged = ctx->staged_blks;
+    uint32_t n = ctx->num_staged_blks;
+    uint32_t i, start = 0;
+
+    ctx->num_staged_blks = 0;
+    if (n == 0) return;
+
+    // entry index can change after dc table lookup, so sort again
+    qsort(staged, n, sizeof(blk_ctx_t *), _blk_ctx_index_cmp);
+
+    for (i = 1; i <= n; i++) {
+        if (i < n &&
+                staged[i]->index - staged[i - 1]->index <= 1 &&
+                staged[i]->index - staged[start]->index < MAX_BATCH_READ_BLKS &&
+                i - start < MAX_BATCH_READ_BLKS) {
+            continue;
+        }
+        _submit_batch_read(ctx, &staged[start], i - start);
+        start = i;
+    }
+#else
+    ctx->num_staged_blks = 0;
+#endif
+}
+
+#ifndef DSS_BUILD_CUNIT_TEST
+void dss_kvtrans_batch_read_complete(kvtrans_batch_read_t *batch)
+{
+    blk_ctx_t *blk_ctx;
+    uint64_t blk_size;
+    uint32_t i;
+
+    DSS_ASSERT(batch && batch->num_blk_ctx > 0);
+    blk_size = batch->blk_ctx[0]->kreq->kvtrans_ctx->blk_size;
+
+    for (i = 0; i < batch->num_blk_ctx; i++) {
+        blk_ctx = batch->blk_ctx[i];
+        DSS_ASSERT(blk_ctx->index >= batch->lba && blk_ctx->index < batch->lba + batch->nblks);
+        memcpy(blk_ctx->blk, (uint8_t *)batch->buf + (blk_ctx->index - batch->lba) * blk_size, blk_size);
+    }
+}
+
+void dss_kvtrans_free_batch_read(kvtrans_batch_read_t *batch)
+{
+    DSS_ASSERT(batch);
+    spdk_free(batch->buf);
+    free(batch);
+}
+#endif
+
 bool iskreq_healthy(kvtrans_req_t *kreq) {
     req_t req = kreq->req;
     if (!kreq->kvtrans_ctx) return false;
@@ -3047,25 +4914,9 @@ bool iskreq_healthy(kvtrans_req_t *kreq) {
 }
 
 #ifdef DSS_BUILD_CUNIT_TEST
-dss_kvtrans_status_t kv_process(kvtrans_ctx_t *kvtrans_ctx) {
-    dss_kvtrans_status_t rc;
-    kvtrans_req_t *kreq;
-    req_t *req;
-    blk_ctx_t *blk_ctx;
-
-    kreq = STAILQ_FIRST(&kvtrans_ctx->req_head);
-    if (!kreq) {
-        return KVTRANS_STATUS_FREE;
-    }
-    STAILQ_REMOVE_HEAD(&kvtrans_ctx->req_head, req_link);
-
-    if (!iskreq_healthy(kreq)) {
-        printf("ERROR: kreq %zu is damaged\n", kreq->id);
-        return KVTRANS_STATUS_ERROR;
-    }
-
-    req = &kreq->req;
-    blk_ctx = TAILQ_FIRST(&kreq->meta_chain);
+static dss_kvtrans_status_t _kv_process_kreq(kvtrans_ctx_t *kvtrans_ctx, kvtrans_req_t *kreq) {
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_ERROR;
+    req_t *req = &kreq->req;
 
     // printf("receive kreq %zu, opc: %d\n", kreq->id, req->opc);
     switch(req->opc) {
@@ -3093,6 +4944,70 @@ dss_kvtrans_status_t kv_process(kvtrans_ctx_t *kvtrans_ctx) {
 
     return rc;
 }
+
+dss_kvtrans_status_t kv_process(kvtrans_ctx_t *kvtrans_ctx) {
+    kvtrans_req_t *kreq;
+
+    kreq = STAILQ_FIRST(&kvtrans_ctx->req_head);
+    if (!kreq) {
+        return KVTRANS_STATUS_FREE;
+    }
+    STAILQ_REMOVE_HEAD(&kvtrans_ctx->req_head, req_link);
+
+    if (!iskreq_healthy(kreq)) {
+        printf("ERROR: kreq %zu is damaged\n", kreq->id);
+        return KVTRANS_STATUS_ERROR;
+    }
+
+    return _kv_process_kreq(kvtrans_ctx, kreq);
+}
+
+// Process up to batch_size queued requests with one hash pass
+// and in entry blk order. Returns the first failed status if any.
+dss_kvtrans_status_t kv_process_batch(kvtrans_ctx_t *kvtrans_ctx) {
+    dss_kvtrans_status_t rc = KVTRANS_STATUS_SUCCESS;
+    dss_kvtrans_status_t kreq_rc;
+    kvtrans_req_t *kreqs[MAX_KVTRANS_BATCH_SIZE];
+    kvtrans_req_t *new_kreqs[MAX_KVTRANS_BATCH_SIZE];
+    kvtrans_req_t *kreq;
+    uint32_t num_kreqs = 0;
+    uint32_t num_new = 0;
+    uint32_t i;
+
+    while (num_kreqs < kvtrans_ctx->batch_size) {
+        kreq = STAILQ_FIRST(&kvtrans_ctx->req_head);
+        if (!kreq) break;
+        STAILQ_REMOVE_HEAD(&kvtrans_ctx->req_head, req_link);
+
+        if (!iskreq_healthy(kreq)) {
+            printf("ERROR: kreq %zu is damaged\n", kreq->id);
+            return KVTRANS_STATUS_ERROR;
+        }
+        if (kreq->state == REQ_INITIALIZED) {
+            new_kreqs[num_new++] = kreq;
+        }
+        kreqs[num_kreqs++] = kreq;
+    }
+
+    if (num_kreqs == 0) {
+        return KVTRANS_STATUS_FREE;
+    }
+
+    dss_kvtrans_hash_entry_blks(new_kreqs, num_new);
+
+    dss_kvtrans_sort_kreqs(kreqs, num_kreqs);
+
+    dss_kvtrans_batch_begin(kvtrans_ctx);
+    for (i = 0; i < num_kreqs; i++) {
+        kreq_rc = _kv_process_kreq(kvtrans_ctx, kreqs[i]);
+        if (kreq_rc != KVTRANS_STATUS_SUCCESS && rc == KVTRANS_STATUS_SUCCESS) {
+            rc = kreq_rc;
+        }
+    }
+    dss_kvtrans_batch_end(kvtrans_ctx);
+
+    return rc;
+}
 #endif
 
 void dump_blk_ctx(blk_ctx_t *blk_ctx) {
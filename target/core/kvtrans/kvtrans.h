@@ -58,6 +58,10 @@ extern "C" {
 #include "dss.h"
 #include "utils/dss_mallocator.h"
 #include "kvtrans_utils.h"
+#include "kvtrans_meta_cache.h"
+#include "kvtrans_key_filter.h"
+#include "kvtrans_cuckoo.h"
+#include "kvtrans_packed.h"
 #include "dragonfly.h"
 
 #ifdef MEM_BACKEND
@@ -72,13 +76,53 @@ extern "C" {
 // make sure blk_ctx is 4096 Byte
 #define MAX_INLINE_VALUE (1024 - 248)
 #define MIN_HASH_SIZE (8)
-#define DEFAULT_BLOCK_STATE_NUM (9)
+#define DEFAULT_BLOCK_STATE_NUM (12)
 #define DEFAULT_BLK_ALLOC_NAME "block_impresario"
 #define DEFAULT_META_NUM (1000000)
 // A 64 bit value to indicate if meta blk valid
 #define META_MAGIC (0xabc0)
 #define BLK_ALIGN (4096)
 #define DEFAULT_BLK_CTX_CACHE (1024)
+// number of new requests hashed and sorted together. 1 disables batching
+#define DEFAULT_KVTRANS_BATCH_SIZE (1)
+#define MAX_KVTRANS_BATCH_SIZE (256)
+// upper bound of blocks merged into one batched entry read
+#define MAX_BATCH_READ_BLKS (32)
+// number of meta blocks cached per kvtrans instance. 0 disables the cache
+#define DEFAULT_KVTRANS_META_CACHE_BLKS (0)
+// number of keys sized for in the key filter per kvtrans instance. 0 disables the filter
+#define DEFAULT_KVTRANS_KEY_FILTER_KEYS (0)
+// placement of meta blocks, must match the placement the device was formatted with
+#define DEFAULT_KVTRANS_PLACEMENT (KVTRANS_PLACEMENT_CHAIN)
+// meta blocks per bucket in cuckoo placement, also fixed at format time
+#define DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS (4)
+// one in this many usable blocks is given to the cuckoo meta table
+#define KVTRANS_CUCKOO_TABLE_SHARE (4)
+// lookups restarted after keys were relocated under them
+#define KVTRANS_CUCKOO_MAX_RETRIES (4)
+// pack small keys into shared meta blocks, needs cuckoo placement and is fixed at format time
+#define DEFAULT_KVTRANS_PACKED_META (false)
+// LBA ranges scanned in parallel to rebuild the dc table at boot
+#define DEFAULT_KVTRANS_BOOT_RANGES (4)
+#define MAX_KVTRANS_BOOT_RANGES (64)
+// save the dc table on clean stop and load it at boot instead of a scan
+#define DEFAULT_KVTRANS_INDEX_SNAPSHOT (true)
+// block allocator groups, each owned by the first thread allocating from it
+#define DEFAULT_KVTRANS_BA_ALLOC_GROUPS (1)
+#define MAX_KVTRANS_BA_ALLOC_GROUPS (256)
+// meta sync requests sharing one block allocator meta write, 1 disables
+#define DEFAULT_KVTRANS_BA_META_SYNC_GROUP_REQS (1)
+#define MAX_KVTRANS_BA_META_SYNC_GROUP_REQS (64)
+// max wait of a meta sync group before it is written out
+#define DEFAULT_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US (50)
+#define MAX_KVTRANS_BA_META_SYNC_GROUP_WINDOW_US (1000)
+// append allocations to the ba journal instead of rewriting the bitmap
+#define DEFAULT_KVTRANS_BA_JOURNAL (true)
+// keep block allocator states as extents instead of a bitmap in memory
+#define DEFAULT_KVTRANS_BA_EXTENT_TREE (false)
+// blocks per ba size class region, 0 disables size class segregation
+#define DEFAULT_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS (0)
+#define MIN_KVTRANS_BA_SIZE_CLASS_REGION_BLOCKS (1024)
 
 #define CEILING(x,y) (((x) + (y) - 1) / (y))
 
@@ -141,7 +185,11 @@ typedef enum blk_state_e {
     // data block be deleted in DC
     DATA_COLLISION_EMPTY,
     // hash to a CE block
-    DATA_COLLISION_CE
+    DATA_COLLISION_CE,
+    // meta of several small keys, cuckoo placement only
+    PACKED_META,
+    // free blk of the cuckoo meta table, kept from value allocation
+    CUCKOO_FREE
 } blk_state_t;
 
 typedef struct dc_item_s {
@@ -256,6 +304,9 @@ struct blk_ctx {
 
     ondisk_meta_t *blk;
 
+    // blk write queued by the owning request, cached once the request completes
+    bool meta_written;
+
     // should always be the last variable
     TAILQ_ENTRY(blk_ctx) blk_link;
 
@@ -273,6 +324,17 @@ enum hash_type_e {
     spooky = 3
 };
 
+/**
+ *  @brief placement of meta blocks on the device
+ *  chain: a key hashes to an entry block, collisions are chained from it.
+ *  cuckoo: a key is kept in one of two buckets of a table of meta_blk_num
+ *  blocks at the start of the device, values are allocated after the table.
+ */
+enum kvtrans_placement_e {
+    KVTRANS_PLACEMENT_CHAIN = 0,
+    KVTRANS_PLACEMENT_CUCKOO = 1
+};
+
 /**
  *  @brief parameters to config a kvtrans_ctx instance
 */
@@ -294,6 +356,24 @@ typedef struct kvtrans_params_s {
     uint64_t blk_offset;
     uint64_t logi_blk_size;
     uint8_t state_num;
+    // max number of requests processed as one batch
+    uint32_t batch_size;
+    // number of meta blocks to cache in memory
+    uint32_t meta_cache_blks;
+    // number of keys to size the key filter for
+    uint64_t key_filter_keys;
+    enum kvtrans_placement_e placement;
+    uint32_t cuckoo_bucket_blks;
+    // blocks of the cuckoo meta table, 0 to size it from logi_blk_num
+    uint64_t cuckoo_table_blks;
+    // store small keys in PACKED_META blocks
+    bool packed_meta;
+    // region of the index snapshot, 0 blks if not reserved
+    uint64_t snapshot_start_blk;
+    uint64_t snapshot_num_blks;
+    // region of the block allocator journal, 0 blks if not reserved
+    uint64_t ba_journal_start_blk;
+    uint64_t ba_journal_num_blks;
 } kvtrans_params_t;
 
 /**
@@ -318,6 +398,9 @@ typedef struct hash_fn_ctx_s {
     void (*init)(struct hash_fn_ctx_s *hash_fn_ctx);
     void (*update)(const char *key, const uint32_t klen, struct hash_fn_ctx_s *hash_fn_ctx);
     void (*clean)(struct hash_fn_ctx_s *hash_fn_ctx);
+    /* first try hashcode of num_keys keys, leaves ctx cleaned */
+    void (*update_batch)(const char **keys, const uint32_t *klens, uint64_t *out,
+                         uint32_t num_keys, struct hash_fn_ctx_s *hash_fn_ctx);
 } hash_fn_ctx_t;
 
 #if 0
@@ -368,12 +451,37 @@ typedef struct dstat_s {
     counter_t mdc;
     counter_t ce; // overlapped with other stats
     counter_t data_scatter;
+    // merged entry reads and the requests served by them
+    counter_t batch_read;
+    counter_t batch_read_kreq;
+    // lookups completed by the key filter and whether it overflowed
+    counter_t key_filter_neg;
+    counter_t key_filter_overflow;
+    // meta reads issued by lookups and the blocks they cover
+    counter_t meta_read;
+    counter_t meta_read_blks;
+    // keys stored in packed meta blks and the blks holding them
+    counter_t packed_keys;
+    counter_t packed_blks;
     tick_t pre;
     tick_t hash;
     tick_t setkey;
     tick_t setval;
 } dstat_t;
 
+/**
+ *  @brief a merged read of adjacent entry blocks for a batch of requests
+ *  The read is issued through the io_task of the first request (leader).
+ *  On completion each block is copied to the blk_ctx waiting for it.
+ */
+struct kvtrans_batch_read_s {
+    uint64_t lba;
+    uint32_t nblks;
+    uint32_t num_blk_ctx;
+    void *buf;
+    blk_ctx_t *blk_ctx[MAX_BATCH_READ_BLKS];
+};
+
 typedef struct kvtrans_meta_sync_ctx_s {
     // Reference to the parent kvtrans intance
     kvtrans_ctx_t *kvtrans_ctx;
@@ -441,6 +549,31 @@ struct kvtrans_ctx_s {
 
     kvtrans_meta_sync_ctx_t *meta_sync_ctx;
 
+    // entry blocks staged for a merged read while a batch is in progress
+    bool batch_in_progress;
+    uint32_t batch_size;
+    uint32_t num_staged_blks;
+    blk_ctx_t **staged_blks;
+
+    // clean copies of on-disk meta blocks, NULL if disabled
+    kvtrans_meta_cache_t *meta_cache;
+#ifndef DSS_BUILD_CUNIT_TEST
+    stat_meta_cache_t *meta_cache_stat;
+    // cache counters changed since meta_cache_stat was last written
+    bool meta_cache_stat_dirty;
+#endif
+
+    // filter to complete lookups of missing keys without meta io, NULL if disabled
+    kvtrans_key_filter_t *key_filter;
+
+    // cuckoo placement of meta blocks, NULL for chained placement
+    kvtrans_cuckoo_t *cuckoo;
+    // requests waiting for locked buckets
+    STAILQ_HEAD(, kvtrans_req) cuckoo_wait_queue;
+
+    // generation of the last index snapshot read or written
+    uint64_t snapshot_gen;
+
 };
 
 
@@ -456,6 +589,14 @@ void free_dc_table(kvtrans_ctx_t  *ctx);
 kvtrans_ctx_t *init_kvtrans_ctx(kvtrans_params_t *params);
 void free_kvtrans_ctx(kvtrans_ctx_t *ctx);
 
+/**
+ *  @brief Take the free blocks of the cuckoo meta table from the block allocator
+ *  Free table blocks are set to CUCKOO_FREE so value allocations skip them.
+ *  Called once the block allocator state is loaded, nothing to do without
+ *  cuckoo placement.
+ */
+dss_kvtrans_status_t dss_kvtrans_cuckoo_reserve_table(kvtrans_ctx_t *ctx);
+
 kvtrans_req_t *init_kvtrans_req(kvtrans_ctx_t *kvtrans_ctx, req_t *req, kvtrans_req_t *preallocated_req);
 void free_kvtrans_req(kvtrans_req_t *kreq);
 
@@ -472,9 +613,47 @@ dss_kvtrans_status_t dss_kvtrans_load_ondisk_blk(blk_ctx_t *blk_ctx, kvtrans_req
 dss_kvtrans_status_t dss_kvtrans_load_ondisk_data(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq, bool submit_for_disk_io);
 dss_kvtrans_status_t dss_kvtrans_write_ondisk_blk(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq, bool submit_for_disk_io);
 dss_kvtrans_status_t dss_kvtrans_write_ondisk_data(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq, bool submit_for_disk_io);
+dss_kvtrans_status_t dss_kvtrans_write_ondisk_blk_data(blk_ctx_t *blk_ctx, kvtrans_req_t *kreq, bool submit_for_disk_io);
 
 void dss_kvtrans_dump_in_memory_meta(kvtrans_ctx_t *kvt_ctx);
 
+/**
+ *  @brief Hash the keys of new requests to their entry block index
+ *  Consecutive requests of the same kvtrans instance are hashed with one
+ *  update_batch call. The index is kept in the first blk_ctx of each request
+ *  and reused when the request state machine starts.
+ */
+void dss_kvtrans_hash_entry_blks(kvtrans_req_t **kreqs, uint32_t num_kreqs);
+
+/**
+ *  @brief Sort requests by kvtrans instance and entry block index
+ *  All requests should already be hashed by dss_kvtrans_hash_entry_blks.
+ */
+void dss_kvtrans_sort_kreqs(kvtrans_req_t **kreqs, uint32_t num_kreqs);
+
+/**
+ *  @brief Start staging entry block reads instead of submitting them
+ */
+void dss_kvtrans_batch_begin(kvtrans_ctx_t *ctx);
+
+/**
+ *  @brief Merge staged entry block reads with adjacent LBAs and submit them
+ */
+void dss_kvtrans_batch_end(kvtrans_ctx_t *ctx);
+
+/**
+ *  @brief Write meta cache counters to ustat if they changed since the last call
+ */
+void dss_kvtrans_publish_meta_cache_stat(kvtrans_ctx_t *ctx);
+
+/**
+ *  @brief Distribute data of a completed merged read to the waiting blk_ctx
+ *  The caller should continue processing all requests in the batch read
+ *  and then release it with dss_kvtrans_free_batch_read.
+ */
+void dss_kvtrans_batch_read_complete(kvtrans_batch_read_t *batch);
+void dss_kvtrans_free_batch_read(kvtrans_batch_read_t *batch);
+
 dss_kvtrans_status_t dss_kvtrans_init_meta_sync_ctx(kvtrans_ctx_t *kvt_ctx);
 void dss_kvtrans_free_meta_sync_ctx(kvtrans_meta_sync_ctx_t *meta_sync_ctx);
 
@@ -485,6 +664,7 @@ async_kvtrans_fn kvtrans_retrieve;
 async_kvtrans_fn kvtrans_delete;
 async_kvtrans_fn kvtrans_exist;
 dss_kvtrans_status_t kv_process(kvtrans_ctx_t *ctx);
+dss_kvtrans_status_t kv_process_batch(kvtrans_ctx_t *ctx);
 
 int dss_kvtrans_handle_request(kvtrans_ctx_t *ctx, req_t *req);
 void dss_kvtrans_check_all_empty(kvtrans_ctx_t *ctx);
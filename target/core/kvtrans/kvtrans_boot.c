@@ -0,0 +1,122 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+
+#include "kvtrans_boot.h"
+
+int kvtrans_boot_batch_init(kvtrans_boot_batch_t *batch, uint32_t max_blks,
+                            uint32_t max_io_blks, uint32_t max_gap_blks)
+{
+    batch->max_blks = max_blks;
+    batch->max_io_blks = max_io_blks;
+    batch->max_gap_blks = max_gap_blks;
+    batch->extents = (kvtrans_boot_extent_t *) calloc(max_blks, sizeof(kvtrans_boot_extent_t));
+    batch->blks = (kvtrans_boot_blk_t *) calloc(max_blks, sizeof(kvtrans_boot_blk_t));
+    if (!batch->extents || !batch->blks) {
+        kvtrans_boot_batch_free(batch);
+        return -1;
+    }
+    kvtrans_boot_batch_reset(batch);
+
+    return 0;
+}
+
+void kvtrans_boot_batch_free(kvtrans_boot_batch_t *batch)
+{
+    free(batch->extents);
+    free(batch->blks);
+    batch->extents = NULL;
+    batch->blks = NULL;
+}
+
+void kvtrans_boot_batch_reset(kvtrans_boot_batch_t *batch)
+{
+    batch->num_buf_blks = 0;
+    batch->num_extents = 0;
+    batch->num_blks = 0;
+}
+
+bool kvtrans_boot_batch_add(kvtrans_boot_batch_t *batch, uint64_t lba, uint32_t state)
+{
+    kvtrans_boot_extent_t *ext = NULL;
+    kvtrans_boot_blk_t *blk;
+    uint64_t next_lba;
+    uint64_t gap;
+
+    if (batch->num_extents > 0) {
+        ext = &batch->extents[batch->num_extents - 1];
+        next_lba = ext->lba + ext->num_blks;
+        gap = lba - next_lba;
+        if (lba < next_lba || gap > batch->max_gap_blks ||
+                ext->num_blks + gap + 1 > batch->max_io_blks) {
+            ext = NULL;
+        } else if (batch->num_buf_blks + gap + 1 > batch->max_blks) {
+            return false;
+        }
+    }
+
+    if (ext) {
+        // read through the gap
+        ext->num_blks += gap + 1;
+        batch->num_buf_blks += gap + 1;
+    } else {
+        if (batch->num_buf_blks + 1 > batch->max_blks) {
+            return false;
+        }
+        ext = &batch->extents[batch->num_extents++];
+        ext->lba = lba;
+        ext->num_blks = 1;
+        ext->buf_idx = batch->num_buf_blks;
+        batch->num_buf_blks++;
+    }
+
+    blk = &batch->blks[batch->num_blks++];
+    blk->lba = lba;
+    blk->buf_idx = ext->buf_idx + (uint32_t) (lba - ext->lba);
+    blk->state = state;
+
+    return true;
+}
+
+void kvtrans_boot_split_range(uint64_t blk_offset, uint64_t blk_num,
+                              uint32_t num_ranges, uint32_t idx,
+                              uint64_t *start, uint64_t *end)
+{
+    uint64_t range_blks = blk_num / num_ranges;
+    uint64_t rem = blk_num % num_ranges;
+
+    // the first rem ranges take one more blk
+    *start = blk_offset + idx * range_blks + (idx < rem ? idx : rem);
+    *end = *start + range_blks + (idx < rem ? 1 : 0);
+}
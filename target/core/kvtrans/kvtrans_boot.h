@@ -0,0 +1,121 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_BOOT_H
+#define KVTRANS_BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// blocks of the read buffer of one range
+#define KVTRANS_BOOT_BUF_BLKS (512)
+// upper bound of blocks of one read
+#define KVTRANS_BOOT_MAX_IO_BLKS (64)
+// unneeded blocks read through to merge two reads into one
+#define KVTRANS_BOOT_MAX_GAP_BLKS (8)
+
+/**
+ *  @brief One sequential read of a boot batch
+ */
+typedef struct kvtrans_boot_extent_s {
+    uint64_t lba;
+    uint32_t num_blks;
+    // first blk of the extent in the batch buffer
+    uint32_t buf_idx;
+} kvtrans_boot_extent_t;
+
+/**
+ *  @brief A blk needed at boot and its place in the batch buffer
+ */
+typedef struct kvtrans_boot_blk_s {
+    uint64_t lba;
+    uint32_t buf_idx;
+    uint32_t state;
+} kvtrans_boot_blk_t;
+
+/**
+ *  @brief A batch of blks coalesced into sequential reads
+ *  Needed blks are added in increasing lba order. A blk close enough
+ *  to the previous extent extends it, reading the gap in between.
+ */
+typedef struct kvtrans_boot_batch_s {
+    uint32_t max_blks;
+    uint32_t max_io_blks;
+    uint32_t max_gap_blks;
+    // buffer blks used by extents
+    uint32_t num_buf_blks;
+    uint32_t num_extents;
+    kvtrans_boot_extent_t *extents;
+    uint32_t num_blks;
+    kvtrans_boot_blk_t *blks;
+} kvtrans_boot_batch_t;
+
+/**
+ *  @brief Allocate a batch with a buffer of max_blks
+ *
+ *  @return 0 on success, -1 on allocation failure
+ */
+int kvtrans_boot_batch_init(kvtrans_boot_batch_t *batch, uint32_t max_blks,
+                            uint32_t max_io_blks, uint32_t max_gap_blks);
+
+void kvtrans_boot_batch_free(kvtrans_boot_batch_t *batch);
+
+void kvtrans_boot_batch_reset(kvtrans_boot_batch_t *batch);
+
+/**
+ *  @brief Add a needed blk, lba must be above the last added one
+ *
+ *  @return true if added, false if the batch is full
+ */
+bool kvtrans_boot_batch_add(kvtrans_boot_batch_t *batch, uint64_t lba, uint32_t state);
+
+/**
+ *  @brief Split [blk_offset, blk_offset + blk_num) into num_ranges ranges
+ *
+ *  @param idx index of the range to get
+ *  @param start first lba of the range
+ *  @param end one past the last lba of the range, equals start for an empty range
+ */
+void kvtrans_boot_split_range(uint64_t blk_offset, uint64_t blk_num,
+                              uint32_t num_ranges, uint32_t idx,
+                              uint64_t *start, uint64_t *end);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "kvtrans_cuckoo.h"
+#include "hash/xxhash.h"
+
+#define CUCKOO_SEED (0x6d657461)
+
+kvtrans_cuckoo_t *kvtrans_cuckoo_init(uint64_t start_blk, uint64_t num_blks, uint32_t bucket_blks)
+{
+    kvtrans_cuckoo_t *cuckoo;
+    uint64_t num_buckets;
+
+    if (bucket_blks == 0 || bucket_blks > KVTRANS_CUCKOO_MAX_BUCKET_BLKS) {
+        return NULL;
+    }
+
+    num_buckets = num_blks / bucket_blks;
+    if (num_buckets < 2) {
+        return NULL;
+    }
+
+    cuckoo = (kvtrans_cuckoo_t *) calloc(1, sizeof(kvtrans_cuckoo_t));
+    if (!cuckoo) {
+        return NULL;
+    }
+
+    cuckoo->lock_bits = (uint64_t *) calloc((num_buckets + 63) / 64, sizeof(uint64_t));
+    if (!cuckoo->lock_bits) {
+        free(cuckoo);
+        return NULL;
+    }
+    cuckoo->start_blk = start_blk;
+    cuckoo->num_buckets = num_buckets;
+    cuckoo->bucket_blks = bucket_blks;
+
+    return cuckoo;
+}
+
+void kvtrans_cuckoo_free(kvtrans_cuckoo_t *cuckoo)
+{
+    if (!cuckoo) return;
+
+    free(cuckoo->lock_bits);
+    free(cuckoo);
+}
+
+void kvtrans_cuckoo_get_buckets(kvtrans_cuckoo_t *cuckoo, const char *key, uint32_t klen,
+                                uint64_t *b1, uint64_t *b2)
+{
+    uint64_t h = XXH64(key, klen, CUCKOO_SEED);
+    uint64_t n = cuckoo->num_buckets;
+
+    *b1 = h % n;
+    // a non-zero offset keeps the two buckets distinct
+    *b2 = (*b1 + 1 + (h >> 32) % (n - 1)) % n;
+}
+
+uint64_t kvtrans_cuckoo_alt_bucket(kvtrans_cuckoo_t *cuckoo, const char *key, uint32_t klen,
+                                   uint64_t bucket)
+{
+    uint64_t b1, b2;
+
+    kvtrans_cuckoo_get_buckets(cuckoo, key, klen, &b1, &b2);
+    return bucket == b1 ? b2 : b1;
+}
+
+bool kvtrans_cuckoo_lock(kvtrans_cuckoo_t *cuckoo, const uint64_t *buckets, uint32_t num_buckets)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_buckets; i++) {
+        if (kvtrans_cuckoo_is_locked(cuckoo, buckets[i])) {
+            return false;
+        }
+    }
+
+    for (i = 0; i < num_buckets; i++) {
+        cuckoo->lock_bits[buckets[i] >> 6] |= 1ULL << (buckets[i] & 63);
+    }
+    return true;
+}
+
+void kvtrans_cuckoo_unlock(kvtrans_cuckoo_t *cuckoo, const uint64_t *buckets, uint32_t num_buckets)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_buckets; i++) {
+        cuckoo->lock_bits[buckets[i] >> 6] &= ~(1ULL << (buckets[i] & 63));
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_CUCKOO_H
+#define KVTRANS_CUCKOO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// upper bound of meta blocks per bucket, one bucket is read with one io
+#define KVTRANS_CUCKOO_MAX_BUCKET_BLKS (8)
+
+/**
+ *  @brief Bucketized cuckoo placement of meta blocks
+ *  The meta table is a range of contiguous blocks split into buckets of
+ *  bucket_blks blocks. A key is stored in a META block of one of its two
+ *  candidate buckets, so a lookup reads at most two buckets.
+ *  Stores and deletes lock both candidate buckets of their key, and the
+ *  alternate bucket of a key they relocate, while their io is in flight.
+ */
+typedef struct kvtrans_cuckoo_s {
+    uint64_t start_blk;
+    uint64_t num_buckets;
+    uint32_t bucket_blks;
+    // bumped whenever a key moves to its alternate bucket
+    uint64_t generation;
+    // one bit per bucket
+    uint64_t *lock_bits;
+
+    uint64_t relocations;
+    uint64_t insert_failures;
+    uint64_t lookup_retries;
+} kvtrans_cuckoo_t;
+
+/**
+ *  @brief Create a cuckoo placement context
+ *
+ *  @param start_blk first block of the meta table
+ *  @param num_blks number of blocks of the meta table, rounded down to whole buckets
+ *  @param bucket_blks blocks per bucket, at most KVTRANS_CUCKOO_MAX_BUCKET_BLKS
+ *  @return placement context, NULL if the table has less than two buckets or on failure
+ */
+kvtrans_cuckoo_t *kvtrans_cuckoo_init(uint64_t start_blk, uint64_t num_blks, uint32_t bucket_blks);
+
+/**
+ *  @brief Free a cuckoo placement context
+ */
+void kvtrans_cuckoo_free(kvtrans_cuckoo_t *cuckoo);
+
+/**
+ *  @brief Get the two distinct candidate buckets of a key
+ */
+void kvtrans_cuckoo_get_buckets(kvtrans_cuckoo_t *cuckoo, const char *key, uint32_t klen,
+                                uint64_t *b1, uint64_t *b2);
+
+/**
+ *  @brief Get the other candidate bucket of a key stored in bucket
+ */
+uint64_t kvtrans_cuckoo_alt_bucket(kvtrans_cuckoo_t *cuckoo, const char *key, uint32_t klen,
+                                   uint64_t bucket);
+
+/**
+ *  @brief Lock all given buckets, or none if any of them is locked
+ *
+ *  @return true if all buckets were locked
+ */
+bool kvtrans_cuckoo_lock(kvtrans_cuckoo_t *cuckoo, const uint64_t *buckets, uint32_t num_buckets);
+
+/**
+ *  @brief Unlock buckets locked with kvtrans_cuckoo_lock
+ */
+void kvtrans_cuckoo_unlock(kvtrans_cuckoo_t *cuckoo, const uint64_t *buckets, uint32_t num_buckets);
+
+static inline bool kvtrans_cuckoo_is_locked(kvtrans_cuckoo_t *cuckoo, uint64_t bucket)
+{
+    return (cuckoo->lock_bits[bucket >> 6] >> (bucket & 63)) & 1;
+}
+
+static inline uint64_t kvtrans_cuckoo_bucket_lba(kvtrans_cuckoo_t *cuckoo, uint64_t bucket)
+{
+    return cuckoo->start_blk + bucket * cuckoo->bucket_blks;
+}
+
+static inline bool kvtrans_cuckoo_has_blk(kvtrans_cuckoo_t *cuckoo, uint64_t lba)
+{
+    return lba >= cuckoo->start_blk && lba < kvtrans_cuckoo_bucket_lba(cuckoo, cuckoo->num_buckets);
+}
+
+/**
+ *  @brief First block after the meta table, where value blocks are allocated from
+ */
+static inline uint64_t kvtrans_cuckoo_end_lba(kvtrans_cuckoo_t *cuckoo)
+{
+    return kvtrans_cuckoo_bucket_lba(cuckoo, cuckoo->num_buckets);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -71,6 +71,25 @@ static uint8_t first_call(hash_fn_ctx_t *hash_fn_ctx)
     return hash_fn_ctx->tryout == 0;
 }
 
+static inline uint64_t rotate_hash_buf(uint32_t hash_buf, int bit_shift, uint16_t hash_size)
+{
+    return (uint32_t) (hash_buf << bit_shift) | (hash_buf >> (hash_size - bit_shift));
+}
+
+/* batch of keys through the single key update, for hash types without a batch kernel */
+void HASH_update_batch(const char **keys, const uint32_t *klens, uint64_t *out,
+                       uint32_t num_keys, hash_fn_ctx_t *hash_fn_ctx)
+{
+    uint32_t i;
+
+    for (i = 0; i < num_keys; i++) {
+        hash_fn_ctx->clean(hash_fn_ctx);
+        hash_fn_ctx->update(keys[i], klens[i], hash_fn_ctx);
+        out[i] = hash_fn_ctx->hashcode;
+    }
+    hash_fn_ctx->clean(hash_fn_ctx);
+}
+
 void SHA256_init(hash_fn_ctx_t *hash_fn_ctx) 
 {   
     assert(hash_fn_ctx);
@@ -116,6 +135,8 @@ void SHA256_clean(hash_fn_ctx_t *hash_fn_ctx)
 {   
     hash_fn_ctx->tryout = 0;
     memset(hash_fn_ctx->buf, 0, SHA256_BLOCK_SIZE * sizeof(BYTE)); 
+    // sha256_final does not reset the state, start over for the next key
+    sha256_init((SHA256_CTX*) hash_fn_ctx->sha256_ctx);
 }
 
 
@@ -132,11 +153,26 @@ void XXHASH_update(const char *key, const uint32_t klen, hash_fn_ctx_t *hash_fn_
     if (first_call(hash_fn_ctx)) {
         hash_fn_ctx->hash_buf = (uint32_t) XXH32(key, klen, hash_fn_ctx->seed);
     }
-    hash_fn_ctx->hashcode = (uint32_t) (hash_fn_ctx->hash_buf << bit_shift)
-                        | (hash_fn_ctx->hash_buf >> (hash_fn_ctx->hash_size - bit_shift));
+    hash_fn_ctx->hashcode = rotate_hash_buf(hash_fn_ctx->hash_buf, bit_shift, hash_fn_ctx->hash_size);
     hash_fn_ctx->tryout++;
 }
 
+void XXHASH_update_batch(const char **keys, const uint32_t *klens, uint64_t *out,
+                         uint32_t num_keys, hash_fn_ctx_t *hash_fn_ctx)
+{
+    uint32_t hash_buf[XXHASH_BATCH_CHUNK];
+    uint32_t i, j, n;
+
+    for (i = 0; i < num_keys; i += n) {
+        n = num_keys - i < XXHASH_BATCH_CHUNK ? num_keys - i : XXHASH_BATCH_CHUNK;
+        xxh32_batch(&keys[i], &klens[i], n, hash_fn_ctx->seed, hash_buf);
+        for (j = 0; j < n; j++) {
+            out[i + j] = rotate_hash_buf(hash_buf[j], 0, hash_fn_ctx->hash_size);
+        }
+    }
+    XXHASH_clean(hash_fn_ctx);
+}
+
 void XXHASH_clean(hash_fn_ctx_t *hash_fn_ctx)
 {
     hash_fn_ctx->tryout = 0;
@@ -155,8 +191,7 @@ void SPOOKY_update(const char *key, const uint32_t klen, hash_fn_ctx_t *hash_fn_
     if (first_call(hash_fn_ctx)) {
         hash_fn_ctx->hash_buf = (uint32_t) spooky_hash32(key, klen, hash_fn_ctx->seed);
     }
-    hash_fn_ctx->hashcode = (uint32_t) (hash_fn_ctx->hash_buf << bit_shift) 
-                        | (hash_fn_ctx->hash_buf >> (hash_fn_ctx->hash_size - bit_shift));
+    hash_fn_ctx->hashcode = rotate_hash_buf(hash_fn_ctx->hash_buf, bit_shift, hash_fn_ctx->hash_size);
     hash_fn_ctx->tryout++;
 }
 
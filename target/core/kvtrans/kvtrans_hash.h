@@ -41,9 +41,16 @@ extern "C" {
 #include "kvtrans.h"
 #include "hash/sha256.h"
 #include "hash/xxhash.h"
+#include "hash/xxhash_batch.h"
 #include "hash/spooky.h"
 
 #define RNG_SEED 321123321
+/* keys hashed per xxh32_batch call */
+#define XXHASH_BATCH_CHUNK (64)
+
+/* any hash type, one key at a time */
+void HASH_update_batch(const char **keys, const uint32_t *klens, uint64_t *out,
+                       uint32_t num_keys, hash_fn_ctx_t *hash_fn_ctx);
 
 /* 256 bit hash */
 void SHA256_init(hash_fn_ctx_t *hash_fn_ctx);
@@ -54,6 +61,8 @@ void SHA256_clean(hash_fn_ctx_t *hash_fn_ctx);
 /* 32 bit hash */
 void XXHASH_init(hash_fn_ctx_t *hash_fn_ctx);
 void XXHASH_update(const char *key, const uint32_t klen, hash_fn_ctx_t *hash_fn_ctx);
+void XXHASH_update_batch(const char **keys, const uint32_t *klens, uint64_t *out,
+                         uint32_t num_keys, hash_fn_ctx_t *hash_fn_ctx);
 void XXHASH_clean(hash_fn_ctx_t *hash_fn_ctx);
 void SPOOKY_init(hash_fn_ctx_t *hash_fn_ctx);
 void SPOOKY_update(const char *key, const uint32_t klen, hash_fn_ctx_t *hash_fn_ctx);
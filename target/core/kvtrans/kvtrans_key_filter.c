@@ -0,0 +1,219 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "kvtrans_key_filter.h"
+#include "hash/xxhash.h"
+
+#define KEY_FILTER_SEED (0x6b657973)
+
+static inline uint16_t *_bucket(kvtrans_key_filter_t *filter, uint64_t i)
+{
+    return &filter->buckets[i * KEY_FILTER_BUCKET_SIZE];
+}
+
+static inline void _key_hash(kvtrans_key_filter_t *filter, const char *key, uint32_t klen,
+                             uint64_t *i1, uint16_t *fp)
+{
+    uint64_t h = XXH64(key, klen, KEY_FILTER_SEED);
+
+    *i1 = h & filter->bucket_mask;
+    *fp = (uint16_t)(h >> 48);
+    // 0 marks an empty slot
+    if (*fp == 0) *fp = 1;
+}
+
+// partial-key cuckoo hashing: each bucket of a pair is derived from the other one
+static inline uint64_t _alt_index(kvtrans_key_filter_t *filter, uint64_t i, uint16_t fp)
+{
+    return (i ^ (fp * 0x5bd1e995ULL)) & filter->bucket_mask;
+}
+
+static bool _bucket_insert(kvtrans_key_filter_t *filter, uint64_t i, uint16_t fp)
+{
+    uint16_t *b = _bucket(filter, i);
+    int j;
+
+    for (j = 0; j < KEY_FILTER_BUCKET_SIZE; j++) {
+        if (b[j] == 0) {
+            b[j] = fp;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool _bucket_contains(kvtrans_key_filter_t *filter, uint64_t i, uint16_t fp)
+{
+    uint16_t *b = _bucket(filter, i);
+    int j;
+
+    for (j = 0; j < KEY_FILTER_BUCKET_SIZE; j++) {
+        if (b[j] == fp) return true;
+    }
+    return false;
+}
+
+static bool _bucket_delete(kvtrans_key_filter_t *filter, uint64_t i, uint16_t fp)
+{
+    uint16_t *b = _bucket(filter, i);
+    int j;
+
+    for (j = 0; j < KEY_FILTER_BUCKET_SIZE; j++) {
+        if (b[j] == fp) {
+            b[j] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+kvtrans_key_filter_t *kvtrans_key_filter_init(uint64_t num_keys)
+{
+    kvtrans_key_filter_t *filter;
+    uint64_t num_buckets = 1;
+
+    if (num_keys == 0) {
+        return NULL;
+    }
+
+    // keep the load factor below 95%, where inserts start to fail
+    while (num_buckets * KEY_FILTER_BUCKET_SIZE * 19 / 20 < num_keys) {
+        num_buckets <<= 1;
+    }
+
+    filter = (kvtrans_key_filter_t *) calloc(1, sizeof(kvtrans_key_filter_t));
+    if (!filter) {
+        return NULL;
+    }
+
+    filter->buckets = (uint16_t *) calloc(num_buckets * KEY_FILTER_BUCKET_SIZE, sizeof(uint16_t));
+    if (!filter->buckets) {
+        free(filter);
+        return NULL;
+    }
+    filter->num_buckets = num_buckets;
+    filter->bucket_mask = num_buckets - 1;
+
+    return filter;
+}
+
+void kvtrans_key_filter_free(kvtrans_key_filter_t *filter)
+{
+    if (!filter) return;
+
+    free(filter->buckets);
+    free(filter);
+}
+
+void kvtrans_key_filter_reset(kvtrans_key_filter_t *filter)
+{
+    memset(filter->buckets, 0, filter->num_buckets * KEY_FILTER_BUCKET_SIZE * sizeof(uint16_t));
+    filter->num_items = 0;
+    filter->overflow = false;
+}
+
+bool kvtrans_key_filter_insert(kvtrans_key_filter_t *filter, const char *key, uint32_t klen)
+{
+    uint64_t i1, i;
+    uint16_t fp, victim;
+    uint16_t *b;
+    int n, j;
+
+    if (filter->overflow) {
+        return false;
+    }
+
+    _key_hash(filter, key, klen, &i1, &fp);
+    if (_bucket_insert(filter, i1, fp) ||
+            _bucket_insert(filter, _alt_index(filter, i1, fp), fp)) {
+        filter->num_items++;
+        return true;
+    }
+
+    // both buckets are full, relocate fingerprints until one finds a free slot
+    i = (filter->victim_seed & 1) ? i1 : _alt_index(filter, i1, fp);
+    for (n = 0; n < KEY_FILTER_MAX_KICKS; n++) {
+        j = filter->victim_seed++ % KEY_FILTER_BUCKET_SIZE;
+        b = _bucket(filter, i);
+        victim = b[j];
+        b[j] = fp;
+        fp = victim;
+        i = _alt_index(filter, i, fp);
+        if (_bucket_insert(filter, i, fp)) {
+            filter->num_items++;
+            return true;
+        }
+    }
+
+    // the last victim is lost, the filter can't tell absent keys anymore
+    filter->overflow = true;
+    return false;
+}
+
+void kvtrans_key_filter_delete(kvtrans_key_filter_t *filter, const char *key, uint32_t klen)
+{
+    uint64_t i1;
+    uint16_t fp;
+
+    if (filter->overflow) {
+        return;
+    }
+
+    _key_hash(filter, key, klen, &i1, &fp);
+    if (_bucket_delete(filter, i1, fp) ||
+            _bucket_delete(filter, _alt_index(filter, i1, fp), fp)) {
+        filter->num_items--;
+    }
+}
+
+bool kvtrans_key_filter_may_contain(kvtrans_key_filter_t *filter, const char *key, uint32_t klen)
+{
+    uint64_t i1;
+    uint16_t fp;
+
+    if (filter->overflow) {
+        return true;
+    }
+
+    _key_hash(filter, key, klen, &i1, &fp);
+    if (_bucket_contains(filter, i1, fp) ||
+            _bucket_contains(filter, _alt_index(filter, i1, fp), fp)) {
+        return true;
+    }
+
+    filter->negatives++;
+    return false;
+}
@@ -0,0 +1,110 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_KEY_FILTER_H
+#define KVTRANS_KEY_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// fingerprints per bucket
+#define KEY_FILTER_BUCKET_SIZE (4)
+// relocations tried before an insert gives up
+#define KEY_FILTER_MAX_KICKS (500)
+
+/**
+ *  @brief Cuckoo filter of the keys stored in a kvtrans instance
+ *  Answers whether a key is definitely absent, so that lookups of missing
+ *  keys can complete without reading meta blocks. Each key is kept as a
+ *  16 bit fingerprint in one of two candidate buckets.
+ *  A key must only be deleted if it was inserted before.
+ *  Once an insert fails the filter can no longer rule out any key.
+ */
+typedef struct kvtrans_key_filter_s {
+    uint64_t num_buckets;
+    uint64_t bucket_mask;
+    uint16_t *buckets;
+    uint64_t num_items;
+    uint32_t victim_seed;
+    // an insert failed, every key may be present
+    bool overflow;
+
+    uint64_t negatives;
+} kvtrans_key_filter_t;
+
+/**
+ *  @brief Create a key filter
+ *
+ *  @param num_keys expected number of keys, buckets are rounded up to a power of 2
+ *  @return filter context, NULL on failure
+ */
+kvtrans_key_filter_t *kvtrans_key_filter_init(uint64_t num_keys);
+
+/**
+ *  @brief Free a key filter
+ */
+void kvtrans_key_filter_free(kvtrans_key_filter_t *filter);
+
+/**
+ *  @brief Drop all keys and clear the overflow state
+ */
+void kvtrans_key_filter_reset(kvtrans_key_filter_t *filter);
+
+/**
+ *  @brief Add a key to the filter
+ *
+ *  @return true on success, false if the filter is full
+ */
+bool kvtrans_key_filter_insert(kvtrans_key_filter_t *filter, const char *key, uint32_t klen);
+
+/**
+ *  @brief Remove a key added with kvtrans_key_filter_insert
+ */
+void kvtrans_key_filter_delete(kvtrans_key_filter_t *filter, const char *key, uint32_t klen);
+
+/**
+ *  @brief Check if a key may be stored
+ *
+ *  @return false if the key is definitely absent, true otherwise
+ */
+bool kvtrans_key_filter_may_contain(kvtrans_key_filter_t *filter, const char *key, uint32_t klen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
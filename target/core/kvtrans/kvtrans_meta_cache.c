@@ -0,0 +1,211 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "kvtrans_meta_cache.h"
+
+static inline uint32_t _seq_bucket(uint64_t index)
+{
+    return (uint32_t)(index & (META_CACHE_SEQ_BUCKETS - 1));
+}
+
+static inline void *_slot_blk(kvtrans_meta_cache_t *cache, uint32_t slot)
+{
+    return cache->blks + (uint64_t)slot * cache->blk_size;
+}
+
+static inline Word_t *_get_slot(kvtrans_meta_cache_t *cache, uint64_t index)
+{
+    return (Word_t *)JudyLGet(cache->slot_map, index, PJE0);
+}
+
+static void _remove_slot(kvtrans_meta_cache_t *cache, uint32_t slot)
+{
+    int rc;
+
+    rc = JudyLDel(&cache->slot_map, cache->slots[slot].index, PJE0);
+    assert(rc == 1);
+    cache->slots[slot].index = 0;
+    cache->slots[slot].referenced = false;
+}
+
+// Advance the clock hand to a free slot or to the first unreferenced one
+static uint32_t _get_victim_slot(kvtrans_meta_cache_t *cache)
+{
+    kvtrans_meta_cache_slot_t *s;
+    uint32_t slot;
+
+    while (true) {
+        slot = cache->hand;
+        cache->hand = (cache->hand + 1) % cache->num_slots;
+        s = &cache->slots[slot];
+        if (s->index == 0) {
+            return slot;
+        }
+        if (s->referenced) {
+            s->referenced = false;
+            continue;
+        }
+        _remove_slot(cache, slot);
+        cache->evictions++;
+        return slot;
+    }
+}
+
+static void _insert(kvtrans_meta_cache_t *cache, uint64_t index, const void *blk)
+{
+    Word_t *pslot;
+    uint32_t slot;
+
+    pslot = _get_slot(cache, index);
+    if (pslot) {
+        slot = (uint32_t)*pslot;
+    } else {
+        slot = _get_victim_slot(cache);
+        pslot = (Word_t *)JudyLIns(&cache->slot_map, index, PJE0);
+        assert(pslot != PJERR);
+        *pslot = slot;
+        cache->slots[slot].index = index;
+        cache->slots[slot].referenced = false;
+    }
+    memcpy(_slot_blk(cache, slot), blk, cache->blk_size);
+}
+
+kvtrans_meta_cache_t *kvtrans_meta_cache_init(uint32_t num_blks, uint64_t blk_size)
+{
+    kvtrans_meta_cache_t *cache;
+
+    if (num_blks == 0 || blk_size == 0) {
+        return NULL;
+    }
+
+    cache = (kvtrans_meta_cache_t *) calloc(1, sizeof(kvtrans_meta_cache_t));
+    if (!cache) {
+        return NULL;
+    }
+
+    cache->num_slots = num_blks;
+    cache->blk_size = blk_size;
+    cache->slots = (kvtrans_meta_cache_slot_t *) calloc(num_blks, sizeof(kvtrans_meta_cache_slot_t));
+    cache->blks = (uint8_t *) malloc((uint64_t)num_blks * blk_size);
+    if (!cache->slots || !cache->blks) {
+        kvtrans_meta_cache_free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void kvtrans_meta_cache_free(kvtrans_meta_cache_t *cache)
+{
+    if (!cache) return;
+
+    JudyLFreeArray(&cache->slot_map, PJE0);
+    free(cache->slots);
+    free(cache->blks);
+    free(cache);
+}
+
+bool kvtrans_meta_cache_lookup(kvtrans_meta_cache_t *cache, uint64_t index, void *blk)
+{
+    Word_t *pslot;
+
+    pslot = _get_slot(cache, index);
+    if (!pslot) {
+        cache->misses++;
+        return false;
+    }
+
+    cache->slots[*pslot].referenced = true;
+    memcpy(blk, _slot_blk(cache, (uint32_t)*pslot), cache->blk_size);
+    cache->hits++;
+    return true;
+}
+
+uint32_t kvtrans_meta_cache_get_seq(kvtrans_meta_cache_t *cache, uint64_t index)
+{
+    return cache->seq[_seq_bucket(index)];
+}
+
+bool kvtrans_meta_cache_fill(kvtrans_meta_cache_t *cache, uint64_t index, const void *blk, uint32_t seq)
+{
+    if (cache->seq[_seq_bucket(index)] != seq) {
+        return false;
+    }
+
+    _insert(cache, index, blk);
+    cache->fills++;
+    return true;
+}
+
+void kvtrans_meta_cache_update(kvtrans_meta_cache_t *cache, uint64_t index, const void *blk)
+{
+    // reads in flight may return data older than this block
+    cache->seq[_seq_bucket(index)]++;
+    _insert(cache, index, blk);
+}
+
+void kvtrans_meta_cache_invalidate(kvtrans_meta_cache_t *cache, uint64_t index)
+{
+    Word_t *pslot;
+
+    cache->seq[_seq_bucket(index)]++;
+    pslot = _get_slot(cache, index);
+    if (pslot) {
+        _remove_slot(cache, (uint32_t)*pslot);
+        cache->invalidations++;
+    }
+}
+
+void kvtrans_meta_cache_invalidate_range(kvtrans_meta_cache_t *cache, uint64_t index, uint64_t num_blks)
+{
+    Word_t idx = index;
+    Word_t *pslot;
+    uint64_t i;
+
+    if (num_blks == 0) return;
+
+    for (i = 0; i < num_blks && i < META_CACHE_SEQ_BUCKETS; i++) {
+        cache->seq[_seq_bucket(index + i)]++;
+    }
+
+    pslot = (Word_t *)JudyLFirst(cache->slot_map, &idx, PJE0);
+    while (pslot && idx < index + num_blks) {
+        _remove_slot(cache, (uint32_t)*pslot);
+        cache->invalidations++;
+        pslot = (Word_t *)JudyLNext(cache->slot_map, &idx, PJE0);
+    }
+}
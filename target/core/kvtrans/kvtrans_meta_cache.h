@@ -0,0 +1,136 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_META_CACHE_H
+#define KVTRANS_META_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <Judy.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// number of invalidation sequence buckets, power of 2
+#define META_CACHE_SEQ_BUCKETS (1024)
+
+typedef struct kvtrans_meta_cache_slot_s {
+    // block index cached in the slot, 0 if the slot is free
+    uint64_t index;
+    // set on hit, cleared when the clock hand passes
+    bool referenced;
+} kvtrans_meta_cache_slot_t;
+
+/**
+ *  @brief Bounded cache of on-disk meta blocks keyed by block index
+ *  Replacement follows the CLOCK algorithm. A block read from disk is only
+ *  filled into the cache if no write to a block of the same sequence bucket
+ *  completed while the read was in flight.
+ */
+typedef struct kvtrans_meta_cache_s {
+    uint32_t num_slots;
+    uint32_t hand;
+    uint64_t blk_size;
+    // JudyL array to map block index to slot
+    Pvoid_t slot_map;
+    kvtrans_meta_cache_slot_t *slots;
+    uint8_t *blks;
+    uint32_t seq[META_CACHE_SEQ_BUCKETS];
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t fills;
+    uint64_t evictions;
+    uint64_t invalidations;
+} kvtrans_meta_cache_t;
+
+/**
+ *  @brief Create a meta block cache
+ *
+ *  @param num_blks maximum number of cached blocks
+ *  @param blk_size size of one meta block in bytes
+ *  @return cache context, NULL on failure
+ */
+kvtrans_meta_cache_t *kvtrans_meta_cache_init(uint32_t num_blks, uint64_t blk_size);
+
+/**
+ *  @brief Free a meta block cache and all cached blocks
+ */
+void kvtrans_meta_cache_free(kvtrans_meta_cache_t *cache);
+
+/**
+ *  @brief Copy a cached block to blk
+ *
+ *  @param cache cache context
+ *  @param index block index
+ *  @param[OUT] blk buffer of blk_size bytes
+ *  @return true on hit, false on miss
+ */
+bool kvtrans_meta_cache_lookup(kvtrans_meta_cache_t *cache, uint64_t index, void *blk);
+
+/**
+ *  @brief Sequence to pass to kvtrans_meta_cache_fill for a read issued now
+ */
+uint32_t kvtrans_meta_cache_get_seq(kvtrans_meta_cache_t *cache, uint64_t index);
+
+/**
+ *  @brief Cache a block read from disk
+ *  The block is dropped if it could be older than a write completed after
+ *  the read was issued.
+ *
+ *  @param seq value of kvtrans_meta_cache_get_seq when the read was issued
+ *  @return true if the block is cached
+ */
+bool kvtrans_meta_cache_fill(kvtrans_meta_cache_t *cache, uint64_t index, const void *blk, uint32_t seq);
+
+/**
+ *  @brief Cache a block whose write to disk completed
+ */
+void kvtrans_meta_cache_update(kvtrans_meta_cache_t *cache, uint64_t index, const void *blk);
+
+/**
+ *  @brief Drop a block from the cache
+ */
+void kvtrans_meta_cache_invalidate(kvtrans_meta_cache_t *cache, uint64_t index);
+
+/**
+ *  @brief Drop blocks [index, index + num_blks) from the cache
+ */
+void kvtrans_meta_cache_invalidate_range(kvtrans_meta_cache_t *cache, uint64_t index, uint64_t num_blks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
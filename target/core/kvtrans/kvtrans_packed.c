@@ -0,0 +1,243 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "kvtrans_packed.h"
+
+// records are 8 byte aligned for creation_time
+#define PACKED_REC_ALIGN (8)
+
+static inline kvtrans_packed_slot_t *_packed_slots(void *blk)
+{
+    return (kvtrans_packed_slot_t *) ((uint8_t *) blk + sizeof(kvtrans_packed_hdr_t));
+}
+
+static inline uint32_t _packed_rec_len(uint32_t klen, uint64_t vlen)
+{
+    uint32_t len = sizeof(kvtrans_packed_rec_t) + klen + vlen;
+
+    return (len + PACKED_REC_ALIGN - 1) & ~(PACKED_REC_ALIGN - 1);
+}
+
+// bytes between the end of the slot directory and the lowest record
+static inline uint32_t _packed_gap(const kvtrans_packed_hdr_t *hdr)
+{
+    return hdr->data_start - sizeof(kvtrans_packed_hdr_t) -
+            hdr->num_slots * sizeof(kvtrans_packed_slot_t);
+}
+
+static int _packed_free_slot(void *blk)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+    int i;
+
+    if (hdr->num_keys == hdr->num_slots) return -1;
+    for (i = 0; i < hdr->num_slots; i++) {
+        if (slots[i].offset == 0) return i;
+    }
+    return -1;
+}
+
+void kvtrans_packed_init(void *blk, uint32_t blk_bytes)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+
+    memset(blk, 0, blk_bytes);
+    hdr->magic = KVTRANS_PACKED_MAGIC;
+    hdr->data_start = blk_bytes & ~(PACKED_REC_ALIGN - 1);
+}
+
+bool kvtrans_packed_is_valid(const void *blk, uint32_t blk_bytes)
+{
+    const kvtrans_packed_hdr_t *hdr = (const kvtrans_packed_hdr_t *) blk;
+
+    return hdr->magic == KVTRANS_PACKED_MAGIC &&
+            hdr->num_slots <= KVTRANS_PACKED_MAX_SLOTS &&
+            hdr->num_keys <= hdr->num_slots &&
+            hdr->data_start <= blk_bytes &&
+            hdr->data_start >= sizeof(kvtrans_packed_hdr_t) + hdr->num_slots * sizeof(kvtrans_packed_slot_t);
+}
+
+bool kvtrans_packed_fits(const void *blk, uint32_t klen, uint64_t vlen)
+{
+    const kvtrans_packed_hdr_t *hdr = (const kvtrans_packed_hdr_t *) blk;
+    uint32_t need;
+
+    if (!kvtrans_packed_is_packable(klen, vlen)) return false;
+
+    need = _packed_rec_len(klen, vlen);
+    if (hdr->num_keys == hdr->num_slots) {
+        if (hdr->num_slots == KVTRANS_PACKED_MAX_SLOTS) return false;
+        need += sizeof(kvtrans_packed_slot_t);
+    }
+    return _packed_gap(hdr) + hdr->frag_bytes >= need;
+}
+
+int kvtrans_packed_find(const void *blk, const char *key, uint32_t klen)
+{
+    const kvtrans_packed_hdr_t *hdr = (const kvtrans_packed_hdr_t *) blk;
+    const kvtrans_packed_slot_t *slots = _packed_slots((void *) blk);
+    const kvtrans_packed_rec_t *rec;
+    int i;
+
+    for (i = 0; i < hdr->num_slots; i++) {
+        if (slots[i].offset == 0) continue;
+        rec = (const kvtrans_packed_rec_t *) ((const uint8_t *) blk + slots[i].offset);
+        if (rec->key_len == klen && !memcmp(rec->data, key, klen)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+kvtrans_packed_rec_t *kvtrans_packed_get(void *blk, int slot)
+{
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+
+    if (slots[slot].offset == 0) return NULL;
+    return (kvtrans_packed_rec_t *) ((uint8_t *) blk + slots[slot].offset);
+}
+
+int kvtrans_packed_insert(void *blk, uint32_t blk_bytes,
+                          const char *key, uint32_t klen,
+                          const void *value, uint64_t vlen,
+                          const struct timespec *creation_time)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+    kvtrans_packed_rec_t *rec;
+    uint32_t rec_len, need;
+    int slot;
+
+    if (!kvtrans_packed_fits(blk, klen, vlen)) return -1;
+
+    rec_len = _packed_rec_len(klen, vlen);
+    slot = _packed_free_slot(blk);
+    need = slot < 0 ? rec_len + sizeof(kvtrans_packed_slot_t) : rec_len;
+    if (_packed_gap(hdr) < need) {
+        kvtrans_packed_compact(blk, blk_bytes);
+    }
+    if (slot < 0) {
+        slot = hdr->num_slots++;
+    }
+
+    hdr->data_start -= rec_len;
+    rec = (kvtrans_packed_rec_t *) ((uint8_t *) blk + hdr->data_start);
+    memset(rec, 0, rec_len);
+    rec->creation_time = *creation_time;
+    rec->key_len = klen;
+    rec->value_size = vlen;
+    memcpy(rec->data, key, klen);
+    if (vlen) memcpy(rec->data + klen, value, vlen);
+
+    slots[slot].offset = hdr->data_start;
+    slots[slot].len = rec_len;
+    hdr->num_keys++;
+    return slot;
+}
+
+bool kvtrans_packed_update(void *blk, uint32_t blk_bytes, int slot,
+                           const char *key, uint32_t klen,
+                           const void *value, uint64_t vlen,
+                           const struct timespec *creation_time)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+
+    if (!kvtrans_packed_is_packable(klen, vlen)) return false;
+    // the slot of the old record is reused
+    if (_packed_gap(hdr) + hdr->frag_bytes + slots[slot].len < _packed_rec_len(klen, vlen)) {
+        return false;
+    }
+
+    kvtrans_packed_delete(blk, slot);
+    return kvtrans_packed_insert(blk, blk_bytes, key, klen, value, vlen, creation_time) >= 0;
+}
+
+void kvtrans_packed_delete(void *blk, int slot)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+
+    if (slots[slot].offset == hdr->data_start) {
+        // lowest record, give its space back to the gap
+        hdr->data_start += slots[slot].len;
+    } else {
+        hdr->frag_bytes += slots[slot].len;
+    }
+    slots[slot].offset = 0;
+    slots[slot].len = 0;
+    hdr->num_keys--;
+
+    // trailing free slots go back to the gap
+    while (hdr->num_slots > 0 && slots[hdr->num_slots - 1].offset == 0) {
+        hdr->num_slots--;
+    }
+}
+
+void kvtrans_packed_compact(void *blk, uint32_t blk_bytes)
+{
+    kvtrans_packed_hdr_t *hdr = (kvtrans_packed_hdr_t *) blk;
+    kvtrans_packed_slot_t *slots = _packed_slots(blk);
+    uint8_t order[KVTRANS_PACKED_MAX_SLOTS];
+    uint32_t end = blk_bytes & ~(PACKED_REC_ALIGN - 1);
+    int i, j, n = 0;
+
+    if (hdr->frag_bytes == 0) return;
+
+    // used slots by record offset, highest first
+    for (i = 0; i < hdr->num_slots; i++) {
+        if (slots[i].offset == 0) continue;
+        for (j = n; j > 0 && slots[order[j - 1]].offset < slots[i].offset; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+        n++;
+    }
+
+    // records only move up, so the ones above are already in place
+    for (i = 0; i < n; i++) {
+        kvtrans_packed_slot_t *s = &slots[order[i]];
+
+        end -= s->len;
+        if (end != s->offset) {
+            memmove((uint8_t *) blk + end, (uint8_t *) blk + s->offset, s->len);
+            s->offset = end;
+        }
+    }
+    hdr->data_start = end;
+    hdr->frag_bytes = 0;
+}
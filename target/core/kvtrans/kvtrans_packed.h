@@ -0,0 +1,174 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_PACKED_H
+#define KVTRANS_PACKED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A 64 bit value to indicate a packed meta blk, next to META_MAGIC
+#define KVTRANS_PACKED_MAGIC (0xabc1)
+// upper bound of key and value bytes of one packed record
+#define KVTRANS_PACKED_MAX_RECORD (1024)
+// upper bound of slots in the directory of a packed blk
+#define KVTRANS_PACKED_MAX_SLOTS (128)
+
+/**
+ *  @brief Header of a packed meta blk
+ *  A packed blk holds the meta and inline value of several small keys.
+ *  The slot directory grows forward from the header and records are
+ *  packed backward from the end of the blk. A free slot has offset 0.
+ */
+typedef struct kvtrans_packed_hdr_s {
+    uint64_t magic;
+    uint16_t num_slots;
+    uint16_t num_keys;
+    // offset of the lowest record
+    uint16_t data_start;
+    // bytes of deleted records above data_start
+    uint16_t frag_bytes;
+} kvtrans_packed_hdr_t;
+
+typedef struct kvtrans_packed_slot_s {
+    uint16_t offset;
+    uint16_t len;
+} kvtrans_packed_slot_t;
+
+/**
+ *  @brief A packed record, key bytes followed by value bytes
+ */
+typedef struct kvtrans_packed_rec_s {
+    struct timespec creation_time;
+    uint16_t key_len;
+    uint16_t value_size;
+    char data[];
+} kvtrans_packed_rec_t;
+
+/**
+ *  @brief Whether a key and value are small enough to be packed
+ */
+static inline bool kvtrans_packed_is_packable(uint32_t klen, uint64_t vlen)
+{
+    return sizeof(kvtrans_packed_rec_t) + klen + vlen <= KVTRANS_PACKED_MAX_RECORD;
+}
+
+/**
+ *  @brief Initialize blk as an empty packed blk of blk_bytes
+ */
+void kvtrans_packed_init(void *blk, uint32_t blk_bytes);
+
+/**
+ *  @brief Check the header of a packed blk of blk_bytes
+ */
+bool kvtrans_packed_is_valid(const void *blk, uint32_t blk_bytes);
+
+/**
+ *  @brief Whether a record of klen and vlen can be inserted, compacting the blk if needed
+ */
+bool kvtrans_packed_fits(const void *blk, uint32_t klen, uint64_t vlen);
+
+/**
+ *  @brief Find the slot of key
+ *
+ *  @return slot index, -1 if the key is not in the blk
+ */
+int kvtrans_packed_find(const void *blk, const char *key, uint32_t klen);
+
+/**
+ *  @brief Get the record of a slot
+ *
+ *  @return record, NULL if the slot is free
+ */
+kvtrans_packed_rec_t *kvtrans_packed_get(void *blk, int slot);
+
+/**
+ *  @brief Insert a record, the caller checks it fits with kvtrans_packed_fits
+ *
+ *  @return slot index of the record, -1 if it does not fit
+ */
+int kvtrans_packed_insert(void *blk, uint32_t blk_bytes,
+                          const char *key, uint32_t klen,
+                          const void *value, uint64_t vlen,
+                          const struct timespec *creation_time);
+
+/**
+ *  @brief Replace the record of a used slot if the new one fits in its place
+ *
+ *  @return true if replaced, false if the blk is left unchanged
+ */
+bool kvtrans_packed_update(void *blk, uint32_t blk_bytes, int slot,
+                           const char *key, uint32_t klen,
+                           const void *value, uint64_t vlen,
+                           const struct timespec *creation_time);
+
+/**
+ *  @brief Delete the record of a used slot
+ */
+void kvtrans_packed_delete(void *blk, int slot);
+
+/**
+ *  @brief Move all records to the end of the blk to merge free space
+ */
+void kvtrans_packed_compact(void *blk, uint32_t blk_bytes);
+
+static inline uint16_t kvtrans_packed_num_keys(const void *blk)
+{
+    return ((const kvtrans_packed_hdr_t *) blk)->num_keys;
+}
+
+static inline uint16_t kvtrans_packed_num_slots(const void *blk)
+{
+    return ((const kvtrans_packed_hdr_t *) blk)->num_slots;
+}
+
+static inline const char *kvtrans_packed_rec_key(const kvtrans_packed_rec_t *rec)
+{
+    return rec->data;
+}
+
+static inline const char *kvtrans_packed_rec_value(const kvtrans_packed_rec_t *rec)
+{
+    return rec->data + rec->key_len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
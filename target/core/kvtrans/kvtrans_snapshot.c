@@ -0,0 +1,166 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+
+#include "kvtrans_snapshot.h"
+#include "hash/xxhash.h"
+
+typedef struct snapshot_save_args_s {
+    kvtrans_snapshot_ent_t *ents;
+    uint64_t max_ents;
+    uint64_t num_ents;
+} snapshot_save_args_t;
+
+static uint32_t _snapshot_hdr_checksum(const kvtrans_snapshot_hdr_t *hdr)
+{
+    return XXH32(hdr, offsetof(kvtrans_snapshot_hdr_t, hdr_checksum), KVTRANS_SNAPSHOT_VERSION);
+}
+
+static uint32_t _snapshot_data_checksum(const void *data, uint64_t num_ents)
+{
+    return XXH32(data, num_ents * sizeof(kvtrans_snapshot_ent_t), KVTRANS_SNAPSHOT_VERSION);
+}
+
+static void _snapshot_save_ent(uint64_t dc_idx, void *elm, void *args)
+{
+    snapshot_save_args_t *save = (snapshot_save_args_t *) args;
+    dc_item_t *it = (dc_item_t *) elm;
+    kvtrans_snapshot_ent_t *ent;
+
+    // counted on overflow to report the size needed
+    if (save->num_ents < save->max_ents) {
+        ent = &save->ents[save->num_ents];
+        ent->dc_idx = dc_idx;
+        ent->mdc_index = it->mdc_index;
+        ent->ori_state = it->ori_state;
+        ent->rsvd = 0;
+    }
+    save->num_ents++;
+}
+
+uint64_t kvtrans_snapshot_data_blks(uint64_t num_dc_entries, uint64_t blk_size)
+{
+    return CEILING(num_dc_entries * sizeof(kvtrans_snapshot_ent_t), blk_size);
+}
+
+int kvtrans_snapshot_save(kvtrans_ctx_t *ctx, kvtrans_snapshot_hdr_t *hdr,
+                          void *data, uint64_t data_len)
+{
+    snapshot_save_args_t save;
+
+    save.ents = (kvtrans_snapshot_ent_t *) data;
+    save.max_ents = data_len / sizeof(kvtrans_snapshot_ent_t);
+    save.num_ents = 0;
+    for_each_elm_fn(ctx->dc_cache_tbl, _snapshot_save_ent, &save);
+    if (save.num_ents > save.max_ents) {
+        DSS_ERRLOG("Index snapshot of [%zu] dc entries exceeds [%zu]\n", save.num_ents, save.max_ents);
+        return -1;
+    }
+
+    memset(hdr, 0, sizeof(kvtrans_snapshot_hdr_t));
+    hdr->magic = KVTRANS_SNAPSHOT_MAGIC;
+    hdr->version = KVTRANS_SNAPSHOT_VERSION;
+    hdr->clean = 1;
+    hdr->generation = ++ctx->snapshot_gen;
+    hdr->blk_offset = ctx->blk_offset;
+    hdr->blk_num = ctx->blk_num;
+    hdr->num_dc_entries = save.num_ents;
+    hdr->meta = ctx->stat.meta;
+    hdr->mc = ctx->stat.mc;
+    hdr->dc = ctx->stat.dc;
+    hdr->mdc = ctx->stat.mdc;
+    hdr->packed_keys = ctx->stat.packed_keys;
+    hdr->packed_blks = ctx->stat.packed_blks;
+    hdr->data_checksum = _snapshot_data_checksum(data, save.num_ents);
+    hdr->hdr_checksum = _snapshot_hdr_checksum(hdr);
+
+    return 0;
+}
+
+bool kvtrans_snapshot_hdr_is_valid(const kvtrans_snapshot_hdr_t *hdr)
+{
+    return hdr->magic == KVTRANS_SNAPSHOT_MAGIC &&
+            hdr->version == KVTRANS_SNAPSHOT_VERSION &&
+            hdr->hdr_checksum == _snapshot_hdr_checksum(hdr);
+}
+
+bool kvtrans_snapshot_is_loadable(kvtrans_ctx_t *ctx, const kvtrans_snapshot_hdr_t *hdr,
+                                  uint64_t data_len)
+{
+    if (!kvtrans_snapshot_hdr_is_valid(hdr) || !hdr->clean) {
+        return false;
+    }
+    if (hdr->blk_offset != ctx->blk_offset || hdr->blk_num != ctx->blk_num) {
+        return false;
+    }
+    return hdr->num_dc_entries <= data_len / sizeof(kvtrans_snapshot_ent_t);
+}
+
+int kvtrans_snapshot_load(kvtrans_ctx_t *ctx, const kvtrans_snapshot_hdr_t *hdr,
+                          const void *data)
+{
+    const kvtrans_snapshot_ent_t *ents = (const kvtrans_snapshot_ent_t *) data;
+    dc_item_t it;
+    uint64_t i;
+
+    if (hdr->data_checksum != _snapshot_data_checksum(data, hdr->num_dc_entries)) {
+        return -1;
+    }
+
+    for (i = 0; i < hdr->num_dc_entries; i++) {
+        memset(&it, 0, sizeof(dc_item_t));
+        it.mdc_index = ents[i].mdc_index;
+        it.ori_state = (blk_state_t) ents[i].ori_state;
+        if (store_elm(ctx->dc_cache_tbl, ents[i].dc_idx, &it)) {
+            DSS_ERRLOG("Restore dc entry [%zu] from index snapshot failed\n", ents[i].dc_idx);
+            DSS_ASSERT(0);
+        }
+    }
+
+    ctx->stat.meta = hdr->meta;
+    ctx->stat.mc = hdr->mc;
+    ctx->stat.dc = hdr->dc;
+    ctx->stat.mdc = hdr->mdc;
+    ctx->stat.packed_keys = hdr->packed_keys;
+    ctx->stat.packed_blks = hdr->packed_blks;
+    ctx->snapshot_gen = hdr->generation;
+
+    return 0;
+}
+
+void kvtrans_snapshot_invalidate(kvtrans_snapshot_hdr_t *hdr)
+{
+    hdr->clean = 0;
+    hdr->hdr_checksum = _snapshot_hdr_checksum(hdr);
+}
@@ -0,0 +1,124 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef KVTRANS_SNAPSHOT_H
+#define KVTRANS_SNAPSHOT_H
+
+#include "kvtrans.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KVTRANS_SNAPSHOT_MAGIC (0x70616e53544b5344ULL)
+#define KVTRANS_SNAPSHOT_VERSION (1)
+
+/**
+ *  @brief Header blk of the kvtrans index snapshot
+ *  The snapshot is written on clean stop and holds the dc table and blk
+ *  stats of a kvtrans instance. Its entries follow in the next blks.
+ *  clean is reset once the snapshot is read at boot, so that it is only
+ *  loaded after the stop that wrote it.
+ */
+typedef struct __attribute__((__packed__)) kvtrans_snapshot_hdr_s {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t clean;
+    uint64_t generation;
+    // layout of the kvtrans instance the snapshot is taken from
+    uint64_t blk_offset;
+    uint64_t blk_num;
+    uint64_t num_dc_entries;
+    uint64_t meta;
+    uint64_t mc;
+    uint64_t dc;
+    uint64_t mdc;
+    uint64_t packed_keys;
+    uint64_t packed_blks;
+    uint32_t data_checksum;
+    // checksum of the header up to this field
+    uint32_t hdr_checksum;
+} kvtrans_snapshot_hdr_t;
+
+typedef struct __attribute__((__packed__)) kvtrans_snapshot_ent_s {
+    uint64_t dc_idx;
+    uint64_t mdc_index;
+    uint32_t ori_state;
+    uint32_t rsvd;
+} kvtrans_snapshot_ent_t;
+
+/**
+ *  @brief Blks after the header taken by num_dc_entries
+ */
+uint64_t kvtrans_snapshot_data_blks(uint64_t num_dc_entries, uint64_t blk_size);
+
+/**
+ *  @brief Serialize the dc table and blk stats of ctx
+ *
+ *  @param hdr header blk filled for a clean snapshot of the next generation
+ *  @param data buffer for entries of data_len bytes
+ *  @return 0 on success, -1 if the entries do not fit in data_len
+ */
+int kvtrans_snapshot_save(kvtrans_ctx_t *ctx, kvtrans_snapshot_hdr_t *hdr,
+                          void *data, uint64_t data_len);
+
+/**
+ *  @brief Check magic, version and checksum of a header
+ */
+bool kvtrans_snapshot_hdr_is_valid(const kvtrans_snapshot_hdr_t *hdr);
+
+/**
+ *  @brief Whether a clean snapshot of the layout of ctx with entries
+ *  within data_len bytes can be loaded
+ */
+bool kvtrans_snapshot_is_loadable(kvtrans_ctx_t *ctx, const kvtrans_snapshot_hdr_t *hdr,
+                                  uint64_t data_len);
+
+/**
+ *  @brief Verify entries and restore dc table and blk stats of ctx
+ *
+ *  @return 0 on success, -1 on checksum mismatch with ctx left untouched
+ */
+int kvtrans_snapshot_load(kvtrans_ctx_t *ctx, const kvtrans_snapshot_hdr_t *hdr,
+                          const void *data);
+
+/**
+ *  @brief Mark a snapshot as consumed
+ */
+void kvtrans_snapshot_invalidate(kvtrans_snapshot_hdr_t *hdr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -46,5 +46,8 @@ int _put_free_index(cache_tbl_t *cache_tbl, uint64_t index);
 int store_elm(cache_tbl_t *cache_tbl, uint64_t kidx, void *data);
 void *get_elm(cache_tbl_t *cache_tbl, uint64_t kidx);
 int delete_elm(cache_tbl_t *cache_tbl, uint64_t kidx);
+int find_elm(cache_tbl_t *cache_tbl, uint64_t kidx);
+bool has_no_elm(cache_tbl_t *cache_tbl);
+int for_each_elm_fn(cache_tbl_t *cache_tbl, void (*cb_fn)(uint64_t, void *, void *), void* cb_args);
 
 #endif
\ No newline at end of file
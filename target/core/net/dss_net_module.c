@@ -66,27 +66,88 @@ dss_net_mod_mgr_t g_net_mod_mgr = {
     .net_mod_list = TAILQ_HEAD_INITIALIZER(g_net_mod_mgr.net_mod_list)
 };
 
+//Per net thread requests waiting for target module credits
+typedef struct dss_net_module_inst_s {
+    TAILQ_HEAD(, dfly_request) credit_wait_reqs;
+    uint64_t num_credit_waits;
+} dss_net_module_inst_t;
+
 //dss_net_module_config_t
 void *dss_net_module_thread_instance_init(void *mctx, void *inst_ctx, int inst_index)
 {
-    return NULL;
+    dss_net_module_inst_t *ni;
+
+    ni = (dss_net_module_inst_t *)calloc(1, sizeof(dss_net_module_inst_t));
+    DSS_RELEASE_ASSERT(ni);
+    TAILQ_INIT(&ni->credit_wait_reqs);
+
+    return ni;
 }
 
 void *dfly_net_module_thread_instance_destroy(void *mctx, void *inst_ctx)
 {
+    dss_net_module_inst_t *ni = (dss_net_module_inst_t *)inst_ctx;
+
+    if(ni) {
+        DSS_ASSERT(TAILQ_EMPTY(&ni->credit_wait_reqs));
+        if(ni->num_credit_waits) {
+            DSS_NOTICELOG("Net thread had %lu requests wait for module credits\n", ni->num_credit_waits);
+        }
+        free(ni);
+    }
     return NULL;
 }
+
+static inline void dss_net_module_credit_wait(dss_net_module_inst_t *ni, dss_request_t *req)
+{
+    TAILQ_INSERT_TAIL(&ni->credit_wait_reqs, (struct dfly_request *)req, credit_wait);
+    ni->num_credit_waits++;
+}
+
 int dss_net_module_req_process(void *ctx, dss_request_t *req)
 {
-    dss_net_request_process(req);
+    dss_net_module_inst_t *ni = (dss_net_module_inst_t *)ctx;
+
+    if(!TAILQ_EMPTY(&ni->credit_wait_reqs) &&
+            req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state == DSS_NET_REQUEST_INIT) {
+        //Keep arrival order behind requests already waiting
+        dss_net_module_credit_wait(ni, req);
+        return DFLY_MODULE_REQUEST_QUEUED;
+    }
+
+    if(dss_net_request_process(req) == DSS_MODULE_STATUS_BUSY) {
+        dss_net_module_credit_wait(ni, req);
+    }
     return DFLY_MODULE_REQUEST_QUEUED;
 }
 
+int dss_net_module_credit_wait_poll(void *ctx)
+{
+    dss_net_module_inst_t *ni = (dss_net_module_inst_t *)ctx;
+    struct dfly_request *dreq;
+    int nprocessed = 0;
+
+    while((dreq = TAILQ_FIRST(&ni->credit_wait_reqs)) != NULL) {
+        if(dss_net_request_process((dss_request_t *)dreq) == DSS_MODULE_STATUS_BUSY) {
+            break;
+        }
+        TAILQ_REMOVE(&ni->credit_wait_reqs, dreq, credit_wait);
+        nprocessed++;
+    }
+
+    //Keep polling at full rate while requests wait for credits
+    if(!TAILQ_EMPTY(&ni->credit_wait_reqs)) {
+        nprocessed++;
+    }
+
+    return nprocessed;
+}
+
 dss_module_ops_t g_net_module_ops = {
     .module_init_instance_context = dss_net_module_thread_instance_init,
     .module_rpoll = dss_net_module_req_process,
     .module_cpoll = NULL,
-    .module_gpoll = NULL,
+    .module_gpoll = dss_net_module_credit_wait_poll,
     .find_instance_context = NULL,
     .module_instance_destroy = dfly_net_module_thread_instance_destroy
 };
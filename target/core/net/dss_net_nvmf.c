@@ -172,7 +172,8 @@ void dss_net_setup_nvmf_resp(dss_request_t *req, dss_request_rc_t status, uint32
             }
             break;
         case DSS_REQ_STATUS_ERROR:
-            DSS_ASSERT(0);
+            dss_nvmf_set_sct_sc(nvmf_req, SPDK_NVME_SCT_GENERIC, SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+            break;
     }
 
     return;
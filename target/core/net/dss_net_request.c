@@ -131,10 +131,11 @@ void dss_net_request_setup_blk_io_task(dss_request_t *req)
     return;
 }
 
-void dss_net_request_process(dss_request_t *req)
+dss_module_status_t dss_net_request_process(dss_request_t *req)
 {
     dss_io_task_status_t iot_rc;
     dss_net_request_state_t prev_state;
+    dss_module_instance_t *target_mi;
     do {
         prev_state = req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state;
         switch (req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state)
@@ -145,27 +146,36 @@ void dss_net_request_process(dss_request_t *req)
                 req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state = DSS_NET_REQUEST_COMPLETE;
             } else if (dss_subsystem_kv_mode_enabled(req->ss)) {
                 if(g_list_conf.list_enabled && req->opc == DSS_NVMF_KV_IO_OPC_LIST_READ) {
+                    target_mi = dfly_module_reserve_request(dss_module_get_subsys_ctx(DSS_MODULE_LIST, req->ss), (struct dfly_request *)req);
+                    if(!target_mi) {
+                        return DSS_MODULE_STATUS_BUSY;
+                    }
                     req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state = DSS_NET_REQUEST_SUBMITTED;
-                    dfly_module_post_request(dss_module_get_subsys_ctx(DSS_MODULE_LIST, req->ss), req);
-                    return;
+                    dfly_module_post_reserved_request(target_mi, (struct dfly_request *)req);
+                    return DSS_MODULE_STATUS_SUCCESS;
                 }
                 if(req->opc == DSS_NVMF_BLK_IO_OPC_READ) {
                     dss_nvmf_process_as_no_op(req);
                     req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state = DSS_NET_REQUEST_COMPLETE;
                 } else {
+                    //Reserve before kvtrans setup so a busy request can be retried as is
+                    target_mi = dfly_module_reserve_request(dss_module_get_subsys_ctx(DSS_MODULE_KVTRANS, req->ss), (struct dfly_request *)req);
+                    if(!target_mi) {
+                        return DSS_MODULE_STATUS_BUSY;
+                    }
                     DSS_ASSERT(req->module_ctx[DSS_MODULE_KVTRANS].mreq_ctx.kvt.initialized == false);
                     dss_setup_kvtrans_req(req, dss_req_get_key(req), dss_req_get_value(req));
                     req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state = DSS_NET_REQUEST_SUBMITTED;
-                    dfly_module_post_request(dss_module_get_subsys_ctx(DSS_MODULE_KVTRANS, req->ss), req);
+                    dfly_module_post_reserved_request(target_mi, (struct dfly_request *)req);
                     dss_trace_record(TRACE_NET_ENQUEUE_KREQ , 0, 0, 0, (uintptr_t)req);
-                    return;
+                    return DSS_MODULE_STATUS_SUCCESS;
                 }
             } else {
                 dss_net_request_setup_blk_io_task(req);
                 iot_rc = dss_io_task_submit(req->io_task);
                 DSS_ASSERT(iot_rc == DSS_IO_TASK_STATUS_SUCCESS);
                 req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state = DSS_NET_REQUEST_SUBMITTED;
-                return;
+                return DSS_MODULE_STATUS_SUCCESS;
             }
             break;
         case DSS_NET_REQUEST_SUBMITTED:
@@ -182,4 +192,6 @@ void dss_net_request_process(dss_request_t *req)
             DSS_RELEASE_ASSERT(0);
         }
     } while(req->module_ctx[DSS_MODULE_NET].mreq_ctx.net.state != prev_state);
+
+    return DSS_MODULE_STATUS_SUCCESS;
 }
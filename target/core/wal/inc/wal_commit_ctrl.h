@@ -0,0 +1,93 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __WAL_COMMIT_CTRL_H
+#define __WAL_COMMIT_CTRL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//Group commit controller of a cache zone.
+//Sizes the log dump batch from the request inter-arrival time and the log device
+//write time so that the p99 commit latency stays under the configured target.
+//The controller is driven from the zone's own thread only, no locking.
+
+#define WAL_COMMIT_CTRL_NR_BUCKET	64	//latency histogram buckets of target/16 each, covers 4x target
+#define WAL_COMMIT_CTRL_WINDOW		64	//batches per feedback window
+#define WAL_COMMIT_CTRL_EWMA_SHIFT	3	//new sample weight 1/8
+#define WAL_COMMIT_CTRL_GAIN_ONE	256
+#define WAL_COMMIT_CTRL_GAIN_INIT	128
+#define WAL_COMMIT_CTRL_GAIN_MIN	8
+#define WAL_COMMIT_CTRL_GAIN_MAX	224	//keep 1/8 of the budget as headroom for device jitter
+#define WAL_COMMIT_CTRL_MIN_TIMEOUT_US	1
+
+typedef struct wal_commit_ctrl_s {
+	int32_t target_us;		//p99 commit latency target, 0 when disabled
+	int32_t max_nr_obj;		//upper bound of batch_nr_obj
+	//controller outputs
+	int32_t batch_nr_obj;
+	int32_t batch_timeout_us;
+	//observations
+	int64_t arrival_ns;		//ewma of request inter-arrival time
+	int64_t device_ns;		//ewma of the log device batch write time
+	int32_t gain;			//share of (target - device time) spent on batching, 1/256 units
+	int32_t p99_us;			//p99 commit latency of the last closed window
+	//current window
+	int32_t nr_window_batch;
+	int64_t nr_window_reqs;
+	int64_t window_max_ns;
+	int64_t hist[WAL_COMMIT_CTRL_NR_BUCKET + 1];	//last bucket counts overflow
+	int64_t nr_batch;
+} wal_commit_ctrl_t;
+
+void wal_commit_ctrl_init(wal_commit_ctrl_t *ctrl, int target_us, int max_nr_obj);
+
+//record the time since the previous request joined a dump group of the zone.
+void wal_commit_ctrl_arrival(wal_commit_ctrl_t *ctrl, int64_t interval_ns);
+
+//record a completed batch write of nr_reqs requests.
+//device_ns is the log write time, latency_ns the time since the oldest request of the batch arrived.
+//batch_nr_obj and batch_timeout_us are updated, returns true when a window closed and p99_us is new.
+bool wal_commit_ctrl_complete(wal_commit_ctrl_t *ctrl, int nr_reqs, int64_t device_ns,
+			      int64_t latency_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -136,7 +136,7 @@ int wal_handle_retrieve_op(struct dfly_subsystem *pool,
 
 int wal_conf_info(const char *conf_name);
 int wal_map_invalidate_item(void *context,
-			    wal_bucket_t *bucket, wal_map_item_t *item);
+			    wal_map_t *map, wal_map_item_t *item);
 
 wal_zone_t *wal_get_zone_from_req(struct dfly_request *req);
 
@@ -76,15 +76,35 @@ typedef struct wal_map_item_s {
 	int32_t		recover_status;
 	void		 *buffer_ptr;
 	void		 *large_key_buff;
-	struct wal_map_item_s *next;
+	TAILQ_ENTRY(wal_map_item_s) link;	//map item list or slab free list
 } wal_map_item_t;
 
-typedef struct wal_bucket_s {
-	TAILQ_ENTRY(wal_bucket_s) link;
-	wal_map_item_t *entry;
-	int32_t valid_nr_entries;
-	int32_t total_nr_entries;
-} wal_bucket_t;
+/**
+ * @brief Open addressed index slot
+ *
+ * key_hash, key_fp and key_len describe the key of item inline so a probe
+ * only dereferences item on a likely match. A slot is empty while item
+ * is NULL and stays taken by its item, valid or not, until map reinit.
+ */
+typedef struct wal_map_slot_s {
+	uint32_t		key_hash;
+	uint16_t		key_fp;
+	uint16_t		key_len;
+	wal_map_item_t	 *item;
+} wal_map_slot_t;
+
+/**
+ * @brief Chunk of map items with their key buffers in one allocation
+ */
+typedef struct wal_map_slab_s {
+	struct wal_map_slab_s *next;
+	uint32_t		nr_items;
+} wal_map_slab_t;
+
+#define WAL_MAP_MIN_SLOTS		(16)
+#define WAL_MAP_SLAB_NR_ITEMS	(1024)
+//grow the index beyond this fill ratio in percent
+#define WAL_MAP_MAX_LOAD_PCT	(75)
 
 typedef enum wal_map_lookup_type_s {
 	WAL_MAP_LOOKUP_WRITE_APPEND = 0,	//for device log
@@ -112,7 +132,8 @@ typedef int32_t (* insert_func_t)(void *context, wal_object_t *obj, wal_map_item
 typedef int64_t (* read_func_t)(void *context, wal_map_item_t *map_item, wal_object_t *obj);
 
 typedef int (*hash_key_comp_t)(wal_key_t *k1, wal_key_t *k2);
-typedef int (*invalidate_item_t)(void *context, wal_bucket_t *bucket, wal_map_item_t *item);
+struct wal_map_s;
+typedef int (*invalidate_item_t)(void *context, struct wal_map_s *map, wal_map_item_t *item);
 
 typedef struct wal_map_ops {
 	hash_func_t	    	hash;
@@ -123,21 +144,33 @@ typedef struct wal_map_ops {
 } wal_map_ops_t;
 
 typedef struct wal_map_s {
-	wal_bucket_t   	*table;
-	TAILQ_HEAD(, wal_bucket_s) 	head;
-	wal_bucket_t *flush_head;
-	int					nr_buckets;
+	wal_map_slot_t		*slots;
+	uint32_t			nr_slots;		//power of 2
+	uint32_t			slot_shift;		//32 - log2(nr_slots)
+	uint32_t			nr_used_slots;
+	int32_t				nr_valid_items;
+	TAILQ_HEAD(, wal_map_item_s) 	head;	//items in first insert order for flush
+	TAILQ_HEAD(, wal_map_item_s) 	free_items;
+	wal_map_item_t		*flush_head;
+	wal_map_slab_t		*slabs;
+	void				*ctx;
 	wal_map_ops_t 		*ops;
 } wal_map_t;
 
 wal_key_t *wal_key_clone(wal_key_t *src_key);
 int wal_map_reinit(wal_map_t *map);
-int wal_map_bucket_iteration(wal_map_t *map);
-void wal_map_bucket_list_update(wal_map_t *map, wal_bucket_t *bucket);
+int wal_map_item_iteration(wal_map_t *map);
 wal_map_item_t *wal_map_lookup(void *icontext, wal_map_t *map, wal_object_t *obj,
 			       off64_t addr, wal_map_lookup_type_t lookup_type);
 
-wal_map_t *wal_map_create(void *ctx, int nr_buckets, wal_map_ops_t *map_ops);
+/**
+ * @brief Create an open addressed map for the wal buffer ctx
+ *
+ * @param nr_slots initial index size, rounded up to a power of 2. The index
+ *                 doubles once WAL_MAP_MAX_LOAD_PCT of the slots are taken.
+ */
+wal_map_t *wal_map_create(void *ctx, int nr_slots, wal_map_ops_t *map_ops);
+void wal_map_destroy(wal_map_t *map);
 
 
 #ifdef __cplusplus
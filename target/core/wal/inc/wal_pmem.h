@@ -0,0 +1,67 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __WAL_PMEM_H
+#define __WAL_PMEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <wal_zone_buffer.h>
+
+//Log device backend on persistent memory.
+//The device is a DAX device or a file mapped into memory. Writes are persisted from user space
+//with non-temporal stores and cache line write back when the mapping is MAP_SYNC, otherwise
+//(plain files, for test) with msync. Requests complete on the submitting thread once persisted.
+
+#define WAL_PMEM_CACHELINE	64
+#define WAL_PMEM_NT_MIN_SZ	256	//smaller copies are cheaper through the cache plus a flush
+#define WAL_PMEM_COMP_SLOTS	1024	//completions in flight per submitting thread, power of 2
+
+extern wal_device_io_ops_t wal_log_pmem_io;
+
+int64_t wal_pmem_getsize(int handle);
+
+//whether the mapping of handle is persisted by cache flushes (MAP_SYNC) rather than msync
+bool wal_pmem_is_map_sync(int handle);
+
+//copy to a MAP_SYNC mapping and make it durable
+void wal_pmem_memcpy_persist(void *dst, const void *src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
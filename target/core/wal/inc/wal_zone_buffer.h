@@ -41,8 +41,10 @@ extern "C" {
 
 #include <wal_map.h>
 #include <wal_def.h>
+#include <wal_commit_ctrl.h>
 
 struct wal_zone_s;
+struct stat_wal_commit;
 
 #define BUFFER_HDR_PADDING_SZ 936
 
@@ -63,6 +65,10 @@ typedef struct wal_dump_hdr_s {
 	uint32_t nr_batch_reqs;				//nr of batch dump object
 	uint32_t reserved;
 	void *req_list[WAL_MAX_DUMP_REQ];	//record the req of the object to be dump in batch way
+	//group commit accounting, cache only, not part of the log record
+	struct wal_zone_s *zone;			//cache zone the group belongs to
+	struct timespec open_ts;			//first request joined the group
+	struct timespec submit_ts;			//batch write submitted to the log device
 } wal_dump_hdr_t;
 
 #define WAL_BUFFER_HDR_SZ	1024
@@ -150,6 +156,60 @@ typedef struct log_recovery_stats_s {
 	int nr_obj_deleted;
 } log_recovery_stats_t;
 
+#define LOG_RECOVER_CHUNK_SZ	(1 << 20)	//size of each pipelined data read
+#define LOG_RECOVER_CARRY_SZ	(256 << 10)	//room for a record split across two chunks
+#define LOG_RECOVER_WT_INIT	64		//initial write through slots per chunk
+
+#define LOG_RECOVER_CHUNK_FREE		0x0
+#define LOG_RECOVER_CHUNK_READING	0x1
+#define LOG_RECOVER_CHUNK_READY		0x2
+
+struct log_recover_chunk_s;
+
+//write through of a recovered object that missed the cache,
+//the value still points into the chunk data until the device completes it.
+typedef struct log_recover_wt_s {
+	struct log_recover_chunk_s *chunk;
+	wal_fh		tgt_fh;
+	wal_key_t	key;
+	wal_val_t	val;
+	void		*key_buff;	//dma buffer for keys beyond the embedded key size
+	bool		is_del;
+} log_recover_wt_t;
+
+typedef struct log_recover_chunk_s {
+	log_cb_ctx_t	io_ctx;		//io_ctx.data points back to this chunk
+	struct log_recover_ctx_s *rctx;
+	char		*data;		//|carry area|chunk data|, read lands after the carry area
+	off64_t		pos;		//device offset of the chunk data
+	int		state;
+	int		nr_wt;		//write through staged while parsing, submitted as one batch
+	int		max_wt;
+	int		nr_wt_pending;	//submitted write through not completed yet
+	log_recover_wt_t *wt;
+} log_recover_chunk_t;
+
+//per zone recovery pipeline, keeps up to qd chunk reads in flight for the buffer
+//being replayed and parses the chunks in device order as they complete.
+typedef struct log_recover_ctx_s {
+	struct wal_device_info	*dev_info;
+	struct wal_zone_s	*zone;
+	struct wal_buffer_s	*buffer;	//buffer being replayed, flush first then log
+	struct wal_zone_s	*cache_zone;	//last cache zone populated
+	int		nr_hdr_read;
+	int		qd;
+	int		nr_inflight;		//chunk reads not completed yet
+	int		nr_wt_pending;		//write through not completed yet
+	uint32_t	issue_seq;
+	uint32_t	parse_seq;
+	off64_t		issue_pos;
+	int		carry_sz;		//bytes of a partial record carried to the next chunk
+	char		*carry;
+	bool		buffer_done;		//no more records, drain and move on
+	bool		resync;			//partial record too large to carry, reread from curr_pos
+	log_recover_chunk_t *chunks;
+} log_recover_ctx_t;
+
 typedef struct wal_buffer_s {
 	wal_buffer_hdr_t hdr;
 	log_cb_ctx_t	hdr_io_ctx;
@@ -199,8 +259,11 @@ typedef struct wal_zone_s {
 	int dump_timeout_us;
 	int log_batch_nr_obj;
 	struct timespec flush_idle_ts;
+	wal_commit_ctrl_t commit_ctrl;	//sizes the dump batch when wal_log_commit_target_us is set
+	struct timespec arrival_ts;
+	struct stat_wal_commit *commit_stat;
 
-	char 			*recovery_buffer;
+	struct log_recover_ctx_s *recover_ctx;
 	log_recovery_stats_t zone_recovery_stats;
 } wal_zone_t;
 
@@ -240,6 +303,7 @@ typedef struct wal_device_info {
 	wal_zone_t	 **zones;
 	wal_map_t **maps;
 	void *pool;
+	int nr_zone_started;
 	int nr_zone_recovered;
 	log_recovery_stats_t dev_log_recovery_stats;
 } wal_device_info_t;
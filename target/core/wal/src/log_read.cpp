@@ -41,10 +41,13 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
 
-#include <sys/types.h>
-
-#include <../../inc/list.h>
+#include <string>
+#include <unordered_map>
 
 #define ATOMIC_ADD(counter, number)                 __sync_fetch_and_add(&(counter), (number))
 #define ATOMIC_INC(counter)                         __sync_fetch_and_add(&(counter), 1)
@@ -134,25 +137,6 @@
 
 #define WAL_DBG(fmt, args...) if(__debug_wal) fprintf(__wal_dbg_fd, fmt, ##args)
 
-typedef struct wal_key_s {
-	void     *key;
-	uint16_t length;
-} wal_key_t;
-
-typedef struct wal_val_s {
-	void	 *value;
-	uint32_t length;
-	int32_t  offset;
-} wal_val_t;
-
-typedef struct wal_object_s {
-	wal_key_t *key;
-	wal_val_t *val;
-	uint32_t	key_hash;
-	int			key_hashed;
-	void 		*obj_private;
-} wal_object_t;
-
 typedef struct wal_object_hdr {
 	int16_t sz_blk; //size in count of 4k block
 	int16_t key_sz;
@@ -178,52 +162,6 @@ typedef struct wal_buffer_hdr_s {
 	char padding[BUFFER_HDR_PADDING_SZ];
 } wal_buffer_hdr_t;
 
-typedef struct wal_map_item_s {
-	wal_key_t 	 *key;
-	uint32_t		key_buff_size;
-	uint32_t		val_size;
-	off64_t 	addr;
-	int32_t 	status;
-	void		 *buffer_ptr;
-	struct wal_map_item_s *next;
-} wal_map_item_t;
-
-typedef struct wal_bucket_s {
-	struct list_head link;
-	wal_map_item_t *entry;
-	int32_t valid_nr_entries;
-	int32_t total_nr_entries;
-} wal_bucket_t;
-
-typedef struct wal_map_s {
-	wal_bucket_t   	*table;
-	wal_bucket_t *flush_head;
-	int					nr_buckets;
-} wal_map_t;
-
-struct wal_zone_s;
-
-typedef struct wal_buffer_s {
-	wal_buffer_hdr_t hdr;
-	int			 fh;		//fh of the WAL device.
-	wal_map_t *map;
-	char 			*record_buffer;
-	struct wal_zone_s *zone;
-	long			nr_objects_inserted;
-	long 			nr_pending_io;
-
-	long			utilization;
-	long			total_space_KB;
-	long			inc_wmk_change;
-	long			dec_wmk_change;
-} wal_buffer_t;
-
-typedef struct wal_zone_s {
-	int32_t			zone_id; //the index of __wal_zones arrays
-	wal_buffer_t *log;
-	wal_buffer_t *flush;
-} wal_zone_t;
-
 
 typedef struct wal_space_s {
 	int32_t addr_mb;
@@ -247,24 +185,108 @@ typedef struct wal_superblock {
 	char 	padding[LOG_SB_PADDING_SIZE];
 } wal_sb_t;
 
-typedef struct wal_device_info {
-	char		dev_name[WAL_DEV_NAME_SZ];
+
+//offline scan alignment, O_DIRECT needs the buffer, offset and length 4k aligned
+#define WAL_SCAN_ALIGN			4096
+#define WAL_SCAN_ALIGN_MASK		(~((off64_t)WAL_SCAN_ALIGN - 1))
+#define WAL_SCAN_CHUNK_MB		4
+#define WAL_SCAN_NAME_MAX		200	//max replay file name, longer keys get a hashed suffix
+
+//why the scan of a buffer stopped
+#define WAL_SCAN_STOP_END		0	//reached the end of the buffer
+#define WAL_SCAN_STOP_EMPTY		1	//zeroed header, nothing was logged after this point
+#define WAL_SCAN_STOP_NO_SEQ	2	//buffer has never been used
+#define WAL_SCAN_STOP_BAD_HDR	3	//object header does not verify
+#define WAL_SCAN_STOP_BAD_ADDR	4	//record runs past the end of the buffer
+#define WAL_SCAN_STOP_CHKSUM	5	//checksum does not match the buffer sequence
+#define WAL_SCAN_STOP_IO		6	//read error
+
+static const char *wal_scan_stop_str[] = {
+	"end", "empty", "no_seq", "bad_hdr", "bad_addr", "chksum", "io"
+};
+
+typedef struct wal_scan_opt_s {
+	char	*dev_name;
+	char	*replay_dir;
+	int		nr_threads;
+	int64_t	chunk_sz;
+	int		verbose;
+	int		direct;
 	int		fh;
-	wal_sb_t 	*sb;
-	wal_zone_t	 **zones;
-	wal_map_t **maps;
-} wal_device_info_t;
+	int		replay_fh;	//buffered handle for value reads during replay
+} wal_scan_opt_t;
+
+//latest record of a key in the zone
+typedef struct wal_scan_item_s {
+	off64_t	val_addr;
+	int32_t	val_sz;
+	int32_t	rec_sz;
+	int32_t	is_del;
+} wal_scan_item_t;
+
+typedef struct wal_scan_buffer_s {
+	wal_buffer_hdr_t hdr;
+	off64_t	data_start;
+	off64_t	stop_pos;
+	int32_t	stop_reason;
+	int64_t	nr_record;
+	int64_t	used_bytes;
+} wal_scan_buffer_t;
+
+typedef struct wal_scan_zone_s {
+	int32_t	zone_id;
+	off64_t	start;
+	off64_t	size;
+	int32_t	rc;
+	wal_scan_buffer_t log;
+	wal_scan_buffer_t flush;
+	std::unordered_map<std::string, wal_scan_item_t> index;
+
+	int64_t	nr_live;
+	int64_t	nr_del;
+	int64_t	nr_overwrite;
+	int64_t	live_bytes;
+	int64_t	read_bytes;
+	int64_t	nr_replay;
+	int64_t	nr_replay_fail;
+} wal_scan_zone_t;
+
+//per thread read window over the device
+typedef struct wal_scan_reader_s {
+	char	*buf;
+	int64_t	buf_sz;
+	off64_t	win_off;
+	int64_t	win_len;
+	int64_t	read_bytes;
+} wal_scan_reader_t;
 
-int sync_bdev_write(int handle, const void *buff, uint64_t offset, uint64_t nbytes,
-		    void *cb, void *cb_arg)
-{
-	return pwrite(handle, buff, nbytes, offset);
-}
+int __wal_obj_hdr_sz = sizeof(wal_obj_hdr_t);
+int	__wal_obj_chksum_sz = sizeof(wal_obj_checksum_t);
+int __buffer_alignment = WAL_ALIGN;
+
+static wal_scan_opt_t g_opt;
+static wal_sb_t *g_sb;
+static wal_scan_zone_t *g_zones;
+static int g_next_zone = 0;
 
 int sync_bdev_read(int handle, void *buff, uint64_t offset, uint64_t nbytes,
 		   void *cb, void *cb_arg)
 {
-	return pread(handle, buff, nbytes, offset);
+	uint64_t done = 0;
+	ssize_t rc;
+
+	while (done < nbytes) {
+		rc = pread(handle, (char *)buff + done, nbytes - done, offset + done);
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if (rc == 0)
+			break;
+		done += rc;
+	}
+	return done;
 }
 
 inline int sync_bdev_open(const char *pathname, int flags)
@@ -293,471 +315,563 @@ int wal_log_show_sb(wal_sb_t *sb)
 	return 0;
 }
 
-typedef int (* read_object_t)(struct wal_buffer_s *buffer, wal_object_t *obj, int64_t src_addr,
-			      int sz, int is_data_read);
-typedef int (*get_object_size_t)(wal_object_t *obj);
-
-int wal_log_get_object_size(wal_object_t *obj)
+uint32_t hash_sdbm(const char *data, int sz)
 {
-	int record_sz = obj->key->length + obj->val->length +
-			sizeof(wal_obj_hdr_t) + sizeof(wal_obj_checksum_t);
-	record_sz += (WAL_ALIGN - 1);
-	record_sz &= (WAL_ALIGN_MASK);
-	return record_sz;
+	uint32_t hash = 0;
+	int count = 0;
+	while (count < sz) {
+		hash = data[count] + (hash << 6) + (hash << 16) - hash;
+		count++;
+	}
+	return hash;
 }
 
-//1. allocate space in log buffer
-//2. write the object in the log buffer
-int __wal_obj_hdr_sz = sizeof(wal_obj_hdr_t);
-int	__wal_obj_chksum_sz = sizeof(wal_obj_checksum_t);
-int __buffer_alignment = WAL_ALIGN;
-
-int wal_log_read_object(wal_buffer_t *buffer, wal_object_t *obj,
-			int64_t src_addr, int sz, int is_data_read)
+bool log_verify_object_hdr(wal_obj_hdr_t *obj_hdr)
 {
-	wal_buffer_hdr_t *hdr = &buffer->hdr;
-	off64_t addr = (off64_t)src_addr;
-	off64_t addr2 = 0;
-	wal_obj_hdr_t oh;
-	wal_obj_checksum_t ch;
-	int rc = 0;
-
-	if ((rc = sync_bdev_read(buffer->fh, (void *)&oh, addr, sizeof(wal_obj_hdr_t), NULL, NULL))
-	    < sizeof(wal_obj_hdr_t)) {
-		rc = - WAL_ERROR_RD_LESS;
-		goto done;
-	}
+	if (obj_hdr->addr != __wal_obj_hdr_sz)
+		return false;
 
-	addr += rc;
+	if (obj_hdr->key_sz <= 0 || obj_hdr->val_sz < 0)
+		return false;
 
-	//verify the object.
-	addr2 = addr + oh.key_sz + oh.val_sz;
-	if (addr2 >= buffer->hdr.end_addr) {
-		rc = - WAL_ERROR_BAD_ADDR;
-		goto done;
-	}
-
-	rc = sync_bdev_read(buffer->fh, (void *)&ch, addr2, sizeof(wal_obj_checksum_t), NULL, NULL);
-	if (rc < sizeof(wal_obj_checksum_t)) {
-		rc = -WAL_ERROR_RD_LESS;
-		goto done;
-	}
-
-	addr2 += rc;
+	if (obj_hdr->sz_blk != (__wal_obj_hdr_sz + __wal_obj_chksum_sz + obj_hdr->key_sz + obj_hdr->val_sz +
+				__buffer_alignment - 1) >> WAL_ALIGN_OFFSET)
+		return false;
 
-	if (ch.chksum != hdr->sequence) {
-		rc = -WAL_ERROR_BAD_CHKSUM;
-		goto done;
-	}
+	return true;
+}
 
-	//allocate key and data buffer if not enough.
-	if (obj->key->length < oh.key_sz) {
-		if (obj->key->key)
-			free(obj->key->key);
-		obj->key->key = malloc(oh.key_sz);
-		obj->key->length = oh.key_sz;
-	}
+static void *wal_scan_alloc(int64_t sz)
+{
+	void *buf = NULL;
+	if (posix_memalign(&buf, WAL_SCAN_ALIGN, sz))
+		return NULL;
+	return buf;
+}
 
-	if (is_data_read) {
-		if (obj->val->length < oh.val_sz) {
-			if (obj->val->value)
-				free(obj->val->value);
-			obj->val->value = malloc(oh.val_sz);
-			obj->val->offset = 0;
-			obj->val->length = oh.val_sz;
+//make [pos, pos + len) resident in the reader window.
+//the tail of the current window is carried over so sequential records are read once,
+//the window grows if a single record is larger than the chunk size.
+//returns pointer to pos in the window, NULL on read error or short read.
+static char *wal_scan_fetch(wal_scan_reader_t *rd, off64_t pos, int64_t len, off64_t limit)
+{
+	off64_t a_pos, a_end, a_limit;
+	int64_t keep = 0, need, rd_sz;
+	int rc;
+
+	if (pos >= rd->win_off && pos + len <= rd->win_off + rd->win_len)
+		return rd->buf + (pos - rd->win_off);
+
+	a_pos = pos & WAL_SCAN_ALIGN_MASK;
+	a_end = (pos + len + WAL_SCAN_ALIGN - 1) & WAL_SCAN_ALIGN_MASK;
+	a_limit = (limit + WAL_SCAN_ALIGN - 1) & WAL_SCAN_ALIGN_MASK;
+
+	need = a_end - a_pos;
+	if (need < g_opt.chunk_sz)
+		need = g_opt.chunk_sz;
+	if (a_pos + need > a_limit)
+		need = a_limit - a_pos;
+
+	if (need > rd->buf_sz) {
+		char *buf = (char *)wal_scan_alloc(need);
+		if (!buf)
+			return NULL;
+		if (rd->win_len && a_pos >= rd->win_off && a_pos < rd->win_off + rd->win_len) {
+			keep = rd->win_off + rd->win_len - a_pos;
+			memcpy(buf, rd->buf + (a_pos - rd->win_off), keep);
 		}
-	} else {
-		obj->val->length = oh.val_sz;
-	}
-
-	//read key
-	rc = sync_bdev_read(buffer->fh, (void *)obj->key->key, addr, oh.key_sz, NULL, NULL);
-	if (rc < oh.key_sz) {
-		rc = -WAL_ERROR_RD_LESS;
-		goto done;
+		free(rd->buf);
+		rd->buf = buf;
+		rd->buf_sz = need;
+	} else if (rd->win_len && a_pos >= rd->win_off && a_pos < rd->win_off + rd->win_len) {
+		keep = rd->win_off + rd->win_len - a_pos;
+		memmove(rd->buf, rd->buf + (a_pos - rd->win_off), keep);
 	}
 
-	//read data
-	if (is_data_read && oh.val_sz) {
-		addr += rc;
-		rc = sync_bdev_read(buffer->fh, (void *)obj->val->value, addr, oh.val_sz, NULL, NULL);
-		if (rc < oh.val_sz) {
-			rc = -WAL_ERROR_RD_LESS;
-			goto done;
-		}
+	//keep is 4k aligned unless the window was cut short by the limit
+	if (keep & (WAL_SCAN_ALIGN - 1))
+		keep = 0;
 
-		obj->val->length = oh.val_sz;
-		addr += oh.val_sz;
-	} else {
-		addr += (rc + oh.val_sz);
+	rd->win_off = a_pos;
+	rd_sz = need - keep;
+	rc = sync_bdev_read(g_opt.fh, rd->buf + keep, a_pos + keep, rd_sz, NULL, NULL);
+	if (rc < 0) {
+		rd->win_len = 0;
+		return NULL;
 	}
+	rd->read_bytes += rc;
+	rd->win_len = keep + rc;
 
-	rc = addr - src_addr;
-	if ((rc + WAL_ALIGN - 1) / __buffer_alignment != oh.sz_blk) {
-		rc = -WAL_ERROR_RECORD_SZ;
-		goto done;
-	}
+	if (pos + len > rd->win_off + rd->win_len)
+		return NULL;
 
-	obj->key->length = oh.key_sz;
-	rc = oh.sz_blk * __buffer_alignment;
+	return rd->buf + (pos - rd->win_off);
+}
 
-done:
-	printf("hdr role %d s_addr 0x%llx key 0x%llx oh.state 0x%x val_size %d seq %ld rc %d\n",
-	       hdr->role, hdr->start_addr, *(long long *)obj->key->key, oh.state, oh.val_sz, ch.chksum, rc);
-	return rc;
+static void wal_scan_print_record(wal_scan_zone_t *zone, wal_scan_buffer_t *buffer,
+				  off64_t pos, wal_obj_hdr_t *oh, const char *key)
+{
+	char key_str[2 * 16 + 1];
+	int i, n = oh->key_sz < 16 ? oh->key_sz : 16;
 
-}
+	for (i = 0; i < n; i++)
+		sprintf(key_str + 2 * i, "%02x", (unsigned char)key[i]);
+	key_str[2 * n] = 0;
 
-wal_device_info_t dev_info;
-wal_sb_t sb;
+	printf("zone[%d] %s pos 0x%llx key %s%s key_sz %d val_sz %d state 0x%x blk %d\n",
+	       zone->zone_id, buffer->hdr.role & WAL_BUFFER_ROLE_FLUSH ? "flush" : "log",
+	       (long long)pos, key_str, oh->key_sz > 16 ? ".." : "",
+	       oh->key_sz, oh->val_sz, oh->state, oh->sz_blk);
+}
 
-int wal_log_iterate_object(wal_buffer_t *buffer,
-			   wal_object_t *obj, off64_t *log_pos, int is_data_read)
+//walk the records of one buffer in log order and index them by key,
+//later records replace earlier ones so the flush buffer must be scanned first.
+static void wal_scan_buffer(wal_scan_reader_t *rd, wal_scan_zone_t *zone,
+			    wal_scan_buffer_t *buffer)
 {
 	wal_buffer_hdr_t *hdr = &buffer->hdr;
-	int rc = 0;
-	off64_t addr = * log_pos;
+	off64_t pos = buffer->data_start;
+	off64_t end = hdr->end_addr;
+	wal_obj_hdr_t *oh;
+	wal_obj_checksum_t ch;
+	char *rec, *key;
+	int64_t rec_sz;
 
+	buffer->stop_reason = WAL_SCAN_STOP_END;
 	if (!hdr->sequence) {
-		return -WAL_ERROR_INVALID_SEQ;
+		buffer->stop_reason = WAL_SCAN_STOP_NO_SEQ;
+		buffer->stop_pos = pos;
+		return;
 	}
 
-	if (addr == hdr->start_addr) { // for the first object
-		addr = hdr->start_addr + sizeof(wal_buffer_hdr_t) + WAL_ALIGN - 1;
-		addr = addr & WAL_ALIGN_MASK;
-	}
+	while (pos + WAL_ALIGN <= end) {
+		oh = (wal_obj_hdr_t *)wal_scan_fetch(rd, pos, WAL_ALIGN, end);
+		if (!oh) {
+			buffer->stop_reason = WAL_SCAN_STOP_IO;
+			break;
+		}
 
-	* log_pos = addr;
-	rc = wal_log_read_object(buffer, obj, addr, 0, is_data_read);
-	if (rc > 0)
-		* log_pos += rc;
+		if (!oh->sz_blk && !oh->key_sz && !oh->val_sz && !oh->addr) {
+			buffer->stop_reason = WAL_SCAN_STOP_EMPTY;
+			break;
+		}
 
-	return rc;
+		if (!log_verify_object_hdr(oh)) {
+			buffer->stop_reason = WAL_SCAN_STOP_BAD_HDR;
+			break;
+		}
 
-}
+		rec_sz = (int64_t)oh->sz_blk << WAL_ALIGN_OFFSET;
+		if (pos + rec_sz > end) {
+			buffer->stop_reason = WAL_SCAN_STOP_BAD_ADDR;
+			break;
+		}
 
-int wal_key_compare(wal_key_t *k1, wal_key_t *k2)
-{
-	if (k1->length != k2->length)
-		return -1;
+		rec = wal_scan_fetch(rd, pos, rec_sz, end);
+		if (!rec) {
+			buffer->stop_reason = WAL_SCAN_STOP_IO;
+			break;
+		}
+		oh = (wal_obj_hdr_t *)rec;
+		key = rec + __wal_obj_hdr_sz;
+		//the checksum follows the value unaligned
+		memcpy(&ch, key + oh->key_sz + oh->val_sz, sizeof(ch));
+		if (ch.chksum != hdr->sequence) {
+			buffer->stop_reason = WAL_SCAN_STOP_CHKSUM;
+			break;
+		}
 
-	return memcmp(k1->key, k2->key, k1->length);
-}
+		if (g_opt.verbose)
+			wal_scan_print_record(zone, buffer, pos, oh, key);
 
-typedef enum wal_map_insert_type_s {
-	WAL_MAP_INSERT_NEW = 0,		//new object
-	WAL_MAP_OVERWRITE_APPEND,	//update by append
-	WAL_MAP_OVERWRITE_INPLACE,	//update by inplace if possible
-	WAL_MAP_OVERWRITE_DELETE,	//insert object by mark it deleted (for append only log devices)
-	WAL_MAP_INSERT_UNKNOWN
-} wal_map_insert_t;
-
-typedef enum wal_map_lookup_type_s {
-	WAL_MAP_LOOKUP_WRITE_APPEND,	//for device log
-	WAL_MAP_LOOKUP_WRITE_INPLACE,	//for in mem cache
-	WAL_MAP_LOOKUP_DELETE,			//invalid the object in memory as well as log devices.
-	WAL_MAP_LOOKUP_READ,			//for lookup only
-	WAL_MAP_LOOKUP_INVALIDATE,		//invalid the object in memory.
-
-	WAL_MAP_LOOKUP_WRITE_INPLACE_TRY_BEST,	//for inplace overwrite on cache not ready condition (flushing and cache full)
-	// only overwrite existed valid object inplace or return retry code
-	WAL_MAP_LOOKUP_UNKNOWN
-} wal_map_lookup_type_t;
-
-wal_key_t *wal_key_clone(wal_key_t *src_key)
-{
-	wal_key_t *clone = (wal_key_t *)calloc(1, sizeof(wal_key_t));
-	clone->length = src_key->length;
-	clone->key = malloc(clone->length);
-	memcpy(clone->key, src_key->key, clone->length);
-	return clone;
+		wal_scan_item_t item;
+		item.val_addr = pos + __wal_obj_hdr_sz + oh->key_sz;
+		item.val_sz = oh->val_sz;
+		item.rec_sz = rec_sz;
+		item.is_del = (oh->state == WAL_ITEM_INVALID || !oh->val_sz);
+
+		std::pair<std::unordered_map<std::string, wal_scan_item_t>::iterator, bool> ins =
+			zone->index.insert(std::make_pair(std::string(key, oh->key_sz), item));
+		if (!ins.second) {
+			zone->nr_overwrite++;
+			ins.first->second = item;
+		}
+
+		buffer->nr_record++;
+		buffer->used_bytes += rec_sz;
+		pos += rec_sz;
+	}
+
+	buffer->stop_pos = pos;
 }
 
-uint32_t hash_sdbm(const char *data, int sz)
+static void wal_scan_replay_name(char *name, const std::string &key)
 {
-	uint32_t hash = 0;
-	int count = 0;
-	while (count < sz) {
-		hash = data[count] + (hash << 6) + (hash << 16) - hash;
-		count++;
-	}
-	return hash;
+	int i, n = key.size();
+	int hex_n = n;
+
+	if (2 * n > WAL_SCAN_NAME_MAX)
+		hex_n = (WAL_SCAN_NAME_MAX - 9) / 2;
+
+	for (i = 0; i < hex_n; i++)
+		sprintf(name + 2 * i, "%02x", (unsigned char)key[i]);
+	name[2 * hex_n] = 0;
+
+	if (hex_n < n)
+		sprintf(name + 2 * hex_n, "~%08x", hash_sdbm(key.data(), n));
 }
 
-//need to rewrite this function: TBD to be debug!!! here
-int32_t wal_map_recover_object(void *context,
-			       wal_map_t *map, wal_object_t *obj, int read_data)
+//write the latest value of each key in the zone to <replay_dir>/<hex key>,
+//keys whose latest record is a delete are removed from the store.
+//keys map to exactly one zone so zones can be replayed concurrently.
+static void wal_scan_replay_zone(wal_scan_zone_t *zone)
 {
-	wal_buffer_t *log_buffer = (wal_buffer_t *)context;
-	wal_buffer_hdr_t *buff_hdr = &log_buffer->hdr;
-	obj->key_hash = hash_sdbm((const char *)obj->key->key, obj->key->length);
-	int bucket_idx = obj->key_hash % map->nr_buckets;
-	wal_bucket_t *bucket = &map->table[bucket_idx];
-	int nr_items = bucket->total_nr_entries;
-	wal_map_item_t *item = bucket->entry;
-	wal_map_item_t *pre_item = NULL;
-	wal_map_item_t *invalid_item = NULL;
-
-	off64_t pos = buff_hdr->curr_pos;
-
-	int cache_size_kb = 0;
-	int overwrite = 0;
-	int val_buffer_reuse = 0;
-	int rc = 0;
-
-	while (nr_items--) {
-
-		if (item->status == WAL_ITEM_INVALID) { //been deleted/invalidated with enough
-			invalid_item = item;
-			pre_item = item;
-			item = item->next;
+	char path[PATH_MAX];
+	char name[WAL_SCAN_NAME_MAX + 1];
+	char *val = NULL;
+	int32_t val_buf_sz = 0;
+	int dir_len = strlen(g_opt.replay_dir);
+	int fd, rc;
+
+	std::unordered_map<std::string, wal_scan_item_t>::iterator it;
+	for (it = zone->index.begin(); it != zone->index.end(); it++) {
+		wal_scan_item_t *item = &it->second;
+
+		wal_scan_replay_name(name, it->first);
+		snprintf(path, sizeof(path), "%.*s/%s", dir_len, g_opt.replay_dir, name);
+
+		if (item->is_del) {
+			if (unlink(path) && errno != ENOENT)
+				zone->nr_replay_fail++;
+			else
+				zone->nr_replay++;
 			continue;
 		}
 
-		if (wal_key_compare(obj->key, item->key)) {
-			pre_item = item;
-			item = item->next;
-		} else {
-			//found the same object
-			item->status = WAL_ITEM_INVALID;
-			bucket->valid_nr_entries --;
-			if (!obj->val->length) { //deletion record
-				ATOMIC_DEC_FETCH(log_buffer->nr_objects_inserted);
-				printf("wal_map_recover_object delete zone[%d] map[%d] 0x%llx%llx\n", log_buffer->zone->zone_id,
-				       bucket_idx, *(long long *)item->key->key, *(long long *)(item->key->key + 8));
-				return rc;
-
-			} else {
-				printf("wal_map_recover_object overwrite zone[%d] map[%d] 0x%llx%llx\n", log_buffer->zone->zone_id,
-				       bucket_idx, *(long long *)item->key->key, *(long long *)(item->key->key + 8));
-
+		if (item->val_sz > val_buf_sz) {
+			free(val);
+			val = (char *)malloc(item->val_sz);
+			val_buf_sz = item->val_sz;
+			if (!val) {
+				val_buf_sz = 0;
+				zone->nr_replay_fail++;
+				continue;
 			}
-			overwrite = 1;
-			break;
 		}
-	}
-
-	if (!item && invalid_item) {
-		item = invalid_item;
-	}
 
-	if (item) {
-		if (!overwrite) { //new key
-			if (item->key_buff_size < obj->key->length) {
-				free(item->key->key);
-				item->key = wal_key_clone(obj->key);
-				item->key_buff_size = obj->key->length;
-			} else {
-				memcpy(item->key->key, obj->key->key, obj->key->length);
-				item->key->length = obj->key->length;
-			}
+		rc = sync_bdev_read(g_opt.replay_fh, val, item->val_addr, item->val_sz, NULL, NULL);
+		if (rc != item->val_sz) {
+			zone->nr_replay_fail++;
+			continue;
 		}
 
-		if (read_data) {
-			//reuse the existed buffer if possible
-			if (item->val_size >= obj->val->length) {
-				pos = item->addr;
-				item->val_size = obj->val->length;
-				val_buffer_reuse = 1;
-			} else {
-				;
-				//allocate new data value buffer
-			}
+		fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			zone->nr_replay_fail++;
+			continue;
 		}
+		if (write(fd, val, item->val_sz) != item->val_sz)
+			zone->nr_replay_fail++;
+		else
+			zone->nr_replay++;
+		close(fd);
 	}
 
-	if (!item) { //need a new map item entry
-		wal_map_item_t *new_item = (wal_map_item_t *)calloc(1, sizeof(wal_map_item_t));
-		new_item->key = wal_key_clone(obj->key);
-		new_item->key_buff_size = obj->key->length;
-		new_item->next = NULL;
-		new_item->buffer_ptr = context;
-		if (pre_item)
-			pre_item->next = new_item;
-		else
-			bucket->entry = new_item; // first item in the bucket
+	free(val);
+}
 
-		item = new_item;
+//read both buffer headers of the zone and tell the log from the flush buffer,
+//the log buffer always carries the newer sequence.
+static int wal_scan_zone_hdr(wal_scan_reader_t *rd, wal_scan_zone_t *zone)
+{
+	wal_buffer_hdr_t hdr1, hdr2;
+	off64_t pos1 = zone->start, pos2 = zone->start + zone->size / 2;
+	char *p;
 
+	p = wal_scan_fetch(rd, pos1, sizeof(wal_buffer_hdr_t), pos1 + WAL_SCAN_ALIGN);
+	if (!p)
+		return -WAL_ERROR_RD_LESS;
+	memcpy(&hdr1, p, sizeof(hdr1));
+
+	p = wal_scan_fetch(rd, pos2, sizeof(wal_buffer_hdr_t), pos2 + WAL_SCAN_ALIGN);
+	if (!p)
+		return -WAL_ERROR_RD_LESS;
+	memcpy(&hdr2, p, sizeof(hdr2));
+
+	if (!(hdr1.role & WAL_BUFFER_ROLE_FLUSH)) {
+		if (hdr1.sequence < hdr2.sequence)
+			return -WAL_ERROR_BUFFER_ROLE;
+		zone->log.hdr = hdr1;
+		zone->flush.hdr = hdr2;
+	} else {
+		if (hdr1.sequence > hdr2.sequence)
+			return -WAL_ERROR_BUFFER_ROLE;
+		zone->log.hdr = hdr2;
+		zone->flush.hdr = hdr1;
 	}
 
-	if (!overwrite)
-		printf("wal_map_recover_object new zone[%d] map[%d] 0x%llx%llx val_sz %d\n",
-		       log_buffer->zone->zone_id,
-		       bucket_idx, *(long long *)item->key->key, *(long long *)(item->key->key + 8), obj->val->length);
+	if (zone->log.hdr.start_addr < zone->start ||
+	    zone->log.hdr.end_addr > zone->start + zone->size ||
+	    zone->flush.hdr.start_addr < zone->start ||
+	    zone->flush.hdr.end_addr > zone->start + zone->size)
+		return -WAL_ERROR_BAD_ADDR;
 
-	item->status = WAL_ITEM_VALID;
-	bucket->valid_nr_entries ++;
-	if (bucket->valid_nr_entries > bucket->total_nr_entries)
-		bucket->total_nr_entries = bucket->valid_nr_entries;
+	zone->log.data_start = (zone->log.hdr.start_addr + sizeof(wal_buffer_hdr_t) + WAL_ALIGN - 1) &
+			       WAL_ALIGN_MASK;
+	zone->flush.data_start = (zone->flush.hdr.start_addr + sizeof(wal_buffer_hdr_t) + WAL_ALIGN - 1) &
+				 WAL_ALIGN_MASK;
+	return 0;
+}
 
-	if (read_data) {
-		memcpy((void *)pos, obj->val->value + obj->val->offset, obj->val->length);
-		item->addr = pos;
-	}
+static void wal_scan_zone(wal_scan_reader_t *rd, wal_scan_zone_t *zone)
+{
+	rd->win_len = 0;
+	rd->read_bytes = 0;
 
-	if (!overwrite)
-		ATOMIC_INC(log_buffer->nr_objects_inserted);
+	zone->rc = wal_scan_zone_hdr(rd, zone);
+	if (zone->rc)
+		return;
 
-	if (read_data && !val_buffer_reuse) {
-		//mem cache pos
-		cache_size_kb = (obj->val->length + __buffer_alignment - 1) >> WAL_ALIGN_OFFSET;
-		buff_hdr->curr_pos += (cache_size_kb << WAL_ALIGN_OFFSET);
+	wal_scan_buffer(rd, zone, &zone->flush);
+	wal_scan_buffer(rd, zone, &zone->log);
+	zone->read_bytes = rd->read_bytes;
+
+	std::unordered_map<std::string, wal_scan_item_t>::iterator it;
+	for (it = zone->index.begin(); it != zone->index.end(); it++) {
+		if (it->second.is_del) {
+			zone->nr_del++;
+		} else {
+			zone->nr_live++;
+			zone->live_bytes += it->second.rec_sz;
+		}
 	}
 
-	return rc;
+	if (g_opt.replay_dir)
+		wal_scan_replay_zone(zone);
 
+	zone->index.clear();
 }
 
-void wal_map_bucket_list_update(wal_map_t *map, wal_bucket_t *bucket)
+static void *wal_scan_worker(void *arg)
 {
-	list_add_tail(&bucket->link, &map->head);
+	wal_scan_reader_t rd;
+	int i;
+
+	memset(&rd, 0, sizeof(rd));
+	while ((i = ATOMIC_INC(g_next_zone)) < g_sb->nr_zone)
+		wal_scan_zone(&rd, &g_zones[i]);
+
+	free(rd.buf);
+	return NULL;
 }
 
-wal_map_t *wal_map_create(int nr_buckets)
+static void wal_scan_report(double elapsed)
 {
-	int i = 0;
-	wal_map_t *map = (wal_map_t *)calloc(1, sizeof(wal_map_t));
-	wal_bucket_t *bucket;
-	map->nr_buckets = nr_buckets;
-	map->table = (wal_bucket_t *)calloc(nr_buckets, sizeof(wal_bucket_t));
-	bucket = map->table;
-	INIT_LIST_HEAD(&map->head);
-	for (; i < nr_buckets; i++, bucket ++) {
-		INIT_LIST_HEAD(&bucket->link);
+	int64_t nr_record = 0, nr_live = 0, nr_del = 0, nr_overwrite = 0;
+	int64_t used = 0, live = 0, cap = 0, read_bytes = 0;
+	int64_t nr_replay = 0, nr_replay_fail = 0;
+	int i, nr_fail = 0;
+
+	printf("%-5s %5s %5s %9s %9s %8s %9s %9s %9s %9s %-13s %-13s\n",
+	       "zone", "lseq", "fseq", "records", "live", "deleted", "overwrite",
+	       "used_kb", "dead_kb", "free_kb", "flush_stop", "log_stop");
+
+	for (i = 0; i < g_sb->nr_zone; i++) {
+		wal_scan_zone_t *zone = &g_zones[i];
+		int64_t z_used, z_cap;
+		char fstop[32], lstop[32];
+
+		if (zone->rc) {
+			printf("%-5d failed rc %d\n", zone->zone_id, zone->rc);
+			nr_fail++;
+			continue;
+		}
+
+		z_used = zone->flush.used_bytes + zone->log.used_bytes;
+		z_cap = (zone->flush.hdr.end_addr - zone->flush.data_start) +
+			(zone->log.hdr.end_addr - zone->log.data_start);
+		snprintf(fstop, sizeof(fstop), "%s@%llx", wal_scan_stop_str[zone->flush.stop_reason],
+			 (long long)(zone->flush.stop_pos - zone->flush.hdr.start_addr));
+		snprintf(lstop, sizeof(lstop), "%s@%llx", wal_scan_stop_str[zone->log.stop_reason],
+			 (long long)(zone->log.stop_pos - zone->log.hdr.start_addr));
+
+		printf("%-5d %5d %5d %9lld %9lld %8lld %9lld %9lld %9lld %9lld %-13s %-13s\n",
+		       zone->zone_id, zone->log.hdr.sequence, zone->flush.hdr.sequence,
+		       (long long)(zone->flush.nr_record + zone->log.nr_record),
+		       (long long)zone->nr_live, (long long)zone->nr_del, (long long)zone->nr_overwrite,
+		       (long long)(z_used >> 10), (long long)((z_used - zone->live_bytes) >> 10),
+		       (long long)((z_cap - z_used) >> 10), fstop, lstop);
+
+		nr_record += zone->flush.nr_record + zone->log.nr_record;
+		nr_live += zone->nr_live;
+		nr_del += zone->nr_del;
+		nr_overwrite += zone->nr_overwrite;
+		used += z_used;
+		live += zone->live_bytes;
+		cap += z_cap;
+		read_bytes += zone->read_bytes;
+		nr_replay += zone->nr_replay;
+		nr_replay_fail += zone->nr_replay_fail;
 	}
-	return map;
+
+	printf("total: zones %d failed %d records %lld live %lld deleted %lld overwrite %lld\n",
+	       g_sb->nr_zone, nr_fail, (long long)nr_record, (long long)nr_live,
+	       (long long)nr_del, (long long)nr_overwrite);
+	printf("space: used %lld KB live %lld KB dead %lld KB free %lld KB (%.1f%% dead of used)\n",
+	       (long long)(used >> 10), (long long)(live >> 10), (long long)((used - live) >> 10),
+	       (long long)((cap - used) >> 10), used ? 100.0 * (used - live) / used : 0.0);
+	printf("scan: %d threads chunk %lld KB %s read %lld MB in %.3f s (%.1f MB/s)\n",
+	       g_opt.nr_threads, (long long)(g_opt.chunk_sz >> 10), g_opt.direct ? "direct" : "buffered",
+	       (long long)(read_bytes >> 20), elapsed, elapsed > 0 ? (read_bytes / 1048576.0) / elapsed : 0.0);
+	if (g_opt.replay_dir)
+		printf("replay: %s applied %lld failed %lld\n",
+		       g_opt.replay_dir, (long long)nr_replay, (long long)nr_replay_fail);
 }
 
-int wal_log_recover_zone_buffer(wal_device_info_t *dev_info,
-				off64_t pos, int32_t sz_mb, wal_zone_t *zone)
+static void usage(const char *prog)
 {
-	wal_buffer_t *buffer1, * buffer2;
-	off64_t next_pos = 0;
-	buffer1 = (wal_buffer_t *)calloc(1, sizeof(wal_buffer_t));
-	buffer2 = (wal_buffer_t *)calloc(1, sizeof(wal_buffer_t));
-
-	int read_sz = sync_bdev_read(dev_info->fh, &buffer1->hdr, pos, sizeof(wal_buffer_hdr_t), NULL,
-				     NULL);
-	if (read_sz < sizeof(wal_buffer_hdr_t))
-		return -WAL_ERROR_RD_LESS;
-
-	next_pos = pos + ((sz_mb / 2) << 20);
-	read_sz = sync_bdev_read(dev_info->fh, &buffer2->hdr, next_pos, sizeof(wal_buffer_hdr_t), NULL,
-				 NULL);
-	if (read_sz < sizeof(wal_buffer_hdr_t))
-		return -WAL_ERROR_RD_LESS;
-
-	printf("wal_recover_zone_buffer: zone %d start 0x%llx pos 0x%llx sz 0x%lx mb\n",
-	       zone->zone_id, (long long)buffer1->hdr.start_addr, (long long)pos, (unsigned long)sz_mb);
+	printf("usage: %s [-t nr_threads] [-c chunk_mb] [-r replay_dir] [-v] <wal log device>\n", prog);
+	printf("\t-t nr_threads\tzones scanned in parallel (default: min(nr_zone, nr_cpu))\n");
+	printf("\t-c chunk_mb\tread size per device access (default: %d)\n", WAL_SCAN_CHUNK_MB);
+	printf("\t-r replay_dir\twrite the latest value of each key to replay_dir/<hex key>\n");
+	printf("\t-v\t\tprint every valid record\n");
+}
 
-	buffer1->hdr.curr_pos = buffer1->hdr.start_addr;
-	buffer2->hdr.curr_pos = buffer2->hdr.start_addr;
+int main(int argc, char **argv)
+{
+	struct timespec ts_start, ts_end;
+	pthread_t *threads = NULL;
+	int32_t sb_sz = sizeof(wal_sb_t);
+	int i, c, nr_started, rc = -1;
 
-	buffer1->map = wal_map_create(WAL_MAX_BUCKET);
-	buffer2->map = wal_map_create(WAL_MAX_BUCKET);
+	g_opt.chunk_sz = (int64_t)WAL_SCAN_CHUNK_MB * MB;
+	g_opt.fh = g_opt.replay_fh = -1;
 
-	buffer1->zone = buffer2->zone = zone;
+	while ((c = getopt(argc, argv, "t:c:r:vh")) != -1) {
+		switch (c) {
+		case 't':
+			g_opt.nr_threads = atoi(optarg);
+			break;
+		case 'c':
+			g_opt.chunk_sz = (int64_t)atoi(optarg) * MB;
+			break;
+		case 'r':
+			g_opt.replay_dir = optarg;
+			break;
+		case 'v':
+			g_opt.verbose = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : -1;
+		}
+	}
 
-	if (!(buffer1->hdr.role & WAL_BUFFER_ROLE_FLUSH)) {
-		if (buffer1->hdr.sequence < buffer2->hdr.sequence)
-			return -WAL_ERROR_BUFFER_ROLE;
-		zone->log = buffer1;
-		zone->flush = buffer2;
-	} else {
-		if (buffer1->hdr.sequence > buffer2->hdr.sequence)
-			return -WAL_ERROR_BUFFER_ROLE;
-		zone->log = buffer2;
-		zone->flush = buffer1;
+	if (optind >= argc || g_opt.chunk_sz <= 0) {
+		usage(argv[0]);
+		return -1;
 	}
-	//zone->log->fh = open(dev_info->dev_name, O_RDWR|O_LARGEFILE);
-	//zone->flush->fh = open(dev_info->dev_name, O_RDWR|O_LARGEFILE);
-	//zone->log->fh = dup(dev_info->fh);
-	//zone->flush->fh = dup(dev_info->fh);
-
-	zone->log->fh = zone->flush->fh = dev_info->fh;
-
-	wal_object_t obj;
-	off64_t log_pos = zone->flush->hdr.start_addr;
-	obj.key = (wal_key_t *)calloc(1, sizeof(wal_key_t));
-	obj.key->key = malloc(4096);
-	obj.key->length = 4096;
-	obj.val = (wal_val_t *)calloc(1, sizeof(wal_val_t));
-	while (wal_log_iterate_object(zone->flush, &obj, &log_pos, 0) >= 0) {
-		//insert into map table
-		wal_map_recover_object(zone->flush, zone->flush->map, &obj, 0);
-		obj.key->length = 4096;
+	g_opt.dev_name = argv[optind];
+
+	g_opt.direct = 1;
+	g_opt.fh = sync_bdev_open(g_opt.dev_name, O_RDONLY | O_DIRECT);
+	if (g_opt.fh < 0 && errno == EINVAL) {
+		//file systems like tmpfs do not support O_DIRECT
+		g_opt.direct = 0;
+		g_opt.fh = sync_bdev_open(g_opt.dev_name, O_RDONLY);
 	}
-
-	log_pos = zone->log->hdr.start_addr;
-	while (wal_log_iterate_object(zone->log, &obj, &log_pos, 0) >= 0) {
-		//insert into map table
-		wal_map_recover_object(zone->log, zone->log->map, &obj, 0);
-		obj.key->length = 4096;
+	if (g_opt.fh < 0) {
+		printf("open %s fail with error %d\n", g_opt.dev_name, errno);
+		return -1;
 	}
 
-	printf("\tlog: t %ld s %llx c %llx e %llx\n",
-	       (long)zone->log->hdr.sequence,
-	       (long long)zone->log->hdr.start_addr,
-	       (long long)zone->log->hdr.curr_pos,
-	       (long long)zone->log->hdr.end_addr);
-	printf("\tflush: t %ld s %llx c %llx e %llx\n",
-	       (long)zone->flush->hdr.sequence,
-	       (long long)zone->flush->hdr.start_addr,
-	       (long long)zone->flush->hdr.curr_pos,
-	       (long long)zone->flush->hdr.end_addr);
+	if (g_opt.replay_dir) {
+		if (mkdir(g_opt.replay_dir, 0755) && errno != EEXIST) {
+			printf("create replay dir %s fail with error %d\n", g_opt.replay_dir, errno);
+			goto exit;
+		}
+		g_opt.replay_fh = sync_bdev_open(g_opt.dev_name, O_RDONLY);
+		if (g_opt.replay_fh < 0) {
+			printf("open %s fail with error %d\n", g_opt.dev_name, errno);
+			goto exit;
+		}
+	}
 
-	return 0;
+	g_sb = (wal_sb_t *)wal_scan_alloc(sb_sz);
+	if (!g_sb)
+		goto exit;
 
-}
+	rc = sync_bdev_read(g_opt.fh, g_sb, WAL_SB_OFFSET, sb_sz, NULL, NULL);
+	if (rc < sb_sz) {
+		printf("sync_log_sb_read rc %d errno %d\n", rc, errno);
+		rc = -WAL_ERROR_RD_LESS;
+		goto exit;
+	}
 
-int wal_log_recover_zones(wal_device_info_t *dev_info, wal_sb_t *sb)
-{
-	wal_zone_t *zone = NULL;
-	//wal_buffer_hdr_t buff_hdr ;
-	//int32_t read_sz = 0 ;
-	int32_t i = 0, rc = 0;
-	//wal_fh fd = dev_info->fh;
-	int nr_zone = sb->nr_zone;
-	off64_t pos = sb->offset;
-	pos = pos << 20;
-	dev_info->zones = (wal_zone_t **)malloc(sizeof(wal_zone_t *) * MAX_ZONE);
-	for (; i < nr_zone; i++) {
-		pos = sb->zone_space[i].addr_mb;
-		pos <<= 20;
-		zone = (wal_zone_t *)malloc(sizeof(wal_zone_t));
-		zone->zone_id = i;
-		dev_info->zones[i] = zone;
-		rc = wal_log_recover_zone_buffer(dev_info, pos, sb->zone_space[i].size_mb, zone);
-		if (rc)
-			break;
+	wal_log_show_sb(g_sb);
+	if (g_sb->magic != WAL_MAGIC) {
+		printf("bad sb magic 0x%x\n", g_sb->magic);
+		rc = -WAL_ERROR_SIGNATURE;
+		goto exit;
+	}
+	if (g_sb->nr_zone <= 0 || g_sb->nr_zone > MAX_ZONE) {
+		printf("bad sb nr_zone %d\n", g_sb->nr_zone);
+		rc = -WAL_ERROR_TOO_MANY_ZONE;
+		goto exit;
 	}
 
-	return rc;
-}
+	g_zones = new wal_scan_zone_t[g_sb->nr_zone]();
+	for (i = 0; i < g_sb->nr_zone; i++) {
+		g_zones[i].zone_id = i;
+		g_zones[i].start = (off64_t)g_sb->zone_space[i].addr_mb << WAL_ZONE_OFFSET;
+		g_zones[i].size = (off64_t)g_sb->zone_space[i].size_mb << WAL_ZONE_OFFSET;
+	}
 
-int main(int argc, char **argv)
-{
-	char *bdev_path = argv[1];
-	int fh = sync_bdev_open(bdev_path, O_RDONLY);
-	if (fh < 0) {
-		printf("open %s fail with error %d\n", bdev_path, errno);
-		return -1;
+	if (g_opt.nr_threads <= 0) {
+		g_opt.nr_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		if (g_opt.nr_threads <= 0)
+			g_opt.nr_threads = 1;
 	}
-	dev_info.fh = fh;
-	sprintf(dev_info.dev_name, "%s\0", bdev_path, strlen(bdev_path));
+	if (g_opt.nr_threads > g_sb->nr_zone)
+		g_opt.nr_threads = g_sb->nr_zone;
 
-	int32_t sb_sz = sizeof(wal_sb_t);
-	int rc = sync_bdev_read(fh, &sb, WAL_SB_OFFSET, sb_sz, NULL, NULL);
-	if (rc < sb_sz) {
-		printf("sync_log_sb_read rc %d errno %d\n", rc, errno);
+	threads = (pthread_t *)calloc(g_opt.nr_threads, sizeof(pthread_t));
+	if (!threads) {
+		printf("alloc %d scan threads fail\n", g_opt.nr_threads);
+		rc = -1;
 		goto exit;
 	}
 
-	dev_info.sb = &sb;
-	wal_log_show_sb(&sb);
+	clock_gettime(CLOCK_MONOTONIC, &ts_start);
+	//workers pull zones until none is left, so fewer threads still scan every zone
+	for (nr_started = 0; nr_started < g_opt.nr_threads; nr_started++) {
+		c = pthread_create(&threads[nr_started], NULL, wal_scan_worker, NULL);
+		if (c) {
+			printf("create scan thread %d fail with error %d\n", nr_started, c);
+			break;
+		}
+	}
+	if (!nr_started)
+		wal_scan_worker(NULL);
+	for (i = 0; i < nr_started; i++)
+		pthread_join(threads[i], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &ts_end);
+	g_opt.nr_threads = nr_started ? nr_started : 1;
+
+	wal_scan_report((ts_end.tv_sec - ts_start.tv_sec) + (ts_end.tv_nsec - ts_start.tv_nsec) / 1e9);
+
+	rc = 0;
+	for (i = 0; i < g_sb->nr_zone; i++) {
+		if (g_zones[i].rc)
+			rc = g_zones[i].rc;
+	}
 
-	wal_log_recover_zones(&dev_info, &sb);
 exit:
-	sync_bdev_close(fh);
+	free(threads);
+	delete [] g_zones;
+	free(g_sb);
+	if (g_opt.replay_fh >= 0)
+		sync_bdev_close(g_opt.replay_fh);
+	sync_bdev_close(g_opt.fh);
+	return rc ? 1 : 0;
 }
@@ -0,0 +1,159 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <wal_commit_ctrl.h>
+
+static inline int64_t wal_commit_ctrl_ewma(int64_t avg, int64_t sample)
+{
+	return avg + ((sample - avg) >> WAL_COMMIT_CTRL_EWMA_SHIFT);
+}
+
+static inline int64_t wal_commit_ctrl_bucket_ns(wal_commit_ctrl_t *ctrl)
+{
+	return ((int64_t)ctrl->target_us * 1000) / (WAL_COMMIT_CTRL_NR_BUCKET / 4);
+}
+
+//derive batch size and timeout from the current observations.
+//the wait budget is what is left of the target after the device write, scaled by the gain.
+static void wal_commit_ctrl_update(wal_commit_ctrl_t *ctrl)
+{
+	int64_t target_ns = (int64_t)ctrl->target_us * 1000;
+	int64_t budget_ns = target_ns - ctrl->device_ns;
+	int64_t wait_ns = 0;
+	int64_t nr;
+
+	if (budget_ns > 0)
+		wait_ns = budget_ns * ctrl->gain / WAL_COMMIT_CTRL_GAIN_ONE;
+
+	//requests expected within the wait, the one opening the group included.
+	//at low rates this is 1 and a request is written as soon as it arrives.
+	nr = ctrl->arrival_ns ? wait_ns / ctrl->arrival_ns + 1 : ctrl->max_nr_obj;
+	if (nr > ctrl->max_nr_obj)
+		nr = ctrl->max_nr_obj;
+	ctrl->batch_nr_obj = (int32_t)nr;
+
+	ctrl->batch_timeout_us = (int32_t)(wait_ns / 1000);
+	if (ctrl->batch_timeout_us < WAL_COMMIT_CTRL_MIN_TIMEOUT_US)
+		ctrl->batch_timeout_us = WAL_COMMIT_CTRL_MIN_TIMEOUT_US;
+	if (ctrl->batch_timeout_us > ctrl->target_us)
+		ctrl->batch_timeout_us = ctrl->target_us;
+}
+
+//close the window: take the p99 from the histogram and correct the gain with it.
+static void wal_commit_ctrl_close_window(wal_commit_ctrl_t *ctrl)
+{
+	int64_t target_ns = (int64_t)ctrl->target_us * 1000;
+	int64_t bucket_ns = wal_commit_ctrl_bucket_ns(ctrl);
+	int64_t rank = ctrl->nr_window_reqs - ctrl->nr_window_reqs / 100;
+	int64_t cum = 0;
+	int64_t p99_ns;
+	int b;
+
+	for (b = 0; b < WAL_COMMIT_CTRL_NR_BUCKET; b++) {
+		cum += ctrl->hist[b];
+		if (cum >= rank)
+			break;
+	}
+
+	p99_ns = (b + 1) * bucket_ns;
+	if (p99_ns > ctrl->window_max_ns)
+		p99_ns = ctrl->window_max_ns;
+	ctrl->p99_us = (int32_t)(p99_ns / 1000);
+
+	if (p99_ns > target_ns) {
+		//back off in proportion to the overshoot
+		ctrl->gain = (int32_t)(ctrl->gain * target_ns / p99_ns);
+		if (ctrl->gain < WAL_COMMIT_CTRL_GAIN_MIN)
+			ctrl->gain = WAL_COMMIT_CTRL_GAIN_MIN;
+	} else if (p99_ns < target_ns - (target_ns >> 3)) {
+		ctrl->gain += (WAL_COMMIT_CTRL_GAIN_MAX - ctrl->gain) >> 2;
+	}
+
+	memset(ctrl->hist, 0, sizeof(ctrl->hist));
+	ctrl->nr_window_batch = 0;
+	ctrl->nr_window_reqs = 0;
+	ctrl->window_max_ns = 0;
+}
+
+void wal_commit_ctrl_init(wal_commit_ctrl_t *ctrl, int target_us, int max_nr_obj)
+{
+	memset(ctrl, 0, sizeof(*ctrl));
+	ctrl->target_us = target_us;
+	ctrl->max_nr_obj = max_nr_obj > 0 ? max_nr_obj : 1;
+	ctrl->gain = WAL_COMMIT_CTRL_GAIN_INIT;
+	//no history yet, start as if idle so that nothing waits.
+	ctrl->arrival_ns = (int64_t)target_us * 1000;
+	wal_commit_ctrl_update(ctrl);
+}
+
+void wal_commit_ctrl_arrival(wal_commit_ctrl_t *ctrl, int64_t interval_ns)
+{
+	//an idle gap only needs to show the rate is low, capping it lets the average
+	//follow the next burst within a few requests.
+	int64_t cap_ns = (int64_t)ctrl->target_us * 1000 * 4;
+
+	if (interval_ns > cap_ns)
+		interval_ns = cap_ns;
+	ctrl->arrival_ns = wal_commit_ctrl_ewma(ctrl->arrival_ns, interval_ns);
+}
+
+bool wal_commit_ctrl_complete(wal_commit_ctrl_t *ctrl, int nr_reqs, int64_t device_ns,
+			      int64_t latency_ns)
+{
+	int64_t b = latency_ns / wal_commit_ctrl_bucket_ns(ctrl);
+	bool window_closed = false;
+
+	if (ctrl->nr_batch)
+		ctrl->device_ns = wal_commit_ctrl_ewma(ctrl->device_ns, device_ns);
+	else
+		ctrl->device_ns = device_ns;
+	ctrl->nr_batch++;
+
+	//the oldest request of the batch stands for all of them, which errs on the high side.
+	if (b > WAL_COMMIT_CTRL_NR_BUCKET)
+		b = WAL_COMMIT_CTRL_NR_BUCKET;
+	ctrl->hist[b] += nr_reqs;
+	ctrl->nr_window_reqs += nr_reqs;
+	if (latency_ns > ctrl->window_max_ns)
+		ctrl->window_max_ns = latency_ns;
+
+	if (++ctrl->nr_window_batch >= WAL_COMMIT_CTRL_WINDOW) {
+		wal_commit_ctrl_close_window(ctrl);
+		window_closed = true;
+	}
+
+	wal_commit_ctrl_update(ctrl);
+
+	return window_closed;
+}
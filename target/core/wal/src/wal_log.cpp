@@ -51,6 +51,7 @@
 
 #include <wal_lib.h>
 #include <wal_module.h>
+#include <wal_pmem.h>
 
 //#define DFLY_WAL_FLUSH_QOS_ENABLED
 
@@ -77,7 +78,6 @@ bool __log_enabled = false;
 wal_log_device_init_ctx_t __wal_log_init_ctx;
 
 int __wal_io_op_cnt = 0;
-#define RECOVER_DATA_SZ  (8*MB)
 
 struct timespec wal_log_startup;
 
@@ -100,8 +100,12 @@ wal_conf_t g_wal_conf = {
 	WAL_LOG_BATCH_NR_OBJ_ADJUST,
 	WAL_LOG_BATCH_TIMEOUT_US,
 	WAL_LOG_BATCH_TIMEOUT_US_ADJUST,
+	WAL_LOG_COMMIT_TARGET_US,
 	WAL_NR_LOG_DEV_DEFAULT,
 	WAL_LOG_CRASH_TEST,
+	WAL_LOG_RECOVER_NR_ZONES,
+	WAL_LOG_RECOVER_QD,
+	WAL_LOG_DEV_PMEM,
 	WAL_NQN_NAME,
 };
 
@@ -169,8 +173,10 @@ wal_zone_t *wal_log_get_object_zone(wal_object_t *obj);
 wal_zone_t *wal_cache_get_object_zone2(wal_subsystem_t *pool, wal_object_t *obj);
 int wal_log_init(wal_log_device_init_ctx_t *log_dev_info_ctx);
 int wal_log_show_sb(wal_sb_t *sb);
-void wal_log_recover_zones(wal_device_info_t *dev_info, wal_sb_t *sb, int zone_idx);
-void log_complete_zone_recover(wal_device_info_t *dev_info, wal_sb_t *sb, int zone_idx);
+void wal_log_recover_zones(wal_device_info_t *dev_info, wal_sb_t *sb);
+void log_complete_zone_recover(wal_device_info_t *dev_info, wal_zone_t *zone);
+void log_recover_data_read_comp(struct df_dev_response_s resp, void *arg);
+static void log_recover_issue(log_recover_ctx_t *rctx);
 void wal_log_complete_batch(struct df_dev_response_s resp, void *arg);
 void wal_log_complete_single(struct df_dev_response_s resp, void *arg);
 void wal_cache_flush_zone(wal_zone_t *zone);
@@ -329,12 +335,13 @@ int wal_cache_map_read(void *context, wal_map_item_t *map_item, wal_object_t *ob
 	return wal_cache_read_object(buffer, obj, (int64_t)val_addr, rd_sz, 1);
 }
 
-void log_init_continue()
+//called once per log device when its format or recovery is done.
+//the devices are opened together by wal_log_init and complete in any order.
+void log_init_continue(wal_device_info_t *dev_info)
 {
-	//__wal_log_init_ctx.nr_record_recovered += __wal_log_init_ctx.log_dev_info->recover_stats.nr_obj_record;
 	ATOMIC_ADD(__wal_log_init_ctx.nr_record_recovered,
-		   __wal_log_init_ctx.log_dev_info->dev_log_recovery_stats.nr_obj_record);
-	if (++__wal_log_init_ctx.curr_device_idx >= __wal_log_init_ctx.nr_log_devices) {
+		   dev_info->dev_log_recovery_stats.nr_obj_record);
+	if (ATOMIC_INC_FETCH(__wal_log_init_ctx.curr_device_idx) == __wal_log_init_ctx.nr_log_devices) {
 		struct dfly_subsystem *subsystem = __wal_log_init_ctx.pool;
 		subsystem->wal_init_status = WAL_INIT_DONE;
 		wal_module_load_done_cb(subsystem, NULL);
@@ -342,13 +349,6 @@ void log_init_continue()
 		long long wal_log_starup_time_ns = elapsed_time(wal_log_startup);
 		printf("Done the wal log initial of %ld records in %lld ms\n",
 		       __wal_log_init_ctx.nr_record_recovered, wal_log_starup_time_ns >> 20);
-	} else {
-		__wal_log_init_ctx.log_dev_info = NULL;
-		__wal_log_init_ctx.sb = NULL;
-		__wal_log_init_ctx.device_name = NULL;
-		int rc = wal_log_init(&__wal_log_init_ctx);
-		printf("log_init_continue: wal_log_init %s rc %x\n",
-		       __wal_log_init_ctx.device_name, rc);
 	}
 }
 
@@ -360,8 +360,9 @@ void log_format_io_write_comp(struct df_dev_response_s resp, void *arg)
 	//    success, ctx->io_type, ctx->data);
 
 	if (ctx->io_type == LOG_IO_TYPE_SB_WR) {
-		wal_log_show_sb(*__wal_log_init_ctx.sb);
-		log_init_continue();
+		wal_device_info_t *log_dev_info = CONTAINEROF(ctx, wal_device_info_t, log_io_ctx);
+		wal_log_show_sb(log_dev_info->sb);
+		log_init_continue(log_dev_info);
 	}
 }
 
@@ -373,7 +374,7 @@ void log_recover_sb_read_comp(struct df_dev_response_s resp, void *arg)
 
 	assert(ctx->io_type == LOG_IO_TYPE_SB_RD);
 
-	wal_device_info_t *log_dev_info = __wal_log_init_ctx.log_dev_info;
+	wal_device_info_t *log_dev_info = CONTAINEROF(ctx, wal_device_info_t, log_io_ctx);
 	wal_sb_t *sb = (wal_sb_t *)ctx->data;
 	if (sb->magic != WAL_MAGIC) {
 
@@ -394,11 +395,9 @@ void log_recover_sb_read_comp(struct df_dev_response_s resp, void *arg)
 	log_dev_info->sb = sb;
 
 	//recovery the sb and zone struct and related buffer maps.
-	if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_SEQ)
-		wal_log_recover_zones(log_dev_info, sb, 0);
-	else if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_PAR)
-		for (int i = 0; i < sb->nr_zone; i++)
-			wal_log_recover_zones(log_dev_info, sb, i);
+	if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_SEQ
+	    || g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_PAR)
+		wal_log_recover_zones(log_dev_info, sb);
 	else
 		assert(0);
 
@@ -469,178 +468,334 @@ int log_object_parse(char **pp_data_addr, int32_t size,
 
 }
 
+static void log_recover_buffer_start(log_recover_ctx_t *rctx, wal_buffer_t *buffer);
+static void log_recover_drained(log_recover_ctx_t *rctx);
+
+static log_recover_ctx_t *log_recover_ctx_create(wal_device_info_t *dev_info, wal_zone_t *zone)
+{
+	log_recover_ctx_t *rctx = (log_recover_ctx_t *)df_calloc(1, sizeof(log_recover_ctx_t));
+	assert(rctx);
+
+	rctx->dev_info = dev_info;
+	rctx->zone = zone;
+	rctx->qd = MAX(g_wal_conf.wal_log_recover_qd, 1);
+	rctx->carry = (char *)df_malloc(LOG_RECOVER_CARRY_SZ);
+	rctx->chunks = (log_recover_chunk_t *)df_calloc(rctx->qd, sizeof(log_recover_chunk_t));
+	assert(rctx->carry && rctx->chunks);
+
+	for (int i = 0; i < rctx->qd; i++) {
+		log_recover_chunk_t *chunk = &rctx->chunks[i];
+		chunk->rctx = rctx;
+		chunk->state = LOG_RECOVER_CHUNK_FREE;
+		chunk->io_ctx.io_type = LOG_IO_TYPE_DATA_RD;
+		chunk->io_ctx.data = chunk;
+		chunk->data = (char *)spdk_dma_malloc(LOG_RECOVER_CARRY_SZ + LOG_RECOVER_CHUNK_SZ,
+						      WAL_PAGESIZE, NULL);
+		chunk->max_wt = LOG_RECOVER_WT_INIT;
+		chunk->wt = (log_recover_wt_t *)df_calloc(chunk->max_wt, sizeof(log_recover_wt_t));
+		assert(chunk->data && chunk->wt);
+	}
+
+	return rctx;
+}
+
+static void log_recover_ctx_free(log_recover_ctx_t *rctx)
+{
+	assert(!rctx->nr_inflight && !rctx->nr_wt_pending);
+	for (int i = 0; i < rctx->qd; i++) {
+		spdk_dma_free(rctx->chunks[i].data);
+		df_free(rctx->chunks[i].wt);
+	}
+	df_free(rctx->chunks);
+	df_free(rctx->carry);
+	df_free(rctx);
+}
+
 void log_recovery_writethrough_complete(struct df_dev_response_s resp, void *arg)
 {
-	void *dma_buffer = arg;
+	log_recover_wt_t *wt = (log_recover_wt_t *)arg;
+	log_recover_chunk_t *chunk = wt->chunk;
+	log_recover_ctx_t *rctx = chunk->rctx;
 	assert(resp.rc);
 
-	if (dma_buffer)
-		dfly_put_key_buff(NULL, dma_buffer);//spdk_dma_free(dma_buffer);
+	if (wt->key_buff)
+		dfly_put_key_buff(NULL, wt->key_buff);//spdk_dma_free(dma_buffer);
+
+	--chunk->nr_wt_pending;
+	--rctx->nr_wt_pending;
+
+	if (rctx->buffer_done)
+		log_recover_drained(rctx);
+	else if (!chunk->nr_wt_pending)
+		log_recover_issue(rctx);
 }
 
-void log_recover_data_read_comp(struct df_dev_response_s resp, void *arg)
+//stage the write through of an object that missed the cache, the chunk keeps
+//the value in place until the batch submitted after the chunk is parsed completes.
+static void log_recover_wt_stage(log_recover_chunk_t *chunk, wal_fh tgt_fh,
+				 wal_object_t *obj, bool is_del)
 {
-	log_cb_ctx_t *ctx = (log_cb_ctx_t *)arg;
-	int ctx_io_size = ctx->io_size;
-	assert(ctx->io_type == LOG_IO_TYPE_DATA_RD && resp.rc);
+	if (chunk->nr_wt == chunk->max_wt) {
+		assert(!chunk->nr_wt_pending);
+		chunk->max_wt <<= 1;
+		chunk->wt = (log_recover_wt_t *)realloc(chunk->wt, chunk->max_wt * sizeof(log_recover_wt_t));
+		assert(chunk->wt);
+	}
 
-	wal_device_info_t *log_dev_info = __wal_log_init_ctx.log_dev_info;
+	log_recover_wt_t *wt = &chunk->wt[chunk->nr_wt++];
+	wt->chunk = chunk;
+	wt->tgt_fh = tgt_fh;
+	wt->is_del = is_del;
+	wt->key = *obj->key;
+	wt->val = *obj->val;
+	wt->key_buff = NULL;
 
-	wal_bdev_read_t bdev_read = log_dev_info->dev_io->read;
-	wal_buffer_t *buffer = (wal_buffer_t *)ctx->data;
-	wal_zone_t *zone = buffer->zone;
-	wal_buffer_hdr_t *hdr = &buffer->hdr;
-	char *recovery_buffer = zone->recovery_buffer;
+	if (obj->key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
+		wt->key_buff = dfly_get_key_buff(NULL, SAMSUNG_KV_MAX_FABRIC_KEY_SIZE);
+		assert(wt->key_buff && obj->key->length <= SAMSUNG_KV_MAX_FABRIC_KEY_SIZE);
+		memcpy(wt->key_buff, obj->key->key, obj->key->length);
+		wt->key.key = wt->key_buff;
+	}
+}
+
+static void log_recover_wt_submit(log_recover_chunk_t *chunk)
+{
+	log_recover_ctx_t *rctx = chunk->rctx;
+	int nr_wt = chunk->nr_wt;
+	int dfly_rc = 0;
+
+	if (!nr_wt)
+		return;
+
+	chunk->nr_wt = 0;
+	chunk->nr_wt_pending += nr_wt;
+	rctx->nr_wt_pending += nr_wt;
+
+	for (int i = 0; i < nr_wt; i++) {
+		log_recover_wt_t *wt = &chunk->wt[i];
+
+		if (wt->is_del)
+			dfly_rc = dfly_device_delete(wt->tgt_fh, &wt->key,
+						     log_recovery_writethrough_complete, wt);
+		else
+			dfly_rc = dfly_device_store(wt->tgt_fh, &wt->key, &wt->val,
+						    log_recovery_writethrough_complete, wt);
+		assert(!dfly_rc);
+	}
+}
+
+static void log_recover_object(log_recover_ctx_t *rctx, log_recover_chunk_t *chunk, wal_object_t *obj)
+{
+	wal_zone_t *zone = rctx->zone;
 	wal_zone_t *cache_zone = NULL;
-	wal_debug("log_recover_data_read_comp: success %d zone[%d] buffer role %d data %p\n",
-		  resp.rc, zone->zone_id, hdr->role, recovery_buffer);
+	wal_map_item_t *dummy_map_item = NULL;
+	int pool_id = __wal_log_init_ctx.pool->id;
 
-	//parse the data go here.
-	// ...
-	wal_object_t obj;
-	wal_key_t *regular_key = (wal_key_t *)df_calloc(1, sizeof(wal_key_t));
-	obj.key = regular_key;
-	obj.val = (wal_val_t *)df_calloc(1, sizeof(wal_val_t));
-	obj.obj_private = 0;
-
-	struct dfly_key large_key;
-	large_key.key = NULL;
-
-	char *buffer_data = recovery_buffer;
-	int rc = 0, dfly_rc = 0;
-	int buffer_size = ctx_io_size;
-	int is_last_chunk = (ctx_io_size < RECOVER_DATA_SZ);
+	obj->key_hashed = 0;
+	//populate the cache here.
+	cache_zone = wal_cache_get_object_zone2(&g_wal_ctx.pool_array[pool_id], obj);
+	cache_zone->associated_zone = zone;
+	zone->associated_zone = cache_zone;
+	rctx->cache_zone = cache_zone;
+
+	bool is_del = (obj->val->length == 0);
+	int cache_rc = wal_zone_insert_object(cache_zone, obj, is_del, &dummy_map_item, NULL);
+
+	//TODO: Update pool information for list update
+	list_key_update(NULL, (const char *)obj->key->key, obj->key->length, is_del, true);
+
+	//recovery stats
+	zone->zone_recovery_stats.nr_obj_record ++;
+	if (cache_rc == WAL_ERROR_WRITE_MISS) {
+		wal_debug("log_recover_object zone[%d] poll_flush_flag %x is_del %d cache_rc %d\n",
+			  cache_zone->zone_id, cache_zone->poll_flush_flag, is_del, cache_rc);
+		log_recover_wt_stage(chunk, cache_zone->tgt_fh, obj, is_del);
+	}
+
+	if (dummy_map_item && dummy_map_item->recover_status == WAL_ITEM_RECOVER_OVERWRITE)
+		zone->zone_recovery_stats.nr_obj_overwritted ++;
+
+	if (is_del)
+		zone->zone_recovery_stats.nr_obj_deleted ++;
+}
+
+//parse the records of the chunk, a partial record at the tail is carried over
+//to the next chunk. returns false once the end of the buffer records is found.
+static bool log_recover_parse_chunk(log_recover_ctx_t *rctx, log_recover_chunk_t *chunk)
+{
+	wal_buffer_t *buffer = rctx->buffer;
+	wal_zone_t *zone = rctx->zone;
 	int min_obj_key_sz = 16;
 	int min_obj_record_sz = sizeof(wal_obj_checksum_t) + sizeof(wal_obj_hdr_t) + min_obj_key_sz;
-	while ((rc = log_object_parse(&buffer_data, buffer_size, hdr->sequence, &obj)) > 0) {
-		obj.key_hashed = 0;
-		//populate the cache here.
-
-		int pool_id = __wal_log_init_ctx.pool->id;
-		wal_map_item_t *dummy_map_item = NULL;
-		cache_zone = wal_cache_get_object_zone2(&g_wal_ctx.pool_array[pool_id], &obj);
-		cache_zone->associated_zone = zone;
-		zone->associated_zone = cache_zone;
+	int is_last_chunk = (chunk->pos + chunk->io_ctx.io_size >= buffer->hdr.end_addr);
+	int chunk_size = rctx->carry_sz + chunk->io_ctx.io_size;
+	int buffer_size = chunk_size;
+	char *buffer_data = chunk->data + LOG_RECOVER_CARRY_SZ - rctx->carry_sz;
+	int rc = -WAL_ERROR_RD_LESS;
 
-		//df_lock(&cache_zone->uio_lock);
-		bool is_del = (obj.val->length == 0);
-		int cache_rc = wal_zone_insert_object(cache_zone, &obj, is_del, &dummy_map_item, NULL);
+	wal_key_t key = {0, 0};
+	wal_val_t val = {0, 0, 0};
+	wal_object_t obj = {&key, &val};
 
-		//TODO: Update pool information for list update
-		list_key_update(NULL, (const char *)obj.key->key, obj.key->length, is_del, true);
+	if (rctx->carry_sz)
+		memcpy(buffer_data, rctx->carry, rctx->carry_sz);
+	rctx->carry_sz = 0;
 
-		//recovery stats
-		ATOMIC_INC(zone->zone_recovery_stats.nr_obj_record);
-		if (cache_rc == WAL_ERROR_WRITE_MISS) {
-			//assert(!dummy_map_item);
-			printf("log_recover_data_read_comp zone[%d] poll_flush_flag %x is_del %d cache_rc %d\n",
-			       cache_zone->zone_id, cache_zone->poll_flush_flag, is_del, cache_rc);
-
-			if (obj.key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
-				large_key.key = dfly_get_key_buff(NULL, SAMSUNG_KV_MAX_FABRIC_KEY_SIZE);
-				assert(large_key.key && obj.key->length <= SAMSUNG_KV_MAX_FABRIC_KEY_SIZE);
-				large_key.length = obj.key->length;
-				obj.key = &large_key;
-			}
+	while (buffer_size >= min_obj_record_sz
+	       && (rc = log_object_parse(&buffer_data, buffer_size, buffer->hdr.sequence, &obj)) > 0) {
+		log_recover_object(rctx, chunk, &obj);
+		buffer_size -= rc;
+		rc = -WAL_ERROR_RD_LESS;
+	}
 
-			if (is_del)
-				dfly_rc = dfly_device_delete(cache_zone->tgt_fh, obj.key,
-							     log_recovery_writethrough_complete, large_key.key);
-			else
-				dfly_rc = dfly_device_store(cache_zone->tgt_fh, obj.key, obj.val,
-							    log_recovery_writethrough_complete, large_key.key);
+	buffer->hdr.curr_pos += (chunk_size - buffer_size);
 
-			obj.key = regular_key;
+	if (is_last_chunk || rc == -WAL_ERROR_BAD_CHKSUM) {
+		printf("log_object_parse zone [%d] role %d done with rc -0x%x, parsed sz %d, total %d records\n",
+		       zone->zone_id, buffer->hdr.role, -rc, (buffer->hdr.curr_pos - buffer->hdr.start_addr),
+		       zone->zone_recovery_stats.nr_obj_record);
+		return false;
+	}
 
-			assert(!dfly_rc);
+	if (buffer_size <= LOG_RECOVER_CARRY_SZ) {
+		memcpy(rctx->carry, buffer_data, buffer_size);
+		rctx->carry_sz = buffer_size;
+	} else {
+		//the partial record does not fit the carry area, reread from it once the
+		//reads in flight drain. a record larger than a chunk can not be parsed at all.
+		if (buffer_size == chunk_size) {
+			printf("log_recover_parse_chunk: zone[%d] role 0x%x record at 0x%llx exceeds the chunk size\n",
+			       zone->zone_id, buffer->hdr.role, (long long)buffer->hdr.curr_pos);
+			assert(0);
 		}
+		rctx->resync = true;
+	}
 
-		if (dummy_map_item && dummy_map_item->recover_status == WAL_ITEM_RECOVER_OVERWRITE)
-			zone->zone_recovery_stats.nr_obj_overwritted ++;
+	return true;
+}
 
-		if (is_del)
-			zone->zone_recovery_stats.nr_obj_deleted ++;
+//keep up to qd chunk reads in flight ahead of the parse position.
+static void log_recover_issue(log_recover_ctx_t *rctx)
+{
+	wal_device_info_t *dev_info = rctx->dev_info;
+	wal_buffer_t *buffer = rctx->buffer;
 
-		wal_debug("log_object_parse: flush %d log_zone[%d] key 0x%llx%llx val_size 0x%x rc %d cache_rc %d buffer_size %d nr_record %d pos 0x%llx\n",
-			  zone->zone_id, cache_zone->poll_flush_flag, *(long long *)obj.key->key,
-			  *(long long *)((char *)obj.key->key + 8),
-			  obj.val->length, rc, cache_rc, buffer_size, zone->zone_recovery_stats.nr_obj_record,
-			  buffer->hdr.curr_pos);
+	while (!rctx->buffer_done && !rctx->resync
+	       && rctx->issue_seq - rctx->parse_seq < (uint32_t)rctx->qd
+	       && rctx->issue_pos < buffer->hdr.end_addr) {
+		log_recover_chunk_t *chunk = &rctx->chunks[rctx->issue_seq % rctx->qd];
+		if (chunk->state != LOG_RECOVER_CHUNK_FREE || chunk->nr_wt_pending)
+			break;
 
-		//df_unlock(&cache_zone->uio_lock);
-		buffer_size -= rc;
-		if (buffer_size < min_obj_record_sz) {
-			rc = -WAL_ERROR_RD_LESS;
+		chunk->pos = rctx->issue_pos;
+		chunk->io_ctx.io_size = MIN(LOG_RECOVER_CHUNK_SZ, buffer->hdr.end_addr - rctx->issue_pos);
+		chunk->state = LOG_RECOVER_CHUNK_READING;
+		rctx->issue_pos += chunk->io_ctx.io_size;
+		rctx->issue_seq ++;
+		rctx->nr_inflight ++;
+
+		int read_sz = dev_info->dev_io->read(dev_info->fh, chunk->data + LOG_RECOVER_CARRY_SZ,
+						     chunk->pos, chunk->io_ctx.io_size,
+						     (void *)log_recover_data_read_comp, &chunk->io_ctx);
+		assert(read_sz == chunk->io_ctx.io_size);
+	}
+}
+
+//parse the completed chunks in device order, chunks completing ahead of
+//the parse position wait in READY state.
+static void log_recover_parse(log_recover_ctx_t *rctx)
+{
+	while (!rctx->buffer_done && !rctx->resync) {
+		log_recover_chunk_t *chunk = &rctx->chunks[rctx->parse_seq % rctx->qd];
+		if (chunk->state != LOG_RECOVER_CHUNK_READY)
 			break;
+
+		if (!log_recover_parse_chunk(rctx, chunk))
+			rctx->buffer_done = true;
+
+		chunk->state = LOG_RECOVER_CHUNK_FREE;
+		rctx->parse_seq ++;
+		log_recover_wt_submit(chunk);
+	}
+
+	if (rctx->buffer_done || rctx->resync) {
+		//drop the chunks read beyond the parse position
+		for (int i = 0; i < rctx->qd; i++) {
+			if (rctx->chunks[i].state == LOG_RECOVER_CHUNK_READY)
+				rctx->chunks[i].state = LOG_RECOVER_CHUNK_FREE;
 		}
-	};
+		log_recover_drained(rctx);
+	} else {
+		log_recover_issue(rctx);
+	}
+}
 
-	df_free(regular_key);
-	df_free(obj.val);
+void log_recover_data_read_comp(struct df_dev_response_s resp, void *arg)
+{
+	log_cb_ctx_t *ctx = (log_cb_ctx_t *)arg;
+	log_recover_chunk_t *chunk = (log_recover_chunk_t *)ctx->data;
+	log_recover_ctx_t *rctx = chunk->rctx;
+	assert(ctx->io_type == LOG_IO_TYPE_DATA_RD && resp.rc);
 
-	buffer->hdr.curr_pos += (ctx_io_size - buffer_size);
-	//printf("log_recover_data_read_comp: zone[%d] buffer role %d parsed records %d rc -0x%x buffer_size %d nxt_pos 0x%llx\n",
-	//        zone->zone_id, hdr->role, log_dev_info->recover_stats.nr_obj_record, -rc, buffer_size, buffer->hdr.curr_pos);
+	wal_debug("log_recover_data_read_comp: success %d zone[%d] buffer role %d pos 0x%llx sz %d\n",
+		  resp.rc, rctx->zone->zone_id, rctx->buffer->hdr.role, (long long)chunk->pos, ctx->io_size);
 
-	if (is_last_chunk) {
-		rc = -WAL_ERROR_BAD_CHKSUM;
+	rctx->nr_inflight --;
+	if (rctx->buffer_done || rctx->resync) {
+		chunk->state = LOG_RECOVER_CHUNK_FREE;
+		log_recover_drained(rctx);
+		return;
 	}
 
-	//check if the end of buffer data
-	if (rc == -WAL_ERROR_RD_LESS) {
-		int rest_buffer_space_sz = buffer->hdr.end_addr - buffer->hdr.curr_pos;
-		if (rest_buffer_space_sz < min_obj_record_sz) {
-			printf("log_recover_data_read_comp: zone[%d] role 0x%x reach the end of buffer\n",
-			       zone->zone_id, hdr->role);
-			assert(0);
-		} else {
-			//continue read the data for the current buffer
-			buffer->hdr_io_ctx.io_type = LOG_IO_TYPE_DATA_RD;
-			buffer->hdr_io_ctx.data = buffer;
-			buffer->hdr_io_ctx.io_size = MIN(RECOVER_DATA_SZ, rest_buffer_space_sz);
-			bdev_read(log_dev_info->fh, recovery_buffer, buffer->hdr.curr_pos, buffer->hdr_io_ctx.io_size,
-				  (void *)log_recover_data_read_comp, &buffer->hdr_io_ctx);
-		}
-	} else if (rc == -WAL_ERROR_BAD_CHKSUM) {
-		// done the current buffer read.
-		// for flush, continue the log buffer
-		// for the log, done the whole zone data recovery.
-		printf("log_object_parse zone [%d] role %d done with rc -0x%x, parsed sz %d, total %d records\n",
-		       zone->zone_id, buffer->hdr.role, -rc, (buffer->hdr.curr_pos - buffer->hdr.start_addr),
-		       zone->zone_recovery_stats.nr_obj_record);
-		if ((buffer->hdr.role & WAL_BUFFER_ROLE_BIT) == WAL_BUFFER_ROLE_FLUSH) {
-			//read back the log buffer
-			buffer = zone->log;
-			off64_t pos = buffer->hdr.curr_pos;
-			buffer->hdr_io_ctx.io_type = LOG_IO_TYPE_DATA_RD;
-			buffer->hdr_io_ctx.io_size = RECOVER_DATA_SZ;
-			buffer->hdr_io_ctx.data = buffer;
-			bdev_read(log_dev_info->fh, recovery_buffer, pos, buffer->hdr_io_ctx.io_size,
-				  (void *)log_recover_data_read_comp, &buffer->hdr_io_ctx);
-		} else {
-			//done the both flush and log buffer of this zone.
-			//continue to recover the next zone
-			if (cache_zone) {
-				update_dump_group_info(cache_zone->log);
-			}
+	chunk->state = LOG_RECOVER_CHUNK_READY;
+	log_recover_parse(rctx);
+}
 
-			log_dev_info->dev_log_recovery_stats.nr_obj_record += zone->zone_recovery_stats.nr_obj_record;
-			log_dev_info->dev_log_recovery_stats.nr_obj_overwritted +=
-				zone->zone_recovery_stats.nr_obj_overwritted;
-			log_dev_info->dev_log_recovery_stats.nr_obj_deleted += zone->zone_recovery_stats.nr_obj_deleted;
+static void log_recover_buffer_start(log_recover_ctx_t *rctx, wal_buffer_t *buffer)
+{
+	rctx->buffer = buffer;
+	rctx->issue_pos = buffer->hdr.curr_pos;
+	rctx->issue_seq = 0;
+	rctx->parse_seq = 0;
+	rctx->carry_sz = 0;
+	rctx->resync = false;
+	rctx->buffer_done = (rctx->issue_pos >= buffer->hdr.end_addr);
 
-			if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_SEQ)
-				wal_log_recover_zones(__wal_log_init_ctx.log_dev_info,
-						      *__wal_log_init_ctx.sb, zone->zone_id + 1);
-			else if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_PAR)
-				log_complete_zone_recover(__wal_log_init_ctx.log_dev_info,
-							  *__wal_log_init_ctx.sb, zone->zone_id + 1);
-			else
-				assert(0);
+	if (rctx->buffer_done)
+		log_recover_drained(rctx);
+	else
+		log_recover_issue(rctx);
+}
 
-		}
+//called whenever a read or write through of the zone completes after the
+//parse stopped. restarts the reads for a resync, replays the log buffer once
+//the flush buffer is done and finishes the zone after both.
+static void log_recover_drained(log_recover_ctx_t *rctx)
+{
+	wal_zone_t *zone = rctx->zone;
+
+	if (rctx->nr_inflight)
+		return;
+
+	if (rctx->resync) {
+		log_recover_buffer_start(rctx, rctx->buffer);
+		return;
 	}
 
+	if ((rctx->buffer->hdr.role & WAL_BUFFER_ROLE_BIT) == WAL_BUFFER_ROLE_FLUSH && zone->log) {
+		//done the flush buffer, continue the log buffer
+		log_recover_buffer_start(rctx, zone->log);
+		return;
+	}
+
+	if (rctx->nr_wt_pending)
+		return;
+
+	//done the both flush and log buffer of this zone.
+	if (rctx->cache_zone)
+		update_dump_group_info(rctx->cache_zone->log);
+
+	log_complete_zone_recover(rctx->dev_info, zone);
 }
 
 int log_recover_buffer_read_comp(struct df_dev_response_s resp, void *arg)
@@ -648,14 +803,10 @@ int log_recover_buffer_read_comp(struct df_dev_response_s resp, void *arg)
 	log_cb_ctx_t *ctx = (log_cb_ctx_t *)arg;
 	assert(ctx->io_type == LOG_IO_TYPE_BUFF_HDR_RD && resp.rc);
 
-	wal_device_info_t *log_dev_info = __wal_log_init_ctx.log_dev_info;
-
-	wal_bdev_read_t bdev_read = log_dev_info->dev_io->read;
 	wal_buffer_t *buffer = (wal_buffer_t *)ctx->data;
 	wal_zone_t *zone = buffer->zone;
 	wal_buffer_hdr_t *hdr = &buffer->hdr;
-
-	char *recovery_buffer = zone->recovery_buffer;;
+	log_recover_ctx_t *rctx = zone->recover_ctx;
 
 	printf("log_recover_buffer_read_comp: success %d zone[%d] buffer role %d start 0x%llx cur_pos 0x%llx end_addr 0x%llx seq %d\n",
 	       resp.rc, zone->zone_id, hdr->role,
@@ -685,15 +836,12 @@ int log_recover_buffer_read_comp(struct df_dev_response_s resp, void *arg)
 		assert(0);
 	}
 
-	//start recover the flush buffer
-	if ((buffer->hdr.role & WAL_BUFFER_ROLE_BIT) == WAL_BUFFER_ROLE_FLUSH) {
-		off64_t pos = buffer->hdr.curr_pos;
-		buffer->hdr_io_ctx.io_type = LOG_IO_TYPE_DATA_RD;
-		buffer->hdr_io_ctx.io_size = RECOVER_DATA_SZ;
-		buffer->hdr_io_ctx.data = buffer;
-		bdev_read(log_dev_info->fh, recovery_buffer, pos, buffer->hdr_io_ctx.io_size,
-			  (void *)log_recover_data_read_comp, &buffer->hdr_io_ctx);
-	}
+	//start recover the flush buffer once both buffer hdrs are in,
+	//the log buffer follows when the flush buffer is done.
+	if (++rctx->nr_hdr_read < 2)
+		return 0;
+
+	log_recover_buffer_start(rctx, zone->flush ? zone->flush : zone->log);
 
 	return 0;
 
@@ -710,9 +858,6 @@ int wal_log_recover_zone_buffer(wal_device_info_t *dev_info, off64_t pos, int32_
 	buffer1 = (wal_buffer_t *)spdk_dma_malloc(buffer_sz_4k << WAL_PAGESIZE_SHIFT, WAL_PAGESIZE, NULL);
 	buffer2 = (wal_buffer_t *)spdk_dma_malloc(buffer_sz_4k << WAL_PAGESIZE_SHIFT, WAL_PAGESIZE, NULL);
 
-	//buffer1->recovery_buffer = spdk_dma_malloc(MB, WAL_PAGESIZE, NULL);//for log data recovery
-	//buffer2->recovery_buffer = spdk_dma_malloc(MB, WAL_PAGESIZE, NULL);//for log data recovery
-
 	buffer1->zone = zone;
 	buffer2->zone = zone;
 
@@ -742,57 +887,70 @@ int wal_log_recover_zone_buffer(wal_device_info_t *dev_info, off64_t pos, int32_
 
 }
 
-void log_complete_zone_recover(wal_device_info_t *dev_info, wal_sb_t *sb, int zone_idx)
+static void wal_log_recover_next_zone(wal_device_info_t *dev_info, wal_sb_t *sb)
 {
-	++dev_info->nr_zone_recovered;
-	if (dev_info->nr_zone_recovered >= sb->nr_zone) {
+	int32_t i = dev_info->nr_zone_started ++;
+	off64_t pos = sb->zone_space[i].addr_mb;
+	wal_zone_t *zone = (wal_zone_t *)df_calloc(1, sizeof(wal_zone_t));
+
+	pos <<= 20;
+	df_lock_init(&zone->uio_lock, NULL);
+	zone->zone_id = i;
+	zone->recover_ctx = log_recover_ctx_create(dev_info, zone);
+	dev_info->zones[i] = zone;
+	wal_log_recover_zone_buffer(dev_info, pos, sb->zone_space[i].size_mb, zone);
+}
+
+void log_complete_zone_recover(wal_device_info_t *dev_info, wal_zone_t *zone)
+{
+	wal_sb_t *sb = dev_info->sb;
+
+	dev_info->dev_log_recovery_stats.nr_obj_record += zone->zone_recovery_stats.nr_obj_record;
+	dev_info->dev_log_recovery_stats.nr_obj_overwritted +=
+		zone->zone_recovery_stats.nr_obj_overwritted;
+	dev_info->dev_log_recovery_stats.nr_obj_deleted += zone->zone_recovery_stats.nr_obj_deleted;
+
+	log_recover_ctx_free(zone->recover_ctx);
+	zone->recover_ctx = NULL;
+
+	//keep the window of recovering zones full
+	if (dev_info->nr_zone_started < sb->nr_zone)
+		wal_log_recover_next_zone(dev_info, sb);
+
+	if (++dev_info->nr_zone_recovered >= sb->nr_zone) {
 		printf("wal_log_recover_zones: done device %s nr_zone %d "
-		       "nr_obj_records %ld nr_obj_overwrite %ld nr_obj_deleleted %ld\n",
-		       __wal_log_init_ctx.device_name, sb->nr_zone,
+		       "nr_obj_records %d nr_obj_overwrite %d nr_obj_deleleted %d\n",
+		       dev_info->dev_name, sb->nr_zone,
 		       dev_info->dev_log_recovery_stats.nr_obj_record,
 		       dev_info->dev_log_recovery_stats.nr_obj_overwritted,
 		       dev_info->dev_log_recovery_stats.nr_obj_deleted);
 
-		log_init_continue();
-		return;
+		log_init_continue(dev_info);
 	}
 }
 
-void wal_log_recover_zones(wal_device_info_t *dev_info, wal_sb_t *sb, int zone_idx)
+//replay the zones of the log device, wal_log_recover_nr_zones of them at a time,
+//or one after another for WAL_OPEN_RECOVER_SEQ.
+void wal_log_recover_zones(wal_device_info_t *dev_info, wal_sb_t *sb)
 {
-	wal_zone_t *zone = NULL;
-	int32_t i = zone_idx, rc = 0;
-	int nr_zone = sb->nr_zone;
-	off64_t pos = sb->offset;
+	int nr_zone_inflight = 1;
 
-	//if the last zone recovery completed
-	if (zone_idx >= sb->nr_zone) {
-		printf("wal_log_recover_zones: done device %s nr_zone %d recovered\n"
-		       "nr_obj_records %ld nr_obj_overwrite %ld nr_obj_deleleted %ld\n",
-		       __wal_log_init_ctx.device_name, sb->nr_zone,
-		       dev_info->dev_log_recovery_stats.nr_obj_record,
-		       dev_info->dev_log_recovery_stats.nr_obj_overwritted,
-		       dev_info->dev_log_recovery_stats.nr_obj_deleted);
+	if (g_wal_conf.wal_open_flag == WAL_OPEN_RECOVER_PAR)
+		nr_zone_inflight = MAX(g_wal_conf.wal_log_recover_nr_zones, 1);
+
+	dev_info->zones = (wal_zone_t **)df_calloc(MAX_ZONE, sizeof(wal_zone_t *));
+	dev_info->nr_zone_started = 0;
+	dev_info->nr_zone_recovered = 0;
 
-		log_init_continue();
+	if (!sb->nr_zone) {
+		log_init_continue(dev_info);
 		return;
 	}
 
-	//allocate zones for the first time recovery
-	if (zone_idx == 0)
-		dev_info->zones = (wal_zone_t **)df_malloc(sizeof(wal_zone_t *) * MAX_ZONE);
-
-	pos = sb->zone_space[i].addr_mb;
-	pos <<= 20;
-	zone = (wal_zone_t *)df_calloc(1, sizeof(wal_zone_t));
-	zone->recovery_buffer = (char *)spdk_dma_malloc(RECOVER_DATA_SZ, WAL_PAGESIZE, NULL);//for log data recovery
-	df_lock_init(&zone->uio_lock, NULL);
-	zone->zone_id = i;
-	dev_info->zones[i] = zone;
-	rc = wal_log_recover_zone_buffer(dev_info, pos, sb->zone_space[i].size_mb, zone);
-
-	return;
+	while (dev_info->nr_zone_started < MIN(sb->nr_zone, nr_zone_inflight))
+		wal_log_recover_next_zone(dev_info, sb);
 }
+
 int wal_log_sb_read(wal_device_info_t *dev_info, wal_sb_t *sb)
 {
 	int sb_sz = sizeof(wal_sb_t);
@@ -827,7 +985,7 @@ uint32_t inline deleted_object_record_size(wal_object_t *obj)
 
 
 int wal_map_invalidate_item(void *context,
-			    wal_bucket_t *bucket, wal_map_item_t *item)
+			    wal_map_t *map, wal_map_item_t *item)
 {
 	wal_buffer_t *buffer = (wal_buffer_t *) context;
 	//printf("wal_map_invalidate_item item %p status %x ", item, item->status);
@@ -836,7 +994,7 @@ int wal_map_invalidate_item(void *context,
 	int b3 = ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_DELETED, WAL_ITEM_INVALID);
 	//printf("b1 %d b2 %d\n", b1, b2);
 	if (b1 || b2 || b3) {
-		-- bucket->valid_nr_entries;
+		-- map->nr_valid_items;
 		if (b1) {
 			ATOMIC_DEC_FETCH(buffer->nr_objects_inserted);
 			buffer->zone->nr_invalidate ++;
@@ -1100,6 +1258,7 @@ int32_t wal_log_insert_object(void *context, wal_object_t *obj,
 		}
 
 		if (dump_hdr->nr_batch_reqs) {
+			start_timer(&dump_hdr->submit_ts);
 			rc = buffer_write(fh, dump_data_addr, pos, dump_data_size,
 					  (void *)wal_log_complete_batch, (void *)p_dump_info->dump_addr);
 			assert(rc == dump_data_size);
@@ -1267,12 +1426,42 @@ log_complete_single_done:
 
 }
 
+//feed the batch into the zone's commit controller and apply its new batch size/timeout
+static void wal_zone_commit_complete(wal_zone_t *zone, wal_dump_hdr_t *dump_hdr)
+{
+	wal_commit_ctrl_t *ctrl = &zone->commit_ctrl;
+	stat_wal_commit_t *stat = zone->commit_stat;
+
+	if (!wal_commit_ctrl_complete(ctrl, dump_hdr->nr_batch_reqs, elapsed_time(dump_hdr->submit_ts),
+				      elapsed_time(dump_hdr->open_ts)))
+		goto commit_complete_done;
+
+	wal_debug("zone[%d] commit p99 %d us device %lld ns arrival %lld ns gain %d: timeout_us %d batch_nr %d\n",
+		  zone->zone_id, ctrl->p99_us, ctrl->device_ns, ctrl->arrival_ns, ctrl->gain,
+		  ctrl->batch_timeout_us, ctrl->batch_nr_obj);
+
+	if (stat) {
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->batch_nr_obj, ctrl->batch_nr_obj);
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->batch_timeout_us, ctrl->batch_timeout_us);
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->p99_us, ctrl->p99_us);
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->device_us, ctrl->device_ns / 1000);
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->arrival_ns, ctrl->arrival_ns);
+		dfly_ustat_set_u64((ustat_struct_t *)stat, &stat->batches, ctrl->nr_batch);
+	}
+
+commit_complete_done:
+	zone->dump_timeout_us = ctrl->batch_timeout_us;
+	zone->log_batch_nr_obj = ctrl->batch_nr_obj;
+}
+
 void wal_log_complete_batch(struct df_dev_response_s resp, void *arg)
 {
 	wal_dump_hdr_t *dump_hdr = (wal_dump_hdr_t *)arg;
 	wal_debug("wal_log_complete_batch entry %d reqs at %p\n",
 		  dump_hdr->nr_batch_reqs, dump_hdr);
 	assert(resp.rc);
+	if (dump_hdr->zone && dump_hdr->zone->commit_ctrl.target_us)
+		wal_zone_commit_complete(dump_hdr->zone, dump_hdr);
 	int32_t nr_dump_req = dump_hdr->nr_batch_reqs;
 	int i = 0;
 	while (nr_dump_req--) {
@@ -1610,7 +1799,8 @@ int wal_cache_shutdown(wal_device_info_t *dev_info)
 		zone->log = NULL;
 		wal_buffer_deinit(zone->flush);
 		zone->flush = NULL;
-		df_free(zone->recovery_buffer);
+		if (zone->commit_stat)
+			dfly_ustat_remove_wal_commit_stat(zone->commit_stat);
 		df_free(zone);
 		zone = NULL;
 #ifdef WAL_USE_PTHREAD
@@ -1668,6 +1858,11 @@ int wal_log_dev_open_2(void *pool, wal_log_device_init_ctx_t *ctx, wal_sb_t **pp
 
 	if (dev_info->fh != WAL_INIT_FH) {
 		return rc;
+	} else if (g_wal_conf.wal_log_dev_pmem) {
+		//same layout as a bdev, only the transport differs. the log buffers share the ops.
+		dev_info->dev_io = &wal_log_pmem_io;
+		wal_log_buffer_ops.dev_io = &wal_log_pmem_io;
+		dev_info->dev_type = WAL_DEV_TYPE_BLK;
 	} else {
 		dev_info->dev_io = &wal_log_bdev_io;
 		dev_info->dev_type = WAL_DEV_TYPE_BLK;
@@ -1686,12 +1881,18 @@ int wal_log_dev_open_2(void *pool, wal_log_device_init_ctx_t *ctx, wal_sb_t **pp
 		wal_debug("spdk_dma_malloc fail to alloc sb with size of %d \n", log_sb_pg << WAL_PAGESIZE_SHIFT);
 		goto fail;
 	}
-	size_bytes = dfly_device_getsize(dev_info->fh);
-	dev_info->size_mb = (size_bytes) >> 20;
-
-	printf("log dev: name %s write_cached %d bsz %d ssz %d cnt_blk %d size_mb %d\n",
-	       dev_info->dev_name, dfly_bdev_write_cached(dev_name),
-	       dev_info->bsz, dev_info->ssz, cnt_blk, dev_info->size_mb);
+	if (dev_info->dev_io == &wal_log_pmem_io) {
+		size_bytes = wal_pmem_getsize(dev_info->fh);
+		dev_info->size_mb = (size_bytes) >> 20;
+		printf("log dev: name %s pmem map_sync %d size_mb %d\n",
+		       dev_info->dev_name, wal_pmem_is_map_sync(dev_info->fh), dev_info->size_mb);
+	} else {
+		size_bytes = dfly_device_getsize(dev_info->fh);
+		dev_info->size_mb = (size_bytes) >> 20;
+		printf("log dev: name %s write_cached %d bsz %d ssz %d cnt_blk %d size_mb %d\n",
+		       dev_info->dev_name, dfly_bdev_write_cached(dev_name),
+		       dev_info->bsz, dev_info->ssz, cnt_blk, dev_info->size_mb);
+	}
 
 	if (open_flags & WAL_OPEN_DEVINFO) {
 		dev_info->dev_io->close(dev_info->fh);
@@ -1739,7 +1940,7 @@ static void wal_cache_flush_buffer_sync(wal_buffer_t *buffer)
 	wal_val_t value = {0, 0, 0};
 	wal_object_t obj = {&key, &value};
 
-	wal_bucket_t *bucket = NULL;
+	wal_map_item_t *entry = NULL;
 	wal_map_t *map = buffer->map;
 	static long long total_flush_cnt = 0;
 
@@ -1748,59 +1949,50 @@ static void wal_cache_flush_buffer_sync(wal_buffer_t *buffer)
 
 keep_flushing:
 
-	bucket  = zone->flush->map->flush_head;
+	entry = zone->flush->map->flush_head;
 	//printf("wal_cache_flush_buffer_sync buffer %p nr_insert %d\n",
 	//    buffer, buffer->nr_objects_inserted);
-	TAILQ_FOREACH_FROM(bucket,  &zone->flush->map->head, link) {
-		int cnt = bucket->valid_nr_entries;
-		wal_map_item_t *entry = bucket->entry;
-
+	TAILQ_FOREACH_FROM(entry, &zone->flush->map->head, link) {
 		if (!((ATOMIC_READ(buffer->nr_objects_inserted) > 0)
 		      && ATOMIC_READ(buffer->nr_pending_io) < zone->poll_flush_max_cnt)) {
 			break;
 		}
 
-		//printf("bucket %p, cnt %d\n", bucket, cnt);
-		while (cnt) {
-			assert(entry);
-			if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_VALID,  WAL_ITEM_FLUSHING)) {
-				buffer->zone->poll_flush_flag &= ~WAL_POLL_FLUSH_DONE;
-				buffer->zone->poll_flush_flag |= WAL_POLL_FLUSH_DOING;
-
-				obj.key = entry->key;
-				obj.val->length = entry->val_size;
-				obj.val->offset = 0;
-				obj.val->value = (void *)entry->addr;
-
-				struct dfly_key large_key;
-				if (entry->key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
-					if (!wal_prepare_large_key(&large_key, entry)) {
-						obj.key = &large_key;
-					} else {
-						DFLY_ERRLOG("fail to get dma buff for large key. will recover from during next startup.\n");
-						cnt --;
-						continue;
-					}
-				}
+		if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_VALID,  WAL_ITEM_FLUSHING)) {
+			buffer->zone->poll_flush_flag &= ~WAL_POLL_FLUSH_DONE;
+			buffer->zone->poll_flush_flag |= WAL_POLL_FLUSH_DOING;
 
-				rc = dfly_device_store(zone->tgt_fh, obj.key, obj.val,
-						       wal_flush_complete, entry);
+			obj.key = entry->key;
+			obj.val->length = entry->val_size;
+			obj.val->offset = 0;
+			obj.val->value = (void *)entry->addr;
 
-				if (rc < 0) {
-					wal_debug("flush: wal_cache_flush_object submit store request failed %d\n", rc);
+			struct dfly_key large_key;
+			if (entry->key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
+				if (!wal_prepare_large_key(&large_key, entry)) {
+					obj.key = &large_key;
 				} else {
-					;//printf("flush: req %p status 0x%x submitted\n", req, entry->status);
+					DFLY_ERRLOG("fail to get dma buff for large key. will recover from during next startup.\n");
+					zone->flush->map->flush_head = TAILQ_NEXT(entry, link);
+					continue;
 				}
-				entry_cnt ++;
-				ATOMIC_INC(buffer->nr_pending_io);
-				cnt --;
-			} else {
-				;//printf("flush: item %p status 0x%x no submittion \n", entry, entry->status);
 			}
 
-			entry = entry->next;
+			rc = dfly_device_store(zone->tgt_fh, obj.key, obj.val,
+					       wal_flush_complete, entry);
+
+			if (rc < 0) {
+				wal_debug("flush: wal_cache_flush_object submit store request failed %d\n", rc);
+			} else {
+				;//printf("flush: req %p status 0x%x submitted\n", req, entry->status);
+			}
+			entry_cnt ++;
+			ATOMIC_INC(buffer->nr_pending_io);
+		} else {
+			;//printf("flush: item %p status 0x%x no submittion \n", entry, entry->status);
 		}
-		zone->flush->map->flush_head = TAILQ_NEXT(bucket, link);
+
+		zone->flush->map->flush_head = TAILQ_NEXT(entry, link);
 		if (entry_cnt >= zone->poll_flush_max_cnt) {
 			break;
 		}
@@ -1854,20 +2046,15 @@ void wal_cache_flush_spdk_proc(void *context)
 	wal_val_t value = {0, 0, 0};
 	wal_object_t obj = {&key, &value};
 
-	wal_bucket_t *bucket = zone->flush->map->flush_head;
+	wal_map_item_t *entry = zone->flush->map->flush_head;
 	wal_buffer_t *buffer = zone->flush;
 	wal_map_t *map = buffer->map;
 	static long long total_flush_cnt = 0;
 
 	int entry_cnt = 0;
 	int rc = 0;
-	int try_next_round = 0;
 	//int cur_pending_io = ATOMIC_READ(buffer->nr_pending_io);
-	TAILQ_FOREACH_FROM(bucket, &map->head, link) {
-
-		int cnt = bucket->total_nr_entries;
-		wal_map_item_t *entry = bucket->entry;
-		//printf("bucket %p, cnt %d\n", bucket, cnt);
+	TAILQ_FOREACH_FROM(entry, &map->head, link) {
 
 		if (zone->poll_flush_flag & WAL_POLL_FLUSH_EXIT)
 			break;
@@ -1876,71 +2063,63 @@ void wal_cache_flush_spdk_proc(void *context)
 			break;
 		}
 
-		while (cnt) {
-
-			/*
-			#define WAL_ITEM_VALID		0x0	//
-			#define WAL_ITEM_INVALID		0x1	//VALID -> INVALID
-			#define WAL_ITEM_FLUSHING		0x2	//VALID -> FLUSHING
-			#define WAL_ITEM_FLUSHED		0x3 //FLUSHING -> FLUSHED
-			#define WAL_ITEM_DELETED		0x4 //object deleted, but item points to deleted record for log.
-			*/
-			assert(entry);
-			if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_DELETED,  WAL_ITEM_INVALID)) {
-				assert(__log_enabled);
-				-- bucket->valid_nr_entries;
-			} else if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_VALID,  WAL_ITEM_FLUSHING)) {
-				obj.key = entry->key;
-				obj.val->length = entry->val_size;
-				obj.val->offset = 0;
-				obj.val->value = (void *)entry->addr;
-
-				struct dfly_key large_key;
-				if (entry->key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
-					if (!wal_prepare_large_key(&large_key, entry)) {
-						obj.key = &large_key;
-					} else { //not enough pool mem for large key. stop here.
-						ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_FLUSHING, WAL_ITEM_VALID);
-						try_next_round = 1;
-						goto next_round;
-					}
+		/*
+		#define WAL_ITEM_VALID		0x0	//
+		#define WAL_ITEM_INVALID		0x1	//VALID -> INVALID
+		#define WAL_ITEM_FLUSHING		0x2	//VALID -> FLUSHING
+		#define WAL_ITEM_FLUSHED		0x3 //FLUSHING -> FLUSHED
+		#define WAL_ITEM_DELETED		0x4 //object deleted, but item points to deleted record for log.
+		*/
+		if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_DELETED,  WAL_ITEM_INVALID)) {
+			assert(__log_enabled);
+			-- map->nr_valid_items;
+		} else if (ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_VALID,  WAL_ITEM_FLUSHING)) {
+			obj.key = entry->key;
+			obj.val->length = entry->val_size;
+			obj.val->offset = 0;
+			obj.val->value = (void *)entry->addr;
+
+			struct dfly_key large_key;
+			if (entry->key->length > SAMSUNG_KV_MAX_EMBED_KEY_SIZE) {
+				if (!wal_prepare_large_key(&large_key, entry)) {
+					obj.key = &large_key;
+				} else { //not enough pool mem for large key. stop here and retry the item next round.
+					ATOMIC_BOOL_COMP_CHX(entry->status, WAL_ITEM_FLUSHING, WAL_ITEM_VALID);
+					break;
 				}
+			}
 
-				if (__log_enabled) {
-					void *val_addr = (void *)entry->addr;
-					wal_obj_hdr_t *obj_hdr = (wal_obj_hdr_t *)entry->addr;
-					obj.val->value = (void *)((char *)obj_hdr + __wal_obj_hdr_sz + obj_hdr->key_sz);
-				}
+			if (__log_enabled) {
+				void *val_addr = (void *)entry->addr;
+				wal_obj_hdr_t *obj_hdr = (wal_obj_hdr_t *)entry->addr;
+				obj.val->value = (void *)((char *)obj_hdr + __wal_obj_hdr_sz + obj_hdr->key_sz);
+			}
 
 #if 0
-				io_request = NULL;
-				rc = dfly_device_build_request(zone->tgt_fh, SPDK_NVME_OPC_SAMSUNG_KV_STORE,
-							       obj.key, obj.val, wal_flush_complete, entry, &io_request);
+			io_request = NULL;
+			rc = dfly_device_build_request(zone->tgt_fh, SPDK_NVME_OPC_SAMSUNG_KV_STORE,
+						       obj.key, obj.val, wal_flush_complete, entry, &io_request);
 
-				//QoS Submit
-				qos_request_ops.qos_recv(io_request, zone->poll_qos_request_ctx, zone->poll_qos_client_ctx);
+			//QoS Submit
+			qos_request_ops.qos_recv(io_request, zone->poll_qos_request_ctx, zone->poll_qos_client_ctx);
 
 #else
-				rc = dfly_device_store(zone->tgt_fh, obj.key, obj.val,
-						       wal_flush_complete, entry);
+			rc = dfly_device_store(zone->tgt_fh, obj.key, obj.val,
+					       wal_flush_complete, entry);
 #endif
 
-				if (rc < 0) {
-					wal_debug("flush: wal_cache_flush_object submit store request failed %d\n", rc);
-				} else {
-					;//printf("flush: req %p status 0x%x submitted\n", req, entry->status);
-				}
-				entry_cnt ++;
-				ATOMIC_INC(buffer->nr_pending_io);
+			if (rc < 0) {
+				wal_debug("flush: wal_cache_flush_object submit store request failed %d\n", rc);
 			} else {
-				wal_debug("flush: bucket %p item %p status 0x%x no submittion \n", bucket, entry, entry->status);
+				;//printf("flush: req %p status 0x%x submitted\n", req, entry->status);
 			}
-			-- cnt;
-			entry = entry->next;
+			entry_cnt ++;
+			ATOMIC_INC(buffer->nr_pending_io);
+		} else {
+			wal_debug("flush: map %p item %p status 0x%x no submittion \n", map, entry, entry->status);
 		}
-next_round:
-		zone->flush->map->flush_head = TAILQ_NEXT(bucket, link);
-		if (try_next_round || entry_cnt >= zone->poll_flush_max_cnt) {
+		zone->flush->map->flush_head = TAILQ_NEXT(entry, link);
+		if (entry_cnt >= zone->poll_flush_max_cnt) {
 			break;
 		}
 
@@ -2018,6 +2197,19 @@ int wal_cache_dev_init(wal_device_info_t *dev_info, int nr_zone, int zone_sz_mb,
 		zone->nr_overwrite = 0;
 		zone->dump_timeout_us = g_wal_conf.wal_log_batch_timeout_us;
 		zone->log_batch_nr_obj = g_wal_conf.wal_log_batch_nr_obj;
+		memset(&zone->commit_ctrl, 0, sizeof(zone->commit_ctrl));
+		zone->commit_stat = NULL;
+		start_timer(&zone->arrival_ts);
+		if (g_wal_conf.wal_log_enabled && g_wal_conf.wal_log_commit_target_us) {
+			wal_commit_ctrl_init(&zone->commit_ctrl, g_wal_conf.wal_log_commit_target_us,
+					     MIN(g_wal_conf.wal_log_batch_nr_obj, WAL_MAX_DUMP_REQ));
+			zone->dump_timeout_us = zone->commit_ctrl.batch_timeout_us;
+			zone->log_batch_nr_obj = zone->commit_ctrl.batch_nr_obj;
+			if (dfly_ustat_init_wal_commit_stat(&zone->commit_stat, i + zone_idx)) {
+				printf("wal_cache_dev_init: commit stats not available for zone %d\n", i);
+				zone->commit_stat = NULL;
+			}
+		}
 		addr = (int64_t)__wal_cache_buffer[i] +  MB - 1;
 		int32_t start_pos_mb = (int32_t)((addr & WAL_ZONE_MASK_64) >> WAL_ZONE_OFFSET);
 		//dev_info->fh = i*2;
@@ -2341,16 +2533,20 @@ int wal_log_init(wal_log_device_init_ctx_t *log_dev_info_ctx)
 	wal_log_device_init_ctx_t *ctx = log_dev_info_ctx;
 	struct dfly_subsystem *pool = ctx->pool;
 	int log_init_rc = WAL_LOG_INIT_RECOVERING;
-	int i = ctx->curr_device_idx;
+	int nr_pending = 0;
+	int i = 0;
 
-	if (i >= ctx->nr_log_devices)
+	if (ctx->curr_device_idx >= ctx->nr_log_devices)
 		return WAL_LOG_INIT_DONE;
 
+	//open all the log devices up front so their format/recovery run concurrently,
+	//curr_device_idx counts the devices done and log_init_continue completes the init.
 	for (; i < ctx->nr_log_devices; i++) {
 		g_wal_ctx.log_dev[i] = &__log_dev[i];
 		g_wal_ctx.log_dev[i]->fh = WAL_INIT_FH;
 		g_wal_ctx.log_dev[i]->pool = pool;
 		ctx->log_dev_info = g_wal_ctx.log_dev[i];
+		ctx->log_dev_info->nr_zone_started = 0;
 		ctx->log_dev_info->nr_zone_recovered = 0;
 		ctx->log_dev_info->dev_log_recovery_stats = {0, 0, 0};
 		ctx->sb = &__log_sb[i];
@@ -2361,20 +2557,25 @@ int wal_log_init(wal_log_device_init_ctx_t *log_dev_info_ctx)
 
 		printf("wal_log_init %s rc %x\n", ctx->device_name, log_init_rc);
 
-		if (log_init_rc == WAL_LOG_INIT_FORMATTED) {
+		if (log_init_rc == WAL_LOG_INIT_FORMATTED)
 			ctx->curr_device_idx ++;
-			ctx->log_dev_info = NULL;
-			ctx->sb = NULL;
-			ctx->device_name = NULL;
-			continue;
-		} else {
+		else if (log_init_rc == WAL_LOG_INIT_FAILED)
 			break;
-		}
+		else
+			nr_pending ++;
 	}
 
-	if (log_init_rc == WAL_LOG_INIT_FORMATTED)
-		log_init_rc = WAL_LOG_INIT_DONE;
+	ctx->log_dev_info = NULL;
+	ctx->sb = NULL;
+	ctx->device_name = NULL;
+
+	if (log_init_rc == WAL_LOG_INIT_FAILED)
+		return log_init_rc;
 
+	if (!nr_pending)
+		log_init_rc = WAL_LOG_INIT_DONE;
+	else
+		log_init_rc = WAL_LOG_INIT_RECOVERING;
 
 	return log_init_rc;
 
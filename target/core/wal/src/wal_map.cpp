@@ -45,269 +45,304 @@ wal_key_t *wal_key_clone(wal_key_t *src_key)
 	return clone;
 }
 
-//wal_key_t dummy_key = {"ffffffffffffffff", 16};
-wal_map_item_t *wal_map_allocate_item(void)
-{
-	wal_map_item_t *new_item = (wal_map_item_t *)df_calloc(1, sizeof(wal_map_item_t));
-	new_item->key = (wal_key_t *)df_calloc(1, sizeof(wal_key_t));
-	new_item->key->key = df_malloc(SAMSUNG_KV_MAX_FABRIC_KEY_SIZE + 1);
-	new_item->key_buff_size = SAMSUNG_KV_MAX_FABRIC_KEY_SIZE + 1;
-	new_item->next = NULL;
-	new_item->status = WAL_ITEM_INVALID;
-	new_item->large_key_buff = NULL;
-	return new_item;
+//Fibonacci hashing, the low bits of key_hash already picked the zone
+#define WAL_MAP_HASH_MUL	(0x9E3779B1U)
+#define WAL_MAP_FP_MUL		(0x9E3779B97F4A7C15ULL)
 
-}
-// create buffer during init, given role, space range.
-wal_map_t *wal_map_create(void *ctx, int nr_buckets, wal_map_ops_t *map_ops)
+static inline uint32_t wal_map_slot_idx(wal_map_t *map, uint32_t key_hash)
 {
-	int i = 0;
-	wal_buffer_t *buffer = (wal_buffer_t *)ctx;
-	wal_map_t *map = (wal_map_t *)df_calloc(1, sizeof(wal_map_t));
-	wal_bucket_t *bucket;
-	map->nr_buckets = nr_buckets;
-	map->table = (wal_bucket_t *)df_calloc(nr_buckets, sizeof(wal_bucket_t));
-	bucket = map->table;
-	TAILQ_INIT(&map->head);
+	return (key_hash * WAL_MAP_HASH_MUL) >> map->slot_shift;
+}
 
+//fingerprint from the head and tail bytes of the key, independent of key_hash
+static inline uint16_t wal_map_key_fp(wal_key_t *key)
+{
+	uint64_t head = 0, tail = 0;
 
-	for (; i < nr_buckets; i++, bucket ++) {
-		//prepare three items per buckets
-		wal_map_item_t *new_item = wal_map_allocate_item();
-		new_item->buffer_ptr = buffer;
-		bucket->entry = new_item;
-		new_item = wal_map_allocate_item();
-		new_item->buffer_ptr = buffer;
-		bucket->entry->next = new_item;
-		new_item = wal_map_allocate_item();
-		new_item->buffer_ptr = buffer;
-		bucket->entry->next->next = new_item;
-
-		bucket->total_nr_entries = 3;
-		bucket->valid_nr_entries = 0;
+	if (key->length >= sizeof(uint64_t)) {
+		memcpy(&head, key->key, sizeof(head));
+		memcpy(&tail, (char *)key->key + key->length - sizeof(tail), sizeof(tail));
+	} else {
+		memcpy(&head, key->key, key->length);
 	}
-	map->ops = map_ops;
-	return map;
+
+	return (uint16_t)(((head ^ (tail * WAL_MAP_FP_MUL)) * WAL_MAP_FP_MUL) >> 48);
 }
 
-int wal_map_reinit(wal_map_t *map)
+static int wal_map_add_slab(wal_map_t *map)
 {
-	wal_bucket_t *bucket = NULL, * tmp;
-	int bucket_cnt = 0;
-//	int valid_cnt = 0;
-
-	bucket = map->table;
-	/*
-		INIT_LIST_HEAD(&map->head);
-		for(int i = 0; i < map->nr_buckets; i++, bucket ++){
-			bucket->valid_nr_entries = 0;
-			INIT_LIST_HEAD(&bucket->link);
-		}*/
-
-	TAILQ_FOREACH_SAFE(bucket, &map->head, link, tmp) {
-		bucket->valid_nr_entries = 0;
-		wal_map_item_t *item = bucket->entry;
-		while (item) {
-			item->status = WAL_ITEM_INVALID;
-			item = item->next;
-		}
-		TAILQ_REMOVE(&map->head, bucket, link);
-		bucket_cnt ++;
+	uint32_t key_buff_size = SAMSUNG_KV_MAX_FABRIC_KEY_SIZE + 1;
+	uint32_t nr_items = WAL_MAP_SLAB_NR_ITEMS;
+	wal_map_slab_t *slab;
+	wal_map_item_t *items;
+	wal_key_t *keys;
+	char *key_buff;
+	uint32_t i;
+
+	//items, key headers and key buffers are carved from one allocation
+	slab = (wal_map_slab_t *)df_calloc(1, sizeof(wal_map_slab_t) +
+					   nr_items * (sizeof(wal_map_item_t) + sizeof(wal_key_t) + key_buff_size));
+	if (!slab) {
+		return -1;
+	}
+	slab->nr_items = nr_items;
+	items = (wal_map_item_t *)(slab + 1);
+	keys = (wal_key_t *)(items + nr_items);
+	key_buff = (char *)(keys + nr_items);
+
+	for (i = 0; i < nr_items; i++) {
+		keys[i].key = key_buff + (size_t)i * key_buff_size;
+		items[i].key = &keys[i];
+		items[i].key_buff_size = key_buff_size;
+		items[i].status = WAL_ITEM_INVALID;
+		items[i].buffer_ptr = map->ctx;
+		items[i].large_key_buff = NULL;
+		TAILQ_INSERT_TAIL(&map->free_items, &items[i], link);
 	}
-	TAILQ_INIT(&map->head);
 
-	/*
-		list_for_each_entry_safe(bucket, tmp, &map->head, link){
-			valid_cnt ++;
-		}
-	*/
+	slab->next = map->slabs;
+	map->slabs = slab;
+	return 0;
+}
+
+static wal_map_item_t *wal_map_allocate_item(wal_map_t *map)
+{
+	wal_map_item_t *item;
 
-	//printf("reinit bucket cnt %d\n", bucket_cnt);
-	return bucket_cnt;
+	if (TAILQ_EMPTY(&map->free_items) && wal_map_add_slab(map)) {
+		return NULL;
+	}
 
+	item = TAILQ_FIRST(&map->free_items);
+	TAILQ_REMOVE(&map->free_items, item, link);
+	TAILQ_INSERT_TAIL(&map->head, item, link);
+	return item;
 }
-int wal_map_bucket_iteration(wal_map_t *map)
+
+//double the index, items do not move so item pointers stay valid
+static int wal_map_grow(wal_map_t *map)
 {
-	wal_bucket_t *bucket = NULL;
-	int entry_cnt = 0;
+	wal_map_slot_t *old_slots = map->slots;
+	uint32_t old_nr_slots = map->nr_slots;
+	wal_map_slot_t *slots;
+	uint32_t mask;
+	uint32_t idx;
+	uint32_t i;
+
+	slots = (wal_map_slot_t *)df_calloc((size_t)old_nr_slots * 2, sizeof(wal_map_slot_t));
+	if (!slots) {
+		return -1;
+	}
 
-	TAILQ_FOREACH(bucket, &map->head, link) {
-		int cnt = bucket->valid_nr_entries;
-		wal_map_item_t *entry = bucket->entry;
-		if (cnt >= 2) {
-			wal_debug(" bucket cnt %d\n", cnt);
+	map->slots = slots;
+	map->nr_slots = old_nr_slots * 2;
+	map->slot_shift --;
+	mask = map->nr_slots - 1;
+
+	for (i = 0; i < old_nr_slots; i++) {
+		if (!old_slots[i].item) {
+			continue;
 		}
-		while (cnt --) {
-			//printf("key: 0x%llx addr 0x%llx\t", *(long long *)entry->key->key, (long long)entry->addr);
-			entry = entry->next;
-			entry_cnt ++;
+		idx = wal_map_slot_idx(map, old_slots[i].key_hash);
+		while (slots[idx].item) {
+			idx = (idx + 1) & mask;
 		}
-		//printf("\n");
+		slots[idx] = old_slots[i];
 	}
-	return entry_cnt;
+
+	df_free(old_slots);
+	wal_debug("wal_map_grow map %p to %u slots\n", map, map->nr_slots);
+	return 0;
 }
 
-void wal_map_bucket_list_update(wal_map_t *map, wal_bucket_t *bucket)
+// create buffer during init, given role, space range.
+wal_map_t *wal_map_create(void *ctx, int nr_slots, wal_map_ops_t *map_ops)
 {
-	TAILQ_INSERT_TAIL(&map->head, bucket, link);
-	/*
-	int cnt = 0;
-	wal_bucket_t * bk = NULL;
-	list_for_each_entry(bk, &map->head, link){
-		cnt ++;
+	wal_map_t *map = (wal_map_t *)df_calloc(1, sizeof(wal_map_t));
+	uint32_t slots = WAL_MAP_MIN_SLOTS;
+	uint32_t shift = 32 - __builtin_ctz(WAL_MAP_MIN_SLOTS);
+
+	if (!map) {
+		return NULL;
+	}
+
+	while (slots < (uint32_t)nr_slots) {
+		slots <<= 1;
+		shift --;
+	}
+
+	map->slots = (wal_map_slot_t *)df_calloc(slots, sizeof(wal_map_slot_t));
+	if (!map->slots) {
+		df_free(map);
+		return NULL;
 	}
-	printf("wal_map_bucket_list_update map %p new bucket %p cnt %d\n", map, bucket, cnt);
-	*/
+	map->nr_slots = slots;
+	map->slot_shift = shift;
+	TAILQ_INIT(&map->head);
+	TAILQ_INIT(&map->free_items);
+	map->ctx = ctx;
+	map->ops = map_ops;
+	return map;
 }
 
-int bucket_revalidate(wal_map_t *map, wal_object_t *obj)
+void wal_map_destroy(wal_map_t *map)
 {
-	int bucket_idx = obj->key_hash % map->nr_buckets;
-	wal_bucket_t *bucket = &map->table[bucket_idx];
-
-	int ve = bucket->valid_nr_entries;
-	int te = bucket->total_nr_entries;
+	wal_map_slab_t *slab, *next;
 
-	wal_map_item_t *item = bucket->entry;
+	if (!map) {
+		return;
+	}
 
-	int ive = 0;
-	while (item) {
-		if (item->status == WAL_ITEM_INVALID)
-			ive ++;
-		item = item->next;
+	for (slab = map->slabs; slab; slab = next) {
+		next = slab->next;
+		df_free(slab);
 	}
+	df_free(map->slots);
+	df_free(map);
+}
+
+int wal_map_reinit(wal_map_t *map)
+{
+	wal_map_item_t *item = NULL;
+	int item_cnt = 0;
 
-	if (ive != (te - ve)) {
-		printf("bucket_revalidate: bucket %p te %d ve %d ive %d\n",
-		       bucket, te, ve, ive);
-		bucket->valid_nr_entries = bucket->total_nr_entries - ive;
+	TAILQ_FOREACH(item, &map->head, link) {
+		item->status = WAL_ITEM_INVALID;
+		item_cnt ++;
 	}
+	TAILQ_CONCAT(&map->free_items, &map->head, link);
 
-	return 0;
+	memset(map->slots, 0, (size_t)map->nr_slots * sizeof(wal_map_slot_t));
+	map->nr_used_slots = 0;
+	map->nr_valid_items = 0;
+	map->flush_head = NULL;
+
+	//printf("reinit item cnt %d\n", item_cnt);
+	return item_cnt;
+}
+
+int wal_map_item_iteration(wal_map_t *map)
+{
+	wal_map_item_t *item = NULL;
+	int entry_cnt = 0;
+
+	TAILQ_FOREACH(item, &map->head, link) {
+		if (item->status != WAL_ITEM_INVALID) {
+			entry_cnt ++;
+		}
+	}
+	return entry_cnt;
 }
+
 wal_map_item_t *wal_map_lookup(void *context, wal_map_t *map, wal_object_t *obj,
 			       off64_t addr, wal_map_lookup_type_t lookup_type)
 {
-	//int bucket_idx = map->ops->hash((const char*)obj->key->key, obj->key->length) % map->nr_buckets ;
-	int bucket_idx = obj->key_hash % map->nr_buckets;
-	wal_bucket_t *bucket = &map->table[bucket_idx];
-	int nr_items = bucket->valid_nr_entries;
-	wal_map_item_t *item = bucket->entry;
-	wal_map_item_t *pre_item = NULL, * invalid_item = NULL;
-	int32_t log_size = 0 ;
+	uint32_t mask = map->nr_slots - 1;
+	uint32_t slot_idx = wal_map_slot_idx(map, obj->key_hash);
+	uint16_t key_fp = wal_map_key_fp(obj->key);
+	uint16_t key_len = (uint16_t)obj->key->length;
+	wal_map_slot_t *slot = NULL, * invalid_slot = NULL;
+	wal_map_item_t *item = NULL;
 	int is_read = (lookup_type == WAL_MAP_LOOKUP_READ);
 	wal_map_insert_t map_insert_type = WAL_MAP_INSERT_NEW;
 	int insert_rc = WAL_ERROR_IO;
-	int old_vne = bucket->valid_nr_entries;
-	int old_tne = bucket->total_nr_entries;
-	wal_map_item_t *old_entry = bucket->entry;
-
-
-
-	if (nr_items) {
-		//check conflict
-		while (nr_items) {
 
-			if (item->status == WAL_ITEM_INVALID) {
-				invalid_item = item;
-				pre_item = item;
-				item = item->next;
-				if (!item && nr_items) {
-					//assert(0);
-					bucket_revalidate(map, obj);
-					nr_items = bucket->valid_nr_entries;
-					item = bucket->entry;
-					pre_item = NULL;
-					invalid_item = NULL;
+	//probe until the first empty slot, keys are only compared on a hash and fingerprint match
+	for (;; slot_idx = (slot_idx + 1) & mask) {
+		slot = &map->slots[slot_idx];
+		if (!slot->item) {
+			break;
+		}
 
-				}
+		if (slot->key_hash != obj->key_hash || slot->key_fp != key_fp || slot->key_len != key_len) {
+			continue;
+		}
 
-				continue;
+		item = slot->item;
+		if (item->status == WAL_ITEM_INVALID) {
+			//likely the same key invalidated earlier, reuse it on insert
+			if (!invalid_slot) {
+				invalid_slot = slot;
 			}
+			continue;
+		}
 
-			-- nr_items;
+		if (map->ops->key_comp(obj->key, item->key)) {
+			continue;
+		}
 
-			if (map->ops->key_comp(obj->key, item->key)) {
-				pre_item = item;
-				item = item->next;
-			} else {
-				//found the valid object with the same key, update
-				//update the item->addr with new addr in wal
-				if (lookup_type != WAL_MAP_LOOKUP_READ) {
-					int rc_modify = 0;
-					//printf("update of the same key object: ");
-					if (lookup_type == WAL_MAP_LOOKUP_INVALIDATE || lookup_type == WAL_MAP_LOOKUP_DELETE) {
-						if (lookup_type == WAL_MAP_LOOKUP_DELETE && item->status == WAL_ITEM_DELETED) {
-							//the object already marked as deleted.
-							return NULL;
-						}
-						rc_modify = map->ops->invalidate_item(context, bucket, item);
-						if (lookup_type == WAL_MAP_LOOKUP_INVALIDATE) {
-							//printf("invalid bkt %p item %p status %x nr_entries %d\n", bucket, item,
-							//	item->status, bucket->valid_nr_entries);
-							return item;
-						} else {
-							//for WAL_MAP_LOOKUP_DELETE, mark as deleted, but keep the item. LOG SERVICE ONLY
-							if (lookup_type == WAL_MAP_LOOKUP_DELETE && !rc_modify) {
-								assert(__log_enabled);
-								bucket->valid_nr_entries ++; //due to the invalidat_item reduce the valid cnt.
-							}
-						}
+		//found the valid object with the same key, update
+		//update the item->addr with new addr in wal
+		if (lookup_type != WAL_MAP_LOOKUP_READ) {
+			int rc_modify = 0;
+			//printf("update of the same key object: ");
+			if (lookup_type == WAL_MAP_LOOKUP_INVALIDATE || lookup_type == WAL_MAP_LOOKUP_DELETE) {
+				if (lookup_type == WAL_MAP_LOOKUP_DELETE && item->status == WAL_ITEM_DELETED) {
+					//the object already marked as deleted.
+					return NULL;
+				}
+				rc_modify = map->ops->invalidate_item(context, map, item);
+				if (lookup_type == WAL_MAP_LOOKUP_INVALIDATE) {
+					//printf("invalid map %p item %p status %x nr_valid_items %d\n", map, item,
+					//	item->status, map->nr_valid_items);
+					return item;
+				} else {
+					//for WAL_MAP_LOOKUP_DELETE, mark as deleted, but keep the item. LOG SERVICE ONLY
+					if (lookup_type == WAL_MAP_LOOKUP_DELETE && !rc_modify) {
+						assert(__log_enabled);
+						map->nr_valid_items ++; //due to the invalidat_item reduce the valid cnt.
 					}
+				}
+			}
 
-					if (!addr) {
-						if (lookup_type == WAL_MAP_LOOKUP_WRITE_APPEND)
-							map_insert_type = WAL_MAP_OVERWRITE_APPEND;
-						else if (lookup_type == WAL_MAP_LOOKUP_DELETE)
-							map_insert_type = WAL_MAP_OVERWRITE_DELETE;
-						else
-							map_insert_type = WAL_MAP_OVERWRITE_INPLACE;
-
-						insert_rc = map->ops->insert(context, obj, item, map_insert_type);
-						wal_debug("wal_map_lookup obj map %p [%d] bucket %p 0x%llx%llx insert_type=%d, insert_rc %d\n",
-							  map, bucket_idx, bucket, *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8),
-							  map_insert_type, insert_rc);
-
-						if (WAL_SUCCESS == insert_rc) {
-							if (map_insert_type == WAL_MAP_OVERWRITE_DELETE) {
-								item->status = WAL_ITEM_DELETED;
-								item->val_size = 0;
-								item->recover_status = WAL_ITEM_RECOVER_DELETED;
-							} else {
-								item->val_size = obj->val->length;
-								item->recover_status = WAL_ITEM_RECOVER_OVERWRITE;
-							}
-						} else {
-							if (map_insert_type == WAL_MAP_OVERWRITE_DELETE) {
-								wal_debug("deletion item %p status %x  key 0x%llx%llx failed\n", item, item->status,
-									  *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8));
-								assert(0);
-								return NULL;//WAL_ERROR_DELETE_FAIL;
-							} else {
-								return NULL;
-							}
-						}
+			if (!addr) {
+				if (lookup_type == WAL_MAP_LOOKUP_WRITE_APPEND)
+					map_insert_type = WAL_MAP_OVERWRITE_APPEND;
+				else if (lookup_type == WAL_MAP_LOOKUP_DELETE)
+					map_insert_type = WAL_MAP_OVERWRITE_DELETE;
+				else
+					map_insert_type = WAL_MAP_OVERWRITE_INPLACE;
+
+				insert_rc = map->ops->insert(context, obj, item, map_insert_type);
+				wal_debug("wal_map_lookup obj map %p [%u] 0x%llx%llx insert_type=%d, insert_rc %d\n",
+					  map, slot_idx, *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8),
+					  map_insert_type, insert_rc);
+
+				if (WAL_SUCCESS == insert_rc) {
+					if (map_insert_type == WAL_MAP_OVERWRITE_DELETE) {
+						item->status = WAL_ITEM_DELETED;
+						item->val_size = 0;
+						item->recover_status = WAL_ITEM_RECOVER_DELETED;
 					} else {
-						item->addr = addr;
+						item->val_size = obj->val->length;
+						item->recover_status = WAL_ITEM_RECOVER_OVERWRITE;
 					}
 				} else {
-					//for read, return the valid item
-					if (!(item->status == WAL_ITEM_INVALID) && !(item->status == WAL_ITEM_DELETED)
-					    && map->ops->read_item(context, item, obj)) {
-						return item;
+					if (map_insert_type == WAL_MAP_OVERWRITE_DELETE) {
+						wal_debug("deletion item %p status %x  key 0x%llx%llx failed\n", item, item->status,
+							  *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8));
+						assert(0);
+						return NULL;//WAL_ERROR_DELETE_FAIL;
 					} else {
-						assert(item);
-						wal_debug("invalid/deleted item %p status %d\n", item, item->status);
 						return NULL;
 					}
 				}
-				//printf("exit wal_map_lookup map %p[%d] for item %p\n", map, bucket_idx, item);
+			} else {
+				item->addr = addr;
+			}
+		} else {
+			//for read, return the valid item
+			if (!(item->status == WAL_ITEM_INVALID) && !(item->status == WAL_ITEM_DELETED)
+			    && map->ops->read_item(context, item, obj)) {
 				return item;
+			} else {
+				assert(item);
+				wal_debug("invalid/deleted item %p status %d\n", item, item->status);
+				return NULL;
 			}
 		}
-		//not found same key in the bucket.
-
-
+		//printf("exit wal_map_lookup map %p[%u] for item %p\n", map, slot_idx, item);
+		return item;
 	}
 
 	//not find the object
@@ -315,96 +350,59 @@ wal_map_item_t *wal_map_lookup(void *context, wal_map_t *map, wal_object_t *obj,
 		return NULL;
 	}
 
+	if (is_read) {
+		//found nothing for get
+		return NULL;
+	}
+
 	//insert new object
-	if (!is_read) {
-		if (!bucket->total_nr_entries || bucket->valid_nr_entries == bucket->total_nr_entries) {
-			//create new item here.
-			wal_map_item_t *new_item = (wal_map_item_t *)df_calloc(1, sizeof(wal_map_item_t));
-			new_item->key = wal_key_clone(obj->key);
-			new_item->key_buff_size = obj->key->length;
-			new_item->next = NULL;
-			new_item->status = WAL_ITEM_VALID;
-			new_item->recover_status = WAL_ITEM_RECOVER_NEW;
-			new_item->buffer_ptr = context;
-			item = new_item;
-			if (!addr) {
-				if ((insert_rc = map->ops->insert(context, obj, item, map_insert_type))
-				    == WAL_SUCCESS) {
-					item->val_size = obj->val->length;
-				} else {
-					assert(0);
-					return NULL;
-				}
-				wal_debug("wal_map_lookup obj map[%d] bucket %p 0x%llx%llx insert_type=%d insert_rc %d\n",
-					  bucket_idx, bucket, *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8), map_insert_type,
-					  insert_rc);
-			} else {
-				item->addr = addr;
-			}
-			assert(old_vne == bucket->valid_nr_entries && old_tne == bucket->total_nr_entries);
+	if (invalid_slot) {
+		//reuse the invalid item, slot already carries the key hash
+		item = invalid_slot->item;
+	} else {
+		item = wal_map_allocate_item(map);
+		if (!item) {
+			assert(0);
+			return NULL;
+		}
+		slot->key_hash = obj->key_hash;
+		slot->key_fp = key_fp;
+		slot->key_len = key_len;
+		slot->item = item;
+		map->nr_used_slots ++;
+	}
 
-			if (!bucket->total_nr_entries) { //the first item in the bucket
-				bucket->entry = item;
-				//bucket link list update
-				wal_map_bucket_list_update(map, bucket);
-			} else {
-				pre_item->next = new_item;	//add new item for the same bucket.
-			}
+	assert(obj->key->length <= item->key_buff_size);
+	item->status = WAL_ITEM_VALID;
+	item->recover_status = WAL_ITEM_RECOVER_NEW;
+	item->buffer_ptr = context;
+	item->key->length = obj->key->length;
+	memcpy(item->key->key, obj->key->key, obj->key->length);
+
+	if (!addr) {
+		if ((insert_rc = map->ops->insert(context, obj, item, map_insert_type))
+		    == WAL_SUCCESS) {
+			item->val_size = obj->val->length;
 		} else {
-			if (bucket->valid_nr_entries < bucket->total_nr_entries) {
-				//reuse the same map item with different key
-				//printf("1 pre_item 0x%p item %p .. %d .. %d\t", pre_item, item, bucket->valid_nr_entries, bucket->total_nr_entries);
-				if (bucket->valid_nr_entries) {
-					//printf("2 pre_item 0x%p item %p .. %d .. %d\n", pre_item, item, bucket->valid_nr_entries, bucket->total_nr_entries);
-
-					assert(item || invalid_item); 	//reuse recycled item
-				}
-
-				if (invalid_item)	//reuse invalid item entry.
-					item = invalid_item;
-
-				item->status = WAL_ITEM_VALID;
-				item->recover_status = WAL_ITEM_RECOVER_NEW;
-				if (item->key_buff_size < obj->key->length) {
-					df_free(item->key);
-					item->key = wal_key_clone(obj->key);
-					item->key_buff_size = obj->key->length;
-				} else {
-					item->key->length = obj->key->length;
-					memcpy(item->key->key, obj->key->key, obj->key->length);
-				}
-
-				if (!addr) {
-					if (WAL_SUCCESS == map->ops->insert(context, obj, item, map_insert_type)) {
-						item->val_size = obj->val->length;
-					} else {
-						assert(0);
-						return NULL;
-					}
-				} else {
-					item->addr = addr;
-				}
-
-				//if(!bucket->valid_nr_entries){//first item for reused item list
-				if (TAILQ_NEXT(bucket, link) == NULL) {
-					wal_map_bucket_list_update(map, bucket);
-				}
-				//}
-
-			} else {
-				assert(0);
-			}
+			item->status = WAL_ITEM_INVALID;
+			assert(0);
+			return NULL;
 		}
-		//update the item list count
-		bucket->valid_nr_entries ++;
-		if (bucket->total_nr_entries < bucket->valid_nr_entries)
-			bucket->total_nr_entries = bucket->valid_nr_entries;
-
+		wal_debug("wal_map_lookup obj map %p [%u] 0x%llx%llx insert_type=%d insert_rc %d\n",
+			  map, slot_idx, *(long long *)obj->key->key, *(long long *)((char *)obj->key->key + 8), map_insert_type,
+			  insert_rc);
 	} else {
-		//found nothing for get
-		return NULL;
+		item->addr = addr;
+	}
+
+	//update the valid item count
+	map->nr_valid_items ++;
+
+	if ((uint64_t)map->nr_used_slots * 100 > (uint64_t)map->nr_slots * WAL_MAP_MAX_LOAD_PCT) {
+		//a failed grow only lengthens probes
+		wal_map_grow(map);
 	}
-	//printf("exit wal_map_lookup map %p[%d] for item %p\n", map, bucket_idx, item);
+
+	//printf("exit wal_map_lookup map %p[%u] for item %p\n", map, slot_idx, item);
 	return item;
 }
-
@@ -114,6 +114,7 @@ int dfly_wal_generic_poll(void *ctx)
 {
 	struct wal_thread_inst_ctx *wal_thrd_ctx = (struct wal_thread_inst_ctx *)ctx;
 	int i, rc;
+	int nr_pending_zones = 0;
 
 	for (i = 0; i < wal_thrd_ctx->num_zones; i++) {
 		wal_zone_t *zone = wal_thrd_ctx->zone_arr[i];
@@ -170,10 +171,12 @@ int dfly_wal_generic_poll(void *ctx)
 			int nr_reqs_holded =  dump_hdr->nr_batch_reqs;
 			void *dump_src_addr = (void *)dump_hdr;
 
-			zone->dump_timeout_us = zone->dump_timeout_us + g_wal_conf.wal_log_batch_timeout_us_adjust;
-			zone->log_batch_nr_obj = zone->log_batch_nr_obj - g_wal_conf.wal_log_batch_nr_obj_adjust;
-			if (zone->log_batch_nr_obj <= 0)
-				zone->log_batch_nr_obj = 1;
+			if (!zone->commit_ctrl.target_us) {
+				zone->dump_timeout_us = zone->dump_timeout_us + g_wal_conf.wal_log_batch_timeout_us_adjust;
+				zone->log_batch_nr_obj = zone->log_batch_nr_obj - g_wal_conf.wal_log_batch_nr_obj_adjust;
+				if (zone->log_batch_nr_obj <= 0)
+					zone->log_batch_nr_obj = 1;
+			}
 
 			assert(zone->associated_zone);
 			zone->log->nr_dump_group ++;
@@ -184,7 +187,8 @@ int dfly_wal_generic_poll(void *ctx)
 				  dump_rc);
 
 		} else {
-			if (!cache_dump_info->dump_blk &&
+			//the commit controller tracks idle periods through the arrival time itself
+			if (!zone->commit_ctrl.target_us && !cache_dump_info->dump_blk &&
 			    elapsed_time(cache_dump_info->idle_ts) >= zone->dump_timeout_us * 4) {
 				zone->dump_timeout_us = g_wal_conf.wal_log_batch_timeout_us;
 				zone->log_batch_nr_obj = g_wal_conf.wal_log_batch_nr_obj;
@@ -204,9 +208,14 @@ int dfly_wal_generic_poll(void *ctx)
 			break;
 		}
 
+		//an open dump group, a cache flush or a retry is only advanced by this poller
+		if (cache_dump_info->dump_blk || (zone->poll_flush_flag & WAL_POLL_FLUSH_DOING)
+		    || !TAILQ_EMPTY(&zone->wp_queue)) {
+			nr_pending_zones++;
+		}
 	}
 
-	return 0;
+	return nr_pending_zones;
 }
 
 //Call only once per thread instantiation
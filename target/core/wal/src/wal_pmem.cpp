@@ -0,0 +1,399 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/mman.h>
+#include <sys/sysmacros.h>
+
+#include <wal_lib.h>
+#include <wal_pmem.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+#ifndef MAP_SHARED_VALIDATE
+#define MAP_SHARED_VALIDATE	0x03
+#endif
+#ifndef MAP_SYNC
+#define MAP_SYNC	0x80000
+#endif
+
+#define WAL_PMEM_SYSFS_PATH_SZ	128
+
+typedef struct wal_pmem_dev_s {
+	int fd;
+	char *addr;		//NULL when the slot is free
+	int64_t size;
+	bool map_sync;	//the mapping is MAP_SYNC, flushed cache lines are durable
+} wal_pmem_dev_t;
+
+typedef struct wal_pmem_comp_s {
+	df_dev_io_completion_cb cb;
+	void *cb_arg;
+} wal_pmem_comp_t;
+
+static wal_pmem_dev_t __wal_pmem_dev[WAL_MAX_LOG_DEV];
+static void (*__wal_pmem_flush)(const void *addr, size_t len) = NULL;
+
+#if defined(__x86_64__)
+__attribute__((target("clwb")))
+static void wal_pmem_flush_clwb(const void *addr, size_t len)
+{
+	uintptr_t p = (uintptr_t)addr & ~(uintptr_t)(WAL_PMEM_CACHELINE - 1);
+
+	for (; p < (uintptr_t)addr + len; p += WAL_PMEM_CACHELINE)
+		_mm_clwb((void *)p);
+}
+
+__attribute__((target("clflushopt")))
+static void wal_pmem_flush_clflushopt(const void *addr, size_t len)
+{
+	uintptr_t p = (uintptr_t)addr & ~(uintptr_t)(WAL_PMEM_CACHELINE - 1);
+
+	for (; p < (uintptr_t)addr + len; p += WAL_PMEM_CACHELINE)
+		_mm_clflushopt((void *)p);
+}
+
+static void wal_pmem_flush_clflush(const void *addr, size_t len)
+{
+	uintptr_t p = (uintptr_t)addr & ~(uintptr_t)(WAL_PMEM_CACHELINE - 1);
+
+	for (; p < (uintptr_t)addr + len; p += WAL_PMEM_CACHELINE)
+		_mm_clflush((void *)p);
+}
+
+//pick the cheapest cache line flush the cpu has, clwb keeps the line cached.
+static void wal_pmem_flush_init(void)
+{
+	unsigned int eax, ebx = 0, ecx, edx;
+
+	__wal_pmem_flush = wal_pmem_flush_clflush;
+	if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		if (ebx & bit_CLWB)
+			__wal_pmem_flush = wal_pmem_flush_clwb;
+		else if (ebx & bit_CLFLUSHOPT)
+			__wal_pmem_flush = wal_pmem_flush_clflushopt;
+	}
+}
+
+void wal_pmem_memcpy_persist(void *dst, const void *src, size_t len)
+{
+	char *d = (char *)dst;
+	const char *s = (const char *)src;
+	size_t head;
+
+	if (!__wal_pmem_flush)
+		wal_pmem_flush_init();
+
+	if (len < WAL_PMEM_NT_MIN_SZ) {
+		memcpy(d, s, len);
+		__wal_pmem_flush(d, len);
+		_mm_sfence();
+		return;
+	}
+
+	//bring the destination to a cache line boundary, then stream whole lines past the cache
+	head = (WAL_PMEM_CACHELINE - ((uintptr_t)d & (WAL_PMEM_CACHELINE - 1))) & (WAL_PMEM_CACHELINE - 1);
+	if (head) {
+		memcpy(d, s, head);
+		__wal_pmem_flush(d, head);
+		d += head;
+		s += head;
+		len -= head;
+	}
+
+	for (; len >= WAL_PMEM_CACHELINE; len -= WAL_PMEM_CACHELINE) {
+		__m128i x0 = _mm_loadu_si128((const __m128i *)s);
+		__m128i x1 = _mm_loadu_si128((const __m128i *)s + 1);
+		__m128i x2 = _mm_loadu_si128((const __m128i *)s + 2);
+		__m128i x3 = _mm_loadu_si128((const __m128i *)s + 3);
+		_mm_stream_si128((__m128i *)d, x0);
+		_mm_stream_si128((__m128i *)d + 1, x1);
+		_mm_stream_si128((__m128i *)d + 2, x2);
+		_mm_stream_si128((__m128i *)d + 3, x3);
+		d += WAL_PMEM_CACHELINE;
+		s += WAL_PMEM_CACHELINE;
+	}
+
+	if (len) {
+		memcpy(d, s, len);
+		__wal_pmem_flush(d, len);
+	}
+
+	//orders the streaming stores and the flushes before the completion
+	_mm_sfence();
+}
+#else
+void wal_pmem_memcpy_persist(void *dst, const void *src, size_t len)
+{
+	//no user space flush, such mappings are never MAP_SYNC, see wal_pmem_dev_open
+	memcpy(dst, src, len);
+}
+#endif
+
+static int wal_pmem_msync(char *addr, size_t len)
+{
+	uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(WAL_PAGESIZE - 1);
+
+	return msync((void *)start, (uintptr_t)addr + len - start, MS_SYNC);
+}
+
+#ifndef DSS_BUILD_CUNIT_TEST
+//completions of a submitting thread, delivered in submit order by one message
+typedef struct wal_pmem_comp_ring_s {
+	uint32_t head;
+	uint32_t tail;
+	bool msg_pending;
+	wal_pmem_comp_t slot[WAL_PMEM_COMP_SLOTS];
+} wal_pmem_comp_ring_t;
+
+static __thread wal_pmem_comp_ring_t __wal_pmem_comp;
+
+static void wal_pmem_complete_msg(void *arg)
+{
+	wal_pmem_comp_ring_t *ring = (wal_pmem_comp_ring_t *)arg;
+	uint32_t end = ring->tail;
+	struct df_dev_response_s resp = {0};
+	wal_pmem_comp_t comp;
+
+	resp.rc = true;
+	//completions queued by the callbacks go out with the next message
+	while (ring->head != end) {
+		comp = ring->slot[ring->head % WAL_PMEM_COMP_SLOTS];
+		ring->head++;
+		comp.cb(resp, comp.cb_arg);
+	}
+
+	ring->msg_pending = false;
+	if (ring->head != ring->tail &&
+	    !spdk_thread_send_msg(spdk_get_thread(), wal_pmem_complete_msg, ring))
+		ring->msg_pending = true;
+}
+#endif
+
+//make sure the completion of a request can be delivered before doing the io
+static int wal_pmem_comp_reserve(void *cb)
+{
+#ifndef DSS_BUILD_CUNIT_TEST
+	wal_pmem_comp_ring_t *ring = &__wal_pmem_comp;
+
+	if (!cb)
+		return 0;
+
+	if (ring->tail - ring->head == WAL_PMEM_COMP_SLOTS)
+		return -WAL_ERROR_BDEV;
+
+	if (!ring->msg_pending) {
+		if (spdk_thread_send_msg(spdk_get_thread(), wal_pmem_complete_msg, ring))
+			return -WAL_ERROR_BDEV;
+		ring->msg_pending = true;
+	}
+#endif
+	return 0;
+}
+
+//the data is durable already, but the callers expect the completion after the submit
+//returns, as with a bdev. Queue it for the submitting thread, the slot was reserved
+//by wal_pmem_comp_reserve.
+static void wal_pmem_complete(void *cb, void *cb_arg)
+{
+	if (!cb)
+		return;
+
+#ifndef DSS_BUILD_CUNIT_TEST
+	wal_pmem_comp_ring_t *ring = &__wal_pmem_comp;
+	wal_pmem_comp_t *comp = &ring->slot[ring->tail % WAL_PMEM_COMP_SLOTS];
+
+	assert(ring->msg_pending);
+	comp->cb = (df_dev_io_completion_cb)cb;
+	comp->cb_arg = cb_arg;
+	ring->tail++;
+#else
+	struct df_dev_response_s resp = {0};
+
+	resp.rc = true;
+	((df_dev_io_completion_cb)cb)(resp, cb_arg);
+#endif
+}
+
+//size of a device dax is only published in sysfs
+static int64_t wal_pmem_chrdev_size(struct stat *st)
+{
+	char path[WAL_PMEM_SYSFS_PATH_SZ];
+	long long size = 0;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "/sys/dev/char/%u:%u/size", major(st->st_rdev), minor(st->st_rdev));
+	f = fopen(path, "r");
+	if (!f)
+		return -1;
+	if (fscanf(f, "%lld", &size) != 1)
+		size = -1;
+	fclose(f);
+
+	return size;
+}
+
+static int wal_pmem_dev_open(const char *pathname, int flags)
+{
+	wal_pmem_dev_t *dev = NULL;
+	struct stat st;
+	void *addr;
+	int handle;
+
+	for (handle = 0; handle < WAL_MAX_LOG_DEV; handle++) {
+		if (!__wal_pmem_dev[handle].addr) {
+			dev = &__wal_pmem_dev[handle];
+			break;
+		}
+	}
+	if (!dev)
+		return -WAL_ERROR_HANDLE;
+
+	dev->fd = open(pathname, O_RDWR);
+	if (dev->fd < 0) {
+		printf("wal_pmem_dev_open: fail to open %s errno %d\n", pathname, errno);
+		return -WAL_ERROR_HANDLE;
+	}
+
+	if (fstat(dev->fd, &st))
+		goto fail;
+	dev->size = S_ISCHR(st.st_mode) ? wal_pmem_chrdev_size(&st) : (int64_t)st.st_size;
+	if (dev->size <= 0)
+		goto fail;
+
+	dev->map_sync = true;
+	addr = mmap(NULL, dev->size, PROT_READ | PROT_WRITE, MAP_SHARED_VALIDATE | MAP_SYNC, dev->fd, 0);
+#if !defined(__x86_64__)
+	if (addr != MAP_FAILED) {
+		munmap(addr, dev->size);
+		addr = MAP_FAILED;
+	}
+#endif
+	if (addr == MAP_FAILED) {
+		//not DAX, page cache backed and persisted by msync
+		dev->map_sync = false;
+		addr = mmap(NULL, dev->size, PROT_READ | PROT_WRITE, MAP_SHARED, dev->fd, 0);
+		if (addr == MAP_FAILED)
+			goto fail;
+	}
+	dev->addr = (char *)addr;
+
+	printf("wal_pmem_dev_open: %s handle %d size_mb %lld %s\n", pathname, handle,
+	       (long long)(dev->size >> 20), dev->map_sync ? "dax" : "msync");
+
+	return handle;
+
+fail:
+	printf("wal_pmem_dev_open: fail to map %s errno %d\n", pathname, errno);
+	close(dev->fd);
+	dev->fd = -1;
+	return -WAL_ERROR_HANDLE;
+}
+
+static int wal_pmem_dev_close(int handle)
+{
+	wal_pmem_dev_t *dev = &__wal_pmem_dev[handle];
+
+	if (!dev->addr)
+		return -WAL_ERROR_HANDLE;
+
+	munmap(dev->addr, dev->size);
+	close(dev->fd);
+	dev->addr = NULL;
+	dev->fd = -1;
+	return 0;
+}
+
+static int wal_pmem_dev_read(int handle, void *buff, uint64_t offset, uint64_t nbytes,
+			     void *cb, void *cb_arg)
+{
+	wal_pmem_dev_t *dev = &__wal_pmem_dev[handle];
+
+	int rc;
+
+	if (offset + nbytes > (uint64_t)dev->size)
+		return -WAL_ERROR_BAD_ADDR;
+
+	rc = wal_pmem_comp_reserve(cb);
+	if (rc)
+		return rc;
+
+	memcpy(buff, dev->addr + offset, nbytes);
+	wal_pmem_complete(cb, cb_arg);
+	return nbytes;
+}
+
+static int wal_pmem_dev_write(int handle, const void *buff, uint64_t offset, uint64_t nbytes,
+			      void *cb, void *cb_arg)
+{
+	wal_pmem_dev_t *dev = &__wal_pmem_dev[handle];
+	char *dst = dev->addr + offset;
+	int rc;
+
+	if (offset + nbytes > (uint64_t)dev->size)
+		return -WAL_ERROR_BAD_ADDR;
+
+	rc = wal_pmem_comp_reserve(cb);
+	if (rc)
+		return rc;
+
+	if (dev->map_sync) {
+		wal_pmem_memcpy_persist(dst, buff, nbytes);
+	} else {
+		memcpy(dst, buff, nbytes);
+		if (wal_pmem_msync(dst, nbytes))
+			return -WAL_ERROR_BDEV;
+	}
+
+	wal_pmem_complete(cb, cb_arg);
+	return nbytes;
+}
+
+int64_t wal_pmem_getsize(int handle)
+{
+	return __wal_pmem_dev[handle].size;
+}
+
+bool wal_pmem_is_map_sync(int handle)
+{
+	return __wal_pmem_dev[handle].map_sync;
+}
+
+wal_device_io_ops_t wal_log_pmem_io = {
+	wal_pmem_dev_open,
+	wal_pmem_dev_close,
+	wal_pmem_dev_read,
+	wal_pmem_dev_write,
+};
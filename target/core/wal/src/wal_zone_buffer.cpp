@@ -76,9 +76,9 @@ int wal_zone_object_iteration(wal_zone_t *zone)
 {
 	int cnt_flush = 0, cnt_log = 0;
 
-	cnt_flush = wal_map_bucket_iteration(zone->flush->map);
+	cnt_flush = wal_map_item_iteration(zone->flush->map);
 	wal_debug("zone %d: object iteration flush %d\n", zone->zone_id, cnt_flush);
-	cnt_log = wal_map_bucket_iteration(zone->log->map);
+	cnt_log = wal_map_item_iteration(zone->log->map);
 	wal_debug("zone %d: object iteration log %d\n", zone->zone_id, cnt_log);
 	return cnt_flush + cnt_log;
 }
@@ -359,6 +359,12 @@ zone_insert_done:
 		dump_hdr->req_list[dump_hdr->nr_batch_reqs++] = obj->obj_private;
 		if (1 == dump_hdr->nr_batch_reqs) {
 			start_timer(&p_dump_info->dump_ts);
+			dump_hdr->zone = zone;
+			dump_hdr->open_ts = p_dump_info->dump_ts;
+		}
+		if (zone->commit_ctrl.target_us) {
+			wal_commit_ctrl_arrival(&zone->commit_ctrl, elapsed_time(zone->arrival_ts));
+			start_timer(&zone->arrival_ts);
 		}
 		if (dump_hdr->nr_batch_reqs >= zone->log_batch_nr_obj) {
 			p_dump_info->dump_flags |= DUMP_BATCH;
@@ -367,10 +373,13 @@ zone_insert_done:
 			wal_debug("zone[%d] timeout_us %d batch_nr %d\n",
 				  zone->zone_id, zone->dump_timeout_us, zone->log_batch_nr_obj);
 
-			zone->dump_timeout_us = MAX(zone->dump_timeout_us - g_wal_conf.wal_log_batch_timeout_us_adjust,
-						    g_wal_conf.wal_log_batch_timeout_us);
-			zone->log_batch_nr_obj = MIN(zone->log_batch_nr_obj + g_wal_conf.wal_log_batch_nr_obj_adjust,
-						     g_wal_conf.wal_log_batch_nr_obj);
+			//with the commit controller the batch is resized on the write completion
+			if (!zone->commit_ctrl.target_us) {
+				zone->dump_timeout_us = MAX(zone->dump_timeout_us - g_wal_conf.wal_log_batch_timeout_us_adjust,
+							    g_wal_conf.wal_log_batch_timeout_us);
+				zone->log_batch_nr_obj = MIN(zone->log_batch_nr_obj + g_wal_conf.wal_log_batch_nr_obj_adjust,
+							     g_wal_conf.wal_log_batch_nr_obj);
+			}
 
 			if (!buffer_switched) {
 				//prepare an new dump obj group.
@@ -550,11 +559,7 @@ int wal_buffer_deinit(wal_buffer_t *buffer)
 {
 	if (buffer) {
 		if (buffer->map) {
-			if (buffer->map->table) {
-				//iterate the hash table to free the entry list.. TBD
-				df_free(buffer->map->table);
-			}
-			df_free(buffer->map);
+			wal_map_destroy(buffer->map);
 		}
 		if (buffer->fh != WAL_INIT_FH) {
 			close(buffer->fh);
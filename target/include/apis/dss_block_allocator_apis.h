@@ -61,8 +61,30 @@ struct dss_blk_allocator_disk_config_s {
 
 typedef struct dss_blk_allocator_disk_config_s dss_blk_allocator_disk_config_t;
 
+typedef enum dss_blk_allocator_backend_e {
+    BLK_ALLOCATOR_BACKEND_BITMAP = 0, // n-bit cell per block bitmap
+    BLK_ALLOCATOR_BACKEND_EXTENT_TREE = 1 // Tree of free and state extents
+} dss_blk_allocator_backend_t;
+
 typedef struct dss_blk_allocator_serialized_s dss_blk_allocator_serialized_t;
 
+// Free extent histogram bucket i counts extents of [2^i, 2^(i+1)) blocks
+#define BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS (32)
+// Allocation size classes of 1, 2-4, 5-16, 17-64 and 65+ blocks
+#define BLK_ALLOCATOR_NUM_SIZE_CLASSES (5)
+
+/**
+ * @brief Free space fragmentation report of a block allocator
+ */
+typedef struct dss_blk_allocator_frag_stats_s {
+    uint64_t free_blocks;
+    uint64_t free_extents;
+    uint64_t free_extent_hist[BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS];
+    uint64_t size_class_regions[BLK_ALLOCATOR_NUM_SIZE_CLASSES]; // Regions
+                                                                 // serving
+                                                                 // each class
+} dss_blk_allocator_frag_stats_t;
+
 typedef enum dss_blk_allocator_status_e {
     BLK_ALLOCATOR_STATUS_ERROR = -1,
     BLK_ALLOCATOR_STATUS_SUCCESS = 0,
@@ -104,6 +126,29 @@ struct dss_blk_allocator_opts_s {
                                        // allocator
     bool enable_ba_meta_sync; // Enable or disable block allocation meta 
                               // sync interface to disk
+    uint64_t num_alloc_groups; // - Number of allocation groups the blocks
+                               //   are split into, each with its own
+                               //   seek optimizer and bitmap slice
+                               // - 1 keeps a single group
+    uint64_t meta_sync_group_max_reqs; // - Number of meta sync requests
+                                       //   committed by one meta write
+                                       // - 1 disables group commit
+    uint64_t meta_sync_group_window_us; // - Max time the first request of
+                                        //   a group waits for followers
+    uint64_t journal_start_block; // First block of the allocation journal
+    uint64_t journal_num_blocks; // - Number of blocks in the allocation
+                                 //   journal
+                                 // - 0 rewrites the bitmap in place on
+                                 //   every meta sync
+    dss_blk_allocator_backend_t backend; // - In-memory representation of
+                                         //   block states
+                                         // - On-disk meta is the same
+                                         //   bitmap for every backend
+    uint64_t size_class_region_blocks; // - Blocks per size class region,
+                                       //   allocations that miss their
+                                       //   hint go to a region of their
+                                       //   size class
+                                       // - 0 disables size classes
 };
 
 /**
@@ -151,6 +196,17 @@ dss_blk_allocator_status_t dss_blk_allocator_load_opts_from_disk_data(uint8_t *s
 dss_blk_allocator_status_t dss_blk_allocator_load_meta_from_disk_data(
         dss_blk_allocator_context_t* ctx, uint8_t *serialized_data, uint64_t serialized_data_len, uint64_t byte_offset);
 
+/**
+ * @brief Replay the allocation journal over the meta loaded by dss_blk_allocator_load_meta_from_disk_data
+ *
+ * @param serialized_data Data buffer read from the disk containing the whole journal region
+ * @param serialized_data_len length of valid serialized data
+ * @param[OUT] num_records number of journal records replayed
+ * @return dss_blk_allocator_status_t BLK_ALLOCATOR_STATUS_SUCCESS on success or error code otherwise
+ */
+dss_blk_allocator_status_t dss_blk_allocator_load_journal_from_disk_data(
+        dss_blk_allocator_context_t* ctx, uint8_t *serialized_data, uint64_t serialized_data_len, uint64_t *num_records);
+
 //In-Memory APIs
 
 /**
@@ -226,6 +282,15 @@ dss_blk_allocator_status_t dss_blk_allocator_alloc_blocks_contig(dss_blk_allocat
  */
 dss_blk_allocator_status_t dss_blk_allocator_print_stats();
 
+/**
+ * @brief Report free space fragmentation of the block allocator
+ *
+ * @param ctx block allocator context
+ * @param[out] stats free extent histogram and size class regions
+ * @return dss_blk_allocator_status_t BLK_ALLOCATOR_STATUS_SUCCESS on success or error code otherwise
+ */
+dss_blk_allocator_status_t dss_blk_allocator_get_frag_stats(dss_blk_allocator_context_t *ctx, dss_blk_allocator_frag_stats_t *stats);
+
 /**
  * @brief Write block allocator meta-data to file (/var/log/dss_bmap.data)
  *
@@ -266,6 +331,16 @@ dss_blk_allocator_status_t dss_blk_allocator_queue_sync_meta_io_tasks(dss_blk_al
  */
 dss_blk_allocator_status_t dss_blk_allocator_get_next_submit_meta_io_tasks(dss_blk_allocator_context_t *ctx, dss_io_task_t **io_task);
 
+/**
+ * @brief Number of meta sync IO tasks queued but not yet handed out by
+ *        dss_blk_allocator_get_next_submit_meta_io_tasks, including the
+ *        tasks of a group commit window still open
+ *
+ * @param ctx block allocator context
+ * @return uint64_t number of pending tasks, 0 if the allocator does not order meta IO
+ */
+uint64_t dss_blk_allocator_get_num_pending_meta_io_tasks(dss_blk_allocator_context_t *ctx);
+
 /**
  * @brief Update block allocator of meta IO completion
  *
@@ -172,7 +172,7 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m);
  * @param m Context pointer of io task module
  * @return dss_iov_t* An empty IO vector allocated
  */
-// dss_iov_t *dss_io_iov_get(dss_io_task_module_t *m);
+dss_iov_t *dss_io_iov_get(dss_io_task_module_t *m);
 
 /**
  * @brief Return provided IO vector to module io vector pool
@@ -181,7 +181,7 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m);
  * @param iov IO vector to be returned back to io module
  * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
  */
-// dss_io_task_status_t dss_io_iov_free(dss_io_task_module_t *m, dss_iov_t *iov);
+dss_io_task_status_t dss_io_iov_free(dss_io_task_module_t *m, dss_iov_t *iov);
 
 /**
  * @brief Add a data region to IO vector
@@ -190,16 +190,16 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m);
  * @param data Pointer to the memory containing the data
  * @param len Length of the data region
  * @param offset Offset from the data* where the valid data starts
- * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
+ * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR if the vector is full
  */
-// dss_io_task_status_t dss_io_iov_add(dss_iov_t *iov, void *data, uint64_t len, uint64_t offset);
+dss_io_task_status_t dss_io_iov_add(dss_iov_t *iov, void *data, uint64_t len, uint64_t offset);
 
 /**
  * @brief Clear data regions in the IO vector
  *
  * @param iov IO vector that the data regions need to be cleared
  */
-// void dss_io_iov_clear(dss_iov_t *iov);
+void dss_io_iov_clear(dss_iov_t *iov);
 
 /**
  * @brief Get an IO task from the IO module task pool
@@ -211,13 +211,22 @@ dss_io_task_module_status_t dss_io_task_module_end(dss_io_task_module_t *m);
 dss_io_task_status_t dss_io_task_get_new(dss_io_task_module_t *m, dss_io_task_t **task);
 
 /**
- * @brief Reset/remove all completed operations from io_task
+ * @brief Reset/remove all completed and failed operations from io_task
  * 
  * @param io_task io task containing ops to be reset
  * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
  */
 dss_io_task_status_t dss_io_task_reset_ops(dss_io_task_t *io_task);
 
+/**
+ * @brief Get the completion status of an IO task, valid once the completion
+ *        is delivered to the task owner and till the task ops are reset
+ *
+ * @param io_task IO task context pointer
+ * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS if every op completed, DSS_IO_TASK_STATUS_ERROR if any op failed
+ */
+dss_io_task_status_t dss_io_task_get_status(dss_io_task_t *io_task);
+
 /**
  * @brief Return an IO task to the IO module task pool
  *
@@ -239,6 +248,17 @@ dss_io_task_status_t dss_io_task_put(dss_io_task_t *io_task);
  */
 dss_io_task_status_t dss_io_task_setup(dss_io_task_t *io_task, dss_request_t *req, dss_module_instance_t *cb_minst, void *cb_ctx, bool cb_to_cq);
 
+/**
+ * @brief Group IO tasks so their completions are posted together once every
+ *        task in the group has completed. Must be called before any of the
+ *        tasks is submitted. The group is released after the last completion
+ *
+ * @param tasks IO tasks to be completed together
+ * @param ntasks Number of tasks in the array
+ * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
+ */
+dss_io_task_status_t dss_io_task_group_create(dss_io_task_t **tasks, uint32_t ntasks);
+
 /**
  * @brief Add a block readv operation to the IO task
  *
@@ -246,11 +266,11 @@ dss_io_task_status_t dss_io_task_setup(dss_io_task_t *io_task, dss_request_t *re
  * @param target_dev Target IO device
  * @param lba Target LBA on disk
  * @param num_blocks Number blocks corresponding to the IO operation starting from `lba`
- * @param iov IO vector having ranges correspoing to the data
- * @param is_blocking Indicates if the current operation is blocking until completion
+ * @param iov IO vector having ranges correspoing to the data, owned by the task and returned to the io vector pool when task ops are reset
+ * @param opts IO options for the operation
  * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
  */
-// dss_io_task_status_t dss_io_task_add_blk_readv(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, bool is_blocking);
+dss_io_task_status_t dss_io_task_add_blk_readv(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, dss_io_opts_t *opts);
 
 /**
  * @brief Add a block writev operation to the IO task
@@ -259,11 +279,11 @@ dss_io_task_status_t dss_io_task_setup(dss_io_task_t *io_task, dss_request_t *re
  * @param target_dev Target IO device
  * @param lba Target LBA on disk
  * @param num_blocks Number blocks corresponding to the IO operation starting from `lba`
- * @param iov IO vector having ranges correspoing to the data
- * @param is_blocking Indicates if the current operation is blocking until completion
+ * @param iov IO vector having ranges correspoing to the data, owned by the task and returned to the io vector pool when task ops are reset
+ * @param opts IO options for the operation
  * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
  */
-// dss_io_task_status_t dss_io_task_add_blk_writev(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, bool is_blocking);
+dss_io_task_status_t dss_io_task_add_blk_writev(dss_io_task_t *task, dss_device_t *target_dev, uint64_t lba, uint64_t num_blocks, dss_iov_t *iov, dss_io_opts_t *opts);
 
 /**
  * @brief Add a block read operation to the IO task
@@ -294,6 +314,7 @@ dss_io_task_status_t dss_io_task_add_blk_write(dss_io_task_t *task, dss_device_t
 
 /**
  * @brief Iterate over ops in an io task to get op details filtered with module id
+ *        Completed and failed ops of a failed io task can be iterated for cleanup
  *
  * @param task IO Task whose ops needs to be iterated over
  * @param mod_id Module ID that needs to be matching with op
@@ -312,6 +333,15 @@ dss_io_task_status_t dss_io_task_get_op_ranges(dss_io_task_t *task, dss_io_op_ow
  */
 dss_io_task_status_t dss_io_task_submit(dss_io_task_t *task);
 
+/**
+ * @brief Complete an IO task with no ops pending, without going through the device.
+ *        The completion is delivered to the task owner the same way as a submitted task.
+ *
+ * @param task IO task to be completed
+ * @return dss_io_task_status_t DSS_IO_TASK_STATUS_SUCCESS on succes, DSS_IO_TASK_STATUS_ERROR otherwise
+ */
+dss_io_task_status_t dss_io_task_post_completion(dss_io_task_t *task);
+
 /**
  * @brief Submit the dss request to underlying block device without io_module
  * 
@@ -334,6 +364,18 @@ struct spdk_io_channel *dss_io_dev_get_channel(dss_device_t *io_device);
  */
 void dss_io_task_submit_to_device(dss_io_task_t *task);
 
+/**
+ * @brief Hold io task ops submitted on the current core on their device
+ *        channels till dss_io_task_unplug is called. Staged ops with
+ *        adjacent LBAs on the same device are merged into one block io
+ */
+void dss_io_task_plug(void);
+
+/**
+ * @brief Submit all ops staged on the current core since dss_io_task_plug
+ */
+void dss_io_task_unplug(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -62,6 +62,7 @@ typedef enum dss_module_status_e {
 	DSS_MODULE_STATUS_INIT_PENDING,
 	DSS_MODULE_STATUS_MOD_DESTROYED,
 	DSS_MODULE_STATUS_MOD_DESTROY_PENDING,
+	DSS_MODULE_STATUS_BUSY,
 	/* Add new error code here*/
 	DSS_MODULE_STATUS_ERROR = -1
 } dss_module_status_t;
@@ -125,15 +126,47 @@ typedef struct dss_io_task_module_s dss_io_task_module_t;
 typedef uint32_t key_size_t;
 typedef struct kvtrans_ctx_s kvtrans_ctx_t;
 typedef struct kvtrans_req kvtrans_req_t;
+typedef struct kvtrans_batch_read_s kvtrans_batch_read_t;
 
 typedef enum dss_kvt_state_e {
     DSS_KVT_LOADING_SUPERBLOCK = 0,
     DSS_KVT_LOAD_SUPERBLOCK_COMPLETE,
     DSS_KVT_LOADING_BA_META,
+    // block allocator journal read and replayed over the bitmap
+    DSS_KVT_LOADING_BA_JOURNAL,
+    DSS_KVT_REPLAYING_BA_JOURNAL,
+    // index snapshot header read, entries read, header invalidated
+    DSS_KVT_LOADING_SNAPSHOT,
+    DSS_KVT_CHECKING_SNAPSHOT,
+    DSS_KVT_RESTORING_SNAPSHOT,
+    DSS_KVT_INVALIDATING_SNAPSHOT,
     DSS_KVT_LOADING_DC_HT,
-    DSS_KVT_INITIALIZED
+    DSS_KVT_MERGING_DC_HT,
+    DSS_KVT_INITIALIZED,
+    // state of a sub request scanning one LBA range for DC table
+    DSS_KVT_SCANNING_DC_RANGE,
+    // states of a request saving the index snapshot on stop
+    DSS_KVT_SAVING_SNAPSHOT,
+    DSS_KVT_SAVED_SNAPSHOT_DATA,
+    DSS_KVT_SNAPSHOT_SAVED
 } dss_kvt_state_t;
 
+typedef struct kvtrans_boot_batch_s kvtrans_boot_batch_t;
+
+typedef struct dss_kvt_boot_stat_s {
+    uint64_t start_tick;
+    uint64_t end_tick;
+    uint64_t blks_scanned;
+    uint64_t ios;
+    uint64_t blks_read;
+    uint64_t dc_entries;
+    uint64_t keys;
+    uint64_t meta;
+    uint64_t mc;
+    uint64_t mdc;
+    uint64_t packed_blks;
+} dss_kvt_boot_stat_t;
+
 typedef struct dss_kvt_init_ctx_s {
     dss_device_t *dev;
     dss_io_task_module_t *iotm;
@@ -154,16 +187,30 @@ typedef struct dss_kvt_init_ctx_s {
 
     // the next mdc entry index
     uint64_t dss_mdc_lba;
-    // the maximum parallel IOs to load dc block
-    uint32_t mdc_io_depth;
-    // pre-allocated memory for dc_tbl entries
-    void *dc_entries;
-    // dc entry size
-    uint32_t dc_ent_sz;
-    // the number of outstanding mdc IOs
-    uint32_t mdc_io_count;
-    // the last batch of mdc IOs
-    bool last_batch;
+    // one past the last lba of the scanned range
+    uint64_t dss_mdc_end_lba;
+    // coalesced reads of the outstanding batch
+    kvtrans_boot_batch_t *boot_batch;
+    // dc table built from the scanned range
+    void *range_dc_tbl;
+    // the loading request a range request reports to
+    dss_request_t *parent_req;
+    // range requests of the loading request
+    uint32_t num_ranges;
+    uint32_t pending_ranges;
+    dss_request_t **range_reqs;
+    // ba meta loading start, dc table loading start
+    uint64_t ba_start_tick;
+    uint64_t dc_start_tick;
+    dss_kvt_boot_stat_t boot_stat;
+    // block allocator journal region read at boot
+    void *ba_journal_data;
+    // entries of the index snapshot read at boot
+    void *snapshot_data;
+    // dc table restored from the index snapshot
+    bool snapshot_loaded;
+    // module stop waiting for the index snapshot
+    void *stop_ctx;
 } dss_kvt_init_ctx_t;
 
 typedef double tick_t;
@@ -197,6 +244,9 @@ typedef struct req_s {
     kv_op_t opc;
 } req_t;
 
+// keys an insert may move to their alternate bucket in cuckoo placement
+#define DSS_KVTRANS_CUCKOO_MAX_KICKS (8)
+
 enum kvtrans_req_e {
     REQ_INITIALIZED = 0,
     QUEUE_TO_LOAD_ENTRY,
@@ -206,6 +256,11 @@ enum kvtrans_req_e {
     QUEUE_TO_LOAD_COL_EXT,
     COL_EXT_LOADING_DONE,
     COL_EXT_LOADING_CONTIG,
+    // cuckoo placement: bucket of a key to move read, key moved
+    QUEUE_TO_LOAD_KICK,
+    KICK_LOADING_DONE,
+    QUEUE_TO_RELOCATE,
+    RELOCATE_DONE,
     QUEUE_TO_START_IO,
     QUEUED_FOR_DATA_IO,
     IO_CMPL,
@@ -234,6 +289,32 @@ struct kvtrans_req{
     dss_io_task_t *io_tasks;
     bool io_to_queue;
     bool ba_meta_updated;
+    // entry blk index was already computed by a batch hash pass
+    bool entry_hashed;
+    // merged entry read owned by this request
+    kvtrans_batch_read_t *batch_read;
+    // meta blk read from disk to add to the meta cache on completion
+    struct blk_ctx *meta_fill_blk;
+    uint32_t meta_fill_seq;
+    // store added a new key rather than updating an existing one
+    bool key_created;
+    // an io task of this request completed with an error
+    bool io_failed;
+    // cuckoo placement: candidate buckets, then the alternate buckets of relocated keys
+    uint64_t cuckoo_bucket[2 + DSS_KVTRANS_CUCKOO_MAX_KICKS];
+    uint8_t cuckoo_num_locked;
+    uint8_t cuckoo_retries;
+    // slots of the keys to move, each to the slot of the next one, and how many moved
+    uint8_t cuckoo_kick_slot[DSS_KVTRANS_CUCKOO_MAX_KICKS];
+    uint8_t cuckoo_num_kicks;
+    uint8_t cuckoo_num_moved;
+    // record of a packed key that outgrew its blk, dropped once the key is moved
+    uint8_t cuckoo_packed_pos;
+    int16_t cuckoo_packed_rec;
+    // relocation generation seen when the lookup started
+    uint64_t cuckoo_gen;
+    // contiguous read of a bucket
+    void *cuckoo_buf;
     // a blk_ctx to maintain meta info
     TAILQ_HEAD(blk_elm, blk_ctx) meta_chain;
     int32_t num_meta_blk;
@@ -64,6 +64,15 @@ void dss_net_setup_request(dss_request_t *req, dss_module_instance_t *m_inst, vo
 
 void dss_net_teardown_request(dss_request_t *req);
 
+/**
+ * @brief Run the net request state machine
+ *
+ * @param req request to process
+ * @return dss_module_status_t DSS_MODULE_STATUS_SUCCESS, DSS_MODULE_STATUS_BUSY if the
+ *         target module is out of credits and req has to be processed again later
+ */
+dss_module_status_t dss_net_request_process(dss_request_t *req);
+
 void dss_nvmf_process_as_no_op(dss_request_t *req);
 
 dss_request_opc_t dss_nvmf_get_dss_opc(void *req);
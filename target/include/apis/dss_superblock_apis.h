@@ -42,6 +42,13 @@ extern "C" {
 
 // Physical block address of super block set to block `0`
 #define SUPER_BLOCK_START 0
+// Size of the region reserved for the kvtrans index snapshot
+#define DSS_KVT_SNAPSHOT_SIZE_BYTES (8 * 1024 * 1024)
+// Size of the region reserved for the block allocator journal
+#define DSS_BA_JOURNAL_SIZE_BYTES (16 * 1024 * 1024)
+// kvtrans meta block placement recorded by the formatter
+#define DSS_KVT_META_PLACEMENT_CHAIN (0)
+#define DSS_KVT_META_PLACEMENT_CUCKOO (1)
 
 /**
  * @brief super block ondisk data structure
@@ -55,8 +62,18 @@ typedef struct __attribute__((__packed__)) dss_super_block_s {
     uint64_t logi_blk_alloc_meta_end_blk; //8
     uint16_t is_blk_alloc_meta_load_needed; //2
     uint64_t logi_super_blk_start_addr; //8
+    // kvtrans index snapshot region, both 0 if not reserved
+    uint64_t logi_kvt_snapshot_start_blk; //8
+    uint64_t logi_kvt_snapshot_end_blk; //8
+    // block allocator journal region, both 0 if not reserved
+    uint64_t logi_blk_alloc_journal_start_blk; //8
+    uint64_t logi_blk_alloc_journal_end_blk; //8
+    // kvtrans meta layout, all 0 for chain placement on older devices
+    uint8_t kvt_meta_placement; //1
+    uint8_t kvt_cuckoo_bucket_blks; //1
+    uint8_t kvt_packed_meta; //1
     // padding to fill a 4K range
-    char resv[4046];
+    char resv[4011];
 } dss_super_block_t;
 
 
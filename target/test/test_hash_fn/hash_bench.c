@@ -0,0 +1,212 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Key hashing throughput of every hash_type_e, one key per update call
+ * versus update_batch over BENCH_BATCH keys.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "kvtrans_hash.h"
+
+#define BENCH_BATCH (64)
+#define BENCH_HASH_SIZE (32)
+
+static const char *hash_type_names[] = {
+    "sha256_take_bit", "sha256_take_byte", "xxhash", "spooky"
+};
+
+static void help() {
+    printf("usage:\n");
+    printf("\t\t./dss_test_hash_bench <key_num> <key_len> <loops>\n");
+    printf("arguments:\n");
+    printf("\t\t -key_num: the number of keys hashed per loop.\n");
+    printf("\t\t -key_len: the key length in bytes, 0 for random length in [16, 256).\n");
+    printf("\t\t -loops: the number of passes over the key set.\n");
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void init_bench_hash_fn_ctx(hash_fn_ctx_t *hash_fn_ctx, enum hash_type_e hash_type)
+{
+    memset(hash_fn_ctx, 0, sizeof(hash_fn_ctx_t));
+    hash_fn_ctx->hash_type = hash_type;
+    hash_fn_ctx->hash_size = BENCH_HASH_SIZE;
+    hash_fn_ctx->max_tryout = BENCH_HASH_SIZE;
+
+    switch (hash_type) {
+        case sha256_take_bit:
+            hash_fn_ctx->init = SHA256_init;
+            hash_fn_ctx->update = SHA256_update_take_bit;
+            hash_fn_ctx->clean = SHA256_clean;
+            hash_fn_ctx->update_batch = HASH_update_batch;
+            break;
+        case sha256_take_byte:
+            hash_fn_ctx->init = SHA256_init;
+            hash_fn_ctx->update = SHA256_update_take_byte;
+            hash_fn_ctx->clean = SHA256_clean;
+            hash_fn_ctx->update_batch = HASH_update_batch;
+            break;
+        case xxhash:
+            hash_fn_ctx->init = XXHASH_init;
+            hash_fn_ctx->update = XXHASH_update;
+            hash_fn_ctx->clean = XXHASH_clean;
+            hash_fn_ctx->update_batch = XXHASH_update_batch;
+            break;
+        case spooky:
+            hash_fn_ctx->init = SPOOKY_init;
+            hash_fn_ctx->update = SPOOKY_update;
+            hash_fn_ctx->clean = SPOOKY_clean;
+            hash_fn_ctx->update_batch = HASH_update_batch;
+            break;
+    }
+    hash_fn_ctx->init(hash_fn_ctx);
+}
+
+static void free_bench_hash_fn_ctx(hash_fn_ctx_t *hash_fn_ctx)
+{
+    if (hash_fn_ctx->hash_type == sha256_take_bit ||
+        hash_fn_ctx->hash_type == sha256_take_byte) {
+        free(hash_fn_ctx->buf);
+        free(hash_fn_ctx->sha256_ctx);
+    }
+}
+
+int main(int arc, char **argv)
+{
+    hash_fn_ctx_t hash_fn_ctx;
+    const char **keys;
+    uint32_t *klens;
+    uint64_t *single_out, *batch_out;
+    uint32_t num_key, key_len, loops;
+    uint32_t i, j, l, n;
+    int hash_type;
+    double t, single_sec, batch_sec;
+
+    if (arc != 4) {
+        printf("Input error\n");
+        help();
+        return 1;
+    }
+
+    num_key = atoi(argv[1]);
+    key_len = atoi(argv[2]);
+    loops = atoi(argv[3]);
+    if (num_key == 0 || loops == 0) {
+        help();
+        return 1;
+    }
+
+    keys = (const char **) calloc(num_key, sizeof(char *));
+    klens = (uint32_t *) calloc(num_key, sizeof(uint32_t));
+    single_out = (uint64_t *) calloc(num_key, sizeof(uint64_t));
+    batch_out = (uint64_t *) calloc(num_key, sizeof(uint64_t));
+    if (!keys || !klens || !single_out || !batch_out) {
+        printf("ERROR: malloc key set failed.\n");
+        return 1;
+    }
+
+    srand(RNG_SEED);
+    for (i = 0; i < num_key; i++) {
+        char *key;
+        klens[i] = key_len ? key_len : 16 + rand() % 240;
+        key = (char *) malloc(klens[i]);
+        if (!key) {
+            printf("ERROR: malloc key failed.\n");
+            return 1;
+        }
+        for (j = 0; j < klens[i]; j++) {
+            key[j] = (char) rand();
+        }
+        keys[i] = key;
+    }
+
+    printf("keys %u, key_len %u, loops %u, xxh32 lanes %u\n",
+            num_key, key_len, loops, xxh32_batch_lanes());
+    printf("%-18s %16s %16s %8s\n", "hash", "single keys/s", "batch keys/s", "speedup");
+
+    for (hash_type = sha256_take_bit; hash_type <= spooky; hash_type++) {
+        init_bench_hash_fn_ctx(&hash_fn_ctx, hash_type);
+
+        t = now_sec();
+        for (l = 0; l < loops; l++) {
+            for (i = 0; i < num_key; i++) {
+                hash_fn_ctx.clean(&hash_fn_ctx);
+                hash_fn_ctx.update(keys[i], klens[i], &hash_fn_ctx);
+                single_out[i] = hash_fn_ctx.hashcode;
+            }
+        }
+        single_sec = now_sec() - t;
+
+        t = now_sec();
+        for (l = 0; l < loops; l++) {
+            for (i = 0; i < num_key; i += n) {
+                n = num_key - i < BENCH_BATCH ? num_key - i : BENCH_BATCH;
+                hash_fn_ctx.update_batch(&keys[i], &klens[i], &batch_out[i], n, &hash_fn_ctx);
+            }
+        }
+        batch_sec = now_sec() - t;
+
+        if (memcmp(single_out, batch_out, num_key * sizeof(uint64_t))) {
+            printf("ERROR: %s batch hashcode mismatch\n", hash_type_names[hash_type]);
+            return 1;
+        }
+
+        printf("%-18s %16.0f %16.0f %7.2fx\n", hash_type_names[hash_type],
+                (double) num_key * loops / single_sec,
+                (double) num_key * loops / batch_sec,
+                single_sec / batch_sec);
+
+        free_bench_hash_fn_ctx(&hash_fn_ctx);
+    }
+
+    for (i = 0; i < num_key; i++) {
+        free((void *) keys[i]);
+    }
+    free(keys);
+    free(klens);
+    free(single_out);
+    free(batch_out);
+
+    return 0;
+}
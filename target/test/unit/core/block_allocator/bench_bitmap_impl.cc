@@ -0,0 +1,154 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "bitmap_impl.h"
+
+/**
+ * Google Benchmark headers
+ */
+#include <benchmark/benchmark.h>
+
+/**
+ * - Benchmarks for range operations on QwordVector64Cell
+ * - Each benchmark reports time per block in `per_block`
+ *   for a range of `num_blocks` given as the benchmark argument
+ */
+const uint64_t BENCH_TOTAL_CELLS = 4 * 1024 * 1024;
+const uint8_t BENCH_BITS_PER_CELL = 4;
+const uint64_t BENCH_NUM_BLOCK_STATES = 5;
+const uint64_t BENCH_BLOCK_STATE = 1;
+
+static std::shared_ptr<AllocatorType::QwordVector64Cell> bench_bitmap(
+        bool with_jso) {
+
+    BlockAlloc::JudySeekOptimizerSharedPtr jso = nullptr;
+
+    if (with_jso) {
+        jso = std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                BENCH_TOTAL_CELLS, 0, 128);
+    }
+
+    return std::make_shared<AllocatorType::QwordVector64Cell>(
+            jso,
+            nullptr,
+            BENCH_TOTAL_CELLS,
+            BENCH_BITS_PER_CELL,
+            BENCH_NUM_BLOCK_STATES,
+            0,
+            0);
+}
+
+static void set_per_block_counter(
+        benchmark::State& state, uint64_t num_blocks) {
+    state.counters["per_block"] = benchmark::Counter(
+            num_blocks,
+            benchmark::Counter::kIsIterationInvariantRate |
+            benchmark::Counter::kInvert);
+}
+
+/**
+ * Contiguous allocation and free of a large value, including
+ * the seek optimizer bookkeeping done on the write path
+ */
+static void BM_alloc_blocks_contig(benchmark::State& state) {
+    uint64_t num_blocks = state.range(0);
+    uint64_t allocated_block = 0;
+    auto bmap = bench_bitmap(true);
+
+    for (auto _ : state) {
+        if (bmap->alloc_blocks_contig(BENCH_BLOCK_STATE, 0, num_blocks,
+                    &allocated_block) != BLK_ALLOCATOR_STATUS_SUCCESS) {
+            state.SkipWithError("alloc_blocks_contig failed");
+            break;
+        }
+        bmap->clear_blocks(allocated_block, num_blocks);
+    }
+    set_per_block_counter(state, num_blocks);
+}
+BENCHMARK(BM_alloc_blocks_contig)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+/**
+ * Bitmap fill of a range without the seek optimizer
+ */
+static void BM_clear_blocks(benchmark::State& state) {
+    uint64_t num_blocks = state.range(0);
+    auto bmap = bench_bitmap(false);
+
+    for (auto _ : state) {
+        bmap->clear_blocks(1, num_blocks);
+        benchmark::ClobberMemory();
+    }
+    set_per_block_counter(state, num_blocks);
+}
+BENCHMARK(BM_clear_blocks)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+/**
+ * Scan of a range where all blocks are in the checked state
+ */
+static void BM_check_blocks_state(benchmark::State& state) {
+    uint64_t num_blocks = state.range(0);
+    uint64_t scanned_index = 0;
+    auto bmap = bench_bitmap(true);
+
+    bmap->alloc_blocks_contig(BENCH_BLOCK_STATE, 1, num_blocks, nullptr);
+    for (auto _ : state) {
+        bmap->check_blocks_state(1, num_blocks, BENCH_BLOCK_STATE,
+                &scanned_index);
+        benchmark::DoNotOptimize(scanned_index);
+    }
+    if (scanned_index != num_blocks) {
+        state.SkipWithError("check_blocks_state stopped early");
+    }
+    set_per_block_counter(state, num_blocks);
+}
+BENCHMARK(BM_check_blocks_state)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+/**
+ * Free space scan of an empty range
+ */
+static void BM_seek_empty_cell_range(benchmark::State& state) {
+    uint64_t num_blocks = state.range(0);
+    bool is_empty = false;
+    auto bmap = bench_bitmap(false);
+
+    for (auto _ : state) {
+        is_empty = bmap->seek_empty_cell_range(1, num_blocks);
+        benchmark::DoNotOptimize(is_empty);
+    }
+    if (!is_empty) {
+        state.SkipWithError("seek_empty_cell_range found a used cell");
+    }
+    set_per_block_counter(state, num_blocks);
+}
+BENCHMARK(BM_seek_empty_cell_range)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,380 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "alloc_group_impl.h"
+#include <assert.h>
+#include <thread>
+
+/**
+ * Cppunit headers
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+// Cells held by one 4K meta block with 4 bits per cell
+const uint64_t TEST_CELLS_PER_META_BLK = 8192;
+const uint64_t TEST_LOGICAL_BLOCK_OFFSET = 16;
+
+
+class AllocGroupTest : public CppUnit::TestFixture {
+public:
+    AllocGroupTest() {
+
+        total_blocks = 3 * TEST_CELLS_PER_META_BLK + 100;
+        bits_per_cell = 4;
+        num_block_states = 5;
+        block_alloc_meta_start_offset = 1;
+        logical_start_block_offset = TEST_LOGICAL_BLOCK_OFFSET;
+        logical_block_size = 4096;
+    }
+
+    void setUp();
+    void tearDown();
+
+    void test_group_layout();
+    void test_alloc_clear();
+    void test_cross_group_range();
+    void test_spill_alloc();
+    void test_cross_thread_free();
+    void test_serialize_load();
+
+    CPPUNIT_TEST_SUITE(AllocGroupTest);
+    CPPUNIT_TEST(test_group_layout);
+    CPPUNIT_TEST(test_alloc_clear);
+    CPPUNIT_TEST(test_cross_group_range);
+    CPPUNIT_TEST(test_spill_alloc);
+    CPPUNIT_TEST(test_cross_thread_free);
+    CPPUNIT_TEST(test_serialize_load);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    std::shared_ptr<AllocatorType::AllocGroups> groups;
+    uint64_t total_blocks;
+    uint8_t bits_per_cell;
+    uint64_t num_block_states;
+    uint64_t block_alloc_meta_start_offset;
+    uint64_t logical_start_block_offset;
+    uint64_t logical_block_size;
+};
+
+void AllocGroupTest::setUp() {
+    // No io task orderer, so groups are owned per thread
+    groups = std::make_shared<AllocatorType::AllocGroups>(
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset,
+            logical_block_size,
+            128,
+            4);
+}
+
+void AllocGroupTest::tearDown() {
+    groups->destroy();
+    groups.reset();
+}
+
+void AllocGroupTest::test_group_layout() {
+
+    BlockAlloc::JudySeekOptimizerSharedPtr jso =
+        std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                total_blocks, logical_start_block_offset, 128);
+    AllocatorType::QwordVector64Cell bmap(
+            jso,
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset);
+    uint64_t drive_lba = 0;
+    uint64_t drive_num_blocks = 0;
+    uint64_t single_lba = 0;
+    uint64_t single_num_blocks = 0;
+
+    // Groups are rounded up to whole meta blocks
+    CPPUNIT_ASSERT(groups->group_blocks() == TEST_CELLS_PER_META_BLK);
+    CPPUNIT_ASSERT(groups->num_groups() == 4);
+
+    // On-disk layout matches a single bitmap
+    CPPUNIT_ASSERT(groups->get_physical_size() == bmap.get_physical_size());
+
+    // Translate a range spanning the first two groups
+    CPPUNIT_ASSERT(groups->translate_meta_to_drive_addr(
+                logical_start_block_offset + TEST_CELLS_PER_META_BLK - 10,
+                20, logical_block_size, logical_block_size,
+                drive_lba, drive_num_blocks) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(bmap.translate_meta_to_drive_addr(
+                logical_start_block_offset + TEST_CELLS_PER_META_BLK - 10,
+                20, logical_block_size, logical_block_size,
+                single_lba, single_num_blocks) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(drive_lba == single_lba);
+    CPPUNIT_ASSERT(drive_num_blocks == single_num_blocks);
+    CPPUNIT_ASSERT(drive_num_blocks == 2);
+}
+
+void AllocGroupTest::test_alloc_clear() {
+
+    uint64_t allocated = 0;
+    uint64_t state = 0;
+    uint64_t scanned_index = 0;
+    uint64_t boundary = logical_start_block_offset + TEST_CELLS_PER_META_BLK;
+
+    // Allocate at hint at the end of the first group
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                2, boundary - 8, 8, &allocated) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(allocated == boundary - 8);
+
+    // And at the start of the second group
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                2, boundary, 8, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    groups->get_block_state(boundary, &state);
+    CPPUNIT_ASSERT(state == 2);
+
+    // State check across the group boundary
+    groups->check_blocks_state(boundary - 8, 32, 2, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == boundary + 7);
+
+    // Clear across the group boundary
+    CPPUNIT_ASSERT(groups->clear_blocks(boundary - 8, 16) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    groups->check_blocks_state(boundary - 8, 16,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == boundary + 7);
+
+    // Out of range requests fail
+    CPPUNIT_ASSERT(groups->clear_blocks(
+                logical_start_block_offset + total_blocks - 1, 2) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+}
+
+void AllocGroupTest::test_cross_group_range() {
+
+    uint64_t state = 0;
+    uint64_t scanned_index = 0;
+    uint64_t boundary = logical_start_block_offset + TEST_CELLS_PER_META_BLK;
+
+    // Exact placement across the group boundary
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                2, boundary - 8, 16, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    groups->check_blocks_state(boundary - 8, 16, 2, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == boundary + 7);
+
+    // State change across the group boundary
+    CPPUNIT_ASSERT(groups->set_blocks_state(boundary - 1, 2, 3) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    groups->get_block_state(boundary - 1, &state);
+    CPPUNIT_ASSERT(state == 3);
+    groups->get_block_state(boundary, &state);
+    CPPUNIT_ASSERT(state == 3);
+
+    CPPUNIT_ASSERT(groups->clear_blocks(boundary - 8, 16) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Failure in the second group releases the part in the first
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                2, boundary + 4, 1, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                2, boundary - 8, 16, NULL) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+    groups->check_blocks_state(boundary - 8, 8,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == boundary - 1);
+
+    // Ranges past the last block fail
+    CPPUNIT_ASSERT(groups->set_blocks_state(
+                logical_start_block_offset + total_blocks - 1, 2, 3) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+}
+
+void AllocGroupTest::test_spill_alloc() {
+
+    uint64_t allocated = 0;
+    uint64_t last_group_start =
+        logical_start_block_offset + 3 * TEST_CELLS_PER_META_BLK;
+
+    // Fill the first group
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                1, logical_start_block_offset,
+                TEST_CELLS_PER_META_BLK, &allocated) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Exact placement in a full group fails
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                1, logical_start_block_offset, 1, NULL) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+
+    // Spill to the freest group
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                1, logical_start_block_offset, 16, &allocated) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(allocated >=
+            logical_start_block_offset + TEST_CELLS_PER_META_BLK);
+    CPPUNIT_ASSERT(allocated < last_group_start);
+
+    // Requests larger than the free blocks of any group fail
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                1, logical_start_block_offset,
+                TEST_CELLS_PER_META_BLK + 1, &allocated) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+}
+
+void AllocGroupTest::test_cross_thread_free() {
+
+    uint64_t allocated = 0;
+    uint64_t other_allocated = 0;
+    uint64_t state = 0;
+    dss_blk_allocator_status_t other_status = BLK_ALLOCATOR_STATUS_ERROR;
+
+    // Main thread owns the first group
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                3, logical_start_block_offset, 4, &allocated) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    std::thread other([&]() {
+        // Free is queued for the owner of the group
+        if (groups->clear_blocks(allocated, 4) !=
+                BLK_ALLOCATOR_STATUS_SUCCESS) {
+            return;
+        }
+        // Allocation at a hint owned elsewhere goes to a free group
+        other_status = groups->alloc_blocks_contig(
+                3, logical_start_block_offset, 4, &other_allocated);
+    });
+    other.join();
+
+    CPPUNIT_ASSERT(groups->deferred_frees() == 1);
+    CPPUNIT_ASSERT(other_status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(other_allocated >=
+            logical_start_block_offset + TEST_CELLS_PER_META_BLK);
+
+    // Owner applies the queued free on its next operation
+    groups->get_block_state(allocated, &state);
+    CPPUNIT_ASSERT(state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+
+    // Group owned by the other thread rejects allocations here
+    CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                3, other_allocated + 4, 1, NULL) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+}
+
+void AllocGroupTest::test_serialize_load() {
+
+    BlockAlloc::JudySeekOptimizerSharedPtr jso =
+        std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                total_blocks, logical_start_block_offset, 128);
+    AllocatorType::QwordVector64Cell bmap(
+            jso,
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset);
+    std::shared_ptr<AllocatorType::AllocGroups> loaded;
+    uint64_t num_meta_blocks =
+        groups->get_physical_size() / logical_block_size + 1;
+    uint64_t serialized_len = 0;
+    void *serialized = nullptr;
+    uint64_t lb = 0;
+    uint64_t state = 0;
+    uint64_t loaded_state = 0;
+
+    // One allocation in every group
+    for (uint64_t i = 0; i < 4; i++) {
+        lb = logical_start_block_offset + i * TEST_CELLS_PER_META_BLK + i;
+        CPPUNIT_ASSERT(groups->alloc_blocks_contig(
+                    i + 1, lb, 10, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    }
+
+    CPPUNIT_ASSERT(groups->serialize_drive_data(
+                block_alloc_meta_start_offset, num_meta_blocks,
+                logical_block_size, &serialized, serialized_len) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(serialized_len == num_meta_blocks * logical_block_size);
+
+    // Load into a single bitmap and a different group split
+    loaded = std::make_shared<AllocatorType::AllocGroups>(
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset,
+            logical_block_size,
+            128,
+            2);
+    CPPUNIT_ASSERT(bmap.load_meta_from_disk_data(
+                (uint8_t *)serialized, bmap.get_physical_size(), 0) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(loaded->load_meta_from_disk_data(
+                (uint8_t *)serialized, serialized_len, 0) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    for (lb = logical_start_block_offset;
+            lb < logical_start_block_offset + total_blocks; lb++) {
+        groups->get_block_state(lb, &state);
+        CPPUNIT_ASSERT(bmap.get_cell_value(lb) == state);
+        loaded->get_block_state(lb, &loaded_state);
+        CPPUNIT_ASSERT(loaded_state == state);
+    }
+    CPPUNIT_ASSERT(jso->get_allocated_blocks() == 40);
+
+    free(serialized);
+}
+
+int main() {
+
+    /**
+     * Main driver for CPPUNIT framework
+     */
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(AllocGroupTest::suite());
+	runner.run();
+	return 0;
+
+}
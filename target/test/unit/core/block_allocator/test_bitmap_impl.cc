@@ -130,6 +130,7 @@ public:
     void test_logical_start_block_offset();
     void test_serialize_deserialize();
     void test_perf_bitmap();
+    void test_range_word_scan();
 
     CPPUNIT_TEST_SUITE(BitmapTest);
     CPPUNIT_TEST(test_bitmap_integrity);
@@ -140,6 +141,7 @@ public:
     CPPUNIT_TEST(test_logical_start_block_offset);
     CPPUNIT_TEST(test_serialize_deserialize);
     CPPUNIT_TEST(test_perf_bitmap);
+    CPPUNIT_TEST(test_range_word_scan);
     CPPUNIT_TEST_SUITE_END();
 private:
     AllocatorType::BitMapSharedPtr bmap;
@@ -441,6 +443,55 @@ void BitmapTest::test_perf_bitmap() {
         (scan_end - scan_begin).count() << "[ns]" << std::endl;
 }
 
+/**
+ * - Tests range scans and fills that work a qword at a time
+ * - Ranges start and end inside qwords and span several
+ *   qwords so that partial and whole qword paths are covered
+ */
+void BitmapTest::test_range_word_scan() {
+
+    uint64_t begin = 13;
+    uint64_t len = 200;
+    uint64_t used_cell = begin + 150;
+    uint64_t scanned_index = 0;
+    uint8_t state = 3;
+
+    // Range is free to begin with
+    CPPUNIT_ASSERT(perf_bmap->seek_empty_cell_range(begin, len));
+
+    // A single used cell deep in the range is found
+    perf_bmap->set_cell(used_cell, 1);
+    CPPUNIT_ASSERT(!perf_bmap->seek_empty_cell_range(begin, len));
+    CPPUNIT_ASSERT(perf_bmap->seek_empty_cell_range(begin,
+                used_cell - begin));
+    CPPUNIT_ASSERT(perf_bmap->seek_empty_cell_range(used_cell + 1,
+                len - (used_cell - begin) - 1));
+
+    // Scan stops right before the first block in another state
+    CPPUNIT_ASSERT(std::dynamic_pointer_cast
+            <AllocatorType::QwordVector64Cell>(perf_bmap)->check_blocks_state(
+                begin, len, DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE,
+                &scanned_index) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(scanned_index == used_cell - 1);
+
+    // Scan covers only the requested range
+    for (uint64_t i = begin; i < used_cell; i++) {
+        perf_bmap->set_cell(i, state);
+    }
+    std::dynamic_pointer_cast
+        <AllocatorType::QwordVector64Cell>(perf_bmap)->check_blocks_state(
+                begin + 1, 50, state, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == begin + 50);
+    CPPUNIT_ASSERT(perf_bmap->get_cell_value(begin - 1) ==
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+
+    // Clean bitmap by unsetting value for next experiment
+    for (uint64_t i = begin; i <= used_cell; i++) {
+        perf_bmap->set_cell(i, 0);
+    }
+    CPPUNIT_ASSERT(perf_bmap->seek_empty_cell_range(begin, len));
+}
+
 int main() {
 
     /**
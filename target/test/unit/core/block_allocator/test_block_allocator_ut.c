@@ -36,6 +36,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "dss_block_allocator_ut.c"
 
@@ -71,8 +72,13 @@ int main(int argc, char **argv)
 
     g_ba_ut.opts.enable_ba_meta_sync = true;
 
-    if(argc == 2) {
-        g_ba_ut.opts.num_block_states = atol(argv[1]);
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "extent_tree")) {
+            // Run the same cases on the extent tree backend
+            g_ba_ut.opts.backend = BLK_ALLOCATOR_BACKEND_EXTENT_TREE;
+        } else {
+            g_ba_ut.opts.num_block_states = atol(argv[i]);
+        }
     }
 
     CU_pSuite pSuite = NULL;
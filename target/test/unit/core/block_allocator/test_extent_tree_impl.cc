@@ -0,0 +1,331 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "extent_tree_impl.h"
+#include "bitmap_impl.h"
+#include <assert.h>
+
+/**
+ * Cppunit headers
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/TestSuite.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestRunner.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+// Cells held by one 4K meta block with 4 bits per cell
+const uint64_t TEST_CELLS_PER_META_BLK = 8192;
+const uint64_t TEST_LOGICAL_BLOCK_OFFSET = 16;
+
+
+class ExtentTreeTest : public CppUnit::TestFixture {
+public:
+    ExtentTreeTest() {
+
+        total_blocks = 2 * TEST_CELLS_PER_META_BLK + 100;
+        bits_per_cell = 4;
+        num_block_states = 5;
+        block_alloc_meta_start_offset = 1;
+        logical_start_block_offset = TEST_LOGICAL_BLOCK_OFFSET;
+        logical_block_size = 4096;
+    }
+
+    void setUp();
+    void tearDown();
+
+    void test_extent_merge_split();
+    void test_check_state();
+    void test_serialize_load();
+
+    CPPUNIT_TEST_SUITE(ExtentTreeTest);
+    CPPUNIT_TEST(test_extent_merge_split);
+    CPPUNIT_TEST(test_check_state);
+    CPPUNIT_TEST(test_serialize_load);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+    BlockAlloc::JudySeekOptimizerSharedPtr jso;
+    std::shared_ptr<AllocatorType::ExtentTree> extents;
+    BlockAlloc::JudySeekOptimizerSharedPtr bmap_jso;
+    std::shared_ptr<AllocatorType::QwordVector64Cell> bmap;
+    uint64_t total_blocks;
+    uint8_t bits_per_cell;
+    uint64_t num_block_states;
+    uint64_t block_alloc_meta_start_offset;
+    uint64_t logical_start_block_offset;
+    uint64_t logical_block_size;
+};
+
+void ExtentTreeTest::setUp() {
+    jso = std::make_shared<BlockAlloc::JudySeekOptimizer>(
+            total_blocks, logical_start_block_offset, 128);
+    extents = std::make_shared<AllocatorType::ExtentTree>(
+            jso,
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset);
+
+    // Bitmap allocator driven alongside for comparison
+    bmap_jso = std::make_shared<BlockAlloc::JudySeekOptimizer>(
+            total_blocks, logical_start_block_offset, 128);
+    bmap = std::make_shared<AllocatorType::QwordVector64Cell>(
+            bmap_jso,
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset);
+}
+
+void ExtentTreeTest::tearDown() {
+    extents->destroy();
+    extents.reset();
+    bmap.reset();
+}
+
+void ExtentTreeTest::test_extent_merge_split() {
+
+    uint64_t lb = logical_start_block_offset + 100;
+    uint64_t state = 0;
+
+    // Adjacent allocations in the same state share one extent
+    CPPUNIT_ASSERT(extents->alloc_blocks_contig(1, lb, 10, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->alloc_blocks_contig(1, lb + 10, 10, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 1);
+
+    // State change in the middle splits it in three
+    CPPUNIT_ASSERT(extents->set_blocks_state(lb + 5, 1, 3) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 3);
+    extents->get_block_state(lb + 5, &state);
+    CPPUNIT_ASSERT(state == 3);
+    extents->get_block_state(lb + 6, &state);
+    CPPUNIT_ASSERT(state == 1);
+
+    // And back to the same state merges again
+    CPPUNIT_ASSERT(extents->set_blocks_state(lb + 5, 1, 1) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 1);
+
+    // Clearing the middle leaves two extents
+    CPPUNIT_ASSERT(extents->clear_blocks(lb + 8, 4) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 2);
+    extents->get_block_state(lb + 8, &state);
+    CPPUNIT_ASSERT(state == DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE);
+    extents->get_block_state(lb + 12, &state);
+    CPPUNIT_ASSERT(state == 1);
+
+    // Setting a free block state allocates it
+    CPPUNIT_ASSERT(extents->set_blocks_state(lb + 9, 1, 2) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 3);
+    CPPUNIT_ASSERT(jso->get_allocated_blocks() == 17);
+
+    CPPUNIT_ASSERT(extents->clear_blocks(lb, 8) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->clear_blocks(lb + 9, 1) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->clear_blocks(lb + 12, 8) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(extents->num_extents() == 0);
+    CPPUNIT_ASSERT(jso->get_allocated_blocks() == 0);
+}
+
+void ExtentTreeTest::test_check_state() {
+
+    uint64_t lb = logical_start_block_offset + 200;
+    uint64_t scanned_index = 0;
+    uint64_t bmap_scanned_index = 0;
+    uint64_t allocated = 0;
+
+    // Same operations on both allocators
+    CPPUNIT_ASSERT(extents->alloc_blocks_contig(2, lb, 16, &allocated) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(allocated == lb);
+    CPPUNIT_ASSERT(bmap->alloc_blocks_contig(2, lb, 16, NULL) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    extents->set_blocks_state(lb + 10, 1, 4);
+    bmap->set_blocks_state(lb + 10, 1, 4);
+
+    extents->check_blocks_state(lb, 32, 2, &scanned_index);
+    bmap->check_blocks_state(lb, 32, 2, &bmap_scanned_index);
+    CPPUNIT_ASSERT(scanned_index == lb + 9);
+    CPPUNIT_ASSERT(scanned_index == bmap_scanned_index);
+
+    extents->check_blocks_state(lb - 8, 32,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE, &scanned_index);
+    bmap->check_blocks_state(lb - 8, 32,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE, &bmap_scanned_index);
+    CPPUNIT_ASSERT(scanned_index == lb - 1);
+    CPPUNIT_ASSERT(scanned_index == bmap_scanned_index);
+
+    extents->check_blocks_state(lb + 16, 32,
+            DSS_BLOCK_ALLOCATOR_BLOCK_STATE_FREE, &scanned_index);
+    CPPUNIT_ASSERT(scanned_index == lb + 47);
+
+    // Out of range requests fail
+    CPPUNIT_ASSERT(extents->clear_blocks(
+                logical_start_block_offset + total_blocks, 2) ==
+            BLK_ALLOCATOR_STATUS_ERROR);
+}
+
+void ExtentTreeTest::test_serialize_load() {
+
+    BlockAlloc::JudySeekOptimizerSharedPtr loaded_jso =
+        std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                total_blocks, logical_start_block_offset, 128);
+    AllocatorType::ExtentTree loaded(
+            loaded_jso,
+            nullptr,
+            total_blocks,
+            bits_per_cell,
+            num_block_states,
+            block_alloc_meta_start_offset,
+            logical_start_block_offset);
+    uint64_t num_meta_blocks =
+        extents->get_physical_size() / logical_block_size + 1;
+    uint64_t serialized_len = 0;
+    uint64_t bmap_serialized_len = 0;
+    void *serialized = nullptr;
+    void *bmap_serialized = nullptr;
+    uint64_t lb = 0;
+    uint64_t state = 0;
+    uint64_t loaded_state = 0;
+    uint64_t drive_lba = 0;
+    uint64_t drive_num_blocks = 0;
+    uint64_t bmap_lba = 0;
+    uint64_t bmap_num_blocks = 0;
+
+    // On-disk layout matches the bitmap allocator
+    CPPUNIT_ASSERT(extents->get_physical_size() ==
+            bmap->get_physical_size());
+    CPPUNIT_ASSERT(extents->translate_meta_to_drive_addr(
+                logical_start_block_offset + TEST_CELLS_PER_META_BLK - 10,
+                20, logical_block_size, logical_block_size,
+                drive_lba, drive_num_blocks) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(bmap->translate_meta_to_drive_addr(
+                logical_start_block_offset + TEST_CELLS_PER_META_BLK - 10,
+                20, logical_block_size, logical_block_size,
+                bmap_lba, bmap_num_blocks) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(drive_lba == bmap_lba);
+    CPPUNIT_ASSERT(drive_num_blocks == bmap_num_blocks);
+
+    // Allocations in every state, crossing qwords and meta blocks
+    for (uint64_t i = 0; i < 4; i++) {
+        lb = logical_start_block_offset +
+            i * (TEST_CELLS_PER_META_BLK / 2) + 3 * i + 100;
+        CPPUNIT_ASSERT(extents->alloc_blocks_contig(
+                    i + 1, lb, 37, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+        CPPUNIT_ASSERT(bmap->alloc_blocks_contig(
+                    i + 1, lb, 37, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    }
+    lb = logical_start_block_offset + TEST_CELLS_PER_META_BLK - 50;
+    CPPUNIT_ASSERT(extents->alloc_blocks_contig(
+                2, lb, 100, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(bmap->alloc_blocks_contig(
+                2, lb, 100, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    lb = logical_start_block_offset + total_blocks - 5;
+    CPPUNIT_ASSERT(extents->alloc_blocks_contig(
+                4, lb, 5, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(bmap->alloc_blocks_contig(
+                4, lb, 5, NULL) == BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Serialized meta is the same bitmap, whole and from the middle
+    CPPUNIT_ASSERT(extents->serialize_drive_data(
+                block_alloc_meta_start_offset, num_meta_blocks,
+                logical_block_size, &serialized, serialized_len) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(serialized_len == num_meta_blocks * logical_block_size);
+    bmap_serialized = malloc(serialized_len);
+    memset(bmap_serialized, 0, serialized_len);
+    bmap->serialize_all((char *)bmap_serialized);
+    CPPUNIT_ASSERT(memcmp(serialized, bmap_serialized, serialized_len) == 0);
+    free(bmap_serialized);
+    bmap_serialized = nullptr;
+
+    CPPUNIT_ASSERT(extents->serialize_drive_data(
+                block_alloc_meta_start_offset + 1, 1,
+                logical_block_size, &bmap_serialized, bmap_serialized_len) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(memcmp(bmap_serialized,
+                (uint8_t *)serialized + logical_block_size,
+                logical_block_size) == 0);
+    free(bmap_serialized);
+
+    // Load in two parts, as read from disk
+    CPPUNIT_ASSERT(loaded.load_meta_from_disk_data(
+                (uint8_t *)serialized, logical_block_size, 0) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(loaded.load_meta_from_disk_data(
+                (uint8_t *)serialized + logical_block_size,
+                serialized_len - logical_block_size,
+                logical_block_size) ==
+            BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    for (lb = logical_start_block_offset;
+            lb < logical_start_block_offset + total_blocks; lb++) {
+        extents->get_block_state(lb, &state);
+        CPPUNIT_ASSERT(bmap->get_cell_value(lb) == state);
+        loaded.get_block_state(lb, &loaded_state);
+        CPPUNIT_ASSERT(loaded_state == state);
+    }
+    CPPUNIT_ASSERT(loaded.num_extents() == extents->num_extents());
+    CPPUNIT_ASSERT(loaded_jso->get_allocated_blocks() ==
+            jso->get_allocated_blocks());
+
+    free(serialized);
+}
+
+int main() {
+
+    /**
+     * Main driver for CPPUNIT framework
+     */
+	CppUnit::TextUi::TestRunner runner;
+	runner.addTest(ExtentTreeTest::suite());
+	runner.run();
+	return 0;
+
+}
@@ -61,6 +61,8 @@ public:
     void test_queue_sync_meta_io_tasks();
     void test_get_next_submit_meta_io_tasks();
     void test_complete_meta_sync();
+    void test_group_failure();
+    void test_load_journal();
 
     CPPUNIT_TEST_SUITE(IoTaskOrdererTest);
     CPPUNIT_TEST(test_integrity);
@@ -69,6 +71,8 @@ public:
     CPPUNIT_TEST(test_queue_sync_meta_io_tasks);
     CPPUNIT_TEST(test_get_next_submit_meta_io_tasks);
     CPPUNIT_TEST(test_complete_meta_sync);
+    CPPUNIT_TEST(test_group_failure);
+    CPPUNIT_TEST(test_load_journal);
     CPPUNIT_TEST_SUITE_END();
 private:
     BlockAlloc::IoTaskOrdererSharedPtr io_task_orderer_;
@@ -265,7 +269,7 @@ void IoTaskOrdererTest::test_integrity() {
 
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
-    status = io_task_orderer_->mark_dirty_meta(10, 100);
+    status = io_task_orderer_->mark_dirty_meta(10, 100, 1);
 
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
@@ -396,7 +400,7 @@ void IoTaskOrdererTest::test_queue_sync_meta_io_tasks() {
 
     // Mark few lbas dirty
     // (This will be invoked during alloc and free)
-    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks);
+    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks, 1);
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
     // Queue the IO task for persisting state to disk
@@ -420,7 +424,7 @@ void IoTaskOrdererTest::test_get_next_submit_meta_io_tasks() {
     // Queue some IO task
     // Mark few lbas dirty
     // (This will be invoked during alloc and free)
-    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks);
+    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks, 1);
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
     // Queue the IO task for persisting state to disk
@@ -446,7 +450,7 @@ void IoTaskOrdererTest::test_complete_meta_sync() {
     // Queue first IO task
     // Mark few lbas dirty
     // (This will be invoked during alloc and free)
-    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks);
+    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks, 1);
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
     // Queue the first IO task for persisting state to disk
@@ -454,7 +458,7 @@ void IoTaskOrdererTest::test_complete_meta_sync() {
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
     // Queue the second IO task for persisting state to disk
-    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks);
+    status = io_task_orderer_->mark_dirty_meta(dirty_lb, dirty_num_blks, 1);
     CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
 
     status = io_task_orderer_->queue_sync_meta_io_tasks(io_task1);
@@ -478,6 +482,144 @@ void IoTaskOrdererTest::test_complete_meta_sync() {
 
 }
 
+void IoTaskOrdererTest::test_group_failure() {
+
+    // Stand ins for io tasks, only compared against
+    dss_io_task_t *leader = (dss_io_task_t *)0x1000;
+    dss_io_task_t *follower = (dss_io_task_t *)0x2000;
+    dss_io_task_t *io_task_out = nullptr;
+    std::vector<std::pair<uint64_t, uint64_t>> written;
+    bool fail_tasks = true;
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_ERROR;
+    // NB: populate_io_ranges stub reports these exact values
+    uint64_t dirty_lb = 10;
+    uint64_t dirty_num_blks = 100;
+
+    BlockAlloc::IoTaskOrdererSharedPtr orderer =
+        std::make_shared<BlockAlloc::IoTaskOrderer>(4096, 4096, 3, nullptr);
+
+    // Meta blocks map to the same drive blocks
+    orderer->translate_meta_to_drive_addr =
+        [](uint64_t meta_lba, uint64_t meta_num_blocks,
+                uint64_t drive_smallest_block_size,
+                uint64_t logical_block_size,
+                uint64_t& drive_blk_addr, uint64_t& drive_num_blocks) {
+            drive_blk_addr = meta_lba;
+            drive_num_blocks = meta_num_blocks;
+            return BLK_ALLOCATOR_STATUS_SUCCESS;
+    };
+    orderer->serialize_drive_data =
+        [&](uint64_t drive_blk_addr, uint64_t drive_num_blocks,
+                uint64_t drive_smallest_block_size,
+                void** serialized_drive_data, uint64_t& serialized_len) {
+            written.push_back(std::make_pair(drive_blk_addr, drive_num_blocks));
+            *serialized_drive_data = nullptr;
+            serialized_len = drive_num_blocks * drive_smallest_block_size;
+            return BLK_ALLOCATOR_STATUS_SUCCESS;
+    };
+    // One failed op fails every task of the group
+    orderer->is_io_task_failed = [&](dss_io_task_t *io_task) {
+        return fail_tasks;
+    };
+    orderer->set_group_commit(2, 1000000);
+
+    status = orderer->mark_dirty_meta(dirty_lb, dirty_num_blks, 1);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    status = orderer->queue_sync_meta_io_tasks(leader);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    status = orderer->queue_sync_meta_io_tasks(follower);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Group is sealed, its meta goes out with the leader
+    CPPUNIT_ASSERT(written.size() == 1);
+    CPPUNIT_ASSERT(written[0].first == dirty_lb);
+    CPPUNIT_ASSERT(written[0].second == dirty_num_blks);
+
+    status = orderer->get_next_submit_meta_io_tasks(&io_task_out);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(io_task_out == leader);
+    status = orderer->get_next_submit_meta_io_tasks(&io_task_out);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_ITERATION_END);
+
+    // Failed leader still releases its in flight ranges
+    status = orderer->complete_meta_sync(leader);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    status = orderer->get_next_submit_meta_io_tasks(&io_task_out);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(io_task_out == follower);
+    status = orderer->complete_meta_sync(follower);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(orderer->get_num_pending_meta_io_tasks() == 0);
+
+    // Meta of the failed group is not persisted, the next task writes
+    // it again
+    fail_tasks = false;
+    orderer->set_group_commit(1, 0);
+    status = orderer->queue_sync_meta_io_tasks(leader);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(written.size() == 2);
+    CPPUNIT_ASSERT(written[1].first == dirty_lb);
+    CPPUNIT_ASSERT(written[1].second == dirty_num_blks);
+
+    status = orderer->get_next_submit_meta_io_tasks(&io_task_out);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    CPPUNIT_ASSERT(io_task_out == leader);
+    status = orderer->complete_meta_sync(leader);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+}
+
+void IoTaskOrdererTest::test_load_journal() {
+
+    uint64_t block_size = 4096;
+    uint64_t journal_blocks = 16;
+    std::vector<uint8_t> journal(block_size * journal_blocks, 0);
+    std::vector<BlockAlloc::ba_journal_rec_t> recs;
+    BlockAlloc::ba_journal_rec_t rec;
+    dss_blk_allocator_status_t status = BLK_ALLOCATOR_STATUS_ERROR;
+
+    BlockAlloc::IoTaskOrdererSharedPtr orderer =
+        std::make_shared<BlockAlloc::IoTaskOrderer>(
+                block_size, block_size, 3, nullptr);
+    status = orderer->set_journal(0, journal_blocks, 0);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+    // Too small for a checkpoint every quarter
+    CPPUNIT_ASSERT(orderer->set_journal(0, 4, 0) ==
+            BLK_ALLOCATOR_STATUS_INVALID_BLOCK_RANGE);
+    status = orderer->set_journal(0, journal_blocks, 0);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Block from the previous lap, already in the bitmap
+    rec = {500, 1, 1};
+    BlockAlloc::IoTaskOrderer::format_journal_block(
+            &journal[5 * block_size], block_size, 5, 0, &rec, 1);
+    // Last block before the checkpoint recorded in later blocks
+    rec = {100, 4, 1};
+    BlockAlloc::IoTaskOrderer::format_journal_block(
+            &journal[0 * block_size], block_size, 16, 10, &rec, 1);
+    rec = {101, 2, 2};
+    BlockAlloc::IoTaskOrderer::format_journal_block(
+            &journal[1 * block_size], block_size, 17, 16, &rec, 1);
+    rec = {100, 1, 0};
+    BlockAlloc::IoTaskOrderer::format_journal_block(
+            &journal[3 * block_size], block_size, 19, 16, &rec, 1);
+    // Block 18 is missing, 20 is torn
+    rec = {200, 1, 1};
+    BlockAlloc::IoTaskOrderer::format_journal_block(
+            &journal[4 * block_size], block_size, 20, 16, &rec, 1);
+    journal[4 * block_size + sizeof(BlockAlloc::ba_journal_hdr_t)] ^= 1;
+
+    status = orderer->load_journal(journal.data(), journal.size(), recs);
+    CPPUNIT_ASSERT(status == BLK_ALLOCATOR_STATUS_SUCCESS);
+
+    // Only 17 and 19 are replayed, in the order written
+    CPPUNIT_ASSERT(recs.size() == 2);
+    CPPUNIT_ASSERT(recs[0].lba == 101);
+    CPPUNIT_ASSERT(recs[0].num_blocks == 2);
+    CPPUNIT_ASSERT(recs[0].state == 2);
+    CPPUNIT_ASSERT(recs[1].lba == 100);
+    CPPUNIT_ASSERT(recs[1].state == 0);
+}
+
 int main() {
 
     /**
@@ -36,6 +36,7 @@
 #include <chrono>
 #include <random>
 #include <fstream>
+#include <cstdlib>
 
 /**
  * Cppunit headers
@@ -60,6 +61,9 @@ public:
     void test_alloc_out_of_bounds();
     void test_alloc_duplicate_lb();
     void test_multiple_alloc_free();
+    void test_free_extent_hist();
+    void test_size_class_regions();
+    void test_aging_benchmark();
 
     CPPUNIT_TEST_SUITE(SeekOptimizationTest);
     CPPUNIT_TEST(test_integrity);
@@ -68,6 +72,9 @@ public:
     CPPUNIT_TEST(test_alloc_out_of_bounds);
     CPPUNIT_TEST(test_alloc_duplicate_lb);
     CPPUNIT_TEST(test_multiple_alloc_free);
+    CPPUNIT_TEST(test_free_extent_hist);
+    CPPUNIT_TEST(test_size_class_regions);
+    CPPUNIT_TEST(test_aging_benchmark);
     CPPUNIT_TEST_SUITE_END();
 private:
     BlockAlloc::JudySeekOptimizerSharedPtr jso_;
@@ -264,6 +271,268 @@ void SeekOptimizationTest::test_multiple_alloc_free() {
     jso_->print_map();
 }
 
+void SeekOptimizationTest::test_free_extent_hist() {
+
+    dss_blk_allocator_frag_stats_t stats = {};
+    uint64_t allocated_lb = 0;
+    uint64_t total_extents = 0;
+
+    // Whole range is one free extent of 65536 blocks
+    jso_->get_frag_stats(stats);
+    CPPUNIT_ASSERT(stats.free_blocks == test_total_blocks_);
+    CPPUNIT_ASSERT(stats.free_extents == 1);
+    CPPUNIT_ASSERT(stats.free_extent_hist[16] == 1);
+
+    // Leaves free extents of 1000, 10 and 64516 blocks
+    CPPUNIT_ASSERT(jso_->allocate_lb(1000, 10, allocated_lb));
+    CPPUNIT_ASSERT(jso_->allocate_lb(1020, 10, allocated_lb));
+
+    stats = {};
+    jso_->get_frag_stats(stats);
+    CPPUNIT_ASSERT(stats.free_blocks == test_total_blocks_ - 20);
+    CPPUNIT_ASSERT(stats.free_extents == 3);
+    CPPUNIT_ASSERT(stats.free_extent_hist[3] == 1);
+    CPPUNIT_ASSERT(stats.free_extent_hist[9] == 1);
+    CPPUNIT_ASSERT(stats.free_extent_hist[15] == 1);
+    for (int i = 0; i < BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS; i++) {
+        total_extents += stats.free_extent_hist[i];
+    }
+    CPPUNIT_ASSERT(total_extents == stats.free_extents);
+
+    // Freeing merges back to a single extent
+    CPPUNIT_ASSERT(jso_->free_lb(1000, 10));
+    CPPUNIT_ASSERT(jso_->free_lb(1020, 10));
+    stats = {};
+    jso_->get_frag_stats(stats);
+    CPPUNIT_ASSERT(stats.free_extents == 1);
+    CPPUNIT_ASSERT(stats.free_extent_hist[16] == 1);
+}
+
+void SeekOptimizationTest::test_size_class_regions() {
+
+    dss_blk_allocator_frag_stats_t stats = {};
+    uint64_t region_blocks = 1024;
+    uint64_t allocated_lb = 0;
+    uint64_t small_lb = 0;
+    uint64_t mid_lb = 0;
+
+    CPPUNIT_ASSERT(BlockAlloc::JudySeekOptimizer::get_size_class(1) == 0);
+    CPPUNIT_ASSERT(BlockAlloc::JudySeekOptimizer::get_size_class(4) == 1);
+    CPPUNIT_ASSERT(BlockAlloc::JudySeekOptimizer::get_size_class(5) == 2);
+    CPPUNIT_ASSERT(BlockAlloc::JudySeekOptimizer::get_size_class(64) == 3);
+    CPPUNIT_ASSERT(BlockAlloc::JudySeekOptimizer::get_size_class(65) == 4);
+
+    jso_->set_size_class_regions(region_blocks);
+
+    // A free hint is always honored and claims no region
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 1, allocated_lb));
+    CPPUNIT_ASSERT(allocated_lb == 5000);
+    jso_->get_frag_stats(stats);
+    for (int i = 0; i < BLK_ALLOCATOR_NUM_SIZE_CLASSES; i++) {
+        CPPUNIT_ASSERT(stats.size_class_regions[i] == 0);
+    }
+
+    // Missed hint, the region of the hint is claimed for 5-16 blocks
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 8, mid_lb));
+    CPPUNIT_ASSERT(mid_lb == 4 * region_blocks);
+
+    // Missed hint, the next unclaimed region is claimed for 2-4 blocks
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 2, small_lb));
+    CPPUNIT_ASSERT(small_lb == 5 * region_blocks);
+
+    // Same size class packs into its region
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 12, allocated_lb));
+    CPPUNIT_ASSERT(allocated_lb == mid_lb + 8);
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 3, allocated_lb));
+    CPPUNIT_ASSERT(allocated_lb == small_lb + 2);
+
+    stats = {};
+    jso_->get_frag_stats(stats);
+    CPPUNIT_ASSERT(stats.size_class_regions[1] == 1);
+    CPPUNIT_ASSERT(stats.size_class_regions[2] == 1);
+
+    // Large allocations can span unclaimed regions
+    CPPUNIT_ASSERT(jso_->allocate_lb(5000, 3000, allocated_lb));
+    CPPUNIT_ASSERT(allocated_lb == 6 * region_blocks);
+    stats = {};
+    jso_->get_frag_stats(stats);
+    CPPUNIT_ASSERT(stats.size_class_regions[4] == 3);
+
+    // Regions are released once fully free
+    CPPUNIT_ASSERT(jso_->free_lb(allocated_lb, 3000));
+    CPPUNIT_ASSERT(jso_->free_lb(mid_lb, 20));
+    CPPUNIT_ASSERT(jso_->free_lb(small_lb, 5));
+    CPPUNIT_ASSERT(jso_->free_lb(5000, 1));
+    stats = {};
+    jso_->get_frag_stats(stats);
+    for (int i = 0; i < BLK_ALLOCATOR_NUM_SIZE_CLASSES; i++) {
+        CPPUNIT_ASSERT(stats.size_class_regions[i] == 0);
+    }
+    CPPUNIT_ASSERT(stats.free_extents == 1);
+    CPPUNIT_ASSERT(jso_->get_free_blocks() == jso_->get_total_blocks());
+}
+
+/**
+ * Ages a seek optimizer with a kvtrans like workload: a 1 block meta
+ * at a hashed lb followed by its value right after it, mixed value sizes
+ * and random deletes. With meta_table_blocks, meta blocks are hashed into
+ * a table reserved at the start of the device so that only values age
+ * the rest of it, each value still hinted at a hashed lb past the table.
+ * Returns the number of large value allocations that could not be placed
+ * contiguously, out of large_attempts.
+ */
+static uint64_t age_seek_optimizer(
+        BlockAlloc::JudySeekOptimizerSharedPtr jso,
+        uint64_t total_blocks, uint64_t meta_table_blocks, uint64_t rounds,
+        uint64_t& large_attempts,
+        dss_blk_allocator_frag_stats_t& stats) {
+
+    // Value sizes in blocks and their weights
+    const uint64_t value_blocks[] = {1, 3, 12, 40, 256};
+    std::discrete_distribution<> value_distr({40, 25, 20, 10, 5});
+    std::mt19937_64 gen(0x5eed);
+    std::uniform_int_distribution<uint64_t> lb_distr(0, total_blocks - 1);
+    std::uniform_int_distribution<uint64_t> table_distr(0,
+            meta_table_blocks ? meta_table_blocks - 1 : 0);
+    // Live objects as meta lb, value lb and value len
+    std::vector<std::pair<uint64_t, std::pair<uint64_t, uint64_t>>> objs;
+    uint64_t hint_lb = 0;
+    // Keep the value space around 70% full
+    uint64_t fill_blocks = meta_table_blocks +
+        ((total_blocks - meta_table_blocks) * 7) / 10;
+    uint64_t large_failures = 0;
+    uint64_t misses = 0;
+    uint64_t meta_lb = 0;
+    uint64_t value_lb = 0;
+    uint64_t len = 0;
+    uint64_t victim = 0;
+
+    if (meta_table_blocks) {
+        CPPUNIT_ASSERT(jso->allocate_lb(0, meta_table_blocks, meta_lb));
+        CPPUNIT_ASSERT(meta_lb == 0);
+    }
+
+    for (uint64_t r = 0; r < rounds; r++) {
+        misses = 0;
+        while (jso->get_allocated_blocks() < fill_blocks && misses < 64) {
+            len = value_blocks[value_distr(gen)];
+            if (meta_table_blocks) {
+                meta_lb = table_distr(gen);
+                hint_lb = meta_table_blocks +
+                    lb_distr(gen) % (total_blocks - meta_table_blocks);
+            } else if (!jso->allocate_lb(lb_distr(gen), 1, meta_lb)) {
+                misses++;
+                continue;
+            } else {
+                hint_lb = meta_lb + 1;
+            }
+            if (len >= 65) {
+                large_attempts++;
+            }
+            if (!jso->allocate_lb(hint_lb, len, value_lb)) {
+                if (len >= 65) {
+                    large_failures++;
+                }
+                if (!meta_table_blocks) {
+                    CPPUNIT_ASSERT(jso->free_lb(meta_lb, 1));
+                }
+                misses++;
+                continue;
+            }
+            objs.push_back(std::make_pair(meta_lb,
+                        std::make_pair(value_lb, len)));
+        }
+
+        // Delete a tenth of the objects
+        for (uint64_t i = 0; i < objs.size() / 10 + 1 && !objs.empty(); i++) {
+            victim = gen() % objs.size();
+            if (!meta_table_blocks) {
+                CPPUNIT_ASSERT(jso->free_lb(objs[victim].first, 1));
+            }
+            CPPUNIT_ASSERT(jso->free_lb(objs[victim].second.first,
+                        objs[victim].second.second));
+            objs[victim] = objs.back();
+            objs.pop_back();
+        }
+    }
+
+    jso->get_frag_stats(stats);
+
+    for (auto& o : objs) {
+        if (!meta_table_blocks) {
+            CPPUNIT_ASSERT(jso->free_lb(o.first, 1));
+        }
+        CPPUNIT_ASSERT(jso->free_lb(o.second.first, o.second.second));
+    }
+    if (meta_table_blocks) {
+        CPPUNIT_ASSERT(jso->free_lb(0, meta_table_blocks));
+    }
+    CPPUNIT_ASSERT(jso->get_allocated_blocks() == 0);
+
+    return large_failures;
+}
+
+void SeekOptimizationTest::test_aging_benchmark() {
+
+    // Rounds can be raised to age for longer
+    // e.g. DSS_BA_AGING_ROUNDS=100000 ./test_seek_optimization_impl
+    uint64_t rounds = 20;
+    uint64_t total_blocks = 1 << 18;
+    // Meta blocks hashed over the whole device, then into a reserved
+    // table of a quarter of it
+    uint64_t meta_table_blocks[2] = {0, total_blocks / 4};
+    uint64_t failures[2][2] = {};
+    uint64_t attempts[2][2] = {};
+    dss_blk_allocator_frag_stats_t stats[2][2] = {};
+    const char *env_rounds = std::getenv("DSS_BA_AGING_ROUNDS");
+
+    if (env_rounds != NULL) {
+        rounds = std::strtoull(env_rounds, NULL, 10);
+    }
+
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < 2; i++) {
+            BlockAlloc::JudySeekOptimizerSharedPtr jso =
+                std::make_shared<BlockAlloc::JudySeekOptimizer>(
+                        total_blocks, 0, test_optimal_block_size_);
+            if (i == 1) {
+                jso->set_size_class_regions(4096);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            failures[t][i] = age_seek_optimizer(jso, total_blocks,
+                    meta_table_blocks[t], rounds, attempts[t][i], stats[t][i]);
+            auto end = std::chrono::steady_clock::now();
+
+            std::cout<<(t == 0 ? "Hashed meta, " : "Meta table, ")
+                <<(i == 0 ? "hint only" : "size classes")
+                <<": rounds = "<<rounds
+                <<", large alloc failures = "<<failures[t][i]
+                <<"/"<<attempts[t][i]
+                <<", free extents = "<<stats[t][i].free_extents
+                <<", time ms = "<<std::chrono::duration_cast<
+                    std::chrono::milliseconds>(end - start).count()
+                <<std::endl;
+            std::cout<<"Free extent histogram:";
+            for (int b = 0; b < BLK_ALLOCATOR_FREE_EXTENT_HIST_BUCKETS; b++) {
+                if (stats[t][i].free_extent_hist[b]) {
+                    std::cout<<" [2^"<<b<<"]="<<stats[t][i].free_extent_hist[b];
+                }
+            }
+            std::cout<<std::endl;
+        }
+
+        // Segregating sizes must not fragment free space more
+        CPPUNIT_ASSERT(stats[t][1].free_extents <= stats[t][0].free_extents);
+        CPPUNIT_ASSERT(failures[t][1] <= failures[t][0]);
+    }
+
+    // Hashed meta blocks land on freed large runs whatever the value
+    // policy, with values alone small ones must stop splitting them:
+    // the large failure rate has to drop by at least a quarter
+    CPPUNIT_ASSERT(failures[1][1] * attempts[1][0] * 4 <
+            failures[1][0] * attempts[1][1] * 3);
+}
 
 int main() {
 
@@ -0,0 +1,397 @@
+/**
+ * The Clear BSD License
+ * 
+ * Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ * 
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ * 
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ * BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ * BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ * USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CUnit/Basic.h"
+#include <sys/queue.h>
+#include <string.h>
+#include <errno.h>
+
+#include "dss_io_task.h"
+
+#include "spdk/nvme_spec.h"
+
+#define DSS_IO_BDEV_UT_MAX_TASKS (16)
+#define DSS_IO_BDEV_UT_MAX_IO_OPS (64)
+#define DSS_IO_BDEV_UT_BLK_SZ (4096)
+#define DSS_IO_BDEV_UT_NUM_TASKS (2)
+#define DSS_IO_BDEV_UT_OPS_PER_TASK (2)
+
+#define DSS_IO_BDEV_UT_CB_INST ((dss_module_instance_t *)0x7023456)
+
+//Stand ins for spdk objects, only compared against
+#define DSS_IO_BDEV_UT_BDEV ((void *)0xB0EF)
+#define DSS_IO_BDEV_UT_DESC ((void *)0xDE5C)
+#define DSS_IO_BDEV_UT_CH ((void *)0xC4A2)
+#define DSS_IO_BDEV_UT_THREAD ((void *)0x7E7D)
+#define DSS_IO_BDEV_UT_BDEV_IO ((void *)0xB10)
+
+typedef void (*ut_bdev_io_cb)(void *bdev_io, bool success, void *cb_arg);
+
+dss_io_task_module_t *g_io_task_module;
+dss_device_t *g_device;
+
+//Submit stub state
+int g_submit_rc;//Returned by every bdev submit
+int g_num_submits;
+int g_last_iovcnt;
+uint64_t g_last_lba;
+uint64_t g_last_nblocks;
+ut_bdev_io_cb g_last_cb;
+void *g_last_cb_arg;
+
+//Completion posts to the owner module
+int g_num_posts;
+void *g_posted_ctx[DSS_IO_BDEV_UT_NUM_TASKS];
+
+uint8_t g_data_buf[DSS_IO_BDEV_UT_NUM_TASKS * DSS_IO_BDEV_UT_OPS_PER_TASK][DSS_IO_BDEV_UT_BLK_SZ];
+
+//SPDK and module stubs, dss_io_bdev.c is linked without the spdk libraries
+void *spdk_bdev_get_by_name(const char *name) { return DSS_IO_BDEV_UT_BDEV; }
+int spdk_bdev_open_ext(const char *name, bool write, void *event_cb, void *event_ctx, void **desc)
+{
+    *desc = DSS_IO_BDEV_UT_DESC;
+    return 0;
+}
+int spdk_bdev_module_claim_bdev(void *bdev, void *desc, void *module) { return 0; }
+void spdk_bdev_module_release_bdev(void *bdev) { }
+void spdk_bdev_close(void *desc) { }
+uint32_t spdk_bdev_get_block_size(const void *bdev) { return DSS_IO_BDEV_UT_BLK_SZ; }
+uint64_t spdk_bdev_get_num_blocks(const void *bdev) { return 1024 * 1024; }
+void *spdk_bdev_get_io_channel(void *desc) { return DSS_IO_BDEV_UT_CH; }
+void spdk_put_io_channel(void *ch) { }
+void spdk_bdev_free_io(void *bdev_io) { CU_ASSERT(bdev_io == DSS_IO_BDEV_UT_BDEV_IO); }
+void spdk_bdev_io_get_nvme_status(const void *bdev_io, uint32_t *cdw0, int *sct, int *sc)
+{
+    CU_ASSERT(bdev_io == DSS_IO_BDEV_UT_BDEV_IO);
+    *cdw0 = 0;
+    *sct = SPDK_NVME_SCT_MEDIA_ERROR;
+    *sc = SPDK_NVME_SC_WRITE_FAULTS;
+}
+int spdk_bdev_queue_io_wait(void *bdev, void *ch, void *entry) { return 0; }
+int spdk_nvmf_subsystem_resume(void *subsystem, void *cb_fn, void *cb_arg) { return 0; }
+void spdk_trace_add_register_fn(void *reg) { }
+void spdk_trace_register_object(uint8_t type, char id_prefix) { }
+void spdk_trace_register_description(const char *name, uint16_t tpoint_id, uint8_t owner_type,
+                                     uint8_t object_type, uint8_t new_object, uint8_t arg1_type,
+                                     const char *arg1_name) { }
+
+static int _ut_bdev_submit(uint64_t lba, uint64_t nblocks, int iovcnt, ut_bdev_io_cb cb, void *cb_arg)
+{
+    g_num_submits++;
+    g_last_lba = lba;
+    g_last_nblocks = nblocks;
+    g_last_iovcnt = iovcnt;
+    g_last_cb = cb;
+    g_last_cb_arg = cb_arg;
+    return g_submit_rc;
+}
+
+int spdk_bdev_read_blocks(void *desc, void *ch, void *buf, uint64_t lba, uint64_t nblocks, ut_bdev_io_cb cb, void *cb_arg)
+{
+    return _ut_bdev_submit(lba, nblocks, 1, cb, cb_arg);
+}
+
+int spdk_bdev_write_blocks(void *desc, void *ch, void *buf, uint64_t lba, uint64_t nblocks, ut_bdev_io_cb cb, void *cb_arg)
+{
+    return _ut_bdev_submit(lba, nblocks, 1, cb, cb_arg);
+}
+
+int spdk_bdev_readv_blocks(void *desc, void *ch, struct iovec *iov, int iovcnt, uint64_t lba, uint64_t nblocks, ut_bdev_io_cb cb, void *cb_arg)
+{
+    return _ut_bdev_submit(lba, nblocks, iovcnt, cb, cb_arg);
+}
+
+int spdk_bdev_writev_blocks(void *desc, void *ch, struct iovec *iov, int iovcnt, uint64_t lba, uint64_t nblocks, ut_bdev_io_cb cb, void *cb_arg)
+{
+    return _ut_bdev_submit(lba, nblocks, iovcnt, cb, cb_arg);
+}
+
+uint32_t dss_env_get_current_core(void) { return 0; }
+uint32_t dss_env_get_spdk_max_cores(void) { return 1; }
+void *dss_env_get_spdk_thread(void) { return DSS_IO_BDEV_UT_THREAD; }
+int dss_spdk_thread_send_msg(void *th, void *fn, void *ctx) { return 0; }
+void dss_trace_record(uint16_t tpoint_id, uint16_t poller_id, uint32_t size,
+                      uint64_t object_id, uint64_t arg1) { }
+void dfly_module_post_request(void *module, void *req) { CU_ASSERT(0); }
+
+dss_module_status_t dss_module_post_to_instance(dss_module_type_t mtype, dss_module_instance_t *module_thread_instance, void *req)
+{
+    CU_ASSERT(module_thread_instance == DSS_IO_BDEV_UT_CB_INST);
+    CU_ASSERT(g_num_posts < DSS_IO_BDEV_UT_NUM_TASKS);
+    if(g_num_posts < DSS_IO_BDEV_UT_NUM_TASKS) {
+        g_posted_ctx[g_num_posts] = req;
+    }
+    g_num_posts++;
+    return DSS_MODULE_STATUS_SUCCESS;
+}
+
+dss_module_status_t dss_module_post_to_instance_cq(dss_module_type_t mtype, dss_module_instance_t *module_thread_instance, void *req)
+{
+    return dss_module_post_to_instance(mtype, module_thread_instance, req);
+}
+
+int dss_io_bdev_ut_init(void)
+{
+    dss_io_task_module_opts_t opts;
+    dss_io_task_module_status_t rc;
+    dss_io_dev_status_t dev_rc;
+
+    opts.max_io_tasks = DSS_IO_BDEV_UT_MAX_TASKS;
+    opts.max_io_ops = DSS_IO_BDEV_UT_MAX_IO_OPS;
+
+    g_io_task_module = NULL;
+    rc = dss_io_task_module_init(opts, &g_io_task_module);
+    assert(rc == DSS_IO_TASK_MODULE_STATUS_SUCCESS);
+
+    g_device = NULL;
+    dev_rc = dss_io_device_open("ut_dev", DSS_BLOCK_DEVICE, &g_device);
+    assert(dev_rc == DSS_IO_DEV_STATUS_SUCCESS);
+    assert(g_device != NULL);
+
+    return 0;
+}
+
+int dss_io_bdev_ut_cleanup(void)
+{
+    dss_io_dev_status_t dev_rc;
+    dss_io_task_module_status_t rc;
+
+    dev_rc = dss_io_device_close(g_device);
+    assert(dev_rc == DSS_IO_DEV_STATUS_SUCCESS);
+
+    rc = dss_io_task_module_end(g_io_task_module);
+    assert(rc == DSS_IO_TASK_MODULE_STATUS_SUCCESS);
+
+    return 0;
+}
+
+/**
+ * @brief Queue DSS_IO_BDEV_UT_OPS_PER_TASK single block writes per task with
+ *        LBAs adjacent across tasks and submit all under one plug, so the
+ *        ops of every task are staged as a single mergeable run
+ */
+static void _ut_submit_adjacent_writes(dss_io_task_t **tasks)
+{
+    dss_io_task_status_t rc;
+    uint64_t lba = 0;
+    int i, j;
+
+    g_num_submits = 0;
+    g_num_posts = 0;
+    memset(g_posted_ctx, 0, sizeof(g_posted_ctx));
+
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        tasks[i] = NULL;
+        rc = dss_io_task_get_new(g_io_task_module, &tasks[i]);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+        rc = dss_io_task_setup(tasks[i], NULL, DSS_IO_BDEV_UT_CB_INST, (void *)tasks[i], false);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+        for(j = 0; j < DSS_IO_BDEV_UT_OPS_PER_TASK; j++) {
+            rc = dss_io_task_add_blk_write(tasks[i], g_device, lba, 1, g_data_buf[lba], NULL);
+            CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+            lba++;
+        }
+    }
+
+    dss_io_task_plug();
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        dss_io_task_submit_to_device(tasks[i]);
+    }
+    CU_ASSERT(g_num_submits == 0);
+    dss_io_task_unplug();
+}
+
+static void _ut_check_posted(dss_io_task_t **tasks)
+{
+    int i, j;
+    bool found;
+
+    CU_ASSERT(g_num_posts == DSS_IO_BDEV_UT_NUM_TASKS);
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        found = false;
+        for(j = 0; j < DSS_IO_BDEV_UT_NUM_TASKS; j++) {
+            if(g_posted_ctx[j] == (void *)tasks[i]) {
+                found = true;
+            }
+        }
+        CU_ASSERT(found == true);
+        CU_ASSERT(tasks[i]->num_outstanding_ops == 0);
+        CU_ASSERT(tasks[i]->num_ops_done == DSS_IO_BDEV_UT_OPS_PER_TASK);
+        CU_ASSERT(tasks[i]->in_progress == false);
+        CU_ASSERT(TAILQ_EMPTY(&tasks[i]->ops_in_progress));
+    }
+}
+
+static void _ut_put_tasks(dss_io_task_t **tasks)
+{
+    dss_io_task_status_t rc;
+    int i;
+
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        rc = dss_io_task_put(tasks[i]);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+}
+
+void testMergedSubmitSuccess(void)
+{
+    dss_io_task_t *tasks[DSS_IO_BDEV_UT_NUM_TASKS];
+    int i;
+
+    g_submit_rc = 0;
+    _ut_submit_adjacent_writes(tasks);
+
+    //All ops of all tasks go out as one bdev io
+    CU_ASSERT(g_num_submits == 1);
+    CU_ASSERT(g_last_lba == 0);
+    CU_ASSERT(g_last_nblocks == DSS_IO_BDEV_UT_NUM_TASKS * DSS_IO_BDEV_UT_OPS_PER_TASK);
+    CU_ASSERT(g_last_iovcnt == DSS_IO_BDEV_UT_NUM_TASKS * DSS_IO_BDEV_UT_OPS_PER_TASK);
+    CU_ASSERT(g_num_posts == 0);
+
+    g_last_cb(DSS_IO_BDEV_UT_BDEV_IO, true, g_last_cb_arg);
+
+    _ut_check_posted(tasks);
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        CU_ASSERT(tasks[i]->task_status == DSS_IO_TASK_STATUS_SUCCESS);
+        CU_ASSERT(TAILQ_EMPTY(&tasks[i]->failed_ops));
+    }
+
+    _ut_put_tasks(tasks);
+}
+
+void testMergedSubmitFailure(void)
+{
+    dss_io_task_t *tasks[DSS_IO_BDEV_UT_NUM_TASKS];
+    dss_io_op_t *op;
+    int i, nfailed;
+
+    //A hard submit error on the merged io must fail every op in the run
+    g_submit_rc = -EIO;
+    _ut_submit_adjacent_writes(tasks);
+
+    CU_ASSERT(g_num_submits == 1);
+    CU_ASSERT(g_last_iovcnt == DSS_IO_BDEV_UT_NUM_TASKS * DSS_IO_BDEV_UT_OPS_PER_TASK);
+
+    _ut_check_posted(tasks);
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        CU_ASSERT(dss_io_task_get_status(tasks[i]) == DSS_IO_TASK_STATUS_ERROR);
+        nfailed = 0;
+        TAILQ_FOREACH(op, &tasks[i]->failed_ops, op_next) {
+            CU_ASSERT(op->merge_next == NULL);
+            CU_ASSERT(op->merge_iov == NULL);
+            CU_ASSERT(op->status.nvme_rsp.sct == SPDK_NVME_SCT_GENERIC);
+            CU_ASSERT(op->status.nvme_rsp.sc == SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+            nfailed++;
+        }
+        CU_ASSERT(nfailed == DSS_IO_BDEV_UT_OPS_PER_TASK);
+    }
+
+    _ut_put_tasks(tasks);
+    g_submit_rc = 0;
+}
+
+void testFailedSubmitReset(void)
+{
+    dss_io_task_t *tasks[DSS_IO_BDEV_UT_NUM_TASKS];
+    dss_io_task_status_t rc;
+    int i;
+
+    //Failed ops are released by reset so the task can be reused
+    g_submit_rc = -EIO;
+    _ut_submit_adjacent_writes(tasks);
+    _ut_check_posted(tasks);
+    g_submit_rc = 0;
+
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        CU_ASSERT(dss_io_task_get_status(tasks[i]) == DSS_IO_TASK_STATUS_ERROR);
+        CU_ASSERT(!TAILQ_EMPTY(&tasks[i]->failed_ops));
+
+        rc = dss_io_task_reset_ops(tasks[i]);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+        CU_ASSERT(TAILQ_EMPTY(&tasks[i]->failed_ops));
+        CU_ASSERT(TAILQ_EMPTY(&tasks[i]->op_done));
+        CU_ASSERT(tasks[i]->num_total_ops == 0);
+        CU_ASSERT(tasks[i]->num_ops_done == 0);
+        CU_ASSERT(dss_io_task_get_status(tasks[i]) == DSS_IO_TASK_STATUS_SUCCESS);
+
+        //Reset task submits again with fresh ops
+        rc = dss_io_task_add_blk_write(tasks[i], g_device, i, 1, g_data_buf[i], NULL);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    }
+
+    g_num_submits = 0;
+    g_num_posts = 0;
+    for(i = 0; i < DSS_IO_BDEV_UT_NUM_TASKS; i++) {
+        dss_io_task_submit_to_device(tasks[i]);
+        CU_ASSERT(g_num_submits == i + 1);
+        g_last_cb(DSS_IO_BDEV_UT_BDEV_IO, true, g_last_cb_arg);
+        CU_ASSERT(g_num_posts == i + 1);
+        CU_ASSERT(dss_io_task_get_status(tasks[i]) == DSS_IO_TASK_STATUS_SUCCESS);
+        CU_ASSERT(TAILQ_EMPTY(&tasks[i]->failed_ops));
+    }
+
+    _ut_put_tasks(tasks);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    if (CUE_SUCCESS != CU_initialize_registry())
+    {
+        return CU_get_error();
+    }
+
+    pSuite = CU_add_suite("DSS IO bdev submission", dss_io_bdev_ut_init, dss_io_bdev_ut_cleanup);
+    if (NULL == pSuite)
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if (
+        NULL == CU_add_test(pSuite, "testMergedSubmitSuccess", testMergedSubmitSuccess) ||
+        NULL == CU_add_test(pSuite, "testMergedSubmitFailure", testMergedSubmitFailure) ||
+        NULL == CU_add_test(pSuite, "testFailedSubmitReset", testFailedSubmitReset) ||
+        NULL == CU_add_test(pSuite, "testMergedSubmitSuccessAfterFailure", testMergedSubmitSuccess))
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+
+    return CU_get_error();
+}
@@ -33,6 +33,7 @@
 
 #include "CUnit/Basic.h"
 #include <sys/queue.h>
+#include <string.h>
 
 #include "dss_io_task.h"
 
@@ -50,6 +51,9 @@ dss_io_task_t *g_io_task;
 #define DSS_IO_TASK_UT_TEST_CB_INST ((dss_module_instance_t *)0x7023456)
 #define DSS_IO_TASK_UT_TEST_CB_CTX  ((void *)0x7024567)
 
+#define DSS_IO_TASK_UT_TEST_IOV_BUF_SZ (4096)
+uint8_t g_iov_buf[DSS_IO_MAX_IOV_ENTRIES + 1][DSS_IO_TASK_UT_TEST_IOV_BUF_SZ * 2];
+
 int dss_io_task_ut_init(void)
 {
     dss_io_task_module_opts_t opts;
@@ -210,6 +214,176 @@ void testIOTaskWriteOP(void)
     return;
 }
 
+void testIoTaskIov(void)
+{
+    dss_io_task_status_t rc;
+    dss_iov_t *iov;
+    int i;
+
+    iov = dss_io_iov_get(g_io_task_module);
+    CU_ASSERT(iov != NULL);
+    CU_ASSERT(iov->iovcnt == 0);
+    CU_ASSERT(iov->len == 0);
+
+    rc = dss_io_iov_add(iov, g_iov_buf[0], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, 0);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    CU_ASSERT(iov->iovcnt == 1);
+
+    //Region following the previous one in memory extends it
+    rc = dss_io_iov_add(iov, g_iov_buf[0], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, DSS_IO_TASK_UT_TEST_IOV_BUF_SZ);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    CU_ASSERT(iov->iovcnt == 1);
+    CU_ASSERT(iov->iovs[0].iov_base == g_iov_buf[0]);
+    CU_ASSERT(iov->iovs[0].iov_len == 2 * DSS_IO_TASK_UT_TEST_IOV_BUF_SZ);
+    CU_ASSERT(iov->len == 2 * DSS_IO_TASK_UT_TEST_IOV_BUF_SZ);
+
+    for(i = 1; i < DSS_IO_MAX_IOV_ENTRIES; i++) {
+        rc = dss_io_iov_add(iov, g_iov_buf[i], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, 1);
+        CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+        CU_ASSERT(iov->iovs[i].iov_base == &g_iov_buf[i][1]);
+    }
+    CU_ASSERT(iov->iovcnt == DSS_IO_MAX_IOV_ENTRIES);
+
+    rc = dss_io_iov_add(iov, g_iov_buf[DSS_IO_MAX_IOV_ENTRIES], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, 1);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_ERROR);
+    CU_ASSERT(iov->iovcnt == DSS_IO_MAX_IOV_ENTRIES);
+    CU_ASSERT(iov->len == (DSS_IO_MAX_IOV_ENTRIES + 1) * DSS_IO_TASK_UT_TEST_IOV_BUF_SZ);
+
+    dss_io_iov_clear(iov);
+    CU_ASSERT(iov->iovcnt == 0);
+    CU_ASSERT(iov->len == 0);
+
+    rc = dss_io_iov_free(g_io_task_module, iov);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    return;
+}
+
+void testIOTaskWritevOp(void)
+{
+    dss_io_task_status_t rc;
+    dss_io_op_t *op;
+    dss_iov_t *iov;
+
+    iov = dss_io_iov_get(g_io_task_module);
+    CU_ASSERT(iov != NULL);
+
+    rc = dss_io_iov_add(iov, g_iov_buf[0], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, 0);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    rc = dss_io_iov_add(iov, g_iov_buf[1], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ * 2, 0);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    CU_ASSERT(iov->iovcnt == 2);
+
+    rc = dss_io_task_add_blk_writev(g_io_task, DSS_IO_TASK_UT_TEST_DEV, \
+                                               DSS_IO_TASK_UT_TEST_LBA, \
+                                               3, \
+                                               iov, \
+                                               NULL);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    CU_ASSERT(g_io_task->num_total_ops == 1);
+    op = TAILQ_FIRST(&g_io_task->op_todo_list);
+    CU_ASSERT(op->opc == DSS_IO_BLK_WRITEV);
+    CU_ASSERT(op->device == DSS_IO_TASK_UT_TEST_DEV);
+    CU_ASSERT(op->rw_v.iov == iov);
+    CU_ASSERT(op->rw_v.is_write == true);
+    CU_ASSERT(op->rw_v.lba == DSS_IO_TASK_UT_TEST_LBA);
+    CU_ASSERT(op->rw_v.nblocks == 3);
+    CU_ASSERT(op->blk_rw.lba == DSS_IO_TASK_UT_TEST_LBA);
+    CU_ASSERT(op->blk_rw.nblocks == 3);
+
+    g_io_task->num_ops_done++;
+    TAILQ_REMOVE(&g_io_task->op_todo_list, op, op_next);
+    TAILQ_INSERT_HEAD(&g_io_task->op_done, op, op_next);
+
+    //iov is returned to the pool with the op
+    rc = dss_io_task_reset_ops(g_io_task);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+    CU_ASSERT(g_io_task->num_total_ops == 0);
+
+    return;
+}
+
+void testIOTaskReadvOp(void)
+{
+    dss_io_task_status_t rc;
+    dss_io_op_t *op;
+    dss_iov_t *iov;
+
+    iov = dss_io_iov_get(g_io_task_module);
+    CU_ASSERT(iov != NULL);
+
+    rc = dss_io_iov_add(iov, g_iov_buf[0], DSS_IO_TASK_UT_TEST_IOV_BUF_SZ, 0);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    rc = dss_io_task_add_blk_readv(g_io_task, DSS_IO_TASK_UT_TEST_DEV, \
+                                              DSS_IO_TASK_UT_TEST_LBA, \
+                                              1, \
+                                              iov, \
+                                              NULL);
+    CU_ASSERT(rc == DSS_IO_TASK_STATUS_SUCCESS);
+
+    op = TAILQ_FIRST(&g_io_task->op_todo_list);
+    CU_ASSERT(op->opc == DSS_IO_BLK_READV);
+    CU_ASSERT(op->rw_v.iov == iov);
+    CU_ASSERT(op->rw_v.is_write == false);
+
+    g_io_task->num_ops_done++;
+    TAILQ_REMOVE(&g_io_task->op_todo_list, op, op_next);
+    TAILQ_INSERT_HEAD(&g_io_task->op_done, op, op_next);
+
+    return;
+}
+
+void testIOTaskOpCanMerge(void)
+{
+    dss_io_op_t prev, next;
+
+    memset(&prev, 0, sizeof(prev));
+    memset(&next, 0, sizeof(next));
+
+    prev.opc = DSS_IO_BLK_WRITE;
+    prev.device = DSS_IO_TASK_UT_TEST_DEV;
+    prev.blk_rw.lba = DSS_IO_TASK_UT_TEST_LBA;
+    prev.blk_rw.nblocks = 2;
+    prev.blk_rw.data = DSS_IO_TASK_UT_TEST_DATAP;
+    next = prev;
+    next.blk_rw.lba = DSS_IO_TASK_UT_TEST_LBA + 2;
+
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == true);
+    //Not adjacent or out of order
+    CU_ASSERT(dss_io_op_can_merge(&next, &prev) == false);
+    next.blk_rw.lba++;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == false);
+    next.blk_rw.lba--;
+
+    //Vector and flat ops in the same direction merge
+    next.opc = DSS_IO_BLK_WRITEV;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == true);
+
+    //Direction mismatch
+    next.opc = DSS_IO_BLK_READ;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == false);
+    prev.opc = DSS_IO_BLK_READV;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == true);
+
+    //Blocking ops are submitted alone
+    next.is_blocking = true;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == false);
+    next.is_blocking = false;
+
+    //Different device
+    next.device = (dss_device_t *)((uintptr_t)DSS_IO_TASK_UT_TEST_DEV + 1);
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == false);
+    next.device = DSS_IO_TASK_UT_TEST_DEV;
+
+    //No data buffer
+    next.blk_rw.data = NULL;
+    CU_ASSERT(dss_io_op_can_merge(&prev, &next) == false);
+
+    return;
+}
+
 int main()
 {
     CU_pSuite pSuite = NULL;
@@ -235,7 +409,13 @@ int main()
         NULL == CU_add_test(pSuite, "testIoTaskPut1", testIoTaskPut) ||
         NULL == CU_add_test(pSuite, "testIoTaskGetNewCacheAlloc", testIoTaskGetNew) ||
         NULL == CU_add_test(pSuite, "testIOTaskWriteOP", testIOTaskWriteOP) ||
-        NULL == CU_add_test(pSuite, "testIoTaskPut2", testIoTaskPut))
+        NULL == CU_add_test(pSuite, "testIoTaskPut2", testIoTaskPut) ||
+        NULL == CU_add_test(pSuite, "testIoTaskIov", testIoTaskIov) ||
+        NULL == CU_add_test(pSuite, "testIoTaskGetNewVectorOps", testIoTaskGetNew) ||
+        NULL == CU_add_test(pSuite, "testIOTaskWritevOp", testIOTaskWritevOp) ||
+        NULL == CU_add_test(pSuite, "testIOTaskReadvOp", testIOTaskReadvOp) ||
+        NULL == CU_add_test(pSuite, "testIOTaskOpCanMerge", testIOTaskOpCanMerge) ||
+        NULL == CU_add_test(pSuite, "testIoTaskPut3", testIoTaskPut))
     {
         CU_cleanup_registry();
         return CU_get_error();
@@ -35,6 +35,8 @@
 #include <math.h>
 #include "CUnit/Basic.h"
 #include "kvtrans.h"
+#include "kvtrans_boot.h"
+#include "kvtrans_snapshot.h"
 #include "keygen.h"
 
 #define KEY_LEN 1024
@@ -140,7 +142,16 @@ void init_params(kvtrans_params_t *params) {
     params->iotm = DEFAULT_IOTM;
     params->blk_offset = 1;
     params->logi_blk_size = 4096;
-    params->state_num = 10;
+    params->state_num = DEFAULT_BLOCK_STATE_NUM;
+    params->batch_size = 64;
+    params->meta_cache_blks = 0;
+    params->key_filter_keys = 0;
+    params->placement = KVTRANS_PLACEMENT_CHAIN;
+    params->cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+    params->cuckoo_table_blks = 0;
+    params->packed_meta = false;
+    params->snapshot_start_blk = 0;
+    params->snapshot_num_blks = 0;
 }
 
 void init_test_ctx() {
@@ -408,6 +419,660 @@ void testFullDelete(void)
     reset_key_generator(g_kvtrans_ut.kg);
 }
 
+void testHashBatch(void)
+{
+    kvtrans_params_t params;
+    hash_fn_ctx_t *hash_fn_ctx;
+    const char *keys[KEY_BATCH];
+    uint32_t klens[KEY_BATCH];
+    uint64_t hashcodes[KEY_BATCH];
+    int hash_type;
+    int i;
+
+    g_kvtrans_ut.kg->run(g_kvtrans_ut.kg, KEY_LEN);
+    for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+        keys[i] = g_kvtrans_ut.kg->obj_key_list[i].key;
+        klens[i] = KEY_LEN;
+    }
+
+    init_params(&params);
+    params.hash_size = 32;
+    for (hash_type=sha256_take_bit; hash_type<=spooky; hash_type++) {
+        params.hash_type = hash_type;
+        hash_fn_ctx = init_hash_fn_ctx(&params);
+        CU_ASSERT(hash_fn_ctx!=NULL);
+        CU_ASSERT(hash_fn_ctx->update_batch!=NULL);
+
+        hash_fn_ctx->update_batch(keys, klens, hashcodes, g_kvtrans_ut.kg->key_batch, hash_fn_ctx);
+        CU_ASSERT(hash_fn_ctx->tryout == 0);
+        /* batch hash should place keys exactly as the single key path */
+        for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+            hash_fn_ctx->clean(hash_fn_ctx);
+            hash_fn_ctx->update(keys[i], klens[i], hash_fn_ctx);
+            CU_ASSERT(hash_fn_ctx->hashcode == hashcodes[i]);
+        }
+        free_hash_fn_ctx(hash_fn_ctx);
+    }
+}
+
+void testBatchFlow(void)
+{
+    char *k;
+    void *v = malloc(VAL_LEN);//Sample data - opaque pointer will be stored
+    CU_ASSERT(v!=NULL);
+    dss_kvtrans_status_t  rc;
+    int i;
+
+    g_kvtrans_ut.kg->run(g_kvtrans_ut.kg, KEY_LEN);
+    /* store */
+    for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+        k = g_kvtrans_ut.kg->obj_key_list[i].key;
+        construct_test_dfly_request(k, v, KVTRANS_OPC_STORE, &g_kvtrans_ut.req_list[i]);
+        dss_kvtrans_handle_request(g_kvtrans_ut.ctx, &g_kvtrans_ut.req_list[i]);
+    }
+    do {
+        rc = kv_process_batch(g_kvtrans_ut.ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS || rc==KVTRANS_STATUS_FREE);
+    } while(rc != KVTRANS_STATUS_FREE);
+    /* exist */
+    for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+        k = g_kvtrans_ut.kg->obj_key_list[i].key;
+        construct_test_dfly_request(k, v, KVTRANS_OPC_EXIST, &g_kvtrans_ut.req_list[i]);
+        dss_kvtrans_handle_request(g_kvtrans_ut.ctx, &g_kvtrans_ut.req_list[i]);
+    }
+    do {
+        rc = kv_process_batch(g_kvtrans_ut.ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS || rc==KVTRANS_STATUS_FREE);
+    } while(rc != KVTRANS_STATUS_FREE);
+    /* delete */
+    for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+        k = g_kvtrans_ut.kg->obj_key_list[i].key;
+        construct_test_dfly_request(k, v, KVTRANS_OPC_DELETE, &g_kvtrans_ut.req_list[i]);
+        dss_kvtrans_handle_request(g_kvtrans_ut.ctx, &g_kvtrans_ut.req_list[i]);
+    }
+    do {
+        rc = kv_process_batch(g_kvtrans_ut.ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS || rc==KVTRANS_STATUS_FREE);
+    } while(rc != KVTRANS_STATUS_FREE);
+    /* exist after delete is served by the single request path */
+    for(i=0; i<g_kvtrans_ut.kg->key_batch; i++) {
+        k = g_kvtrans_ut.kg->obj_key_list[i].key;
+        construct_test_dfly_request(k, v, KVTRANS_OPC_EXIST, &g_kvtrans_ut.req_list[i]);
+        dss_kvtrans_handle_request(g_kvtrans_ut.ctx, &g_kvtrans_ut.req_list[i]);
+    }
+    do {
+        rc = kv_process(g_kvtrans_ut.ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_NOT_FOUND || rc==KVTRANS_STATUS_FREE);
+    } while(rc != KVTRANS_STATUS_FREE);
+
+    free(v);
+    reset_mem_backend(g_kvtrans_ut.ctx);
+    reset_key_generator(g_kvtrans_ut.kg);
+}
+
+void testMetaCache(void)
+{
+    kvtrans_meta_cache_t *cache;
+    uint64_t blk_size = BLK_ALIGN;
+    char *blk = malloc(blk_size);
+    char *out = malloc(blk_size);
+    uint32_t seq;
+    uint64_t i;
+
+    CU_ASSERT(blk!=NULL && out!=NULL);
+    CU_ASSERT(kvtrans_meta_cache_init(0, blk_size)==NULL);
+    cache = kvtrans_meta_cache_init(4, blk_size);
+    CU_ASSERT(cache!=NULL);
+
+    /* fill all slots */
+    for (i=1; i<=4; i++) {
+        memset(blk, (int)i, blk_size);
+        seq = kvtrans_meta_cache_get_seq(cache, i);
+        CU_ASSERT(kvtrans_meta_cache_fill(cache, i, blk, seq));
+    }
+    CU_ASSERT(kvtrans_meta_cache_lookup(cache, 2, out));
+    CU_ASSERT(out[0] == 2 && out[blk_size - 1] == 2);
+
+    /* referenced blk 2 survives, blk 1 is the clock victim */
+    memset(blk, 5, blk_size);
+    CU_ASSERT(kvtrans_meta_cache_fill(cache, 5, blk, kvtrans_meta_cache_get_seq(cache, 5)));
+    CU_ASSERT(cache->evictions == 1);
+    CU_ASSERT(!kvtrans_meta_cache_lookup(cache, 1, out));
+    CU_ASSERT(kvtrans_meta_cache_lookup(cache, 2, out));
+
+    /* a read issued before a completed write must not be cached */
+    seq = kvtrans_meta_cache_get_seq(cache, 3);
+    memset(blk, 6, blk_size);
+    kvtrans_meta_cache_update(cache, 3, blk);
+    memset(blk, 3, blk_size);
+    CU_ASSERT(!kvtrans_meta_cache_fill(cache, 3, blk, seq));
+    CU_ASSERT(kvtrans_meta_cache_lookup(cache, 3, out));
+    CU_ASSERT(out[0] == 6);
+
+    kvtrans_meta_cache_invalidate(cache, 3);
+    CU_ASSERT(!kvtrans_meta_cache_lookup(cache, 3, out));
+    kvtrans_meta_cache_invalidate_range(cache, 1, 8);
+    for (i=1; i<=8; i++) {
+        CU_ASSERT(!kvtrans_meta_cache_lookup(cache, i, out));
+    }
+
+    kvtrans_meta_cache_free(cache);
+    free(blk);
+    free(out);
+}
+
+void testKeyFilter(void)
+{
+    kvtrans_key_filter_t *filter;
+    char key[32];
+    uint64_t num_keys = 1024;
+    uint64_t false_pos = 0;
+    uint64_t i;
+
+    CU_ASSERT(kvtrans_key_filter_init(0)==NULL);
+    filter = kvtrans_key_filter_init(num_keys);
+    CU_ASSERT(filter!=NULL);
+
+    for (i=0; i<num_keys; i++) {
+        snprintf(key, sizeof(key), "filter_key_%zu", i);
+        CU_ASSERT(kvtrans_key_filter_insert(filter, key, strlen(key)));
+    }
+    CU_ASSERT(filter->num_items == num_keys);
+    CU_ASSERT(!filter->overflow);
+
+    /* no false negatives */
+    for (i=0; i<num_keys; i++) {
+        snprintf(key, sizeof(key), "filter_key_%zu", i);
+        CU_ASSERT(kvtrans_key_filter_may_contain(filter, key, strlen(key)));
+    }
+
+    /* most absent keys are rejected */
+    for (i=0; i<num_keys; i++) {
+        snprintf(key, sizeof(key), "absent_key_%zu", i);
+        if (kvtrans_key_filter_may_contain(filter, key, strlen(key))) false_pos++;
+    }
+    CU_ASSERT(false_pos < num_keys / 100);
+
+    /* deleted keys are gone, the rest stay */
+    for (i=0; i<num_keys; i+=2) {
+        snprintf(key, sizeof(key), "filter_key_%zu", i);
+        kvtrans_key_filter_delete(filter, key, strlen(key));
+    }
+    CU_ASSERT(filter->num_items == num_keys / 2);
+    for (i=1; i<num_keys; i+=2) {
+        snprintf(key, sizeof(key), "filter_key_%zu", i);
+        CU_ASSERT(kvtrans_key_filter_may_contain(filter, key, strlen(key)));
+    }
+
+    kvtrans_key_filter_reset(filter);
+    CU_ASSERT(filter->num_items == 0);
+    kvtrans_key_filter_free(filter);
+}
+
+void testBootScan(void)
+{
+    kvtrans_boot_batch_t batch;
+    uint64_t start, end, prev_end;
+    uint32_t i, j;
+
+    /* ranges cover all blks without overlap */
+    for (i=1; i<=7; i++) {
+        prev_end = 100;
+        for (j=0; j<i; j++) {
+            kvtrans_boot_split_range(100, 1003, i, j, &start, &end);
+            CU_ASSERT(start == prev_end);
+            CU_ASSERT(end - start >= 1003 / i && end - start <= 1003 / i + 1);
+            prev_end = end;
+        }
+        CU_ASSERT(prev_end == 1103);
+    }
+    kvtrans_boot_split_range(0, 2, 4, 3, &start, &end);
+    CU_ASSERT(start == end);
+
+    CU_ASSERT(kvtrans_boot_batch_init(&batch, 16, 8, 2) == 0);
+
+    /* close blks share one read */
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 10, META_DATA_COLLISION_ENTRY));
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 11, META_DATA_COLLISION_ENTRY));
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 14, META_DATA_COLLISION_ENTRY));
+    CU_ASSERT(batch.num_extents == 1);
+    CU_ASSERT(batch.extents[0].lba == 10 && batch.extents[0].num_blks == 5);
+    CU_ASSERT(batch.blks[2].buf_idx == 4);
+
+    /* a far blk starts a new read */
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 20, META_DATA_COLLISION_ENTRY));
+    CU_ASSERT(batch.num_extents == 2);
+    CU_ASSERT(batch.extents[1].buf_idx == 5);
+    CU_ASSERT(batch.blks[3].buf_idx == 5);
+
+    /* reads are capped at max_io_blks */
+    for (i=21; i<28; i++) {
+        CU_ASSERT(kvtrans_boot_batch_add(&batch, i, META));
+    }
+    CU_ASSERT(batch.num_extents == 2);
+    CU_ASSERT(batch.extents[1].num_blks == 8);
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 28, META));
+    CU_ASSERT(batch.num_extents == 3);
+    CU_ASSERT(batch.num_buf_blks == 14);
+
+    /* a full batch rejects the blk and keeps its reads */
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 29, META));
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 30, META));
+    CU_ASSERT(!kvtrans_boot_batch_add(&batch, 40, META));
+    CU_ASSERT(!kvtrans_boot_batch_add(&batch, 32, META));
+    CU_ASSERT(batch.num_buf_blks == 16);
+    CU_ASSERT(batch.num_blks == 14);
+
+    kvtrans_boot_batch_reset(&batch);
+    CU_ASSERT(batch.num_extents == 0 && batch.num_blks == 0);
+    CU_ASSERT(kvtrans_boot_batch_add(&batch, 40, META));
+    CU_ASSERT(batch.blks[0].buf_idx == 0);
+
+    kvtrans_boot_batch_free(&batch);
+}
+
+void testIndexSnapshot(void)
+{
+    kvtrans_params_t params;
+    kvtrans_ctx_t *ctx, *new_ctx;
+    kvtrans_snapshot_hdr_t hdr, bad_hdr;
+    kvtrans_snapshot_ent_t *ents;
+    dc_item_t it, *got;
+    uint64_t num_ents = 300;
+    uint64_t data_len = num_ents * sizeof(kvtrans_snapshot_ent_t);
+    uint64_t i;
+
+    init_params(&params);
+    params.logi_blk_num = 1 << 16;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    new_ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(new_ctx!=NULL);
+    ents = (kvtrans_snapshot_ent_t *) malloc(data_len);
+    CU_ASSERT(ents!=NULL);
+
+    for (i=0; i<num_ents; i++) {
+        it.mdc_index = ctx->blk_offset + 2 * i + 1;
+        it.ori_state = (i & 1) ? META : DATA;
+        CU_ASSERT(store_elm(ctx->dc_cache_tbl, ctx->blk_offset + 2 * i, &it) == 0);
+    }
+    ctx->stat.meta = 7;
+    ctx->stat.mdc = num_ents;
+
+    /* entries must fit in the region */
+    CU_ASSERT(kvtrans_snapshot_save(ctx, &hdr, ents, data_len - 1) == -1);
+    CU_ASSERT(kvtrans_snapshot_save(ctx, &hdr, ents, data_len) == 0);
+    CU_ASSERT(hdr.num_dc_entries == num_ents);
+    CU_ASSERT(hdr.generation == 1 && ctx->snapshot_gen == 1);
+    CU_ASSERT(kvtrans_snapshot_data_blks(num_ents, 4096) == 2);
+    CU_ASSERT(kvtrans_snapshot_hdr_is_valid(&hdr));
+    CU_ASSERT(kvtrans_snapshot_is_loadable(new_ctx, &hdr, data_len));
+    CU_ASSERT(!kvtrans_snapshot_is_loadable(new_ctx, &hdr, data_len - 1));
+
+    /* restored dc table and stats match */
+    CU_ASSERT(kvtrans_snapshot_load(new_ctx, &hdr, ents) == 0);
+    for (i=0; i<num_ents; i++) {
+        got = (dc_item_t *) get_elm(new_ctx->dc_cache_tbl, ctx->blk_offset + 2 * i);
+        CU_ASSERT(got!=NULL);
+        if (got) {
+            CU_ASSERT(got->mdc_index == ctx->blk_offset + 2 * i + 1);
+            CU_ASSERT(got->ori_state == ((i & 1) ? META : DATA));
+        }
+    }
+    CU_ASSERT(new_ctx->stat.meta == 7 && new_ctx->stat.mdc == num_ents);
+    CU_ASSERT(new_ctx->snapshot_gen == 1);
+
+    /* corrupted header or entries are rejected */
+    bad_hdr = hdr;
+    bad_hdr.blk_num++;
+    CU_ASSERT(!kvtrans_snapshot_hdr_is_valid(&bad_hdr));
+    ents[num_ents / 2].mdc_index++;
+    free_kvtrans_ctx(new_ctx);
+    new_ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(kvtrans_snapshot_load(new_ctx, &hdr, ents) == -1);
+    CU_ASSERT(has_no_elm(new_ctx->dc_cache_tbl));
+
+    /* a consumed snapshot is not loaded again */
+    kvtrans_snapshot_invalidate(&hdr);
+    CU_ASSERT(kvtrans_snapshot_hdr_is_valid(&hdr));
+    CU_ASSERT(!kvtrans_snapshot_is_loadable(new_ctx, &hdr, data_len));
+
+    /* a snapshot of another layout is not loaded */
+    CU_ASSERT(kvtrans_snapshot_save(ctx, &hdr, ents, data_len) == 0);
+    CU_ASSERT(hdr.generation == 2);
+    free_kvtrans_ctx(new_ctx);
+    params.logi_blk_num--;
+    new_ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(!kvtrans_snapshot_is_loadable(new_ctx, &hdr, data_len));
+
+    free(ents);
+    free_kvtrans_ctx(new_ctx);
+    free_kvtrans_ctx(ctx);
+}
+
+void testCuckoo(void)
+{
+    kvtrans_cuckoo_t *cuckoo;
+    kvtrans_params_t params;
+    kvtrans_ctx_t *ctx;
+    req_t *req;
+    char k[KEY_LEN];
+    void *v = malloc(VAL_LEN);//Sample data - opaque pointer will be stored
+    uint64_t buckets[2], b1, b2;
+    uint64_t num_keys = 1024;
+    uint64_t reads, i;
+    uint64_t lba, blk_state;
+    dss_kvtrans_status_t rc;
+
+    CU_ASSERT(v!=NULL);
+    memset(v, 0x5a, VAL_LEN);
+
+    /* candidate buckets are distinct and map to each other */
+    CU_ASSERT(kvtrans_cuckoo_init(1, 4, 4)==NULL);
+    CU_ASSERT(kvtrans_cuckoo_init(1, 64, KVTRANS_CUCKOO_MAX_BUCKET_BLKS + 1)==NULL);
+    cuckoo = kvtrans_cuckoo_init(1, 64, 4);
+    CU_ASSERT(cuckoo!=NULL);
+    CU_ASSERT(cuckoo->num_buckets == 16);
+    CU_ASSERT(kvtrans_cuckoo_end_lba(cuckoo) == 65);
+    for (i=0; i<num_keys; i++) {
+        snprintf(k, sizeof(k), "cuckoo_key_%zu", i);
+        kvtrans_cuckoo_get_buckets(cuckoo, k, strlen(k), &b1, &b2);
+        CU_ASSERT(b1 != b2);
+        CU_ASSERT(b1 < cuckoo->num_buckets && b2 < cuckoo->num_buckets);
+        CU_ASSERT(kvtrans_cuckoo_alt_bucket(cuckoo, k, strlen(k), b1) == b2);
+        CU_ASSERT(kvtrans_cuckoo_alt_bucket(cuckoo, k, strlen(k), b2) == b1);
+    }
+
+    /* locking is all or nothing */
+    buckets[0] = 3;
+    buckets[1] = 7;
+    CU_ASSERT(kvtrans_cuckoo_lock(cuckoo, buckets, 2));
+    CU_ASSERT(kvtrans_cuckoo_is_locked(cuckoo, 3) && kvtrans_cuckoo_is_locked(cuckoo, 7));
+    buckets[0] = 5;
+    CU_ASSERT(!kvtrans_cuckoo_lock(cuckoo, buckets, 2));
+    CU_ASSERT(!kvtrans_cuckoo_is_locked(cuckoo, 5));
+    buckets[0] = 3;
+    kvtrans_cuckoo_unlock(cuckoo, buckets, 2);
+    CU_ASSERT(!kvtrans_cuckoo_is_locked(cuckoo, 3) && !kvtrans_cuckoo_is_locked(cuckoo, 7));
+    kvtrans_cuckoo_free(cuckoo);
+
+    /* the table takes a share of the usable blks by default */
+    memcpy(&params, g_kvtrans_ut.params, sizeof(kvtrans_params_t));
+    params.placement = KVTRANS_PLACEMENT_CUCKOO;
+    params.cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    CU_ASSERT(ctx->cuckoo!=NULL);
+    CU_ASSERT(ctx->cuckoo->num_buckets * ctx->cuckoo->bucket_blks >
+                (params.logi_blk_num - params.blk_offset) / KVTRANS_CUCKOO_TABLE_SHARE - ctx->cuckoo->bucket_blks);
+    free_kvtrans_ctx(ctx);
+
+    /* a lookup reads at most two buckets */
+    params.cuckoo_table_blks = 2 * num_keys;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    CU_ASSERT(ctx->cuckoo!=NULL);
+    CU_ASSERT(dss_kvtrans_cuckoo_reserve_table(ctx) == KVTRANS_STATUS_SUCCESS);
+    //Disable block allocator meta sync
+    ctx->is_ba_meta_sync_enabled = false;
+    req = (req_t *)calloc(1, sizeof(req_t));
+
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "cuckoo_key_%zu", i);
+        construct_test_dfly_request(k, v, KVTRANS_OPC_STORE, req);
+        dss_kvtrans_handle_request(ctx, req);
+        rc = kv_process(ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+    CU_ASSERT(ctx->cuckoo->insert_failures == 0);
+    // values stay out of the table
+    for (lba=ctx->cuckoo->start_blk; lba<kvtrans_cuckoo_end_lba(ctx->cuckoo); lba++) {
+        CU_ASSERT(dss_blk_allocator_get_block_state(ctx->blk_alloc_ctx, lba, &blk_state) == 0);
+        CU_ASSERT(blk_state == META || blk_state == CUCKOO_FREE);
+    }
+
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "cuckoo_key_%zu", i);
+        reads = ctx->stat.meta_read;
+        construct_test_dfly_request(k, v, KVTRANS_OPC_EXIST, req);
+        dss_kvtrans_handle_request(ctx, req);
+        rc = kv_process(ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+        CU_ASSERT(ctx->stat.meta_read - reads <= 2);
+    }
+
+    memset(k, 0, sizeof(k));
+    snprintf(k, sizeof(k), "cuckoo_key_%d", 0);
+    memset(req->req_value.value, 0, req->req_value.length);
+    construct_test_dfly_request(k, v, KVTRANS_OPC_RETRIEVE, req);
+    dss_kvtrans_handle_request(ctx, req);
+    rc = kv_process(ctx);
+    CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    CU_ASSERT(req->req_value.length == VAL_LEN);
+
+    for (i=0; i<num_keys; i+=2) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "cuckoo_key_%zu", i);
+        construct_test_dfly_request(k, v, KVTRANS_OPC_DELETE, req);
+        dss_kvtrans_handle_request(ctx, req);
+        rc = kv_process(ctx);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "cuckoo_key_%zu", i);
+        construct_test_dfly_request(k, v, KVTRANS_OPC_EXIST, req);
+        dss_kvtrans_handle_request(ctx, req);
+        rc = kv_process(ctx);
+        CU_ASSERT(rc == (i % 2 ? KVTRANS_STATUS_SUCCESS : KVTRANS_STATUS_NOT_FOUND));
+    }
+
+    free(req);
+    free(v);
+    free_kvtrans_ctx(ctx);
+}
+
+// store, update or delete a small key in ctx
+static dss_kvtrans_status_t packed_test_op(kvtrans_ctx_t *ctx, req_t *req, char *k,
+                                           void *v, uint32_t vlen, kv_op_t opc)
+{
+    construct_test_dfly_request(k, v, opc, req);
+    req->req_key.length = strlen(k);
+    req->req_value.length = vlen;
+    dss_kvtrans_handle_request(ctx, req);
+    return kv_process(ctx);
+}
+
+void testPackedMeta(void)
+{
+    static uint8_t blk[sizeof(ondisk_meta_t)];
+    struct timespec ts = {0};
+    kvtrans_packed_rec_t *rec;
+    kvtrans_params_t params;
+    kvtrans_ctx_t *ctx;
+    req_t *req;
+    char k[KEY_LEN];
+    uint8_t *v = malloc(VAL_LEN);
+    uint8_t *out = malloc(VAL_LEN);
+    uint64_t num_keys = 512;
+    uint32_t vlen = 64;
+    int slot[3];
+    uint64_t i;
+    dss_kvtrans_status_t rc;
+
+    CU_ASSERT(v!=NULL && out!=NULL);
+    memset(v, 0x5a, VAL_LEN);
+
+    /* records share a blk until it is full, deleted space is reused */
+    CU_ASSERT(kvtrans_packed_is_packable(16, vlen));
+    CU_ASSERT(!kvtrans_packed_is_packable(16, KVTRANS_PACKED_MAX_RECORD));
+    kvtrans_packed_init(blk, sizeof(blk));
+    CU_ASSERT(kvtrans_packed_is_valid(blk, sizeof(blk)));
+    slot[0] = kvtrans_packed_insert(blk, sizeof(blk), "key0", 4, v, 500, &ts);
+    slot[1] = kvtrans_packed_insert(blk, sizeof(blk), "key1", 4, v, 500, &ts);
+    slot[2] = kvtrans_packed_insert(blk, sizeof(blk), "key2", 4, v, 500, &ts);
+    CU_ASSERT(slot[0] >= 0 && slot[1] >= 0 && slot[2] >= 0);
+    CU_ASSERT(kvtrans_packed_num_keys(blk) == 3);
+    CU_ASSERT(kvtrans_packed_find(blk, "key1", 4) == slot[1]);
+    CU_ASSERT(kvtrans_packed_find(blk, "key3", 4) < 0);
+    for (i=0; kvtrans_packed_fits(blk, 4, 500); i++) {
+        snprintf(k, sizeof(k), "fill%zu", i);
+        CU_ASSERT(kvtrans_packed_insert(blk, sizeof(blk), k, strlen(k), v, 500, &ts) >= 0);
+    }
+    CU_ASSERT(kvtrans_packed_insert(blk, sizeof(blk), "key3", 4, v, 500, &ts) < 0);
+    kvtrans_packed_delete(blk, slot[1]);
+    CU_ASSERT(kvtrans_packed_find(blk, "key1", 4) < 0);
+    // the hole left by key1 is merged when key3 is inserted
+    CU_ASSERT(kvtrans_packed_insert(blk, sizeof(blk), "key3", 4, v, 500, &ts) >= 0);
+    rec = kvtrans_packed_get(blk, kvtrans_packed_find(blk, "key2", 4));
+    CU_ASSERT(rec != NULL && rec->value_size == 500);
+    CU_ASSERT(!kvtrans_packed_update(blk, sizeof(blk), kvtrans_packed_find(blk, "key2", 4),
+                                        "key2", 4, v, 900, &ts));
+    CU_ASSERT(kvtrans_packed_update(blk, sizeof(blk), kvtrans_packed_find(blk, "key2", 4),
+                                        "key2", 4, v, 8, &ts));
+    rec = kvtrans_packed_get(blk, kvtrans_packed_find(blk, "key2", 4));
+    CU_ASSERT(rec != NULL && rec->value_size == 8);
+
+    /* packing needs cuckoo placement */
+    memcpy(&params, g_kvtrans_ut.params, sizeof(kvtrans_params_t));
+    params.meta_blk_num = 2 * num_keys;
+    params.packed_meta = true;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    CU_ASSERT(ctx->kvtrans_params.packed_meta == false);
+    free_kvtrans_ctx(ctx);
+
+    // a small table so that buckets hold several keys
+    params.cuckoo_table_blks = num_keys / 4;
+    params.placement = KVTRANS_PLACEMENT_CUCKOO;
+    params.cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    CU_ASSERT(ctx->cuckoo!=NULL && ctx->kvtrans_params.packed_meta);
+    CU_ASSERT(dss_kvtrans_cuckoo_reserve_table(ctx) == KVTRANS_STATUS_SUCCESS);
+    //Disable block allocator meta sync
+    ctx->is_ba_meta_sync_enabled = false;
+    req = (req_t *)calloc(1, sizeof(req_t));
+
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "packed_key_%zu", i);
+        memset(v, (int) i, vlen);
+        rc = packed_test_op(ctx, req, k, v, vlen, KVTRANS_OPC_STORE);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+    CU_ASSERT(ctx->stat.packed_keys == num_keys);
+    CU_ASSERT(ctx->stat.meta == 0);
+    // several keys per blk
+    CU_ASSERT(ctx->stat.packed_blks > 0 && ctx->stat.packed_blks <= num_keys / 4);
+
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "packed_key_%zu", i);
+        memset(out, 0, vlen + 1);
+        rc = packed_test_op(ctx, req, k, out, VAL_LEN, KVTRANS_OPC_RETRIEVE);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+        memset(v, (int) i, vlen);
+        CU_ASSERT(memcmp(out, v, vlen) == 0);
+        CU_ASSERT(out[vlen] == 0);
+    }
+
+    /* a value too large to pack moves the key to a meta blk */
+    memset(k, 0, sizeof(k));
+    snprintf(k, sizeof(k), "packed_key_%d", 1);
+    memset(v, 0x77, VAL_LEN);
+    rc = packed_test_op(ctx, req, k, v, 2 * KVTRANS_PACKED_MAX_RECORD, KVTRANS_OPC_STORE);
+    CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    CU_ASSERT(ctx->stat.packed_keys == num_keys - 1);
+    CU_ASSERT(ctx->stat.meta == 1);
+    memset(out, 0, VAL_LEN);
+    rc = packed_test_op(ctx, req, k, out, VAL_LEN, KVTRANS_OPC_RETRIEVE);
+    CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    CU_ASSERT(memcmp(out, v, 2 * KVTRANS_PACKED_MAX_RECORD) == 0);
+
+    for (i=0; i<num_keys; i+=2) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "packed_key_%zu", i);
+        rc = packed_test_op(ctx, req, k, v, 0, KVTRANS_OPC_DELETE);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "packed_key_%zu", i);
+        rc = packed_test_op(ctx, req, k, v, 0, KVTRANS_OPC_EXIST);
+        CU_ASSERT(rc == (i % 2 ? KVTRANS_STATUS_SUCCESS : KVTRANS_STATUS_NOT_FOUND));
+    }
+    for (i=1; i<num_keys; i+=2) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "packed_key_%zu", i);
+        rc = packed_test_op(ctx, req, k, v, 0, KVTRANS_OPC_DELETE);
+        CU_ASSERT(rc == KVTRANS_STATUS_SUCCESS);
+    }
+    // blks are freed with their last key
+    CU_ASSERT(ctx->stat.packed_keys == 0);
+    CU_ASSERT(ctx->stat.packed_blks == 0);
+
+    free(req);
+    free(out);
+    free(v);
+    free_kvtrans_ctx(ctx);
+}
+
+void testCuckooFill(void)
+{
+    kvtrans_params_t params;
+    kvtrans_ctx_t *ctx;
+    req_t *req;
+    char k[KEY_LEN];
+    uint8_t *v = malloc(VAL_LEN);
+    uint64_t table_blks = 1024;
+    uint64_t num_keys, failures = 0;
+    uint32_t vlen = 64;
+    uint64_t i;
+    dss_kvtrans_status_t rc;
+
+    CU_ASSERT(v!=NULL);
+    memset(v, 0x5a, VAL_LEN);
+
+    memcpy(&params, g_kvtrans_ut.params, sizeof(kvtrans_params_t));
+    params.placement = KVTRANS_PLACEMENT_CUCKOO;
+    params.cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+    params.cuckoo_table_blks = table_blks;
+    ctx = init_kvtrans_ctx(&params);
+    CU_ASSERT(ctx!=NULL);
+    CU_ASSERT(ctx->cuckoo!=NULL);
+    CU_ASSERT(dss_kvtrans_cuckoo_reserve_table(ctx) == KVTRANS_STATUS_SUCCESS);
+    //Disable block allocator meta sync
+    ctx->is_ba_meta_sync_enabled = false;
+    req = (req_t *)calloc(1, sizeof(req_t));
+
+    /* kick chains keep inserts succeeding up to 95% of the table */
+    num_keys = ctx->cuckoo->num_buckets * ctx->cuckoo->bucket_blks * 95 / 100;
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "fill_key_%zu", i);
+        rc = packed_test_op(ctx, req, k, v, vlen, KVTRANS_OPC_STORE);
+        if (rc != KVTRANS_STATUS_SUCCESS) failures++;
+    }
+    CU_ASSERT(failures == ctx->cuckoo->insert_failures);
+    CU_ASSERT(failures * 100 <= num_keys);
+    CU_ASSERT(ctx->cuckoo->relocations > 0);
+
+    // moved keys are found in their alternate bucket
+    for (i=0; i<num_keys; i++) {
+        memset(k, 0, sizeof(k));
+        snprintf(k, sizeof(k), "fill_key_%zu", i);
+        rc = packed_test_op(ctx, req, k, v, 0, KVTRANS_OPC_EXIST);
+        if (rc != KVTRANS_STATUS_SUCCESS) failures--;
+    }
+    CU_ASSERT(failures == 0);
+
+    free(req);
+    free(v);
+    free_kvtrans_ctx(ctx);
+}
 
 int main( )
 {
@@ -431,6 +1096,15 @@ int main( )
         || NULL == CU_add_test(pSuite, "testSuccessFlow" ,  testSuccessFlow)
         // || NULL == CU_add_test(pSuite, "testCollision" ,  testCollision) // included in testFullDelete
         || NULL == CU_add_test(pSuite, "testBatchDelete" ,  testBatchDelete)
+        || NULL == CU_add_test(pSuite, "testBatchFlow" ,  testBatchFlow)
+        || NULL == CU_add_test(pSuite, "testHashBatch" ,  testHashBatch)
+        || NULL == CU_add_test(pSuite, "testMetaCache" ,  testMetaCache)
+        || NULL == CU_add_test(pSuite, "testKeyFilter" ,  testKeyFilter)
+        || NULL == CU_add_test(pSuite, "testBootScan" ,  testBootScan)
+        || NULL == CU_add_test(pSuite, "testIndexSnapshot" ,  testIndexSnapshot)
+        || NULL == CU_add_test(pSuite, "testCuckoo" ,  testCuckoo)
+        || NULL == CU_add_test(pSuite, "testPackedMeta" ,  testPackedMeta)
+        || NULL == CU_add_test(pSuite, "testCuckooFill" ,  testCuckooFill)
         || NULL == CU_add_test(pSuite, "testFullDelete" ,  testFullDelete)
     ) {
         CU_cleanup_registry();
@@ -0,0 +1,199 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Meta read amplification of the chained and cuckoo kvtrans placement
+ * modes at 50/80/95% fill of the meta placement region.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "kvtrans.h"
+
+#define BENCH_VAL_LEN (512)
+#define BENCH_DEFAULT_TABLE_BLKS (20000)
+#define DEFAULT_DEV 0x34acb239
+#define DEFAULT_IOTM 0xffffffff
+
+extern bool g_disk_as_data_store;
+
+static const uint32_t bench_fill_pct[] = {50, 80, 95};
+
+static const char *placement_names[] = {"chain", "cuckoo"};
+
+static void help() {
+    printf("usage:\n");
+    printf("\t\t./dss_kvtrans_placement_bench [table_blks]\n");
+    printf("arguments:\n");
+    printf("\t\t -table_blks: the number of blocks keys are placed in, default %u.\n",
+            BENCH_DEFAULT_TABLE_BLKS);
+}
+
+static void init_bench_params(kvtrans_params_t *params, enum kvtrans_placement_e placement,
+                              uint64_t table_blks)
+{
+    memset(params, 0, sizeof(kvtrans_params_t));
+    params->id = 0;
+    params->thread_num = 1;
+    params->name = "kvtrans_placement_bench";
+    params->hash_type = spooky;
+    params->hash_size = 0;
+    params->meta_blk_num = table_blks;
+    params->blk_alloc_name = "block_impresario";
+    params->dev = (void *) DEFAULT_DEV;
+    params->iotm = (void *) DEFAULT_IOTM;
+    params->blk_offset = 1;
+    params->logi_blk_size = 4096;
+    params->state_num = 10;
+    params->batch_size = 1;
+    params->placement = placement;
+    params->cuckoo_bucket_blks = DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS;
+    if (placement == KVTRANS_PLACEMENT_CUCKOO) {
+        // the table is at the device start, leave the rest for values
+        params->logi_blk_num = 2 * table_blks;
+    } else {
+        // chained entries are hashed over the whole device
+        params->logi_blk_num = table_blks;
+    }
+}
+
+static void build_req(req_t *req, uint64_t key_id, kv_op_t opc, void *value)
+{
+    memset(req, 0, sizeof(req_t));
+    req->req_key.length = snprintf(req->req_key.key, sizeof(req->req_key.key),
+                                    "placement_bench_key_%zu", key_id);
+    if (value) {
+        req->req_value.value = value;
+        req->req_value.length = BENCH_VAL_LEN;
+    }
+    req->opc = opc;
+}
+
+static int run_bench(enum kvtrans_placement_e placement, uint64_t table_blks, uint32_t fill_pct)
+{
+    kvtrans_params_t params;
+    kvtrans_ctx_t *ctx;
+    req_t *req;
+    void *value;
+    uint64_t num_keys = table_blks * fill_pct / 100;
+    uint64_t stored = 0, failed = 0;
+    uint64_t reads, blks, max_reads = 0;
+    uint64_t i, r;
+
+    init_bench_params(&params, placement, table_blks);
+    ctx = init_kvtrans_ctx(&params);
+    req = (req_t *) calloc(1, sizeof(req_t));
+    value = malloc(BENCH_VAL_LEN);
+    if (!ctx || !req || !value) {
+        printf("ERROR: init %s bench failed.\n", placement_names[placement]);
+        return 1;
+    }
+    //Disable block allocator meta sync
+    ctx->is_ba_meta_sync_enabled = false;
+    memset(value, 0xa5, BENCH_VAL_LEN);
+
+    for (i = 0; i < num_keys; i++) {
+        build_req(req, i, KVTRANS_OPC_STORE, value);
+        dss_kvtrans_handle_request(ctx, req);
+        if (kv_process(ctx) == KVTRANS_STATUS_SUCCESS) {
+            stored++;
+        } else {
+            failed++;
+        }
+    }
+
+    reads = ctx->stat.meta_read;
+    blks = ctx->stat.meta_read_blks;
+    for (i = 0; i < num_keys; i++) {
+        r = ctx->stat.meta_read;
+        build_req(req, i, KVTRANS_OPC_EXIST, NULL);
+        dss_kvtrans_handle_request(ctx, req);
+        kv_process(ctx);
+        r = ctx->stat.meta_read - r;
+        if (r > max_reads) max_reads = r;
+    }
+    reads = ctx->stat.meta_read - reads;
+    blks = ctx->stat.meta_read_blks - blks;
+
+    printf("%-8s %5u%% %10zu %10zu %12.3f %10zu %12.3f %10zu\n",
+            placement_names[placement], fill_pct, stored, failed,
+            num_keys ? (double) reads / num_keys : 0,
+            max_reads,
+            num_keys ? (double) blks / num_keys : 0,
+            ctx->cuckoo ? ctx->cuckoo->relocations : ctx->stat.mc + ctx->stat.dc);
+
+    free(value);
+    free(req);
+    free_kvtrans_ctx(ctx);
+    return 0;
+}
+
+int main(int arc, char **argv)
+{
+    uint64_t table_blks = BENCH_DEFAULT_TABLE_BLKS;
+    int placement;
+    uint32_t i;
+
+    if (arc > 2) {
+        printf("Input error\n");
+        help();
+        return 1;
+    }
+    if (arc == 2) {
+        table_blks = strtoull(argv[1], NULL, 10);
+        if (table_blks < 2 * DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS) {
+            help();
+            return 1;
+        }
+    }
+
+    g_disk_as_data_store = false;
+
+    printf("table blks %zu, value len %u, cuckoo bucket blks %u\n",
+            table_blks, BENCH_VAL_LEN, DEFAULT_KVTRANS_CUCKOO_BUCKET_BLKS);
+    printf("%-8s %6s %10s %10s %12s %10s %12s %10s\n", "mode", "fill", "stored",
+            "failed", "reads/get", "max reads", "blks/get", "col/reloc");
+
+    for (i = 0; i < sizeof(bench_fill_pct) / sizeof(bench_fill_pct[0]); i++) {
+        for (placement = KVTRANS_PLACEMENT_CHAIN; placement <= KVTRANS_PLACEMENT_CUCKOO; placement++) {
+            if (run_bench(placement, table_blks, bench_fill_pct[i])) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,338 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <dirent.h>
+#include "CUnit/Basic.h"
+
+#include <wal_lib.h>
+
+#define TEST_NR_ZONE	2
+#define TEST_ZONE_MB	1
+#define TEST_IMAGE_SZ	((1 + TEST_NR_ZONE * TEST_ZONE_MB) * MB)
+
+static const char *g_log_read;
+
+typedef struct test_buffer_s {
+    off64_t start;
+    off64_t pos;
+    int32_t sequence;
+} test_buffer_t;
+
+//buffer header at the start of each half of the zone, records follow it as recovery expects
+static void test_buffer_init(char *img, test_buffer_t *b, off64_t start, off64_t size,
+                             int32_t role, int32_t sequence)
+{
+    wal_buffer_hdr_t *hdr = (wal_buffer_hdr_t *)(img + start);
+
+    hdr->start_addr = start;
+    hdr->end_addr = start + size;
+    hdr->role = role;
+    hdr->sequence = sequence;
+
+    b->start = start;
+    b->pos = (start + sizeof(wal_buffer_hdr_t) + WAL_ALIGN - 1) & WAL_ALIGN_MASK;
+    b->sequence = sequence;
+    hdr->curr_pos = b->pos;
+}
+
+//[hdr|key|value|chksum] padded to WAL_ALIGN, a delete is a record without value
+static void test_buffer_add(char *img, test_buffer_t *b, const char *key, const char *val,
+                            int32_t chksum)
+{
+    wal_obj_hdr_t *oh = (wal_obj_hdr_t *)(img + b->pos);
+    wal_obj_checksum_t ch = {chksum, 0};
+    int key_sz = strlen(key);
+    int val_sz = val ? strlen(val) : 0;
+    char *p = img + b->pos + sizeof(wal_obj_hdr_t);
+
+    oh->key_sz = key_sz;
+    oh->val_sz = val_sz;
+    oh->state = val ? WAL_ITEM_VALID : WAL_ITEM_INVALID;
+    oh->addr = sizeof(wal_obj_hdr_t);
+    oh->sz_blk = (sizeof(wal_obj_hdr_t) + sizeof(wal_obj_checksum_t) + key_sz + val_sz +
+                  WAL_ALIGN - 1) >> WAL_ALIGN_OFFSET;
+
+    memcpy(p, key, key_sz);
+    memcpy(p + key_sz, val, val_sz);
+    memcpy(p + key_sz + val_sz, &ch, sizeof(ch));
+
+    b->pos += (off64_t)oh->sz_blk << WAL_ALIGN_OFFSET;
+}
+
+//zone 0 has both buffers in use, zone 1 only its log buffer with a torn last record
+static void test_write_image(const char *path)
+{
+    char *img = (char *)calloc(1, TEST_IMAGE_SZ);
+    wal_sb_t *sb = (wal_sb_t *)img;
+    off64_t zone_sz = (off64_t)TEST_ZONE_MB << WAL_ZONE_OFFSET;
+    test_buffer_t log, flush;
+    int fd, i;
+
+    CU_ASSERT(img != NULL);
+    if (img == NULL) {
+        return;
+    }
+
+    sb->size = sizeof(wal_sb_t);
+    sb->version = WAL_VER;
+    sb->magic = WAL_MAGIC;
+    sb->alignment = WAL_ALIGN;
+    sb->offset = 1;
+    sb->nr_zone = TEST_NR_ZONE;
+    for (i = 0; i < TEST_NR_ZONE; i++) {
+        sb->zone_space[i].addr_mb = 1 + i * TEST_ZONE_MB;
+        sb->zone_space[i].size_mb = TEST_ZONE_MB;
+    }
+
+    //zone 0: the flush buffer holds the older records
+    test_buffer_init(img, &log, 1 * MB, zone_sz / 2, WAL_BUFFER_ROLE_LOG, 2);
+    test_buffer_init(img, &flush, 1 * MB + zone_sz / 2, zone_sz / 2, WAL_BUFFER_ROLE_FLUSH, 1);
+    test_buffer_add(img, &flush, "key_a", "value_a1", flush.sequence);
+    test_buffer_add(img, &flush, "key_b", "value_b1", flush.sequence);
+    test_buffer_add(img, &log, "key_a", "value_a2", log.sequence);
+    test_buffer_add(img, &log, "key_b", NULL, log.sequence);
+    test_buffer_add(img, &log, "key_c", "value_c1", log.sequence);
+
+    //zone 1: flush buffer never used, the last record was not completely written
+    test_buffer_init(img, &log, 2 * MB, zone_sz / 2, WAL_BUFFER_ROLE_LOG, 1);
+    test_buffer_init(img, &flush, 2 * MB + zone_sz / 2, zone_sz / 2, WAL_BUFFER_ROLE_FLUSH, 0);
+    test_buffer_add(img, &log, "key_d", "value_d1", log.sequence);
+    test_buffer_add(img, &log, "key_e", "value_e1", log.sequence);
+    test_buffer_add(img, &log, "key_f", "value_f1", log.sequence);
+    test_buffer_add(img, &log, "key_g", "value_g1", log.sequence + 1);
+
+    fd = open(path, O_WRONLY | O_TRUNC);
+    CU_ASSERT(fd >= 0);
+    CU_ASSERT(pwrite(fd, img, TEST_IMAGE_SZ, 0) == TEST_IMAGE_SZ);
+    close(fd);
+    free(img);
+}
+
+typedef struct test_totals_s {
+    int nr_zone;
+    int nr_fail;
+    long long records;
+    long long live;
+    long long deleted;
+    long long overwrite;
+    long long replayed;
+    long long replay_fail;
+    int exit_code;
+} test_totals_t;
+
+//run the tool on the image and parse its summary lines
+static void test_run_log_read(const char *args, const char *path, test_totals_t *t)
+{
+    char cmd[1024], line[1024];
+    FILE *out;
+    int status;
+
+    memset(t, 0, sizeof(*t));
+    t->nr_zone = -1;
+    snprintf(cmd, sizeof(cmd), "%s %s %s", g_log_read, args, path);
+    out = popen(cmd, "r");
+    CU_ASSERT(out != NULL);
+    if (out == NULL) {
+        return;
+    }
+    while (fgets(line, sizeof(line), out)) {
+        sscanf(line, "total: zones %d failed %d records %lld live %lld deleted %lld overwrite %lld",
+               &t->nr_zone, &t->nr_fail, &t->records, &t->live, &t->deleted, &t->overwrite);
+        if (!strncmp(line, "replay:", 7)) {
+            sscanf(strstr(line, "applied"), "applied %lld failed %lld",
+                   &t->replayed, &t->replay_fail);
+        }
+    }
+    status = pclose(out);
+    t->exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static void test_check_file(const char *dir, const char *key, const char *val)
+{
+    char path[PATH_MAX], name[128], rd[64];
+    int fd, i, n;
+
+    for (i = 0; key[i]; i++) {
+        sprintf(name + 2 * i, "%02x", (unsigned char)key[i]);
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    fd = open(path, O_RDONLY);
+    if (!val) {
+        CU_ASSERT(fd < 0);
+        return;
+    }
+    CU_ASSERT(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    n = read(fd, rd, sizeof(rd));
+    close(fd);
+    CU_ASSERT(n == (int)strlen(val));
+    CU_ASSERT(!memcmp(rd, val, strlen(val)));
+    unlink(path);
+}
+
+static void testScanCounts(void)
+{
+    char path[] = "/tmp/dss_wal_log_read_utXXXXXX";
+    const char *args[] = {"-t 1", "-t 2 -c 1", "-t 8"};
+    test_totals_t t;
+    int fd, i;
+
+    fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+    test_write_image(path);
+
+    //same counts whatever the thread count and read size
+    for (i = 0; i < (int)(sizeof(args) / sizeof(args[0])); i++) {
+        test_run_log_read(args[i], path, &t);
+        CU_ASSERT(t.exit_code == 0);
+        CU_ASSERT(t.nr_zone == TEST_NR_ZONE);
+        CU_ASSERT(t.nr_fail == 0);
+        //5 records in zone 0, the torn one in zone 1 is not counted
+        CU_ASSERT(t.records == 8);
+        CU_ASSERT(t.live == 5);
+        CU_ASSERT(t.deleted == 1);
+        CU_ASSERT(t.overwrite == 2);
+    }
+
+    unlink(path);
+}
+
+static void testReplay(void)
+{
+    char path[] = "/tmp/dss_wal_log_read_utXXXXXX";
+    char dir[] = "/tmp/dss_wal_log_read_replayXXXXXX";
+    char args[128];
+    test_totals_t t;
+    int fd;
+
+    fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+    if (mkdtemp(dir) == NULL) {
+        CU_ASSERT(0);
+        unlink(path);
+        return;
+    }
+    test_write_image(path);
+
+    snprintf(args, sizeof(args), "-r %s", dir);
+    test_run_log_read(args, path, &t);
+    CU_ASSERT(t.exit_code == 0);
+    //every latest record is applied, deletes included
+    CU_ASSERT(t.replayed == 6);
+    CU_ASSERT(t.replay_fail == 0);
+
+    test_check_file(dir, "key_a", "value_a2");
+    test_check_file(dir, "key_b", NULL);
+    test_check_file(dir, "key_c", "value_c1");
+    test_check_file(dir, "key_d", "value_d1");
+    test_check_file(dir, "key_e", "value_e1");
+    test_check_file(dir, "key_f", "value_f1");
+    test_check_file(dir, "key_g", NULL);
+
+    rmdir(dir);
+    unlink(path);
+}
+
+static void testBadImage(void)
+{
+    char path[] = "/tmp/dss_wal_log_read_utXXXXXX";
+    test_totals_t t;
+    uint32_t magic = 0;
+    int fd;
+
+    fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+    test_write_image(path);
+
+    fd = open(path, O_WRONLY);
+    CU_ASSERT(pwrite(fd, &magic, sizeof(magic), offsetof(wal_sb_t, magic)) == sizeof(magic));
+    close(fd);
+
+    test_run_log_read("", path, &t);
+    CU_ASSERT(t.exit_code != 0);
+    CU_ASSERT(t.nr_zone == -1);
+
+    unlink(path);
+}
+
+int main(int argc, char **argv)
+{
+    CU_pSuite pSuite = NULL;
+
+    if (argc < 2) {
+        printf("usage: %s <log_read binary>\n", argv[0]);
+        return -1;
+    }
+    g_log_read = argv[1];
+
+    if(CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    pSuite = CU_add_suite("DSS wal log_read", NULL, NULL);
+    if(NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if(
+        NULL == CU_add_test(pSuite, "testScanCounts", testScanCounts) ||
+        NULL == CU_add_test(pSuite, "testReplay", testReplay) ||
+        NULL == CU_add_test(pSuite, "testBadImage", testBadImage)
+    ) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+
+    return CU_get_error();
+}
@@ -0,0 +1,217 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include "CUnit/Basic.h"
+
+#include <wal_commit_ctrl.h>
+
+#define TEST_TARGET_US	500
+#define TEST_MAX_NR_OBJ	256
+
+//group commit of one zone: requests every interval_ns, a group is written once it holds
+//batch_nr_obj requests or its oldest request waited batch_timeout_us, each write takes device_ns.
+//returns the largest p99 reported after the controller settled.
+static int32_t simulate(wal_commit_ctrl_t *ctrl, int64_t interval_ns, int64_t device_ns, int nr_reqs)
+{
+    int64_t now = 0, open_ts = -1;
+    int nr_group = 0, nr_batch = 0;
+    int32_t p99_us = 0;
+    int i;
+
+    for (i = 0; i < nr_reqs; i++) {
+        now += interval_ns;
+        //timeout dispatch of the pending group before this arrival
+        if (nr_group && now - open_ts >= (int64_t)ctrl->batch_timeout_us * 1000) {
+            int64_t done = open_ts + (int64_t)ctrl->batch_timeout_us * 1000 + device_ns;
+            if (wal_commit_ctrl_complete(ctrl, nr_group, device_ns, done - open_ts) &&
+                ++nr_batch > 4 && ctrl->p99_us > p99_us)
+                p99_us = ctrl->p99_us;
+            nr_group = 0;
+        }
+        wal_commit_ctrl_arrival(ctrl, interval_ns);
+        if (!nr_group++)
+            open_ts = now;
+        if (nr_group >= ctrl->batch_nr_obj) {
+            if (wal_commit_ctrl_complete(ctrl, nr_group, device_ns, now + device_ns - open_ts) &&
+                ++nr_batch > 4 && ctrl->p99_us > p99_us)
+                p99_us = ctrl->p99_us;
+            nr_group = 0;
+        }
+    }
+
+    return p99_us;
+}
+
+static void testInit(void)
+{
+    wal_commit_ctrl_t ctrl;
+
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, TEST_MAX_NR_OBJ);
+    CU_ASSERT(ctrl.target_us == TEST_TARGET_US);
+    CU_ASSERT(ctrl.batch_nr_obj == 1);
+    CU_ASSERT(ctrl.batch_timeout_us >= WAL_COMMIT_CTRL_MIN_TIMEOUT_US);
+    CU_ASSERT(ctrl.batch_timeout_us <= TEST_TARGET_US);
+
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, 0);
+    CU_ASSERT(ctrl.max_nr_obj == 1);
+    CU_ASSERT(ctrl.batch_nr_obj == 1);
+
+    return;
+}
+
+static void testLowRate(void)
+{
+    wal_commit_ctrl_t ctrl;
+    int i;
+
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, TEST_MAX_NR_OBJ);
+    //requests far apart are written on their own, they never wait for company
+    for (i = 0; i < WAL_COMMIT_CTRL_WINDOW * 2; i++) {
+        wal_commit_ctrl_arrival(&ctrl, 10000000);
+        wal_commit_ctrl_complete(&ctrl, 1, 50000, 50000);
+        CU_ASSERT(ctrl.batch_nr_obj == 1);
+    }
+    CU_ASSERT(ctrl.p99_us <= 50);
+    //idle gaps are capped
+    CU_ASSERT(ctrl.arrival_ns <= (int64_t)TEST_TARGET_US * 1000 * 4);
+    CU_ASSERT(ctrl.arrival_ns > (int64_t)TEST_TARGET_US * 1000 * 3);
+
+    return;
+}
+
+static void testHighRate(void)
+{
+    wal_commit_ctrl_t ctrl;
+    int i;
+
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, TEST_MAX_NR_OBJ);
+    for (i = 0; i < 64; i++)
+        wal_commit_ctrl_arrival(&ctrl, 2000);
+    wal_commit_ctrl_complete(&ctrl, 1, 100000, 100000);
+    CU_ASSERT(ctrl.batch_nr_obj > 1);
+    CU_ASSERT(ctrl.batch_nr_obj <= TEST_MAX_NR_OBJ);
+    //the wait never eats into the device time
+    CU_ASSERT(ctrl.batch_timeout_us <= TEST_TARGET_US - 100);
+
+    //back to back requests fill the largest batch
+    for (i = 0; i < 64; i++)
+        wal_commit_ctrl_arrival(&ctrl, 10);
+    wal_commit_ctrl_complete(&ctrl, 1, 100000, 100000);
+    CU_ASSERT(ctrl.batch_nr_obj == TEST_MAX_NR_OBJ);
+
+    return;
+}
+
+static void testOvershoot(void)
+{
+    wal_commit_ctrl_t ctrl;
+    int32_t gain, timeout_us;
+    int i;
+
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, TEST_MAX_NR_OBJ);
+    for (i = 0; i < 64; i++)
+        wal_commit_ctrl_arrival(&ctrl, 1000);
+    gain = ctrl.gain;
+
+    for (i = 0; i < WAL_COMMIT_CTRL_WINDOW - 1; i++)
+        CU_ASSERT(!wal_commit_ctrl_complete(&ctrl, 8, 100000, TEST_TARGET_US * 2000));
+    timeout_us = ctrl.batch_timeout_us;
+    CU_ASSERT(wal_commit_ctrl_complete(&ctrl, 8, 100000, TEST_TARGET_US * 2000));
+    CU_ASSERT(ctrl.p99_us == TEST_TARGET_US * 2);
+    CU_ASSERT(ctrl.gain == gain / 2);
+    CU_ASSERT(ctrl.batch_timeout_us < timeout_us);
+    CU_ASSERT(ctrl.nr_window_reqs == 0);
+
+    //latency well under target lets the gain recover
+    gain = ctrl.gain;
+    for (i = 0; i < WAL_COMMIT_CTRL_WINDOW; i++)
+        wal_commit_ctrl_complete(&ctrl, 8, 100000, 150000);
+    CU_ASSERT(ctrl.p99_us <= 150);
+    CU_ASSERT(ctrl.gain > gain);
+    CU_ASSERT(ctrl.gain <= WAL_COMMIT_CTRL_GAIN_MAX);
+
+    return;
+}
+
+static void testConverge(void)
+{
+    wal_commit_ctrl_t ctrl;
+    int64_t intervals[] = {500, 2000, 20000, 200000, 2000000};
+    int i;
+
+    //load swings from saturation to idle and back, the target holds throughout
+    wal_commit_ctrl_init(&ctrl, TEST_TARGET_US, TEST_MAX_NR_OBJ);
+    for (i = 0; i < (int)(sizeof(intervals) / sizeof(intervals[0])); i++) {
+        CU_ASSERT(simulate(&ctrl, intervals[i], 150000, 200000) <= TEST_TARGET_US);
+    }
+    for (i = (int)(sizeof(intervals) / sizeof(intervals[0])) - 1; i >= 0; i--) {
+        CU_ASSERT(simulate(&ctrl, intervals[i], 150000, 200000) <= TEST_TARGET_US);
+    }
+    CU_ASSERT(simulate(&ctrl, 500, 150000, 200000) <= TEST_TARGET_US);
+    CU_ASSERT(ctrl.batch_nr_obj > 100);
+
+    return;
+}
+
+int main( )
+{
+    CU_pSuite pSuite = NULL;
+
+    if(CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    pSuite = CU_add_suite("DSS wal commit ctrl", NULL, NULL);
+    if(NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if(
+        NULL == CU_add_test(pSuite, "testInit", testInit) ||
+        NULL == CU_add_test(pSuite, "testLowRate", testLowRate) ||
+        NULL == CU_add_test(pSuite, "testHighRate", testHighRate) ||
+        NULL == CU_add_test(pSuite, "testOvershoot", testOvershoot) ||
+        NULL == CU_add_test(pSuite, "testConverge", testConverge)
+    ) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+
+    return CU_get_error();
+}
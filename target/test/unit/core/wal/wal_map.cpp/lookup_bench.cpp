@@ -0,0 +1,234 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Latency of wal_map_lookup per lookup type for a single zone map filled
+ * with keys that hash to that zone, as the wal cache does.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <wal_lib.h>
+
+#define BENCH_DEFAULT_NR_OBJS (1048576)
+#define BENCH_DEFAULT_NR_ZONES (4)
+#define BENCH_KEY_LEN (16)
+
+bool __log_enabled = false;
+dfly_trace_flag_t DFLY_LOG_WAL;
+
+void dfly_log(dfly_log_level_e level, const char *file, const int line, const char *func,
+	      const char *format, ...)
+{
+    return;
+}
+
+static int32_t bench_insert(void *context, wal_object_t *obj, wal_map_item_t *item,
+                            wal_map_insert_t insert_type)
+{
+    item->addr = (off64_t)obj->val->offset;
+    return WAL_SUCCESS;
+}
+
+static int64_t bench_read_item(void *context, wal_map_item_t *item, wal_object_t *obj)
+{
+    return 1;
+}
+
+static int bench_invalidate_item(void *context, wal_map_t *map, wal_map_item_t *item)
+{
+    if (ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_VALID, WAL_ITEM_INVALID) ||
+        ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_DELETED, WAL_ITEM_INVALID)) {
+        -- map->nr_valid_items;
+        return 0;
+    }
+    return -1;
+}
+
+static int bench_key_comp(wal_key_t *k1, wal_key_t *k2)
+{
+    if (k1->length != k2->length)
+        return -1;
+
+    return memcmp(k1->key, k2->key, k1->length);
+}
+
+wal_map_ops_t bench_map_ops = {
+    (hash_func_t) hash_sdbm,
+    (hash_key_comp_t) bench_key_comp,
+    (insert_func_t) bench_insert,
+    (read_func_t) bench_read_item,
+    (invalidate_item_t) bench_invalidate_item,
+};
+
+char bench_buffer;
+
+typedef struct bench_key_s {
+    char key[BENCH_KEY_LEN];
+    uint32_t key_hash;
+} bench_key_t;
+
+static void help() {
+    printf("usage:\n");
+    printf("\t\t./dss_wal_map_lookup_bench [nr_objs] [nr_zones]\n");
+    printf("arguments:\n");
+    printf("\t\t -nr_objs: the number of objects in the zone map, default %u.\n",
+            BENCH_DEFAULT_NR_OBJS);
+    printf("\t\t -nr_zones: the zones keys are spread over, default %u.\n",
+            BENCH_DEFAULT_NR_ZONES);
+}
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//keys of zone 0 only, starting at key index seq
+static bench_key_t *bench_gen_keys(uint32_t nr_objs, uint32_t nr_zones, uint64_t *seq)
+{
+    bench_key_t *keys = (bench_key_t *)malloc(nr_objs * sizeof(bench_key_t));
+    char key_str[BENCH_KEY_LEN + 1];
+    uint32_t i = 0;
+
+    while (keys && i < nr_objs) {
+        snprintf(key_str, sizeof(key_str), "%016llx", (unsigned long long)(*seq)++);
+        memcpy(keys[i].key, key_str, BENCH_KEY_LEN);
+        keys[i].key_hash = hash_sdbm(keys[i].key, BENCH_KEY_LEN);
+        if (keys[i].key_hash % nr_zones == 0) {
+            i++;
+        }
+    }
+
+    return keys;
+}
+
+static double run_lookup(wal_map_t *map, bench_key_t *keys, uint32_t nr_objs,
+                         wal_map_lookup_type_t lookup_type, uint32_t *nr_found)
+{
+    wal_key_t key;
+    wal_val_t val = {NULL, 4096, 0};
+    wal_object_t obj = {&key, &val, 0, 1, NULL};
+    uint64_t start;
+    uint32_t i;
+
+    *nr_found = 0;
+    key.length = BENCH_KEY_LEN;
+    start = bench_now_ns();
+    for (i = 0; i < nr_objs; i++) {
+        key.key = keys[i].key;
+        obj.key_hash = keys[i].key_hash;
+        val.offset = i;
+        if (wal_map_lookup(&bench_buffer, map, &obj, 0, lookup_type)) {
+            (*nr_found)++;
+        }
+    }
+
+    return (double)(bench_now_ns() - start) / nr_objs;
+}
+
+int main(int arc, char **argv)
+{
+    uint32_t nr_objs = BENCH_DEFAULT_NR_OBJS;
+    uint32_t nr_zones = BENCH_DEFAULT_NR_ZONES;
+    bench_key_t *keys, *miss_keys;
+    uint64_t seq = 0;
+    wal_map_t *map;
+    uint32_t nr_found;
+    double ns;
+    uint32_t i;
+
+    struct {
+        const char *name;
+        wal_map_lookup_type_t lookup_type;
+        bool miss;
+    } phases[] = {
+        {"insert", WAL_MAP_LOOKUP_WRITE_APPEND, false},
+        {"write_append", WAL_MAP_LOOKUP_WRITE_APPEND, false},
+        {"write_inplace", WAL_MAP_LOOKUP_WRITE_INPLACE, false},
+        {"read_hit", WAL_MAP_LOOKUP_READ, false},
+        {"read_miss", WAL_MAP_LOOKUP_READ, true},
+        {"invalidate_miss", WAL_MAP_LOOKUP_INVALIDATE, true},
+        {"invalidate", WAL_MAP_LOOKUP_INVALIDATE, false},
+        {"reinsert", WAL_MAP_LOOKUP_WRITE_APPEND, false},
+        {"delete", WAL_MAP_LOOKUP_DELETE, false},
+    };
+
+    if (arc > 3) {
+        printf("Input error\n");
+        help();
+        return 1;
+    }
+    if (arc > 1) {
+        nr_objs = strtoul(argv[1], NULL, 10);
+    }
+    if (arc > 2) {
+        nr_zones = strtoul(argv[2], NULL, 10);
+    }
+    if (!nr_objs || !nr_zones) {
+        help();
+        return 1;
+    }
+
+    keys = bench_gen_keys(nr_objs, nr_zones, &seq);
+    miss_keys = bench_gen_keys(nr_objs, nr_zones, &seq);
+    map = wal_map_create(&bench_buffer, WAL_MAX_BUCKET, &bench_map_ops);
+    if (!keys || !miss_keys || !map) {
+        printf("ERROR: bench init failed.\n");
+        return 1;
+    }
+
+    //delete keeps the item for the log service
+    __log_enabled = true;
+
+    printf("objs %u, zones %u, key len %u, map slots %u\n",
+            nr_objs, nr_zones, BENCH_KEY_LEN, map->nr_slots);
+    printf("%-16s %10s %10s\n", "lookup", "ns/op", "found");
+    for (i = 0; i < sizeof(phases) / sizeof(phases[0]); i++) {
+        ns = run_lookup(map, phases[i].miss ? miss_keys : keys, nr_objs,
+                        phases[i].lookup_type, &nr_found);
+        printf("%-16s %10.1f %10u\n", phases[i].name, ns, nr_found);
+    }
+    printf("map slots %u, used slots %u\n", map->nr_slots, map->nr_used_slots);
+
+    wal_map_destroy(map);
+    free(keys);
+    free(miss_keys);
+    return 0;
+}
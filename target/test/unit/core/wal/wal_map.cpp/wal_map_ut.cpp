@@ -0,0 +1,290 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include "CUnit/Basic.h"
+
+#include <wal_lib.h>
+
+bool __log_enabled = false;
+dfly_trace_flag_t DFLY_LOG_WAL;
+
+void dfly_log(dfly_log_level_e level, const char *file, const int line, const char *func,
+	      const char *format, ...)
+{
+    return;
+}
+
+static int32_t test_insert(void *context, wal_object_t *obj, wal_map_item_t *item,
+                           wal_map_insert_t insert_type)
+{
+    item->addr = (off64_t)obj->val->offset;
+    return WAL_SUCCESS;
+}
+
+static int64_t test_read_item(void *context, wal_map_item_t *item, wal_object_t *obj)
+{
+    return 1;
+}
+
+static int test_invalidate_item(void *context, wal_map_t *map, wal_map_item_t *item)
+{
+    if (ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_VALID, WAL_ITEM_INVALID) ||
+        ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_FLUSHED, WAL_ITEM_INVALID) ||
+        ATOMIC_BOOL_COMP_CHX(item->status, WAL_ITEM_DELETED, WAL_ITEM_INVALID)) {
+        -- map->nr_valid_items;
+        return 0;
+    }
+    return -1;
+}
+
+static int test_key_comp(wal_key_t *k1, wal_key_t *k2)
+{
+    if (k1->length != k2->length)
+        return -1;
+
+    return memcmp(k1->key, k2->key, k1->length);
+}
+
+wal_map_ops_t test_map_ops = {
+    (hash_func_t) hash_sdbm,
+    (hash_key_comp_t) test_key_comp,
+    (insert_func_t) test_insert,
+    (read_func_t) test_read_item,
+    (invalidate_item_t) test_invalidate_item,
+};
+
+char test_buffer;
+
+typedef struct test_obj_s {
+    char key_buff[32];
+    wal_key_t key;
+    wal_val_t val;
+    wal_object_t obj;
+} test_obj_t;
+
+static wal_object_t *test_obj_init(test_obj_t *t, uint32_t i)
+{
+    t->key.key = t->key_buff;
+    t->key.length = snprintf(t->key_buff, sizeof(t->key_buff), "wal_map_key_%08u", i);
+    t->val.value = NULL;
+    t->val.length = 4096;
+    t->val.offset = i;
+    t->obj.key = &t->key;
+    t->obj.val = &t->val;
+    t->obj.key_hash = hash_sdbm(t->key_buff, t->key.length);
+    t->obj.key_hashed = 1;
+    return &t->obj;
+}
+
+void testInsertRead(void)
+{
+    wal_map_t *map = wal_map_create(&test_buffer, 1024, &test_map_ops);
+    wal_map_item_t *item, *update;
+    test_obj_t t;
+    uint32_t i;
+
+    CU_ASSERT(map != NULL);
+
+    for (i = 0; i < 512; i++) {
+        item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_WRITE_APPEND);
+        CU_ASSERT(item != NULL);
+        CU_ASSERT(item->recover_status == WAL_ITEM_RECOVER_NEW);
+        CU_ASSERT(item->addr == i);
+    }
+    CU_ASSERT(map->nr_valid_items == 512);
+    CU_ASSERT(wal_map_item_iteration(map) == 512);
+
+    for (i = 0; i < 512; i++) {
+        item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_READ);
+        CU_ASSERT(item != NULL);
+        CU_ASSERT(item->key->length == t.key.length);
+        CU_ASSERT(!memcmp(item->key->key, t.key_buff, t.key.length));
+    }
+
+    //missing keys
+    for (i = 512; i < 1024; i++) {
+        item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_READ);
+        CU_ASSERT(item == NULL);
+        item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_INVALIDATE);
+        CU_ASSERT(item == NULL);
+    }
+
+    //overwrite keeps the item
+    item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, 7), 0, WAL_MAP_LOOKUP_READ);
+    t.val.offset = 7000;
+    update = wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_WRITE_INPLACE);
+    CU_ASSERT(update == item);
+    CU_ASSERT(update->addr == 7000);
+    CU_ASSERT(update->recover_status == WAL_ITEM_RECOVER_OVERWRITE);
+    CU_ASSERT(map->nr_valid_items == 512);
+
+    wal_map_destroy(map);
+
+    return;
+}
+
+void testInvalidateReuse(void)
+{
+    wal_map_t *map = wal_map_create(&test_buffer, 1024, &test_map_ops);
+    wal_map_item_t *item, *reused;
+    test_obj_t t;
+    uint32_t used_slots;
+
+    item = wal_map_lookup(&test_buffer, map, test_obj_init(&t, 1), 0, WAL_MAP_LOOKUP_WRITE_APPEND);
+    CU_ASSERT(item != NULL);
+    used_slots = map->nr_used_slots;
+
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_INVALIDATE) == item);
+    CU_ASSERT(item->status == WAL_ITEM_INVALID);
+    CU_ASSERT(map->nr_valid_items == 0);
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_READ) == NULL);
+
+    //the same key takes back its invalidated item and slot
+    reused = wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_WRITE_APPEND);
+    CU_ASSERT(reused == item);
+    CU_ASSERT(reused->status == WAL_ITEM_VALID);
+    CU_ASSERT(map->nr_used_slots == used_slots);
+    CU_ASSERT(map->nr_valid_items == 1);
+
+    //deleted objects stay in the map for the log
+    __log_enabled = true;
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_DELETE) == item);
+    CU_ASSERT(item->status == WAL_ITEM_DELETED);
+    CU_ASSERT(item->recover_status == WAL_ITEM_RECOVER_DELETED);
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_DELETE) == NULL);
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_READ) == NULL);
+    __log_enabled = false;
+
+    wal_map_destroy(map);
+
+    return;
+}
+
+void testHashCollision(void)
+{
+    wal_map_t *map = wal_map_create(&test_buffer, 16, &test_map_ops);
+    wal_map_item_t *items[64];
+    test_obj_t t;
+    uint32_t i;
+
+    //same key hash for all keys, only the fingerprint and key tell them apart
+    for (i = 0; i < 64; i++) {
+        test_obj_init(&t, i);
+        t.obj.key_hash = 0x1234;
+        items[i] = wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_WRITE_APPEND);
+        CU_ASSERT(items[i] != NULL);
+    }
+
+    for (i = 0; i < 64; i++) {
+        test_obj_init(&t, i);
+        t.obj.key_hash = 0x1234;
+        CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_READ) == items[i]);
+    }
+
+    wal_map_destroy(map);
+
+    return;
+}
+
+void testGrowReinit(void)
+{
+    wal_map_t *map = wal_map_create(&test_buffer, 16, &test_map_ops);
+    wal_map_item_t *item;
+    wal_map_slab_t *slabs;
+    test_obj_t t;
+    uint32_t i;
+
+    CU_ASSERT(map->nr_slots == WAL_MAP_MIN_SLOTS);
+
+    for (i = 0; i < 4096; i++) {
+        CU_ASSERT(wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_WRITE_APPEND) != NULL);
+    }
+    CU_ASSERT(map->nr_slots >= 4096 * 100 / WAL_MAP_MAX_LOAD_PCT);
+
+    //items survive the index growth and keep the insert order for flush
+    i = 0;
+    TAILQ_FOREACH(item, &map->head, link) {
+        test_obj_init(&t, i++);
+        CU_ASSERT(wal_map_lookup(&test_buffer, map, &t.obj, 0, WAL_MAP_LOOKUP_READ) == item);
+    }
+    CU_ASSERT(i == 4096);
+
+    //reinit returns all items to the slab
+    slabs = map->slabs;
+    CU_ASSERT(wal_map_reinit(map) == 4096);
+    CU_ASSERT(map->nr_used_slots == 0);
+    CU_ASSERT(TAILQ_EMPTY(&map->head));
+    CU_ASSERT(wal_map_lookup(&test_buffer, map, test_obj_init(&t, 1), 0, WAL_MAP_LOOKUP_READ) == NULL);
+
+    for (i = 0; i < 4096; i++) {
+        CU_ASSERT(wal_map_lookup(&test_buffer, map, test_obj_init(&t, i), 0, WAL_MAP_LOOKUP_WRITE_APPEND) != NULL);
+    }
+    CU_ASSERT(map->slabs == slabs);
+    CU_ASSERT(wal_map_item_iteration(map) == 4096);
+
+    wal_map_destroy(map);
+
+    return;
+}
+
+int main( )
+{
+    CU_pSuite pSuite = NULL;
+
+    if(CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    pSuite = CU_add_suite("DSS wal map", NULL, NULL);
+    if(NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if(
+        NULL == CU_add_test(pSuite, "testInsertRead", testInsertRead) ||
+        NULL == CU_add_test(pSuite, "testInvalidateReuse", testInvalidateReuse) ||
+        NULL == CU_add_test(pSuite, "testHashCollision", testHashCollision) ||
+        NULL == CU_add_test(pSuite, "testGrowReinit", testGrowReinit)
+    ) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+
+    return CU_get_error();
+}
@@ -0,0 +1,168 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2022 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *      * Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *      * Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in
+ *        the documentation and/or other materials provided with the distribution.
+ *      * Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *        contributors may be used to endorse or promote products derived from
+ *        this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include "CUnit/Basic.h"
+
+#include <wal_lib.h>
+#include <wal_pmem.h>
+
+#define TEST_FILE_SZ	(4 * 1024 * 1024)
+
+static int nr_comp;
+
+static void test_comp(struct df_dev_response_s resp, void *arg)
+{
+    CU_ASSERT(resp.rc);
+    CU_ASSERT(arg == (void *)&nr_comp);
+    nr_comp++;
+}
+
+static void fill(char *buf, int len, int seed)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (char)(seed * 131 + i * 7);
+}
+
+static void testMemcpyPersist(void)
+{
+    static char src[8192 + 128], dst[8192 + 256], ref[8192 + 256];
+    int lens[] = {1, 63, 64, 255, 256, 1000, 4096, 8192 + 17};
+    int i, dst_off, src_off;
+
+    fill(src, sizeof(src), 1);
+    //every alignment of the destination within a cache line and the head, stream and tail paths
+    for (i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++) {
+        for (dst_off = 0; dst_off < WAL_PMEM_CACHELINE; dst_off += 7) {
+            for (src_off = 0; src_off < 32; src_off += 13) {
+                memset(dst, 0x5a, sizeof(dst));
+                memset(ref, 0x5a, sizeof(ref));
+                memcpy(ref + dst_off, src + src_off, lens[i]);
+                wal_pmem_memcpy_persist(dst + dst_off, src + src_off, lens[i]);
+                CU_ASSERT(!memcmp(dst, ref, sizeof(dst)));
+            }
+        }
+    }
+
+    return;
+}
+
+static void testFileBackend(void)
+{
+    char path[] = "/tmp/dss_wal_pmem_utXXXXXX";
+    static char buf[65536], rd[65536];
+    int fd, handle, rc;
+
+    fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    CU_ASSERT(!ftruncate(fd, TEST_FILE_SZ));
+    close(fd);
+
+    handle = wal_log_pmem_io.open(path, 0);
+    CU_ASSERT(handle >= 0);
+    CU_ASSERT(wal_pmem_getsize(handle) == TEST_FILE_SZ);
+
+    //records as the log writes them: sb, buffer headers and batches at aligned offsets
+    nr_comp = 0;
+    fill(buf, sizeof(buf), 2);
+    rc = wal_log_pmem_io.write(handle, buf, 0, 4096, (void *)test_comp, &nr_comp);
+    CU_ASSERT(rc == 4096);
+    rc = wal_log_pmem_io.write(handle, buf + 100, 1024 * 1024, sizeof(buf) - 100, (void *)test_comp, &nr_comp);
+    CU_ASSERT(rc == sizeof(buf) - 100);
+    //no callback, synchronous caller
+    rc = wal_log_pmem_io.write(handle, buf + 7, TEST_FILE_SZ - 3000, 3000, NULL, NULL);
+    CU_ASSERT(rc == 3000);
+    CU_ASSERT(nr_comp == 2);
+
+    CU_ASSERT(wal_log_pmem_io.write(handle, buf, TEST_FILE_SZ - 1024, 2048, NULL, NULL) == -WAL_ERROR_BAD_ADDR);
+    CU_ASSERT(wal_log_pmem_io.read(handle, rd, TEST_FILE_SZ, 1, NULL, NULL) == -WAL_ERROR_BAD_ADDR);
+
+    rc = wal_log_pmem_io.read(handle, rd, 1024 * 1024, sizeof(buf) - 100, (void *)test_comp, &nr_comp);
+    CU_ASSERT(rc == sizeof(buf) - 100);
+    CU_ASSERT(!memcmp(rd, buf + 100, sizeof(buf) - 100));
+    CU_ASSERT(nr_comp == 3);
+
+    CU_ASSERT(!wal_log_pmem_io.close(handle));
+
+    //the writes reached the file
+    fd = open(path, O_RDONLY);
+    CU_ASSERT(fd >= 0);
+    CU_ASSERT(pread(fd, rd, 4096, 0) == 4096);
+    CU_ASSERT(!memcmp(rd, buf, 4096));
+    CU_ASSERT(pread(fd, rd, 3000, TEST_FILE_SZ - 3000) == 3000);
+    CU_ASSERT(!memcmp(rd, buf + 7, 3000));
+    close(fd);
+
+    //the slot is reused and the data is there on reopen
+    handle = wal_log_pmem_io.open(path, 0);
+    CU_ASSERT(handle >= 0);
+    CU_ASSERT(wal_log_pmem_io.read(handle, rd, 0, 4096, NULL, NULL) == 4096);
+    CU_ASSERT(!memcmp(rd, buf, 4096));
+    CU_ASSERT(!wal_log_pmem_io.close(handle));
+
+    unlink(path);
+    CU_ASSERT(wal_log_pmem_io.open(path, 0) < 0);
+
+    return;
+}
+
+int main( )
+{
+    CU_pSuite pSuite = NULL;
+
+    if(CUE_SUCCESS != CU_initialize_registry()) {
+        return CU_get_error();
+    }
+
+    pSuite = CU_add_suite("DSS wal pmem", NULL, NULL);
+    if(NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    if(
+        NULL == CU_add_test(pSuite, "testMemcpyPersist", testMemcpyPersist) ||
+        NULL == CU_add_test(pSuite, "testFileBackend", testFileBackend)
+    ) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+
+    return CU_get_error();
+}
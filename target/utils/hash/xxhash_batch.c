@@ -0,0 +1,305 @@
+/**
+ *  The Clear BSD License
+ *
+ *  Copyright (c) 2023 Samsung Electronics Co., Ltd.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted (subject to the limitations in the
+ *  disclaimer below) provided that the following conditions are met:
+ *
+ *  	* Redistributions of source code must retain the above copyright
+ *  	  notice, this list of conditions and the following disclaimer.
+ *  	* Redistributions in binary form must reproduce the above copyright
+ *  	  notice, this list of conditions and the following disclaimer in
+ *  	  the documentation and/or other materials provided with the distribution.
+ *  	* Neither the name of Samsung Electronics Co., Ltd. nor the names of its
+ *  	  contributors may be used to endorse or promote products derived from
+ *  	  this software without specific prior written permission.
+ *
+ *  NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED
+ *  BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+ *  BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ *  FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+ *  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ *  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Multi-key XXH32.
+ * XXH32 keeps four 32 bit accumulators per key, so one key maps to one
+ * 32 bit lane and a vector register holds the same accumulator for 8 (AVX2)
+ * or 16 (AVX-512) keys. The stripes common to all keys of a group are
+ * consumed in vector registers, the rest of every key is finished with
+ * scalar code. Output matches XXH32() bit for bit.
+ */
+
+#include <string.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "xxhash_batch.h"
+#include "xxhash.h"
+
+#define XXH32_P1 0x9E3779B1U
+#define XXH32_P2 0x85EBCA77U
+#define XXH32_P3 0xC2B2AE3DU
+#define XXH32_P4 0x27D4EB2FU
+#define XXH32_P5 0x165667B1U
+
+#define XXH32_STRIPE_LEN (16)
+
+#if defined(__AVX512F__)
+#define XXH32_BATCH_LANES (16)
+#elif defined(__AVX2__)
+#define XXH32_BATCH_LANES (8)
+#else
+#define XXH32_BATCH_LANES (1)
+#endif
+
+static inline uint32_t _xxh32_rotl(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t _xxh32_read32(const uint8_t *p)
+{
+    uint32_t v;
+    // x86 only, keys are read as little endian words
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t _xxh32_round(uint32_t acc, uint32_t input)
+{
+    acc += input * XXH32_P2;
+    acc = _xxh32_rotl(acc, 13);
+    return acc * XXH32_P1;
+}
+
+#if XXH32_BATCH_LANES > 1
+// Continue XXH32 of a key after `stripes` stripes were consumed into v[]
+static uint32_t _xxh32_finish(const uint8_t *p, uint32_t len, uint32_t stripes, uint32_t v[4])
+{
+    const uint8_t *end = p + len;
+    uint32_t h;
+
+    p += stripes * XXH32_STRIPE_LEN;
+    while (p + XXH32_STRIPE_LEN <= end) {
+        v[0] = _xxh32_round(v[0], _xxh32_read32(p));
+        v[1] = _xxh32_round(v[1], _xxh32_read32(p + 4));
+        v[2] = _xxh32_round(v[2], _xxh32_read32(p + 8));
+        v[3] = _xxh32_round(v[3], _xxh32_read32(p + 12));
+        p += XXH32_STRIPE_LEN;
+    }
+
+    h = _xxh32_rotl(v[0], 1) + _xxh32_rotl(v[1], 7) +
+            _xxh32_rotl(v[2], 12) + _xxh32_rotl(v[3], 18);
+    h += len;
+
+    while (p + 4 <= end) {
+        h += _xxh32_read32(p) * XXH32_P3;
+        h = _xxh32_rotl(h, 17) * XXH32_P4;
+        p += 4;
+    }
+    while (p < end) {
+        h += (*p) * XXH32_P5;
+        h = _xxh32_rotl(h, 11) * XXH32_P1;
+        p++;
+    }
+
+    h ^= h >> 15;
+    h *= XXH32_P2;
+    h ^= h >> 13;
+    h *= XXH32_P3;
+    h ^= h >> 16;
+
+    return h;
+}
+
+// Number of stripes every key of the group has. 0 if any key is shorter than a stripe.
+static inline uint32_t _xxh32_common_stripes(const uint32_t *klens)
+{
+    uint32_t stripes = UINT32_MAX;
+    uint32_t i;
+
+    for (i = 0; i < XXH32_BATCH_LANES; i++) {
+        if (klens[i] / XXH32_STRIPE_LEN < stripes) {
+            stripes = klens[i] / XXH32_STRIPE_LEN;
+        }
+    }
+    return stripes;
+}
+
+static void _xxh32_lanes_finish(const char **keys, const uint32_t *klens, uint32_t stripes,
+                                uint32_t acc[4][XXH32_BATCH_LANES], uint32_t *out)
+{
+    uint32_t v[4];
+    uint32_t i;
+
+    for (i = 0; i < XXH32_BATCH_LANES; i++) {
+        v[0] = acc[0][i];
+        v[1] = acc[1][i];
+        v[2] = acc[2][i];
+        v[3] = acc[3][i];
+        out[i] = _xxh32_finish((const uint8_t *)keys[i], klens[i], stripes, v);
+    }
+}
+#endif
+
+#if defined(__AVX512F__)
+static inline __m512i _xxh32_round_x16(__m512i acc, __m512i input, __m512i p1, __m512i p2)
+{
+    acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(input, p2));
+    acc = _mm512_rol_epi32(acc, 13);
+    return _mm512_mullo_epi32(acc, p1);
+}
+
+// Gather one 16 byte stripe of keys k, k+4, k+8, k+12 into one register
+static inline __m512i _xxh32_load_x4(const char **keys, uint32_t k, uint32_t off)
+{
+    __m512i r = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i *)(keys[k] + off)));
+
+    r = _mm512_inserti32x4(r, _mm_loadu_si128((const __m128i *)(keys[k + 4] + off)), 1);
+    r = _mm512_inserti32x4(r, _mm_loadu_si128((const __m128i *)(keys[k + 8] + off)), 2);
+    r = _mm512_inserti32x4(r, _mm_loadu_si128((const __m128i *)(keys[k + 12] + off)), 3);
+    return r;
+}
+
+static void _xxh32_lanes(const char **keys, const uint32_t *klens, uint32_t seed, uint32_t *out)
+{
+    const __m512i p1 = _mm512_set1_epi32((int)XXH32_P1);
+    const __m512i p2 = _mm512_set1_epi32((int)XXH32_P2);
+    __m512i v0 = _mm512_set1_epi32((int)(seed + XXH32_P1 + XXH32_P2));
+    __m512i v1 = _mm512_set1_epi32((int)(seed + XXH32_P2));
+    __m512i v2 = _mm512_set1_epi32((int)seed);
+    __m512i v3 = _mm512_set1_epi32((int)(seed - XXH32_P1));
+    __m512i a0, a1, a2, a3, t0, t1, t2, t3;
+    uint32_t acc[4][XXH32_BATCH_LANES] __attribute__((aligned(64)));
+    uint32_t stripes = _xxh32_common_stripes(klens);
+    uint32_t s, off, i;
+
+    if (stripes == 0) {
+        for (i = 0; i < XXH32_BATCH_LANES; i++) {
+            out[i] = XXH32(keys[i], klens[i], seed);
+        }
+        return;
+    }
+
+    for (s = 0; s < stripes; s++) {
+        off = s * XXH32_STRIPE_LEN;
+        a0 = _xxh32_load_x4(keys, 0, off);
+        a1 = _xxh32_load_x4(keys, 1, off);
+        a2 = _xxh32_load_x4(keys, 2, off);
+        a3 = _xxh32_load_x4(keys, 3, off);
+
+        // 4x4 transpose of 32 bit words in each 128 bit lane
+        t0 = _mm512_unpacklo_epi32(a0, a1);
+        t1 = _mm512_unpackhi_epi32(a0, a1);
+        t2 = _mm512_unpacklo_epi32(a2, a3);
+        t3 = _mm512_unpackhi_epi32(a2, a3);
+
+        v0 = _xxh32_round_x16(v0, _mm512_unpacklo_epi64(t0, t2), p1, p2);
+        v1 = _xxh32_round_x16(v1, _mm512_unpackhi_epi64(t0, t2), p1, p2);
+        v2 = _xxh32_round_x16(v2, _mm512_unpacklo_epi64(t1, t3), p1, p2);
+        v3 = _xxh32_round_x16(v3, _mm512_unpackhi_epi64(t1, t3), p1, p2);
+    }
+
+    _mm512_store_si512((__m512i *)acc[0], v0);
+    _mm512_store_si512((__m512i *)acc[1], v1);
+    _mm512_store_si512((__m512i *)acc[2], v2);
+    _mm512_store_si512((__m512i *)acc[3], v3);
+
+    _xxh32_lanes_finish(keys, klens, stripes, acc, out);
+}
+#elif defined(__AVX2__)
+static inline __m256i _xxh32_round_x8(__m256i acc, __m256i input, __m256i p1, __m256i p2)
+{
+    acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(input, p2));
+    acc = _mm256_or_si256(_mm256_slli_epi32(acc, 13), _mm256_srli_epi32(acc, 19));
+    return _mm256_mullo_epi32(acc, p1);
+}
+
+// Gather one 16 byte stripe of keys k and k+4 into one register
+static inline __m256i _xxh32_load_x2(const char **keys, uint32_t k, uint32_t off)
+{
+    __m256i r = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(keys[k] + off)));
+
+    return _mm256_inserti128_si256(r, _mm_loadu_si128((const __m128i *)(keys[k + 4] + off)), 1);
+}
+
+static void _xxh32_lanes(const char **keys, const uint32_t *klens, uint32_t seed, uint32_t *out)
+{
+    const __m256i p1 = _mm256_set1_epi32((int)XXH32_P1);
+    const __m256i p2 = _mm256_set1_epi32((int)XXH32_P2);
+    __m256i v0 = _mm256_set1_epi32((int)(seed + XXH32_P1 + XXH32_P2));
+    __m256i v1 = _mm256_set1_epi32((int)(seed + XXH32_P2));
+    __m256i v2 = _mm256_set1_epi32((int)seed);
+    __m256i v3 = _mm256_set1_epi32((int)(seed - XXH32_P1));
+    __m256i a0, a1, a2, a3, t0, t1, t2, t3;
+    uint32_t acc[4][XXH32_BATCH_LANES] __attribute__((aligned(32)));
+    uint32_t stripes = _xxh32_common_stripes(klens);
+    uint32_t s, off, i;
+
+    if (stripes == 0) {
+        for (i = 0; i < XXH32_BATCH_LANES; i++) {
+            out[i] = XXH32(keys[i], klens[i], seed);
+        }
+        return;
+    }
+
+    for (s = 0; s < stripes; s++) {
+        off = s * XXH32_STRIPE_LEN;
+        a0 = _xxh32_load_x2(keys, 0, off);
+        a1 = _xxh32_load_x2(keys, 1, off);
+        a2 = _xxh32_load_x2(keys, 2, off);
+        a3 = _xxh32_load_x2(keys, 3, off);
+
+        // 4x4 transpose of 32 bit words in each 128 bit lane
+        t0 = _mm256_unpacklo_epi32(a0, a1);
+        t1 = _mm256_unpackhi_epi32(a0, a1);
+        t2 = _mm256_unpacklo_epi32(a2, a3);
+        t3 = _mm256_unpackhi_epi32(a2, a3);
+
+        v0 = _xxh32_round_x8(v0, _mm256_unpacklo_epi64(t0, t2), p1, p2);
+        v1 = _xxh32_round_x8(v1, _mm256_unpackhi_epi64(t0, t2), p1, p2);
+        v2 = _xxh32_round_x8(v2, _mm256_unpacklo_epi64(t1, t3), p1, p2);
+        v3 = _xxh32_round_x8(v3, _mm256_unpackhi_epi64(t1, t3), p1, p2);
+    }
+
+    _mm256_store_si256((__m256i *)acc[0], v0);
+    _mm256_store_si256((__m256i *)acc[1], v1);
+    _mm256_store_si256((__m256i *)acc[2], v2);
+    _mm256_store_si256((__m256i *)acc[3], v3);
+
+    _xxh32_lanes_finish(keys, klens, stripes, acc, out);
+}
+#endif
+
+uint32_t xxh32_batch_lanes(void)
+{
+    return XXH32_BATCH_LANES;
+}
+
+void xxh32_batch(const char **keys, const uint32_t *klens, uint32_t num_keys,
+                 uint32_t seed, uint32_t *out)
+{
+    uint32_t i = 0;
+
+#if XXH32_BATCH_LANES > 1
+    for (; i + XXH32_BATCH_LANES <= num_keys; i += XXH32_BATCH_LANES) {
+        _xxh32_lanes(&keys[i], &klens[i], seed, &out[i]);
+    }
+#endif
+    for (; i < num_keys; i++) {
+        out[i] = XXH32(keys[i], klens[i], seed);
+    }
+}